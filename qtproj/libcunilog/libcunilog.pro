@@ -88,6 +88,7 @@ HEADERS += \
     ../../src/c/datetime/ubf_times.h \
     ../../src/c/dbg/dbgcountandtrack.h \
     ../../src/c/dbg/ubfdebug.h \
+    ../../src/c/extern/ExtCompressors.h \
     ../../src/c/mem/VectorC.h \
     ../../src/c/mem/bulkmalloc.h \
     ../../src/c/mem/membuf.h \
@@ -141,6 +142,7 @@ SOURCES += \
     ../../src/c/datetime/ubf_times.c \
     ../../src/c/dbg/dbgcountandtrack.c \
     ../../src/c/dbg/ubfdebug.c \
+    ../../src/c/extern/ExtCompressors.c \
     ../../src/c/mem/VectorC.c \
     ../../src/c/mem/bulkmalloc.c \
     ../../src/c/mem/membuf.c \
@@ -66,6 +66,11 @@ DEFINES += PROCESS_HELPERS_BUILD_TEST_FNCT
 linux:LIBS += \
 		-ldl
 
+# The gzip rotator (cunilogrotationtask_ExtCompressLogfiles) requires zlib.
+linux:DEFINES += HAVE_ZLIB
+linux:LIBS += \
+		-lz
+
 # See
 #	https://stackoverflow.com/questions/14015950/which-library-to-link-osx
 macx:LIBS += \
@@ -105,6 +110,7 @@ HEADERS += \
     ../../src/c/datetime/ubf_times.h \
     ../../src/c/dbg/dbgcountandtrack.h \
     ../../src/c/dbg/ubfdebug.h \
+    ../../src/c/extern/ExtCompressors.h \
     ../../src/c/mem/VectorC.h \
     ../../src/c/mem/bulkmalloc.h \
     ../../src/c/mem/membuf.h \
@@ -165,6 +171,7 @@ SOURCES += \
     ../../src/c/datetime/ubf_times.c \
     ../../src/c/dbg/dbgcountandtrack.c \
     ../../src/c/dbg/ubfdebug.c \
+    ../../src/c/extern/ExtCompressors.c \
     ../../src/c/mem/VectorC.c \
     ../../src/c/mem/bulkmalloc.c \
     ../../src/c/mem/membuf.c \
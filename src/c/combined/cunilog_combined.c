@@ -8347,320 +8347,925 @@ When		Who				What
 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 	#include "./ExtCompressors.h"
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./ubfdebug.h"
+		#include "./ubfmem.h"
+		#include "./unref.h"
+		#ifdef OS_IS_WINDOWS
+			#include "./WinAPI_U8.h"
+		#endif
+	#else
+		#include "./../dbg/ubfdebug.h"
+		#include "./../mem/ubfmem.h"
+		#include "./../pre/unref.h"
+		#ifdef OS_IS_WINDOWS
+			#include "./../OS/Windows/WinAPI_U8.h"
+		#endif
+	#endif
 #endif
 
-/****************************************************************************************
+#include <string.h>
+#include <stdint.h>
 
-	File:		ubfmem.c
-	Why:		Functions for memory handling.
-	OS:			C99
-	Author:		Thomas
-	Created:	2016-10-31
-  
-History
--------
+#ifdef PLATFORM_IS_POSIX
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <stdio.h>
+#endif
 
-When		Who				What
------------------------------------------------------------------------------------------
-2016-10-31	Thomas			Created.
+#ifdef HAVE_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+	#include <zstd.h>
+#endif
 
-****************************************************************************************/
+#ifdef OS_IS_WINDOWS
+	typedef HANDLE		extcmphandle;
+	#define EXTCMP_INVALID_HANDLE	INVALID_HANDLE_VALUE
+#else
+	typedef int			extcmphandle;
+	#define EXTCMP_INVALID_HANDLE	(-1)
+#endif
 
 /*
-	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+	The source and destination file of a compression, and the buffers. The buffers
+	are allocated together with the temporary file name in one go.
 */
+typedef struct extcmpfiles
+{
+	extcmphandle		hSrc;
+	extcmphandle		hDst;
+	unsigned char		*pIn;								// EXT_COMPRESSOR_BUF_SIZE octets.
+	unsigned char		*pOut;								// EXT_COMPRESSOR_BUF_SIZE octets.
+	char				*szTmp;								// Name of the temporary file.
+} EXTCMPFILES;
 
-/*
-	This code is covered by the MIT License. See https://opensource.org/license/mit .
+static const char		*ccExtCompressorExtensions [extcompressor_XAmountEnumValues] =
+{
+		".gz"
+	,	".zst"
+};
 
-	Copyright (c) 2024, 2025 Thomas
+bool ExtCompressorAvailable (enextcompressor cmp)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
 
-	Permission is hereby granted, free of charge, to any person obtaining a copy of this
-	software and associated documentation files (the "Software"), to deal in the Software
-	without restriction, including without limitation the rights to use, copy, modify,
-	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
-	permit persons to whom the Software is furnished to do so, subject to the following
-	conditions:
+	switch (cmp)
+	{
+		case extcompressor_gzip:
+			#ifdef HAVE_ZLIB
+				return true;
+			#else
+				return false;
+			#endif
+		case extcompressor_zstd:
+			#ifdef HAVE_ZSTD
+				return true;
+			#else
+				return false;
+			#endif
+		default:
+			return false;
+	}
+}
 
-	The above copyright notice and this permission notice shall be included in all copies
-	or substantial portions of the Software.
+const char *ExtCompressorFileExtension (enextcompressor cmp, size_t *plen)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
 
-	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
-	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
-	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
-	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
-	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-*/
+	const char *cc = ccExtCompressorExtensions [cmp];
+	if (plen)
+		*plen = strlen (cc);
+	return cc;
+}
 
-#ifdef _MSC_VER
-	#include <crtdbg.h>
-#else
-	// We need this if the Microsoft compiler is not used.
-	#include <assert.h>
-#endif
+static inline void setExtCmpError (bool bNotSupported)
+{
+	#ifdef OS_IS_WINDOWS
+		SetLastError (bNotSupported ? ERROR_NOT_SUPPORTED : ERROR_INVALID_DATA);
+	#else
+		errno = bNotSupported ? ENOSYS : EIO;
+	#endif
+}
 
-#include <malloc.h>
-#include <string.h>
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+/*
+	Reads up to EXT_COMPRESSOR_BUF_SIZE octets from the source file into pIn. The number of
+	octets read is returned in *pRead. It is 0 at the end of the file.
+*/
+static bool readExtCmpSrc (EXTCMPFILES *pf, size_t *pRead)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (pRead);
 
-#ifndef CUNILOG_USE_COMBINED_MODULE
+	#ifdef OS_IS_WINDOWS
+		DWORD dwRead;
+		if (!ReadFile (pf->hSrc, pf->pIn, EXT_COMPRESSOR_BUF_SIZE, &dwRead, NULL))
+			return false;
+		*pRead = dwRead;
+		return true;
+	#else
+		ssize_t r;
+		do
+		{
+			r = read (pf->hSrc, pf->pIn, EXT_COMPRESSOR_BUF_SIZE);
+		} while (-1 == r && EINTR == errno);
+		if (-1 == r)
+			return false;
+		*pRead = (size_t) r;
+		return true;
+	#endif
+}
 
-	#include "./ubfmem.h"
+static bool writeExtCmpDst (EXTCMPFILES *pf, const unsigned char *pData, size_t len)
+{
+	ubf_assert_non_NULL (pf);
 
-	#ifdef UBF_MEM_DEBUG_USE_OUR_DEBUG_FUNCS
-		#include "./../dbg/ubfdebug.h"
-		#include "./../mem/ubfmemdebug.h"
+	#ifdef OS_IS_WINDOWS
+		DWORD dwWritten;
+		while (len)
+		{
+			if (!WriteFile (pf->hDst, pData, (DWORD) len, &dwWritten, NULL))
+				return false;
+			pData	+= dwWritten;
+			len		-= dwWritten;
+		}
+		return true;
+	#else
+		ssize_t w;
+		while (len)
+		{
+			w = write (pf->hDst, pData, len);
+			if (-1 == w)
+			{
+				if (EINTR == errno)
+					continue;
+				return false;
+			}
+			pData	+= w;
+			len		-= (size_t) w;
+		}
+		return true;
 	#endif
-
+}
 #endif
 
-#ifdef _WIN32
-	#ifdef USE_WINDOWS_NATIVE_HEAP_FUNCTIONS
-		#include <windows.h>
+#ifdef HAVE_ZLIB
+	static bool compressExtCmpGzip (EXTCMPFILES *pf, int level)
+	{
+		ubf_assert_non_NULL (pf);
 
-		/*
-		void *memset (void *ptr, int value, size_t num)
-		{
-			char *p = ptr;
+		z_stream	zs;
+		size_t		stRead;
+		int			flush;
+		int			zr;
 
-			while (num-- > 0)
-				*p ++ = value;
-			return ptr;
+		memset (&zs, 0, sizeof (zs));
+		if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+			level = Z_DEFAULT_COMPRESSION;
+		// 15 + 16 selects a window of 32 KiB and a gzip header and trailer.
+		zr = deflateInit2 (&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		if (Z_OK != zr)
+		{
+			setExtCmpError (false);
+			return false;
 		}
-		*/
+		do
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+				goto Failed;
+			zs.next_in	= pf->pIn;
+			zs.avail_in	= (uInt) stRead;
+			flush		= stRead ? Z_NO_FLUSH : Z_FINISH;
+			do
+			{
+				zs.next_out		= pf->pOut;
+				zs.avail_out	= EXT_COMPRESSOR_BUF_SIZE;
+				zr = deflate (&zs, flush);
+				if (Z_STREAM_ERROR == zr)
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (!writeExtCmpDst (pf, pf->pOut, EXT_COMPRESSOR_BUF_SIZE - zs.avail_out))
+					goto Failed;
+			} while (0 == zs.avail_out);
+		} while (Z_FINISH != flush);
+		ubf_assert (Z_STREAM_END == zr);
+		deflateEnd (&zs);
+		return true;
 
-		/*
-			memcpy
-			memcmp
+	Failed:
+		deflateEnd (&zs);
+		return false;
+	}
+#endif
 
-			Because we are not using the run-time library to obtain a small executable size we
-			got to provide our own standard functions.
-		*/
-		/*
-		void *memcpy (void *dest, const void *src, size_t len)
+#ifdef HAVE_ZSTD
+	static bool compressExtCmpZstd (EXTCMPFILES *pf, int level)
+	{
+		ubf_assert_non_NULL (pf);
+
+		ZSTD_CCtx			*cctx;
+		ZSTD_inBuffer		zin;
+		ZSTD_outBuffer		zout;
+		ZSTD_EndDirective	mode;
+		size_t				stRead;
+		size_t				zr;
+		bool				bDone;
+
+		cctx = ZSTD_createCCtx ();
+		if (NULL == cctx)
 		{
-			char *d = dest;
-			const char *s = src;
+			setExtCmpError (false);
+			return false;
+		}
+		if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+			level = ZSTD_CLEVEL_DEFAULT;
+		ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel, level);
+		ZSTD_CCtx_setParameter (cctx, ZSTD_c_checksumFlag, 1);
+		do
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+				goto Failed;
+			zin.src		= pf->pIn;
+			zin.size	= stRead;
+			zin.pos		= 0;
+			mode		= stRead ? ZSTD_e_continue : ZSTD_e_end;
+			do
+			{
+				zout.dst	= pf->pOut;
+				zout.size	= EXT_COMPRESSOR_BUF_SIZE;
+				zout.pos	= 0;
+				zr = ZSTD_compressStream2 (cctx, &zout, &zin, mode);
+				if (ZSTD_isError (zr))
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (!writeExtCmpDst (pf, pf->pOut, zout.pos))
+					goto Failed;
+				// With ZSTD_e_end, zr is the amount of octets still to be flushed.
+				bDone = ZSTD_e_end == mode ? 0 == zr : zin.pos == zin.size;
+			} while (!bDone);
+		} while (ZSTD_e_end != mode);
+		ZSTD_freeCCtx (cctx);
+		return true;
 
-			while (len--)
+	Failed:
+		ZSTD_freeCCtx (cctx);
+		return false;
+	}
+#endif
+
+static bool openExtCmpFiles (EXTCMPFILES *pf, const char *szSrc)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (szSrc);
+
+	#ifdef OS_IS_WINDOWS
+		pf->hSrc = CreateFileU8	(
+						szSrc, GENERIC_READ,
+						FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+								);
+		if (EXTCMP_INVALID_HANDLE == pf->hSrc)
+			return false;
+		pf->hDst = CreateFileU8	(
+						pf->szTmp, GENERIC_WRITE, 0,
+						NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL
+								);
+	#else
+		pf->hSrc = open (szSrc, O_RDONLY | O_CLOEXEC);
+		if (EXTCMP_INVALID_HANDLE == pf->hSrc)
+			return false;
+		pf->hDst = open (pf->szTmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	#endif
+	return EXTCMP_INVALID_HANDLE != pf->hDst;
+}
+
+/*
+	Flushes the temporary file to disk and closes both files. If bMove is true, the
+	temporary file is then renamed to szDst. The temporary file is deleted if anything
+	failed. The error of the first failure is preserved.
+*/
+static bool closeExtCmpFiles (EXTCMPFILES *pf, const char *szDst, bool bMove)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (szDst);
+
+	#ifdef OS_IS_WINDOWS
+		DWORD	err		= ERROR_SUCCESS;
+
+		if (EXTCMP_INVALID_HANDLE != pf->hSrc)
+			CloseHandle (pf->hSrc);
+		if (EXTCMP_INVALID_HANDLE != pf->hDst)
+		{
+			if (bMove && !FlushFileBuffers (pf->hDst))
+				bMove = false;
+			CloseHandle (pf->hDst);
+			if (bMove)
+				bMove = MoveFileExU8	(
+							pf->szTmp, szDst,
+							MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+										);
+			if (!bMove)
 			{
-				*d++ = *s++;
+				err = GetLastError ();
+				DeleteFileU8 (pf->szTmp);
+				SetLastError (err);
 			}
-			return dest;
 		}
-		*/
-
-		int memcmp (const void *str1, const void *str2, size_t count)
-		{
-			const unsigned char *s1 = (const unsigned char*) str1;
-			const unsigned char *s2 = (const unsigned char*) str2;
-
-			while (count-- > 0)
+	#else
+		int		err;
+
+		if (EXTCMP_INVALID_HANDLE != pf->hSrc)
+			close (pf->hSrc);
+		if (EXTCMP_INVALID_HANDLE != pf->hDst)
+		{
+			if (bMove && 0 != fsync (pf->hDst))
+				bMove = false;
+			if (0 != close (pf->hDst))
+				bMove = false;
+			if (bMove)
+				bMove = 0 == rename (pf->szTmp, szDst);
+			if (!bMove)
 			{
-				if (*s1 ++ != *s2 ++)
-					return s1 [-1] < s2 [-1] ? -1 : 1;
+				err = errno;
+				unlink (pf->szTmp);
+				errno = err;
 			}
-			return 0;
 		}
-
 	#endif
-#endif
+	return bMove;
+}
 
-#ifdef UBF_MEM_DEBUG_USE_OUR_DEBUG_FUNCS
-	void *ubf_malloc	(size_t size)
-	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_malloc.htm .
-		void	*pnew;
-	
-		pnew = ubf_memdbg_malloc (size);
-		return pnew;
-	}
+bool ExtCompressFileByName	(
+		const char			*szSrc,
+		const char			*szDst,
+		enextcompressor		cmp,
+		int					level
+							)
+{
+	ubf_assert_non_NULL	(szSrc);
+	ubf_assert_non_NULL	(szDst);
+	ubf_assert			(0 <= cmp);
+	ubf_assert			(cmp < extcompressor_XAmountEnumValues);
 
-	void *ubf_calloc	(size_t nitems, size_t size)
-	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_calloc.htm .
-		void	*pnew;
-	
-		pnew = ubf_memdbg_calloc (nitems, size);
-		return pnew;
+	if (!ExtCompressorAvailable (cmp))
+	{
+		setExtCmpError (true);
+		return false;
 	}
 
-	void *ubf_realloc	(void *ptr, size_t new_size)
-	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_realloc.htm .
-		void	*pnew;
+	size_t			lnDst	= strlen (szDst);
+	EXTCMPFILES		f;
+	bool			b;
 
-		pnew = ubf_memdbg_realloc (ptr, new_size);
-		return pnew;
+	f.pIn = ubf_malloc (2 * EXT_COMPRESSOR_BUF_SIZE + lnDst + sizeof (".tmp"));
+	if (NULL == f.pIn)
+		return false;
+	f.pOut	= f.pIn + EXT_COMPRESSOR_BUF_SIZE;
+	f.szTmp	= (char *) f.pOut + EXT_COMPRESSOR_BUF_SIZE;
+	memcpy (f.szTmp, szDst, lnDst);
+	memcpy (f.szTmp + lnDst, ".tmp", sizeof (".tmp"));
+	f.hSrc	= EXTCMP_INVALID_HANDLE;
+	f.hDst	= EXTCMP_INVALID_HANDLE;
+
+	b = openExtCmpFiles (&f, szSrc);
+	if (b)
+	{
+		switch (cmp)
+		{
+			#ifdef HAVE_ZLIB
+				case extcompressor_gzip:
+					b = compressExtCmpGzip (&f, level);
+					break;
+			#endif
+			#ifdef HAVE_ZSTD
+				case extcompressor_zstd:
+					b = compressExtCmpZstd (&f, level);
+					break;
+			#endif
+			default:
+				UNUSED (level);
+				setExtCmpError (true);
+				b = false;
+				break;
+		}
 	}
+	b = closeExtCmpFiles (&f, szDst, b);
+	ubf_free (f.pIn);
+	return b;
+}
 
-	char *ubf_strdup	(const char *cc)
-	{
-		char		*pchnew;
 
-		pchnew = ubf_memdbg_strdup (cc);			
-		return pchnew;
-	}
-	
-	void ubf_free		(void *ptr)
-	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_free.htm .
-		/*
-			The debug version does not allow a NULL pointer argument. Use
+/*
+	The state of a frame compressor. The output buffer is enlarged when a frame doesn't
+	fit into it.
+*/
+struct extcmpframer
+{
+	enextcompressor		cmp;
+	int					level;
+	char				*pOut;
+	size_t				siz;								// Size of pOut in octets.
+	size_t				len;								// Octets of the frame in pOut.
+	#ifdef HAVE_ZLIB
+		z_stream		zs;
+	#endif
+	#ifdef HAVE_ZSTD
+		ZSTD_CCtx		*cctx;
+	#endif
+};
 
-			#ifdef DEBUG
-				if (p)
-			#endif
-					ubf_free (p);
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+static bool growExtCmpFrameOut (EXTCMPFRAMER *pfr)
+{
+	ubf_assert_non_NULL (pfr);
 
-			or
-				ubf_free_accept_NULL (p)
+	char *pc = ubf_realloc (pfr->pOut, 2 * pfr->siz);
+	if (NULL == pc)
+		return false;
+	pfr->pOut	= pc;
+	pfr->siz	*= 2;
+	return true;
+}
+#endif
 
-			if you expect a NULL pointer to be passed to ubf_free ().
-		*/
-		ubf_assert (UBF_NULL != ptr);
-		ubf_assert (NULL != ptr);
-		ubf_memdbg_free (ptr);
-	}
-	
-	void ubf_free_accept_NULL	(void *ptr)
+#ifdef HAVE_ZLIB
+	/*
+		Deflates lnIn octets of pIn into the output buffer of pfr. The frame is complete
+		when the function returns true for Z_FINISH.
+	*/
+	static bool deflateExtCmpFrame (EXTCMPFRAMER *pfr, const char *pIn, size_t lnIn, int flush)
 	{
-		#ifdef DEBUG
-			if (ptr)
-		#endif
-				ubf_memdbg_free (ptr);
-	}
+		ubf_assert_non_NULL (pfr);
+		// zlib counts in uInt.
+		ubf_assert (lnIn == (uInt) lnIn);
 
-	void *ubf_memcpy	(void *bse, void *dst, const void *src, size_t len)
-	{
-		return ubf_memdbg_memcpy (bse, dst, src, len);
-	}
+		z_stream	*pzs	= &pfr->zs;
+		int			zr;
 
-	void *ubf_memmove	(void *bse, void *dst, const void *src, size_t len)
-	{
-		return ubf_memdbg_memmove (bse, dst, src, len);
-	}
-	
-	void *ubf_memset (void *bse, void *ptr, int value, size_t num)
-	{
-		return ubf_memdbg_memset (bse, ptr, value, num);
-	}
-	
-	int ubf_memcmp (const void *bse, const void *ptr1, const void *ptr2, size_t num)
-	{
-		return ubf_memdbg_memcmp (bse, ptr1, ptr2, num);
+		if (0 == lnIn && Z_FINISH != flush)
+			return true;
+		pzs->next_in	= (Bytef *) pIn;
+		pzs->avail_in	= (uInt) lnIn;
+		for (;;)
+		{
+			if (pfr->len == pfr->siz && !growExtCmpFrameOut (pfr))
+				return false;
+			pzs->next_out	= (Bytef *) pfr->pOut + pfr->len;
+			pzs->avail_out	= (uInt) (pfr->siz - pfr->len);
+			zr = deflate (pzs, flush);
+			pfr->len = pfr->siz - pzs->avail_out;
+			if (Z_STREAM_ERROR == zr)
+				return false;
+			if (Z_FINISH == flush ? Z_STREAM_END == zr : 0 == pzs->avail_in && pzs->avail_out)
+				return true;
+		}
 	}
-	
-	void ubf_mem_init_ptr (void *btm, size_t usize)
+#endif
+
+#ifdef HAVE_ZSTD
+	/*
+		Compresses lnIn octets of pIn into the output buffer of pfr. The frame is complete
+		when the function returns true for ZSTD_e_end.
+	*/
+	static bool zstdExtCmpFrame (EXTCMPFRAMER *pfr, const char *pIn, size_t lnIn, ZSTD_EndDirective mode)
 	{
-		ubf_memdbg_fill_alloc_guards_botm (btm, usize);
+		ubf_assert_non_NULL (pfr);
+
+		ZSTD_inBuffer		zin;
+		ZSTD_outBuffer		zout;
+		size_t				zr;
+
+		if (0 == lnIn && ZSTD_e_end != mode)
+			return true;
+		zin.src		= pIn;
+		zin.size	= lnIn;
+		zin.pos		= 0;
+		for (;;)
+		{
+			if (pfr->len == pfr->siz && !growExtCmpFrameOut (pfr))
+				return false;
+			zout.dst	= pfr->pOut;
+			zout.size	= pfr->siz;
+			zout.pos	= pfr->len;
+			zr = ZSTD_compressStream2 (pfr->cctx, &zout, &zin, mode);
+			pfr->len = zout.pos;
+			if (ZSTD_isError (zr))
+				return false;
+			// With ZSTD_e_end, zr is the amount of octets still to be flushed.
+			if (ZSTD_e_end == mode ? 0 == zr : zin.pos == zin.size)
+				return true;
+		}
 	}
-	
-	void *ubf_mem_usr_ptr (void *btm)
+#endif
+
+EXTCMPFRAMER *CreateEXTCMPFRAMER (enextcompressor cmp, int level)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	if (!ExtCompressorAvailable (cmp))
 	{
-		ubf_memdbg_check_alloc_guards_botm (btm);
-		return ubf_memdbg_get_base_from_botm (btm);
+		setExtCmpError (true);
+		return NULL;
 	}
-	
-	void ubf_mem_chk_ptr (void *btm)
-	{
-		ubf_memdbg_check_alloc_guards_botm (btm);
+
+	EXTCMPFRAMER *pfr = ubf_malloc (sizeof (EXTCMPFRAMER));
+	if (NULL == pfr)
+		return NULL;
+	memset (pfr, 0, sizeof (EXTCMPFRAMER));
+	pfr->cmp	= cmp;
+	pfr->level	= level;
+	pfr->pOut	= ubf_malloc (EXT_COMPRESSOR_BUF_SIZE);
+	if (NULL == pfr->pOut)
+		goto Failed;
+	pfr->siz	= EXT_COMPRESSOR_BUF_SIZE;
+	switch (cmp)
+	{
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+					level = Z_DEFAULT_COMPRESSION;
+				// 15 + 16 selects a window of 32 KiB and a gzip header and trailer.
+				if (Z_OK != deflateInit2 (&pfr->zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY))
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				pfr->cctx = ZSTD_createCCtx ();
+				if (NULL == pfr->cctx)
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+					level = ZSTD_CLEVEL_DEFAULT;
+				ZSTD_CCtx_setParameter (pfr->cctx, ZSTD_c_compressionLevel, level);
+				ZSTD_CCtx_setParameter (pfr->cctx, ZSTD_c_checksumFlag, 1);
+				break;
+		#endif
+		default:
+			UNUSED (level);
+			break;
 	}
-	
-	void ubf_mem_chk_bse (void *bse)
+	return pfr;
+
+Failed:
+	DoneEXTCMPFRAMER (pfr);
+	return NULL;
+}
+
+void DoneEXTCMPFRAMER (EXTCMPFRAMER *pfr)
+{
+	if (NULL == pfr)
+		return;
+	switch (pfr->cmp)
 	{
-		ubf_memdbg_check_alloc_guards_base (bse);
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				// Also fine if deflateInit2 () failed.
+				deflateEnd (&pfr->zs);
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				ZSTD_freeCCtx (pfr->cctx);
+				break;
+		#endif
+		default:
+			break;
 	}
-	
-	void ubf_mem_test_memdbg (void)
+	ubf_free_accept_NULL (pfr->pOut);
+	ubf_free (pfr);
+}
+
+const char *ExtCompressFrame	(
+		EXTCMPFRAMER		*pfr,
+		const char			*p1,
+		size_t				ln1,
+		const char			*p2,
+		size_t				ln2,
+		size_t				*plnFrame
+								)
+{
+	ubf_assert_non_NULL (pfr);
+	ubf_assert_non_NULL (plnFrame);
+
+	bool b;
+
+	pfr->len = 0;
+	switch (pfr->cmp)
 	{
-		ubf_memdbg_test_module ();
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				// Every frame is a gzip member of its own.
+				b =		Z_OK == deflateReset (&pfr->zs)
+					&&	deflateExtCmpFrame (pfr, p1, ln1, Z_NO_FLUSH)
+					&&	deflateExtCmpFrame (pfr, p2, ln2, Z_FINISH);
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				// The parameters are kept. The frame header gets the content size.
+				b =		!ZSTD_isError (ZSTD_CCtx_reset (pfr->cctx, ZSTD_reset_session_only))
+					&&	!ZSTD_isError (ZSTD_CCtx_setPledgedSrcSize (pfr->cctx, ln1 + ln2))
+					&&	zstdExtCmpFrame (pfr, p1, ln1, ZSTD_e_continue)
+					&&	zstdExtCmpFrame (pfr, p2, ln2, ZSTD_e_end);
+				break;
+		#endif
+		default:
+			UNUSED (p1);
+			UNUSED (ln1);
+			UNUSED (p2);
+			UNUSED (ln2);
+			b = false;
+			break;
 	}
-	
-	void ubf_mem_done (void)
+	if (!b)
 	{
-	
+		setExtCmpError (false);
+		return NULL;
 	}
-#endif
+	*plnFrame = pfr->len;
+	return pfr->pOut;
+}
 
-#ifdef OS_IS_WINDOWS
-	#ifdef DEBUG
-	void *ubf_aligned_malloc_intern (size_t alignment, size_t size)
-	{	// It's easy to confuse the parameters. The first one's the alignment, the second one
-		//	is the size of the memory block to allocate. We assume here that size is always
-		//	greater or equal to alignment. Maybe this catches some bugs.
-		ASSERT (size >= alignment);								// Parameters confused?
-		return _aligned_malloc (alignment, size);
-	}
-	#else
-		// Covered in the header.
-		//return _aligned_malloc (alignment, size);
-	#endif
-#else
-	// POSIX.
-	#include <stdlib.h>
-	
-	void *ubf_aligned_malloc_intern (size_t alignment, size_t size)
+#ifdef HAVE_ZLIB
+	/*
+		Inflates the gzip members of the source file of pf one after the other. The offset
+		behind the last complete member is written to *pullValid, the size of the file to
+		*pullSize.
+	*/
+	static bool scanExtCmpGzipFrames (EXTCMPFILES *pf, uint64_t *pullValid, uint64_t *pullSize)
 	{
-		void	*pRet = NULL;
-		
-		// It's easy to confuse the parameters. The first one's the alignment, the second one
-		//	is the size of the memory block to allocate. We assume here that size is always
-		//	greater or equal to alignment. Maybe this catches some bugs.
-		ASSERT (size >= alignment);								// Parameters confused?
-		// See http://pubs.opengroup.org/onlinepubs/9699919799/functions/posix_memalign.html .
-		if (posix_memalign (&pRet, alignment, size))
-			return NULL;
-		return pRet;
+		ubf_assert_non_NULL (pf);
+		ubf_assert_non_NULL (pullValid);
+		ubf_assert_non_NULL (pullSize);
+
+		z_stream	zs;
+		size_t		stRead;
+		bool		bFrames	= true;
+		int			zr;
+
+		memset (&zs, 0, sizeof (zs));
+		// 15 + 16 expects a window of up to 32 KiB and a gzip header and trailer.
+		if (Z_OK != inflateInit2 (&zs, 15 + 16))
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		*pullValid	= 0;
+		*pullSize	= 0;
+		for (;;)
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+			{
+				inflateEnd (&zs);
+				return false;
+			}
+			if (0 == stRead)
+				break;
+			*pullSize	+= stRead;
+			zs.next_in	= pf->pIn;
+			zs.avail_in	= (uInt) stRead;
+			// Once the data isn't a gzip member anymore we only obtain the file size.
+			while (bFrames && (zs.avail_in || 0 == zs.avail_out))
+			{
+				zs.next_out		= pf->pOut;
+				zs.avail_out	= EXT_COMPRESSOR_BUF_SIZE;
+				zr = inflate (&zs, Z_NO_FLUSH);
+				if (Z_STREAM_END == zr)
+				{
+					*pullValid = *pullSize - zs.avail_in;
+					inflateReset (&zs);
+				} else
+				if (Z_OK != zr)
+					bFrames = false;
+			}
+		}
+		inflateEnd (&zs);
+		return true;
 	}
 #endif
 
-#ifdef DEBUG
+#ifdef HAVE_ZSTD
 	/*
-	void *ubf_alloca (size_t size)
+		Decompresses the zstd frames of the source file of pf one after the other. The
+		offset behind the last complete frame is written to *pullValid, the size of the file
+		to *pullSize.
+	*/
+	static bool scanExtCmpZstdFrames (EXTCMPFILES *pf, uint64_t *pullValid, uint64_t *pullSize)
 	{
-		return alloca (size);
+		ubf_assert_non_NULL (pf);
+		ubf_assert_non_NULL (pullValid);
+		ubf_assert_non_NULL (pullSize);
+
+		ZSTD_DCtx		*dctx;
+		ZSTD_inBuffer	zin;
+		ZSTD_outBuffer	zout;
+		size_t			stRead;
+		size_t			zr;
+		bool			bFrames	= true;
+
+		dctx = ZSTD_createDCtx ();
+		if (NULL == dctx)
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		*pullValid	= 0;
+		*pullSize	= 0;
+		zout.dst	= pf->pOut;
+		zout.size	= EXT_COMPRESSOR_BUF_SIZE;
+		zout.pos	= 0;
+		for (;;)
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+			{
+				ZSTD_freeDCtx (dctx);
+				return false;
+			}
+			if (0 == stRead)
+				break;
+			*pullSize	+= stRead;
+			zin.src		= pf->pIn;
+			zin.size	= stRead;
+			zin.pos		= 0;
+			// Once the data isn't a zstd frame anymore we only obtain the file size.
+			while (bFrames && (zin.pos < zin.size || zout.pos == zout.size))
+			{
+				zout.pos = 0;
+				zr = ZSTD_decompressStream (dctx, &zout, &zin);
+				if (ZSTD_isError (zr))
+					bFrames = false;
+				else
+				if (0 == zr)
+					*pullValid = *pullSize - (zin.size - zin.pos);
+			}
+		}
+		ZSTD_freeDCtx (dctx);
+		return true;
 	}
-	*/
 #endif
 
-void *ubf_memdup (const void *mem, size_t len)
-{
-	void	*dup;
-	
-	dup = ubf_malloc (len);
-	if (dup)
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+	/*
+		Returns true if the source file of pf starts with the magic number of a frame of the
+		compressor cmp. The file position is reset to the start of the file.
+	*/
+	static bool hasExtCmpFrameMagic (EXTCMPFILES *pf, enextcompressor cmp)
 	{
-		if (len)
-			memcpy (dup, mem, len);
+		ubf_assert_non_NULL (pf);
+
+		static const unsigned char	ucGzip [] = {0x1F, 0x8B};
+		static const unsigned char	ucZstd [] = {0x28, 0xB5, 0x2F, 0xFD};
+		const unsigned char			*puc	= extcompressor_gzip == cmp ? ucGzip : ucZstd;
+		size_t						ln		=
+			extcompressor_gzip == cmp ? sizeof (ucGzip) : sizeof (ucZstd);
+		size_t						stRead;
+		bool						b;
+
+		b = readExtCmpSrc (pf, &stRead) && stRead >= ln && 0 == memcmp (pf->pIn, puc, ln);
+		#ifdef OS_IS_WINDOWS
+			LARGE_INTEGER li;
+			li.QuadPart = 0;
+			SetFilePointerEx (pf->hSrc, li, NULL, FILE_BEGIN);
+		#else
+			lseek (pf->hSrc, 0, SEEK_SET);
+		#endif
+		return b;
 	}
-	return dup;
-}
 
-void *ubf_memdup_siz (const void *mem, size_t len, size_t siz)
-{
-	void	*dup;
-	
-	//ubf_assert (siz >= len);
-	
-	dup = ubf_malloc (siz);
-	if (dup)
+	/*
+		Cuts the file szFile off after ullValid octets.
+	*/
+	static bool truncateExtCmpFile (const char *szFile, uint64_t ullValid)
 	{
-		if (len && siz > len)
-			memcpy (dup, mem, len);
+		ubf_assert_non_NULL (szFile);
+
+		#ifdef OS_IS_WINDOWS
+			HANDLE			h;
+			LARGE_INTEGER	li;
+			bool			b;
+
+			h = CreateFileU8	(
+					szFile, GENERIC_WRITE,
+					FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+					NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+								);
+			if (INVALID_HANDLE_VALUE == h)
+				return false;
+			li.QuadPart = (LONGLONG) ullValid;
+			b = SetFilePointerEx (h, li, NULL, FILE_BEGIN) && SetEndOfFile (h);
+			CloseHandle (h);
+			return b;
+		#else
+			return 0 == truncate (szFile, (off_t) ullValid);
+		#endif
 	}
-	return dup;
-}
-/****************************************************************************************
+#endif
 
-	File:		bulkmalloc.c
-	Why:		Functions for bulk dynamic memory handling.
-	OS:			C99
-	Author:		Thomas
-	Created:	2021-07-29
+bool ExtCompressFramesRepairFile (EXTCMPFRAMER *pfr, const char *szFile)
+{
+	ubf_assert_non_NULL (pfr);
+	ubf_assert_non_NULL (szFile);
 
-History
--------
+	#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+		EXTCMPFILES		f;
+		uint64_t		ullValid	= 0;
+		uint64_t		ullSize		= 0;
+		bool			bMagic;
+		bool			b;
 
-When		Who				What
------------------------------------------------------------------------------------------
-2021-07-29	Thomas			Created.
+		f.pIn = ubf_malloc (2 * EXT_COMPRESSOR_BUF_SIZE);
+		if (NULL == f.pIn)
+			return false;
+		f.pOut	= f.pIn + EXT_COMPRESSOR_BUF_SIZE;
+		f.szTmp	= NULL;
+		f.hDst	= EXTCMP_INVALID_HANDLE;
+		#ifdef OS_IS_WINDOWS
+			f.hSrc = CreateFileU8	(
+							szFile, GENERIC_READ,
+							FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+									);
+			if (EXTCMP_INVALID_HANDLE == f.hSrc)
+			{
+				ubf_free (f.pIn);
+				return ERROR_FILE_NOT_FOUND == GetLastError ();
+			}
+		#else
+			f.hSrc = open (szFile, O_RDONLY | O_CLOEXEC);
+			if (EXTCMP_INVALID_HANDLE == f.hSrc)
+			{
+				ubf_free (f.pIn);
+				return ENOENT == errno;
+			}
+		#endif
+		bMagic = hasExtCmpFrameMagic (&f, pfr->cmp);
+		switch (pfr->cmp)
+		{
+			#ifdef HAVE_ZLIB
+				case extcompressor_gzip:
+					b = scanExtCmpGzipFrames (&f, &ullValid, &ullSize);
+					break;
+			#endif
+			#ifdef HAVE_ZSTD
+				case extcompressor_zstd:
+					b = scanExtCmpZstdFrames (&f, &ullValid, &ullSize);
+					break;
+			#endif
+			default:
+				setExtCmpError (true);
+				b = false;
+				break;
+		}
+		#ifdef OS_IS_WINDOWS
+			CloseHandle (f.hSrc);
+		#else
+			close (f.hSrc);
+		#endif
+		ubf_free (f.pIn);
+		if (!b || ullValid == ullSize)
+			return b;
+		// A file that starts with a frame is ours. Only its end is torn.
+		if (ullValid || bMagic)
+			return truncateExtCmpFile (szFile, ullValid);
+		return ExtCompressFileByName (szFile, szFile, pfr->cmp, pfr->level);
+	#else
+		UNUSED (pfr);
+		UNUSED (szFile);
+		setExtCmpError (true);
+		return false;
+	#endif
+}
+/****************************************************************************************
+
+	File:		ubfmem.c
+	Why:		Functions for memory handling.
+	OS:			C99
+	Author:		Thomas
+	Created:	2016-10-31
+  
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2016-10-31	Thomas			Created.
 
 ****************************************************************************************/
 
@@ -8683,7 +9288,7 @@ When		Who				What
 	The above copyright notice and this permission notice shall be included in all copies
 	or substantial portions of the Software.
 
-	THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
 	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
 	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
 	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
@@ -8691,1058 +9296,1000 @@ When		Who				What
 	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include <stdbool.h>
-#include <inttypes.h>
-#include <stdio.h>
+#ifdef _MSC_VER
+	#include <crtdbg.h>
+#else
+	// We need this if the Microsoft compiler is not used.
+	#include <assert.h>
+#endif
+
+#include <malloc.h>
 #include <string.h>
 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
-	#include "./bulkmalloc.h"
 	#include "./ubfmem.h"
 
-	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
-		#include "./ArrayMacros.h"
-		#include "./ubf_date_and_time.h"
-		#include "./ubfdebug.h"
-	#else
-		#include "./../pre/ArrayMacros.h"
-		#include "./../datetime/ubf_date_and_time.h"
+	#ifdef UBF_MEM_DEBUG_USE_OUR_DEBUG_FUNCS
 		#include "./../dbg/ubfdebug.h"
-	#endif
-
-	#ifdef BUILD_BULKMALLOC_TEST_FUNCTIONS
-		#include <stdio.h>
+		#include "./../mem/ubfmemdebug.h"
 	#endif
 
 #endif
 
-static void AssertAlignment (uint16_t alignment)
-{
-	ubf_assert	(
-						   0 == alignment
-					||	   1 == alignment
-					||	   8 == alignment
-					||	  16 == alignment
-					||	  32 == alignment
-					||	  64 == alignment
-					||	 128 == alignment
-					||	 256 == alignment
-					||	 512 == alignment
-					||	1024 == alignment
-					||	2048 == alignment
-					||	4096 == alignment
-				);
-	UNREFERENCED_PARAMETER (alignment);
-}
+#ifdef _WIN32
+	#ifdef USE_WINDOWS_NATIVE_HEAP_FUNCTIONS
+		#include <windows.h>
 
-size_t CalculateSizeFromUnit (size_t size, enum en_sbulkmem_unit unit)
-{
-	size_t		stRet	= 0;
+		/*
+		void *memset (void *ptr, int value, size_t num)
+		{
+			char *p = ptr;
 
-	ubf_assert ((size_t) -1 != size);
-	// Some assertions aboout the unit constants.
-	ubf_assert (EN_SBULKMEM_UNIT_BYTES == EN_SBULKMEM_UNIT_OCTETS);
-	ubf_assert (EN_SBULKMEM_UNIT_KiB > EN_SBULKMEM_UNIT_BYTES);
-	ubf_assert (EN_SBULKMEM_UNIT_MiB > EN_SBULKMEM_UNIT_KiB);
-	ubf_assert (EN_SBULKMEM_UNIT_GiB > EN_SBULKMEM_UNIT_MiB);
-	if (size)
-	{
-		stRet = size;
-		stRet *= unit >= EN_SBULKMEM_UNIT_KiB ? 1024 : 1;
-		stRet *= unit >= EN_SBULKMEM_UNIT_MiB ? 1024 : 1;
-		stRet *= unit >= EN_SBULKMEM_UNIT_GiB ? 1024 : 1;
-	} else
-	{
-		stRet = DEFAULT_SBULKMEM_SIZE;
-	}
-	return stRet;
-}
+			while (num-- > 0)
+				*p ++ = value;
+			return ptr;
+		}
+		*/
 
-size_t CalculateAlignedSize (size_t size, uint16_t alignment)
-{
-	size_t	stRequested;
+		/*
+			memcpy
+			memcmp
 
-	ubf_assert ((size_t) -1 != size);
-	switch (alignment)
-	{
-		case 1:
-			stRequested = size;
-			break;
-		case 0:
-			alignment = DEFAULT_SBULKMEM_ALIGNMENT;
-		default:
-			AssertAlignment (alignment);
-			stRequested = ALIGNED_SIZE (size, alignment);
-			break;
+			Because we are not using the run-time library to obtain a small executable size we
+			got to provide our own standard functions.
+		*/
+		/*
+		void *memcpy (void *dest, const void *src, size_t len)
+		{
+			char *d = dest;
+			const char *s = src;
+
+			while (len--)
+			{
+				*d++ = *s++;
+			}
+			return dest;
+		}
+		*/
+
+		int memcmp (const void *str1, const void *str2, size_t count)
+		{
+			const unsigned char *s1 = (const unsigned char*) str1;
+			const unsigned char *s2 = (const unsigned char*) str2;
+
+			while (count-- > 0)
+			{
+				if (*s1 ++ != *s2 ++)
+					return s1 [-1] < s2 [-1] ? -1 : 1;
+			}
+			return 0;
+		}
+
+	#endif
+#endif
+
+#ifdef UBF_MEM_DEBUG_USE_OUR_DEBUG_FUNCS
+	void *ubf_malloc	(size_t size)
+	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_malloc.htm .
+		void	*pnew;
+	
+		pnew = ubf_memdbg_malloc (size);
+		return pnew;
 	}
-	return stRequested;
-}
 
-void *AlignMemblock (void *pBlock, size_t size, uint16_t alignment)
-{
-	size_t	asize = CalculateAlignedSize (size, alignment);
-	ubf_assert (asize >= size);
+	void *ubf_calloc	(size_t nitems, size_t size)
+	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_calloc.htm .
+		void	*pnew;
+	
+		pnew = ubf_memdbg_calloc (nitems, size);
+		return pnew;
+	}
 
-	char	*p	= pBlock;
-	p += asize - size;
-	return p;
-}
+	void *ubf_realloc	(void *ptr, size_t new_size)
+	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_realloc.htm .
+		void	*pnew;
 
-#ifdef DEBUG
-	void InitSBULKMEM (SBULKMEM *pPlinth, size_t defaultSize)
+		pnew = ubf_memdbg_realloc (ptr, new_size);
+		return pnew;
+	}
+
+	char *ubf_strdup	(const char *cc)
 	{
-		ubf_assert_non_NULL (pPlinth);
+		char		*pchnew;
 
-		pPlinth->psbulkFirst	=	NULL;
-		pPlinth->psbulkLast		=	NULL;
-		pPlinth->stDefaultSize		= defaultSize;
-		pPlinth->uiFlags			= 0;
-		#ifdef BUILD_POPSBULKMEM
-			pPlinth->psbulkLastUsed	= NULL;
-		#endif
+		pchnew = ubf_memdbg_strdup (cc);			
+		return pchnew;
 	}
-#endif
+	
+	void ubf_free		(void *ptr)
+	{	// See https://www.tutorialspoint.com/c_standard_library/c_function_free.htm .
+		/*
+			The debug version does not allow a NULL pointer argument. Use
 
-SBULKMEM *AllocInitSBULKMEM	(
-			SBULKMEM						*pPlinth,
-			size_t							stDefaultSize
-							)
-{
-	SBULKMEM	*plinth;
-	size_t		stTotal;
-	size_t		stSBULKMEM			= ALIGNED_SIZE (sizeof (SBULKMEM), DEFAULT_SBULKMEM_ALIGNMENT);
-	size_t		stSBULKMEMBLOCK		= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
-	size_t		stMemblockSize		= ALIGNED_SIZE (stDefaultSize, DEFAULT_SBULKMEM_ALIGNMENT);
+			#ifdef DEBUG
+				if (p)
+			#endif
+					ubf_free (p);
 
-	ubf_assert (0 != stDefaultSize);
-	ubf_assert ((size_t) -1 != stDefaultSize);
-	ubf_assert (1 == sizeof (char));
-	ubf_assert (1 == sizeof (uint8_t));
+			or
+				ubf_free_accept_NULL (p)
 
-	if (pPlinth)
+			if you expect a NULL pointer to be passed to ubf_free ().
+		*/
+		ubf_assert (UBF_NULL != ptr);
+		ubf_assert (NULL != ptr);
+		ubf_memdbg_free (ptr);
+	}
+	
+	void ubf_free_accept_NULL	(void *ptr)
 	{
-		plinth = pPlinth;
-		if (pPlinth->psbulkFirst)
-		{
-			GrowSBULKMEM (plinth, 0);
-		} else
-		{
-			SBULKMEMBLOCK		*pbm;
-			
-			stTotal								= stSBULKMEMBLOCK + stMemblockSize;
-			plinth->uiFlags						= 0;
-			plinth->stDefaultSize				= stMemblockSize;
-			pbm = ubf_malloc (stTotal);
-			if (pbm)
-			{
-				char			*pWork;							// Just a pointer to work with.
-	
-				pWork = (char *) pbm;
-				pWork += stSBULKMEMBLOCK;
-				plinth->psbulkFirst				= pbm;
-				plinth->psbulkLast				= pbm;
-				pbm->uiFlags					= USBM_STRUCT_ALLOCATED | USBM_STRUCT_INITIALISED;
-				pbm->pMemBlockBase				= pWork;
-				pbm->pNextAvailable				= pWork;
-				pbm->pNextElement				= NULL;
-				pbm->stSize						= stMemblockSize;
-				pbm->stFreeSize					= stMemblockSize;
-			} else
-			{
-				plinth->psbulkFirst				= NULL;
-				plinth->psbulkLast				= NULL;
-			}
-		}
-	} else
-	{
-		stTotal									= stSBULKMEM + stSBULKMEMBLOCK + stMemblockSize;
-		plinth = ubf_malloc (stTotal);
-		if (plinth)
-		{
-			char			*pWork;							// Just a pointer to work with.
-	
-			plinth->uiFlags						= USBM_STRUCT_ALLOCATED | USBM_STRUCT_INITIALISED;
-			plinth->stDefaultSize				= stMemblockSize;
-			pWork = (char *) plinth;
-			pWork += stSBULKMEM;
-			plinth->psbulkFirst					= (SBULKMEMBLOCK *) pWork;
-			plinth->psbulkLast					= (SBULKMEMBLOCK *) pWork;
-			plinth->psbulkFirst->pMemBlockBase	= (void *) (pWork + stSBULKMEM + stSBULKMEMBLOCK);
-			plinth->psbulkFirst->pNextAvailable	= (void *) (pWork + stSBULKMEM + stSBULKMEMBLOCK);
-			plinth->psbulkFirst->pNextElement	= NULL;
-			plinth->psbulkFirst->stSize			= stMemblockSize;
-			plinth->psbulkFirst->stFreeSize		= stMemblockSize;
-			plinth->psbulkFirst->uiFlags		= 0;
-		#ifdef BUILD_POPSBULKMEM
-			plinth->psbulkLastUsed				= NULL;
+		#ifdef DEBUG
+			if (ptr)
 		#endif
-		}
+				ubf_memdbg_free (ptr);
 	}
-	return plinth;
-}
-
-void EmptySBULKMEM (SBULKMEM *pPlinth)
-{
-	ubf_assert_non_NULL (pPlinth);
 
-	SBULKMEMBLOCK *p = pPlinth->psbulkFirst;
-	while (p)
+	void *ubf_memcpy	(void *bse, void *dst, const void *src, size_t len)
 	{
-		p->pNextAvailable		= p->pMemBlockBase;
-		p->stFreeSize			= p->stSize;
-		p						= p->pNextElement;
+		return ubf_memdbg_memcpy (bse, dst, src, len);
 	}
-	#ifdef BUILD_POPSBULKMEM
-		pPlinth->psbulkLastUsed	= NULL;
-	#endif
-}
-
-SBULKMEM *DoneSBULKMEM (SBULKMEM *pPlinth)
-{
-	SBULKMEMBLOCK	*p;
-	SBULKMEMBLOCK	*l;
 
-	ubf_assert (NULL != pPlinth);
-	p = pPlinth->psbulkFirst;
-	while (p)
+	void *ubf_memmove	(void *bse, void *dst, const void *src, size_t len)
 	{
-		if (p->uiFlags & USBM_MEM_BLOCK_ALLOCATED && p->pMemBlockBase)
-		{
-			ubf_free (p->pMemBlockBase);
-		}
-		l = p;
-		p = p->pNextElement;
-		if (l->uiFlags & USBM_STRUCT_ALLOCATED)
-			ubf_free (l);
+		return ubf_memdbg_memmove (bse, dst, src, len);
 	}
-	if (pPlinth->uiFlags & USBM_MEM_BLOCK_ALLOCATED)
+	
+	void *ubf_memset (void *bse, void *ptr, int value, size_t num)
 	{
-		ubf_free (pPlinth);
-		return NULL;
+		return ubf_memdbg_memset (bse, ptr, value, num);
+	}
+	
+	int ubf_memcmp (const void *bse, const void *ptr1, const void *ptr2, size_t num)
+	{
+		return ubf_memdbg_memcmp (bse, ptr1, ptr2, num);
+	}
+	
+	void ubf_mem_init_ptr (void *btm, size_t usize)
+	{
+		ubf_memdbg_fill_alloc_guards_botm (btm, usize);
+	}
+	
+	void *ubf_mem_usr_ptr (void *btm)
+	{
+		ubf_memdbg_check_alloc_guards_botm (btm);
+		return ubf_memdbg_get_base_from_botm (btm);
+	}
+	
+	void ubf_mem_chk_ptr (void *btm)
+	{
+		ubf_memdbg_check_alloc_guards_botm (btm);
+	}
+	
+	void ubf_mem_chk_bse (void *bse)
+	{
+		ubf_memdbg_check_alloc_guards_base (bse);
+	}
+	
+	void ubf_mem_test_memdbg (void)
+	{
+		ubf_memdbg_test_module ();
+	}
+	
+	void ubf_mem_done (void)
+	{
+	
 	}
-	pPlinth->psbulkFirst	= NULL;
-	pPlinth->psbulkLast		= NULL;
-#ifdef BUILD_POPSBULKMEM
-	pPlinth->psbulkLastUsed	= NULL;
 #endif
-	return pPlinth;
-}
 
-void AddSBULKMEMBLOCKtoPlinth (SBULKMEM *pPlinth, SBULKMEMBLOCK *pnew)
-{
-	ubf_assert_non_NULL (pPlinth);
-	ubf_assert_non_NULL (pnew);
+#ifdef OS_IS_WINDOWS
+	#ifdef DEBUG
+	void *ubf_aligned_malloc_intern (size_t alignment, size_t size)
+	{	// It's easy to confuse the parameters. The first one's the alignment, the second one
+		//	is the size of the memory block to allocate. We assume here that size is always
+		//	greater or equal to alignment. Maybe this catches some bugs.
+		ASSERT (size >= alignment);								// Parameters confused?
+		return _aligned_malloc (alignment, size);
+	}
+	#else
+		// Covered in the header.
+		//return _aligned_malloc (alignment, size);
+	#endif
+#else
+	// POSIX.
+	#include <stdlib.h>
 	
-	if (pPlinth->psbulkLast)
+	void *ubf_aligned_malloc_intern (size_t alignment, size_t size)
 	{
-		pPlinth->psbulkLast->pNextElement		= pnew;
-		pPlinth->psbulkLast						= pnew;
-	} else
+		void	*pRet = NULL;
+		
+		// It's easy to confuse the parameters. The first one's the alignment, the second one
+		//	is the size of the memory block to allocate. We assume here that size is always
+		//	greater or equal to alignment. Maybe this catches some bugs.
+		ASSERT (size >= alignment);								// Parameters confused?
+		// See http://pubs.opengroup.org/onlinepubs/9699919799/functions/posix_memalign.html .
+		if (posix_memalign (&pRet, alignment, size))
+			return NULL;
+		return pRet;
+	}
+#endif
+
+#ifdef DEBUG
+	/*
+	void *ubf_alloca (size_t size)
 	{
-		pPlinth->psbulkFirst					= pnew;
-		pPlinth->psbulkLast						= pnew;
+		return alloca (size);
 	}
-}
+	*/
+#endif
 
-SBULKMEMBLOCK *AllocAndAddEmptySBULKMEMBLOCK (SBULKMEM *pPlinth)
+void *ubf_memdup (const void *mem, size_t len)
 {
-	SBULKMEMBLOCK	*pnew;
-	size_t			stSBULKMEMBLOCK	= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
-
-	ubf_assert_non_NULL (pPlinth);
-	pnew = ubf_malloc (stSBULKMEMBLOCK);
-	if (pnew)
+	void	*dup;
+	
+	dup = ubf_malloc (len);
+	if (dup)
 	{
-		pnew->uiFlags							= USBM_STRUCT_ALLOCATED;
-		pnew->pMemBlockBase						= NULL;
-		pnew->pNextAvailable					= NULL;
-		pnew->pNextElement						= NULL;
-		pnew->stFreeSize						= 0;
-		pnew->stSize							= 0;
-		AddSBULKMEMBLOCKtoPlinth (pPlinth, pnew);
+		if (len)
+			memcpy (dup, mem, len);
 	}
-	return pnew;
+	return dup;
 }
 
-SBULKMEMBLOCK *GrowSBULKMEM	(
-			SBULKMEM						*pPlinth,
-			size_t							size
-							)
+void *ubf_memdup_siz (const void *mem, size_t len, size_t siz)
 {
-	SBULKMEMBLOCK	*pnew;
-
-	ubf_assert_non_NULL (pPlinth);
-	ubf_assert ((size_t) -1 != size);
-
-	if (size <= pPlinth->stDefaultSize)
-		size = pPlinth->stDefaultSize;
-	if (size)
+	void	*dup;
+	
+	//ubf_assert (siz >= len);
+	
+	dup = ubf_malloc (siz);
+	if (dup)
 	{
-		size_t			stSBULKMEMBLOCK	= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
-		size_t			stMemoryBlock	= CalculateAlignedSize (size, DEFAULT_SBULKMEM_ALIGNMENT);
-
-		pnew = ubf_malloc (stSBULKMEMBLOCK + stMemoryBlock);
-		if (pnew)
-		{
-			pnew->uiFlags						= USBM_STRUCT_ALLOCATED;
-			pnew->pMemBlockBase					= ((char *) pnew) + stSBULKMEMBLOCK;
-			pnew->pNextAvailable				= ((char *) pnew) + stSBULKMEMBLOCK;
-			pnew->pNextElement					= NULL;
-			pnew->stSize						= stMemoryBlock;
-			pnew->stFreeSize					= stMemoryBlock;
-			AddSBULKMEMBLOCKtoPlinth (pPlinth, pnew);
-		}
-	} else
-	{	// 0 == size.
-		pnew = AllocAndAddEmptySBULKMEMBLOCK (pPlinth);
+		if (len && siz > len)
+			memcpy (dup, mem, len);
 	}
-	return pnew;
+	return dup;
 }
+/****************************************************************************************
 
-SBULKMEMBLOCK *FindAvailableSizeOrGrow	(
-			SBULKMEM						*p,
-			size_t							size,
-			enum en_sbulkmem_allow_growth	grow
-										)
-{
-	ubf_expect_non_NULL (p);
-	ubf_assert ((size_t) -1 != size);
-
-	SBULKMEMBLOCK	*pbm	= p->psbulkFirst;
+	File:		bulkmalloc.c
+	Why:		Functions for bulk dynamic memory handling.
+	OS:			C99
+	Author:		Thomas
+	Created:	2021-07-29
 
-	while (pbm)
-	{
-		if (size <= pbm->stFreeSize)
-			return pbm;
-		pbm = pbm->pNextElement;
-	}
-	if (EN_SBULKMEM_CANNOT_GROW == grow)
-		return NULL;
-	// Note that size has been aligned here already.
-	pbm = GrowSBULKMEM (p, size);
-	if (pbm)
-	{
-		ubf_assert (pbm->stFreeSize >= size);
-		ubf_assert (pbm->stSize >= size);
-	}
-	return pbm;
-}
+History
+-------
 
-void *GetMemFromSBULKMEMBLOCKifAvailable (SBULKMEMBLOCK *pbm, size_t size)
-{
-	void	*pRet		= NULL;
+When		Who				What
+-----------------------------------------------------------------------------------------
+2021-07-29	Thomas			Created.
 
-	ubf_assert_not_NULL (pbm);
-	ubf_assert ((size_t) -1 != size);
+****************************************************************************************/
 
-	if (pbm->stFreeSize >= size)
-	{
-		pRet			= pbm->pNextAvailable;
-		char	*p		= pRet;
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
 
-		p += size;
-		pbm->pNextAvailable		= p;
-		pbm->stFreeSize			-= size;
-	}
-	return pRet;
-}
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
 
-void *GetMemFromSBULKMEM	(
-			SBULKMEM						*pPlinth,
-			size_t							size,
-			uint8_t							alignment,
-			enum en_sbulkmem_allow_growth	grow
-							)
-{
-	SBULKMEMBLOCK		*pbm;
-	size_t				stRequested;
+	Copyright (c) 2024, 2025 Thomas
 
-	ubf_assert_non_NULL (pPlinth);
-	ubf_assert ((size_t) -1 != size);
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
 
-	AssertAlignment (alignment);
-	stRequested = CalculateAlignedSize (size, alignment);
-	pbm = FindAvailableSizeOrGrow (pPlinth, stRequested, grow);
-	if (pbm)
-	{
-		void *pRet = NULL;
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
 
-		pRet = GetMemFromSBULKMEMBLOCKifAvailable (pbm, stRequested);
-		// Align the returned block.
-		ubf_assert (stRequested >= size);
+	THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
 
-		char *p = pRet;
-		p += stRequested - size;
-		#ifdef BUILD_POPSBULKMEM
-			pPlinth->psbulkLastUsed = pbm;
-		#endif
-		return p;
-	}
-	return NULL;
-}
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 
-/*
-	Copy of GetMemFromSBULKMEM () with the most common parameters.
-	Alignment is 8 for 16 bit CPUs and 16 for 64 bit CPUs, and the block can grow.
-*/
-void *GetAlignedMemFromSBULKMEMgrow	(
-			SBULKMEM						*pPlinth,
-			size_t							size
-										)
-{
-	SBULKMEMBLOCK		*pbm;
-	size_t				stRequested;
+#ifndef CUNILOG_USE_COMBINED_MODULE
 
-	ubf_assert (NULL != pPlinth);
-	ubf_assert ((size_t) -1 != size);
+	#include "./bulkmalloc.h"
+	#include "./ubfmem.h"
 
-	stRequested = ALIGNED_SIZE (size, DEFAULT_SBULKMEM_ALIGNMENT);
-	pbm = FindAvailableSizeOrGrow (pPlinth, stRequested, EN_SBULKMEM_CAN_GROW);
-	if (pbm)
-	{
-		void *pRet = NULL;
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./ArrayMacros.h"
+		#include "./ubf_date_and_time.h"
+		#include "./ubfdebug.h"
+	#else
+		#include "./../pre/ArrayMacros.h"
+		#include "./../datetime/ubf_date_and_time.h"
+		#include "./../dbg/ubfdebug.h"
+	#endif
 
-		pRet = GetMemFromSBULKMEMBLOCKifAvailable (pbm, stRequested);
-		// Align the returned block.
-		ubf_assert (stRequested >= size);
+	#ifdef BUILD_BULKMALLOC_TEST_FUNCTIONS
+		#include <stdio.h>
+	#endif
 
-		char *p = pRet;
-		p += stRequested - size;
-		#ifdef BUILD_POPSBULKMEM
-			pPlinth->psbulkLastUsed = pbm;
-		#endif
-		return p;
-	}
-	return NULL;
-}
+#endif
 
-void *GetAlignedMemFromSBULKMEMnogrow	(
-			SBULKMEM						*pPlinth,
-			size_t							size
-										)
+static void AssertAlignment (uint16_t alignment)
 {
-	ubf_assert (NULL != pPlinth);
-	ubf_assert ((size_t) -1 != size);
-
-	return GetMemFromSBULKMEM (pPlinth, size, DEFAULT_SBULKMEM_ALIGNMENT, EN_SBULKMEM_CANNOT_GROW);
+	ubf_assert	(
+						   0 == alignment
+					||	   1 == alignment
+					||	   8 == alignment
+					||	  16 == alignment
+					||	  32 == alignment
+					||	  64 == alignment
+					||	 128 == alignment
+					||	 256 == alignment
+					||	 512 == alignment
+					||	1024 == alignment
+					||	2048 == alignment
+					||	4096 == alignment
+				);
+	UNREFERENCED_PARAMETER (alignment);
 }
 
-void *GetUnalignedMemFromSBULKMEMgrow	(
-			SBULKMEM						*pPlinth,
-			size_t							size
-										)
+size_t CalculateSizeFromUnit (size_t size, enum en_sbulkmem_unit unit)
 {
-	ubf_assert (NULL != pPlinth);
-	ubf_assert ((size_t) -1 != size);
+	size_t		stRet	= 0;
 
-	return GetMemFromSBULKMEM (pPlinth, size, 1, EN_SBULKMEM_CAN_GROW);
+	ubf_assert ((size_t) -1 != size);
+	// Some assertions aboout the unit constants.
+	ubf_assert (EN_SBULKMEM_UNIT_BYTES == EN_SBULKMEM_UNIT_OCTETS);
+	ubf_assert (EN_SBULKMEM_UNIT_KiB > EN_SBULKMEM_UNIT_BYTES);
+	ubf_assert (EN_SBULKMEM_UNIT_MiB > EN_SBULKMEM_UNIT_KiB);
+	ubf_assert (EN_SBULKMEM_UNIT_GiB > EN_SBULKMEM_UNIT_MiB);
+	if (size)
+	{
+		stRet = size;
+		stRet *= unit >= EN_SBULKMEM_UNIT_KiB ? 1024 : 1;
+		stRet *= unit >= EN_SBULKMEM_UNIT_MiB ? 1024 : 1;
+		stRet *= unit >= EN_SBULKMEM_UNIT_GiB ? 1024 : 1;
+	} else
+	{
+		stRet = DEFAULT_SBULKMEM_SIZE;
+	}
+	return stRet;
 }
 
-void *GetUnalignedMemFromSBULKMEMnogrow	(
-			SBULKMEM						*pPlinth,
-			size_t							size
-										)
+size_t CalculateAlignedSize (size_t size, uint16_t alignment)
 {
-	ubf_assert (NULL != pPlinth);
-	ubf_assert ((size_t) -1 != size);
+	size_t	stRequested;
 
-	return GetMemFromSBULKMEM (pPlinth, size, 1, EN_SBULKMEM_CANNOT_GROW);
+	ubf_assert ((size_t) -1 != size);
+	switch (alignment)
+	{
+		case 1:
+			stRequested = size;
+			break;
+		case 0:
+			alignment = DEFAULT_SBULKMEM_ALIGNMENT;
+		default:
+			AssertAlignment (alignment);
+			stRequested = ALIGNED_SIZE (size, alignment);
+			break;
+	}
+	return stRequested;
 }
 
-void popSBULKMEMBLOCK					(
-			SBULKMEMBLOCK					*pb,
-			size_t							size
-										)
+void *AlignMemblock (void *pBlock, size_t size, uint16_t alignment)
 {
-	ubf_assert_non_NULL (pb);
-	ubf_assert ((char *) pb->pNextAvailable - size >= (char *) pb->pMemBlockBase);
-	
-	pb->pNextAvailable	= (char *) pb->pNextAvailable - size;
-	pb->stFreeSize		+= size;
+	size_t	asize = CalculateAlignedSize (size, alignment);
+	ubf_assert (asize >= size);
+
+	char	*p	= pBlock;
+	p += asize - size;
+	return p;
 }
 
-#ifdef BUILD_POPSBULKMEM
-	void popSBULKMEM						(
-				SBULKMEM						*pPlinth,
-				size_t							size
-											)
+#ifdef DEBUG
+	void InitSBULKMEM (SBULKMEM *pPlinth, size_t defaultSize)
 	{
 		ubf_assert_non_NULL (pPlinth);
-		ubf_assert_non_NULL (pPlinth->psbulkLastUsed);
-		
-		popSBULKMEMBLOCK (pPlinth->psbulkLastUsed, size);
+
+		pPlinth->psbulkFirst	=	NULL;
+		pPlinth->psbulkLast		=	NULL;
+		pPlinth->stDefaultSize		= defaultSize;
+		pPlinth->uiFlags			= 0;
+		#ifdef BUILD_POPSBULKMEM
+			pPlinth->psbulkLastUsed	= NULL;
+		#endif
 	}
 #endif
 
-void getSBULKMEMstats (SBULKMEMSTATS *pStats, SBULKMEM *pPlinth)
+SBULKMEM *AllocInitSBULKMEM	(
+			SBULKMEM						*pPlinth,
+			size_t							stDefaultSize
+							)
+{
+	SBULKMEM	*plinth;
+	size_t		stTotal;
+	size_t		stSBULKMEM			= ALIGNED_SIZE (sizeof (SBULKMEM), DEFAULT_SBULKMEM_ALIGNMENT);
+	size_t		stSBULKMEMBLOCK		= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
+	size_t		stMemblockSize		= ALIGNED_SIZE (stDefaultSize, DEFAULT_SBULKMEM_ALIGNMENT);
+
+	ubf_assert (0 != stDefaultSize);
+	ubf_assert ((size_t) -1 != stDefaultSize);
+	ubf_assert (1 == sizeof (char));
+	ubf_assert (1 == sizeof (uint8_t));
+
+	if (pPlinth)
+	{
+		plinth = pPlinth;
+		if (pPlinth->psbulkFirst)
+		{
+			GrowSBULKMEM (plinth, 0);
+		} else
+		{
+			SBULKMEMBLOCK		*pbm;
+			
+			stTotal								= stSBULKMEMBLOCK + stMemblockSize;
+			plinth->uiFlags						= 0;
+			plinth->stDefaultSize				= stMemblockSize;
+			pbm = ubf_malloc (stTotal);
+			if (pbm)
+			{
+				char			*pWork;							// Just a pointer to work with.
+	
+				pWork = (char *) pbm;
+				pWork += stSBULKMEMBLOCK;
+				plinth->psbulkFirst				= pbm;
+				plinth->psbulkLast				= pbm;
+				pbm->uiFlags					= USBM_STRUCT_ALLOCATED | USBM_STRUCT_INITIALISED;
+				pbm->pMemBlockBase				= pWork;
+				pbm->pNextAvailable				= pWork;
+				pbm->pNextElement				= NULL;
+				pbm->stSize						= stMemblockSize;
+				pbm->stFreeSize					= stMemblockSize;
+			} else
+			{
+				plinth->psbulkFirst				= NULL;
+				plinth->psbulkLast				= NULL;
+			}
+		}
+	} else
+	{
+		stTotal									= stSBULKMEM + stSBULKMEMBLOCK + stMemblockSize;
+		plinth = ubf_malloc (stTotal);
+		if (plinth)
+		{
+			char			*pWork;							// Just a pointer to work with.
+	
+			plinth->uiFlags						= USBM_STRUCT_ALLOCATED | USBM_STRUCT_INITIALISED;
+			plinth->stDefaultSize				= stMemblockSize;
+			pWork = (char *) plinth;
+			pWork += stSBULKMEM;
+			plinth->psbulkFirst					= (SBULKMEMBLOCK *) pWork;
+			plinth->psbulkLast					= (SBULKMEMBLOCK *) pWork;
+			plinth->psbulkFirst->pMemBlockBase	= (void *) (pWork + stSBULKMEM + stSBULKMEMBLOCK);
+			plinth->psbulkFirst->pNextAvailable	= (void *) (pWork + stSBULKMEM + stSBULKMEMBLOCK);
+			plinth->psbulkFirst->pNextElement	= NULL;
+			plinth->psbulkFirst->stSize			= stMemblockSize;
+			plinth->psbulkFirst->stFreeSize		= stMemblockSize;
+			plinth->psbulkFirst->uiFlags		= 0;
+		#ifdef BUILD_POPSBULKMEM
+			plinth->psbulkLastUsed				= NULL;
+		#endif
+		}
+	}
+	return plinth;
+}
+
+void EmptySBULKMEM (SBULKMEM *pPlinth)
 {
-	ubf_assert_non_NULL (pStats);
 	ubf_assert_non_NULL (pPlinth);
 
-	pStats->stDefaultSize		= pPlinth->stDefaultSize;
-	pStats->nSBULKMEMBLOCKs		= 0;
-	pStats->stFreeLargest		= 0;
-	pStats->stFreeSmallest		= (size_t) -1;
-	pStats->stTotal				= 0;
-	pStats->stFreeTotal			= 0;
-	pStats->stFreeAverage		= 0;
+	SBULKMEMBLOCK *p = pPlinth->psbulkFirst;
+	while (p)
+	{
+		p->pNextAvailable		= p->pMemBlockBase;
+		p->stFreeSize			= p->stSize;
+		p						= p->pNextElement;
+	}
+	#ifdef BUILD_POPSBULKMEM
+		pPlinth->psbulkLastUsed	= NULL;
+	#endif
+}
 
-	SBULKMEMBLOCK	*p	= pPlinth->psbulkFirst;
+SBULKMEM *DoneSBULKMEM (SBULKMEM *pPlinth)
+{
+	SBULKMEMBLOCK	*p;
+	SBULKMEMBLOCK	*l;
+
+	ubf_assert (NULL != pPlinth);
+	p = pPlinth->psbulkFirst;
 	while (p)
 	{
-		++ pStats->nSBULKMEMBLOCKs;
-		pStats->stTotal += p->stSize;
-		pStats->stFreeTotal += p->stFreeSize;
-		if (p->stFreeSize > pStats->stFreeLargest)
-			pStats->stFreeLargest = p->stFreeSize;
-		if (p->stFreeSize < pStats->stFreeSmallest)
-			pStats->stFreeSmallest = p->stFreeSize;
+		if (p->uiFlags & USBM_MEM_BLOCK_ALLOCATED && p->pMemBlockBase)
+		{
+			ubf_free (p->pMemBlockBase);
+		}
+		l = p;
 		p = p->pNextElement;
+		if (l->uiFlags & USBM_STRUCT_ALLOCATED)
+			ubf_free (l);
 	}
-	if (pStats->nSBULKMEMBLOCKs)
+	if (pPlinth->uiFlags & USBM_MEM_BLOCK_ALLOCATED)
 	{
-		pStats->stFreeAverage = pStats->stFreeTotal / pStats->nSBULKMEMBLOCKs;
+		ubf_free (pPlinth);
+		return NULL;
+	}
+	pPlinth->psbulkFirst	= NULL;
+	pPlinth->psbulkLast		= NULL;
+#ifdef BUILD_POPSBULKMEM
+	pPlinth->psbulkLastUsed	= NULL;
+#endif
+	return pPlinth;
+}
+
+void AddSBULKMEMBLOCKtoPlinth (SBULKMEM *pPlinth, SBULKMEMBLOCK *pnew)
+{
+	ubf_assert_non_NULL (pPlinth);
+	ubf_assert_non_NULL (pnew);
+	
+	if (pPlinth->psbulkLast)
+	{
+		pPlinth->psbulkLast->pNextElement		= pnew;
+		pPlinth->psbulkLast						= pnew;
 	} else
 	{
-		pStats->stFreeSmallest = 0;
+		pPlinth->psbulkFirst					= pnew;
+		pPlinth->psbulkLast						= pnew;
 	}
 }
 
-#ifdef BUILD_BULKMALLOC_TEST_FUNCTIONS
-	bool bulkmalloc_test_fnct (void)
+SBULKMEMBLOCK *AllocAndAddEmptySBULKMEMBLOCK (SBULKMEM *pPlinth)
+{
+	SBULKMEMBLOCK	*pnew;
+	size_t			stSBULKMEMBLOCK	= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
+
+	ubf_assert_non_NULL (pPlinth);
+	pnew = ubf_malloc (stSBULKMEMBLOCK);
+	if (pnew)
 	{
-		bool			b		= true;
-		SBULKMEM		sbm		= SBULKMEM_INITIALISER (128);
-		//SBULKMEM		*pbm;
-		void			*p;
-		SBULKMEMBLOCK	*pbmb;
+		pnew->uiFlags							= USBM_STRUCT_ALLOCATED;
+		pnew->pMemBlockBase						= NULL;
+		pnew->pNextAvailable					= NULL;
+		pnew->pNextElement						= NULL;
+		pnew->stFreeSize						= 0;
+		pnew->stSize							= 0;
+		AddSBULKMEMBLOCKtoPlinth (pPlinth, pnew);
+	}
+	return pnew;
+}
 
-		// The SBULKMEM structure doesn't have any memory block attached.
-		p = GetUnalignedMemFromSBULKMEMnogrow (&sbm, 1);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
-		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
-		p = GetUnalignedMemFromSBULKMEMnogrow (&sbm, 1024);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
-		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1024);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
-		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1022);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
+SBULKMEMBLOCK *GrowSBULKMEM	(
+			SBULKMEM						*pPlinth,
+			size_t							size
+							)
+{
+	SBULKMEMBLOCK	*pnew;
 
-		pbmb = GrowSBULKMEM (&sbm, 0);
-		ubf_assert_non_NULL (pbmb);
-		b &= NULL != pbmb;
-		pbmb = GrowSBULKMEM (&sbm, 12);
-		ubf_assert_non_NULL (pbmb);
-		b &= NULL != pbmb;
-		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1022);
-		ubf_assert_NULL (p);
-		b &= NULL == p;
-		// This should succeed.
-		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 16);
-		ubf_assert_non_NULL (p);
-		b &= NULL != p;
-		p = GetAlignedMemFromSBULKMEMgrow (&sbm, 12);
-		ubf_assert_non_NULL (p);
-		b &= NULL != p;
+	ubf_assert_non_NULL (pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-		DoneSBULKMEM (&sbm);
+	if (size <= pPlinth->stDefaultSize)
+		size = pPlinth->stDefaultSize;
+	if (size)
+	{
+		size_t			stSBULKMEMBLOCK	= ALIGNED_SIZE (sizeof (SBULKMEMBLOCK), DEFAULT_SBULKMEM_ALIGNMENT);
+		size_t			stMemoryBlock	= CalculateAlignedSize (size, DEFAULT_SBULKMEM_ALIGNMENT);
 
-		p = GetAlignedMemFromSBULKMEMgrow (&sbm, 1024);
-		ubf_assert_non_NULL (p);
-		b &= NULL != p;
-		if (p)
+		pnew = ubf_malloc (stSBULKMEMBLOCK + stMemoryBlock);
+		if (pnew)
 		{
-			memset (p, 0, 1024);
+			pnew->uiFlags						= USBM_STRUCT_ALLOCATED;
+			pnew->pMemBlockBase					= ((char *) pnew) + stSBULKMEMBLOCK;
+			pnew->pNextAvailable				= ((char *) pnew) + stSBULKMEMBLOCK;
+			pnew->pNextElement					= NULL;
+			pnew->stSize						= stMemoryBlock;
+			pnew->stFreeSize					= stMemoryBlock;
+			AddSBULKMEMBLOCKtoPlinth (pPlinth, pnew);
 		}
-		DoneSBULKMEM (&sbm);
-
-		/*
-			Let's compare the two solutions when it comes to speed.
-			We allocate 100 000 memory blocks with 128 octets each, write to the block,
-			then deallocate it again. Method 2) allocates 200 MiB.
+	} else
+	{	// 0 == size.
+		pnew = AllocAndAddEmptySBULKMEMBLOCK (pPlinth);
+	}
+	return pnew;
+}
 
-			1) malloc () and free ()
-			2) AllocInitSBULKMEM (), GetMemFromSBULKMEM (), and DoneSBULKMEM ()
-		*/
-		SBULKMEM	*pTest;
+SBULKMEMBLOCK *FindAvailableSizeOrGrow	(
+			SBULKMEM						*p,
+			size_t							size,
+			enum en_sbulkmem_allow_growth	grow
+										)
+{
+	ubf_expect_non_NULL (p);
+	ubf_assert ((size_t) -1 != size);
 
-		FILETIME	ft1, ft2;
-		uint64_t	ut1, ut2, ut3;
-		uint64_t	u;
+	SBULKMEMBLOCK	*pbm	= p->psbulkFirst;
 
-		GetSystemTimeAsFileTime (&ft1);
-		char *pCh [100000];
-		for (u = 0; u < 100000; ++u)
-		{
-			pCh [u] = malloc (128);
-			if (pCh [u])
-				memset (pCh [u], 0, 128);
-		}
-		for (u = 0; u < 100000; ++u)
-		{
-			free (pCh [u]);
-		}
-		GetSystemTimeAsFileTime (&ft2);
-		ut1 = ft1.dwHighDateTime;
-		ut1 <<= 32;
-		ut1 += ft1.dwLowDateTime;
-		ut2 = ft2.dwHighDateTime;
-		ut2 <<= 32;
-		ut2 += ft2.dwLowDateTime;
-		ut3 = ut2 - ut1;
-		ut3 /= 10000;			// milliseconds.
-		printf ("\nTime taken by malloc ():\t\t %" PRIu64 " ms.\n", ut3);
-
-		GetSystemTimeAsFileTime (&ft1);
-		pTest = AllocInitSBULKMEM (NULL, 200 * 1024 * 1024);
-		if (pTest)
-		{
-			for (u = 0; u < 100000; ++u)
-			{
-				pCh [u] = GetMemFromSBULKMEM (pTest, 128, 0, EN_SBULKMEM_CANNOT_GROW);
-				if (pCh [u])
-					memset (pCh [u], 0, 128);
-			}
-			DoneSBULKMEM (pTest);
-			GetSystemTimeAsFileTime (&ft2);
-			ut1 = ft1.dwHighDateTime;
-			ut1 <<= 32;
-			ut1 += ft1.dwLowDateTime;
-			ut2 = ft2.dwHighDateTime;
-			ut2 <<= 32;
-			ut2 += ft2.dwLowDateTime;
-			ut3 = ut2 - ut1;
-			ut3 /= 10000;			// milliseconds.
-			printf ("Time taken by GetMemFromSBULKMEM ():\t %" PRIu64 " ms.\n", ut3);
-		}
-		/*
-			End of speed comparison.
-		*/
-
-		// Example 1 used for the top of the header file.
-		//	->
-		#define OUR_BULK_DATA_ARRAY_SIZE	(100)
-
-		SBULKMEM	sbulk	= SBULKMEM_INITIALISER (DEFAULT_SBULKMEM_SIZE);
-		void		*pDat2 [OUR_BULK_DATA_ARRAY_SIZE];
-		int			i;
+	while (pbm)
+	{
+		if (size <= pbm->stFreeSize)
+			return pbm;
+		pbm = pbm->pNextElement;
+	}
+	if (EN_SBULKMEM_CANNOT_GROW == grow)
+		return NULL;
+	// Note that size has been aligned here already.
+	pbm = GrowSBULKMEM (p, size);
+	if (pbm)
+	{
+		ubf_assert (pbm->stFreeSize >= size);
+		ubf_assert (pbm->stSize >= size);
+	}
+	return pbm;
+}
 
-		for (i = 0; i < OUR_BULK_DATA_ARRAY_SIZE; ++i)
-		{
-			pDat2 [i] = GetMemFromSBULKMEM (&sbulk, 1024, 8, EN_SBULKMEM_CAN_GROW);
-			if (pDat2 [i])
-			{
-				memset (pDat2 [i], 0xFF, 1024);
-			}
-		}
-		DoneSBULKMEM (&sbulk);
-		//	<-
+void *GetMemFromSBULKMEMBLOCKifAvailable (SBULKMEMBLOCK *pbm, size_t size)
+{
+	void	*pRet		= NULL;
 
-		// Example 2 used for the top of the header file.
-		//	->
-		#define OUR_BULK_DATA_ARRAY_SIZE	(100)
-		SBULKMEM	*pBulk	= AllocInitSBULKMEM (NULL, DEFAULT_SBULKMEM_SIZE);
-		if (pBulk)
-		{
-			void		*pData [OUR_BULK_DATA_ARRAY_SIZE];
-			int			j;
+	ubf_assert_not_NULL (pbm);
+	ubf_assert ((size_t) -1 != size);
 
-			for (j = 0; j < OUR_BULK_DATA_ARRAY_SIZE; ++j)
-			{
-				pData [j] = GetMemFromSBULKMEM (&sbulk, 1024, 0, EN_SBULKMEM_CAN_GROW);
-				if (pData [j])
-				{
-					memset (pData [j], 0xFF, 1024);
-				}
-			}
-			DoneSBULKMEM (&sbulk);
-		}
-		//	<-
+	if (pbm->stFreeSize >= size)
+	{
+		pRet			= pbm->pNextAvailable;
+		char	*p		= pRet;
 
-		return b;
+		p += size;
+		pbm->pNextAvailable		= p;
+		pbm->stFreeSize			-= size;
 	}
-#endif
-/****************************************************************************************
+	return pRet;
+}
 
-	File:		memstrstr.c
-	Created:	?
+void *GetMemFromSBULKMEM	(
+			SBULKMEM						*pPlinth,
+			size_t							size,
+			uint8_t							alignment,
+			enum en_sbulkmem_allow_growth	grow
+							)
+{
+	SBULKMEMBLOCK		*pbm;
+	size_t				stRequested;
 
-History
--------
+	ubf_assert_non_NULL (pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-When		Who				What
------------------------------------------------------------------------------------------
-2014-03-10	Thomas			This history added.
-2016-12-09	Thomas			Definitions for TRUE and FALSE removed.
-2019-10-13	Thomas			Include files moved to the header.
-2024-05-21	Thomas			Function memstrrchr () fixed.
+	AssertAlignment (alignment);
+	stRequested = CalculateAlignedSize (size, alignment);
+	pbm = FindAvailableSizeOrGrow (pPlinth, stRequested, grow);
+	if (pbm)
+	{
+		void *pRet = NULL;
 
-	The original version of this function has been taken from
-	http://www.koders.com/c/fid2330745E0E8C0A0F5E2CF94799642712318471D0.aspx?s=getopt#L459
-	which is buggy and doesn't work under certain circumstances.
+		pRet = GetMemFromSBULKMEMBLOCKifAvailable (pbm, stRequested);
+		// Align the returned block.
+		ubf_assert (stRequested >= size);
 
-****************************************************************************************/
+		char *p = pRet;
+		p += stRequested - size;
+		#ifdef BUILD_POPSBULKMEM
+			pPlinth->psbulkLastUsed = pbm;
+		#endif
+		return p;
+	}
+	return NULL;
+}
 
 /*
-	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+	Copy of GetMemFromSBULKMEM () with the most common parameters.
+	Alignment is 8 for 16 bit CPUs and 16 for 64 bit CPUs, and the block can grow.
 */
+void *GetAlignedMemFromSBULKMEMgrow	(
+			SBULKMEM						*pPlinth,
+			size_t							size
+										)
+{
+	SBULKMEMBLOCK		*pbm;
+	size_t				stRequested;
 
-/*
-	This code is covered by the MIT License. See https://opensource.org/license/mit .
+	ubf_assert (NULL != pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-	Copyright (c) 2024, 2025 Thomas
+	stRequested = ALIGNED_SIZE (size, DEFAULT_SBULKMEM_ALIGNMENT);
+	pbm = FindAvailableSizeOrGrow (pPlinth, stRequested, EN_SBULKMEM_CAN_GROW);
+	if (pbm)
+	{
+		void *pRet = NULL;
 
-	Permission is hereby granted, free of charge, to any person obtaining a copy of this
-	software and associated documentation files (the "Software"), to deal in the Software
-	without restriction, including without limitation the rights to use, copy, modify,
-	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
-	permit persons to whom the Software is furnished to do so, subject to the following
-	conditions:
+		pRet = GetMemFromSBULKMEMBLOCKifAvailable (pbm, stRequested);
+		// Align the returned block.
+		ubf_assert (stRequested >= size);
 
-	The above copyright notice and this permission notice shall be included in all copies
-	or substantial portions of the Software.
+		char *p = pRet;
+		p += stRequested - size;
+		#ifdef BUILD_POPSBULKMEM
+			pPlinth->psbulkLastUsed = pbm;
+		#endif
+		return p;
+	}
+	return NULL;
+}
 
-	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
-	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
-	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
-	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
-	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-*/
+void *GetAlignedMemFromSBULKMEMnogrow	(
+			SBULKMEM						*pPlinth,
+			size_t							size
+										)
+{
+	ubf_assert (NULL != pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-#ifndef CUNILOG_USE_COMBINED_MODULE
+	return GetMemFromSBULKMEM (pPlinth, size, DEFAULT_SBULKMEM_ALIGNMENT, EN_SBULKMEM_CANNOT_GROW);
+}
 
-	#include "memstrstr.h"
+void *GetUnalignedMemFromSBULKMEMgrow	(
+			SBULKMEM						*pPlinth,
+			size_t							size
+										)
+{
+	ubf_assert (NULL != pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-#endif
+	return GetMemFromSBULKMEM (pPlinth, size, 1, EN_SBULKMEM_CAN_GROW);
+}
 
-/*
-	Note: These comments are only here for convenience. Refer to the
-	 ones in memstrstr.h. They might be more accurate.
+void *GetUnalignedMemFromSBULKMEMnogrow	(
+			SBULKMEM						*pPlinth,
+			size_t							size
+										)
+{
+	ubf_assert (NULL != pPlinth);
+	ubf_assert ((size_t) -1 != size);
 
-	Function:	memstrstr
+	return GetMemFromSBULKMEM (pPlinth, size, 1, EN_SBULKMEM_CANNOT_GROW);
+}
 
-	The function returns a pointer to the first occurrence of s2 in s1.
-	If s2 cannot be found in s1 the return value is NULL. If size2 is
-	0 the function returns s1.
+void popSBULKMEMBLOCK					(
+			SBULKMEMBLOCK					*pb,
+			size_t							size
+										)
+{
+	ubf_assert_non_NULL (pb);
+	ubf_assert ((char *) pb->pNextAvailable - size >= (char *) pb->pMemBlockBase);
+	
+	pb->pNextAvailable	= (char *) pb->pNextAvailable - size;
+	pb->stFreeSize		+= size;
+}
 
-	The function memstrstr is basically a replacement for strstr
-	(http://www.cppreference.com/stdstring/strstr.html) but does not require
-	NULL terminated strings. It can handle any buffer which can contain any
-	byte sequence including NUL characters.
-
-	The original version of this function has been taken from
-	http://www.koders.com/c/fid2330745E0E8C0A0F5E2CF94799642712318471D0.aspx?s=getopt#L459
-	which needed fixing first. The page has disappeared in the meantime (2018). The
-	Wayback Machine also holds no copy of it.
-*/
-char *memstrstr (const char *s1, size_t size1, const char *s2, size_t size2)
-{
-	size_t		count1		= size1;
-	size_t		count2		= size2;
-	size_t		count3		= 0;
-	const char	*s1_ptr		= s1;
-	const char	*s2_ptr		= s2;
-
-	if (0 == size2)
-		return (char *) s1;
-	while (count1 --)
+#ifdef BUILD_POPSBULKMEM
+	void popSBULKMEM						(
+				SBULKMEM						*pPlinth,
+				size_t							size
+											)
 	{
-		if (*s1_ptr ++ == *s2_ptr ++)
-		{
-			if (-- count2 == 0)
-				return (char *) (s1_ptr - size2);
-			count3 ++;
-			continue;
-		} else
-		{
-			if (count3)
-			{
-				s1_ptr -= count3;
-				count1 += count3;
-				count3 = 0;
-			}
-		}
-		count2 = size2;
-		s2_ptr = s2;
+		ubf_assert_non_NULL (pPlinth);
+		ubf_assert_non_NULL (pPlinth->psbulkLastUsed);
+		
+		popSBULKMEMBLOCK (pPlinth->psbulkLastUsed, size);
 	}
-	return NULL;
-}
-
-/*
-	Note: These comments are only here for convenience. Refer to the
-	 ones in memstrstr.h. They might be more accurate.
-
-	Like memstrstr but only returns the nth occurrance of s2 in s1 if
-	s2 has been found amount times in s1. Returns NULL if s1 does not
-	contain s2 amount times.
+#endif
 
-	Example:
-	s1: "This is a test for memstrstrn."
-	s2: "e"
-	amount: 2 (second occurrance of s2 in s1)
-	Returns "emstrstrn."
-*/
-char *memstrstrn (char *s1, size_t size1, char *s2, size_t size2, size_t amount)
+void getSBULKMEMstats (SBULKMEMSTATS *pStats, SBULKMEM *pPlinth)
 {
-	char		*chF	= s1;
-	char		*chM	= s1 + size1 - 1;		// Max chF.
-	size_t		a		= amount;
-	size_t		st1		= size1;
-
-	if (amount > size1)
-		return NULL;
-	while (a --)
-	{
-		if (chF)
-		{
-			chF = memstrstr (chF, st1, s2, size2);
-			if ((chF) && (chF < chM))
-			{
-				chF ++;
-				st1 = size1 - (size_t)(chF - s1);
-			} else
-			{
-				if (a)
-					return NULL;
-			}
-		} else
-			return NULL;
-	}
-	return chF;
-}
+	ubf_assert_non_NULL (pStats);
+	ubf_assert_non_NULL (pPlinth);
 
-size_t memchrreplace (char *s, size_t size, char s1, char s2)
-{
-	size_t r	= 0;
-	size_t o	= 0;
+	pStats->stDefaultSize		= pPlinth->stDefaultSize;
+	pStats->nSBULKMEMBLOCKs		= 0;
+	pStats->stFreeLargest		= 0;
+	pStats->stFreeSmallest		= (size_t) -1;
+	pStats->stTotal				= 0;
+	pStats->stFreeTotal			= 0;
+	pStats->stFreeAverage		= 0;
 
-	while (o < size)
+	SBULKMEMBLOCK	*p	= pPlinth->psbulkFirst;
+	while (p)
 	{
-		if (s [o] == s1)
-		{
-			s [o] = s2;
-			++ r;
-		}
-		++ o;
+		++ pStats->nSBULKMEMBLOCKs;
+		pStats->stTotal += p->stSize;
+		pStats->stFreeTotal += p->stFreeSize;
+		if (p->stFreeSize > pStats->stFreeLargest)
+			pStats->stFreeLargest = p->stFreeSize;
+		if (p->stFreeSize < pStats->stFreeSmallest)
+			pStats->stFreeSmallest = p->stFreeSize;
+		p = p->pNextElement;
 	}
-	return r;
-}
-
-char *memstrchr (const char *str, size_t len, char character)
-{
-	while (len && *str != character)
+	if (pStats->nSBULKMEMBLOCKs)
 	{
-		++ str;
-		-- len;
-	}
-	return (char *) (len && *str == character ? str : NULL);
-}
-
-char *memstrrchr (const char *str, size_t len, char character)
-{
-	const char *sr = str;
-	while (len && str [len - 1] != character)
+		pStats->stFreeAverage = pStats->stFreeTotal / pStats->nSBULKMEMBLOCKs;
+	} else
 	{
-		-- len;
+		pStats->stFreeSmallest = 0;
 	}
-	sr += len ? len - 1 : 0;
-	return (char *) (*sr == character ? sr : NULL);
 }
-/****************************************************************************************
-
-	File:		VectorC.c
-	Why:		Implements vector types in C.
-	OS:			-
-	Author:		Thomas
-	Created:	2019-12-09
-  
-History
--------
-
-When		Who				What
------------------------------------------------------------------------------------------
-2019-12-09	Thomas			Created.
 
-****************************************************************************************/
+#ifdef BUILD_BULKMALLOC_TEST_FUNCTIONS
+	bool bulkmalloc_test_fnct (void)
+	{
+		bool			b		= true;
+		SBULKMEM		sbm		= SBULKMEM_INITIALISER (128);
+		//SBULKMEM		*pbm;
+		void			*p;
+		SBULKMEMBLOCK	*pbmb;
 
-/*
-	This file is maintained as part of Cunilog. See https://github.com/cunilog .
-*/
+		// The SBULKMEM structure doesn't have any memory block attached.
+		p = GetUnalignedMemFromSBULKMEMnogrow (&sbm, 1);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
+		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
+		p = GetUnalignedMemFromSBULKMEMnogrow (&sbm, 1024);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
+		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1024);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
+		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1022);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
 
-/*
-	Implements vectors (variable arrays) in C. If you change this text please copy
-	and paste it in the code or header file too.
-	
-	The code has been inspired by several different sources and changed/extended.
-	
-	Sources:
-	https://github.com/rxi/vec
-	https://eddmann.com/posts/implementing-a-dynamic-vector-array-in-c/
-	https://stackoverflow.com/questions/4694401/how-to-replicate-vector-in-c
-	https://github.com/Mashpoe/c-vector
-	
-	Most of the code comes from https://github.com/rxi/vec .
-	A good introduction can be found at https://jameshfisher.com/2017/04/06/rxi-vec/ .
+		pbmb = GrowSBULKMEM (&sbm, 0);
+		ubf_assert_non_NULL (pbmb);
+		b &= NULL != pbmb;
+		pbmb = GrowSBULKMEM (&sbm, 12);
+		ubf_assert_non_NULL (pbmb);
+		b &= NULL != pbmb;
+		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 1022);
+		ubf_assert_NULL (p);
+		b &= NULL == p;
+		// This should succeed.
+		p = GetAlignedMemFromSBULKMEMnogrow (&sbm, 16);
+		ubf_assert_non_NULL (p);
+		b &= NULL != p;
+		p = GetAlignedMemFromSBULKMEMgrow (&sbm, 12);
+		ubf_assert_non_NULL (p);
+		b &= NULL != p;
 
-	This code is covered by the MIT License. See https://opensource.org/license/mit .
+		DoneSBULKMEM (&sbm);
 
-	Since most of the code is from the rxi implementation: Copyright (c) 2014 rxi
+		p = GetAlignedMemFromSBULKMEMgrow (&sbm, 1024);
+		ubf_assert_non_NULL (p);
+		b &= NULL != p;
+		if (p)
+		{
+			memset (p, 0, 1024);
+		}
+		DoneSBULKMEM (&sbm);
 
-	Permission is hereby granted, free of charge, to any person obtaining a copy of this
-	software and associated documentation files (the "Software"), to deal in the Software
-	without restriction, including without limitation the rights to use, copy, modify,
-	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
-	permit persons to whom the Software is furnished to do so, subject to the following
-	conditions:
+		/*
+			Let's compare the two solutions when it comes to speed.
+			We allocate 100 000 memory blocks with 128 octets each, write to the block,
+			then deallocate it again. Method 2) allocates 200 MiB.
 
-	The above copyright notice and this permission notice shall be included in all copies
-	or substantial portions of the Software.
+			1) malloc () and free ()
+			2) AllocInitSBULKMEM (), GetMemFromSBULKMEM (), and DoneSBULKMEM ()
+		*/
+		SBULKMEM	*pTest;
 
-	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
-	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
-	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
-	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
-	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-*/
-
-/** 
- * Copyright (c) 2014 rxi
- *
- * This library is free software; you can redistribute it and/or modify it
- * under the terms of the MIT license. See LICENSE for details.
- */
- 
-#ifndef CUNILOG_USE_COMBINED_MODULE
-
-    #include "./VectorC.h"
-
-#endif
-
-int vec_expand_(char **data, size_t *length, size_t *capacity, size_t memsz) {
-  if (*length + 1 > *capacity) {
-    void *ptr;
-    size_t n = (*capacity == 0) ? 1 : *capacity << 1;
-    ptr = realloc(*data, n * memsz);
-    if (ptr == NULL) return -1;
-    *data = ptr;
-    *capacity = n;
-  }
-  return 0;
-}
-
-
-int vec_reserve_(char **data, size_t *length, size_t *capacity, size_t memsz, size_t n) {
-  (void) length;
-  if (n > *capacity) {
-    void *ptr = realloc(*data, n * memsz);
-    if (ptr == NULL) return -1;
-    *data = ptr;
-    *capacity = n;
-  }
-  return 0;
-}
-
-
-int vec_reserve_po2_(
-  char **data, size_t *length, size_t *capacity, size_t memsz, size_t n
-) {
-  size_t n2 = 1;
-  if (n == 0) return 0;
-  while (n2 < n) n2 <<= 1;
-  return vec_reserve_(data, length, capacity, memsz, n2);
-}
-
-
-int vec_compact_(char **data, size_t *length, size_t *capacity, size_t memsz) {
-  if (*length == 0) {
-    free(*data);
-    *data = NULL;
-    *capacity = 0;
-    return 0;
-  } else {
-    void *ptr;
-    size_t n = *length;
-    ptr = realloc(*data, n * memsz);
-    if (ptr == NULL) return -1;
-    *capacity = n;
-    *data = ptr;
-  }
-  return 0;
-}
+		FILETIME	ft1, ft2;
+		uint64_t	ut1, ut2, ut3;
+		uint64_t	u;
 
+		GetSystemTimeAsFileTime (&ft1);
+		char *pCh [100000];
+		for (u = 0; u < 100000; ++u)
+		{
+			pCh [u] = malloc (128);
+			if (pCh [u])
+				memset (pCh [u], 0, 128);
+		}
+		for (u = 0; u < 100000; ++u)
+		{
+			free (pCh [u]);
+		}
+		GetSystemTimeAsFileTime (&ft2);
+		ut1 = ft1.dwHighDateTime;
+		ut1 <<= 32;
+		ut1 += ft1.dwLowDateTime;
+		ut2 = ft2.dwHighDateTime;
+		ut2 <<= 32;
+		ut2 += ft2.dwLowDateTime;
+		ut3 = ut2 - ut1;
+		ut3 /= 10000;			// milliseconds.
+		printf ("\nTime taken by malloc ():\t\t %" PRIu64 " ms.\n", ut3);
 
-int vec_insert_(char **data, size_t *length, size_t *capacity, size_t memsz,
-                 size_t idx
-) {
-  int err = vec_expand_(data, length, capacity, memsz);
-  if (err) return err;
-  memmove(*data + (idx + 1) * memsz,
-          *data + idx * memsz,
-          (size_t) ((*length - idx) * memsz));
-  return 0;
-}
+		GetSystemTimeAsFileTime (&ft1);
+		pTest = AllocInitSBULKMEM (NULL, 200 * 1024 * 1024);
+		if (pTest)
+		{
+			for (u = 0; u < 100000; ++u)
+			{
+				pCh [u] = GetMemFromSBULKMEM (pTest, 128, 0, EN_SBULKMEM_CANNOT_GROW);
+				if (pCh [u])
+					memset (pCh [u], 0, 128);
+			}
+			DoneSBULKMEM (pTest);
+			GetSystemTimeAsFileTime (&ft2);
+			ut1 = ft1.dwHighDateTime;
+			ut1 <<= 32;
+			ut1 += ft1.dwLowDateTime;
+			ut2 = ft2.dwHighDateTime;
+			ut2 <<= 32;
+			ut2 += ft2.dwLowDateTime;
+			ut3 = ut2 - ut1;
+			ut3 /= 10000;			// milliseconds.
+			printf ("Time taken by GetMemFromSBULKMEM ():\t %" PRIu64 " ms.\n", ut3);
+		}
+		/*
+			End of speed comparison.
+		*/
 
+		// Example 1 used for the top of the header file.
+		//	->
+		#define OUR_BULK_DATA_ARRAY_SIZE	(100)
 
-void vec_splice_(char **data, size_t *length, size_t *capacity, size_t memsz,
-                 size_t start, size_t count
-) {
-  (void) capacity;
-  memmove(*data + start * memsz,
-          *data + (start + count) * memsz,
-          (size_t) ((*length - start - count) * memsz));
-}
+		SBULKMEM	sbulk	= SBULKMEM_INITIALISER (DEFAULT_SBULKMEM_SIZE);
+		void		*pDat2 [OUR_BULK_DATA_ARRAY_SIZE];
+		int			i;
 
+		for (i = 0; i < OUR_BULK_DATA_ARRAY_SIZE; ++i)
+		{
+			pDat2 [i] = GetMemFromSBULKMEM (&sbulk, 1024, 8, EN_SBULKMEM_CAN_GROW);
+			if (pDat2 [i])
+			{
+				memset (pDat2 [i], 0xFF, 1024);
+			}
+		}
+		DoneSBULKMEM (&sbulk);
+		//	<-
 
-void vec_swapsplice_(char **data, size_t *length, size_t *capacity, size_t memsz,
-                     size_t start, size_t count
-) {
-  (void) capacity;
-  memmove(*data + start * memsz,
-          *data + (*length - count) * memsz,
-          (size_t) (count * memsz));
-}
+		// Example 2 used for the top of the header file.
+		//	->
+		#define OUR_BULK_DATA_ARRAY_SIZE	(100)
+		SBULKMEM	*pBulk	= AllocInitSBULKMEM (NULL, DEFAULT_SBULKMEM_SIZE);
+		if (pBulk)
+		{
+			void		*pData [OUR_BULK_DATA_ARRAY_SIZE];
+			int			j;
 
+			for (j = 0; j < OUR_BULK_DATA_ARRAY_SIZE; ++j)
+			{
+				pData [j] = GetMemFromSBULKMEM (&sbulk, 1024, 0, EN_SBULKMEM_CAN_GROW);
+				if (pData [j])
+				{
+					memset (pData [j], 0xFF, 1024);
+				}
+			}
+			DoneSBULKMEM (&sbulk);
+		}
+		//	<-
 
-void vec_swap_(char **data, size_t *length, size_t *capacity, size_t memsz,
-               size_t idx1, size_t idx2
-) {
-  unsigned char *a, *b, tmp;
-  size_t count;
-  (void) length;
-  (void) capacity;
-  if (idx1 == idx2) return;
-  a = (unsigned char*) *data + idx1 * memsz;
-  b = (unsigned char*) *data + idx2 * memsz;
-  count = memsz;
-  while (count--) {
-    tmp = *a;
-    *a = *b;
-    *b = tmp;
-    a++; b++;
-  }
-}
+		return b;
+	}
+#endif
 /****************************************************************************************
 
-	File		shortmonths.h
-	Why:		An array with the short month names in English.
-	OS:			C99
-	Created:	2025-02-02
+	File:		memstrstr.c
+	Created:	?
 
 History
 -------
 
 When		Who				What
 -----------------------------------------------------------------------------------------
-2025-02-02	Thomas			Created.
+2014-03-10	Thomas			This history added.
+2016-12-09	Thomas			Definitions for TRUE and FALSE removed.
+2019-10-13	Thomas			Include files moved to the header.
+2024-05-21	Thomas			Function memstrrchr () fixed.
+
+	The original version of this function has been taken from
+	http://www.koders.com/c/fid2330745E0E8C0A0F5E2CF94799642712318471D0.aspx?s=getopt#L459
+	which is buggy and doesn't work under certain circumstances.
 
 ****************************************************************************************/
 
@@ -9775,54 +10322,189 @@ When		Who				What
 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
-	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
-		#include "./externC.h"
-		#include "./platform.h"
-	#else
-		#include "./../pre/externC.h"
-		#include "./../pre/platform.h"
-	#endif
+	#include "memstrstr.h"
 
 #endif
 
-const char ccdtMnths [12][4] =
-		{"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
-/****************************************************************************************
-
-	File:		ubf_time.c
-	Why:		Contains structures and functions to work with UBF_TIMESTAMP
-				and SUBF_TIMESTRUCT structures.
-	OS:			C99.
-	Author:		Thomas
-	Created:	2018-03-29
-  
-History
--------
-
-When		Who				What
------------------------------------------------------------------------------------------
-2018-03-29	Thomas			Created.
-2020-09-23	Thomas			Extended.
-2021-01-01	Thomas			Format of UBF_TIMESTAMP changed. The old one had a few
-							 issues.
-							 
-****************************************************************************************/
-
-/*
-	This file is maintained as part of Cunilog. See https://github.com/cunilog .
-*/
-
 /*
-	This code is covered by the MIT License. See https://opensource.org/license/mit .
+	Note: These comments are only here for convenience. Refer to the
+	 ones in memstrstr.h. They might be more accurate.
 
-	Copyright (c) 2024, 2025 Thomas
+	Function:	memstrstr
 
-	Permission is hereby granted, free of charge, to any person obtaining a copy of this
-	software and associated documentation files (the "Software"), to deal in the Software
-	without restriction, including without limitation the rights to use, copy, modify,
-	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
-	permit persons to whom the Software is furnished to do so, subject to the following
-	conditions:
+	The function returns a pointer to the first occurrence of s2 in s1.
+	If s2 cannot be found in s1 the return value is NULL. If size2 is
+	0 the function returns s1.
+
+	The function memstrstr is basically a replacement for strstr
+	(http://www.cppreference.com/stdstring/strstr.html) but does not require
+	NULL terminated strings. It can handle any buffer which can contain any
+	byte sequence including NUL characters.
+
+	The original version of this function has been taken from
+	http://www.koders.com/c/fid2330745E0E8C0A0F5E2CF94799642712318471D0.aspx?s=getopt#L459
+	which needed fixing first. The page has disappeared in the meantime (2018). The
+	Wayback Machine also holds no copy of it.
+*/
+char *memstrstr (const char *s1, size_t size1, const char *s2, size_t size2)
+{
+	size_t		count1		= size1;
+	size_t		count2		= size2;
+	size_t		count3		= 0;
+	const char	*s1_ptr		= s1;
+	const char	*s2_ptr		= s2;
+
+	if (0 == size2)
+		return (char *) s1;
+	while (count1 --)
+	{
+		if (*s1_ptr ++ == *s2_ptr ++)
+		{
+			if (-- count2 == 0)
+				return (char *) (s1_ptr - size2);
+			count3 ++;
+			continue;
+		} else
+		{
+			if (count3)
+			{
+				s1_ptr -= count3;
+				count1 += count3;
+				count3 = 0;
+			}
+		}
+		count2 = size2;
+		s2_ptr = s2;
+	}
+	return NULL;
+}
+
+/*
+	Note: These comments are only here for convenience. Refer to the
+	 ones in memstrstr.h. They might be more accurate.
+
+	Like memstrstr but only returns the nth occurrance of s2 in s1 if
+	s2 has been found amount times in s1. Returns NULL if s1 does not
+	contain s2 amount times.
+
+	Example:
+	s1: "This is a test for memstrstrn."
+	s2: "e"
+	amount: 2 (second occurrance of s2 in s1)
+	Returns "emstrstrn."
+*/
+char *memstrstrn (char *s1, size_t size1, char *s2, size_t size2, size_t amount)
+{
+	char		*chF	= s1;
+	char		*chM	= s1 + size1 - 1;		// Max chF.
+	size_t		a		= amount;
+	size_t		st1		= size1;
+
+	if (amount > size1)
+		return NULL;
+	while (a --)
+	{
+		if (chF)
+		{
+			chF = memstrstr (chF, st1, s2, size2);
+			if ((chF) && (chF < chM))
+			{
+				chF ++;
+				st1 = size1 - (size_t)(chF - s1);
+			} else
+			{
+				if (a)
+					return NULL;
+			}
+		} else
+			return NULL;
+	}
+	return chF;
+}
+
+size_t memchrreplace (char *s, size_t size, char s1, char s2)
+{
+	size_t r	= 0;
+	size_t o	= 0;
+
+	while (o < size)
+	{
+		if (s [o] == s1)
+		{
+			s [o] = s2;
+			++ r;
+		}
+		++ o;
+	}
+	return r;
+}
+
+char *memstrchr (const char *str, size_t len, char character)
+{
+	while (len && *str != character)
+	{
+		++ str;
+		-- len;
+	}
+	return (char *) (len && *str == character ? str : NULL);
+}
+
+char *memstrrchr (const char *str, size_t len, char character)
+{
+	const char *sr = str;
+	while (len && str [len - 1] != character)
+	{
+		-- len;
+	}
+	sr += len ? len - 1 : 0;
+	return (char *) (*sr == character ? sr : NULL);
+}
+/****************************************************************************************
+
+	File:		VectorC.c
+	Why:		Implements vector types in C.
+	OS:			-
+	Author:		Thomas
+	Created:	2019-12-09
+  
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2019-12-09	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
+
+/*
+	Implements vectors (variable arrays) in C. If you change this text please copy
+	and paste it in the code or header file too.
+	
+	The code has been inspired by several different sources and changed/extended.
+	
+	Sources:
+	https://github.com/rxi/vec
+	https://eddmann.com/posts/implementing-a-dynamic-vector-array-in-c/
+	https://stackoverflow.com/questions/4694401/how-to-replicate-vector-in-c
+	https://github.com/Mashpoe/c-vector
+	
+	Most of the code comes from https://github.com/rxi/vec .
+	A good introduction can be found at https://jameshfisher.com/2017/04/06/rxi-vec/ .
+
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Since most of the code is from the rxi implementation: Copyright (c) 2014 rxi
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
 
 	The above copyright notice and this permission notice shall be included in all copies
 	or substantial portions of the Software.
@@ -9835,76 +10517,297 @@ When		Who				What
 	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-// Function ftime ():
-/*
- * Copyright (C) 2008 The Android Open Source Project
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions
- * are met:
- *  * Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- *  * Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in
- *    the documentation and/or other materials provided with the
- *    distribution.
+/** 
+ * Copyright (c) 2014 rxi
  *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
- * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
- * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
- * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
- * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
- * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
- * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
- * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
- * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
- * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
- * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- * SUCH DAMAGE.
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
  */
-
+ 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
-	#include "./ubf_times.h"
-
-	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
-		#include "./ubfdebug.h"
-	#else
-		#include "./../dbg/ubfdebug.h"
-	#endif
+    #include "./VectorC.h"
 
 #endif
 
-#ifdef _MSC_VER
-#pragma warning (disable: 4996)									// MSVC says some functions are unsafe.
-#endif
+int vec_expand_(char **data, size_t *length, size_t *capacity, size_t memsz) {
+  if (*length + 1 > *capacity) {
+    void *ptr;
+    size_t n = (*capacity == 0) ? 1 : *capacity << 1;
+    ptr = realloc(*data, n * memsz);
+    if (ptr == NULL) return -1;
+    *data = ptr;
+    *capacity = n;
+  }
+  return 0;
+}
 
-UBF_TIMESTAMP UBF_TIMESTAMP_OFFSET_BITS (SUBF_TIMESTRUCT *ts)
-{
-	UBF_TIMESTAMP			s;
 
-	ubf_assert_non_NULL (ts);
+int vec_reserve_(char **data, size_t *length, size_t *capacity, size_t memsz, size_t n) {
+  (void) length;
+  if (n > *capacity) {
+    void *ptr = realloc(*data, n * memsz);
+    if (ptr == NULL) return -1;
+    *data = ptr;
+    *capacity = n;
+  }
+  return 0;
+}
 
-	/*
-		Specification from 2021-01-01:
 
-		Bit 76543210
-			3210|||.	UTC offset in hours
-				0||.	1: UTC offset is negative
-				 ||.	0: UTC offset is positive
-				 0|.	1: UTC offset + 30 minutes
-				  |.	0: UTC offset unchanged
-				  0.	1: UTC offset + 15 minutes
-						0: UTC offset unchanged
-	*/
-	s = ts->uOffsetHours;
-	s <<= 4;
-	s |= ts->bOffsetNegative ? 0x08 : 0;
-	switch (ts->uOffsetMinutes)
-	{	// Can be: 0, 15, 30, and 45.
-	case 0:
-		break;
+int vec_reserve_po2_(
+  char **data, size_t *length, size_t *capacity, size_t memsz, size_t n
+) {
+  size_t n2 = 1;
+  if (n == 0) return 0;
+  while (n2 < n) n2 <<= 1;
+  return vec_reserve_(data, length, capacity, memsz, n2);
+}
+
+
+int vec_compact_(char **data, size_t *length, size_t *capacity, size_t memsz) {
+  if (*length == 0) {
+    free(*data);
+    *data = NULL;
+    *capacity = 0;
+    return 0;
+  } else {
+    void *ptr;
+    size_t n = *length;
+    ptr = realloc(*data, n * memsz);
+    if (ptr == NULL) return -1;
+    *capacity = n;
+    *data = ptr;
+  }
+  return 0;
+}
+
+
+int vec_insert_(char **data, size_t *length, size_t *capacity, size_t memsz,
+                 size_t idx
+) {
+  int err = vec_expand_(data, length, capacity, memsz);
+  if (err) return err;
+  memmove(*data + (idx + 1) * memsz,
+          *data + idx * memsz,
+          (size_t) ((*length - idx) * memsz));
+  return 0;
+}
+
+
+void vec_splice_(char **data, size_t *length, size_t *capacity, size_t memsz,
+                 size_t start, size_t count
+) {
+  (void) capacity;
+  memmove(*data + start * memsz,
+          *data + (start + count) * memsz,
+          (size_t) ((*length - start - count) * memsz));
+}
+
+
+void vec_swapsplice_(char **data, size_t *length, size_t *capacity, size_t memsz,
+                     size_t start, size_t count
+) {
+  (void) capacity;
+  memmove(*data + start * memsz,
+          *data + (*length - count) * memsz,
+          (size_t) (count * memsz));
+}
+
+
+void vec_swap_(char **data, size_t *length, size_t *capacity, size_t memsz,
+               size_t idx1, size_t idx2
+) {
+  unsigned char *a, *b, tmp;
+  size_t count;
+  (void) length;
+  (void) capacity;
+  if (idx1 == idx2) return;
+  a = (unsigned char*) *data + idx1 * memsz;
+  b = (unsigned char*) *data + idx2 * memsz;
+  count = memsz;
+  while (count--) {
+    tmp = *a;
+    *a = *b;
+    *b = tmp;
+    a++; b++;
+  }
+}
+/****************************************************************************************
+
+	File		shortmonths.h
+	Why:		An array with the short month names in English.
+	OS:			C99
+	Created:	2025-02-02
+
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2025-02-02	Thomas			Created.
+
+****************************************************************************************/
+
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CUNILOG_USE_COMBINED_MODULE
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./externC.h"
+		#include "./platform.h"
+	#else
+		#include "./../pre/externC.h"
+		#include "./../pre/platform.h"
+	#endif
+
+#endif
+
+const char ccdtMnths [12][4] =
+		{"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+/****************************************************************************************
+
+	File:		ubf_time.c
+	Why:		Contains structures and functions to work with UBF_TIMESTAMP
+				and SUBF_TIMESTRUCT structures.
+	OS:			C99.
+	Author:		Thomas
+	Created:	2018-03-29
+  
+History
+-------
+
+When		Who				What
+-----------------------------------------------------------------------------------------
+2018-03-29	Thomas			Created.
+2020-09-23	Thomas			Extended.
+2021-01-01	Thomas			Format of UBF_TIMESTAMP changed. The old one had a few
+							 issues.
+							 
+****************************************************************************************/
+
+/*
+	This file is maintained as part of Cunilog. See https://github.com/cunilog .
+*/
+
+/*
+	This code is covered by the MIT License. See https://opensource.org/license/mit .
+
+	Copyright (c) 2024, 2025 Thomas
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy of this
+	software and associated documentation files (the "Software"), to deal in the Software
+	without restriction, including without limitation the rights to use, copy, modify,
+	merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be included in all copies
+	or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+	INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+	PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+	OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+// Function ftime ():
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CUNILOG_USE_COMBINED_MODULE
+
+	#include "./ubf_times.h"
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./ubfdebug.h"
+	#else
+		#include "./../dbg/ubfdebug.h"
+	#endif
+
+#endif
+
+#ifdef _MSC_VER
+#pragma warning (disable: 4996)									// MSVC says some functions are unsafe.
+#endif
+
+UBF_TIMESTAMP UBF_TIMESTAMP_OFFSET_BITS (SUBF_TIMESTRUCT *ts)
+{
+	UBF_TIMESTAMP			s;
+
+	ubf_assert_non_NULL (ts);
+
+	/*
+		Specification from 2021-01-01:
+
+		Bit 76543210
+			3210|||.	UTC offset in hours
+				0||.	1: UTC offset is negative
+				 ||.	0: UTC offset is positive
+				 0|.	1: UTC offset + 30 minutes
+				  |.	0: UTC offset unchanged
+				  0.	1: UTC offset + 15 minutes
+						0: UTC offset unchanged
+	*/
+	s = ts->uOffsetHours;
+	s <<= 4;
+	s |= ts->bOffsetNegative ? 0x08 : 0;
+	switch (ts->uOffsetMinutes)
+	{	// Can be: 0, 15, 30, and 45.
+	case 0:
+		break;
 	case 15:
 		s |= 0x02;												// Bit 0.
 		break;
@@ -10267,9 +11170,105 @@ UBF_TIMESTAMP LocalTime_UBF_TIMESTAMP (void)
 }
 
 /*
-	A note about tests.
-
-	Functions in this module (ubf_times) are tested by the test function in module ubf_date_and_time.c/h.
+	Recomputes the cached local time for the second tSec. The UTC offset is obtained the
+	same way as in GetLocalTime_UBF_TIMESTAMP (). Unlike there, the reentrant versions of
+	localtime () are used.
+*/
+static void updateUBF_TIMESTAMP_CACHE (UBF_TIMESTAMP_CACHE *pc, int64_t tSec)
+{
+	ubf_assert_non_NULL (pc);
+
+	int				i_adjustment_hours;
+	int				i_adjustment_mins;
+	bool			bOffsetNegative = false;
+	time_t			t_time			= (time_t) tSec;
+	struct tm		stime;
+
+	#ifdef PLATFORM_IS_WINDOWS
+		struct	timeb	timebuffer;
+		_ftime (&timebuffer);
+		if (timebuffer.timezone < 0)
+		{
+			bOffsetNegative = true;
+			timebuffer.timezone *= -1;
+		}
+		i_adjustment_hours = timebuffer.timezone / 60;
+		i_adjustment_mins  = timebuffer.timezone % 60;
+		localtime_s (&stime, &t_time);
+	#else
+		struct timeval	tv;
+		struct timezone	tz;
+		gettimeofday (&tv, &tz);
+		if (tz.tz_minuteswest < 0)
+		{
+			bOffsetNegative = true;
+			tz.tz_minuteswest *= -1;
+		}
+		i_adjustment_hours	= tz.tz_minuteswest / 60;
+		i_adjustment_mins	= tz.tz_minuteswest % 60;
+		localtime_r (&t_time, &stime);
+	#endif
+
+	// Adjust daylight saving time (DST) value.
+	//  DST automatically implies +1 hour (+01:00).
+	if (stime.tm_isdst > 0) i_adjustment_hours++;
+
+	SET_UBF_TIMESTAMP_OFFSET_BITS	(
+		pc->uts, (UBF_TIMESTAMP) i_adjustment_hours, (UBF_TIMESTAMP) i_adjustment_mins, bOffsetNegative
+									);
+	pc->uts |= SET_UBF_TIMESTAMP_YEAR_BITS		((UBF_TIMESTAMP) stime.tm_year + 1900);
+	pc->uts |= SET_UBF_TIMESTAMP_MONTH_BITS		((UBF_TIMESTAMP) stime.tm_mon + 1);
+	pc->uts |= SET_UBF_TIMESTAMP_DAY_BITS		((UBF_TIMESTAMP) stime.tm_mday);
+	pc->uts |= SET_UBF_TIMESTAMP_HOUR_BITS		((UBF_TIMESTAMP) stime.tm_hour);
+	pc->uts |= SET_UBF_TIMESTAMP_MINUTE_BITS	((UBF_TIMESTAMP) stime.tm_min);
+	pc->uts |= SET_UBF_TIMESTAMP_SECOND_BITS	((UBF_TIMESTAMP) stime.tm_sec);
+	pc->tSec = tSec;
+}
+
+void GetLocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP *ut, UBF_TIMESTAMP_CACHE *pc)
+{
+	ubf_assert_non_NULL (ut);
+	ubf_assert_non_NULL (pc);
+
+	int64_t			tSec;
+	unsigned int	ms;
+
+	#ifdef PLATFORM_IS_WINDOWS
+		FILETIME		ft;
+		ULARGE_INTEGER	ul;
+		GetSystemTimeAsFileTime (&ft);
+		ul.LowPart		= ft.dwLowDateTime;
+		ul.HighPart		= ft.dwHighDateTime;
+		ul.QuadPart		-= 116444736000000000;				// 1601-01-01 to 1970-01-01.
+		tSec			= (int64_t) (ul.QuadPart / FT_SECOND);
+		ms				= (unsigned int) ((ul.QuadPart % FT_SECOND) / FT_MILLISECOND);
+	#else
+		struct timespec	ts;
+		#ifdef CLOCK_REALTIME_COARSE
+			clock_gettime (CLOCK_REALTIME_COARSE, &ts);
+		#else
+			clock_gettime (CLOCK_REALTIME, &ts);
+		#endif
+		tSec			= (int64_t) ts.tv_sec;
+		ms				= (unsigned int) (ts.tv_nsec / 1000000);
+	#endif
+
+	if (tSec != pc->tSec)
+		updateUBF_TIMESTAMP_CACHE (pc, tSec);
+	*ut = pc->uts | SET_UBF_TIMESTAMP_MILLISECOND_BITS ((UBF_TIMESTAMP) ms);
+}
+
+UBF_TIMESTAMP LocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP_CACHE *pc)
+{
+	UBF_TIMESTAMP	dts;
+	GetLocalTimeCached_UBF_TIMESTAMP (&dts, pc);
+	return dts;
+}
+
+/*
+	A note about tests.
+
+	Functions in this module (ubf_times) are tested by the test function in module ubf_date_and_time.c/h.
 
 	Please do not place any code below. Please add code only above this comment block.
 */
@@ -12532,6 +13531,22 @@ bool FormattedMilliseconds (char *chFormatted, const uint64_t uiTimeInMillisecon
 		ISO8601T_from_UBF_TIMESTAMPc (szTS2, tt);
 		ubf_expect_bool_AND (b, !memcmp (szTS1, szTS2, SIZ_ISO8601DATETIMESTAMPMS));
 
+		// Apart from the milliseconds the cached local time is identical to the uncached one.
+		UBF_TIMESTAMP_CACHE	tsc		= UBF_TIMESTAMP_CACHE_INITIALISER;
+		UBF_TIMESTAMP		msk		= ~ SET_UBF_TIMESTAMP_MILLISECOND_BITS (0x3FF);
+		UBF_TIMESTAMP		tc;
+		tt = LocalTime_UBF_TIMESTAMP ();
+		tc = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		if ((tt & msk) != (tc & msk))
+		{	// Hit during a second change.
+			tt = LocalTime_UBF_TIMESTAMP ();
+			tc = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		}
+		ubf_expect_bool_AND (b, (tt & msk) == (tc & msk));
+		ubf_expect_bool_AND (b, -1 != tsc.tSec);
+		tt = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		ubf_expect_bool_AND (b, (tt & msk) >= (tc & msk));
+
 		char szISO_1 [SIZ_ISO8601DATETIMESTAMP_NO_OFFS];
 		char szISO_2 [SIZ_ISO8601DATETIMESTAMP_NO_OFFS];
 		szISO_1 [LEN_ISO8601DATETIMESTAMP_NO_OFFS] = 'X';
@@ -20577,6 +21592,11 @@ When		Who				What
 #ifdef PLATFORM_IS_POSIX
 	#include <pthread.h>
 #endif
+#ifdef OS_IS_LINUX
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+#endif
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
 
@@ -20659,12 +21679,11 @@ void culCmdStoreCmdConfigCunilognewline (unsigned char *szOut, newline_t nl)
 }
 
 /*
-	These declarations are from cunilog.h. They are defined in cunilog.c.
+	This declaration is from cunilog.c, where the function is defined. The functions
+	ConfigCUNILOG_TARGETdisableTaskProcessors () and friends from cunilog.h would queue
+	another command event.
 */
-void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
-void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
-void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put);
-void ConfigCUNILOG_TARGETenableEchoProcessor (CUNILOG_TARGET *put);
+void cunilogDisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task, bool bDisable);
 
 void culCmdStoreCmdConfigDisableTaskProcessors (unsigned char *szOut, enum cunilogprocesstask task)
 {
@@ -20690,7 +21709,7 @@ void culCmdConfigDisableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDa
 	ubf_assert (0 <= task);
 	ubf_assert (task < cunilogProcessXAmountEnumValues);
 
-	ConfigCUNILOG_TARGETdisableTaskProcessors (put, task);
+	cunilogDisableTaskProcessors (put, task, true);
 }
 
 void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szData)
@@ -20701,7 +21720,7 @@ void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDat
 	ubf_assert (0 <= task);
 	ubf_assert (task < cunilogProcessXAmountEnumValues);
 
-	ConfigCUNILOG_TARGETenableTaskProcessors (put, task);
+	cunilogDisableTaskProcessors (put, task, false);
 }
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_SEVERITY_TYPE
@@ -20745,6 +21764,13 @@ void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDat
 		HANDLE hThread = GetCurrentThread ();
 		return SetThreadPriority (hThread, prio);
 	}
+#elif defined (OS_IS_LINUX)
+	static bool SetPsxCurrThreadPriority (int prio)
+	{	// On Linux, the nice value is a per-thread attribute. The static priority that
+		//	pthread_setschedprio () changes must be 0 with the default scheduling policy.
+		//	See https://man7.org/linux/man-pages/man2/setpriority.2.html .
+		return 0 == setpriority (PRIO_PROCESS, (id_t) syscall (SYS_gettid), prio);
+	}
 #else
 	static bool SetPsxCurrThreadPriority (int prio)
 	{	// See https://man7.org/linux/man-pages/man3/pthread_setschedprio.3.html .
@@ -20828,10 +21854,10 @@ void culCmdChangeCmdConfigFromCommand (CUNILOG_EVENT *pev)
 			culCmdConfigEnableTaskProcessors (put, szData);
 			break;
 		case cunilogCmdConfigDisableEchoProcessor:
-			ConfigCUNILOG_TARGETdisableEchoProcessor (put);
+			cunilogDisableTaskProcessors (put, cunilogProcessEchoToConsole, true);
 			break;
 		case cunilogCmdConfigEnableEchoProcessor:
-			ConfigCUNILOG_TARGETenableEchoProcessor (put);
+			cunilogDisableTaskProcessors (put, cunilogProcessEchoToConsole, false);
 			break;
 		case cunilogCmdConfigSetLogPriority:
 			culCmdConfigSetLogPriority (szData);
@@ -20909,6 +21935,7 @@ When		Who				What
 		#include "./strisabsolutepath.h"
 		#include "./strnewline.h"
 		#include "./CompressFile.h"
+		#include "./ExtCompressors.h"
 		#include "./ExeFileName.h"
 		#include "./UserHome.h"
 		
@@ -20920,6 +21947,7 @@ When		Who				What
 			#include "./PsxReadDirFncts.h"
 			#include "./PsxTrash.h"
 			#include "./PsxHome.h"
+			#include "./timespecfncts.h"
 		#endif
 		
 		#include "./unref.h"
@@ -20941,6 +21969,7 @@ When		Who				What
 		#include "./../string/strnewline.h"
 		#include "./../string/strwildcards.h"
 		#include "./../OS/CompressFile.h"
+		#include "./../extern/ExtCompressors.h"
 		#include "./../OS/ExeFileName.h"
 		#include "./../OS/UserHome.h"
 		
@@ -20952,6 +21981,7 @@ When		Who				What
 			#include "./../OS/POSIX/PsxReadDirFncts.h"
 			#include "./../OS/POSIX/PsxTrash.h"
 			#include "./../OS/POSIX/PsxHome.h"
+			#include "./../datetime/timespecfncts.h"
 		#endif
 		
 		#include "./../pre/unref.h"
@@ -20963,6 +21993,18 @@ When		Who				What
 #ifdef PLATFORM_IS_POSIX
 	#include <errno.h>
 	#include <unistd.h>
+	#include <time.h>
+	#include <fcntl.h>
+	#include <sys/uio.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#ifdef CUNILOG_HAVE_IO_URING
+		#include <sys/syscall.h>
+		#include <linux/io_uring.h>
+	#endif
+	#ifdef CUNILOG_HAVE_INOTIFY
+		#include <sys/inotify.h>
+	#endif
 #endif
 
 static CUNILOG_TARGET CUNILOG_TARGETstatic;
@@ -21215,6 +22257,7 @@ size_t arrLengthTimeStampFromPostfix [] =					// [unilogPostfixAmountEnumValues]
 	/* cunilogPostfixDotNumberWeekly		*/	,	1 + UBF_UINT64_LEN
 	/* cunilogPostfixDotNumberMonthly		*/	,	1 + UBF_UINT64_LEN
 	/* cunilogPostfixDotNumberYearly		*/	,	1 + UBF_UINT64_LEN
+	/* cunilogPostfixDotNumberSize			*/	,	1 + UBF_UINT64_LEN
 };
 
 #ifdef DEBUG
@@ -21261,7 +22304,8 @@ const char *arrPostfixWildcardMask []	=		// [cunilogPostfixAmountEnumValues]
 	"",											// cunilogPostfixDotNumberDaily
 	"",											// cunilogPostfixDotNumberWeekly
 	"",											// cunilogPostfixDotNumberMonthly
-	""											// cunilogPostfixDotNumberYearly
+	"",											// cunilogPostfixDotNumberYearly
+	""											// cunilogPostfixDotNumberSize
 };
 
 #ifdef DEBUG
@@ -21314,6 +22358,7 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 	/* cunilogPostfixDotNumberWeekly		*/	,	noPostfix
 	/* cunilogPostfixDotNumberMonthly		*/	,	noPostfix
 	/* cunilogPostfixDotNumberYearly		*/	,	noPostfix
+	/* cunilogPostfixDotNumberSize			*/	,	noPostfix
 };
 
 #ifdef DEBUG
@@ -21443,8 +22488,9 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 					ubf_assert_true (put->cl.bInitialised);
 				#endif
 
-				LeaveCriticalSection (&put->cl.cs);
+				// Before unlocking. Another thread may lock and set it again right away.
 				cunilogClrDebugQueueLocked (put);
+				LeaveCriticalSection (&put->cl.cs);
 			}
 		}
 	#else
@@ -21458,8 +22504,9 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 					ubf_assert_true (put->cl.bInitialised);
 				#endif
 
-				pthread_mutex_unlock (&put->cl.mt);
+				// Before unlocking. Another thread may lock and set it again right away.
 				cunilogClrDebugQueueLocked (put);
+				pthread_mutex_unlock (&put->cl.mt);
 			}
 		}
 	#endif
@@ -21499,129 +22546,456 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 	#define DoneCUNILOG_LOCKER(x)
 #endif
 
-void InitSCUNILOGNPI (SCUNILOGNPI *pni)
-{
-	ubf_assert_non_NULL (pni);
+/*
+	Lockers that are not the locker of a target, like the ones of the staging buffers,
+	the event pool, and the maintenance thread.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void InitLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
 
-	initSMEMBUF (&pni->smbRotMask);
-	pni->lenRotMask			= 0;
-	pni->nIgnoredTotal		= 0;
-	pni->pNextVecCunilogFls	= NULL;
-}
+		#ifdef OS_IS_WINDOWS
+			InitializeCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_init (&pcl->mt, NULL);
+		#endif
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			pcl->bInitialised = true;
+		#endif
+	}
 
-void DoneSCUNILOGNPI (SCUNILOGNPI *pni)
-{
-	ubf_assert_non_NULL (pni);
+	static inline void EnterLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			ubf_assert_true (pcl->bInitialised);
+		#endif
 
-	if (isUsableSMEMBUF (&pni->smbRotMask))
-		doneSMEMBUF (&pni->smbRotMask);
-}
+		#ifdef OS_IS_WINDOWS
+			EnterCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_lock (&pcl->mt);
+		#endif
+	}
 
-/*
-	ObtainCurrentWorkingDirectoy
+	static inline bool TryEnterLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			ubf_assert_true (pcl->bInitialised);
+		#endif
 
-	Returns the current working directory with an ending forward or backslash as
-	an SMEMBUF. Should probably go in its own module at some point as it certainly
-	does not belong here.
+		#ifdef OS_IS_WINDOWS
+			return TryEnterCriticalSection (&pcl->cs);
+		#else
+			return 0 == pthread_mutex_trylock (&pcl->mt);
+		#endif
+	}
 
-	The function returns the amount of characters it has written to the buffer of
-	the SMEMBUF structure, not including a terminating NUL character.
+	static inline void LeaveLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+
+		#ifdef OS_IS_WINDOWS
+			LeaveCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_unlock (&pcl->mt);
+		#endif
+	}
+
+	static inline void DoneLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+
+		#ifdef OS_IS_WINDOWS
+			DeleteCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_destroy (&pcl->mt);
+		#endif
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			pcl->bInitialised = false;
+		#endif
+	}
+#endif
+
+/*
+	Atomic operations for the lock-free event queue and the free lists of the event pool.
+	The compare-and-swap functions update the value pexp points to with the current value
+	if the swap fails.
 */
-static size_t ObtainCurrentWorkingDirectoy (SMEMBUF *mb)
-{
-	ubf_assert_non_NULL (mb);
-	ubf_assert (isInitialisedSMEMBUF (mb));
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline CUNILOG_EVENT *cunilogAtomicLoadEvt (CUNILOG_EVENT **pp)
+		{
+			return InterlockedCompareExchangePointer ((PVOID volatile *) pp, NULL, NULL);
+		}
 
-	size_t	r = 0;
+		static inline CUNILOG_EVENT *cunilogAtomicXchgEvt (CUNILOG_EVENT **pp, CUNILOG_EVENT *pev)
+		{
+			return InterlockedExchangePointer ((PVOID volatile *) pp, pev);
+		}
 
-	#if defined (PLATFORM_IS_WINDOWS)
+		static inline bool cunilogAtomicCasEvt	(
+							CUNILOG_EVENT **pp, CUNILOG_EVENT **pexp, CUNILOG_EVENT *pev
+												)
+		{
+			CUNILOG_EVENT *prv = InterlockedCompareExchangePointer	(
+									(PVOID volatile *) pp, pev, *pexp
+																	);
+			if (prv == *pexp)
+				return true;
+			*pexp = prv;
+			return false;
+		}
 
-		WCHAR wc [1];
-		DWORD dw = GetCurrentDirectoryW (1, wc);
-		WCHAR *pw = malloc (sizeof (WCHAR) * dw + sizeof (WCHAR));
-		if (pw)
+		static inline size_t cunilogAtomicLoadSize (size_t *p)
 		{
-			DWORD dn = GetCurrentDirectoryW (dw, pw);
-			ubf_assert (dn);
-			ubf_assert (dn < dw);
-			if (dn)
-			{
-				int rq = reqUTF8sizeFromUTF16wchars (dn);
-				growToSizeSMEMBUF (mb, rq);
-				if (isUsableSMEMBUF (mb))
-				{
-					int n = UTF8_from_WinU16 (mb->buf.pch, rq, pw);
-					if (n)
-					{
-						mb->buf.pch [n - 1]	= '\\';
-						mb->buf.pch [n]		= '\0';
-					}
-					r = n;
-				}
-			}
-			free (pw);
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, 0);
 		}
 
-	#elif defined (PLATFORM_IS_POSIX)
+		static inline size_t cunilogAtomicAddSize (size_t *p, size_t n)
+		{
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, n);
+		}
 
-		size_t	siz		= 32;
-		char	*pr		= NULL;
-		bool	rtry	= true;
+		static inline size_t cunilogAtomicSubSize (size_t *p, size_t n)
+		{
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, (size_t) 0 - n);
+		}
 
-		while (rtry)
+		static inline size_t cunilogAtomicXchgSize (size_t *p, size_t n)
 		{
-			growToSizeSMEMBUF (mb, siz + 1);
-			if (isUsableSMEMBUF (mb))
-			{
-				pr = getcwd (mb->buf.pch, siz);
-				if (pr)
-				{
-					size_t l = strlen (pr);
-					pr [l]		= '/';
-					pr [l + 1]	= '\0';
-					r = l + 1;
-					rtry = false;
-				} else
-				{
-					if (ERANGE == errno)
-						siz += 32;
-					else
-						rtry = false;
-				}
-			}
+			#ifdef _WIN64
+				return (size_t) InterlockedExchange64 ((LONG64 volatile *) p, (LONG64) n);
+			#else
+				return (size_t) InterlockedExchange ((LONG volatile *) p, (LONG) n);
+			#endif
 		}
 
-	#else
+		static inline void cunilogAtomicStoreSize (size_t *p, size_t n)
+		{
+			cunilogAtomicXchgSize (p, n);
+		}
 
-		#error Not supported!
+		static inline CUNILOG_POOLSLOT *cunilogAtomicLoadSlot (CUNILOG_POOLSLOT **pp)
+		{
+			return InterlockedCompareExchangePointer ((PVOID volatile *) pp, NULL, NULL);
+		}
 
-	#endif
+		static inline bool cunilogAtomicCasSlot	(
+							CUNILOG_POOLSLOT **pp, CUNILOG_POOLSLOT **pexp, CUNILOG_POOLSLOT *ps
+												)
+		{
+			CUNILOG_POOLSLOT *prv = InterlockedCompareExchangePointer	(
+										(PVOID volatile *) pp, ps, *pexp
+																		);
+			if (prv == *pexp)
+				return true;
+			*pexp = prv;
+			return false;
+		}
+	#else
+		static inline CUNILOG_EVENT *cunilogAtomicLoadEvt (CUNILOG_EVENT **pp)
+		{
+			return __atomic_load_n (pp, __ATOMIC_SEQ_CST);
+		}
 
-	return r;
-}
+		static inline CUNILOG_EVENT *cunilogAtomicXchgEvt (CUNILOG_EVENT **pp, CUNILOG_EVENT *pev)
+		{
+			return __atomic_exchange_n (pp, pev, __ATOMIC_SEQ_CST);
+		}
 
-static size_t ObtainRelativeLogPathBase (SMEMBUF *mb, enCunilogRelPath relLogPath)
-{
-	switch (relLogPath)
-	{
-		#ifdef DEBUG
-		case cunilogPath_isAbsolute:
-			ubf_assert_msg (false, "This should have been caught before we got here");
-			// Hopefully this causes an access violation/segmentation fault.
-			return CUNILOG_SIZE_ERROR;
-		#endif
-		case cunilogPath_relativeToExecutable:
-			return ObtainPathFromExecutableModule (mb);
-		case cunilogPath_relativeToCurrentDir:
-			return ObtainCurrentWorkingDirectoy (mb);
-		case cunilogPath_relativeToHomeDir:
-			return ObtainUserHomeDirectoy (mb);
-	}
-	return 0;
-}
+		static inline bool cunilogAtomicCasEvt	(
+							CUNILOG_EVENT **pp, CUNILOG_EVENT **pexp, CUNILOG_EVENT *pev
+												)
+		{
+			return __atomic_compare_exchange_n	(
+						pp, pexp, pev, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+												);
+		}
 
-bool CunilogGetAbsPathFromAbsOrRelPath	(
-		SMEMBUF				*psmb,
+		static inline size_t cunilogAtomicLoadSize (size_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicAddSize (size_t *p, size_t n)
+		{
+			return __atomic_fetch_add (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicSubSize (size_t *p, size_t n)
+		{
+			return __atomic_fetch_sub (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicXchgSize (size_t *p, size_t n)
+		{
+			return __atomic_exchange_n (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline void cunilogAtomicStoreSize (size_t *p, size_t n)
+		{
+			__atomic_store_n (p, n, __ATOMIC_RELEASE);
+		}
+
+		static inline CUNILOG_POOLSLOT *cunilogAtomicLoadSlot (CUNILOG_POOLSLOT **pp)
+		{
+			return __atomic_load_n (pp, __ATOMIC_SEQ_CST);
+		}
+
+		static inline bool cunilogAtomicCasSlot	(
+							CUNILOG_POOLSLOT **pp, CUNILOG_POOLSLOT **pexp, CUNILOG_POOLSLOT *ps
+												)
+		{
+			return __atomic_compare_exchange_n	(
+						pp, pexp, ps, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+												);
+		}
+	#endif
+#endif
+
+/*
+	Loads and stores of the severity mask of a target, which can be changed while other
+	threads are logging. A relaxed load is sufficient. An event logged concurrently with
+	the change is either filtered by the old or by the new mask.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline uint32_t cunilogAtomicLoadU32 (uint32_t *p)
+		{
+			return *(uint32_t volatile *) p;
+		}
+
+		static inline void cunilogAtomicStoreU32 (uint32_t *p, uint32_t v)
+		{
+			InterlockedExchange ((LONG volatile *) p, (LONG) v);
+		}
+	#else
+		static inline uint32_t cunilogAtomicLoadU32 (uint32_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_RELAXED);
+		}
+
+		static inline void cunilogAtomicStoreU32 (uint32_t *p, uint32_t v)
+		{
+			__atomic_store_n (p, v, __ATOMIC_RELEASE);
+		}
+	#endif
+#else
+	#define cunilogAtomicLoadU32(p)						(*(p))
+	#define cunilogAtomicStoreU32(p, v)					(*(p) = (v))
+#endif
+
+/*
+	Sequence lock of the cached local time of a target (member tsc). Readers never block.
+	The sequence number is odd while a thread updates the cache. A reader copies the cache
+	and only uses the copy if the sequence number was even and did not change meanwhile.
+	Since the cache only changes once per second, a writer only takes over the cache if
+	the sequence number still is the one it read, and gives up otherwise.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline uint32_t cunilogTimestampSeqBeginRead (uint32_t *p)
+		{
+			uint32_t seq = *(uint32_t volatile *) p;
+			MemoryBarrier ();
+			return seq;
+		}
+
+		static inline bool cunilogTimestampSeqEndRead (uint32_t *p, uint32_t seq)
+		{
+			MemoryBarrier ();
+			return 0 == (seq & 1) && seq == *(uint32_t volatile *) p;
+		}
+
+		static inline bool cunilogTimestampSeqTryBeginWrite (uint32_t *p, uint32_t seq)
+		{
+			return	(LONG) seq == InterlockedCompareExchange	(
+									(LONG volatile *) p, (LONG) (seq + 1), (LONG) seq
+																);
+		}
+
+		static inline void cunilogTimestampSeqEndWrite (uint32_t *p, uint32_t seq)
+		{
+			InterlockedExchange ((LONG volatile *) p, (LONG) (seq + 2));
+		}
+
+		static inline void cunilogTimestampCacheLoad (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			pd->tSec	= *(int64_t volatile *) &ps->tSec;
+			pd->uts		= *(UBF_TIMESTAMP volatile *) &ps->uts;
+		}
+
+		static inline void cunilogTimestampCacheStore (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			*(int64_t volatile *) &pd->tSec			= ps->tSec;
+			*(UBF_TIMESTAMP volatile *) &pd->uts	= ps->uts;
+		}
+	#else
+		static inline uint32_t cunilogTimestampSeqBeginRead (uint32_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+		}
+
+		static inline bool cunilogTimestampSeqEndRead (uint32_t *p, uint32_t seq)
+		{
+			__atomic_thread_fence (__ATOMIC_ACQUIRE);
+			return 0 == (seq & 1) && seq == __atomic_load_n (p, __ATOMIC_RELAXED);
+		}
+
+		static inline bool cunilogTimestampSeqTryBeginWrite (uint32_t *p, uint32_t seq)
+		{
+			bool b = __atomic_compare_exchange_n	(
+						p, &seq, seq + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+													);
+			__atomic_thread_fence (__ATOMIC_RELEASE);
+			return b;
+		}
+
+		static inline void cunilogTimestampSeqEndWrite (uint32_t *p, uint32_t seq)
+		{
+			__atomic_store_n (p, seq + 2, __ATOMIC_RELEASE);
+		}
+
+		static inline void cunilogTimestampCacheLoad (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			pd->tSec	= __atomic_load_n (&ps->tSec, __ATOMIC_RELAXED);
+			pd->uts		= __atomic_load_n (&ps->uts, __ATOMIC_RELAXED);
+		}
+
+		static inline void cunilogTimestampCacheStore (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			__atomic_store_n (&pd->tSec, ps->tSec, __ATOMIC_RELAXED);
+			__atomic_store_n (&pd->uts, ps->uts, __ATOMIC_RELAXED);
+		}
+	#endif
+#endif
+
+void InitSCUNILOGNPI (SCUNILOGNPI *pni)
+{
+	ubf_assert_non_NULL (pni);
+
+	initSMEMBUF (&pni->smbRotMask);
+	pni->lenRotMask			= 0;
+	pni->nIgnoredTotal		= 0;
+	pni->pNextVecCunilogFls	= NULL;
+}
+
+void DoneSCUNILOGNPI (SCUNILOGNPI *pni)
+{
+	ubf_assert_non_NULL (pni);
+
+	if (isUsableSMEMBUF (&pni->smbRotMask))
+		doneSMEMBUF (&pni->smbRotMask);
+}
+
+/*
+	ObtainCurrentWorkingDirectoy
+
+	Returns the current working directory with an ending forward or backslash as
+	an SMEMBUF. Should probably go in its own module at some point as it certainly
+	does not belong here.
+
+	The function returns the amount of characters it has written to the buffer of
+	the SMEMBUF structure, not including a terminating NUL character.
+*/
+static size_t ObtainCurrentWorkingDirectoy (SMEMBUF *mb)
+{
+	ubf_assert_non_NULL (mb);
+	ubf_assert (isInitialisedSMEMBUF (mb));
+
+	size_t	r = 0;
+
+	#if defined (PLATFORM_IS_WINDOWS)
+
+		WCHAR wc [1];
+		DWORD dw = GetCurrentDirectoryW (1, wc);
+		WCHAR *pw = malloc (sizeof (WCHAR) * dw + sizeof (WCHAR));
+		if (pw)
+		{
+			DWORD dn = GetCurrentDirectoryW (dw, pw);
+			ubf_assert (dn);
+			ubf_assert (dn < dw);
+			if (dn)
+			{
+				int rq = reqUTF8sizeFromUTF16wchars (dn);
+				growToSizeSMEMBUF (mb, rq);
+				if (isUsableSMEMBUF (mb))
+				{
+					int n = UTF8_from_WinU16 (mb->buf.pch, rq, pw);
+					if (n)
+					{
+						mb->buf.pch [n - 1]	= '\\';
+						mb->buf.pch [n]		= '\0';
+					}
+					r = n;
+				}
+			}
+			free (pw);
+		}
+
+	#elif defined (PLATFORM_IS_POSIX)
+
+		size_t	siz		= 32;
+		char	*pr		= NULL;
+		bool	rtry	= true;
+
+		while (rtry)
+		{
+			growToSizeSMEMBUF (mb, siz + 1);
+			if (isUsableSMEMBUF (mb))
+			{
+				pr = getcwd (mb->buf.pch, siz);
+				if (pr)
+				{
+					size_t l = strlen (pr);
+					pr [l]		= '/';
+					pr [l + 1]	= '\0';
+					r = l + 1;
+					rtry = false;
+				} else
+				{
+					if (ERANGE == errno)
+						siz += 32;
+					else
+						rtry = false;
+				}
+			}
+		}
+
+	#else
+
+		#error Not supported!
+
+	#endif
+
+	return r;
+}
+
+static size_t ObtainRelativeLogPathBase (SMEMBUF *mb, enCunilogRelPath relLogPath)
+{
+	switch (relLogPath)
+	{
+		#ifdef DEBUG
+		case cunilogPath_isAbsolute:
+			ubf_assert_msg (false, "This should have been caught before we got here");
+			// Hopefully this causes an access violation/segmentation fault.
+			return CUNILOG_SIZE_ERROR;
+		#endif
+		case cunilogPath_relativeToExecutable:
+			return ObtainPathFromExecutableModule (mb);
+		case cunilogPath_relativeToCurrentDir:
+			return ObtainCurrentWorkingDirectoy (mb);
+		case cunilogPath_relativeToHomeDir:
+			return ObtainUserHomeDirectoy (mb);
+	}
+	return 0;
+}
+
+bool CunilogGetAbsPathFromAbsOrRelPath	(
+		SMEMBUF				*psmb,
 		size_t				*plmb,
 		const char			*szAbsOrRelPath,
 		size_t				lnAbsOrRelPath,
@@ -21841,6 +23215,7 @@ enum cunilogprocessfrequency frequencyTbl [] =
 	/* cunilogPostfixDotNumberWeekly	*/		,	cunilogProcessAppliesTo_WeekChanged
 	/* cunilogPostfixDotNumberMonthly	*/		,	cunilogProcessAppliesTo_MonthChanged
 	/* cunilogPostfixDotNumberYearly	*/		,	cunilogProcessAppliesTo_YearChanged
+	/* cunilogPostfixDotNumberSize		*/		,	cunilogProcessAppliesTo_nOctets
 };
 
 static inline enum cunilogprocessfrequency defaultFrequencyFromPostfix (CUNILOG_TARGET *put)
@@ -21869,7 +23244,7 @@ static inline bool hasDotNumberPostfix (CUNILOG_TARGET *put)
 
 	return	(
 					cunilogPostfixDotNumberMinutely	<= put->culogPostfix
-				&&	cunilogPostfixDotNumberYearly	>= put->culogPostfix
+				&&	cunilogPostfixDotNumberSize		>= put->culogPostfix
 			);
 }
 
@@ -21929,6 +23304,13 @@ static inline void defaultProcessorParameters (CUNILOG_TARGET *put)
 		{
 			case cunilogProcessRotateLogfiles:
 				prCurr = cp->pData;
+				// The retention policy relies on the sizes and times kept with the index.
+				if (cunilogHasRotatorRetention (prCurr))
+					cunilogTargetSetFLSindex (put);
+				#ifdef PLATFORM_IS_POSIX
+					// readdir () returns the files in no particular order.
+					cunilogTargetSetFSneedsSorting	(put);
+				#endif
 				if (hasDotNumberPostfix (put))
 				{	// For this rotator the trick with remembering how many files we've
 					//	had so far doesn't work. However, we need to sort the retrieved
@@ -21974,9 +23356,45 @@ static inline void zeroProcessors (CUNILOG_TARGET *put)
 
 	put->cprocessors	= NULL;
 	put->nprocessors	= 0;
+	put->plan			= NULL;
+	put->nplan			= 0;
+	put->batches		= NULL;
+}
+
+static bool compileProcessorPlan (CUNILOG_TARGET *put);
+
+static inline void DoneCUNILOG_TARGETplan (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (put->plan)
+	{
+		ubf_free (put->plan);
+		put->plan	= NULL;
+		put->nplan	= 0;
+	}
+	if (put->batches)
+	{
+		unsigned int n;
+		for (n = 0; n < put->nprocessors; ++ n)
+		{
+			ubf_assert_0 (put->batches [n].nevs);
+			if (put->batches [n].pbes)
+				ubf_free (put->batches [n].pbes);
+			if (put->batches [n].pofs)
+				ubf_free (put->batches [n].pofs);
+		}
+		ubf_free (put->batches);
+		put->batches = NULL;
+	}
 }
 
 static void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETmaintenance (CUNILOG_TARGET *put);
+#else
+	#define DoneCUNILOG_TARGETmaintenance(put)
+#endif
 
 /*
 	In the target initialisers zeroProcessors () must be called before prepareProcessors ().
@@ -22001,6 +23419,10 @@ static bool prepareProcessors (CUNILOG_TARGET *put, CUNILOG_PROCESSOR **cp, unsi
 	}
 	*/
 
+	// The plan of a previous processor list might be too small. This needs to be done
+	//	before the list is replaced as the batches are parallel to it.
+	DoneCUNILOG_TARGETplan (put);
+
 	if (NULL == cp || 0 == np)
 	{
 		ubf_assert (NULL == cp);
@@ -22020,7 +23442,7 @@ static bool prepareProcessors (CUNILOG_TARGET *put, CUNILOG_PROCESSOR **cp, unsi
 		put->nprocessors = np;
 	}
 	defaultProcessorParameters (put);
-	return true;
+	return compileProcessorPlan (put);
 }
 
 static inline void createLogfilesSearchMaskDotNumberPostfix (CUNILOG_TARGET *put)
@@ -22040,6 +23462,11 @@ static inline void createLogfilesSearchMaskDotNumberPostfix (CUNILOG_TARGET *put
 	ubf_assert (strlen (put->mbLogFileMask.buf.pcc) == put->lnLogFileMask);
 }
 
+/*
+	The search mask ends with a wildcard after the ".log" extension to also pick up the
+	logfiles that rotators with the task cunilogrotationtask_ExtCompressLogfiles have
+	compressed. See isLogfileOrExtCompressedName ().
+*/
 static inline void createLogfilesSearchMask (CUNILOG_TARGET *put)
 {
 	// Create the wildcard/search mask.
@@ -22055,11 +23482,18 @@ static inline void createLogfilesSearchMask (CUNILOG_TARGET *put)
 		+	put->lnAppName + 1
 		+	lenDateTimeStampFromPostfix (put->culogPostfix),
 		szCunilogLogFileNameExtension,
-		sizCunilogLogFileNameExtension
+		lenCunilogLogFileNameExtension
 			);
+	char *szAster =		put->mbLogFileMask.buf.pch
+					+	put->lnAppName + 1
+					+	lenDateTimeStampFromPostfix (put->culogPostfix)
+					+	lenCunilogLogFileNameExtension;
+	memcpy (szAster, "*", 2);
 	put->lnLogFileMask	=	put->lnAppName + 1
 						+	lenDateTimeStampFromPostfix (put->culogPostfix)
-						+	lenCunilogLogFileNameExtension;
+						+	lenCunilogLogFileNameExtension
+						+	1;
+	ubf_assert (strlen (put->mbLogFileMask.buf.pcc) == put->lnLogFileMask);
 }
 
 static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
@@ -22106,6 +23540,9 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 	// We also need an underscore in the search mask for LogPostfixes.
 	if (hasLogPostfix (put))
 		++ stRequiredForLogFileMask;
+	// And the wildcard for compressed logfiles. See createLogfilesSearchMask ().
+	if (!hasDotNumberPostfix (put))
+		++ stRequiredForLogFileMask;
 
 	initSMEMBUFtoSize (&put->mbLogFileMask, stRequiredForLogFileMask);
 	if (isUsableSMEMBUF (&put->mbLogFileMask))
@@ -22176,14 +23613,20 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 				// See
 				//	https://learn.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createsemaphorew .
 				put->sm.hSemaphore = CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
-				if (NULL == put->sm.hSemaphore)
+				put->smQueueSpace.hSemaphore = CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
+				if (NULL == put->sm.hSemaphore || NULL == put->smQueueSpace.hSemaphore)
 					SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
-				return NULL != put->sm.hSemaphore;
+				return NULL != put->sm.hSemaphore && NULL != put->smQueueSpace.hSemaphore;
 				
 			#else
 			
 				int i = sem_init (&put->sm.tSemaphore, 0, 0);
 				ubf_assert (0 == i);
+				if (0 == i)
+				{
+					i = sem_init (&put->smQueueSpace.tSemaphore, 0, 0);
+					ubf_assert (0 == i);
+				}
 				if (0 != i)
 					SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
 				return 0 == i;
@@ -22207,11 +23650,16 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 			#ifdef OS_IS_WINDOWS
 				bool b = CloseHandle (put->sm.hSemaphore);
 				ubf_assert_true (b);
+				b = CloseHandle (put->smQueueSpace.hSemaphore);
+				ubf_assert_true (b);
 				UNUSED (b);
 				put->sm.hSemaphore = NULL;
+				put->smQueueSpace.hSemaphore = NULL;
 			#else
 				int i = sem_destroy (&put->sm.tSemaphore);
 				ubf_assert (0 == i);
+				i = sem_destroy (&put->smQueueSpace.tSemaphore);
+				ubf_assert (0 == i);
 				UNUSED (i);
 			#endif
 		}
@@ -22230,6 +23678,7 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 			put->qu.first	= NULL;
 			put->qu.last	= NULL;
 			put->qu.num		= 0;
+			put->qu.head	= NULL;
 		}
 		// If no semaphore is required, not creating it is seen as success.
 		return true;
@@ -22392,11 +23841,30 @@ static inline void initFilesListInCUNILOG_TARGET (CUNILOG_TARGET *put)
 
 	vec_init (&put->fls);
 	InitSBULKMEM (&put->sbm, CUNILOG_STD_BULK_ALLOC_SIZE);
+	put->stFLSorphaned = 0;
+	#ifdef CUNILOG_HAVE_INOTIFY
+		put->fdFLSwatch = -1;
+	#endif
 
 	// Note that we do not allocate any bulk memory here yet. If for instance the caller
 	//	hasn't provided a rotation processor we may not even need one.
 }
 
+#ifdef CUNILOG_HAVE_INOTIFY
+	static void DoneCUNILOG_TARGETflsWatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 != put->fdFLSwatch)
+		{
+			close (put->fdFLSwatch);
+			put->fdFLSwatch = -1;
+		}
+	}
+#else
+	#define DoneCUNILOG_TARGETflsWatch(x)
+#endif
+
 static inline void initPrevTimestamp (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
@@ -22427,6 +23895,10 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	// The name of the active logfile never changes for .log and dot number postfixes.
+	//	The rotator closes and reopens it when it renames it.
+	if (hasDotNumberPostfix (put) || hasLogPostfix (put))
+		return false;
 
 	int r = memcmp	(
 				put->szDateTimeStamp, put->cPrevDateTimeStamp,
@@ -22435,9 +23907,28 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 	return r > 0;
 }
 
-#ifdef PLATFORM_IS_POSIX
-	// The plain logging folder name is not used on Windows. It is only required
-	//	for opendir () on POSIX. This might change in the future as I can imagine
+/*
+	Remembers the date/timestamp postfix of the logfile just opened, so that
+	requiresNewLogFile () only returns true again when the postfix changes, instead of for
+	every event until the next time the logfile name is updated.
+
+	Logfiles with .log or dot number postfixes never require a new logfile and are
+	therefore not affected.
+*/
+static inline void setLogFileDateTimeStampInUse (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (put->szDateTimeStamp && cunilogPostfixYear >= put->culogPostfix)
+		memcpy	(
+			put->cPrevDateTimeStamp, put->szDateTimeStamp,
+			lenDateTimeStampFromPostfix (put->culogPostfix)
+				);
+}
+
+#ifdef PLATFORM_IS_POSIX
+	// The plain logging folder name is not used on Windows. It is only required
+	//	for opendir () on POSIX. This might change in the future as I can imagine
 	//	that some custom processor might also benefit from it.
 	static void InitCUNILOG_TARGETmbLogFold (CUNILOG_TARGET *put)
 	{
@@ -22459,14 +23950,45 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 			memcpy (put->mbLogFold.buf.pch, put->mbLogPath.buf.pch, lenLogp);
 			put->mbLogFold.buf.pch [lenLogp] = '\0';
 			put->lnLogFold = lenLogp;
+			put->fdLogFold = -1;
 			return;
 		}
 		// We should never get here.
 		ubf_assert (false);
 		put->lnLogFold = 0;
+		put->fdLogFold = -1;
+	}
+
+	/*
+		Returns the directory file descriptor of the logging folder mbLogFold, which is
+		opened on first use and stays open until the target is destroyed, or until a
+		rename fails because the folder has been deleted and created again. Rotators use it
+		with renameat () to move logfiles without resolving the folder again each time.
+		Returns -1 if the folder cannot be opened, in which case errno is set.
+	*/
+	static int cunilogLogFoldFD (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (isUsableSMEMBUF (&put->mbLogFold));
+
+		if (-1 == put->fdLogFold)
+			put->fdLogFold = open (put->mbLogFold.buf.pcc, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		return put->fdLogFold;
+	}
+
+	static void DoneCUNILOG_TARGETfdLogFold (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 != put->fdLogFold)
+		{
+			close (put->fdLogFold);
+			put->fdLogFold = -1;
+		}
 	}
 #else
 	#define InitCUNILOG_TARGETmbLogFold(x)
+	#define DoneCUNILOG_TARGETfdLogFold(x)
 #endif
 
 static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
@@ -22476,7 +23998,203 @@ static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
 	#ifdef OS_IS_WINDOWS
 		put->logfile.hLogFile = NULL;
 	#else
-		put->logfile.fLogFile = NULL;
+		put->logfile.fLogFile	= NULL;
+		put->logfile.fdLogFile	= -1;
+		put->logfile.pMap		= NULL;
+		put->logfile.lnMap		= 0;
+		put->logfile.ofsMap		= 0;
+		put->logfile.ullMapBase	= 0;
+		put->logfile.lnMapChunk	= CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE;
+	#endif
+	put->logfile.ullSize		= 0;
+	put->logfile.ullSizeEvt		= 0;
+	put->logfile.ullSizePrv		= 0;
+	put->logfile.bSizeUnseen	= true;
+}
+
+#ifndef OS_IS_WINDOWS
+	/*
+		Preallocates and maps lnMapChunk octets of the logfile, starting with the page
+		that contains the file offset ullEnd. The offset ullEnd is the real end of the
+		logfile, i.e. where the next event line goes.
+	*/
+	static bool cunilogMapLogFileAt (CUNILOG_TARGET *put, uint64_t ullEnd)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->logfile.pMap);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		uint64_t		ullPage	= (uint64_t) sysconf (_SC_PAGESIZE);
+		uint64_t		ullBase	= ullEnd - ullEnd % ullPage;
+
+		// Where to continue if anything goes wrong.
+		pl->ullMapBase	= ullEnd;
+		pl->ofsMap		= 0;
+		pl->lnMap		= 0;
+
+		#ifdef OS_IS_LINUX
+			int e = posix_fallocate	(
+						pl->fdLogFile, (off_t) ullBase, (off_t) pl->lnMapChunk
+									);
+			// Not every file system supports preallocation.
+			if (e && (EOPNOTSUPP != e || ftruncate (pl->fdLogFile, (off_t) (ullBase + pl->lnMapChunk))))
+				return false;
+		#else
+			if (ftruncate (pl->fdLogFile, (off_t) (ullBase + pl->lnMapChunk)))
+				return false;
+		#endif
+		void *pv = mmap	(
+						NULL, pl->lnMapChunk, PROT_READ | PROT_WRITE, MAP_SHARED,
+						pl->fdLogFile, (off_t) ullBase
+						);
+		if (MAP_FAILED == pv)
+			return false;
+		pl->pMap		= pv;
+		pl->lnMap		= pl->lnMapChunk;
+		pl->ullMapBase	= ullBase;
+		pl->ofsMap		= (size_t) (ullEnd - ullBase);
+		return true;
+	}
+
+	/*
+		Returns the real end of a memory-mapped logfile with a size of ullSize octets,
+		which is where its trailing NUL octets start. Trailing NUL octets are left behind
+		by a process that terminated without closing the logfile. They can't be more than
+		a chunk.
+	*/
+	static uint64_t cunilogMappedLogFileEnd (CUNILOG_TARGET *put, uint64_t ullSize)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		uint64_t		ullPage	= (uint64_t) sysconf (_SC_PAGESIZE);
+		uint64_t		ullFrom	= ullSize > pl->lnMapChunk ? ullSize - pl->lnMapChunk : 0;
+		uint64_t		ullBase	= ullFrom - ullFrom % ullPage;
+		size_t			ln		= (size_t) (ullSize - ullBase);
+
+		if (0 == ullSize)
+			return 0;
+		char *pc = mmap (NULL, ln, PROT_READ, MAP_SHARED, pl->fdLogFile, (off_t) ullBase);
+		if (MAP_FAILED == pc)
+			return ullSize;
+		while (ln && ASCII_NUL == pc [ln - 1])
+			-- ln;
+		munmap (pc, (size_t) (ullSize - ullBase));
+		return ullBase + ln;
+	}
+
+	static bool cunilogOpenMappedLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		struct stat		st;
+
+		pl->fdLogFile = open	(
+					put->mbLogfileName.buf.pcc,
+					CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS, CUNILOG_DEFAULT_RAW_OPEN_PERMS
+								);
+		if (0 > pl->fdLogFile)
+			return false;
+		if (0 == fstat (pl->fdLogFile, &st))
+		{
+			uint64_t ullEnd = cunilogMappedLogFileEnd (put, (uint64_t) st.st_size);
+			if	(
+						(
+								ullEnd == (uint64_t) st.st_size
+							||	0 == ftruncate (pl->fdLogFile, (off_t) ullEnd)
+						)
+					&&	cunilogMapLogFileAt (put, ullEnd)
+				)
+				return true;
+		}
+		close (pl->fdLogFile);
+		pl->fdLogFile = -1;
+		return false;
+	}
+
+	/*
+		Unmaps the current chunk and truncates the logfile to the octets written.
+	*/
+	static void cunilogUnmapLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+
+		if (pl->pMap)
+		{
+			munmap (pl->pMap, pl->lnMap);
+			pl->pMap = NULL;
+		}
+		if (ftruncate (pl->fdLogFile, (off_t) (pl->ullMapBase + pl->ofsMap)))
+			ubf_assert (false);
+	}
+
+	/*
+		Copies the n buffers of the array piov points to into the mapping, and maps the
+		next chunk whenever the current one is full.
+	*/
+	static bool cunilogMappedWritevToLogFile (CUNILOG_TARGET *put, struct iovec *piov, int n)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (piov);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+
+		for (int i = 0; i < n; ++ i)
+		{
+			const char	*pc	= piov [i].iov_base;
+			size_t		ln	= piov [i].iov_len;
+
+			while (ln)
+			{
+				if (pl->ofsMap == pl->lnMap)
+				{
+					uint64_t ullEnd = pl->ullMapBase + pl->ofsMap;
+					if (pl->pMap)
+					{
+						munmap (pl->pMap, pl->lnMap);
+						pl->pMap = NULL;
+					}
+					if (!cunilogMapLogFileAt (put, ullEnd))
+						return false;
+				}
+				size_t lnCpy = ln < pl->lnMap - pl->ofsMap ? ln : pl->lnMap - pl->ofsMap;
+				memcpy (pl->pMap + pl->ofsMap, pc, lnCpy);
+				pl->ofsMap	+= lnCpy;
+				pc			+= lnCpy;
+				ln			-= lnCpy;
+			}
+		}
+		return true;
+	}
+#endif
+
+/*
+	Obtains the size of the logfile that has just been opened. New event lines are
+	appended to it. The next event that triggers rotators is the first one that can make
+	them rotate the logfile by size. See hasLogfileReachedRotationSize ().
+*/
+static inline void cunilogObtainLogFileSize (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_LOGFILE	*pl	= &put->logfile;
+
+	pl->ullSize		= 0;
+	pl->bSizeUnseen	= true;
+	#ifdef PLATFORM_IS_WINDOWS
+		LARGE_INTEGER	li;
+		if (GetFileSizeEx (pl->hLogFile, &li))
+			pl->ullSize = (uint64_t) li.QuadPart;
+	#else
+		struct stat		st;
+		if (cunilogHasMappedLogfile (put))
+			pl->ullSize = pl->ullMapBase + pl->ofsMap;
+		else
+		if (0 == fstat (cunilogHasRawLogfile (put) ? pl->fdLogFile : fileno (pl->fLogFile), &st))
+			pl->ullSize = (uint64_t) st.st_size;
 	#endif
 }
 
@@ -22485,6 +24203,16 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 	ubf_assert_non_NULL	(put);
 	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
 
+	bool b;
+
+	/*
+		A compressed logfile that ends in a frame torn by a crash, or that has been written
+		uncompressed before, can't be read by the decompression tools. We cut the torn frame
+		off or compress the existing content first. If this fails we append anyway.
+	*/
+	if (put->wb.pfr)
+		ExtCompressFramesRepairFile (put->wb.pfr, put->mbLogfileName.buf.pcc);
+
 	#ifdef PLATFORM_IS_WINDOWS
 		put->logfile.hLogFile = CreateFileU8	(
 						put->mbLogfileName.buf.pcc,
@@ -22494,11 +24222,218 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 						FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
 						NULL
 									);
-		return NULL != put->logfile.hLogFile && INVALID_HANDLE_VALUE != put->logfile.hLogFile;
+		b = NULL != put->logfile.hLogFile && INVALID_HANDLE_VALUE != put->logfile.hLogFile;
 	#else
-		// We always (and automatically) append.
-		put->logfile.fLogFile = fopen (put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE);
-		return NULL != put->logfile.fLogFile;
+		if (cunilogHasMappedLogfile (put))
+			b = cunilogOpenMappedLogFile (put);
+		else
+		if (cunilogHasRawLogfile (put))
+		{	// We always (and automatically) append.
+			put->logfile.fdLogFile = open	(
+						put->mbLogfileName.buf.pcc,
+						CUNILOG_DEFAULT_RAW_OPEN_FLAGS, CUNILOG_DEFAULT_RAW_OPEN_PERMS
+											);
+			b = 0 <= put->logfile.fdLogFile;
+		} else
+		{
+			put->logfile.fLogFile = fopen (put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE);
+			b = NULL != put->logfile.fLogFile;
+		}
+	#endif
+	if (b)
+		cunilogObtainLogFileSize (put);
+	return b;
+}
+
+#ifndef OS_IS_WINDOWS
+	static inline void cunilogCloseLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (0 <= put->logfile.fdLogFile)
+		{
+			if (cunilogHasMappedLogfile (put))
+				cunilogUnmapLogFile (put);
+			close (put->logfile.fdLogFile);
+			put->logfile.fdLogFile = -1;
+		}
+		if (put->logfile.fLogFile)
+		{
+			fclose (put->logfile.fLogFile);
+			put->logfile.fLogFile = NULL;
+		}
+	}
+#endif
+
+#ifndef OS_IS_WINDOWS
+	// The file descriptor of the open logfile.
+	static inline int cunilogLogFileDescriptor (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		return cunilogHasRawLogfile (put) ? put->logfile.fdLogFile : fileno (put->logfile.fLogFile);
+	}
+#endif
+
+static bool cunilogWriteBehindToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine);
+static bool cunilogWriteBehindToLogFileAndWait (CUNILOG_TARGET *put);
+
+#ifdef CUNILOG_HAVE_IO_URING
+	static inline void InitCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+
+		pur->fdRing			= -1;
+		pur->pSQ			= NULL;
+		pur->lnSQ			= 0;
+		pur->pCQ			= NULL;
+		pur->lnCQ			= 0;
+		pur->sqes			= NULL;
+		pur->lnSQEs			= 0;
+		pur->buf			= NULL;
+		pur->siz			= 0;
+		pur->len			= 0;
+		pur->nInFlight		= 0;
+		pur->bSyncInFlight	= false;
+	}
+
+	/*
+		Unmaps the rings and closes the io_uring. Nothing must be in flight anymore.
+	*/
+	static void DoneCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+		ubf_assert_0 (pur->nInFlight);
+
+		if (pur->sqes && MAP_FAILED != (void *) pur->sqes)
+			munmap (pur->sqes, pur->lnSQEs);
+		if (pur->pCQ && MAP_FAILED != pur->pCQ && pur->pCQ != pur->pSQ)
+			munmap (pur->pCQ, pur->lnCQ);
+		if (pur->pSQ && MAP_FAILED != pur->pSQ)
+			munmap (pur->pSQ, pur->lnSQ);
+		if (0 <= pur->fdRing)
+			close (pur->fdRing);
+		if (pur->buf)
+			ubf_free (pur->buf);
+		InitCUNILOG_IOURING (pur);
+	}
+
+	/*
+		Returns true if the kernel supports the opcodes the logfile is written with. Kernels
+		too old to answer IORING_REGISTER_PROBE don't support IORING_OP_WRITE either.
+	*/
+	static bool cunilogIoUringProbeOps (int fdRing)
+	{
+		unsigned int			n	= IORING_OP_WRITE + 1;
+		struct io_uring_probe	*pp;
+		bool					b;
+
+		pp = ubf_calloc (1, sizeof (struct io_uring_probe) + n * sizeof (struct io_uring_probe_op));
+		if (NULL == pp)
+			return false;
+		b =		0 <= syscall (__NR_io_uring_register, fdRing, IORING_REGISTER_PROBE, pp, n)
+			&&	IORING_OP_WRITE <= pp->last_op
+			&&	pp->ops [IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED
+			&&	pp->ops [IORING_OP_FSYNC].flags & IO_URING_OP_SUPPORTED;
+		ubf_free (pp);
+		return b;
+	}
+
+	/*
+		Sets up an io_uring with room for a write that is linked to a datasync, and maps
+		its rings. Returns false if the kernel doesn't provide io_uring, doesn't support
+		the opcodes required, or doesn't allow this process to use it.
+	*/
+	static bool SetupCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+		ubf_assert (0 > pur->fdRing);
+
+		struct io_uring_params	p;
+		unsigned char			*pc;
+
+		memset (&p, 0, sizeof (p));
+		pur->fdRing = (int) syscall (__NR_io_uring_setup, 2, &p);
+		if (0 > pur->fdRing)
+			return false;
+		if (!cunilogIoUringProbeOps (pur->fdRing))
+			return false;
+		pur->lnSQ = p.sq_off.array + p.sq_entries * sizeof (unsigned int);
+		pur->lnCQ = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+		if (p.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			pur->lnSQ = pur->lnCQ > pur->lnSQ ? pur->lnCQ : pur->lnSQ;
+			pur->lnCQ = 0;
+		}
+		pur->pSQ = mmap	(
+						NULL, pur->lnSQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_SQ_RING
+						);
+		if (MAP_FAILED == pur->pSQ)
+			return false;
+		pur->pCQ = pur->lnCQ
+					? mmap	(
+						NULL, pur->lnCQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_CQ_RING
+							)
+					: pur->pSQ;
+		if (MAP_FAILED == pur->pCQ)
+			return false;
+		pur->lnSQEs = p.sq_entries * sizeof (struct io_uring_sqe);
+		pur->sqes = mmap	(
+						NULL, pur->lnSQEs, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_SQES
+							);
+		if (MAP_FAILED == (void *) pur->sqes)
+			return false;
+		pc = pur->pSQ;
+		pur->sqHead		= (unsigned int *) (pc + p.sq_off.head);
+		pur->sqTail		= (unsigned int *) (pc + p.sq_off.tail);
+		pur->sqMask		= (unsigned int *) (pc + p.sq_off.ring_mask);
+		pur->sqArray	= (unsigned int *) (pc + p.sq_off.array);
+		pc = pur->pCQ;
+		pur->cqHead		= (unsigned int *) (pc + p.cq_off.head);
+		pur->cqTail		= (unsigned int *) (pc + p.cq_off.tail);
+		pur->cqMask		= (unsigned int *) (pc + p.cq_off.ring_mask);
+		pur->cqes		= (struct io_uring_cqe *) (pc + p.cq_off.cqes);
+		return true;
+	}
+#endif
+
+static inline void InitCUNILOG_TARGETwriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	put->wb.buf			= NULL;
+	put->wb.siz			= 0;
+	put->wb.len			= 0;
+	put->wb.ullLatency	= UINT64_MAX;
+	put->wb.policy		= cunilogWriteBehindWhenFull;
+	put->wb.nSyncOctets	= 0;
+	put->wb.nUnsynced	= 0;
+	put->wb.nWrites		= 0;
+	put->wb.pfr			= NULL;
+	#ifdef CUNILOG_HAVE_IO_URING
+		InitCUNILOG_IOURING (&put->wb.ur);
+	#endif
+}
+
+static inline void DoneCUNILOG_TARGETwriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+	// The logfile has been closed already, which wrote out the buffer.
+	ubf_assert_0 (put->wb.len);
+
+	if (put->wb.buf)
+	{
+		ubf_free (put->wb.buf);
+		put->wb.buf = NULL;
+		put->wb.siz = 0;
+	}
+	DoneEXTCMPFRAMER (put->wb.pfr);
+	put->wb.pfr = NULL;
+	#ifdef CUNILOG_HAVE_IO_URING
+		DoneCUNILOG_IOURING (&put->wb.ur);
 	#endif
 }
 
@@ -22506,6 +24441,7 @@ static inline void cunilogCloseCUNILOG_LOGFILEifOpen (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	cunilogWriteBehindToLogFileAndWait (put);
 	#ifdef OS_IS_WINDOWS
 		if (put->logfile.hLogFile)
 		{
@@ -22513,14 +24449,23 @@ static inline void cunilogCloseCUNILOG_LOGFILEifOpen (CUNILOG_TARGET *put)
 			put->logfile.hLogFile = NULL;
 		}
 	#else
-		if (put->logfile.fLogFile)
-		{
-			fclose (put->logfile.fLogFile);
-			put->logfile.fLogFile = NULL;
-		}
+		cunilogCloseLogFile (put);
 	#endif
 }
 
+static inline void initRotateAtSizeInCUNILOG_TARGET (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogPostfixDotNumberSize == put->culogPostfix)
+	{	// Size-triggered rotations can be frequent. The renames are applied to the
+		//	index instead of reading the logging folder each time.
+		put->ullRotateAtSize = CUNILOG_DEFAULT_ROTATE_AT_SIZE;
+		cunilogTargetSetFLSindex (put);
+	} else
+		put->ullRotateAtSize = 0;
+}
+
 static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
@@ -22535,9 +24480,40 @@ static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *pu
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 		put->nPendingNoRotEvts				= 0;
 		put->nPausedEvents					= 0;
+		put->nDbgQueueLocked				= 0;
+		put->nSepLogThreadIdle				= 0;
+		put->nSepLogThreadPosts				= 0;
+		put->nSepLogThreadWakeups			= 0;
+		put->nMaxQueuedEvents				= 0;
+		put->queueFullPolicy				= cunilogQueueFullBlock;
+		put->uiDropSeverities				= 0;
+		put->nBlockedProducers				= 0;
+		memset (put->nDroppedEvents, 0, sizeof (put->nDroppedEvents));
+		put->tlsStaging.bCreated			= false;
+		put->stagings						= NULL;
+		put->bStaging						= false;
+		put->bStagingClosed					= false;
+		put->nStagingEvents					= SIZE_MAX;
+		put->nStagingOctets					= SIZE_MAX;
+		put->ullStagingLatency				= UINT64_MAX;
+		put->pool							= NULL;
+		put->pmt							= NULL;
+		put->pevDeferred					= NULL;
+		put->szBatchLines					= NULL;
+		put->szBatchLinesSize				= 0;
+		put->lnBatchLines					= 0;
+		put->pevBatchLine					= NULL;
+		put->ofsBatchLine					= 0;
+		initSMEMBUF							(&put->mbEchoBatch);
+		put->lnEchoBatch					= 0;
+		put->seqTimestamps					= 0;
 	#endif
+	InitUBF_TIMESTAMP_CACHE					(&put->tsc);
+	InitCUNILOG_TSPREFIX					(&put->tsp);
+	InitCUNILOG_TARGETwriteBehind			(put);
 	put->dumpWidth							= enDataDumpWidth16;
 	put->evSeverityType						= cunilogEvtSeverityTypeDefault;
+	put->uiLogSeverities					= CUNILOG_SEVERITY_MASK_ALL;
 	initPrevTimestamp						(put);
 	InitCUNILOG_TARGETmbLogFold				(put);
 	InitCUNILOG_TARGETdumpstructs			(put);
@@ -22546,6 +24522,7 @@ static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *pu
 	InitCUNILOG_TARGETqueue					(put);
 	initFilesListInCUNILOG_TARGET			(put);
 	cunilogInitCUNILOG_LOGFILE				(put);
+	initRotateAtSizeInCUNILOG_TARGET		(put);
 	bool b;
 	b = StartSeparateLoggingThread_ifNeeded	(put);
 	if (b)
@@ -23043,6 +25020,107 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 	#endif
 #endif
 
+/*
+	Importance of the event severities for ConfigCUNILOG_TARGETminSeverity () and the
+	queue full policy cunilogQueueFullDropBelowSeverity. The higher the value, the more
+	important the severity. The order of the elements is the order of the enumeration
+	cunilogeventseverity. The same ranks decide which of the severity logging macros
+	CUNILOG_COMPILE_MIN_SEVERITY compiles out.
+*/
+static const unsigned char cunilogEvtSeverityRank [] =
+{
+		CUNILOG_SEVRANK_NONE							// cunilogEvtSeverityNone
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityNonePass
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityNoneFail
+	,	CUNILOG_SEVRANK_WARNING							// cunilogEvtSeverityNoneWarn
+	,	CUNILOG_SEVRANK_NONE							// cunilogEvtSeverityBlanks
+	,	CUNILOG_SEVRANK_EMERGENCY						// cunilogEvtSeverityEmergency
+	,	CUNILOG_SEVRANK_NOTICE							// cunilogEvtSeverityNotice
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityInfo
+	,	CUNILOG_SEVRANK_NOTICE							// cunilogEvtSeverityMessage
+	,	CUNILOG_SEVRANK_WARNING							// cunilogEvtSeverityWarning
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityError
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityPass
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityFail
+	,	CUNILOG_SEVRANK_CRITICAL						// cunilogEvtSeverityCritical
+	,	CUNILOG_SEVRANK_FATAL							// cunilogEvtSeverityFatal
+	,	CUNILOG_SEVRANK_DEBUG							// cunilogEvtSeverityDebug
+	,	CUNILOG_SEVRANK_TRACE							// cunilogEvtSeverityTrace
+	,	CUNILOG_SEVRANK_DETAIL							// cunilogEvtSeverityDetail
+	,	CUNILOG_SEVRANK_VERBOSE							// cunilogEvtSeverityVerbose
+	,	CUNILOG_SEVRANK_EMERGENCY						// cunilogEvtSeverityIllegal
+};
+
+void ConfigCUNILOG_TARGETseverityMask (CUNILOG_TARGET *put, uint32_t uiMask)
+{
+	ubf_assert_non_NULL (put);
+
+	cunilogAtomicStoreU32 (&put->uiLogSeverities, uiMask & CUNILOG_SEVERITY_MASK_ALL);
+}
+
+uint32_t cunilogSeverityMaskFromMin (cueventseverity sevMin)
+{
+	ubf_assert			(0 <= sevMin);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sevMin);
+
+	uint32_t	uiMask	= 0;
+	unsigned	sev;
+
+	for (sev = 0; sev < cunilogEvtSeverityXAmountEnumValues; ++ sev)
+	{
+		if (cunilogEvtSeverityRank [sev] >= cunilogEvtSeverityRank [sevMin])
+			uiMask |= CUNILOG_SEVERITY_BIT (sev);
+	}
+	return uiMask;
+}
+
+void ConfigCUNILOG_TARGETminSeverity (CUNILOG_TARGET *put, cueventseverity sevMin)
+{
+	ubf_assert_non_NULL	(put);
+
+	ConfigCUNILOG_TARGETseverityMask (put, cunilogSeverityMaskFromMin (sevMin));
+}
+
+void ConfigCUNILOG_PROCESSORfilter	(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+{
+	ubf_assert_non_NULL (cup);
+
+	cup->uiSkipSeverities	= ~ uiSeverities	& CUNILOG_SEVERITY_MASK_ALL;
+	cup->uiSkipEvtTypes		= ~ uiEvtTypes		& CUNILOG_EVTTYPES_ALL;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	void ConfigCUNILOG_TARGETqueueLimit	(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(0 <= policy);
+		ubf_assert			(cunilogQueueFullAmountEnumValues > policy);
+		ubf_assert			(0 <= sevThreshold);
+		ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sevThreshold);
+
+		uint32_t	uiDrop	= 0;
+		unsigned	sev;
+
+		for (sev = 0; sev < cunilogEvtSeverityXAmountEnumValues; ++ sev)
+		{
+			if (cunilogEvtSeverityRank [sev] < cunilogEvtSeverityRank [sevThreshold])
+				uiDrop |= (uint32_t) 1 << sev;
+		}
+		put->uiDropSeverities	= uiDrop;
+		put->queueFullPolicy	= policy;
+		put->nMaxQueuedEvents	= nMaxEvents;
+	}
+#endif
+
 #if defined (DEBUG) || defined (CUNILOG_BUILD_SHARED_LIBRARY)
 	void ConfigCUNILOG_TARGETrunProcessorsOnStartup (CUNILOG_TARGET *put, runProcessorsOnStartup rp)
 	{
@@ -23081,10 +25159,14 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 #endif
 
 /*
+	Disables the processors for task task of the target put points to if bDisable is true,
+	enables them otherwise, and compiles the processor plan of the target again. Only the
+	thread that processes the events of the target may call this function.
+
 	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
 	please don't forget to change it there too.
 */
-void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+void cunilogDisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task, bool bDisable)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert_non_NULL (put->cprocessors);
@@ -23093,33 +25175,61 @@ void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilo
 	while (n < put->nprocessors)
 	{
 		if (task == put->cprocessors [n]->task)
-			optCunProcSetOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
+		{
+			if (bDisable)
+				optCunProcSetOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
+			else
+				optCunProcClrOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
+		}
+		++ n;
 	}
+	compileProcessorPlan (put);
 }
 
 /*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
+	The separate logging thread runs the processor plan without holding the locker of
+	the target. The change is therefore handed over to it as a command event, which it
+	processes in order with the other events.
 */
-void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+static void cunilogDisableOrQueueTaskProcessors	(
+				CUNILOG_TARGET				*put,
+				enum cunilogprocesstask		task,
+				bool						bDisable
+												)
+{
+	ubf_assert_non_NULL	(put);
+
+	#if !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY) && !defined (CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS)
+		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
+		{
+			if (bDisable)
+				ChangeCUNILOG_TARGETdisableTaskProcessors (put, task);
+			else
+				ChangeCUNILOG_TARGETenableTaskProcessors (put, task);
+			return;
+		}
+	#endif
+	EnterCUNILOG_LOCKER (put);
+	cunilogDisableTaskProcessors (put, task, bDisable);
+	LeaveCUNILOG_LOCKER (put);
+}
+
+void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert_non_NULL (put->cprocessors);
 
-	unsigned int n = 0;
-	while (n < put->nprocessors)
-	{
-		if (task == put->cprocessors [n]->task)
-			optCunProcClrOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
-	}
+	cunilogDisableOrQueueTaskProcessors (put, task, true);
+}
+
+void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL (put->cprocessors);
+
+	cunilogDisableOrQueueTaskProcessors (put, task, false);
 }
 
-/*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
-*/
 void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
@@ -23128,10 +25238,6 @@ void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put)
 	ConfigCUNILOG_TARGETdisableTaskProcessors (put, cunilogProcessEchoToConsole);
 }
 
-/*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
-*/
 void ConfigCUNILOG_TARGETenableEchoProcessor (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
@@ -23206,6 +25312,7 @@ static void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put)
 		}
 	}
 
+	DoneCUNILOG_TARGETplan (put);
 	if (cunilogTargetHasProcessorsAllocatedFlag (put))
 	{
 		ubf_free (put->cprocessors);
@@ -23235,10 +25342,21 @@ static void DoneCUNILOG_TARGETpsdump (CUNILOG_TARGET *psu)
 	*/
 }
 
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETstaging (CUNILOG_TARGET *put);
+	static void DoneCUNILOG_TARGETeventPool (CUNILOG_TARGET *put);
+#else
+	#define DoneCUNILOG_TARGETstaging(put)
+	#define DoneCUNILOG_TARGETeventPool(put)
+#endif
+
 static void DoneCUNILOG_TARGETmembers (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	// Before anything the maintenance thread might still use goes away.
+	DoneCUNILOG_TARGETmaintenance (put);
+
 	if (cunilogTargetHasLogPathAllocatedFlag (put))
 		freeSMEMBUF (&put->mbLogPath);
 	if (cunilogTargetHasAppNameAllocatedFlag (put))
@@ -23255,10 +25373,23 @@ static void DoneCUNILOG_TARGETmembers (CUNILOG_TARGET *put)
 	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
 		freeSMEMBUF (&put->mbColEventLine);
 	#endif
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		ubf_assert_0 (put->lnEchoBatch);
+		if (isUsableSMEMBUF (&put->mbEchoBatch))
+			freeSMEMBUF (&put->mbEchoBatch);
+		ubf_assert_0 (put->lnBatchLines);
+		if (put->szBatchLines)
+			ubf_free (put->szBatchLines);
+	#endif
 
 	DoneSCUNILOGNPI (&put->scuNPI);
 	DoneCUNILOG_LOCKER (put);
+	DoneCUNILOG_TARGETstaging (put);
+	DoneCUNILOG_TARGETeventPool (put);
+	DoneCUNILOG_TARGETwriteBehind (put);
 	DoneCUNILOG_TARGETqueuesemaphore (put);
+	DoneCUNILOG_TARGETfdLogFold (put);
+	DoneCUNILOG_TARGETflsWatch (put);
 	vec_deinit (&put->fls);
 	DoneSBULKMEM (&put->sbm);
 	DoneCUNILOG_TARGETpsdump (put);
@@ -23482,2774 +25613,6867 @@ STRANSICOLOURSEQUENCE evtSeverityColours [cunilogEvtSeverityXAmountEnumValues] =
 		ubf_assert			(0 <= sev);
 		ubf_assert			(sev < cunilogEvtSeverityXAmountEnumValues);
 
-		if (evtSeverityColours [sev].lnColSequence)
+		if (evtSeverityColours [sev].lnColSequence)
+		{
+			memcpy (*sz, evtSeverityColours [sev].szColSequence, evtSeverityColours [sev].lnColSequence);
+			*sz += evtSeverityColours [sev].lnColSequence;
+		}
+	}
+	static inline void cpyRstEvtSeverityColour (char **sz, cueventseverity sev)
+	{
+		if (evtSeverityColours [sev].lnColSequence)
+		{
+			memcpy (*sz, STR_ANSI_RESET, LEN_ANSI_RESET);
+			*sz += LEN_ANSI_RESET;
+		}
+	}
+#else
+	#define cpyEvtSeverityColour(s, sev)
+	#define cpyRstEvtSeverityColour(s)
+#endif
+
+static inline size_t requiredEventSeverityChars (cueventseverity sev, cueventsevfmtpy tpy)
+{
+	// "" or "INF" + " ".
+	if (cunilogEvtSeverityBlanks > sev)
+			return 0;
+	switch (tpy)
+	{														// The + 1 is for a space character.
+		case cunilogEvtSeverityTypeChars3:					return 3 + 1;
+		case cunilogEvtSeverityTypeChars5:					return 5 + 1;
+		case cunilogEvtSeverityTypeChars9:					return 9 + 1;
+		case cunilogEvtSeverityTypeChars3InBrackets:		return 2 + 3 + 1;
+		case cunilogEvtSeverityTypeChars5InBrackets:		return 2 + 5 + 1;
+		case cunilogEvtSeverityTypeChars9InBrackets:		return 2 + 9 + 1;
+		case cunilogEvtSeverityTypeChars5InTightBrackets:	return 2 + 5 + 1;
+		case cunilogEvtSeverityTypeChars9InTightBrackets:	return 2 + 9 + 1;
+	}
+	ubf_assert_msg (false, "Internal error! We should never get here!");
+	return 0;
+}
+
+static inline size_t writeEventSeverity (char *szOut, cueventseverity sev, cueventsevfmtpy tpy)
+{
+	ubf_assert_non_NULL (szOut);
+	ubf_assert (0 <= sev);
+	ubf_assert (cunilogEvtSeverityXAmountEnumValues > sev);
+
+	if (cunilogEvtSeverityBlanks > sev)
+			return 0;
+
+	size_t len;
+
+	switch (tpy)
+	{
+		case cunilogEvtSeverityTypeChars3:					// "EMG"
+			memcpy (szOut, EventSeverityTexts3 [sev], 3);
+			szOut [3] = ' ';
+			return 3 + 1;
+		case cunilogEvtSeverityTypeChars5:					// "EMRGY"
+			memcpy (szOut, EventSeverityTexts5 [sev], 5);
+			szOut [5] = ' ';
+			return 5 + 1;
+		case cunilogEvtSeverityTypeChars9:					// "EMERGENCY"
+			memcpy (szOut, EventSeverityTexts9 [sev], 9);
+			szOut [9] = ' ';
+			return 9 + 1;
+		case cunilogEvtSeverityTypeChars3InBrackets:		// "[EMG]"
+			*szOut ++ = '[';
+			memcpy (szOut, EventSeverityTexts3 [sev], 3);
+			memcpy (szOut + 3, "] ", 2);
+			return 2 + 3 + 1;
+		case cunilogEvtSeverityTypeChars5InBrackets:		// "[FAIL ]"
+			*szOut ++ = '[';
+			memcpy (szOut, EventSeverityTexts5 [sev], 5);
+			memcpy (szOut + 5, "] ", 2);
+			return 2 + 5 + 1;
+		case cunilogEvtSeverityTypeChars9InBrackets:		// "[FAIL     ]"
+			*szOut ++ = '[';
+			memcpy (szOut, EventSeverityTexts9 [sev], 9);
+			memcpy (szOut + 9, "] ", 2);
+			return 2 + 9 + 1;
+		case cunilogEvtSeverityTypeChars5InTightBrackets:
+			len = strlen (EventSeverityTexts5tgt [sev]);
+			ubf_assert (len <= 5);
+			*szOut ++ = '[';
+			memcpy (szOut, EventSeverityTexts5tgt [sev], len);
+			memcpy (szOut + len, "] ", 2);
+			memset (szOut + len + 2, ' ', 5 - len);
+			return 2 + 5 + 1;
+		case cunilogEvtSeverityTypeChars9InTightBrackets:
+			len = strlen (EventSeverityTexts9tgt [sev]);
+			ubf_assert (len <= 9);
+			*szOut ++ = '[';
+			memcpy (szOut, EventSeverityTexts9tgt [sev], len);
+			memcpy (szOut + len, "] ", 2);
+			memset (szOut + len + 2, ' ', 9 - len);
+			return 2 + 9 + 1;
+	}
+	ubf_assert_msg (false, "Internal error! We should never get here!");
+	return 0;
+}
+
+static inline size_t requiredFullstopChars (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	return cunilogIsEventAutoFullstop (pev) ? 1 : 0;
+};
+
+static inline size_t writeFullStop (char *szOut, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (szOut);
+	ubf_assert_non_NULL (pev);
+
+	if (cunilogIsEventAutoFullstop (pev))
+	{
+		if (pev->lenDataToLog && '.' != pev->szDataToLog [pev->lenDataToLog - 1])
+		{
+			szOut [0] = '.';
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static inline size_t eventLenNewline (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	return lnLineEnding (pev->pCUNILOG_TARGET->unilogNewLine);
+}
+
+static inline enum enLineEndings eventLineEnding (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	return pev->pCUNILOG_TARGET->unilogNewLine;
+}
+
+static inline void evtTSFormats_unilogEvtTS_ISO8601 (char *chISO, UBF_TIMESTAMP ts)
+{
+	ISO8601_from_UBF_TIMESTAMPc (chISO, ts);
+	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
+}
+
+static inline void evtTSFormats_unilogEvtTS_ISO8601T (char *chISO, UBF_TIMESTAMP ts)
+{
+	ISO8601T_from_UBF_TIMESTAMPc (chISO, ts);
+	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
+}
+
+static inline void evtTSFormats_unilogEvtTS_ISO8601_3spc (char *chISO, UBF_TIMESTAMP ts)
+{
+	ISO8601_from_UBF_TIMESTAMPc (chISO, ts);
+	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
+	chISO [LEN_ISO8601DATETIMESTAMPMS + 1]	= ' ';
+	chISO [LEN_ISO8601DATETIMESTAMPMS + 2]	= ' ';
+}
+
+static inline void evtTSFormats_unilogEvtTS_ISO8601T_3spc (char *chISO, UBF_TIMESTAMP ts)
+{
+	ISO8601T_from_UBF_TIMESTAMPc (chISO, ts);
+	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
+	chISO [LEN_ISO8601DATETIMESTAMPMS + 1]	= ' ';
+	chISO [LEN_ISO8601DATETIMESTAMPMS + 2]	= ' ';
+}
+
+static inline void evtTSFormats_unilogEvtTS_NCSADT (char *chNCSADT, UBF_TIMESTAMP ts)
+{
+	NCSADATETIME_from_UBF_TIMESTAMP (chNCSADT, ts);
+}
+
+/*
+	Structure for the event timestamp table.
+	First member is the length that'll be written; second member is a pointer to the
+	function that is going to write this out. The remaining members are the offsets of
+	the time of day digits within the written timestamp, which patchEvtTSprefix () uses
+	to update a cached timestamp. An offset of 0 means the format has no such field.
+*/
+typedef struct seventTSformats
+{
+	size_t			len;									// Required length.
+	void			(*fnc) (char *, UBF_TIMESTAMP);			// Function pointer.
+	size_t			ofsHour;								// Offset of "HH".
+	size_t			ofsMinute;								// Offset of "MI".
+	size_t			ofsSecond;								// Offset of "SS".
+	size_t			ofsMillisecond;							// Offset of "000", or 0.
+} SeventTSformats;
+
+SeventTSformats evtTSFormats [cunilogEvtTS_AmountEnumValues] =
+{
+		{	// unilogEvtTS_ISO8601
+			LEN_ISO8601DATETIMESTAMPMS + 1,
+			evtTSFormats_unilogEvtTS_ISO8601,				// "YYYY-MM-DD HH:MI:SS.000+01:00 ".
+			11, 14, 17, 20
+		}
+	,	{	// unilogEvtTS_ISO8601T
+			LEN_ISO8601DATETIMESTAMPMS + 1,
+			evtTSFormats_unilogEvtTS_ISO8601T,				// "YYYY-MM-DDTHH:MI:SS.000+01:00 ".
+			11, 14, 17, 20
+		}
+	,	{	// unilogEvtTS_ISO8601_3spc
+			LEN_ISO8601DATETIMESTAMPMS + 3,
+			evtTSFormats_unilogEvtTS_ISO8601_3spc,			// "YYYY-MM-DD HH:MI:SS.000+01:00   ".
+			11, 14, 17, 20
+		}
+	,	{	// unilogEvtTS_ISO8601T_3spc
+			LEN_ISO8601DATETIMESTAMPMS + 3,
+			evtTSFormats_unilogEvtTS_ISO8601T_3spc,			// "YYYY-MM-DDTHH:MI:SS.000+01:00   ".
+			11, 14, 17, 20
+		}
+	,	{	// cunilogEvtTS_NCSADT
+			LEN_NCSA_COMMON_LOG_DATETIME + 1,				// "[10/Oct/2000:13:55:36 -0700] ".
+			evtTSFormats_unilogEvtTS_NCSADT,
+			13, 16, 19, 0
+		}
+};
+
+/*
+	Bits of a UBF_TIMESTAMP, as far as patchEvtTSprefix () is concerned. Microseconds are
+	not part of any event timestamp format. Any change outside the time of day (date and
+	offset) requires the timestamp to be rendered from scratch.
+*/
+#define CUNILOG_TS_MICROSECOND_MASK		(((UBF_TIMESTAMP) 0x3FF)	<< 8)
+#define CUNILOG_TS_MILLISECOND_MASK		(((UBF_TIMESTAMP) 0x3FF)	<< 18)
+#define CUNILOG_TS_SECOND_MASK			(((UBF_TIMESTAMP) 0x3F)		<< 28)
+#define CUNILOG_TS_MINUTE_MASK			(((UBF_TIMESTAMP) 0x3F)		<< 34)
+#define CUNILOG_TS_HOUR_MASK			(((UBF_TIMESTAMP) 0x1F)		<< 40)
+#define CUNILOG_TS_TIMEOFDAY_MASK						\
+(														\
+		CUNILOG_TS_MICROSECOND_MASK						\
+	|	CUNILOG_TS_MILLISECOND_MASK						\
+	|	CUNILOG_TS_SECOND_MASK							\
+	|	CUNILOG_TS_MINUTE_MASK							\
+	|	CUNILOG_TS_HOUR_MASK							\
+)
+
+/*
+	patchEvtTSprefix
+
+	Updates the time of day digits of the cached timestamp ptp points to with the ones
+	of ts. Returns false if the cache needs to be rendered from scratch instead, which
+	is the case when the date or the offset differ, or when a field is out of range.
+*/
+static bool patchEvtTSprefix (CUNILOG_TSPREFIX *ptp, SeventTSformats *pf, UBF_TIMESTAMP ts)
+{
+	ubf_assert_non_NULL (ptp);
+	ubf_assert_non_NULL (pf);
+
+	UBF_TIMESTAMP	d = ptp->stamp ^ ts;
+
+	if (d & ~CUNILOG_TS_TIMEOFDAY_MASK)
+		return false;
+	if (d & CUNILOG_TS_MILLISECOND_MASK && pf->ofsMillisecond)
+	{
+		unsigned int ms = (unsigned int) UBF_TIMESTAMP_MILLISECOND (ts);
+		if (ms > 999)
+			return false;
+		ptp->szPrefix [pf->ofsMillisecond]		= (char) ('0' + ms / 100);
+		ptp->szPrefix [pf->ofsMillisecond + 1]	= (char) ('0' + ms / 10 % 10);
+		ptp->szPrefix [pf->ofsMillisecond + 2]	= (char) ('0' + ms % 10);
+	}
+	if (d & CUNILOG_TS_SECOND_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsSecond, (uint8_t) UBF_TIMESTAMP_SECOND (ts));
+	if (d & CUNILOG_TS_MINUTE_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsMinute, (uint8_t) UBF_TIMESTAMP_MINUTE (ts));
+	if (d & CUNILOG_TS_HOUR_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsHour, (uint8_t) UBF_TIMESTAMP_HOUR (ts));
+	ptp->stamp = ts;
+	return true;
+}
+
+/*
+	writeEvtTimestamp
+
+	Writes the event timestamp of pev in the target's format to szOut and returns the
+	amount of octets written. The target keeps the most recently rendered timestamp. Since
+	consecutive events mostly differ in their milliseconds or seconds only, the digits that
+	changed are patched and the cached timestamp is copied out.
+
+	The function must only be called while creating an event line, which is serialised
+	per target, hence the cache doesn't require a lock.
+*/
+static size_t writeEvtTimestamp (char *szOut, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (szOut);
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	CUNILOG_TSPREFIX	*ptp	= &put->tsp;
+	SeventTSformats		*pf		= &evtTSFormats [put->unilogEvtTSformat];
+
+	ubf_assert (pf->len < sizeof (ptp->szPrefix));
+
+	if	(
+				put->unilogEvtTSformat != ptp->tsf
+			||	!patchEvtTSprefix (ptp, pf, pev->stamp)
+		)
+	{
+		pf->fnc (ptp->szPrefix, pev->stamp);
+		ptp->stamp	= pev->stamp;
+		ptp->tsf	= put->unilogEvtTSformat;
+	}
+	memcpy (szOut, ptp->szPrefix, pf->len);
+	return pf->len;
+}
+
+static inline size_t requiredEvtLineTimestampAndSeverityLength (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	size_t	r;
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " ".
+	r = evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].len;
+	// "WRN" + " "
+	r += requiredEventSeverityChars (pev->evSeverity, pev->pCUNILOG_TARGET->evSeverityType);
+
+	return r;
+}
+
+static inline size_t requiredEventLineSizeU8 (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
+
+	size_t	r;
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
+	r = requiredEvtLineTimestampAndSeverityLength (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// Actual data.
+	r += pev->lenDataToLog;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// "."
+	r += requiredFullstopChars (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// CR + LF max.
+	r += eventLenNewline (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// Terminating NUL.
+	r += 1;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	return r;
+}
+
+/*
+	writeEventLineFromSUNILOGEVENTU8
+
+	The caller is responsible for szEventLine to point to a buffer big enough to hold the
+	event line. The function requiredEventLineSize () obtains this size.
+*/
+static size_t writeEventLineFromSUNILOGEVENTU8 (char *szEventLine, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (szEventLine);
+	ubf_assert_non_NULL (pev);
+	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (cunilogIsTargetInitialised (pev->pCUNILOG_TARGET));
+
+	char	*szOrg = szEventLine;
+
+	DBG_RESET_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " (see table above).
+	szEventLine += writeEvtTimestamp (szEventLine, pev);
+	szEventLine += writeEventSeverity (szEventLine, pev->evSeverity, pev->pCUNILOG_TARGET->evSeverityType);
+	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+
+	memcpy (szEventLine, pev->szDataToLog, pev->lenDataToLog);
+	szEventLine += pev->lenDataToLog;
+	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+
+	szEventLine += writeFullStop (szEventLine, pev);
+	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+
+	// We've reserved space for a new line character sequence in requiredEventLineSizeU8 ()
+	//	but we're not going to add this here yet. Instead, we NUL-terminate. This simply lets
+	//	us call puts (). We'll add the new line sequence later in the processor that writes
+	//	to the logfile.
+
+	// The NUL byte is useful for OS API functions.
+	szEventLine [0] = ASCII_NUL;
+	return szEventLine - szOrg;
+}
+
+/*
+static bool obtainValidSCUNILOGDUMPinCUNILOG_TARGET (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (NULL == put->psdump)
+	{
+		put->psdump = ubf_malloc (sizeof (SCUNILOGDUMP));
+		SCUNILOGDUMP *pd = put->psdump;
+		if (pd)
+		{
+			pd->dump_prs = ubf_malloc (sizeof (SHEX_DUMP_PARS));
+			pd->dump_sns = ubf_malloc (sizeof (SHEX_DUMP_SAN));
+			if (pd->dump_prs && pd->dump_sns)
+			{
+				ubf_data_dump_def_SUBF_DUMP_PARS (pd->dump_prs);
+				SHEX_DUMP_SAN *ps = pd->dump_sns;
+				ps->bInitialised = false;
+				return true;
+			} else
+			{
+				if (NULL != pd->dump_prs)
+					ubf_free (pd->dump_prs);
+				if (NULL != pd->dump_sns)
+					ubf_free (pd->dump_sns);
+				pd->dump_prs = NULL;
+				pd->dump_sns = NULL;
+			}
+		}
+		return false;
+	} else
+		return true;
+}
+*/
+
+static inline size_t widthOfCaptionLengthFromCunilogEventType (cueventtype type)
+{
+	switch (type)
+	{
+		case cunilogEvtTypeNormalText:				return 0;
+		case cunilogEvtTypeCommand:					return 0;
+		case cunilogEvtTypeHexDumpWithCaption8:		return 1;
+		case cunilogEvtTypeHexDumpWithCaption16:	return 2;
+		case cunilogEvtTypeHexDumpWithCaption32:	return 4;
+		case cunilogEvtTypeHexDumpWithCaption64:	return 8;
+		case cunilogEvtTypeDeferredFmt:				return 0;
+		default:									return 0;
+	}
+}
+
+static size_t readCaptionLengthFromData (unsigned char *pData, size_t ui)
+{
+	uint8_t			ui8;
+	uint16_t		ui16;
+	uint32_t		ui32;
+	uint64_t		ui64;
+	size_t			lnRet;
+
+	switch (ui)
+	{
+		case 0:	lnRet = 0;									break;
+		case 1:	memcpy (&ui8, pData, ui);	lnRet = ui8;	break;
+		case 2:	memcpy (&ui16, pData, ui);	lnRet = ui16;	break;
+		case 4:	memcpy (&ui32, pData, ui);	lnRet = ui32;	break;
+		case 8:	
+				ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
+				memcpy (&ui64, pData, ui);
+				lnRet = (size_t) ui64;						break;
+		default:
+				ubf_assert_msg (false, "Bug");
+				lnRet = 0;									break;
+	}
+	return lnRet;
+}
+
+static char		scSummaryOctets []	= " octets/bytes.";
+static size_t	lnSummaryOctets		= sizeof (scSummaryOctets) - 1;
+
+static inline size_t requiredEventLineSizeHexDump	(
+						unsigned char		**pDumpData,
+						size_t				*width,
+						size_t				*len,
+						CUNILOG_EVENT		*pev
+													)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert	(
+						cunilogEvtTypeHexDumpWithCaption8	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption16	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption32	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption64	== pev->evType
+				);
+	ubf_assert_non_NULL (pDumpData);
+	ubf_assert_non_NULL (width);
+	ubf_assert_non_NULL (len);
+
+	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+
+	size_t	r;
+
+	/*
+		Timestamp + Type + caption, etc.
+	*/
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
+	r = requiredEvtLineTimestampAndSeverityLength (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// The width of the caption length.
+	size_t ui			= widthOfCaptionLengthFromCunilogEventType (pev->evType);
+	// Its actual length. This needs to be added to our return value.
+	size_t lenCaption	= readCaptionLengthFromData (pev->szDataToLog, ui);
+	*pDumpData			= pev->szDataToLog + ui + lenCaption;
+	*width				= ui;
+	*len				= lenCaption;
+	r += lenCaption;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// "."
+	r += requiredFullstopChars (pev);
+	// New line.
+	r += eventLenNewline (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// Actual dump data size. Includes NUL terminator.
+	size_t sizHexDmp = hxdmpRequiredSize (pev->lenDataToLog, put->dumpWidth, eventLineEnding (pev));
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, sizHexDmp);
+	r += sizHexDmp;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// ASCII TAB.
+	++ r;
+
+	// To be considered in the future:
+	//	It would be faster to just always reserve UBF_UINT64_LEN octets instead of
+	//	performing the uint -> ASCII transformation.
+	char cDmpOctets [UBF_UINT64_SIZE];
+	//r += ubf_str_from_uint64 (cDmpOctets, pev->lenDataToLog);
+	ubf_str__from_uint64 (cDmpOctets, 10, pev->lenDataToLog);
+	r += 10;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	r += lnSummaryOctets;
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	// New line.
+	r += eventLenNewline (pev);
+	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+
+	#ifdef DEBUG
+		++ r;												// Space for a debug marker.
+	#endif
+
+	return r;
+}
+
+static size_t createDumpEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
+	ubf_assert	(
+						cunilogEvtTypeHexDumpWithCaption8	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption16	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption32	== pev->evType
+					||	cunilogEvtTypeHexDumpWithCaption64	== pev->evType
+				);
+
+	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+
+	unsigned char	*pDumpData;
+	size_t			captionWidth;
+	size_t			captionLen;
+	size_t lenTotal = requiredEventLineSizeHexDump (&pDumpData, &captionWidth, &captionLen, pev);
+	// pDumpData				Points to the data to dump.
+	// pev->lenDataToLog		Its length.
+
+	growToSizeSMEMBUF64aligned (&put->mbLogEventLine, lenTotal);
+	if (isUsableSMEMBUF (&put->mbLogEventLine))
+	{
+		#ifdef DEBUG
+			put->mbLogEventLine.buf.pch [lenTotal] = CUNILOG_DEFAULT_DBG_CHAR;
+		#endif
+		char *szOut = put->mbLogEventLine.buf.pch;
+		char *szOrg = szOut;
+
+		// Timestamp + severity.
+		szOut += writeEvtTimestamp (szOut, pev);
+		szOut += writeEventSeverity (szOut, pev->evSeverity, put->evSeverityType);
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
+
+		// Caption.
+		memcpy (szOut, pev->szDataToLog + captionWidth, captionLen);
+		szOut += captionLen;
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
+
+		// "." + new line.
+		size_t lenNewLine = eventLenNewline (pev);
+		szOut += writeFullStop (szOut, pev);
+		memcpy (szOut, ccLineEnding (eventLineEnding (pev)), lenNewLine);
+		szOut += lenNewLine;
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
+
+		put->lnLogEventLine = szOut - szOrg;
+		char *szHexDmpOut = szOut;
+		size_t sizHx = hxdmpWriteHexDump	(
+						szHexDmpOut, pDumpData, pev->lenDataToLog,
+						put->dumpWidth, put->unilogNewLine
+											);
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, sizHx + 1);
+		ubf_assert (CUNILOG_DEFAULT_DBG_CHAR == put->mbLogEventLine.buf.pch [lenTotal]);
+		put->lnLogEventLine += sizHx;
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+
+		szOut = szHexDmpOut + sizHx;
+		szOut [0] = ASCII_TAB;
+		++ szOut;
+		++ put->lnLogEventLine;
+
+		//size_t lnOctets = ubf_str_from_uint64 (szOut, pev->lenDataToLog);
+		size_t lnOctets = 10;
+		ubf_str__from_uint64 (szOut, 10, pev->lenDataToLog);
+		put->lnLogEventLine += lnOctets;
+		ubf_assert (CUNILOG_DEFAULT_DBG_CHAR == put->mbLogEventLine.buf.pch [lenTotal]);
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+
+		szOut += lnOctets;
+		memcpy (szOut, scSummaryOctets, lnSummaryOctets + 1);
+		put->lnLogEventLine += lnSummaryOctets;
+		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+
+		return put->lnLogEventLine;
+	}
+	return CUNILOG_SIZE_ERROR;
+}
+
+static size_t createU8EventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
+	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
+
+	size_t requiredEvtLineSize;
+
+	requiredEvtLineSize = requiredEventLineSizeU8 (pev);
+	growToSizeSMEMBUF64aligned (&pev->pCUNILOG_TARGET->mbLogEventLine, requiredEvtLineSize);
+	if (isUsableSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine))
+	{
+		pev->pCUNILOG_TARGET->lnLogEventLine =
+			writeEventLineFromSUNILOGEVENTU8 (pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch, pev);
+		return pev->pCUNILOG_TARGET->lnLogEventLine;
+	}
+	return CUNILOG_SIZE_ERROR;
+}
+
+/*
+	Deferred formatting.
+
+	An event of type cunilogEvtTypeDeferredFmt carries a copy of the format string,
+	including its NUL terminator, followed by one record per argument. The format string
+	is copied because the caller might not pass a string literal, and its buffer might be
+	gone or overwritten by the time the event is processed. A record consists of a tag octet and 8 octets of
+	payload, which are stored unaligned. The payload of a string record is its length. The
+	string itself follows without NUL terminator. Width and precision arguments ('*') are
+	stored as integer records before the value they belong to.
+
+	The text is rendered by createDeferredFmtEventLineFromSUNILOGEVENT () when the event
+	line is created.
+*/
+#define CUNILOG_DFMT_TAG_INT			'i'
+#define CUNILOG_DFMT_TAG_UINT			'u'
+#define CUNILOG_DFMT_TAG_DOUBLE			'd'
+#define CUNILOG_DFMT_TAG_STRING			's'
+#define CUNILOG_DFMT_TAG_POINTER		'p'
+#define CUNILOG_DFMT_RECORD_SIZE		(1 + sizeof (uint64_t))
+
+// Maximum length of a rebuilt conversion specification, including its NUL terminator.
+#define CUNILOG_DFMT_SPEC_SIZE			(48)
+
+enum cunilogdfmtlength
+{
+		cunilogDfmtLen_none
+	,	cunilogDfmtLen_hh
+	,	cunilogDfmtLen_h
+	,	cunilogDfmtLen_l
+	,	cunilogDfmtLen_ll
+	,	cunilogDfmtLen_j
+	,	cunilogDfmtLen_z
+	,	cunilogDfmtLen_t
+};
+
+typedef struct cunilog_dfmtspec
+{
+	size_t						lenSpec;					// Length, including the '%'.
+	size_t						lenFlags;					// Amount of flag characters.
+	bool						bWidth;
+	bool						bWidthStar;
+	int							iWidth;
+	int							iPrec;						// -1 if no precision.
+	bool						bPrecStar;
+	enum cunilogdfmtlength		len;						// Length modifier.
+	char						cConv;						// Conversion specifier.
+} CUNILOG_DFMTSPEC;
+
+static inline bool isDeferredFmtDigit (char c)
+{
+	return '0' <= c && '9' >= c;
+}
+
+/*
+	Parses a decimal number of at most 6 digits for width and precision. Longer
+	numbers are rejected.
+*/
+static inline bool parseDeferredFmtNumber (int *pi, const char **pcc)
+{
+	const char	*cc = *pcc;
+	int			i	= 0;
+	int			n	= 0;
+
+	while (isDeferredFmtDigit (*cc))
+	{
+		if (6 == n ++)
+			return false;
+		i = i * 10 + (*cc ++ - '0');
+	}
+	*pi		= i;
+	*pcc	= cc;
+	return true;
+}
+
+/*
+	Parses the conversion specification at ccFmt, which must point to a '%'. The function
+	returns false if the conversion specification is not supported for deferred formatting.
+	Supported are the conversion specifiers d, i, u, o, x, X, c, s, p, f, F, e, E, g, G,
+	a, and A with the flags "-+ #0", width and precision (both also as '*'), and the length
+	modifiers hh, h, l, ll, j, z, and t for integers. Not supported are %n, long double
+	(L), wide characters and strings (%lc, %ls), and positional arguments.
+*/
+static bool parseDeferredFmtSpec (CUNILOG_DFMTSPEC *ps, const char *ccFmt)
+{
+	ubf_assert_non_NULL (ps);
+	ubf_assert_non_NULL (ccFmt);
+	ubf_assert ('%' == ccFmt [0]);
+
+	const char	*cc		= ccFmt + 1;
+
+	ps->bWidth			= false;
+	ps->bWidthStar		= false;
+	ps->iWidth			= 0;
+	ps->iPrec			= -1;
+	ps->bPrecStar		= false;
+	ps->len				= cunilogDfmtLen_none;
+
+	if ('%' == *cc)
+	{
+		ps->lenFlags	= 0;
+		ps->cConv		= '%';
+		ps->lenSpec		= 2;
+		return true;
+	}
+	while ('-' == *cc || '+' == *cc || ' ' == *cc || '#' == *cc || '0' == *cc)
+		++ cc;
+	ps->lenFlags = cc - ccFmt - 1;
+	if ('*' == *cc)
+	{
+		ps->bWidth		= true;
+		ps->bWidthStar	= true;
+		++ cc;
+	} else
+	if (isDeferredFmtDigit (*cc))
+	{
+		ps->bWidth		= true;
+		if (!parseDeferredFmtNumber (&ps->iWidth, &cc))
+			return false;
+	}
+	if ('.' == *cc)
+	{
+		++ cc;
+		if ('*' == *cc)
+		{
+			ps->bPrecStar	= true;
+			++ cc;
+		} else
+		if (!parseDeferredFmtNumber (&ps->iPrec, &cc))
+			return false;
+	}
+	switch (*cc)
+	{
+		case 'h':
+			++ cc;
+			if ('h' == *cc)
+			{
+				ps->len = cunilogDfmtLen_hh;
+				++ cc;
+			} else
+				ps->len = cunilogDfmtLen_h;
+			break;
+		case 'l':
+			++ cc;
+			if ('l' == *cc)
+			{
+				ps->len = cunilogDfmtLen_ll;
+				++ cc;
+			} else
+				ps->len = cunilogDfmtLen_l;
+			break;
+		case 'j':	ps->len = cunilogDfmtLen_j;	++ cc;		break;
+		case 'z':	ps->len = cunilogDfmtLen_z;	++ cc;		break;
+		case 't':	ps->len = cunilogDfmtLen_t;	++ cc;		break;
+		default:											break;
+	}
+	ps->cConv = *cc;
+	switch (ps->cConv)
+	{
+		case 'd':	case 'i':	case 'u':	case 'o':	case 'x':	case 'X':
+			break;
+		case 'c':	case 's':	case 'p':
+			if (cunilogDfmtLen_none != ps->len)
+				return false;
+			break;
+		case 'f':	case 'F':	case 'e':	case 'E':
+		case 'g':	case 'G':	case 'a':	case 'A':
+			// "%lf" is identical to "%f".
+			if (cunilogDfmtLen_none != ps->len && cunilogDfmtLen_l != ps->len)
+				return false;
+			break;
+		default:
+			// This includes %n and the NUL terminator.
+			return false;
+	}
+	ps->lenSpec = cc + 1 - ccFmt;
+	return true;
+}
+
+static inline size_t storeDeferredFmtRecord (unsigned char *pRec, char tag, uint64_t ui)
+{
+	if (pRec)
+	{
+		pRec [0] = (unsigned char) tag;
+		memcpy (pRec + 1, &ui, sizeof (uint64_t));
+	}
+	return CUNILOG_DFMT_RECORD_SIZE;
+}
+
+static inline size_t storeDeferredFmtInt (unsigned char *pRec, int64_t i)
+{
+	uint64_t	ui;
+
+	memcpy (&ui, &i, sizeof (uint64_t));
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_INT, ui);
+}
+
+static inline size_t storeDeferredFmtDouble (unsigned char *pRec, double d)
+{
+	uint64_t	ui;
+
+	ubf_assert (sizeof (double) == sizeof (uint64_t));
+	memcpy (&ui, &d, sizeof (uint64_t));
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_DOUBLE, ui);
+}
+
+/*
+	Strings are copied. If a precision is given, not more than iPrec octets are read,
+	which means the string does not need to be NUL-terminated in this case.
+*/
+static inline size_t storeDeferredFmtString (unsigned char *pRec, const char *sz, int iPrec)
+{
+	size_t		ln	= 0;
+
+	if (NULL == sz)
+		sz = "(null)";
+	if (iPrec < 0)
+		ln = strlen (sz);
+	else
+		while (ln < (size_t) iPrec && sz [ln])
+			++ ln;
+	if (pRec)
+		memcpy (pRec + CUNILOG_DFMT_RECORD_SIZE, sz, ln);
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_STRING, ln) + ln;
+}
+
+/*
+	Walks the format string fmt and stores a copy of fmt and the arguments of ap in the
+	binary argument record at pRec. If pRec is NULL, the function only returns the required
+	size of the record. The function returns CUNILOG_SIZE_ERROR if fmt contains a
+	conversion specification that is not supported for deferred formatting.
+*/
+static size_t storeDeferredFmtArgs (unsigned char *pRec, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (fmt);
+
+	CUNILOG_DFMTSPEC	spec;
+	const char			*cc		= fmt;
+	size_t				r		= strlen (fmt) + 1;
+	int64_t				i64;
+	uint64_t			u64;
+	int					i;
+
+	if (pRec)
+		memcpy (pRec, fmt, r);
+	while (NULL != (cc = strchr (cc, '%')))
+	{
+		if (!parseDeferredFmtSpec (&spec, cc))
+			return CUNILOG_SIZE_ERROR;
+		cc += spec.lenSpec;
+		if ('%' == spec.cConv)
+			continue;
+		if (spec.bWidthStar)
+			r += storeDeferredFmtInt (pRec ? pRec + r : NULL, va_arg (ap, int));
+		if (spec.bPrecStar)
+		{
+			i = va_arg (ap, int);
+			r += storeDeferredFmtInt (pRec ? pRec + r : NULL, i);
+			spec.iPrec = i < 0 ? -1 : i;
+		}
+		switch (spec.cConv)
+		{
+			case 'd':
+			case 'i':
+				switch (spec.len)
+				{
+					case cunilogDfmtLen_hh:	i64 = (signed char) va_arg (ap, int);	break;
+					case cunilogDfmtLen_h:	i64 = (short) va_arg (ap, int);			break;
+					case cunilogDfmtLen_l:	i64 = va_arg (ap, long);				break;
+					case cunilogDfmtLen_ll:	i64 = va_arg (ap, long long);			break;
+					case cunilogDfmtLen_j:	i64 = va_arg (ap, intmax_t);			break;
+					case cunilogDfmtLen_z:	i64 = (int64_t) va_arg (ap, size_t);	break;
+					case cunilogDfmtLen_t:	i64 = va_arg (ap, ptrdiff_t);			break;
+					default:				i64 = va_arg (ap, int);					break;
+				}
+				r += storeDeferredFmtInt (pRec ? pRec + r : NULL, i64);
+				break;
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+				switch (spec.len)
+				{
+					case cunilogDfmtLen_hh:	u64 = (unsigned char) va_arg (ap, unsigned int);	break;
+					case cunilogDfmtLen_h:	u64 = (unsigned short) va_arg (ap, unsigned int);	break;
+					case cunilogDfmtLen_l:	u64 = va_arg (ap, unsigned long);					break;
+					case cunilogDfmtLen_ll:	u64 = va_arg (ap, unsigned long long);				break;
+					case cunilogDfmtLen_j:	u64 = va_arg (ap, uintmax_t);						break;
+					case cunilogDfmtLen_z:	u64 = va_arg (ap, size_t);							break;
+					case cunilogDfmtLen_t:	u64 = (uint64_t) va_arg (ap, ptrdiff_t);			break;
+					default:				u64 = va_arg (ap, unsigned int);					break;
+				}
+				r += storeDeferredFmtRecord (pRec ? pRec + r : NULL, CUNILOG_DFMT_TAG_UINT, u64);
+				break;
+			case 'c':
+				r += storeDeferredFmtInt (pRec ? pRec + r : NULL, va_arg (ap, int));
+				break;
+			case 's':
+				r += storeDeferredFmtString	(
+						pRec ? pRec + r : NULL, va_arg (ap, const char *), spec.iPrec
+											);
+				break;
+			case 'p':
+				u64 = (uint64_t) (uintptr_t) va_arg (ap, void *);
+				r += storeDeferredFmtRecord (pRec ? pRec + r : NULL, CUNILOG_DFMT_TAG_POINTER, u64);
+				break;
+			default:
+				r += storeDeferredFmtDouble (pRec ? pRec + r : NULL, va_arg (ap, double));
+				break;
+		}
+	}
+	return r;
+}
+
+typedef struct cunilog_dfmtarg
+{
+	char						tag;
+	uint64_t					ui;
+	const char					*sz;						// Only for strings.
+} CUNILOG_DFMTARG;
+
+static inline void readDeferredFmtRecord (CUNILOG_DFMTARG *pa, const unsigned char **ppRec)
+{
+	const unsigned char *pRec = *ppRec;
+
+	pa->tag = (char) pRec [0];
+	memcpy (&pa->ui, pRec + 1, sizeof (uint64_t));
+	pRec += CUNILOG_DFMT_RECORD_SIZE;
+	if (CUNILOG_DFMT_TAG_STRING == pa->tag)
+	{
+		pa->sz	= (const char *) pRec;
+		pRec	+= pa->ui;
+	}
+	*ppRec = pRec;
+}
+
+static inline int readDeferredFmtInt (const unsigned char **ppRec)
+{
+	CUNILOG_DFMTARG		arg;
+	int64_t				i64;
+
+	readDeferredFmtRecord (&arg, ppRec);
+	ubf_assert (CUNILOG_DFMT_TAG_INT == arg.tag);
+	memcpy (&i64, &arg.ui, sizeof (int64_t));
+	return (int) i64;
+}
+
+/*
+	Rebuilds the conversion specification ps describes in szSpec, with width and
+	precision as numbers. Integers are always rendered with the length modifier "ll",
+	and strings with their stored length as precision since they're not NUL-terminated.
+*/
+static void buildDeferredFmtSpec (char *szSpec, const char *ccFmtSpec, CUNILOG_DFMTSPEC *ps)
+{
+	char	*sz		= szSpec;
+	char	*szEnd	= szSpec + CUNILOG_DFMT_SPEC_SIZE;
+
+	*sz ++ = '%';
+	memcpy (sz, ccFmtSpec + 1, ps->lenFlags);
+	sz += ps->lenFlags;
+	if (ps->bWidth)
+		sz += snprintf (sz, szEnd - sz, "%d", ps->iWidth);
+	if (ps->iPrec >= 0)
+		sz += snprintf (sz, szEnd - sz, ".%d", ps->iPrec);
+	switch (ps->cConv)
+	{
+		case 'd':	case 'i':	case 'u':	case 'o':	case 'x':	case 'X':
+			*sz ++ = 'l';
+			*sz ++ = 'l';
+			break;
+		default:
+			break;
+	}
+	*sz ++ = ps->cConv;
+	*sz = ASCII_NUL;
+	ubf_assert (sz < szEnd);
+}
+
+static inline int renderDeferredFmtArg	(
+					char						*sz,
+					size_t						siz,
+					const char					*szSpec,
+					char						cConv,
+					CUNILOG_DFMTARG				*pa
+										)
+{
+	int64_t		i64;
+	double		d;
+
+	switch (pa->tag)
+	{
+		case CUNILOG_DFMT_TAG_INT:
+			memcpy (&i64, &pa->ui, sizeof (int64_t));
+			if ('c' == cConv)
+				return snprintf (sz, siz, szSpec, (int) i64);
+			return snprintf (sz, siz, szSpec, (long long) i64);
+		case CUNILOG_DFMT_TAG_UINT:
+			return snprintf (sz, siz, szSpec, (unsigned long long) pa->ui);
+		case CUNILOG_DFMT_TAG_DOUBLE:
+			memcpy (&d, &pa->ui, sizeof (double));
+			return snprintf (sz, siz, szSpec, d);
+		case CUNILOG_DFMT_TAG_STRING:
+			return snprintf (sz, siz, szSpec, pa->sz);
+		case CUNILOG_DFMT_TAG_POINTER:
+			return snprintf (sz, siz, szSpec, (void *) (uintptr_t) pa->ui);
+	}
+	ubf_assert_msg (false, "Cunilog bug! Unknown deferred formatting tag.");
+	return -1;
+}
+
+static inline bool growDeferredFmtBuf (SMEMBUF *mb, size_t siz)
+{
+	if (mb->size < siz)
+		growToSizeRetainSMEMBUF (mb, ALIGNED_SIZE (siz, 64));
+	return isUsableSMEMBUF (mb);
+}
+
+/*
+	Renders the format string and the argument record of the event pev points to into
+	the buffer of mb, starting at offset offs. The buffer grows as required. The
+	function returns the length of the rendered text, or CUNILOG_SIZE_ERROR.
+*/
+static size_t renderDeferredFmt (SMEMBUF *mb, size_t offs, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (mb);
+	ubf_assert_non_NULL (pev);
+	ubf_assert (cunilogEvtTypeDeferredFmt == pev->evType);
+
+	const unsigned char	*pRec	= pev->szDataToLog;
+	const char			*fmt;
+	const char			*cc;
+	const char			*pc;
+	size_t				pos		= offs;
+	size_t				ln;
+	CUNILOG_DFMTSPEC	spec;
+	CUNILOG_DFMTARG		arg;
+	char				szSpec [CUNILOG_DFMT_SPEC_SIZE];
+	int					i;
+
+	if (!growDeferredFmtBuf (mb, offs + 1))
+		return CUNILOG_SIZE_ERROR;
+	fmt = (const char *) pRec;
+	pRec += strlen (fmt) + 1;
+	cc = fmt;
+	while (*cc)
+	{
+		pc = strchr (cc, '%');
+		ln = pc ? (size_t) (pc - cc) : strlen (cc);
+		if (ln)
+		{
+			if (!growDeferredFmtBuf (mb, pos + ln + 1))
+				return CUNILOG_SIZE_ERROR;
+			memcpy (mb->buf.pch + pos, cc, ln);
+			pos += ln;
+			cc += ln;
+		}
+		if (NULL == pc)
+			break;
+		if (!parseDeferredFmtSpec (&spec, cc))
+		{
+			ubf_assert_msg (false, "Cunilog bug! This has been checked by the producer.");
+			return CUNILOG_SIZE_ERROR;
+		}
+		if ('%' == spec.cConv)
+		{
+			if (!growDeferredFmtBuf (mb, pos + 2))
+				return CUNILOG_SIZE_ERROR;
+			mb->buf.pch [pos ++] = '%';
+			cc += spec.lenSpec;
+			continue;
+		}
+		if (spec.bWidthStar)
+			spec.iWidth = readDeferredFmtInt (&pRec);
+		if (spec.bPrecStar)
+		{
+			spec.iPrec = readDeferredFmtInt (&pRec);
+			spec.iPrec = spec.iPrec < 0 ? -1 : spec.iPrec;
+		}
+		readDeferredFmtRecord (&arg, &pRec);
+		if (CUNILOG_DFMT_TAG_STRING == arg.tag)
+			spec.iPrec = (int) arg.ui;
+		buildDeferredFmtSpec (szSpec, cc, &spec);
+		cc += spec.lenSpec;
+		i = renderDeferredFmtArg (mb->buf.pch + pos, mb->size - pos, szSpec, spec.cConv, &arg);
+		if (i < 0)
+			return CUNILOG_SIZE_ERROR;
+		if ((size_t) i >= mb->size - pos)
+		{
+			if (!growDeferredFmtBuf (mb, pos + i + 1))
+				return CUNILOG_SIZE_ERROR;
+			i = renderDeferredFmtArg (mb->buf.pch + pos, mb->size - pos, szSpec, spec.cConv, &arg);
+			ubf_assert ((size_t) i < mb->size - pos);
+		}
+		pos += i;
+	}
+	ubf_assert (pRec == pev->szDataToLog + pev->lenDataToLog);
+	return pos - offs;
+}
+
+static size_t createDeferredFmtEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
+	ubf_assert (cunilogEvtTypeDeferredFmt == pev->evType);
+
+	CUNILOG_TARGET	*put		= pev->pCUNILOG_TARGET;
+	SMEMBUF			*mb			= &put->mbLogEventLine;
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
+	size_t			lenPrefix	= requiredEvtLineTimestampAndSeverityLength (pev);
+
+	// The text is rendered first, directly behind the space reserved for the prefix.
+	size_t			lenText		= renderDeferredFmt (mb, lenPrefix, pev);
+	if (CUNILOG_SIZE_ERROR == lenText)
+		return CUNILOG_SIZE_ERROR;
+	lenText = strRemoveLineEndingsFromEnd (mb->buf.pch + lenPrefix, lenText);
+
+	// "." + CR + LF max. + NUL.
+	if (!growDeferredFmtBuf (mb, lenPrefix + lenText + 1 + eventLenNewline (pev) + 1))
+		return CUNILOG_SIZE_ERROR;
+
+	char *szOut = mb->buf.pch;
+	szOut += writeEvtTimestamp (szOut, pev);
+	szOut += writeEventSeverity (szOut, pev->evSeverity, put->evSeverityType);
+	ubf_assert (szOut == mb->buf.pch + lenPrefix);
+
+	szOut += lenText;
+	if (cunilogIsEventAutoFullstop (pev) && lenText && '.' != szOut [-1])
+		*szOut ++ = '.';
+	szOut [0] = ASCII_NUL;
+
+	put->lnLogEventLine = szOut - mb->buf.pch;
+	return put->lnLogEventLine;
+}
+
+static size_t createEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
+
+	DBG_RESET_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
+
+	switch (pev->evType)
+	{
+		case cunilogEvtTypeNormalText:
+			return createU8EventLineFromSUNILOGEVENT	(pev);
+	#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
+		case cunilogEvtTypeCommand:
+			ubf_assert_msg (false, "Cunilog bug! This function is not to be called in this case!");
+			break;
+	#endif
+		case cunilogEvtTypeHexDumpWithCaption8:
+		case cunilogEvtTypeHexDumpWithCaption16:
+		case cunilogEvtTypeHexDumpWithCaption32:
+		case cunilogEvtTypeHexDumpWithCaption64:
+			return createDumpEventLineFromSUNILOGEVENT	(pev);
+		case cunilogEvtTypeDeferredFmt:
+			return createDeferredFmtEventLineFromSUNILOGEVENT (pev);
+		default:
+			break;
+	}
+	return CUNILOG_SIZE_ERROR;
+}
+
+/*
+	Not to be called with 0 == ui.
+*/
+static inline void storeCaptionLength (unsigned char **pData, size_t ui, size_t lenCapt)
+{
+	ubf_assert_non_NULL (pData);
+	ubf_assert_non_NULL (*pData);
+	ubf_assert_non_0	(ui);
+
+	uint8_t			ui8;
+	uint16_t		ui16;
+	uint32_t		ui32;
+	uint64_t		ui64;
+
+	switch (ui)
+	{
+		/*
+		// We're not being called for 0 == ui.
+		case 0:
+			ubf_assert_msg (false, "Must be a bug!");
+			return;
+		*/
+		case 1:
+			ui8 = (uint8_t) (lenCapt & 0xFF);
+			memcpy (*pData, &ui8, ui);
+			break;
+		case 2:
+			ui16 = (uint16_t) (lenCapt & 0xFFFF);
+			memcpy (*pData, &ui16, ui);
+			break;
+		case 4:
+			ui32 = (uint32_t) (lenCapt & 0xFFFFFFFF);
+			memcpy (*pData, &ui32, ui);
+			break;
+		case 8:
+			ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
+			ui64 = (uint64_t) lenCapt;
+			memcpy (*pData, &ui64, ui);
+			break;
+		default:
+			ubf_assert_msg (false, "Must be a bug!");
+			break;
+	}
+	*pData += ui;
+}
+
+/*
+	The event pool.
+
+	A slot consists of a CUNILOG_POOLSLOT header, the CUNILOG_EVENT structure, and the
+	payload of its size class for caption and data. Free slots are kept in a lock-free
+	singly-linked list per size class. Any thread can return a slot to the list with a
+	compare-and-swap, but only one thread at a time takes slots from it, which is what
+	the locker of the size class is for. With a single taker a slot can't be taken and
+	returned between reading the head of the list and swapping it, i.e. there's no ABA
+	problem. New slots are carved from the bulk memory of the pool.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static const size_t stEventPoolPayloads [] =
+	{
+		128, 256, 512, 1024, 4096
+	};
+
+	#define CUNILOG_POOLSLOT_HEADER_SIZE				\
+		ALIGNED_SIZE (sizeof (CUNILOG_POOLSLOT), CUNILOG_DEFAULT_ALIGNMENT)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns an event from the pool. The parameter ln is the total size of the event,
+		including the aligned CUNILOG_EVENT structure. The function returns NULL if the
+		event is too big for the pool or no slot could be obtained, in which case the
+		caller allocates it from the heap.
+	*/
+	static CUNILOG_EVENT *GetPooledCUNILOG_EVENT (CUNILOG_EVENTPOOL *pool, size_t ln)
+	{
+		ubf_assert_non_NULL (pool);
+
+		size_t					aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+		CUNILOG_EVENTPOOL_CLASS	*pcl	= NULL;
+		CUNILOG_POOLSLOT		*ps;
+		unsigned int			ui;
+
+		ubf_assert (ln >= aln);
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			if (ln - aln <= pool->classes [ui].stPayload)
+			{
+				pcl = &pool->classes [ui];
+				break;
+			}
+		}
+		if (NULL == pcl)
+		{
+			cunilogAtomicAddSize (&pool->nHeapAllocs, 1);
+			return NULL;
+		}
+
+		EnterLocker (&pcl->cl);
+		ps = cunilogAtomicLoadSlot (&pcl->free);
+		while (ps && !cunilogAtomicCasSlot (&pcl->free, &ps, ps->next))
+			;
+		if (NULL == ps)
+		{
+			EnterLocker (&pool->cl);
+			ps = GetAlignedMemFromSBULKMEMgrow	(
+					&pool->sbm, CUNILOG_POOLSLOT_HEADER_SIZE + aln + pcl->stPayload
+												);
+			LeaveLocker (&pool->cl);
+			if (ps)
+			{
+				ps->pClass = pcl;
+				++ pcl->nSlots;
+			}
+		}
+		if (ps)
+			++ pcl->nAllocs;
+		LeaveLocker (&pcl->cl);
+
+		if (NULL == ps)
+		{
+			cunilogAtomicAddSize (&pool->nHeapAllocs, 1);
+			return NULL;
+		}
+		ps->next = NULL;
+		cunilogAtomicAddSize (&pcl->nInUse, 1);
+		cunilogAtomicAddSize (&pool->nRefs, 1);
+		return (CUNILOG_EVENT *) ((unsigned char *) ps + CUNILOG_POOLSLOT_HEADER_SIZE);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_EVENTPOOL (CUNILOG_EVENTPOOL *pool)
+	{
+		ubf_assert_non_NULL (pool);
+
+		unsigned int ui;
+
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			ubf_assert_0 (pool->classes [ui].nInUse);
+			DoneLocker (&pool->classes [ui].cl);
+		}
+		DoneSBULKMEM (&pool->sbm);
+		DoneLocker (&pool->cl);
+		ubf_free (pool);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Releases a reference to the pool and deallocates the pool if it was the last one.
+	*/
+	static inline void ReleaseCUNILOG_EVENTPOOL (CUNILOG_EVENTPOOL *pool)
+	{
+		ubf_assert_non_NULL (pool);
+
+		if (1 == cunilogAtomicSubSize (&pool->nRefs, 1))
+			DoneCUNILOG_EVENTPOOL (pool);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns the slot of a pooled event to the free list of its size class. This
+		is called from any thread. The target of the pool may have been destroyed
+		already if the event has been handed on to another target.
+	*/
+	static void ReturnPooledCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogIsEventPooled (pev));
+
+		CUNILOG_POOLSLOT		*ps		=
+			(CUNILOG_POOLSLOT *) ((unsigned char *) pev - CUNILOG_POOLSLOT_HEADER_SIZE);
+		CUNILOG_EVENTPOOL_CLASS	*pcl	= ps->pClass;
+		CUNILOG_POOLSLOT		*head;
+
+		ubf_assert_non_NULL (pcl);
+		cunilogAtomicSubSize (&pcl->nInUse, 1);
+		head = cunilogAtomicLoadSlot (&pcl->free);
+		do
+		{
+			ps->next = head;
+		} while (!cunilogAtomicCasSlot (&pcl->free, &head, ps));
+		ReleaseCUNILOG_EVENTPOOL (pcl->pool);
+	}
+#endif
+
+/*
+	Allocates the memory for an event of ln octets, either from the event pool of the
+	target or from the heap. The flag that tells DoneCUNILOG_EVENT () how to deallocate
+	the event is written to puiOpts.
+*/
+static inline CUNILOG_EVENT *AllocCUNILOG_EVENT	(
+					CUNILOG_TARGET				*put,
+					size_t						ln,
+					uint64_t					*puiOpts
+												)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (puiOpts);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (put->pool)
+		{
+			CUNILOG_EVENT *pev = GetPooledCUNILOG_EVENT (put->pool, ln);
+			if (pev)
+			{
+				*puiOpts = CUNILOGEVENT_POOLED;
+				return pev;
+			}
+		}
+	#endif
+	*puiOpts = CUNILOGEVENT_ALLOCATED;
+	return ubf_malloc (ln);
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETeventPool (CUNILOG_TARGET *put, size_t stBulkSize)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->pool);
+
+		if (put->pool)
+			return true;
+
+		CUNILOG_EVENTPOOL *pool = ubf_malloc (sizeof (CUNILOG_EVENTPOOL));
+		if (NULL == pool)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		InitLocker (&pool->cl);
+		InitSBULKMEM (&pool->sbm, stBulkSize ? stBulkSize : CUNILOG_STD_EVENTPOOL_SIZE);
+		unsigned int ui;
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			pool->classes [ui].pool			= pool;
+			pool->classes [ui].free			= NULL;
+			InitLocker (&pool->classes [ui].cl);
+			pool->classes [ui].stPayload	= stEventPoolPayloads [ui];
+			pool->classes [ui].nSlots		= 0;
+			pool->classes [ui].nInUse		= 0;
+			pool->classes [ui].nAllocs		= 0;
+		}
+		pool->nHeapAllocs	= 0;
+		pool->nRefs			= 1;
+		put->pool			= pool;
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool getCUNILOG_EVENTPOOLstats (CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (pStats);
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_EVENTPOOL	*pool	= put->pool;
+		unsigned int		ui;
+
+		if (NULL == pool)
+			return false;
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			CUNILOG_EVENTPOOL_CLASS *pcl = &pool->classes [ui];
+
+			EnterLocker (&pcl->cl);
+			pStats->stPayload [ui]	= pcl->stPayload;
+			pStats->nSlots [ui]		= pcl->nSlots;
+			pStats->nAllocs [ui]	= pcl->nAllocs;
+			LeaveLocker (&pcl->cl);
+			pStats->nInUse [ui]		= cunilogAtomicLoadSize (&pcl->nInUse);
+		}
+		pStats->nHeapAllocs = cunilogAtomicLoadSize (&pool->nHeapAllocs);
+		EnterLocker (&pool->cl);
+		getSBULKMEMstats (&pStats->sbmStats, &pool->sbm);
+		LeaveLocker (&pool->cl);
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when the target is destroyed. Events of the pool that have been handed on
+		to other targets may still be in use, in which case the last one of them returned
+		deallocates the pool.
+	*/
+	static void DoneCUNILOG_TARGETeventPool (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->pool)
+		{
+			ReleaseCUNILOG_EVENTPOOL (put->pool);
+			put->pool = NULL;
+		}
+	}
+#endif
+
+void ConfigCUNILOG_TARGETcachedTimestamps (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogHasCachedTimestamps (put))
+		return;
+	InitUBF_TIMESTAMP_CACHE (&put->tsc);
+	cunilogSetCachedTimestamps (put);
+}
+
+bool ConfigCUNILOG_TARGETwriteBehind	(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (cunilogWriteBehindAmountEnumValues > policy);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+	if (nOctets != pwb->siz)
+	{	// Data already waiting in the buffer goes out first.
+		cunilogWriteBehindToLogFileAndWait (put);
+		#ifdef CUNILOG_HAVE_IO_URING
+			// The io_uring buffer must have the same size.
+			bool bIoUring = 0 <= pwb->ur.fdRing;
+			DoneCUNILOG_IOURING (&pwb->ur);
+		#endif
+		if (pwb->buf)
+		{
+			ubf_free (pwb->buf);
+			pwb->buf = NULL;
+			pwb->siz = 0;
+		}
+		if (0 == nOctets)
+		{	// Without the buffer there's nothing to compress.
+			DoneEXTCMPFRAMER (pwb->pfr);
+			pwb->pfr = NULL;
+		}
+		if (nOctets)
+		{
+			pwb->buf = ubf_malloc (nOctets);
+			if (NULL == pwb->buf)
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+				return false;
+			}
+			pwb->siz = nOctets;
+			#ifndef OS_IS_WINDOWS
+				// From now on we write to the file descriptor directly.
+				if (!cunilogHasRawLogfile (put) && put->logfile.fLogFile)
+					fflush (put->logfile.fLogFile);
+			#endif
+			#ifdef CUNILOG_HAVE_IO_URING
+				if (bIoUring)
+					ConfigCUNILOG_TARGETioUring (put);
+			#endif
+		}
+	}
+	// FILETIME units are 100 ns.
+	pwb->ullLatency		= msLatency ? (uint64_t) msLatency * 10000 : UINT64_MAX;
+	pwb->policy			= policy;
+	pwb->nSyncOctets	= nSyncOctets;
+	return true;
+}
+
+bool ConfigCUNILOG_TARGETioUring (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef CUNILOG_HAVE_IO_URING
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+		CUNILOG_IOURING		*pur	= &pwb->ur;
+
+		if (0 <= pur->fdRing)
+			return true;
+		if (NULL == pwb->buf || cunilogHasMappedLogfile (put))
+			return false;
+		pur->buf = ubf_malloc (pwb->siz);
+		if (NULL == pur->buf)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		pur->siz = pwb->siz;
+		if (SetupCUNILOG_IOURING (pur))
+			return true;
+		// Falls back to writev ().
+		DoneCUNILOG_IOURING (pur);
+		return false;
+	#else
+		UNUSED (put);
+		return false;
+	#endif
+}
+
+void ConfigCUNILOG_TARGETrawLogfile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef OS_IS_WINDOWS
+		if (cunilogHasRawLogfile (put))
+			return;
+		// A logfile opened by the C runtime library is reopened as a raw one on demand.
+		cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		cunilogSetRawLogfile (put);
+	#else
+		UNUSED (put);
+	#endif
+}
+
+void ConfigCUNILOG_TARGETmappedLogfile (CUNILOG_TARGET *put, size_t nChunk)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef OS_IS_WINDOWS
+		size_t	page	= (size_t) sysconf (_SC_PAGESIZE);
+
+		nChunk = nChunk ? nChunk : CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE;
+		nChunk = (nChunk + page - 1) / page * page;
+		// Whatever is open now is reopened as a mapped logfile on demand.
+		cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		put->logfile.lnMapChunk = nChunk;
+		cunilogSetRawLogfile (put);
+		cunilogSetMappedLogfile (put);
+	#else
+		UNUSED (put);
+		UNUSED (nChunk);
+	#endif
+}
+
+bool ConfigCUNILOG_TARGETcompressedLogfile	(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	EXTCMPFRAMER		*pfr;
+
+	pfr = CreateEXTCMPFRAMER (cmp, level);
+	if (NULL == pfr)
+		return false;
+	nFrameOctets = nFrameOctets ? nFrameOctets : CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE;
+	// Data waiting in the buffer goes out with the previous settings.
+	cunilogWriteBehindToLogFileAndWait (put);
+	if	(
+				nFrameOctets != pwb->siz
+			&&	!ConfigCUNILOG_TARGETwriteBehind	(
+					put, nFrameOctets,
+					UINT64_MAX == pwb->ullLatency ? 0 : (unsigned int) (pwb->ullLatency / 10000),
+					pwb->policy, pwb->nSyncOctets
+												)
+		)
+	{
+		DoneEXTCMPFRAMER (pfr);
+		return false;
+	}
+	DoneEXTCMPFRAMER (pwb->pfr);
+	pwb->pfr = pfr;
+	return true;
+}
+
+/*
+	Returns the local time for the timestamp of an event of the target put points to.
+*/
+static inline UBF_TIMESTAMP cunilogLocalTimestamp (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogHasCachedTimestamps (put))
+	{
+		UBF_TIMESTAMP	ts;
+
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			UBF_TIMESTAMP_CACHE	tsc;
+			uint32_t			seq;
+			bool				bValid;
+			int64_t				tSec;
+
+			seq = cunilogTimestampSeqBeginRead (&put->seqTimestamps);
+			cunilogTimestampCacheLoad (&tsc, &put->tsc);
+			bValid = cunilogTimestampSeqEndRead (&put->seqTimestamps, seq);
+
+			// A torn copy or a copy taken during an update is discarded.
+			if (!bValid)
+				InitUBF_TIMESTAMP_CACHE (&tsc);
+			tSec = tsc.tSec;
+			GetLocalTimeCached_UBF_TIMESTAMP (&ts, &tsc);
+
+			// The first thread that sees a new second publishes it. Other threads don't wait.
+			if	(
+						bValid
+					&&	tSec != tsc.tSec
+					&&	cunilogTimestampSeqTryBeginWrite (&put->seqTimestamps, seq)
+				)
+			{
+				cunilogTimestampCacheStore (&put->tsc, &tsc);
+				cunilogTimestampSeqEndWrite (&put->seqTimestamps, seq);
+			}
+		#else
+			GetLocalTimeCached_UBF_TIMESTAMP (&ts, &put->tsc);
+		#endif
+		return ts;
+	}
+	return LocalTime_UBF_TIMESTAMP ();
+}
+
+/*
+	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
+	in which case a buffer of siz octets is reserved but not initialised!
+	This is also used for event type cunilogEvtTypeNormalText by
+	CreateCUNILOG_EVENT_Textvfmt (), which formats its text directly into
+	the reserved buffer, and for event type cunilogEvtTypeDeferredFmt by
+	CreateCUNILOG_EVENT_TextDeferredvfmt (), which stores its argument record
+	there.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccCapt,
+					size_t						lenCapt,
+					cueventtype					type,
+					const char					*ccData,
+					size_t						siz
+													)
+{
+	ubf_assert_non_NULL	(put);
+	if (ccData)
+		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
+	else
+		ubf_assert	(
+							(
+									cunilogEvtTypeCommand		== type
+								||	cunilogEvtTypeNormalText	== type
+								||	cunilogEvtTypeDeferredFmt	== type
+							)
+						&&	NULL == ccData
+					);
+	ubf_assert			(USE_STRLEN != siz);
+	ubf_assert			(0 <= type);
+	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
+
+	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
+	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	size_t			ln		= aln + wl + lenCapt + siz;
+	uint64_t		opts;
+	CUNILOG_EVENT	*pev	= AllocCUNILOG_EVENT (put, ln, &opts);
+
+	if (pev)
+	{
+		unsigned char *pData = (unsigned char *) pev + aln;
+		
+		if	(	
+					cunilogHasEnqueueTimestamps	(put)
+				&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
+			)
+		{
+			FillCUNILOG_EVENT	(
+				pev, put,
+				opts,
+				0,
+				sev, type,
+				pData, siz, ln
+								);
+		} else
+		{
+			FillCUNILOG_EVENT	(
+				pev, put,
+				opts,
+				cunilogLocalTimestamp (put),
+				sev, type,
+				pData, siz, ln
+								);
+		}
+		if (wl)
+		{
+			storeCaptionLength (&pData, wl, lenCapt);
+			memcpy (pData, ccCapt, lenCapt);
+			pData += lenCapt;
+		}
+		if (ccData)
+			memcpy (pData, ccData, siz);
+	}
+	return pev;
+}
+
+/*
+	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
+	in which case a buffer of siz octets is reserved but not initialised!
+
+	This function is identical to CreateCUNILOG_EVENTandData () but requires
+	an additional UBF_TIMESTAMP parameter (ts).
+
+	This is a separate function so that it could easily be removed via
+	macro definitions later if required.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENTandDataTS	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccCapt,
+					size_t						lenCapt,
+					cueventtype					type,
+					const char					*ccData,
+					size_t						siz,
+					UBF_TIMESTAMP				ts
+													)
+{
+	ubf_assert_non_NULL	(put);
+	if (ccData)
+		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
+	else
+		ubf_assert (cunilogEvtTypeCommand == type && NULL == ccData);
+	ubf_assert			(USE_STRLEN != siz);
+	ubf_assert			(0 <= type);
+	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
+
+	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
+	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	size_t			ln		= aln + wl + lenCapt + siz;
+	uint64_t		opts;
+	CUNILOG_EVENT	*pev	= AllocCUNILOG_EVENT (put, ln, &opts);
+
+	if (pev)
+	{
+		unsigned char *pData = (unsigned char *) pev + aln;
+		
+		FillCUNILOG_EVENT	(
+			pev, put,
+			opts,
+			ts,
+			sev, type,
+			pData, siz, ln
+							);
+		if (wl)
+		{
+			storeCaptionLength (&pData, wl, lenCapt);
+			memcpy (pData, ccCapt, lenCapt);
+			pData += lenCapt;
+		}
+		if (ccData)
+			memcpy (pData, ccData, siz);
+		else
+			ubf_assert (cunilogEvtTypeCommand == type);
+	}
+	return pev;
+}
+
+static inline cueventtype cunilogEventTypeFromLength (size_t len)
+{
+	ubf_assert (USE_STRLEN != len);
+
+	if (len < UINT8_MAX)
+		return cunilogEvtTypeHexDumpWithCaption8;
+	if (len < UINT16_MAX)
+		return cunilogEvtTypeHexDumpWithCaption16;
+	if (len < UINT32_MAX)
+		return cunilogEvtTypeHexDumpWithCaption32;
+	ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
+	return cunilogEvtTypeHexDumpWithCaption64;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Data		(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccData,
+					size_t						siz,
+					const char					*ccCapt,
+					size_t						lenCapt
+											)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(ccData);
+	ubf_assert (USE_STRLEN != siz);
+
+	if (ccCapt)
+		lenCapt = USE_STRLEN == lenCapt ? strlen (ccCapt) : lenCapt;
+	else
+		lenCapt = 0;
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, ccCapt, lenCapt,
+							cunilogEventTypeFromLength (lenCapt),
+							ccData, siz
+													);
+	return pev;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_Text		(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccText,
+					size_t						len
+											)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (ccText);
+
+	len = USE_STRLEN == len ? strlen (ccText) : len;
+
+	/*
+	while (len && ('\n' == ccText [len - 1] || '\r' == ccText [len - 1]))
+		-- len;
+	*/
+	len = strRemoveLineEndingsFromEnd (ccText, len);
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, NULL, 0, cunilogEvtTypeNormalText,
+							ccText, len
+													);
+	return pev;
+}
+
+CUNILOG_EVENT *CreateCUNILOG_EVENT_TextTS		(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccText,
+					size_t						len,
+					UBF_TIMESTAMP				ts
+											)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (ccText);
+
+	len = USE_STRLEN == len ? strlen (ccText) : len;
+
+	/*
+	while (len && ('\n' == ccText [len - 1] || '\r' == ccText [len - 1]))
+		-- len;
+	*/
+	len = strRemoveLineEndingsFromEnd (ccText, len);
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandDataTS	(
+							put, sev, NULL, 0, cunilogEvtTypeNormalText,
+							ccText, len, ts
+														);
+	return pev;
+}
+
+/*
+	Creates a text event from the format string fmt and its arguments ap. The text
+	is formatted into a stack buffer first. Only if it doesn't fit, vsnprintf () is
+	called a second time to format it straight into the data area of the event. The
+	caller's ap is not consumed.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENT_Textvfmt	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*fmt,
+					va_list						ap
+													)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (fmt);
+
+	char			cb [CUNILOG_DEFAULT_SFMT_SIZE];
+	va_list			aq;
+	int				i;
+	size_t			l;
+
+	va_copy (aq, ap);
+	i = vsnprintf (cb, CUNILOG_DEFAULT_SFMT_SIZE, fmt, aq);
+	va_end (aq);
+	if (i < 0)
+		return NULL;
+	l = (size_t) i;
+	if (l < CUNILOG_DEFAULT_SFMT_SIZE)
+		return CreateCUNILOG_EVENT_Text (put, sev, cb, l);
+
+	// One more octet for the NUL terminator vsnprintf () writes.
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, NULL, 0, cunilogEvtTypeNormalText,
+							NULL, l + 1
+													);
+	if (pev)
+	{
+		va_copy (aq, ap);
+		vsnprintf ((char *) pev->szDataToLog, l + 1, fmt, aq);
+		va_end (aq);
+		pev->lenDataToLog = strRemoveLineEndingsFromEnd ((char *) pev->szDataToLog, l);
+	}
+	return pev;
+}
+
+/*
+	Creates an event of type cunilogEvtTypeDeferredFmt. Only the arguments are captured
+	here. The text is rendered when the event line is created, which is on the separate
+	logging thread if the target has one. If the target doesn't have a queue, or if fmt
+	contains a conversion specification that is not supported for deferred formatting,
+	the function falls back to CreateCUNILOG_EVENT_Textvfmt (). The caller's ap is not
+	consumed.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENT_TextDeferredvfmt	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*fmt,
+					va_list						ap
+															)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (fmt);
+
+	if (!HAS_CUNILOG_TARGET_A_QUEUE (put))
+		return CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+
+	va_list			aq;
+	size_t			siz;
+
+	va_copy (aq, ap);
+	siz = storeDeferredFmtArgs (NULL, fmt, aq);
+	va_end (aq);
+	if (CUNILOG_SIZE_ERROR == siz)
+		return CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, NULL, 0, cunilogEvtTypeDeferredFmt,
+							NULL, siz
+													);
+	if (pev)
+	{
+		va_copy (aq, ap);
+		storeDeferredFmtArgs (pev->szDataToLog, fmt, aq);
+		va_end (aq);
+	}
+	return pev;
+}
+
+CUNILOG_EVENT *CreateSUNILOGEVENT_W	(
+					cueventseverity		sev,
+					size_t				lenDataW
+									)
+{
+	UNREFERENCED_PARAMETER (sev);
+	UNREFERENCED_PARAMETER (lenDataW);
+
+	//return CreateSUNILOGSTRUCT_U8 (evType, lenDataW * sizeof (wchar_t));
+	ubf_assert (false);
+	return NULL;
+}
+
+CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	size_t size;
+
+	if (pev->sizEvent)
+		size = pev->sizEvent;
+	else
+		size = sizeof (CUNILOG_EVENT);
+	CUNILOG_EVENT *pnev = ubf_malloc (size);
+	if (pnev)
+	{
+		memcpy (pnev, pev, size);
+		// Data that follows the structure is now part of the copy.
+		if	(
+					pev->szDataToLog >= (unsigned char *) pev
+				&&	pev->szDataToLog < (unsigned char *) pev + size
+			)
+			pnev->szDataToLog = (unsigned char *) pnev + (pev->szDataToLog - (unsigned char *) pev);
+		cunilogClrEventPooled (pnev);
+		cunilogClrEventBatched (pnev);
+		cunilogClrEventDeferred (pnev);
+		cunilogSetEventAllocated (pnev);
+	}
+	return pnev;
+}
+
+CUNILOG_EVENT *DoneCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+{
+	if (NULL == put || put == pev->pCUNILOG_TARGET)
+	{
+		if (pev->szDataToLog && cunilogIsEventDataAllocated (pev))
+		{
+			ubf_free (pev->szDataToLog);
+		}
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			if (cunilogIsEventPooled (pev))
+			{
+				ReturnPooledCUNILOG_EVENT (pev);
+				return NULL;
+			}
+		#endif
+		if (cunilogIsEventAllocated (pev))
+		{
+			ubf_free (pev);
+		}
+	}
+	return NULL;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put);
+#endif
+
+#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
+	void cunilogSetTargetErrorAndInvokeErrorCallback	(
+			CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
+														)
+	{
+		ubf_assert_non_NULL (cup);
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		#ifdef PLATFORM_IS_WINDOWS
+			DWORD syserror = GetLastError ();
+		#else
+			int32_t syserror = errno;
+		#endif
+		SetCunilogError (pev->pCUNILOG_TARGET, cunilog_error, syserror);
+
+		if (pev->pCUNILOG_TARGET->errorCB)
+		{
+			errCBretval rv = pev->pCUNILOG_TARGET->errorCB (pev->pCUNILOG_TARGET->error, cup, pev);
+			ubf_assert (0 <= rv);
+			ubf_assert (cunilogErrCB_AmountEnumValues > rv);
+
+			CUNILOG_EVENT *pve;
+			CUNILOG_EVENT *nxt;
+
+			switch (rv)
+			{
+				case cunilogErrCB_ignore:
+					break;
+				case cunilogErrCB_next_processor:
+					break;
+				case cunilogErrCB_next_event:
+					cunilogEventSetIgnoreRemainingProcessors (pev);
+					break;
+				case cunilogErrCB_shutdown:
+					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
+					break;
+				case cunilogErrCB_cancel:
+					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
+					#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+						pve = DequeueAllCUNILOG_EVENTs (pev->pCUNILOG_TARGET);
+						while (pve)
+						{
+							nxt = pve->next;
+							DoneCUNILOG_EVENT (NULL, pve);
+							pve = nxt;
+						}
+					#endif
+					break;
+				default:
+					ubf_assert (false);
+					break;
+			}
+		}
+	}
+
+	/*
+		cunilogTestErrorCB
+	*/
+	#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
+		void cunilogTestErrorCB	(
+				CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
+								)
+		{
+			ubf_assert_non_NULL (cup);
+			ubf_assert_non_NULL (pev);
+			ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+			if (cunilogTargetHasAlwaysCallErrorCB (pev->pCUNILOG_TARGET))
+			{
+				errCBretval rv = pev->pCUNILOG_TARGET->errorCB	(
+										cunilog_error, cup, pev
+																);
+				UNUSED (rv);
+				ubf_assert (0 <= rv);
+				ubf_assert (cunilogErrCB_AmountEnumValues > rv);
+			}
+		}
+	#else
+		#define cunilogTestErrorCB(error, cup, pev)
+	#endif
+#else
+	#define cunilogInvokeErrorCallback(error, cup, pev)
+	#define cunilogTestErrorCB(error, cup, pev)
+#endif
+
+/*
+	The dummy/no-operation processor.
+*/
+static bool cunilogProcessNoneFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	UNREFERENCED_PARAMETER (cup);
+	UNREFERENCED_PARAMETER (pev);
+
+	return true;
+}
+
+#ifdef PLATFORM_IS_WINDOWS
+	static inline int cunilogPutsWin (const char *szOutput, size_t len)
+	{
+		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
+			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
+		CunilogEnableANSIifNotInitialised ();
+
+		if (len)
+		{	// This function expects a NUL-terminated string.
+			ubf_assert (strlen (szOutput) == len);
+			ubf_assert (ASCII_NUL == szOutput [len]);
+
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return puts					(szOutput);
+				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	(szOutput);
+				case cunilogConsoleIsNeither:	return puts					(szOutput);
+				default:						return puts					(szOutput);
+			}
+		} else
+		{
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return puts					("");
+				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	("");
+				case cunilogConsoleIsNeither:	return puts					("");
+				default:						return puts					("");
+			}
+		}
+	}
+#endif
+
+#ifdef PLATFORM_IS_WINDOWS
+	static inline int cunilogPrintWin (const char *szOutput, size_t len)
+	{
+		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
+			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
+		CunilogEnableANSIifNotInitialised ();
+
+		if (len)
+		{	// This function expects a NUL-terminated string.
+			ubf_assert (strlen (szOutput) == len);
+			ubf_assert (ASCII_NUL == szOutput [len]);
+
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return printf				(szOutput);
+				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, szOutput);
+				case cunilogConsoleIsNeither:	return printf				(szOutput);
+				default:						return printf				(szOutput);
+			}
+		} else
+		{
+			switch (ourCunilogConsoleOutputCodePage)
+			{
+				case cunilogConsoleIsUTF8:		return printf				("");
+				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, "");
+				case cunilogConsoleIsNeither:	return printf				("");
+				default:						return printf				("");
+			}
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
+	static inline void cunilogFillColouredEchoEvtLine	(
+							char				**pszToOutput,
+							size_t				*plnToOutput,
+							CUNILOG_EVENT		*pev
+														)
+	{
+		ubf_assert_non_NULL (pszToOutput);
+		ubf_assert_non_NULL (plnToOutput);
+		ubf_assert_non_NULL (pev);
+		// Includes LEN_ANSI_RESET too.
+		size_t	lnThisColour	= evtSeverityColoursLen (pev->evSeverity);
+
+		if	(
+					cunilogTargetHasUseColourForEcho (pev->pCUNILOG_TARGET)
+				&&	lnThisColour
+			)
+		{
+			size_t	lnEvtLine		= pev->pCUNILOG_TARGET->lnLogEventLine;
+			size_t	lnColEcho		= lnThisColour
+									+ lnEvtLine
+									;
+
+			growToSizeSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine, lnColEcho + 1);
+			if (isUsableSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine))
+			{
+				ubf_assert	(
+									strlen (pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch)
+								==	pev->pCUNILOG_TARGET->lnLogEventLine
+							);
+				char *sz = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
+				cpyEvtSeverityColour (&sz, pev->evSeverity);
+				memcpy (sz, pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch, lnEvtLine);
+				sz += lnEvtLine;
+				cpyRstEvtSeverityColour (&sz, pev->evSeverity);
+				*sz = ASCII_NUL;
+				pev->pCUNILOG_TARGET->lnColEventLine = lnColEcho;
+				*pszToOutput = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
+				*plnToOutput = lnColEcho;
+				return;
+			}
+		}
+		*pszToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
+		*plnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Writes out the echo output of the current batch with a single call. Each line in
+		the buffer is followed by a line ending. The last one is replaced by a NUL
+		terminator because puts () adds it again.
+	*/
+	static void cunilogFlushEchoBatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->lnEchoBatch)
+		{
+			char	*sz	= put->mbEchoBatch.buf.pch;
+			size_t	ln	= put->lnEchoBatch - 1;
+			int		ips;
+
+			sz [ln] = ASCII_NUL;
+			put->lnEchoBatch = 0;
+			#ifdef PLATFORM_IS_WINDOWS
+				ips = cunilogPutsWin (sz, ln);
+			#else
+				ips = puts (sz);
+			#endif
+			if (EOF == ips)
+			{
+				ubf_assert_msg (false, "Error writing to stdout.");
+				SetCunilogSystemError (put, EBADF);
+			}
+		}
+	}
+#else
+	#define cunilogFlushEchoBatch(put)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Appends the event line sz to the echo output of the current batch. The buffer is
+		written out before it grows, which means its content isn't lost if the
+		allocation fails. The function returns false in this case.
+	*/
+	static bool cunilogAppendToEchoBatch (CUNILOG_TARGET *put, const char *sz, size_t ln)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (sz);
+
+		size_t lnNew = put->lnEchoBatch + ln + 1;
+		if (lnNew + 1 > put->mbEchoBatch.size)
+		{
+			cunilogFlushEchoBatch (put);
+			lnNew = ln + 1;
+			growToSizeSMEMBUFreserve (&put->mbEchoBatch, lnNew + 1, put->mbEchoBatch.size);
+			if (!isUsableSMEMBUF (&put->mbEchoBatch))
+				return false;
+		}
+		char *pc = put->mbEchoBatch.buf.pch + put->lnEchoBatch;
+		memcpy (pc, sz, ln);
+		pc [ln] = '\n';
+		put->lnEchoBatch = lnNew;
+		return true;
+	}
+#endif
+
+static bool cunilogProcessEchoFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	UNREFERENCED_PARAMETER (cup);
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	if (cunilogIsNoEcho (pev->pCUNILOG_TARGET) || cunilogHasEventNoEcho (pev))
+		return true;
+
+	// The actual task of this processor: Echo the event line.
+	//	Note that we can rely on the following conditions here:
+	//		- The line to output is NUL-terminated.
+	//		- It only consists of printable characters.
+	//		- The length of the event line has been stored correctly.
+	//		- If we require a lock, we have it already.
+
+	int		ips;
+	char	*szToOutput;
+	size_t	lnToOutput;
+
+	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
+		cunilogFillColouredEchoEvtLine (&szToOutput, &lnToOutput, pev);
+	#else
+		szToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
+		lnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
+	#endif
+
+	// An event of a batch is echoed together with the others of the batch. Any other
+	//	event must not overtake them.
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if	(
+					cunilogIsEventBatched (pev)
+				&&	cunilogAppendToEchoBatch (pev->pCUNILOG_TARGET, szToOutput, lnToOutput)
+			)
+			return true;
+		cunilogFlushEchoBatch (pev->pCUNILOG_TARGET);
+	#endif
+
+	#ifdef PLATFORM_IS_WINDOWS
+		ips = cunilogPutsWin (szToOutput, lnToOutput);
+	#else
+		if (lnToOutput)
+			ips = puts (szToOutput);
+		else
+			ips = puts ("");
+	#endif
+	if (EOF == ips)
+	{	// "Bad file descriptor" might not be the best error here but what's better?
+		ubf_assert_msg (false, "Error writing to stdout.");
+		cunilogSetTargetErrorAndInvokeErrorCallback (EBADF, cup, pev);
+	}
+	return true;
+}
+
+static bool cunilogProcessUpdateLogFileNameFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	UNREFERENCED_PARAMETER (cup);
+	ubf_assert_non_NULL (pev);
+	
+	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+
+	#ifdef DEBUG
+		char *sz = put->mbLogfileName.buf.pch;
+		UNREFERENCED_PARAMETER (sz);
+	#endif
+
+	switch (put->culogPostfix)
+	{
+		case cunilogPostfixNone:
+			return true;
+
+		case cunilogPostfixMinute:
+		case cunilogPostfixMinuteT:
+		case cunilogPostfixHour:
+		case cunilogPostfixHourT:
+		case cunilogPostfixDay:
+		case cunilogPostfixWeek:
+		case cunilogPostfixMonth:
+		case cunilogPostfixYear:
+			savePrevTimestamp (pev);
+			return true;
+
+		case cunilogPostfixLogMinute:
+		case cunilogPostfixLogMinuteT:
+		case cunilogPostfixLogHour:
+		case cunilogPostfixLogHourT:
+		case cunilogPostfixLogDay:
+		case cunilogPostfixLogWeek:
+		case cunilogPostfixLogMonth:
+		case cunilogPostfixLogYear:
+			return true;
+
+		case cunilogPostfixDotNumberMinutely:
+		case cunilogPostfixDotNumberHourly:
+		case cunilogPostfixDotNumberDaily:
+		case cunilogPostfixDotNumberWeekly:
+		case cunilogPostfixDotNumberMonthly:
+		case cunilogPostfixDotNumberYearly:
+		case cunilogPostfixDotNumberSize:
+			return true;
+
+		default:
+			ubf_assert_msg (false, "Bug!");
+			return true;
+	}
+}
+
+/*
+	Closes the previous file and opens the new one.
+*/
+static inline bool cunilogOpenNewLogFile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
+
+	cunilogWriteBehindToLogFileAndWait (put);
+	#ifdef OS_IS_WINDOWS
+		CloseHandle (put->logfile.hLogFile);
+		return cunilogOpenLogFile (put);
+	#else
+		cunilogCloseLogFile (put);
+		return cunilogOpenLogFile (put);
+	#endif
+}
+
+static inline bool requiresOpenLogFile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+#ifdef OS_IS_WINDOWS
+		return NULL == put->logfile.hLogFile || INVALID_HANDLE_VALUE == put->logfile.hLogFile;
+	#else
+		if (cunilogHasRawLogfile (put))
+			return 0 > put->logfile.fdLogFile;
+		return NULL == put->logfile.fLogFile;
+	#endif
+}
+
+#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
+#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
+	static inline bool requiresNewLogFileCunilogTest	(
+							CUNILOG_TARGET		*put,
+							CUNILOG_PROCESSOR	*cup,
+							CUNILOG_EVENT		*pev
+														)
+	{
+		ubf_assert_non_NULL (put);
+
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_REQUIRES_NEW_LOGFILE, cup, pev);
+		int r = requiresNewLogFile (put);
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_REQUIRES_NEW_LOGFILE, cup, pev);
+
+		return r > 0;
+	}
+#endif
+#endif
+
+#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
+	#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
+		#define REQUIRES_NEW_LOGFILE(put, cup, pev)		\
+				requiresNewLogFileCunilogTest (put, cup, pev)
+	#else
+		#define REQUIRES_NEW_LOGFILE(put, cup, pev)		\
+				requiresNewLogFile (put)
+	#endif
+#else
+	#define REQUIRES_NEW_LOGFILE(put, cup, pev)			\
+				requiresNewLogFile (put)
+#endif
+
+static inline size_t addNewLineToLogEventLine (char *pData, size_t lnData, enum enLineEndings nl)
+{	// At least one octet has been reserved for a newline character, and one
+	//	for NUL, hence we're definitely safe to write 2 more octets.
+	size_t len;
+	const char *cc = szLineEnding (nl, &len);
+	ubf_assert (len <= 2);
+	memcpy (pData + lnData, cc, len + 1);
+	return lnData + len;
+}
+
+/*
+	Writes the n buffers of the array piov points to to the logfile with writev (),
+	carrying on after partial writes and interruptions. The array is modified.
+*/
+#ifndef OS_IS_WINDOWS
+	static bool cunilogWritevToLogFile (CUNILOG_TARGET *put, struct iovec *piov, int n)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (piov);
+
+		if (cunilogHasMappedLogfile (put))
+			return cunilogMappedWritevToLogFile (put, piov, n);
+
+		int				fd		= cunilogLogFileDescriptor (put);
+		ssize_t			w;
+
+		while (n)
+		{
+			w = writev (fd, piov, n);
+			if (w < 0)
+			{
+				if (EINTR == errno)
+					continue;
+				return false;
+			}
+			// Partial write.
+			while (n && (size_t) w >= piov->iov_len)
+			{
+				w -= (ssize_t) piov->iov_len;
+				++ piov;
+				-- n;
+			}
+			if (n)
+			{
+				piov->iov_base	= (char *) piov->iov_base + w;
+				piov->iov_len	-= (size_t) w;
+			}
+		}
+		return true;
+	}
+#endif
+
+/*
+	Writes lnBuf octets of pBuf, usually the write-behind buffer of the target put points
+	to, followed by lnLine octets of pLine, to the logfile. On POSIX both go out with a
+	single writev () call, bypassing the buffer of the C runtime library.
+*/
+static bool cunilogWriteBehindWriteToLogFile	(
+		CUNILOG_TARGET		*put,
+		const char			*pBuf,
+		size_t				lnBuf,
+		const char			*pLine,
+		size_t				lnLine
+												)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef OS_IS_WINDOWS
+		const char	*pc [2]		= {pBuf, pLine};
+		size_t		ln [2]		= {lnBuf, lnLine};
+		DWORD		dwWritten;
+
+		for (unsigned int ui = 0; ui < 2; ++ ui)
+		{
+			while (ln [ui])
+			{
+				DWORD toWrite = ln [ui] > 0x40000000 ? 0x40000000 : (DWORD) ln [ui];
+				if (!WriteFile (put->logfile.hLogFile, pc [ui], toWrite, &dwWritten, NULL))
+					return false;
+				pc [ui] += dwWritten;
+				ln [ui] -= dwWritten;
+			}
+		}
+		return true;
+	#else
+		struct iovec	iov [2];
+		int				n		= 0;
+
+		if (lnBuf)
+		{
+			iov [n].iov_base	= (void *) pBuf;
+			iov [n].iov_len		= lnBuf;
+			++ n;
+		}
+		if (lnLine)
+		{
+			iov [n].iov_base	= (void *) pLine;
+			iov [n].iov_len		= lnLine;
+			++ n;
+		}
+		return cunilogWritevToLogFile (put, iov, n);
+	#endif
+}
+
+static inline bool cunilogSyncLogFile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef OS_IS_WINDOWS
+		return FlushFileBuffers (put->logfile.hLogFile);
+	#else
+		// Earlier chunks are unmapped already and taken care of by fsync ()/fdatasync ().
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		if (pl->pMap && msync (pl->pMap, pl->ofsMap, MS_SYNC))
+			return false;
+		#ifdef OS_IS_MACOS
+			return 0 == fsync (cunilogLogFileDescriptor (put));
+		#else
+			return 0 == fdatasync (cunilogLogFileDescriptor (put));
+		#endif
+	#endif
+}
+
+#ifdef CUNILOG_HAVE_IO_URING
+	// The user_data of the submission queue entries.
+	#define CUNILOG_IOURING_WRITE		(1)
+	#define CUNILOG_IOURING_DATASYNC	(2)
+
+	static inline void cunilogIoUringQueue	(
+							CUNILOG_IOURING		*pur,
+							uint8_t				opcode,
+							uint8_t				flags,
+							int					fd,
+							const char			*pData,
+							size_t				lnData
+											)
+	{
+		ubf_assert_non_NULL (pur);
+
+		unsigned int		tail	= *pur->sqTail;
+		unsigned int		idx		= tail & *pur->sqMask;
+		struct io_uring_sqe	*sqe	= &pur->sqes [idx];
+
+		memset (sqe, 0, sizeof (*sqe));
+		sqe->opcode		= opcode;
+		sqe->flags		= flags;
+		sqe->fd			= fd;
+		if (IORING_OP_WRITE == opcode)
+		{	// Anything above the kernel's limit becomes a short write.
+			sqe->addr		= (uint64_t) (uintptr_t) pData;
+			sqe->len		= lnData > 0x7FFFF000 ? 0x7FFFF000 : (uint32_t) lnData;
+			sqe->off		= (uint64_t) -1;			// Current file position.
+			sqe->user_data	= CUNILOG_IOURING_WRITE;
+		} else
+		{
+			sqe->fsync_flags	= IORING_FSYNC_DATASYNC;
+			sqe->user_data		= CUNILOG_IOURING_DATASYNC;
+		}
+		pur->sqArray [idx] = idx;
+		__atomic_store_n (pur->sqTail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	/*
+		Waits for the completion of what has been submitted for the target put points to.
+		The rest of a short write is written synchronously, as is a failed write, and a
+		datasync that has been cancelled because of either. The function returns false if
+		the synchronous write or the datasync failed.
+	*/
+	static bool cunilogIoUringWait (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_IOURING		*pur	= &put->wb.ur;
+		bool				b		= true;
+		bool				bSync	= false;
+		unsigned int		head;
+		struct io_uring_cqe	*cqe;
+		struct iovec		iov;
+
+		while (pur->nInFlight)
+		{
+			head = *pur->cqHead;
+			if (head == __atomic_load_n (pur->cqTail, __ATOMIC_ACQUIRE))
+			{
+				if	(
+							0 > syscall	(
+									__NR_io_uring_enter, pur->fdRing, 0, 1,
+									IORING_ENTER_GETEVENTS, NULL, 0
+										)
+						&&	EINTR != errno
+					)
+				{	// We should never get here.
+					ubf_assert (false);
+					pur->nInFlight = 0;
+					b = false;
+				}
+				continue;
+			}
+			cqe = &pur->cqes [head & *pur->cqMask];
+			if (CUNILOG_IOURING_WRITE == cqe->user_data)
+			{
+				if (0 > cqe->res)
+				{	// Nothing has been written.
+					iov.iov_base	= pur->buf;
+					iov.iov_len		= pur->len;
+					b &= cunilogWritevToLogFile (put, &iov, 1);
+				} else
+				if ((size_t) cqe->res < pur->len)
+				{
+					iov.iov_base	= pur->buf + cqe->res;
+					iov.iov_len		= pur->len - (size_t) cqe->res;
+					b &= cunilogWritevToLogFile (put, &iov, 1);
+				}
+			} else
+			{	// A short write breaks the link to the datasync.
+				if (-ECANCELED == cqe->res)
+					bSync = true;
+				else
+				if (0 > cqe->res)
+					b = false;
+			}
+			__atomic_store_n (pur->cqHead, head + 1, __ATOMIC_RELEASE);
+			-- pur->nInFlight;
+		}
+		pur->len			= 0;
+		pur->bSyncInFlight	= false;
+		if (bSync)
+			b &= cunilogSyncLogFile (put);
+		return b;
+	}
+
+	/*
+		Swaps the write-behind buffer of the target put points to with the io_uring buffer
+		and submits a write of it, linked to a datasync if bSync is true. The function
+		waits for the previous submission first. This keeps the writes in order, and the
+		next batch of event lines is rendered into the other buffer while the kernel is
+		writing this one.
+
+		If the submission fails, the data is written synchronously.
+	*/
+	static bool cunilogIoUringSubmit (CUNILOG_TARGET *put, bool bSync)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+		CUNILOG_IOURING		*pur	= &pwb->ur;
+		bool				b		= cunilogIoUringWait (put);
+		int					fd		= cunilogLogFileDescriptor (put);
+		unsigned int		n		= bSync ? 2 : 1;
+		long				r;
+		char				*pc;
+		struct iovec		iov;
+
+		ubf_assert (pur->siz == pwb->siz);
+		pc					= pur->buf;
+		pur->buf			= pwb->buf;
+		pwb->buf			= pc;
+		pur->len			= pwb->len;
+		pur->bSyncInFlight	= bSync;
+		cunilogIoUringQueue (pur, IORING_OP_WRITE, bSync ? IOSQE_IO_LINK : 0, fd, pur->buf, pur->len);
+		if (bSync)
+			cunilogIoUringQueue (pur, IORING_OP_FSYNC, 0, fd, NULL, 0);
+		do
+		{
+			r = syscall (__NR_io_uring_enter, pur->fdRing, n, 0, 0, NULL, 0);
+		} while (0 > r && EINTR == errno);
+		r = 0 > r ? 0 : r;
+		pur->nInFlight = (unsigned int) r;
+		if ((unsigned int) r < n)
+		{	// Take back what hasn't been submitted and do it ourselves.
+			__atomic_store_n (pur->sqTail, *pur->sqTail - (n - (unsigned int) r), __ATOMIC_RELEASE);
+			if (0 == r)
+			{
+				iov.iov_base	= pur->buf;
+				iov.iov_len		= pur->len;
+				b &= cunilogWritevToLogFile (put, &iov, 1);
+			}
+			b &= cunilogIoUringWait (put);
+			if (bSync)
+				b &= cunilogSyncLogFile (put);
+		}
+		return b;
+	}
+#endif
+
+/*
+	Compresses the octets in the write-behind buffer of the target put points to, followed
+	by lnLine octets of pLine, into a single frame and writes it to the logfile. See
+	ConfigCUNILOG_TARGETcompressedLogfile ().
+*/
+static bool cunilogWriteBehindFrameToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (put->wb.pfr);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	size_t				lnFrame;
+	const char			*pFrame;
+
+	pFrame = ExtCompressFrame (pwb->pfr, pwb->buf, pwb->len, pLine, lnLine, &lnFrame);
+	if (NULL == pFrame)
+		return false;
+	put->logfile.ullSize += lnFrame;
+	return cunilogWriteBehindWriteToLogFile (put, pFrame, lnFrame, NULL, 0);
+}
+
+/*
+	cunilogWriteBehindToLogFile
+
+	Writes the data in the write-behind buffer of the target put points to, followed by
+	the lnLine octets pLine points to, to the logfile, and syncs the logfile if the sync
+	threshold of the target has been reached. The buffer is empty afterwards, even if
+	writing fails, in which case the function returns false.
+*/
+static bool cunilogWriteBehindToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine)
+{
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+	if (0 == pwb->len + lnLine)
+		return true;
+	if (requiresOpenLogFile (put))
+	{
+		pwb->len = 0;
+		return false;
+	}
+	bool b = true;
+	#ifdef CUNILOG_HAVE_IO_URING
+		if (0 <= pwb->ur.fdRing && !cunilogHasMappedLogfile (put) && NULL == pwb->pfr)
 		{
-			memcpy (*sz, evtSeverityColours [sev].szColSequence, evtSeverityColours [sev].lnColSequence);
-			*sz += evtSeverityColours [sev].lnColSequence;
+			if (0 == lnLine)
+			{
+				bool bSync = pwb->nSyncOctets && pwb->nUnsynced + pwb->len >= pwb->nSyncOctets;
+				b = cunilogIoUringSubmit (put, bSync);
+				++ pwb->nWrites;
+				pwb->nUnsynced	= bSync ? 0 : pwb->nUnsynced + pwb->len;
+				pwb->len		= 0;
+				return b;
+			}
+			// Nothing must overtake what is still in flight.
+			b = cunilogIoUringWait (put);
 		}
+	#endif
+	if (pwb->pfr)
+		b &= cunilogWriteBehindFrameToLogFile (put, pLine, lnLine);
+	else
+		b &= cunilogWriteBehindWriteToLogFile (put, pwb->buf, pwb->len, pLine, lnLine);
+	++ pwb->nWrites;
+	pwb->nUnsynced	+= pwb->len + lnLine;
+	pwb->len		= 0;
+	if (b && pwb->nSyncOctets && pwb->nUnsynced >= pwb->nSyncOctets)
+	{
+		b = cunilogSyncLogFile (put);
+		pwb->nUnsynced = 0;
 	}
-	static inline void cpyRstEvtSeverityColour (char **sz, cueventseverity sev)
+	return b;
+}
+
+/*
+	Writes the data in the write-behind buffer of the target put points to to the logfile
+	and, unlike cunilogWriteBehindToLogFile (), only returns when it has been written. This
+	is required before the logfile is closed or the buffer is deallocated.
+*/
+static bool cunilogWriteBehindToLogFileAndWait (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	bool b = cunilogWriteBehindToLogFile (put, NULL, 0);
+	#ifdef CUNILOG_HAVE_IO_URING
+		b &= cunilogIoUringWait (put);
+	#endif
+	return b;
+}
+
+/*
+	Appends the event line to the write-behind buffer. The buffer is written out first if
+	the event line doesn't fit. An event line that is bigger than the entire buffer is
+	written out together with it.
+*/
+static bool cunilogWriteDataToWriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (put->wb.buf);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	char				*pData	= put->mbLogEventLine.buf.pch;
+	size_t				lnData	= put->lnLogEventLine;
+	size_t				lnLine	= addNewLineToLogEventLine (pData, lnData, put->unilogNewLine);
+	bool				b		= true;
+
+	// A compressed logfile grows by its frames.
+	if (NULL == pwb->pfr)
+		put->logfile.ullSize += lnLine;
+	if (pwb->len + lnLine > pwb->siz)
 	{
-		if (evtSeverityColours [sev].lnColSequence)
+		if (lnLine > pwb->siz)
 		{
-			memcpy (*sz, STR_ANSI_RESET, LEN_ANSI_RESET);
-			*sz += LEN_ANSI_RESET;
+			b = cunilogWriteBehindToLogFile (put, pData, lnLine);
+			pData [lnData] = ASCII_NUL;
+			return b;
 		}
+		b = cunilogWriteBehindToLogFile (put, NULL, 0);
 	}
-#else
-	#define cpyEvtSeverityColour(s, sev)
-	#define cpyRstEvtSeverityColour(s)
-#endif
+	if (0 == pwb->len && UINT64_MAX != pwb->ullLatency)
+		pwb->ullFirst = GetSystemTimeAsULONGLONGrel ();
+	memcpy (pwb->buf + pwb->len, pData, lnLine);
+	pwb->len += lnLine;
+	pData [lnData] = ASCII_NUL;
+	if	(
+				UINT64_MAX != pwb->ullLatency
+			&&	GetSystemTimeAsULONGLONGrel () - pwb->ullFirst >= pwb->ullLatency
+		)
+		b &= cunilogWriteBehindToLogFile (put, NULL, 0);
+	return b;
+}
 
-static inline size_t requiredEventSeverityChars (cueventseverity sev, cueventsevfmtpy tpy)
+static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
 {
-	// "" or "INF" + " ".
-	if (cunilogEvtSeverityBlanks > sev)
-			return 0;
-	switch (tpy)
-	{														// The + 1 is for a space character.
-		case cunilogEvtSeverityTypeChars3:					return 3 + 1;
-		case cunilogEvtSeverityTypeChars5:					return 5 + 1;
-		case cunilogEvtSeverityTypeChars9:					return 9 + 1;
-		case cunilogEvtSeverityTypeChars3InBrackets:		return 2 + 3 + 1;
-		case cunilogEvtSeverityTypeChars5InBrackets:		return 2 + 5 + 1;
-		case cunilogEvtSeverityTypeChars9InBrackets:		return 2 + 9 + 1;
-		case cunilogEvtSeverityTypeChars5InTightBrackets:	return 2 + 5 + 1;
-		case cunilogEvtSeverityTypeChars9InTightBrackets:	return 2 + 9 + 1;
-	}
-	ubf_assert_msg (false, "Internal error! We should never get here!");
-	return 0;
+	ubf_assert_non_NULL (put);
+
+	if (put->wb.buf)
+		return cunilogWriteDataToWriteBehind (put);
+
+	char				*pData	= put->mbLogEventLine.buf.pch;
+	size_t				lnData	= put->lnLogEventLine;
+	enum enLineEndings	nl		= put->unilogNewLine;
+
+	#ifdef OS_IS_WINDOWS
+		DWORD dwWritten;
+		DWORD toWrite = addNewLineToLogEventLine (pData, lnData, nl) & 0xFFFFFFFF;
+		put->logfile.ullSize += toWrite;
+		// The file has been opened with FILE_APPEND_DATA, i.e. we don't need to
+		//	seek ourselves.
+		//	LARGE_INTEGER	z = {0, 0};
+		//	SetFilePointerEx (pl->hLogFile, z, NULL, FILE_END);
+		bool b = WriteFile (put->logfile.hLogFile, pData, toWrite, &dwWritten, NULL);
+		pData [lnData] = ASCII_NUL;
+		return b;
+	#else
+		if (cunilogHasRawLogfile (put))
+		{	// Event line and line ending straight from where they are.
+			struct iovec	iov [2];
+			size_t			lnNL;
+			iov [0].iov_base	= pData;
+			iov [0].iov_len		= lnData;
+			iov [1].iov_base	= (void *) szLineEnding (nl, &lnNL);
+			iov [1].iov_len		= lnNL;
+			put->logfile.ullSize += lnData + lnNL;
+			return cunilogWritevToLogFile (put, iov, 2);
+		}
+		long lToWrite = (long) addNewLineToLogEventLine (pData, lnData, nl);
+		put->logfile.ullSize += (uint64_t) lToWrite;
+		// See https://www.man7.org/linux/man-pages/man3/fopen.3.html .
+		//	A call "fseek (pl->fLogFile, (long) 0, SEEK_END);" is not required
+		//	because we opened the file in append mode.
+		size_t st = fwrite (pData, 1, lToWrite, put->logfile.fLogFile);
+		pData [lnData] = ASCII_NUL;
+		return st == lnData;
+	#endif
 }
 
-static inline size_t writeEventSeverity (char *szOut, cueventseverity sev, cueventsevfmtpy tpy)
+static void cunilogAddLogfileToFLSindex (CUNILOG_TARGET *put);
+
+static bool cunilogProcessWriteToLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
-	ubf_assert_non_NULL (szOut);
-	ubf_assert (0 <= sev);
-	ubf_assert (cunilogEvtSeverityXAmountEnumValues > sev);
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
-	if (cunilogEvtSeverityBlanks > sev)
-			return 0;
+	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+	ubf_assert (isUsableSMEMBUF (&put->mbLogfileName));
 
-	size_t len;
+	if (cunilogHasDontWriteToLogfile (put))
+		return true;
 
-	switch (tpy)
+	/*
+	CUNILOG_LOGFILE	*pl	= cup->pData;
+	ubf_assert_non_NULL (pl);
+	*/
+
+	if (isUsableSMEMBUF (&put->mbLogfileName))
 	{
-		case cunilogEvtSeverityTypeChars3:					// "EMG"
-			memcpy (szOut, EventSeverityTexts3 [sev], 3);
-			szOut [3] = ' ';
-			return 3 + 1;
-		case cunilogEvtSeverityTypeChars5:					// "EMRGY"
-			memcpy (szOut, EventSeverityTexts5 [sev], 5);
-			szOut [5] = ' ';
-			return 5 + 1;
-		case cunilogEvtSeverityTypeChars9:					// "EMERGENCY"
-			memcpy (szOut, EventSeverityTexts9 [sev], 9);
-			szOut [9] = ' ';
-			return 9 + 1;
-		case cunilogEvtSeverityTypeChars3InBrackets:		// "[EMG]"
-			*szOut ++ = '[';
-			memcpy (szOut, EventSeverityTexts3 [sev], 3);
-			memcpy (szOut + 3, "] ", 2);
-			return 2 + 3 + 1;
-		case cunilogEvtSeverityTypeChars5InBrackets:		// "[FAIL ]"
-			*szOut ++ = '[';
-			memcpy (szOut, EventSeverityTexts5 [sev], 5);
-			memcpy (szOut + 5, "] ", 2);
-			return 2 + 5 + 1;
-		case cunilogEvtSeverityTypeChars9InBrackets:		// "[FAIL     ]"
-			*szOut ++ = '[';
-			memcpy (szOut, EventSeverityTexts9 [sev], 9);
-			memcpy (szOut + 9, "] ", 2);
-			return 2 + 9 + 1;
-		case cunilogEvtSeverityTypeChars5InTightBrackets:
-			len = strlen (EventSeverityTexts5tgt [sev]);
-			ubf_assert (len <= 5);
-			*szOut ++ = '[';
-			memcpy (szOut, EventSeverityTexts5tgt [sev], len);
-			memcpy (szOut + len, "] ", 2);
-			memset (szOut + len + 2, ' ', 5 - len);
-			return 2 + 5 + 1;
-		case cunilogEvtSeverityTypeChars9InTightBrackets:
-			len = strlen (EventSeverityTexts9tgt [sev]);
-			ubf_assert (len <= 9);
-			*szOut ++ = '[';
-			memcpy (szOut, EventSeverityTexts9tgt [sev], len);
-			memcpy (szOut + len, "] ", 2);
-			memset (szOut + len + 2, ' ', 9 - len);
-			return 2 + 9 + 1;
+		// Without a logfile there's nothing to write to. The next event tries to open it
+		//	again.
+		if (requiresOpenLogFile (put))
+		{
+			if (!cunilogOpenLogFile (put))
+			{
+				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
+				return true;
+			}
+			setLogFileDateTimeStampInUse (put);
+			cunilogAddLogfileToFLSindex (put);
+		} else
+		if (REQUIRES_NEW_LOGFILE (put, cup, pev))
+		{
+			if (!cunilogOpenNewLogFile (put))
+			{
+				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
+				return true;
+			}
+			setLogFileDateTimeStampInUse (put);
+			cunilogAddLogfileToFLSindex (put);
+		}
+		if (!cunilogWriteDataToLogFile (put))
+				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_WRITING_LOGFILE, cup, pev);
+		// Rotators triggered by this event see the size that includes it, even if one of
+		//	them renames the active logfile and logs about it before the others run.
+		if (!cunilogHasEventNoRotation (pev))
+		{
+			put->logfile.ullSizePrv		=		put->logfile.bSizeUnseen
+										?	0
+										:	put->logfile.ullSizeEvt;
+			put->logfile.ullSizeEvt		= put->logfile.ullSize;
+			put->logfile.bSizeUnseen	= false;
+		}
 	}
-	ubf_assert_msg (false, "Internal error! We should never get here!");
-	return 0;
+	return true;
 }
 
-static inline size_t requiredFullstopChars (CUNILOG_EVENT *pev)
+static bool cunilogProcessFlushLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+	
+	if (cunilogHasDontWriteToLogfile (put))
+		return true;
 
-	return cunilogIsEventAutoFullstop (pev) ? 1 : 0;
-};
+	// The write-behind buffer has its own schedule and is not written out here.
+	#ifdef OS_IS_WINDOWS
+		if (!FlushFileBuffers (put->logfile.hLogFile))
+			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
+	#else
+		// A raw logfile has no buffer that could be flushed.
+		if (!cunilogHasRawLogfile (put) && 0 != fflush (put->logfile.fLogFile))
+			cunilogInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
+	#endif
+	return true;
+}
 
-static inline size_t writeFullStop (char *szOut, CUNILOG_EVENT *pev)
+static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev);
+static bool enqueueAndTriggerSeparateLoggingThread (CUNILOG_EVENT *pev);
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+
+	static inline void IncrementPendingNoRotationEvents (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		++ put->nPendingNoRotEvts;
+		//printf ("%" PRIu64 "\n", put->nPendingNoRotEvts);
+	}
+	static inline void DecrementPendingNoRotationEvents (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		-- put->nPendingNoRotEvts;
+		//printf ("%" PRIu64 "\n", put->nPendingNoRotEvts);
+	}
+#else
+	#define IncrementPendingNoRotationEvents(put)
+	#define DecrementPendingNoRotationEvents(put)
+#endif
+
+static bool logFromInsideRotatorTextU8vfmt (CUNILOG_TARGET *put, const char *fmt, va_list ap)
 {
-	ubf_assert_non_NULL (szOut);
-	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+
+	va_list		cp;
+	size_t		len;
+	bool		bRet = false;
+
+	// We're supposed to be inside a rotator. This means we should have a
+	//	CUNILOG_ROTATOR_ARGS structure set in our target. It also means
+	//	we should have a cunilog processor. Its pData member points to a
+	//	rotation data structure. Anything else is a bug.
+	ubf_assert_non_NULL (put->prargs);
+	ubf_assert_non_NULL (put->prargs->cup);
+	ubf_assert_non_NULL (put->prargs->cup->pData);
+
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+	ubf_assert_non_NULL (prd);
+
+	/*
+		prd->plogCUNILOG_TARGET == NULL		-> Log to current CUNILOG_TARGET (put) but
+												without rotation (because we currently *are*
+												within a rotation).
+		prd->plogCUNILOG_TARGET == put		-> Bug, as this should be NULL.
+		prd->plogCUNILOG_TARGET == <Anything else>
+											-> Log to this CUNILOG_TARGET normally.
+	*/
+	ubf_assert (put != prd->plogCUNILOG_TARGET);
+	if (prd->plogCUNILOG_TARGET && put != prd->plogCUNILOG_TARGET)
+		return logTextU8vfmt (put, fmt, ap);
+
+	va_copy (cp, ap);
+	len = (size_t) vsnprintf (NULL, 0, fmt, cp);
+	va_end (cp);
 
-	if (cunilogIsEventAutoFullstop (pev))
+	char *szTxtToLog = ubf_malloc (len + 1);
+	if (szTxtToLog)
 	{
-		if (pev->lenDataToLog && '.' != pev->szDataToLog [pev->lenDataToLog - 1])
+		va_copy (cp, ap);
+		vsnprintf (szTxtToLog, len + 1, fmt, cp);
+		va_end (cp);
+
+		CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, szTxtToLog, len);
+		ubf_assert_non_NULL (pev);
+		if (pev)
 		{
-			szOut [0] = '.';
-			return 1;
+			cunilogSetEventInternal		(pev);
+			cunilogSetEventNoRotation	(pev);
+			#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+				if (HAS_CUNILOG_TARGET_A_QUEUE (put))
+				{
+					IncrementPendingNoRotationEvents (put);
+					enqueueAndTriggerSeparateLoggingThread (pev);
+					bRet = true;
+				} else
+			#endif
+					bRet = cunilogProcessEventSingleThreaded (pev);
 		}
+		ubf_free (szTxtToLog);
 	}
-	return 0;
+	return bRet;
 }
 
-static inline size_t eventLenNewline (CUNILOG_EVENT *pev)
+static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt, ...)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert_non_NULL (put);
 
-	return lnLineEnding (pev->pCUNILOG_TARGET->unilogNewLine);
+	va_list		ap;
+	bool		bRet;
+
+	va_start (ap, fmt);
+	bRet = logFromInsideRotatorTextU8vfmt (put, fmt, ap);
+	va_end (ap);
+	return bRet;
 }
 
-static inline enum enLineEndings eventLineEnding (CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+#ifdef OS_IS_WINDOWS
+	static DWORD GetTextForLastError (char *szErrMsg)
+	{
+		ubf_assert_non_NULL (szErrMsg);
 
-	return pev->pCUNILOG_TARGET->unilogNewLine;
-}
+		// Note that we expect a buffer of CUNILOG_STD_MSG_SIZE octets.
+		DWORD dwError = GetLastError ();
+		GetWinErrorTextU8 (szErrMsg, CUNILOG_STD_MSG_SIZE, dwError);
+		return dwError;
+	}
+#else
+	static int GetTextForLastError (char *szErrMsg)
+	{
+		ubf_assert_non_NULL (szErrMsg);
 
-static inline void evtTSFormats_unilogEvtTS_ISO8601 (char *chISO, UBF_TIMESTAMP ts)
-{
-	ISO8601_from_UBF_TIMESTAMPc (chISO, ts);
-	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
-}
+		// Note that we expect a buffer of CUNILOG_STD_MSG_SIZE octets.
+		int iError = errno;
+		snprintf (szErrMsg, CUNILOG_STD_MSG_SIZE, "%d (%s)", iError, strerror (iError));
+		return iError;
+	}
+#endif
 
-static inline void evtTSFormats_unilogEvtTS_ISO8601T (char *chISO, UBF_TIMESTAMP ts)
-{
-	ISO8601T_from_UBF_TIMESTAMPc (chISO, ts);
-	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
-}
+/*
+	Increments the dot number part of a filename, i.e. ".1234".
+	Can also be "", which is the case for the original file.
+	Assumes that there's always enough space available to write out
+	the incremented value.
 
-static inline void evtTSFormats_unilogEvtTS_ISO8601_3spc (char *chISO, UBF_TIMESTAMP ts)
-{
-	ISO8601_from_UBF_TIMESTAMPc (chISO, ts);
-	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
-	chISO [LEN_ISO8601DATETIMESTAMPMS + 1]	= ' ';
-	chISO [LEN_ISO8601DATETIMESTAMPMS + 2]	= ' ';
-}
+	Like:
+	"file.log"		-> ""
+	"file.log.1"	-> ".1"
+	"file.log.2"	-> ".2"
+	"file.log.900"	-> ".900"
 
-static inline void evtTSFormats_unilogEvtTS_ISO8601T_3spc (char *chISO, UBF_TIMESTAMP ts)
+	Returns the new length of the dot number part, including the dot.
+*/
+static inline size_t incrementDotNumberName (char *sz)
 {
-	ISO8601T_from_UBF_TIMESTAMPc (chISO, ts);
-	chISO [LEN_ISO8601DATETIMESTAMPMS]		= ' ';
-	chISO [LEN_ISO8601DATETIMESTAMPMS + 1]	= ' ';
-	chISO [LEN_ISO8601DATETIMESTAMPMS + 2]	= ' ';
+	ubf_assert_non_NULL	(sz);
+	ubf_assert_non_0	(sz [0]);
+
+	if ('.' == sz [0])
+	{
+		++ sz;
+		uint64_t	ui = 0;;
+		ubf_uint64_from_str (&ui, sz);
+		++ ui;
+		size_t written = ubf_str_from_uint64 (sz, ui);
+		++ written;											// The '.'
+		return written;
+	} else
+	{
+		++ sz;
+		memcpy (sz, ".1", 3);
+		return 2;
+	}
 }
 
-static inline void evtTSFormats_unilogEvtTS_NCSADT (char *chNCSADT, UBF_TIMESTAMP ts)
+static inline char *findDotNumberPart (size_t *pln, CUNILOG_TARGET *put)
 {
-	NCSADATETIME_from_UBF_TIMESTAMP (chNCSADT, ts);
+	ubf_assert_non_NULL (pln);
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
+
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+
+	// Obtain the dot number part.
+	size_t ln = put->stFilToRotate - 1;
+	-- ln;
+	while (ln)
+	{
+		if (!isdigit (prd->mbDstFile.buf.pch [ln]))
+			break;
+		-- ln;
+	}
+	char *sz = prd->mbDstFile.buf.pch + ln;
+	*pln = ln;
+	return sz;
 }
 
 /*
-	Structure for the event timestamp table.
-	First member is the length that'll be written; second member is a pointer to the
-	function that is going to write this out.
+	Renames the DotNumberPostfix file in our files list (FLS) to keep the files list in sync
+	with the real directory on disk.
 */
-typedef struct seventTSformats
+static inline void renameDotNumberPostfixInFLS (CUNILOG_TARGET *put, size_t nLen, size_t oLen)
 {
-	size_t			len;									// Required length.
-	void			(*fnc) (char *, UBF_TIMESTAMP);			// Function pointer.
-} SeventTSformats;
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
 
-SeventTSformats evtTSFormats [cunilogEvtTS_AmountEnumValues] =
-{
-		{	// unilogEvtTS_ISO8601
-			LEN_ISO8601DATETIMESTAMPMS + 1,
-			evtTSFormats_unilogEvtTS_ISO8601				// "YYYY-MM-DD HH:MI:SS.000+01:00 ".
-		}
-	,	{	// unilogEvtTS_ISO8601T
-			LEN_ISO8601DATETIMESTAMPMS + 1,
-			evtTSFormats_unilogEvtTS_ISO8601T				// "YYYY-MM-DDTHH:MI:SS.000+01:00 ".
-		}
-	,	{	// unilogEvtTS_ISO8601_3spc
-			LEN_ISO8601DATETIMESTAMPMS + 3,
-			evtTSFormats_unilogEvtTS_ISO8601_3spc			// "YYYY-MM-DD HH:MI:SS.000+01:00   ".
-		}
-	,	{	// unilogEvtTS_ISO8601T_3spc
-			LEN_ISO8601DATETIMESTAMPMS + 3,
-			evtTSFormats_unilogEvtTS_ISO8601T_3spc			// "YYYY-MM-DDTHH:MI:SS.000+01:00   ".
-		}
-	,	{	// cunilogEvtTS_NCSADT
-			LEN_NCSA_COMMON_LOG_DATETIME + 1,				// "[10/Oct/2000:13:55:36 -0700] ".
-			evtTSFormats_unilogEvtTS_NCSADT
-		}
-};
+	CUNILOG_ROTATOR_ARGS	*prg = put->prargs;
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
 
-static inline size_t requiredEvtLineTimestampAndSeverityLength (CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	char		*szDst;
+	const char	*ccSrc;
 
-	size_t	r;
+	if (nLen > oLen)
+	{
+		char	*sz	= put->fls.data [prg->idx].chFilename;
+		size_t	ln	= put->fls.data [prg->idx].stFilename - oLen + nLen;
+		put->stFLSorphaned += put->fls.data [prg->idx].stFilename;
+		put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, ln);
+		char *szFls = put->fls.data [prg->idx].chFilename;
+		if (NULL == szFls)
+		{	// Bulk memory allocation failed. There's not much we can do.
+			ubf_assert_msg (false, "Bulk memory allocation failed");
+			return;
+		}
+		memcpy (szFls, sz, put->fls.data [prg->idx].stFilename);
+		put->fls.data [prg->idx].stFilename = ln;
 
-	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " ".
-	r = evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].len;
-	// "WRN" + " "
-	r += requiredEventSeverityChars (pev->evSeverity, pev->pCUNILOG_TARGET->evSeverityType);
+		// Since the new vector entry is empty, we also need to copy the NUL terminator.
+		++ nLen;
+	}
 
-	return r;
+	szDst	=	put->fls.data [prg->idx].chFilename
+			+	put->lnAppName
+			+	lenCunilogLogFileNameExtension;
+
+	ccSrc	=	prd->mbDstFile.buf.pcc
+			+	put->lnLogPath
+			+	put->lnAppName
+			+	lenCunilogLogFileNameExtension;
+	memcpy (szDst, ccSrc, nLen);
 }
 
-static inline size_t requiredEventLineSizeU8 (CUNILOG_EVENT *pev)
+/*
+	Removes the entry at index idx from our files list (FLS) after its file has been
+	deleted or moved out of the logging folder.
+*/
+static inline void removeFromFLS (CUNILOG_TARGET *put, size_t idx)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
-
-	size_t	r;
-
-	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
-	r = requiredEvtLineTimestampAndSeverityLength (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
 
-	// Actual data.
-	r += pev->lenDataToLog;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+	put->stFLSorphaned += put->fls.data [idx].stFilename;
+	vec_splice (&put->fls, idx, 1);
+}
 
-	// "."
-	r += requiredFullstopChars (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+static void insertIntoFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName);
 
-	// CR + LF max.
-	r += eventLenNewline (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+/*
+	Renames the LogPostfix file in our files list (FLS) to keep the files list in sync
+	with the real directory on disk.
+*/
+static inline void renameLogPostfixInFLS (CUNILOG_TARGET *put, const char *szNew, size_t lnNew)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL	(szNew);
+	ubf_assert_non_0	(lnNew);
+	ubf_assert			(strlen (szNew) == lnNew);
 
-	// Terminating NUL.
-	r += 1;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+	CUNILOG_ROTATOR_ARGS	*prg	= put->prargs;
+	size_t					siz		= lnNew + 1;
 
-	return r;
+	if (cunilogTargetHasFLSindexBuilt (put))
+	{	// If the active logfile is rotated twice within the same period, the rename
+		//	replaces the file rotated first. Inserting the new name instead of
+		//	overwriting the entry keeps the files list index sorted and unique.
+		removeFromFLS (put, prg->idx);
+		insertIntoFLSindex (put, szNew, siz);
+		return;
+	}
+	put->stFLSorphaned += put->fls.data [prg->idx].stFilename;
+	put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, siz);
+	if (put->fls.data [prg->idx].chFilename)
+	{
+		memcpy (put->fls.data [prg->idx].chFilename, szNew, siz);
+		put->fls.data [prg->idx].stFilename = siz;
+		return;
+	}
+	// Bulk memory allocation failed. There's not much we can do.
+	ubf_assert_msg (false, "Bulk memory allocation failed");
+	put->fls.data [prg->idx].stFilename = 0;
 }
 
-/*
-	writeEventLineFromSUNILOGEVENTU8
-
-	The caller is responsible for szEventLine to point to a buffer big enough to hold the
-	event line. The function requiredEventLineSize () obtains this size.
+/*
+	The size and last write time of a new files list entry are obtained when a retention
+	policy needs them. See isLogfileBeyondRetention ().
 */
-static size_t writeEventLineFromSUNILOGEVENTU8 (char *szEventLine, CUNILOG_EVENT *pev)
+static inline void initCUNILOG_FLSattributes (CUNILOG_FLS *pfls)
 {
-	ubf_assert_non_NULL (szEventLine);
-	ubf_assert_non_NULL (pev);
-	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	ubf_assert (cunilogIsTargetInitialised (pev->pCUNILOG_TARGET));
+	ubf_assert_non_NULL (pfls);
 
-	char	*szOrg = szEventLine;
+	pfls->ullSize		= CUNILOG_FLS_UNKNOWN;
+	pfls->ullModified	= CUNILOG_FLS_UNKNOWN;
+}
 
-	DBG_RESET_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
+/*
+	Replaces the name of the entry at index idx of our files list (FLS) with the name of
+	the file its logfile is compressed into with the compressor cmp, so that subsequent
+	rotators, like the ones that delete logfiles, work on the compressed file. Since the
+	extension is appended, the entry keeps its position in the sorted list and the index.
+*/
+static void extCompressedInFLS (CUNILOG_TARGET *put, size_t idx, enextcompressor cmp)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
 
-	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " (see table above).
-	evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].fnc (szEventLine, pev->stamp);
-	//ISO8601_from_UBF_TIMESTAMP (szEventLine, pue->stamp);
+	CUNILOG_FLS	*pfls	= &put->fls.data [idx];
+	size_t		lnExt;
+	const char	*ccExt	= ExtCompressorFileExtension (cmp, &lnExt);
+	char		*szName	= GetAlignedMemFromSBULKMEMgrow (&put->sbm, pfls->stFilename + lnExt);
 
-	szEventLine += evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].len;
-	szEventLine += writeEventSeverity (szEventLine, pev->evSeverity, pev->pCUNILOG_TARGET->evSeverityType);
-	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+	if (NULL == szName)
+	{	// The compressed file is picked up when the folder is read again.
+		removeFromFLS (put, idx);
+		return;
+	}
+	memcpy (szName, pfls->chFilename, pfls->stFilename - 1);
+	memcpy (szName + pfls->stFilename - 1, ccExt, lnExt + 1);
+	put->stFLSorphaned += pfls->stFilename;
+	pfls->chFilename	= szName;
+	pfls->stFilename	+= lnExt;
+	initCUNILOG_FLSattributes (pfls);
+}
 
-	memcpy (szEventLine, pev->szDataToLog, pev->lenDataToLog);
-	szEventLine += pev->lenDataToLog;
-	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+/*
+	The next rotator would have to read the directory listing from disk again,
+	but we may not have logfile.log again yet, if no event has been written to it,
+	which would mean the amount of files to ignore is one too high.
 
-	szEventLine += writeFullStop (szEventLine, pev);
-	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
+	We therefore need to insert the current/active logfile's name.
+	Since the vector is sorted with the current logfile at index 0, vec_insert() is
+	invoked instead of vec_push().
 
-	// We've reserved space for a new line character sequence in requiredEventLineSizeU8 ()
-	//	but we're not going to add this here yet. Instead, we NUL-terminate. This simply lets
-	//	us call puts (). We'll add the new line sequence later in the processor that writes
-	//	to the logfile.
+					-> logfile.log		<- Inserted by vec_insert() below.
+	logfile.log		-> logfile.log.1
+	logfile.log.1	-> logfile.log.2
 
-	// The NUL byte is useful for OS API functions.
-	szEventLine [0] = ASCII_NUL;
-	return szEventLine - szOrg;
-}
+	i == false	:	Insert at the beginning/top.
+	i == true	:	Push to the end.
 
-/*
-static bool obtainValidSCUNILOGDUMPinCUNILOG_TARGET (CUNILOG_TARGET *put)
+*/
+static inline void cunilogAddActiveLogfile (bool bIsActiveLogfile, bool i, CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-	if (NULL == put->psdump)
+	if (bIsActiveLogfile)
 	{
-		put->psdump = ubf_malloc (sizeof (SCUNILOGDUMP));
-		SCUNILOGDUMP *pd = put->psdump;
-		if (pd)
+		CUNILOG_FLS	currFls;
+		initCUNILOG_FLSattributes (&currFls);
+		currFls.stFilename = put->lnAppName + sizCunilogLogFileNameExtension;
+		currFls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, currFls.stFilename);
+		if (currFls.chFilename)
 		{
-			pd->dump_prs = ubf_malloc (sizeof (SHEX_DUMP_PARS));
-			pd->dump_sns = ubf_malloc (sizeof (SHEX_DUMP_SAN));
-			if (pd->dump_prs && pd->dump_sns)
+			memcpy (currFls.chFilename, put->mbAppName.buf.pcc, put->lnAppName);
+			memcpy (currFls.chFilename + put->lnAppName, szCunilogLogFileNameExtension,
+						sizCunilogLogFileNameExtension);
+			if (i)
 			{
-				ubf_data_dump_def_SUBF_DUMP_PARS (pd->dump_prs);
-				SHEX_DUMP_SAN *ps = pd->dump_sns;
-				ps->bInitialised = false;
-				return true;
+				if (0 == vec_push (&put->fls, currFls))
+					return;
 			} else
 			{
-				if (NULL != pd->dump_prs)
-					ubf_free (pd->dump_prs);
-				if (NULL != pd->dump_sns)
-					ubf_free (pd->dump_sns);
-				pd->dump_prs = NULL;
-				pd->dump_sns = NULL;
+				if (0 == vec_insert (&put->fls, 0, currFls))
+					return;
 			}
 		}
-		return false;
-	} else
-		return true;
-}
-*/
-
-static inline size_t widthOfCaptionLengthFromCunilogEventType (cueventtype type)
-{
-	switch (type)
-	{
-		case cunilogEvtTypeNormalText:				return 0;
-		case cunilogEvtTypeCommand:					return 0;
-		case cunilogEvtTypeHexDumpWithCaption8:		return 1;
-		case cunilogEvtTypeHexDumpWithCaption16:	return 2;
-		case cunilogEvtTypeHexDumpWithCaption32:	return 4;
-		case cunilogEvtTypeHexDumpWithCaption64:	return 8;
-		default:									return 0;
+		SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
 	}
 }
 
-static size_t readCaptionLengthFromData (unsigned char *pData, size_t ui)
+static inline bool prepareDotNumberPostfixFileToRename	(
+						CUNILOG_TARGET				*put,
+						size_t						*poldLength,
+						size_t						*pnewLength
+												)
 {
-	uint8_t			ui8;
-	uint16_t		ui16;
-	uint32_t		ui32;
-	uint64_t		ui64;
-	size_t			lnRet;
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL	(put->prargs->cup);
+	ubf_assert_non_NULL (poldLength);
+	ubf_assert_non_NULL (pnewLength);
+	
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+	bool					bIsActiveLogfile;
 
-	switch (ui)
-	{
-		case 0:	lnRet = 0;									break;
-		case 1:	memcpy (&ui8, pData, ui);	lnRet = ui8;	break;
-		case 2:	memcpy (&ui16, pData, ui);	lnRet = ui16;	break;
-		case 4:	memcpy (&ui32, pData, ui);	lnRet = ui32;	break;
-		case 8:	
-				ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
-				memcpy (&ui64, pData, ui);
-				lnRet = (size_t) ui64;						break;
-		default:
-				ubf_assert_msg (false, "Bug");
-				lnRet = 0;									break;
-	}
-	return lnRet;
+	memcpy (prd->mbDstFile.buf.pch, put->mbFilToRotate.buf.pch, put->stFilToRotate);
+	size_t ln;
+	char *sz = findDotNumberPart (&ln, put);
+	//printf ("Dot number part: >%s<\n", sz);
+	// Either ".log.<number>" orr "g" from ".log".
+	ubf_assert ('.' == sz [0] || 'g' == sz [0]);
+	bIsActiveLogfile = 'g' == sz [0];
+	// The dot number part of the active logfile is appended after the "g" of ".log".
+	*poldLength = bIsActiveLogfile ? 0 : put->stFilToRotate - 1 - ln;
+	*pnewLength = incrementDotNumberName (sz);
+	return bIsActiveLogfile;
 }
 
-static char		scSummaryOctets []	= " octets/bytes.";
-static size_t	lnSummaryOctets		= sizeof (scSummaryOctets) - 1;
-
-static inline size_t requiredEventLineSizeHexDump	(
-						unsigned char		**pDumpData,
-						size_t				*width,
-						size_t				*len,
-						CUNILOG_EVENT		*pev
+static inline bool prepareLogPostfixFileToRename	(
+						CUNILOG_TARGET				*put,
+						char						**pszNewFileName,
+						size_t						*poldLength,
+						size_t						*pnewLength
 													)
 {
-	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL	(put->prargs->cup);
+	ubf_assert_non_NULL	(pszNewFileName);
+	ubf_assert_non_NULL (poldLength);
+	ubf_assert_non_NULL (pnewLength);
+	
+	UNUSED (poldLength);
+
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+
+	ubf_assert	(put->prargs->siz == put->lnAppName + sizCunilogLogFileNameExtension);
+	ubf_assert	(!memcmp (put->prargs->nam, put->mbAppName.buf.pcc, put->lnAppName));
 	ubf_assert	(
-						cunilogEvtTypeHexDumpWithCaption8	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption16	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption32	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption64	== pev->evType
+		!memcmp (put->prargs->nam + put->lnAppName,
+		szCunilogLogFileNameExtension,
+		lenCunilogLogFileNameExtension)
 				);
-	ubf_assert_non_NULL (pDumpData);
-	ubf_assert_non_NULL (width);
-	ubf_assert_non_NULL (len);
+	char *szWrite = prd->mbDstFile.buf.pch;
+	memcpy (szWrite, put->mbFilToRotate.buf.pcc, put->lnLogPath);
+	szWrite += put->lnLogPath;
+	memcpy (szWrite, put->mbAppName.buf.pcc, put->lnAppName);
+	*pszNewFileName = szWrite;
+	szWrite += put->lnAppName;
+	*szWrite ++ = '_';
+	obtainDateAndTimeStamp (szWrite, put->prargs->cup->cur, put->culogPostfix);
+	szWrite += lenDateTimeStampFromPostfix (put->culogPostfix);
+	memcpy (szWrite, szCunilogLogFileNameExtension, sizCunilogLogFileNameExtension);
+	*pnewLength =		put->lnAppName
+				+	1								// Underscore '_'.
+				+	lenDateTimeStampFromPostfix (put->culogPostfix)
+				+	lenCunilogLogFileNameExtension;
+	return true;
+}
 
-	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
+/*
+	Moves/renames the file mbFilToRotate to prd->mbDstFile. Both reside in the logging
+	folder. On POSIX, the move is carried out with renameat () relative to the directory
+	file descriptor of the logging folder, which only requires the names of the files.
+*/
+static inline bool cunilogMoveFileToRotate (CUNILOG_TARGET *put, CUNILOG_ROTATION_DATA *prd)
+{
 	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (prd);
 
-	size_t	r;
-
-	/*
-		Timestamp + Type + caption, etc.
-	*/
-
-	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
-	r = requiredEvtLineTimestampAndSeverityLength (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	// The width of the caption length.
-	size_t ui			= widthOfCaptionLengthFromCunilogEventType (pev->evType);
-	// Its actual length. This needs to be added to our return value.
-	size_t lenCaption	= readCaptionLengthFromData (pev->szDataToLog, ui);
-	*pDumpData			= pev->szDataToLog + ui + lenCaption;
-	*width				= ui;
-	*len				= lenCaption;
-	r += lenCaption;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	// "."
-	r += requiredFullstopChars (pev);
-	// New line.
-	r += eventLenNewline (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	// Actual dump data size. Includes NUL terminator.
-	size_t sizHexDmp = hxdmpRequiredSize (pev->lenDataToLog, put->dumpWidth, eventLineEnding (pev));
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, sizHexDmp);
-	r += sizHexDmp;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	// ASCII TAB.
-	++ r;
-
-	// To be considered in the future:
-	//	It would be faster to just always reserve UBF_UINT64_LEN octets instead of
-	//	performing the uint -> ASCII transformation.
-	char cDmpOctets [UBF_UINT64_SIZE];
-	//r += ubf_str_from_uint64 (cDmpOctets, pev->lenDataToLog);
-	ubf_str__from_uint64 (cDmpOctets, 10, pev->lenDataToLog);
-	r += 10;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	r += lnSummaryOctets;
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
-
-	// New line.
-	r += eventLenNewline (pev);
-	DBG_TRACK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, r);
+	#ifdef PLATFORM_IS_WINDOWS
+		return MoveFileU8long (put->mbFilToRotate.buf.pch, prd->mbDstFile.buf.pcc);
+	#else
+		ubf_assert (!memcmp (put->mbFilToRotate.buf.pcc, put->mbLogPath.buf.pcc, put->lnLogPath));
+		ubf_assert (!memcmp (prd->mbDstFile.buf.pcc, put->mbLogPath.buf.pcc, put->lnLogPath));
 
-	#ifdef DEBUG
-		++ r;												// Space for a debug marker.
+		int fd = cunilogLogFoldFD (put);
+		if (-1 == fd)
+			return false;
+		int i = renameat	(
+					fd, put->mbFilToRotate.buf.pcc + put->lnLogPath,
+					fd, prd->mbDstFile.buf.pcc + put->lnLogPath
+							);
+		if (-1 == i && ENOENT == errno)
+		{	// The logging folder might have been deleted and created again since we
+			//	opened it. Its directory fd then still refers to the deleted folder.
+			DoneCUNILOG_TARGETfdLogFold (put);
+			fd = cunilogLogFoldFD (put);
+			if (-1 == fd)
+				return false;
+			i = renameat	(
+					fd, put->mbFilToRotate.buf.pcc + put->lnLogPath,
+					fd, prd->mbDstFile.buf.pcc + put->lnLogPath
+							);
+		}
+		return 0 == i;
 	#endif
-
-	return r;
 }
 
-static size_t createDumpEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+static void cunilogRenameLogfile (CUNILOG_TARGET *put)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
-	ubf_assert	(
-						cunilogEvtTypeHexDumpWithCaption8	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption16	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption32	== pev->evType
-					||	cunilogEvtTypeHexDumpWithCaption64	== pev->evType
-				);
-
-	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL	(put->prargs->cup);
+	ubf_assert_non_NULL	(put->prargs->cup->pData);
+	ubf_assert			(isInitialisedSMEMBUF (&put->mbFilToRotate));
+	ubf_assert_non_0	(put->stFilToRotate);
+	ubf_assert_non_0	(1 < put->stFilToRotate);
+	ubf_assert			(hasDotNumberPostfix (put) || hasLogPostfix (put));
 
-	unsigned char	*pDumpData;
-	size_t			captionWidth;
-	size_t			captionLen;
-	size_t lenTotal = requiredEventLineSizeHexDump (&pDumpData, &captionWidth, &captionLen, pev);
-	// pDumpData				Points to the data to dump.
-	// pev->lenDataToLog		Its length.
+	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+	bool					bIsActiveLogfile;
+	size_t					oldLen			= 0;
+	size_t					newLen;
+	char					*szNewFileName		= NULL;
 
-	growToSizeSMEMBUF64aligned (&put->mbLogEventLine, lenTotal);
-	if (isUsableSMEMBUF (&put->mbLogEventLine))
+	if (!cunilogHasRotatorFlag_USE_MBDSTFILE (prd))
+	{														// The + 1 is for an underscore.
+		initSMEMBUFtoSize	(
+			&prd->mbDstFile,
+			put->stFilToRotate + lenDateTimeStampFromPostfix (put->culogPostfix) + 1
+							);
+		cunilogSetRotatorFlag_USE_MBDSTFILE (prd);
+	}
+	growToSizeSMEMBUF	(
+		&prd->mbDstFile,
+		put->stFilToRotate + lenDateTimeStampFromPostfix (put->culogPostfix) + 1
+						);
+	if (isUsableSMEMBUF (&prd->mbDstFile))
 	{
-		#ifdef DEBUG
-			put->mbLogEventLine.buf.pch [lenTotal] = CUNILOG_DEFAULT_DBG_CHAR;
-		#endif
-		char *szOut = put->mbLogEventLine.buf.pch;
-		char *szOrg = szOut;
-
-		// Timestamp + severity.
-		evtTSFormats [put->unilogEvtTSformat].fnc (szOut, pev->stamp);
-		szOut += evtTSFormats [put->unilogEvtTSformat].len;
-		szOut += writeEventSeverity (szOut, pev->evSeverity, put->evSeverityType);
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
-
-		// Caption.
-		memcpy (szOut, pev->szDataToLog + captionWidth, captionLen);
-		szOut += captionLen;
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
+		if (hasDotNumberPostfix (put))
+		{
+			bIsActiveLogfile = prepareDotNumberPostfixFileToRename (put, &oldLen, &newLen);
+		} else
+		if (hasLogPostfix (put))
+		{
+			// We only have to deal with the current/active logfile here. All other file names
+			//	stay the same throughout their existence.
+			if (put->prargs->siz != put->lnAppName + sizCunilogLogFileNameExtension)
+				return;
+			bIsActiveLogfile = prepareLogPostfixFileToRename (put, &szNewFileName, &oldLen, &newLen);
+		} else
+		{
+			ubf_assert_msg (false, "Bug!");
+			return;
+		}
 
-		// "." + new line.
-		size_t lenNewLine = eventLenNewline (pev);
-		szOut += writeFullStop (szOut, pev);
-		memcpy (szOut, ccLineEnding (eventLineEnding (pev)), lenNewLine);
-		szOut += lenNewLine;
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
+		if (bIsActiveLogfile)
+			cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		bool bMoved = cunilogMoveFileToRotate (put, prd);
 
-		put->lnLogEventLine = szOut - szOrg;
-		char *szHexDmpOut = szOut;
-		size_t sizHx = hxdmpWriteHexDump	(
-						szHexDmpOut, pDumpData, pev->lenDataToLog,
-						put->dumpWidth, put->unilogNewLine
+		// Obtain the error before reopening the logfile can overwrite it.
+		char szErr [CUNILOG_STD_MSG_SIZE];
+		#ifdef PLATFORM_IS_WINDOWS
+			DWORD	sysErr	= bMoved ? ERROR_SUCCESS : GetTextForLastError (szErr);
+		#else
+			int		sysErr	= bMoved ? 0 : GetTextForLastError (szErr);
+		#endif
+		if (bIsActiveLogfile && requiresOpenLogFile (put))
+		{
+			if (!cunilogOpenLogFile (put))
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
+				cunilogSetTargetErrorAndInvokeErrorCallback	(
+					CUNILOG_ERROR_OPENING_LOGFILE,
+					put->prargs->cup, put->prargs->pev
+															);
+			}
+		}
+		if (bMoved)
+		{
+			if (hasDotNumberPostfix (put))
+			{
+				renameDotNumberPostfixInFLS (put, newLen, oldLen);
+				cunilogAddActiveLogfile (bIsActiveLogfile, false, put);
+			} else
+			if (hasLogPostfix (put))
+			{
+				renameLogPostfixInFLS (put, szNewFileName, newLen);
+				cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
+			}
+			logFromInsideRotatorTextU8fmt	(
+				put, "File \"%s\" moved/renamed to \"%s\".",
+				put->mbFilToRotate.buf.pcc,
+				prd->mbDstFile.buf.pcc
 											);
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, sizHx + 1);
-		ubf_assert (CUNILOG_DEFAULT_DBG_CHAR == put->mbLogEventLine.buf.pch [lenTotal]);
-		put->lnLogEventLine += sizHx;
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+		} else
+		{
+			logFromInsideRotatorTextU8fmt	(
+				put,
+				"Error %s while attempting to move file \"%s\" to \"%s\".",
+				szErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
+											);
+			SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, sysErr);
+		}
+	}
+}
 
-		szOut = szHexDmpOut + sizHx;
-		szOut [0] = ASCII_TAB;
-		++ szOut;
-		++ put->lnLogEventLine;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Adds a message of job pj to the messages of the maintenance thread of the target
+		put points to. The messages are logged, and obtain their timestamps, by the thread
+		that processes the events of the target. See cunilogLogMaintenanceMessages ().
+	*/
+	static bool logFromMaintenanceThreadTextU8vfmt	(
+					CUNILOG_TARGET		*put,
+					CUNILOG_MAINTJOB	*pj,
+					const char			*fmt,
+					va_list				ap
+													)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (put->pmt);
+		ubf_assert_non_NULL (pj);
 
-		//size_t lnOctets = ubf_str_from_uint64 (szOut, pev->lenDataToLog);
-		size_t lnOctets = 10;
-		ubf_str__from_uint64 (szOut, 10, pev->lenDataToLog);
-		put->lnLogEventLine += lnOctets;
-		ubf_assert (CUNILOG_DEFAULT_DBG_CHAR == put->mbLogEventLine.buf.pch [lenTotal]);
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		va_list				cp;
+		int					iLen;
 
-		szOut += lnOctets;
-		memcpy (szOut, scSummaryOctets, lnSummaryOctets + 1);
-		put->lnLogEventLine += lnSummaryOctets;
-		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, put->lnLogEventLine + 1);
+		va_copy (cp, ap);
+		iLen = vsnprintf (NULL, 0, fmt, cp);
+		va_end (cp);
+		if (iLen < 0)
+			return false;
 
-		return put->lnLogEventLine;
+		CUNILOG_MAINTMSG *pm = ubf_malloc (sizeof (CUNILOG_MAINTMSG) + (size_t) iLen + 1);
+		if (NULL == pm)
+			return false;
+		pm->next				= NULL;
+		pm->plogCUNILOG_TARGET	= pj->plogCUNILOG_TARGET;
+		pm->szMsg				= (char *) (pm + 1);
+		pm->lnMsg				= (size_t) iLen;
+		va_copy (cp, ap);
+		vsnprintf (pm->szMsg, (size_t) iLen + 1, fmt, cp);
+		va_end (cp);
+
+		EnterLocker (&pmt->cl);
+		if (pmt->lastMsg)
+			pmt->lastMsg->next = pm;
+		else
+			pmt->firstMsg = pm;
+		pmt->lastMsg = pm;
+		cunilogAtomicAddSize (&pmt->nMsgs, 1);
+		LeaveLocker (&pmt->cl);
+		return true;
 	}
-	return CUNILOG_SIZE_ERROR;
-}
+#endif
 
-static size_t createU8EventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+/*
+	Logs a message of a rotation task. The task is either carried out by the rotator
+	itself, in which case pj is NULL, or by the maintenance thread for job pj.
+*/
+static bool logRotationTextU8fmt (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj, const char *fmt, ...)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
-	ubf_assert (cunilogEvtTypeNormalText == pev->evType);
+	ubf_assert_non_NULL (put);
 
-	size_t requiredEvtLineSize;
+	va_list		ap;
+	bool		bRet;
 
-	requiredEvtLineSize = requiredEventLineSizeU8 (pev);
-	growToSizeSMEMBUF64aligned (&pev->pCUNILOG_TARGET->mbLogEventLine, requiredEvtLineSize);
-	if (isUsableSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine))
-	{
-		pev->pCUNILOG_TARGET->lnLogEventLine =
-			writeEventLineFromSUNILOGEVENTU8 (pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch, pev);
-		return pev->pCUNILOG_TARGET->lnLogEventLine;
-	}
-	return CUNILOG_SIZE_ERROR;
+	va_start (ap, fmt);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			bRet = logFromMaintenanceThreadTextU8vfmt (put, pj, fmt, ap);
+		else
+	#else
+		UNUSED (pj);
+	#endif
+			bRet = logFromInsideRotatorTextU8vfmt (put, fmt, ap);
+	va_end (ap);
+	return bRet;
 }
 
-static size_t createEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+static inline const char *fileToRotate (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
-
-	DBG_RESET_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
+	ubf_assert_non_NULL (put);
 
-	switch (pev->evType)
-	{
-		case cunilogEvtTypeNormalText:
-			return createU8EventLineFromSUNILOGEVENT	(pev);
-	#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
-		case cunilogEvtTypeCommand:
-			ubf_assert_msg (false, "Cunilog bug! This function is not to be called in this case!");
-			break;
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			return pj->szFile;
+	#else
+		UNUSED (pj);
 	#endif
-		case cunilogEvtTypeHexDumpWithCaption8:
-		case cunilogEvtTypeHexDumpWithCaption16:
-		case cunilogEvtTypeHexDumpWithCaption32:
-		case cunilogEvtTypeHexDumpWithCaption64:
-			return createDumpEventLineFromSUNILOGEVENT	(pev);
-		default:
-			break;
-	}
-	return CUNILOG_SIZE_ERROR;
+	return put->mbFilToRotate.buf.pcc;
 }
 
 /*
-	Not to be called with 0 == ui.
+	Called when the logfile to rotate has been moved to the recycle bin or deleted. The
+	logfile of a job of the maintenance thread has been removed from the files list
+	already when the job was queued.
 */
-static inline void storeCaptionLength (unsigned char **pData, size_t ui, size_t lenCapt)
+static inline void removeRotatedFromFLS (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 {
-	ubf_assert_non_NULL (pData);
-	ubf_assert_non_NULL (*pData);
-	ubf_assert_non_0	(ui);
+	ubf_assert_non_NULL (put);
 
-	uint8_t			ui8;
-	uint16_t		ui16;
-	uint32_t		ui32;
-	uint64_t		ui64;
+	if (NULL == pj)
+		removeFromFLS (put, put->prargs->idx);
+}
 
-	switch (ui)
-	{
-		/*
-		// We're not being called for 0 == ui.
-		case 0:
-			ubf_assert_msg (false, "Must be a bug!");
-			return;
-		*/
-		case 1:
-			ui8 = (uint8_t) (lenCapt & 0xFF);
-			memcpy (*pData, &ui8, ui);
-			break;
-		case 2:
-			ui16 = (uint16_t) (lenCapt & 0xFFFF);
-			memcpy (*pData, &ui16, ui);
-			break;
-		case 4:
-			ui32 = (uint32_t) (lenCapt & 0xFFFFFFFF);
-			memcpy (*pData, &ui32, ui);
+/*
+	Called when the logfile to rotate could not be moved to the recycle bin or deleted.
+*/
+static inline void keepRotatedInFLS (CUNILOG_MAINTJOB *pj)
+{
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			pj->bFailed = true;
+	#else
+		UNUSED (pj);
+	#endif
+}
+
+static inline uint64_t rotatorFlags (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			return pj->uiFlgs;
+	#else
+		UNUSED (pj);
+	#endif
+	ubf_assert_non_NULL (put->prargs);
+	CUNILOG_ROTATION_DATA *prd = put->prargs->cup->pData;
+	return prd->uiFlgs;
+}
+
+static inline enextcompressor rotatorCompressor (uint64_t uiFlgs)
+{
+	return uiFlgs & CUNILOG_ROTATOR_FLAG_ZSTD ? extcompressor_zstd : extcompressor_gzip;
+}
+
+static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+
+	bool b;
+	char szErr [CUNILOG_STD_MSG_SIZE];
+	const char *szFile = fileToRotate (put, pj);
+	
+	enfilecompressresult	cmprRes = IsFileCompressedByName (szFile);
+	switch (cmprRes)
+	{
+		case fscompress_uncompressed:
+			logRotationTextU8fmt	(
+				put, pj, "Initiating file system compression for file \"%s\"...",
+				szFile
+									);
+			b = FScompressFileByName (szFile);
+			if (b)
+			{
+				logRotationTextU8fmt	(
+					put, pj, "File system compression for file \"%s\" initiated.",
+					szFile
+										);
+			} else
+			{
+				GetTextForLastError (szErr);
+				logRotationTextU8fmt	(
+					put, pj,
+					"Error %s while attempting to initiate file system compression for file \"%s\".",
+					szErr, szFile
+										);
+			}
 			break;
-		case 8:
-			ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
-			ui64 = (uint64_t) lenCapt;
-			memcpy (*pData, &ui64, ui);
+		case fscompress_compressed:
 			break;
-		default:
-			ubf_assert_msg (false, "Must be a bug!");
+		case fscompress_error:
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt	(
+				put, pj,
+				"Error %s while attempting to check file system compression for file \"%s\".",
+				szErr, szFile
+									);
 			break;
 	}
-	*pData += ui;
 }
 
-/*
-	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
-	in which case a buffer of siz octets is reserved but not initialised!
-*/
-static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccCapt,
-					size_t						lenCapt,
-					cueventtype					type,
-					const char					*ccData,
-					size_t						siz
-													)
-{
-	ubf_assert_non_NULL	(put);
-	if (ccData)
-		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
-	else
-		ubf_assert (cunilogEvtTypeCommand == type && NULL == ccData);
-	ubf_assert			(USE_STRLEN != siz);
-	ubf_assert			(0 <= type);
-	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
-
-	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
-	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
-	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
-	size_t			ln		= aln + wl + lenCapt + siz;
-	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+#if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
 
-	if (pev)
+	static void MoveFileToRecycleBinWin (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
-		unsigned char *pData = (unsigned char *) pev + aln;
-		
-		if	(	
-					cunilogHasEnqueueTimestamps	(put)
-				&&	HAS_CUNILOG_TARGET_A_QUEUE	(put)
-			)
-		{
-			FillCUNILOG_EVENT	(
-				pev, put,
-				CUNILOGEVENT_ALLOCATED,
-				0,
-				sev, type,
-				pData, siz, ln
+		ubf_assert_non_NULL (put);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+		const char *szFile = fileToRotate (put, pj);
+
+		logRotationTextU8fmt	(
+			put, pj, "Moving obsolete logfile \"%s\" to recycle bin...", szFile
 								);
-		} else
+		bool b = MoveToRecycleBinU8 (szFile);
+		if (b)
 		{
-			FillCUNILOG_EVENT	(
-				pev, put,
-				CUNILOGEVENT_ALLOCATED,
-				LocalTime_UBF_TIMESTAMP (),
-				sev, type,
-				pData, siz, ln
-								);
-		}
-		if (wl)
+			logRotationTextU8fmt	(
+				put, pj, "Obsolete logfile \"%s\" moved to recycle bin.", szFile
+									);
+			removeRotatedFromFLS (put, pj);
+		} else
 		{
-			storeCaptionLength (&pData, wl, lenCapt);
-			memcpy (pData, ccCapt, lenCapt);
-			pData += lenCapt;
+			char szErr [CUNILOG_STD_MSG_SIZE];
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt	(
+				put, pj,
+				"Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.", szErr, szFile
+									);
+			keepRotatedInFLS (pj);
 		}
-		if (ccData)
-			memcpy (pData, ccData, siz);
-		else
-			ubf_assert (cunilogEvtTypeCommand == type);
 	}
-	return pev;
-}
 
-/*
-	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
-	in which case a buffer of siz octets is reserved but not initialised!
+#elif OS_IS_MACOS
 
-	This function is identical to CreateCUNILOG_EVENTandData () but requires
-	an additional UBF_TIMESTAMP parameter (ts).
+	#include "./../OS/Apple/TrashCan.h"
 
-	This is a separate function so that it could easily be removed via
-	macro definitions later if required.
-*/
-static CUNILOG_EVENT *CreateCUNILOG_EVENTandDataTS	(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccCapt,
-					size_t						lenCapt,
-					cueventtype					type,
-					const char					*ccData,
-					size_t						siz,
-					UBF_TIMESTAMP				ts
-													)
-{
-	ubf_assert_non_NULL	(put);
-	if (ccData)
-		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
-	else
-		ubf_assert (cunilogEvtTypeCommand == type && NULL == ccData);
-	ubf_assert			(USE_STRLEN != siz);
-	ubf_assert			(0 <= type);
-	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
+	// Our wrapper.
+	static void MoveFileToRecycleBinMac (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
 
-	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
-	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
-	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
-	size_t			ln		= aln + wl + lenCapt + siz;
-	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+		const char *szFile = fileToRotate (put, pj);
 
-	if (pev)
-	{
-		unsigned char *pData = (unsigned char *) pev + aln;
-		
-		FillCUNILOG_EVENT	(
-			pev, put,
-			CUNILOGEVENT_ALLOCATED,
-			ts,
-			sev, type,
-			pData, siz, ln
-							);
-		if (wl)
+		logRotationTextU8fmt (put, pj, "Moving obsolete logfile \"%s\" to recycle bin...\n", szFile);
+		if (LIBTRASHCAN_SUCCESS == trashcan_soft_delete_apple (szFile))
 		{
-			storeCaptionLength (&pData, wl, lenCapt);
-			memcpy (pData, ccCapt, lenCapt);
-			pData += lenCapt;
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" moved to recycle bin.\n", szFile);
+			removeRotatedFromFLS (put, pj);
+		} else
+		{
+			logRotationTextU8fmt (put, pj, "Error while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szFile);
+			keepRotatedInFLS (pj);
 		}
-		if (ccData)
-			memcpy (pData, ccData, siz);
-		else
-			ubf_assert (cunilogEvtTypeCommand == type);
 	}
-	return pev;
-}
 
-static inline cueventtype cunilogEventTypeFromLength (size_t len)
-{
-	ubf_assert (USE_STRLEN != len);
+#elif defined (OS_IS_LINUX)
 
-	if (len < UINT8_MAX)
-		return cunilogEvtTypeHexDumpWithCaption8;
-	if (len < UINT16_MAX)
-		return cunilogEvtTypeHexDumpWithCaption16;
-	if (len < UINT32_MAX)
-		return cunilogEvtTypeHexDumpWithCaption32;
-	ubf_assert_msg (false, "Really??? A caption length of more than 4 GiB??");
-	return cunilogEvtTypeHexDumpWithCaption64;
-}
+	static void MoveFileToRecycleBinLnx (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
 
-CUNILOG_EVENT *CreateCUNILOG_EVENT_Data		(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccData,
-					size_t						siz,
-					const char					*ccCapt,
-					size_t						lenCapt
-											)
-{
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(ccData);
-	ubf_assert (USE_STRLEN != siz);
+		const char *szFile = fileToRotate (put, pj);
 
-	if (ccCapt)
-		lenCapt = USE_STRLEN == lenCapt ? strlen (ccCapt) : lenCapt;
-	else
-		lenCapt = 0;
+		logRotationTextU8fmt (put, pj, "Moving obsolete logfile \"%s\" to recycle bin...\n", szFile);
+		bool b = MoveFileToTrashPOSIX (szFile);
+		if (b)
+		{
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" moved to recycle bin.\n", szFile);
+			removeRotatedFromFLS (put, pj);
+		} else
+		{
+			char szErr [CUNILOG_STD_MSG_SIZE];
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt (put, pj, "Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szErr, szFile);
+			keepRotatedInFLS (pj);
+		}
+	}
 
-	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
-							put, sev, ccCapt, lenCapt,
-							cunilogEventTypeFromLength (lenCapt),
-							ccData, siz
-													);
-	return pev;
-}
+#else
 
-CUNILOG_EVENT *CreateCUNILOG_EVENT_Text		(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccText,
-					size_t						len
-											)
+	#error To do!!!
+
+#endif
+
+/*
+	Platform-independent wrapper function.
+*/
+static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 {
 	ubf_assert_non_NULL (put);
-	ubf_assert_non_NULL (ccText);
 
-	len = USE_STRLEN == len ? strlen (ccText) : len;
+	#if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
+		MoveFileToRecycleBinWin (put, pj);
+	#elif defined (OS_IS_MACOS)
+		MoveFileToRecycleBinMac (put, pj);
+	#elif defined (OS_IS_LINUX)
+		MoveFileToRecycleBinLnx (put, pj);
+	#else
+		#error Not implemented yet!
+	#endif
+}
 
-	/*
-	while (len && ('\n' == ccText [len - 1] || '\r' == ccText [len - 1]))
-		-- len;
-	*/
-	len = strRemoveLineEndingsFromEnd (ccText, len);
+#ifdef PLATFORM_IS_WINDOWS
+	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
 
-	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
-							put, sev, NULL, 0, cunilogEvtTypeNormalText,
-							ccText, len
-													);
-	return pev;
-}
+		const char *szFile = fileToRotate (put, pj);
+	
+		logRotationTextU8fmt (put, pj, "Deleting obsolete logfile \"%s\"...\n", szFile);
+		bool b = DeleteFileU8 (szFile);
+		if (b)
+		{
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" deleted.\n", szFile);
+			removeRotatedFromFLS (put, pj);
+		} else
+		{
+			char szErr [CUNILOG_STD_MSG_SIZE];
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt (put, pj, "Error %s while attempting to delete obsolete logfile \"%s\".\n", szErr, szFile);
+			keepRotatedInFLS (pj);
+		}
+	}
+#endif
+
+#ifdef PLATFORM_IS_POSIX
+	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+		const char *szFile = fileToRotate (put, pj);
+	
+		logRotationTextU8fmt (put, pj, "Deleting obsolete logfile \"%s\"...\n", szFile);
+		int i = unlink (szFile);
+		if (0 == i)
+		{
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" deleted.\n", szFile);
+			removeRotatedFromFLS (put, pj);
+		} else
+		{
+			logRotationTextU8fmt (put, pj, "Error %d while attempting to delete obsolete logfile \"%s\".\n", errno, szFile);
+			keepRotatedInFLS (pj);
+		}
+	}
+#endif
 
-CUNILOG_EVENT *CreateCUNILOG_EVENT_TextTS		(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccText,
-					size_t						len,
-					UBF_TIMESTAMP				ts
-											)
+/*
+	Returns the length of the extension of an external compressor the file name szName
+	with length ln ends with, for instance 3 for ".gz", or 0 if it doesn't end with one.
+*/
+static size_t lenExtCompressorExtensionOfName (const char *szName, size_t ln)
 {
-	ubf_assert_non_NULL (put);
-	ubf_assert_non_NULL (ccText);
-
-	len = USE_STRLEN == len ? strlen (ccText) : len;
+	ubf_assert_non_NULL (szName);
 
-	/*
-	while (len && ('\n' == ccText [len - 1] || '\r' == ccText [len - 1]))
-		-- len;
-	*/
-	len = strRemoveLineEndingsFromEnd (ccText, len);
+	int		i;
+	size_t	lnExt;
 
-	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandDataTS	(
-							put, sev, NULL, 0, cunilogEvtTypeNormalText,
-							ccText, len, ts
-														);
-	return pev;
+	for (i = 0; i < extcompressor_XAmountEnumValues; ++ i)
+	{
+		const char *ccExt = ExtCompressorFileExtension ((enextcompressor) i, &lnExt);
+		if (lnExt < ln && !memcmp (szName + ln - lnExt, ccExt, lnExt))
+			return lnExt;
+	}
+	return 0;
 }
 
-CUNILOG_EVENT *CreateSUNILOGEVENT_W	(
-					cueventseverity		sev,
-					size_t				lenDataW
-									)
+static inline bool isActiveLogfileToRotate (CUNILOG_TARGET *put)
 {
-	UNREFERENCED_PARAMETER (sev);
-	UNREFERENCED_PARAMETER (lenDataW);
+	ubf_assert_non_NULL (put);
 
-	//return CreateSUNILOGSTRUCT_U8 (evType, lenDataW * sizeof (wchar_t));
-	ubf_assert (false);
-	return NULL;
+	return		isUsableSMEMBUF (&put->mbLogfileName)
+			&&	!strcmp (put->mbFilToRotate.buf.pcc, put->mbLogfileName.buf.pcc);
 }
 
-CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (pev);
-
-	size_t size;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static size_t	stCompressionPrio			= CUNILOG_DEFAULT_COMPRESSION_PRIORITY;
+	static size_t	stMaxParallelCompressions	= CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS;
+	static size_t	stParallelCompressions;
 
-	if (pev->sizEvent)
-		size = pev->sizEvent;
-	else
-		size = sizeof (CUNILOG_EVENT);
-	CUNILOG_EVENT *pnev = ubf_malloc (size);
-	if (pnev)
+	bool cunilogSetCompressionLimits (cunilogprio prio, unsigned int nMaxParallel)
 	{
-		memcpy (pnev, pev, size);
-		cunilogSetEventAllocated (pnev);
+		ubf_assert	(0 <= prio);
+		ubf_assert	(prio < cunilogPrioAmountEnumValues);
+
+		if (0 <= prio && prio < cunilogPrioAmountEnumValues)
+		{
+			cunilogAtomicXchgSize (&stCompressionPrio, (size_t) prio);
+			cunilogAtomicXchgSize (&stMaxParallelCompressions, nMaxParallel);
+			return true;
+		}
+		return false;
 	}
-	return pnev;
-}
 
-CUNILOG_EVENT *DoneCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
-{
-	if (NULL == put || put == pev->pCUNILOG_TARGET)
+	/*
+		Called by the maintenance thread before it compresses a logfile. Waits until
+		less than stMaxParallelCompressions logfiles are compressed within the process.
+	*/
+	static void enterCompressionSlot (CUNILOG_MAINTENANCE *pmt)
 	{
-		if (pev->szDataToLog && cunilogIsEventDataAllocated (pev))
+		ubf_assert_non_NULL (pmt);
+
+		cunilogprio prio = (cunilogprio) cunilogAtomicLoadSize (&stCompressionPrio);
+		if ((int) prio != pmt->iPrio)
 		{
-			ubf_free (pev->szDataToLog);
+			CunilogChangeCurrentThreadPriority (prio);
+			pmt->iPrio = prio;
 		}
-		if (cunilogIsEventAllocated (pev))
+
+		size_t n;
+		for (;;)
 		{
-			ubf_free (pev);
+			n = cunilogAtomicLoadSize (&stMaxParallelCompressions);
+			if (cunilogAtomicAddSize (&stParallelCompressions, 1) < n || 0 == n)
+				return;
+			cunilogAtomicSubSize (&stParallelCompressions, 1);
+			Sleep_ms (10);
 		}
 	}
-	return NULL;
-}
 
-#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put);
+	static inline void leaveCompressionSlot (void)
+	{
+		cunilogAtomicSubSize (&stParallelCompressions, 1);
+	}
 #endif
 
-#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
-	void cunilogSetTargetErrorAndInvokeErrorCallback	(
-			CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
-														)
+/*
+	Compresses the logfile to rotate into a new file with the extension of the compressor
+	appended and deletes it afterwards.
+*/
+static void cunilogExtCompressLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+	const char		*szFile	= fileToRotate (put, pj);
+	enextcompressor	cmp		= rotatorCompressor (rotatorFlags (put, pj));
+	size_t			lnFile	= strlen (szFile);
+	size_t			lnExt;
+	const char		*ccExt	= ExtCompressorFileExtension (cmp, &lnExt);
+	char			szErr [CUNILOG_STD_MSG_SIZE];
+	bool			b;
+
+	char *szDst = ubf_malloc (lnFile + lnExt + 1);
+	if (NULL == szDst)
 	{
-		ubf_assert_non_NULL (cup);
-		ubf_assert_non_NULL (pev);
-		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+		if (NULL == pj)
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+		keepRotatedInFLS (pj);
+		return;
+	}
+	memcpy (szDst, szFile, lnFile);
+	memcpy (szDst + lnFile, ccExt, lnExt + 1);
 
+	logRotationTextU8fmt (put, pj, "Compressing logfile \"%s\" into \"%s\"...", szFile, szDst);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			enterCompressionSlot (put->pmt);
+	#endif
+	b = ExtCompressFileByName (szFile, szDst, cmp, EXT_COMPRESSOR_DEFAULT_LEVEL);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			leaveCompressionSlot ();
+	#endif
+	if (b)
+	{
 		#ifdef PLATFORM_IS_WINDOWS
-			DWORD syserror = GetLastError ();
+			b = DeleteFileU8 (szFile);
 		#else
-			int32_t syserror = errno;
+			b = 0 == unlink (szFile);
 		#endif
-		SetCunilogError (pev->pCUNILOG_TARGET, cunilog_error, syserror);
-
-		if (pev->pCUNILOG_TARGET->errorCB)
+		if (b)
 		{
-			errCBretval rv = pev->pCUNILOG_TARGET->errorCB (pev->pCUNILOG_TARGET->error, cup, pev);
-			ubf_assert (0 <= rv);
-			ubf_assert (cunilogErrCB_AmountEnumValues > rv);
-
-			CUNILOG_EVENT *pve;
-			CUNILOG_EVENT *nxt;
-
-			switch (rv)
-			{
-				case cunilogErrCB_ignore:
-					break;
-				case cunilogErrCB_next_processor:
-					break;
-				case cunilogErrCB_next_event:
-					cunilogEventSetIgnoreRemainingProcessors (pev);
-					break;
-				case cunilogErrCB_shutdown:
-					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-					break;
-				case cunilogErrCB_cancel:
-					cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-					#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-						pve = DequeueAllCUNILOG_EVENTs (pev->pCUNILOG_TARGET);
-						while (pve)
-						{
-							nxt = pve->next;
-							DoneCUNILOG_EVENT (NULL, pve);
-							pve = nxt;
-						}
-					#endif
-					break;
-				default:
-					ubf_assert (false);
-					break;
-			}
+			logRotationTextU8fmt (put, pj, "Logfile \"%s\" compressed into \"%s\".", szFile, szDst);
+			// The entry of a job has been updated when the job was queued.
+			if (NULL == pj)
+				extCompressedInFLS (put, put->prargs->idx, cmp);
+		} else
+		{
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt	(
+				put, pj,
+				"Error %s while attempting to delete logfile \"%s\" after compressing it.",
+				szErr, szFile
+									);
+			keepRotatedInFLS (pj);
 		}
+	} else
+	{
+		GetTextForLastError (szErr);
+		logRotationTextU8fmt	(
+			put, pj,
+			"Error %s while attempting to compress logfile \"%s\" into \"%s\".",
+			szErr, szFile, szDst
+								);
+		keepRotatedInFLS (pj);
 	}
+	ubf_free (szDst);
+}
 
-	/*
-		cunilogTestErrorCB
-	*/
-	#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
-		void cunilogTestErrorCB	(
-				CUNILOG_ERROR cunilog_error, CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
-								)
-		{
-			ubf_assert_non_NULL (cup);
-			ubf_assert_non_NULL (pev);
-			ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+#ifdef CUNILOG_BUILD_DEBUG_OUTPUT_FILES_LIST
+	static void DebugOutputFilesList (const char *szText, vec_cunilog_fls *pvec)
+	{
+		ubf_assert_non_NULL (pvec);
 
-			if (cunilogTargetHasAlwaysCallErrorCB (pev->pCUNILOG_TARGET))
-			{
-				errCBretval rv = pev->pCUNILOG_TARGET->errorCB	(
-										cunilog_error, cup, pev
-																);
-				UNUSED (rv);
-				ubf_assert (0 <= rv);
-				ubf_assert (cunilogErrCB_AmountEnumValues > rv);
-			}
+		// Output from index 0 up to length. This is different from how the files
+		//	might be processed by a rotator.
+		size_t iFiles = 0;
+		if (szText)
+			printf ("\nDebugOutputFilesList (%s): %zu file(s)\n", szText, pvec->length);
+		else
+			printf ("\nDebugOutputFilesList: %zu file(s)\n", pvec->length);
+		while (iFiles < pvec->length)
+		{
+			puts (pvec->data [iFiles].chFilename);
+			++ iFiles;
 		}
-	#else
-		#define cunilogTestErrorCB(error, cup, pev)
-	#endif
+		puts ("");
+	}
 #else
-	#define cunilogInvokeErrorCallback(error, cup, pev)
-	#define cunilogTestErrorCB(error, cup, pev)
+	#define DebugOutputFilesList(text, pvec)
 #endif
 
 /*
-	The dummy/no-operation processor.
+	The maintenance thread.
 */
-static bool cunilogProcessNoneFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	UNREFERENCED_PARAMETER (cup);
-	UNREFERENCED_PARAMETER (pev);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the task of the current rotator over to the maintenance thread of the target
+		put points to. The function returns false if the target doesn't have a maintenance
+		thread or the job couldn't be created, in which case the rotator carries out the
+		task itself.
+
+		A logfile that is moved to the recycle bin or deleted is removed from the files
+		list straight away. A logfile that is compressed by a rotator with the task
+		cunilogrotationtask_ExtCompressLogfiles gets the name of its compressed file in the
+		list straight away. If the maintenance thread fails to remove or compress it later,
+		it asks for the files list to be rebuilt. See updateFLSindex ().
+	*/
+	static bool queueCUNILOG_MAINTJOB (CUNILOG_TARGET *put, CUNILOG_ROTATOR_ARGS *prg)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (prg);
 
-	return true;
-}
+		CUNILOG_ROTATION_DATA	*prd	= prg->cup->pData;
+		ubf_assert_non_NULL (prd);
 
-#ifdef PLATFORM_IS_WINDOWS
-	static inline int cunilogPutsWin (const char *szOutput, size_t len)
-	{
-		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
-			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
-		CunilogEnableANSIifNotInitialised ();
+		// Compressing a logfile takes too long for the thread that processes the events.
+		if (NULL == put->pmt && cunilogrotationtask_ExtCompressLogfiles == prd->tsk)
+			ConfigCUNILOG_TARGETmaintenanceThread (put);
 
-		if (len)
-		{	// This function expects a NUL-terminated string.
-			ubf_assert (strlen (szOutput) == len);
-			ubf_assert (ASCII_NUL == szOutput [len]);
+		CUNILOG_MAINTENANCE		*pmt	= put->pmt;
+		if (NULL == pmt || !isUsableSMEMBUF (&put->mbFilToRotate))
+			return false;
+		const char				*szFile	= put->mbFilToRotate.buf.pcc;
+		size_t					stFile	= put->stFilToRotate;
+		CUNILOG_MAINTJOB		*pj;
+		bool					bQueued	= false;
 
-			switch (ourCunilogConsoleOutputCodePage)
-			{
-				case cunilogConsoleIsUTF8:		return puts					(szOutput);
-				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	(szOutput);
-				case cunilogConsoleIsNeither:	return puts					(szOutput);
-				default:						return puts					(szOutput);
-			}
-		} else
+		EnterLocker (&pmt->cl);
+		// A logfile that is still waiting for the same task isn't queued again. This can
+		//	happen if the folder is read again before the maintenance thread got to it.
+		for (pj = pmt->firstJob; pj; pj = pj->next)
 		{
-			switch (ourCunilogConsoleOutputCodePage)
+			if (prd->tsk == pj->tsk && stFile == pj->stFile && !memcmp (szFile, pj->szFile, stFile))
+				break;
+		}
+		if (NULL == pj)
+		{
+			pj = ubf_malloc (sizeof (CUNILOG_MAINTJOB) + stFile);
+			if (NULL == pj)
 			{
-				case cunilogConsoleIsUTF8:		return puts					("");
-				case cunilogConsoleIsUTF16:		return putsU8toU16stdout	("");
-				case cunilogConsoleIsNeither:	return puts					("");
-				default:						return puts					("");
+				LeaveLocker (&pmt->cl);
+				return false;
 			}
+			pj->next				= NULL;
+			pj->tsk					= prd->tsk;
+			pj->plogCUNILOG_TARGET	= prd->plogCUNILOG_TARGET;
+			pj->uiFlgs				= prd->uiFlgs;
+			pj->szFile				= (char *) (pj + 1);
+			memcpy (pj->szFile, szFile, stFile);
+			pj->stFile				= stFile;
+			pj->bFailed				= false;
+			if (pmt->lastJob)
+				pmt->lastJob->next = pj;
+			else
+				pmt->firstJob = pj;
+			pmt->lastJob = pj;
+			bQueued = true;
+		}
+		LeaveLocker (&pmt->cl);
+
+		if (bQueued)
+		{
+			#ifdef OS_IS_WINDOWS
+				bool b = ReleaseSemaphore (pmt->sm.hSemaphore, 1, NULL);
+				ubf_assert_true (b);
+				UNUSED (b);
+			#else
+				int i = sem_post (&pmt->sm.tSemaphore);
+				ubf_assert_0 (i);
+				UNUSED (i);
+			#endif
+		}
+		if (cunilogrotationtask_ExtCompressLogfiles == prd->tsk)
+			extCompressedInFLS (put, prg->idx, rotatorCompressor (prd->uiFlgs));
+		else
+		if (cunilogrotationtask_FScompressLogfiles != prd->tsk)
+			removeFromFLS (put, prg->idx);
+		return true;
+	}
+#else
+	#define queueCUNILOG_MAINTJOB(put, prg)	\
+		(false)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void runCUNILOG_MAINTJOB (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pj);
+
+		switch (pj->tsk)
+		{
+			case cunilogrotationtask_FScompressLogfiles:
+				cunilogFileSystemCompressLogfile (put, pj);
+				break;
+			case cunilogrotationtask_MoveToRecycleBinLogfiles:
+				cunilogMoveFileToRecycleBin (put, pj);
+				break;
+			case cunilogrotationtask_DeleteLogfiles:
+				cunilogDeleteObsoleteLogfile (put, pj);
+				break;
+			case cunilogrotationtask_ExtCompressLogfiles:
+				cunilogExtCompressLogfile (put, pj);
+				break;
+			default:
+				ubf_assert_msg (false, "Internal error");
+				break;
 		}
 	}
 #endif
 
-#ifdef PLATFORM_IS_WINDOWS
-	static inline int cunilogPrintWin (const char *szOutput, size_t len)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	SEPARATE_LOGGING_THREAD_RETURN_TYPE MaintenanceThread (CUNILOG_TARGET *put)
 	{
-		if (cunilogConsoleIsUninitialised == ourCunilogConsoleOutputCodePage)
-			CunilogSetConsoleTo (cunilogConsoleIsUTF8);
-		CunilogEnableANSIifNotInitialised ();
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (put->pmt);
 
-		if (len)
-		{	// This function expects a NUL-terminated string.
-			ubf_assert (strlen (szOutput) == len);
-			ubf_assert (ASCII_NUL == szOutput [len]);
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTJOB	*pj;
+		bool				bStop;
 
-			switch (ourCunilogConsoleOutputCodePage)
+		// The semaphore is posted once for each job and once to stop. Since jobs are
+		//	only removed when they're done, all of them are done before we leave.
+		for (;;)
+		{
+			#ifdef OS_IS_WINDOWS
+				DWORD dw = WaitForSingleObject (pmt->sm.hSemaphore, INFINITE);
+				ubf_assert (WAIT_OBJECT_0 == dw);
+				UNUSED (dw);
+			#else
+				int i = sem_wait (&pmt->sm.tSemaphore);
+				if (0 != i)
+					continue;
+			#endif
+			EnterLocker (&pmt->cl);
+			pj		= pmt->firstJob;
+			bStop	= pmt->bStop;
+			LeaveLocker (&pmt->cl);
+			if (NULL == pj)
 			{
-				case cunilogConsoleIsUTF8:		return printf				(szOutput);
-				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, szOutput);
-				case cunilogConsoleIsNeither:	return printf				(szOutput);
-				default:						return printf				(szOutput);
+				if (bStop)
+					break;
+				continue;
 			}
-		} else
-		{
-			switch (ourCunilogConsoleOutputCodePage)
+			runCUNILOG_MAINTJOB (put, pj);
+			EnterLocker (&pmt->cl);
+			++ pmt->nJobsDone;
+			pmt->firstJob = pj->next;
+			if (NULL == pmt->firstJob)
 			{
-				case cunilogConsoleIsUTF8:		return printf				("");
-				case cunilogConsoleIsUTF16:		return fprintfU8toU16stream	(stdout, "");
-				case cunilogConsoleIsNeither:	return printf				("");
-				default:						return printf				("");
+				pmt->lastJob = NULL;
+				if (pmt->bIdleWait)
+				{
+					pmt->bIdleWait = false;
+					#ifdef OS_IS_WINDOWS
+						ReleaseSemaphore (pmt->smIdle.hSemaphore, 1, NULL);
+					#else
+						sem_post (&pmt->smIdle.tSemaphore);
+					#endif
+				}
 			}
+			LeaveLocker (&pmt->cl);
+			if (pj->bFailed)
+				cunilogAtomicAddSize (&pmt->nResync, 1);
+			ubf_free (pj);
 		}
+		return SEPARATE_LOGGING_THREAD_RETURN_SUCCESS;
 	}
 #endif
 
-#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-	static inline void cunilogFillColouredEchoEvtLine	(
-							char				**pszToOutput,
-							size_t				*plnToOutput,
-							CUNILOG_EVENT		*pev
-														)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Logs the messages the maintenance thread has created so far. Called by the
+		thread that processes the events of the target put points to.
+	*/
+	static void cunilogLogMaintenanceMessages (CUNILOG_TARGET *put)
 	{
-		ubf_assert_non_NULL (pszToOutput);
-		ubf_assert_non_NULL (plnToOutput);
-		ubf_assert_non_NULL (pev);
-		// Includes LEN_ANSI_RESET too.
-		size_t	lnThisColour	= evtSeverityColoursLen (pev->evSeverity);
+		ubf_assert_non_NULL (put);
 
-		if	(
-					cunilogTargetHasUseColourForEcho (pev->pCUNILOG_TARGET)
-				&&	lnThisColour
-			)
-		{
-			size_t	lnEvtLine		= pev->pCUNILOG_TARGET->lnLogEventLine;
-			size_t	lnColEcho		= lnThisColour
-									+ lnEvtLine
-									;
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTMSG	*pm;
+		CUNILOG_MAINTMSG	*pnx;
 
-			growToSizeSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine, lnColEcho + 1);
-			if (isUsableSMEMBUF (&pev->pCUNILOG_TARGET->mbColEventLine))
+		if (NULL == pmt || 0 == cunilogAtomicLoadSize (&pmt->nMsgs))
+			return;
+		EnterLocker (&pmt->cl);
+		pm				= pmt->firstMsg;
+		pmt->firstMsg	= NULL;
+		pmt->lastMsg	= NULL;
+		cunilogAtomicXchgSize (&pmt->nMsgs, 0);
+		LeaveLocker (&pmt->cl);
+
+		while (pm)
+		{
+			pnx = pm->next;
+			if (pm->plogCUNILOG_TARGET)
 			{
-				ubf_assert	(
-									strlen (pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch)
-								==	pev->pCUNILOG_TARGET->lnLogEventLine
-							);
-				char *sz = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
-				cpyEvtSeverityColour (&sz, pev->evSeverity);
-				memcpy (sz, pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch, lnEvtLine);
-				sz += lnEvtLine;
-				cpyRstEvtSeverityColour (&sz, pev->evSeverity);
-				*sz = ASCII_NUL;
-				pev->pCUNILOG_TARGET->lnColEventLine = lnColEcho;
-				*pszToOutput = pev->pCUNILOG_TARGET->mbColEventLine.buf.pch;
-				*plnToOutput = lnColEcho;
-				return;
+				logTextU8sevl	(
+					pm->plogCUNILOG_TARGET, cunilogEvtSeverityNone,
+					pm->szMsg, pm->lnMsg
+								);
+			} else
+			{	// Like logFromInsideRotatorTextU8fmt () but we're the thread that
+				//	processes the events already.
+				CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text	(
+										put, cunilogEvtSeverityNone,
+										pm->szMsg, pm->lnMsg
+															);
+				if (pev)
+				{
+					cunilogSetEventInternal		(pev);
+					cunilogSetEventNoRotation	(pev);
+					IncrementPendingNoRotationEvents (put);
+					cunilogProcessEventSingleThreaded (pev);
+					DoneCUNILOG_EVENT (put, pev);
+				}
 			}
+			ubf_free (pm);
+			pm = pnx;
 		}
-		*pszToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
-		*plnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
 	}
+#else
+	#define cunilogLogMaintenanceMessages(put)
 #endif
 
-static bool cunilogProcessEchoFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	UNREFERENCED_PARAMETER (cup);
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Waits until the maintenance thread of the target put points to has done all its
+		jobs and logs their messages. Renaming dot number logfiles changes the names of
+		all logfiles, including the ones jobs might still refer to.
+	*/
+	static void WaitForMaintenanceJobs (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-	if (cunilogIsNoEcho (pev->pCUNILOG_TARGET) || cunilogHasEventNoEcho (pev))
-		return true;
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		bool				bWait;
 
-	// The actual task of this processor: Echo the event line.
-	//	Note that we can rely on the following conditions here:
-	//		- The line to output is NUL-terminated.
-	//		- It only consists of printable characters.
-	//		- The length of the event line has been stored correctly.
-	//		- If we require a lock, we have it already.
+		if (NULL == pmt)
+			return;
+		EnterLocker (&pmt->cl);
+		bWait = NULL != pmt->firstJob;
+		if (bWait)
+			pmt->bIdleWait = true;
+		LeaveLocker (&pmt->cl);
+		if (bWait)
+		{
+			#ifdef OS_IS_WINDOWS
+				DWORD dw = WaitForSingleObject (pmt->smIdle.hSemaphore, INFINITE);
+				ubf_assert (WAIT_OBJECT_0 == dw);
+				UNUSED (dw);
+			#else
+				while (0 != sem_wait (&pmt->smIdle.tSemaphore) && EINTR == errno)
+					;
+			#endif
+		}
+		cunilogLogMaintenanceMessages (put);
+	}
+#else
+	#define WaitForMaintenanceJobs(put)
+#endif
 
-	int		ips;
-	char	*szToOutput;
-	size_t	lnToOutput;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void JoinMaintenanceThread (CUNILOG_MAINTENANCE *pmt)
+	{
+		ubf_assert_non_NULL (pmt);
 
-	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
-		cunilogFillColouredEchoEvtLine (&szToOutput, &lnToOutput, pev);
-	#else
-		szToOutput = pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
-		lnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
-	#endif
+		if (pmt->bStopped)
+			return;
+		EnterLocker (&pmt->cl);
+		pmt->bStop = true;
+		LeaveLocker (&pmt->cl);
+		#ifdef OS_IS_WINDOWS
+			bool b = ReleaseSemaphore (pmt->sm.hSemaphore, 1, NULL);
+			ubf_assert_true (b);
+			UNUSED (b);
+			DWORD dw = WaitForSingleObject (pmt->th.hThread, INFINITE);
+			ubf_assert (WAIT_OBJECT_0 == dw);
+			UNUSED (dw);
+			CloseHandle (pmt->th.hThread);
+		#else
+			int i = sem_post (&pmt->sm.tSemaphore);
+			ubf_assert_0 (i);
+			void *threadRetValue;
+			i = pthread_join (pmt->th.tThread, &threadRetValue);
+			ubf_assert_0 (i);
+			UNUSED (threadRetValue);
+			UNUSED (i);
+		#endif
+		pmt->bStopped = true;
+	}
+#endif
 
-	#ifdef PLATFORM_IS_WINDOWS
-		ips = cunilogPutsWin (szToOutput, lnToOutput);
-	#else
-		if (lnToOutput)
-			ips = puts (szToOutput);
-		else
-			ips = puts ("");
-	#endif
-	if (EOF == ips)
-	{	// "Bad file descriptor" might not be the best error here but what's better?
-		ubf_assert_msg (false, "Error writing to stdout.");
-		cunilogSetTargetErrorAndInvokeErrorCallback (EBADF, cup, pev);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Waits for the maintenance thread to finish its jobs and logs their remaining
+		messages. Called by the thread that processes the events of the target when the
+		target is shut down.
+	*/
+	static void StopMaintenanceThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->pmt)
+		{
+			JoinMaintenanceThread (put->pmt);
+			cunilogLogMaintenanceMessages (put);
+		}
 	}
-	return true;
-}
+#else
+	#define StopMaintenanceThread(put)
+#endif
 
-static bool cunilogProcessUpdateLogFileNameFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	UNREFERENCED_PARAMETER (cup);
-	ubf_assert_non_NULL (pev);
-	
-	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DestroyCUNILOG_MAINTENANCE (CUNILOG_MAINTENANCE *pmt)
+	{
+		ubf_assert_non_NULL (pmt);
 
-	#ifdef DEBUG
-		char *sz = put->mbLogfileName.buf.pch;
-		UNREFERENCED_PARAMETER (sz);
-	#endif
+		#ifdef OS_IS_WINDOWS
+			CloseHandle (pmt->sm.hSemaphore);
+			CloseHandle (pmt->smIdle.hSemaphore);
+		#else
+			sem_destroy (&pmt->sm.tSemaphore);
+			sem_destroy (&pmt->smIdle.tSemaphore);
+		#endif
+		DoneLocker (&pmt->cl);
+		ubf_free (pmt);
+	}
+#endif
 
-	switch (put->culogPostfix)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when the target is destroyed. Messages that haven't been logged because
+		the target hasn't been shut down are discarded.
+	*/
+	static void DoneCUNILOG_TARGETmaintenance (CUNILOG_TARGET *put)
 	{
-		case cunilogPostfixNone:
-			return true;
+		ubf_assert_non_NULL (put);
 
-		case cunilogPostfixMinute:
-		case cunilogPostfixMinuteT:
-		case cunilogPostfixHour:
-		case cunilogPostfixHourT:
-		case cunilogPostfixDay:
-		case cunilogPostfixWeek:
-		case cunilogPostfixMonth:
-		case cunilogPostfixYear:
-			savePrevTimestamp (pev);
-			return true;
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTMSG	*pm;
+		CUNILOG_MAINTMSG	*pnx;
 
-		case cunilogPostfixLogMinute:
-		case cunilogPostfixLogMinuteT:
-		case cunilogPostfixLogHour:
-		case cunilogPostfixLogHourT:
-		case cunilogPostfixLogDay:
-		case cunilogPostfixLogWeek:
-		case cunilogPostfixLogMonth:
-		case cunilogPostfixLogYear:
-			return true;
+		if (pmt)
+		{
+			JoinMaintenanceThread (pmt);
+			pm = pmt->firstMsg;
+			while (pm)
+			{
+				pnx = pm->next;
+				ubf_free (pm);
+				pm = pnx;
+			}
+			DestroyCUNILOG_MAINTENANCE (pmt);
+			put->pmt = NULL;
+		}
+	}
+#endif
 
-		case cunilogPostfixDotNumberMinutely:
-		case cunilogPostfixDotNumberHourly:
-		case cunilogPostfixDotNumberDaily:
-		case cunilogPostfixDotNumberWeekly:
-		case cunilogPostfixDotNumberMonthly:
-		case cunilogPostfixDotNumberYearly:
-			return true;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETmaintenanceThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->pmt);
 
-		default:
-			ubf_assert_msg (false, "Bug!");
+		if (put->pmt)
 			return true;
-	}
-}
 
-/*
-	Closes the previous file and opens the new one.
-*/
-static inline bool cunilogOpenNewLogFile (CUNILOG_TARGET *put)
-{
-	ubf_assert_non_NULL	(put);
-	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
+		CUNILOG_MAINTENANCE *pmt = ubf_malloc (sizeof (CUNILOG_MAINTENANCE));
+		if (NULL == pmt)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		pmt->firstJob	= NULL;
+		pmt->lastJob	= NULL;
+		pmt->firstMsg	= NULL;
+		pmt->lastMsg	= NULL;
+		pmt->nMsgs		= 0;
+		pmt->nJobsDone	= 0;
+		pmt->nResync	= 0;
+		pmt->iPrio		= cunilogPrioNormal;
+		pmt->bIdleWait	= false;
+		pmt->bStop		= false;
+		pmt->bStopped	= false;
+		#ifdef OS_IS_WINDOWS
+			pmt->sm.hSemaphore		= CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
+			pmt->smIdle.hSemaphore	= CreateSemaphoreW (NULL, 0, 1, NULL);
+			if (NULL == pmt->sm.hSemaphore || NULL == pmt->smIdle.hSemaphore)
+			{
+				if (pmt->sm.hSemaphore)
+					CloseHandle (pmt->sm.hSemaphore);
+				if (pmt->smIdle.hSemaphore)
+					CloseHandle (pmt->smIdle.hSemaphore);
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+		#else
+			if (0 != sem_init (&pmt->sm.tSemaphore, 0, 0))
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+			if (0 != sem_init (&pmt->smIdle.tSemaphore, 0, 0))
+			{
+				sem_destroy (&pmt->sm.tSemaphore);
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+		#endif
+		InitLocker (&pmt->cl);
 
-	#ifdef OS_IS_WINDOWS
-		CloseHandle (put->logfile.hLogFile);
-		return cunilogOpenLogFile (put);
-	#else
-		fclose (put->logfile.fLogFile);
-		return cunilogOpenLogFile (put);
-	#endif
-}
+		// The thread expects its structure in the target.
+		put->pmt = pmt;
+		#ifdef OS_IS_WINDOWS
+			pmt->th.hThread = CreateThread (NULL, 0, MaintenanceThread, put, 0, NULL);
+			if (NULL == pmt->th.hThread)
+		#else
+			if (0 != pthread_create (&pmt->th.tThread, NULL, (void * (*)(void *)) MaintenanceThread, put))
+		#endif
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_MAINTENANCE_THREAD);
+			put->pmt = NULL;
+			DestroyCUNILOG_MAINTENANCE (pmt);
+			return false;
+		}
+		return true;
+	}
+#endif
 
-static inline bool requiresOpenLogFile (CUNILOG_TARGET *put)
+static inline void performActualRotation (CUNILOG_ROTATOR_ARGS *prg)
 {
+	ubf_assert_non_NULL (prg);
+
+	CUNILOG_PROCESSOR		*cup = prg->cup;
+	ubf_assert_non_NULL (cup);
+	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+	ubf_assert_non_NULL (prd);
+	CUNILOG_EVENT			*pev = prg->pev;
+	ubf_assert_non_NULL	(pev);
+	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
 	ubf_assert_non_NULL (put);
 
-#ifdef OS_IS_WINDOWS
-		return NULL == put->logfile.hLogFile || INVALID_HANDLE_VALUE == put->logfile.hLogFile;
-	#else
-		return NULL == put->logfile.fLogFile;
-	#endif
-}
+	// Now the target knows exactly which rotator it is working on.
+	put->prargs = prg;
 
-#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
-#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
-	static inline bool requiresNewLogFileCunilogTest	(
-							CUNILOG_TARGET		*put,
-							CUNILOG_PROCESSOR	*cup,
-							CUNILOG_EVENT		*pev
-														)
+	switch (prd->tsk)
 	{
-		ubf_assert_non_NULL (put);
-
-		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_REQUIRES_NEW_LOGFILE, cup, pev);
-		int r = requiresNewLogFile (put);
-		cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_REQUIRES_NEW_LOGFILE, cup, pev);
-
-		return r > 0;
+		case cunilogrotationtask_None:
+			// This is a bug. We're normally not called in this case. See function
+			//	cunilogProcessRotateLogfiles ().
+			ubf_assert (false);
+			break;
+		case cunilogrotationtask_RenameLogfiles:
+			// Renaming includes the active logfile. It's never handed over.
+			cunilogRenameLogfile (put);
+			break;
+		case cunilogrotationtask_FScompressLogfiles:
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogFileSystemCompressLogfile (put, NULL);
+			break;
+		case cunilogrotationtask_MoveToRecycleBinLogfiles:
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogMoveFileToRecycleBin (put, NULL);
+			break;
+		case cunilogrotationtask_DeleteLogfiles:
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogDeleteObsoleteLogfile (put, NULL);
+			break;
+		case cunilogrotationtask_ExtCompressLogfiles:
+			// The active logfile is still written to.
+			if (isActiveLogfileToRotate (put))
+				break;
+			// Compressed by an earlier run already.
+			if (lenExtCompressorExtensionOfName (prg->nam, prg->siz - 1))
+				break;
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogExtCompressLogfile (put, NULL);
+			break;
 	}
-#endif
-#endif
-
-#ifdef CUNILOG_BUILD_WITH_TEST_ERRORCB
-	#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
-		#define REQUIRES_NEW_LOGFILE(put, cup, pev)		\
-				requiresNewLogFileCunilogTest (put, cup, pev)
-	#else
-		#define REQUIRES_NEW_LOGFILE(put, cup, pev)		\
-				requiresNewLogFile (put)
-	#endif
-#else
-	#define REQUIRES_NEW_LOGFILE(put, cup, pev)			\
-				requiresNewLogFile (put)
-#endif
 
-static inline size_t addNewLineToLogEventLine (char *pData, size_t lnData, enum enLineEndings nl)
-{	// At least one octet has been reserved for a newline character, and one
-	//	for NUL, hence we're definitely safe to write 2 more octets.
-	size_t len;
-	const char *cc = szLineEnding (nl, &len);
-	ubf_assert (len <= 2);
-	memcpy (pData + lnData, cc, len + 1);
-	return lnData + len;
+	// We're not in a rotator anymore.
+	put->prargs = NULL;
 }
 
-static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
+static inline void prepareU8fullFileNameToRotate (CUNILOG_TARGET *put, size_t idx)
 {
 	ubf_assert_non_NULL (put);
 
-	char				*pData	= put->mbLogEventLine.buf.pch;
-	size_t				lnData	= put->lnLogEventLine;
-	enum enLineEndings	nl		= put->unilogNewLine;
+	char	*strNam = put->fls.data [idx].chFilename;
+	size_t	sizName = put->fls.data [idx].stFilename;
 
-	#ifdef OS_IS_WINDOWS
-		DWORD dwWritten;
-		DWORD toWrite = addNewLineToLogEventLine (pData, lnData, nl) & 0xFFFFFFFF;
-		// The file has been opened with FILE_APPEND_DATA, i.e. we don't need to
-		//	seek ourselves.
-		//	LARGE_INTEGER	z = {0, 0};
-		//	SetFilePointerEx (pl->hLogFile, z, NULL, FILE_END);
-		bool b = WriteFile (put->logfile.hLogFile, pData, toWrite, &dwWritten, NULL);
-		pData [lnData] = ASCII_NUL;
-		return b;
-	#else
-		long lToWrite = (long) addNewLineToLogEventLine (pData, lnData, nl);
-		// See https://www.man7.org/linux/man-pages/man3/fopen.3.html .
-		//	A call "fseek (pl->fLogFile, (long) 0, SEEK_END);" is not required
-		//	because we opened the file in append mode.
-		size_t st = fwrite (pData, 1, lToWrite, put->logfile.fLogFile);
-		pData [lnData] = ASCII_NUL;
-		return st == lnData;
-	#endif
+	growToSizeSMEMBUF (&put->mbFilToRotate, put->lnLogPath + sizName);
+	if (isUsableSMEMBUF (&put->mbFilToRotate))
+	{
+		memcpy (put->mbFilToRotate.buf.pch + put->lnLogPath, strNam, sizName);
+		put->stFilToRotate = put->lnLogPath + sizName;
+	}
 }
 
-static bool cunilogProcessWriteToLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+static inline int cmpflsnums (const char *sz1, size_t l1, const char *sz2, size_t l2)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-
-	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
-	ubf_assert (isUsableSMEMBUF (&put->mbLogfileName));
-
-	if (cunilogHasDontWriteToLogfile (put))
-		return true;
-
-	/*
-	CUNILOG_LOGFILE	*pl	= cup->pData;
-	ubf_assert_non_NULL (pl);
-	*/
+	const char *szo1 = sz1;
+	const char *szo2 = sz2;
 
-	if (isUsableSMEMBUF (&put->mbLogfileName))
+	while (szo1 [0] == szo2 [0])
 	{
-		if (requiresOpenLogFile (put))
-		{
-			if (!cunilogOpenLogFile (put))
-				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
-		} else
-		if (REQUIRES_NEW_LOGFILE (put, cup, pev))
+		++ szo1;
+		-- l1;
+		++ szo2;
+		-- l2;
+	}
+	if (l1 || l2)
+	{
+		// The shorter the greater, i.e. "file.9" is greater than "file.10".
+		if (l1 < l2)
+			return -1;
+		if (l1 > l2)
+			return 1;
+		if (isdigit (szo1 [0]) && isdigit (szo2 [0]))
 		{
-			if (!cunilogOpenNewLogFile (put))
-				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
+			uint64_t	ui1;
+			uint64_t	ui2;
+
+			//printf ("%s - %s\n", szo1, szo2);
+			ubf_uint64_from_str (&ui1, szo1);
+			ubf_uint64_from_str (&ui2, szo2);
+			if (ui1 == ui2)
+				return 0;
+			// "file.1" is greater than "file.2".
+			return ui1 > ui2 ? 1 : -1;
 		}
-		if (!cunilogWriteDataToLogFile (put))
-				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_WRITING_LOGFILE, cup, pev);
 	}
-	return true;
+	return 0;
 }
 
-static bool cunilogProcessFlushLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+/*
+	Compare functions for vec_sort ().
+*/
+static int flscmp_dotnum (const void *p1, const void *p2)
 {
-	ubf_assert_non_NULL (pev);
-	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
-	CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
-	
-	if (cunilogHasDontWriteToLogfile (put))
-		return true;
+	const CUNILOG_FLS	*fls1 = p1;
+	const CUNILOG_FLS	*fls2 = p2;
+	int					r = 0;
 
-	#ifdef OS_IS_WINDOWS
-		if (!FlushFileBuffers (put->logfile.hLogFile))
-			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
-	#else
-		if (0 != fflush (put->logfile.fLogFile))
-			cunilogInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
-	#endif
-	return true;
+	ubf_assert_non_0 (fls1->stFilename);
+	ubf_assert_non_0 (fls2->stFilename);
+
+	r = cmpflsnums (fls1->chFilename, fls1->stFilename - 1, fls2->chFilename, fls2->stFilename - 1);
+	return r;
 }
 
-static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev);
-static bool enqueueAndTriggerSeparateLoggingThread (CUNILOG_EVENT *pev);
+static int flscmp_default (const void *p1, const void *p2)
+{
+	const CUNILOG_FLS	*fls1 = p1;
+	const CUNILOG_FLS	*fls2 = p2;
+	int					r = 0;
 
-#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	ubf_assert_non_0 (fls1->stFilename);
+	ubf_assert_non_0 (fls2->stFilename);
 
-	static inline void IncrementPendingNoRotationEvents (CUNILOG_TARGET *put)
+	if (fls1->stFilename == fls2->stFilename)
 	{
-		ubf_assert_non_NULL (put);
-		++ put->nPendingNoRotEvts;
-		//printf ("%" PRIu64 "\n", put->nPendingNoRotEvts);
+		r = memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename - 1);
+		return r;
 	}
-	static inline void DecrementPendingNoRotationEvents (CUNILOG_TARGET *put)
+	if (fls1->stFilename < fls2->stFilename)
+	{	
+		r = memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename - 1);
+		return r ? r : -1;
+	}
+	if (fls1->stFilename > fls2->stFilename)
 	{
-		ubf_assert_non_NULL (put);
-		-- put->nPendingNoRotEvts;
-		//printf ("%" PRIu64 "\n", put->nPendingNoRotEvts);
+		r = memcmp (fls1->chFilename, fls2->chFilename, fls2->stFilename - 1);
+		return r ? r : 1;
 	}
-#else
-	#define IncrementPendingNoRotationEvents(put)
-	#define DecrementPendingNoRotationEvents(put)
-#endif
+	return r;
+}
 
-static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt, ...)
+static inline bool needReverseFLS (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup)
 {
 	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (cup);
 
-	if (cunilogTargetHasShutdownInitiatedFlag (put))
-		return false;
-
-	va_list		ap;
-	size_t		len;
-	bool		bRet = false;
+	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+	
+	bool bRet;
+	bRet = hasDotNumberPostfix (put) && cunilogrotationtask_RenameLogfiles != prd->tsk;
+	return bRet;
+}
 
-	// We're supposed to be inside a rotator. This means we should have a
-	//	CUNILOG_ROTATOR_ARGS structure set in our target. It also means
-	//	we should have a cunilog processor. Its pData member points to a
-	//	rotation data structure. Anything else is a bug.
-	ubf_assert_non_NULL (put->prargs);
-	ubf_assert_non_NULL (put->prargs->cup);
-	ubf_assert_non_NULL (put->prargs->cup->pData);
+/*
+	On NTFS, files are returned in descending alphabetical order.
 
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
-	ubf_assert_non_NULL (prd);
+	This means it is enough to just reverse the order, i.e. start with the last
+	file first and walk downwards, and this is what prapareLogfilesListAndRotate ()
+	does.
+	
+	Other file systems may also return files in descending alphabetical order,
+	but on file systems that return the files randomly we got to sort the vector
+	first. If sorting descending alphabetically is required, we expect the target option
+	flag CUNILOGTARGET_FS_NEEDS_SORTING.
 
+	For the dot number postfix we need to sort in any case.
+*/
+static inline void sortLogfilesList (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup)
+{
 	/*
-		prd->plogCUNILOG_TARGET == NULL		-> Log to current CUNILOG_TARGET (put) but
-												without rotation (because we currently *are*
-												within a rotation).
-		prd->plogCUNILOG_TARGET == put		-> Bug, as this should be NULL.
-		prd->plogCUNILOG_TARGET == <Anything else>
-											-> Log to this CUNILOG_TARGET normally.
-	*/
-	ubf_assert (put != prd->plogCUNILOG_TARGET);
-	if (prd->plogCUNILOG_TARGET && put != prd->plogCUNILOG_TARGET)
+	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+
+	size_t iFiles = put->fls.length;
+	printf ("\nList sort in: %d\n", prd->tsk);
+	while (iFiles --)
 	{
-		va_start (ap, fmt);
-		bRet = logTextU8vfmt (put, fmt, ap);
-		va_end (ap);
-		return bRet;
+		puts (put->fls.data [iFiles].chFilename);
 	}
+	*/
 
-	va_start (ap, fmt);
-	len = (size_t) vsnprintf (NULL, 0, fmt, ap);
-	va_end (ap);
-
-	char *szTxtToLog = ubf_malloc (len + 1);
-	if (szTxtToLog)
+	if (cunilogTargetHasFSneedsSorting (put))
 	{
-		va_start (ap, fmt);
-		vsnprintf (szTxtToLog, len + 1, fmt, ap);
-		va_end (ap);
-
-		CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, szTxtToLog, len);
-		ubf_assert_non_NULL (pev);
-		if (pev)
+		if (!cunilogTargetHasFLSisSorted (put))
 		{
-			cunilogSetEventInternal		(pev);
-			cunilogSetEventNoRotation	(pev);
-			#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-				if (HAS_CUNILOG_TARGET_A_QUEUE (put))
-				{
-					IncrementPendingNoRotationEvents (put);
-					enqueueAndTriggerSeparateLoggingThread (pev);
-					bRet = true;
-				} else
-			#endif
-					bRet = cunilogProcessEventSingleThreaded (pev);
+			if (hasDotNumberPostfix (put))
+				vec_sort (&put->fls, flscmp_dotnum);
+			else
+				vec_sort (&put->fls, flscmp_default);
+			cunilogTargetSetFLSisSorted (put);
 		}
-		ubf_free (szTxtToLog);
 	}
-	return bRet;
-}
 
-#ifdef OS_IS_WINDOWS
-	static DWORD GetTextForLastError (char *szErrMsg)
+	// The processor may need the files in reverse order.
+	bool bFLSreversedRequired = needReverseFLS (put, cup);
+	if (bFLSreversedRequired)
 	{
-		ubf_assert_non_NULL (szErrMsg);
-
-		// Note that we expect a buffer of CUNILOG_STD_MSG_SIZE octets.
-		DWORD dwError = GetLastError ();
-		GetWinErrorTextU8 (szErrMsg, CUNILOG_STD_MSG_SIZE, dwError);
-		return dwError;
-	}
-#else
-	static int GetTextForLastError (char *szErrMsg)
+		if (!cunilogTargetHasFLSreversed (put))
+		{
+			vec_reverse (&put->fls);
+			cunilogTargetSetFLSreversed (put);
+		}
+	} else
 	{
-		ubf_assert_non_NULL (szErrMsg);
+		if (cunilogTargetHasFLSreversed (put))
+		{
+			vec_reverse (&put->fls);
+			cunilogTargetClrFLSreversed (put);
+		}
+	}
 
-		char szErr [] = "\"Not implemented\"";
-		memcpy (szErrMsg, szErr, sizeof (szErr));
-		return -1;
+	/*
+	printf ("\nList sort out: %d\n", prd->tsk);
+	iFiles = put->fls.length;
+	while (iFiles --)
+	{
+		puts (put->fls.data [iFiles].chFilename);
 	}
-#endif
+	;
+	*/
+}
 
 /*
-	Increments the dot number part of a filename, i.e. ".1234".
-	Can also be "", which is the case for the original file.
-	Assumes that there's always enough space available to write out
-	the incremented value.
-
-	Like:
-	"file.log"		-> ""
-	"file.log.1"	-> ".1"
-	"file.log.2"	-> ".2"
-	"file.log.900"	-> ".900"
-
-	Returns the new length of the dot number part, including the dot.
+	Obtains the size and the last write time of the logfile in the files list entry pfls
+	from the file system. On Windows, mbFilToRotate must contain the full path of the
+	logfile. The members stay CUNILOG_FLS_UNKNOWN if the logfile doesn't exist anymore.
 */
-static inline size_t incrementDotNumberName (char *sz)
+static inline void obtainCUNILOG_FLSattributes (CUNILOG_TARGET *put, CUNILOG_FLS *pfls)
 {
-	ubf_assert_non_NULL	(sz);
-	ubf_assert_non_0	(sz [0]);
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pfls);
 
-	if ('.' == sz [0])
-	{
-		++ sz;
-		uint64_t	ui = 0;;
-		ubf_uint64_from_str (&ui, sz);
-		++ ui;
-		size_t written = ubf_str_from_uint64 (sz, ui);
-		++ written;											// The '.'
-		return written;
-	} else
-	{
-		++ sz;
-		memcpy (sz, ".1", 3);
-		return 2;
-	}
+	#ifdef PLATFORM_IS_WINDOWS
+		HANDLE	h	= CreateFileU8	(
+						put->mbFilToRotate.buf.pcc, FILE_READ_ATTRIBUTES,
+						FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+									);
+		if (INVALID_HANDLE_VALUE == h)
+			return;
+		LARGE_INTEGER	li;
+		FILETIME		ft;
+		if (GetFileSizeEx (h, &li) && GetFileTime (h, NULL, NULL, &ft))
+		{
+			pfls->ullSize		= (uint64_t) li.QuadPart;
+			pfls->ullModified	= ULONGLONGfromFILETIME (ft);
+		}
+		CloseHandle (h);
+	#else
+		struct stat	st;
+		int			fd	= cunilogLogFoldFD (put);
+		if (-1 == fd || fstatat (fd, pfls->chFilename, &st, 0))
+			return;
+		pfls->ullSize		= (uint64_t) st.st_size;
+		#ifdef OS_IS_MACOS
+			pfls->ullModified	= ULONGLONG_from_timespec (&st.st_mtimespec);
+		#else
+			pfls->ullModified	= ULONGLONG_from_timespec (&st.st_mtim);
+		#endif
+	#endif
 }
 
-static inline char *findDotNumberPart (size_t *pln, CUNILOG_TARGET *put)
+/*
+	Returns true if the logfile at index idx of the files list is to be rotated because of
+	the retention policy of the rotator prd. The files are expected to be checked from the
+	newest to the oldest one. *pullTotal receives the total size of all files checked so
+	far, including the one at idx. The active logfile is never rotated.
+*/
+static bool isLogfileBeyondRetention	(
+				CUNILOG_TARGET				*put,
+				CUNILOG_ROTATION_DATA		*prd,
+				size_t						idx,
+				uint64_t					ullNow,
+				uint64_t					*pullTotal
+										)
 {
-	ubf_assert_non_NULL (pln);
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (prd);
+	ubf_assert (idx < put->fls.length);
+	ubf_assert_non_NULL (pullTotal);
 
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+	CUNILOG_FLS	*pfls	= &put->fls.data [idx];
 
-	// Obtain the dot number part.
-	size_t ln = put->stFilToRotate - 1;
-	-- ln;
-	while (ln)
-	{
-		if (!isdigit (prd->mbDstFile.buf.pch [ln]))
-			break;
-		-- ln;
+	prepareU8fullFileNameToRotate (put, idx);
+	if (isActiveLogfileToRotate (put))
+	{	// Its entry may be older than the last event written to it. The attributes are
+		//	obtained again once it isn't the active logfile anymore.
+		initCUNILOG_FLSattributes (pfls);
+		*pullTotal += put->logfile.ullSize;
+		return false;
 	}
-	char *sz = prd->mbDstFile.buf.pch + ln;
-	*pln = ln;
-	return sz;
+	if (CUNILOG_FLS_UNKNOWN == pfls->ullSize)
+		obtainCUNILOG_FLSattributes (put, pfls);
+	if (CUNILOG_FLS_UNKNOWN == pfls->ullSize)
+		return false;
+	*pullTotal += pfls->ullSize;
+	if (prd->ullKeepOctets && *pullTotal > prd->ullKeepOctets)
+		return true;
+	return		prd->ullKeepSeconds
+			&&	ullNow > pfls->ullModified
+			&&	ullNow - pfls->ullModified > prd->ullKeepSeconds * FT_SECOND;
 }
 
-/*
-	Renames the DotNumberPostfix file in our files list (FLS) to keep the files list in sync
-	with the real directory on disk.
-*/
-static inline void renameDotNumberPostfixInFLS (CUNILOG_TARGET *put, size_t nLen, size_t oLen)
+static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 {
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
+	ubf_assert_non_NULL (prg);
+	CUNILOG_EVENT			*pev = prg->pev;
+	ubf_assert_non_NULL (pev);
+	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (put);
+	CUNILOG_PROCESSOR		*cup = prg->cup;
+	ubf_assert_non_NULL (cup);
+	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+	ubf_assert_non_NULL (prd);
 
-	CUNILOG_ROTATOR_ARGS	*prg = put->prargs;
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
 
-	char		*szDst;
-	const char	*ccSrc;
+	//DebugOutputFilesList ("List in", cup, pev);
+	sortLogfilesList (put, cup);
 
-	if (nLen > oLen)
-	{
-		char	*sz	= put->fls.data [prg->idx].chFilename;
-		size_t	ln	= put->fls.data [prg->idx].stFilename - oLen + nLen;
-		put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, ln);
-		char *szFls = put->fls.data [prg->idx].chFilename;
-		if (NULL == szFls)
-		{	// Bulk memory allocation failed. There's not much we can do.
-			ubf_assert_msg (false, "Bulk memory allocation failed");
-			return;
-		}
-		memcpy (szFls, sz, put->fls.data [prg->idx].stFilename);
-		put->fls.data [prg->idx].stFilename = ln;
+	uint64_t nToIgnore = prd->nIgnore + put->scuNPI.nIgnoredTotal;
+	uint64_t nMaxToRot;
 
-		// Since the new vector entry is empty, we also need to copy the NUL terminator.
-		++ nLen;
+	if (cunilogrotationtask_RenameLogfiles == prd->tsk && hasLogPostfix (put))
+	{	// This should all have been taken care of before we're called.
+		ubf_assert (cunilogProcessRotateLogfiles == cup->task);
+		ubf_assert (hasLogPostfix (put));
+
+		nMaxToRot = 1;										// Only "<appname>.log" needs rotation.
+	} else
+	{
+		nMaxToRot =	CUNILOG_MAX_ROTATE_AUTO - nToIgnore <= prd->nMaxToRotate
+					?	prd->nMaxToRotate
+					:	nToIgnore + prd->nMaxToRotate;
 	}
+	DebugOutputFilesList ("List out", &put->fls);
 
-	szDst	=	put->fls.data [prg->idx].chFilename
-			+	put->lnAppName
-			+	lenCunilogLogFileNameExtension;
+	size_t iFiles = put->fls.length;
 
-	ccSrc	=	prd->mbDstFile.buf.pcc
-			+	put->lnLogPath
-			+	put->lnAppName
-			+	lenCunilogLogFileNameExtension;
-	memcpy (szDst, ccSrc, nLen);
+	// A retention policy can rotate files the rotator would otherwise ignore.
+	bool		bRetain		= cunilogHasRotatorRetention (prd);
+	uint64_t	ullNow		= prd->ullKeepSeconds ? GetSystemTimeAsULONGLONG () : 0;
+	uint64_t	ullTotal	= 0;
+	uint64_t	nRotated	= 0;
+
+	// The files to ignore come first. Skip them in one go.
+	if (!bRetain && prd->nCnt < nToIgnore)
+	{
+		uint64_t nSkip = nToIgnore - prd->nCnt;
+		nSkip = nSkip < iFiles ? nSkip : iFiles;
+		prd->nCnt						+= nSkip;
+		put->scuNPI.nIgnoredTotal		+= nSkip;
+		iFiles							-= (size_t) nSkip;
+	}
+	while (iFiles --)
+	{
+		ubf_assert (iFiles < put->fls.length);
+		//puts (put->fls.data [iFiles].chFilename);
+		++ prd->nCnt;
+		bool bRotate =		prd->nCnt > nToIgnore
+						||	(
+									bRetain
+								&&	isLogfileBeyondRetention (put, prd, iFiles, ullNow, &ullTotal)
+							);
+		if (bRotate)
+		{
+			if (bRetain && prd->nRetainBatch && nRotated == prd->nRetainBatch)
+			{	// The remaining files are rotated with the next event.
+				optCunProcSetOPT_CUNPROC_AT_STARTUP (prg->cup->uiOpts);
+				break;
+			}
+			if (prd->nCnt <= nMaxToRot || prd->nCnt <= nToIgnore)
+			{
+				++ nRotated;
+				/*
+				DebugOutputFilesList ("List", &put->fls);
+				puts ("File:");
+				puts (put->fls.data [iFiles].chFilename);
+				*/
+				prepareU8fullFileNameToRotate (put, iFiles);
+				//puts (put->fls.data [iFiles].chFilename);
+
+				prg->nam = put->fls.data [iFiles].chFilename;
+				prg->siz = put->fls.data [iFiles].stFilename;
+				prg->idx = iFiles;
+				performActualRotation (prg);
+			} else
+				break;
+		} else
+		{	// This tells the next rotation processor how many we've ignored already.
+			++ put->scuNPI.nIgnoredTotal;
+		}
+	}
+	DebugOutputFilesList ("List out", &put->fls);
 }
 
 /*
-	Renames the LogPostfix file in our files list (FLS) to keep the files list in sync
-	with the real directory on disk.
+	Returns true if the logfile name ends with ".log" or ".log.<number>".
 */
-static inline void renameLogPostfixInFLS (CUNILOG_TARGET *put, const char *szNew, size_t lnNew)
+static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 {
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
-	ubf_assert_non_NULL	(szNew);
-	ubf_assert_non_0	(lnNew);
-	ubf_assert			(strlen (szNew) == lnNew);
+	ubf_assert_non_NULL	(pfls);
+	ubf_assert_non_NULL	(pfls->chFilename);
+	ubf_assert_non_0	(pfls->stFilename);
 
-	CUNILOG_ROTATOR_ARGS	*prg	= put->prargs;
-	size_t					siz		= lnNew + 1;
+	size_t o = pfls->stFilename;
+	size_t d = 0;
 
-	put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, siz);
-	if (put->fls.data [prg->idx].chFilename)
+	if (o > lenCunilogLogFileNameExtension + 1)
 	{
-		memcpy (put->fls.data [prg->idx].chFilename, szNew, siz);
-		put->fls.data [prg->idx].stFilename = siz;
-		return;
+		o -= 2;												// NULL and 0 index.
+		while (o && isdigit (pfls->chFilename [o]))
+		{
+			-- o;
+			++ d;
+		}
+		if (d && o && '.' == pfls->chFilename [o])
+		{
+			-- o;
+			++ d;
+		}
+		char *szfn = pfls->chFilename + pfls->stFilename - sizCunilogLogFileNameExtension - d;
+		if (o > lenCunilogLogFileNameExtension)
+		{
+			return	0 == memcmp	(
+							szCunilogLogFileNameExtension,
+							szfn,
+							lenCunilogLogFileNameExtension
+								);
+		}
 	}
-	// Bulk memory allocation failed. There's not much we can do.
-	ubf_assert_msg (false, "Bulk memory allocation failed");
-	put->fls.data [prg->idx].stFilename = 0;
+	return false;
 }
 
 /*
-	The next rotator would have to read the directory listing from disk again,
-	but we may not have logfile.log again yet, if no event has been written to it,
-	which would mean the amount of files to ignore is one too high.
-
-	We therefore need to insert the current/active logfile's name.
-	Since the vector is sorted with the current logfile at index 0, vec_insert() is
-	invoked instead of vec_push().
-
-					-> logfile.log		<- Inserted by vec_insert() below.
-	logfile.log		-> logfile.log.1
-	logfile.log.1	-> logfile.log.2
-
-	i == false	:	Insert at the beginning/top.
-	i == true	:	Push to the end.
-
+	Returns true if the file name szName with length ln, which matches the search mask of
+	the target put points to, is a logfile, or a logfile that has been compressed by a
+	rotator with the task cunilogrotationtask_ExtCompressLogfiles. Other files the wildcard
+	at the end of the search mask picks up are not part of the files list. See
+	createLogfilesSearchMask ().
 */
-static inline void cunilogAddActiveLogfile (bool bIsActiveLogfile, bool i, CUNILOG_TARGET *put)
+static inline bool isLogfileOrExtCompressedName (CUNILOG_TARGET *put, const char *szName, size_t ln)
 {
 	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (szName);
 
-	if (bIsActiveLogfile)
+	if (hasDotNumberPostfix (put))
+		return true;
+	// Everything in front of the wildcard matches the same number of characters.
+	if (ln + 1 < put->lnLogFileMask)
+		return false;
+	size_t lnTail = ln + 1 - put->lnLogFileMask;
+	return 0 == lnTail || lnTail == lenExtCompressorExtensionOfName (szName, ln);
+}
+
+#if defined (PLATFORM_IS_WINDOWS)
+	static bool obtainLogfilesListToRotateCallbackWin (SRDIRONEENTRYSTRUCT *psdE)
 	{
-		CUNILOG_FLS	currFls;
-		currFls.stFilename = put->lnAppName + sizCunilogLogFileNameExtension;
-		currFls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, currFls.stFilename);
-		if (currFls.chFilename)
+		ubf_assert_non_NULL (psdE);
+		CUNILOG_TARGET			*put = psdE->pCustom;
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_FLS	fls;
+		fls.stFilename	= psdE->stFileNameU8;
+		fls.chFilename	= psdE->szFileNameU8;
+		// Comes with the directory listing anyway.
+		fls.ullSize		=		((uint64_t) psdE->pwfd->nFileSizeHigh << 32)
+							|	psdE->pwfd->nFileSizeLow;
+		fls.ullModified	= ULONGLONGfromFILETIME (psdE->pwfd->ftLastWriteTime);
+		if (hasDotNumberPostfix (put) && !endsLogFileNameWithDotNumber (&fls))
+			return true;
+		if (!isLogfileOrExtCompressedName (put, fls.chFilename, fls.stFilename - 1))
+			return true;
+		// The active logfile is still growing. Its attributes are obtained once it has
+		//	been rotated. See isLogfileBeyondRetention ().
+		if	(
+					isUsableSMEMBUF (&put->mbLogfileName)
+				&&	!strcmp (fls.chFilename, put->mbLogfileName.buf.pcc + put->lnLogPath)
+			)
+			initCUNILOG_FLSattributes (&fls);
+
+		fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
+		ubf_assert_non_NULL (fls.chFilename);
+		if (fls.chFilename)
 		{
-			memcpy (currFls.chFilename, put->mbAppName.buf.pcc, put->lnAppName);
-			memcpy (currFls.chFilename + put->lnAppName, szCunilogLogFileNameExtension,
-						sizCunilogLogFileNameExtension);
-			if (i)
+			memcpy (fls.chFilename, psdE->szFileNameU8, fls.stFilename);
+			if (0 == put->fls.capacity)
 			{
-				if (0 == vec_push (&put->fls, currFls))
-					return;
-			} else
+				if (-1 == vec_reserve (&put->fls, CUNILOG_STD_VECT_EXP_SIZE))
+					return false;
+			}
+			vec_push (&put->fls, fls);
+		}
+		return true;
+	}
+#elif defined (PLATFORM_IS_POSIX)
+	static bool obtainLogfilesListToRotateCallbackPsx (SONEDIRENT *pod)
+	{
+		ubf_assert_non_NULL (pod);
+		CUNILOG_TARGET			*put = pod->pCustom;
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_FLS fls;
+		initCUNILOG_FLSattributes (&fls);
+		fls.stFilename = strlen (pod->dirEnt->d_name) + 1;
+		if	(
+					matchWildcardPattern	(
+						pod->dirEnt->d_name, fls.stFilename - 1,
+						put->mbLogFileMask.buf.pcc, put->lnLogFileMask
+											)
+				&&	isLogfileOrExtCompressedName (put, pod->dirEnt->d_name, fls.stFilename - 1)
+			)
+		{
+			fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
+			ubf_assert_non_NULL (fls.chFilename);
+			if (fls.chFilename)
 			{
-				if (0 == vec_insert (&put->fls, 0, currFls))
-					return;
+				memcpy (fls.chFilename, pod->dirEnt->d_name, fls.stFilename);
+				if (0 == put->fls.capacity)
+				{
+					if (-1 == vec_reserve (&put->fls, CUNILOG_STD_VECT_EXP_SIZE))
+						return false;
+				}
+				vec_push (&put->fls, fls);
 			}
 		}
-		SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+		return true;
+	}
+#endif
+
+#if defined (PLATFORM_IS_WINDOWS)
+	static void obtainLogfilesListToRotateWin (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(strlen (put->mbLogPath.buf.pcc)		== put->lnLogPath);
+		ubf_assert			(strlen (put->mbLogFileMask.buf.pcc)	== put->lnLogFileMask);
+
+		uint64_t		n;
+		/*
+		n = ForEachDirectoryEntryU8	(
+				put->mbLogFileMask.buf.pcc,					// Search mask.
+				obtainLogfilesListToRotateCallbackWin, put, NULL
+									);
+		*/
+		n = ForEachDirectoryEntryMaskU8	(
+				put->mbLogPath.buf.pcc,			put->lnLogPath,
+				put->mbLogFileMask.buf.pcc,		put->lnLogFileMask,
+				obtainLogfilesListToRotateCallbackWin,
+				put,
+				NULL
+										);
+		UNUSED (n);
+	}
+#elif defined (PLATFORM_IS_POSIX)
+	static void obtainLogfilesListToRotatePsx (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(strlen (put->mbLogPath.buf.pcc)		== put->lnLogPath);
+		ubf_assert			(strlen (put->mbLogFileMask.buf.pcc)	== put->lnLogFileMask);
+
+		uint64_t n;
+		n = ForEachPsxDirEntry	(
+				put->mbLogFold.buf.pcc,						// Directory name.
+				obtainLogfilesListToRotateCallbackPsx, put, NULL
+								);
+		UNUSED (n);
 	}
+#endif
+
+static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	vec_clear (&put->fls);
+	EmptySBULKMEM (&put->sbm);
+	put->stFLSorphaned = 0;
+	cunilogTargetClrFLSisSorted (put);
+	cunilogTargetClrFLSindexBuilt (put);
 }
 
-static inline bool prepareDotNumberPostfixFileToRename	(
-						CUNILOG_TARGET				*put,
-						size_t						*poldLength,
-						size_t						*pnewLength
-												)
+/*
+	Compare function for vec_sort () for the files list index of a target with a dot
+	number postfix. Unlike flscmp_dotnum (), names the dot number comparison considers
+	equal are ordered alphabetically, and identical names are supported, which makes the
+	order suitable for a binary search.
+*/
+static int flscmp_dotnum_index (const void *p1, const void *p2)
 {
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
-	ubf_assert_non_NULL	(put->prargs->cup);
-	ubf_assert_non_NULL (poldLength);
-	ubf_assert_non_NULL (pnewLength);
-	
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
-	bool					bIsActiveLogfile;
+	const CUNILOG_FLS	*fls1 = p1;
+	const CUNILOG_FLS	*fls2 = p2;
 
-	memcpy (prd->mbDstFile.buf.pch, put->mbFilToRotate.buf.pch, put->stFilToRotate);
-	size_t ln;
-	char *sz = findDotNumberPart (&ln, put);
-	//printf ("Dot number part: >%s<\n", sz);
-	// Either ".log.<number>" orr "g" from ".log".
-	ubf_assert ('.' == sz [0] || 'g' == sz [0]);
-	bIsActiveLogfile = 'g' == sz [0];
-	*poldLength = put->stFilToRotate - 1 - ln;
-	*pnewLength = incrementDotNumberName (sz);
-	return bIsActiveLogfile;
+	if	(
+				fls1->stFilename == fls2->stFilename
+			&&	!memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename)
+		)
+		return 0;
+	int r = flscmp_dotnum (p1, p2);
+	return r ? r : flscmp_default (p1, p2);
 }
 
-static inline bool prepareLogPostfixFileToRename	(
-						CUNILOG_TARGET				*put,
-						char						**pszNewFileName,
-						size_t						*poldLength,
-						size_t						*pnewLength
-													)
+/*
+	Compares two entries of the files list index in the order of the index, which is
+	the reverse order if the files list has been reversed.
+*/
+static inline int cmpFLSindex (CUNILOG_TARGET *put, const CUNILOG_FLS *fls1, const CUNILOG_FLS *fls2)
 {
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
-	ubf_assert_non_NULL	(put->prargs->cup);
-	ubf_assert_non_NULL	(pszNewFileName);
-	ubf_assert_non_NULL (poldLength);
-	ubf_assert_non_NULL (pnewLength);
-	
-	UNUSED (poldLength);
+	ubf_assert_non_NULL (put);
 
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
+	int r = hasDotNumberPostfix (put) ? flscmp_dotnum_index (fls1, fls2) : flscmp_default (fls1, fls2);
+	return cunilogTargetHasFLSreversed (put) ? -r : r;
+}
 
-	ubf_assert	(put->prargs->siz == put->lnAppName + sizCunilogLogFileNameExtension);
-	ubf_assert	(!memcmp (put->prargs->nam, put->mbAppName.buf.pcc, put->lnAppName));
-	ubf_assert	(
-		!memcmp (put->prargs->nam + put->lnAppName,
-		szCunilogLogFileNameExtension,
-		lenCunilogLogFileNameExtension)
-				);
-	char *szWrite = prd->mbDstFile.buf.pch;
-	memcpy (szWrite, put->mbFilToRotate.buf.pcc, put->lnLogPath);
-	szWrite += put->lnLogPath;
-	memcpy (szWrite, put->mbAppName.buf.pcc, put->lnAppName);
-	*pszNewFileName = szWrite;
-	szWrite += put->lnAppName;
-	*szWrite ++ = '_';
-	obtainDateAndTimeStamp (szWrite, put->prargs->cup->cur, put->culogPostfix);
-	szWrite += lenDateTimeStampFromPostfix (put->culogPostfix);
-	memcpy (szWrite, szCunilogLogFileNameExtension, sizCunilogLogFileNameExtension);
-	*pnewLength =		put->lnAppName
-				+	1								// Underscore '_'.
-				+	lenDateTimeStampFromPostfix (put->culogPostfix)
-				+	lenCunilogLogFileNameExtension;
-	return true;
+/*
+	Returns true if pfls is the current/active logfile "<appname>.log" of a target with a
+	.log postfix. The search mask doesn't pick it up, and it is always the last element
+	of the files list.
+*/
+static inline bool isActiveLogPostfixFLS (CUNILOG_TARGET *put, CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pfls);
+
+	return		pfls->stFilename == put->lnAppName + sizCunilogLogFileNameExtension
+			&&	!memcmp (pfls->chFilename, put->mbAppName.buf.pcc, put->lnAppName)
+			&&	!memcmp	(
+					pfls->chFilename + put->lnAppName, szCunilogLogFileNameExtension,
+					sizCunilogLogFileNameExtension
+						);
 }
 
-static void cunilogRenameLogfile (CUNILOG_TARGET *put)
+/*
+	Binary search for the file name szName with size stName, which includes the NUL
+	terminator, in the files list index. If the function returns true, *pidx receives
+	the index of the entry. If it returns false, *pidx receives the index the entry
+	would have to be inserted at.
+*/
+static bool findInFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName, size_t *pidx)
 {
-	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL	(put->prargs);
-	ubf_assert_non_NULL	(put->prargs->cup);
-	ubf_assert_non_NULL	(put->prargs->cup->pData);
-	ubf_assert			(isInitialisedSMEMBUF (&put->mbFilToRotate));
-	ubf_assert_non_0	(put->stFilToRotate);
-	ubf_assert_non_0	(1 < put->stFilToRotate);
-	ubf_assert			(hasDotNumberPostfix (put) || hasLogPostfix (put));
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (szName);
+	ubf_assert_non_0	(stName);
+	ubf_assert_non_NULL (pidx);
 
-	CUNILOG_ROTATION_DATA	*prd = put->prargs->cup->pData;
-	bool					bIsActiveLogfile;
-	size_t					oldLen			= 0;
-	size_t					newLen;
-	char					*szNewFileName		= NULL;
+	CUNILOG_FLS	fls;
+	fls.chFilename	= (char *) szName;
+	fls.stFilename	= stName;
 
-	if (!cunilogHasRotatorFlag_USE_MBDSTFILE (prd))
-	{														// The + 1 is for an underscore.
-		initSMEMBUFtoSize	(
-			&prd->mbDstFile,
-			put->stFilToRotate + lenDateTimeStampFromPostfix (put->culogPostfix) + 1
-							);
-		cunilogSetRotatorFlag_USE_MBDSTFILE (prd);
-	}
-	growToSizeSMEMBUF	(
-		&prd->mbDstFile,
-		put->stFilToRotate + lenDateTimeStampFromPostfix (put->culogPostfix) + 1
-						);
-	if (isUsableSMEMBUF (&prd->mbDstFile))
+	size_t lo = 0;
+	size_t hi = put->fls.length;
+	if (hasLogPostfix (put) && hi && isActiveLogPostfixFLS (put, &put->fls.data [hi - 1]))
+		-- hi;
+	while (lo < hi)
 	{
-		if (hasDotNumberPostfix (put))
-		{
-			bIsActiveLogfile = prepareDotNumberPostfixFileToRename (put, &oldLen, &newLen);
-		} else
-		if (hasLogPostfix (put))
+		size_t	mi	= lo + (hi - lo) / 2;
+		int		r	= cmpFLSindex (put, &put->fls.data [mi], &fls);
+		if (0 == r)
 		{
-			// We only have to deal with the current/active logfile here. All other file names
-			//	stay the same throughout their existence.
-			if (put->prargs->siz != put->lnAppName + sizCunilogLogFileNameExtension)
-				return;
-			bIsActiveLogfile = prepareLogPostfixFileToRename (put, &szNewFileName, &oldLen, &newLen);
-		} else
-		{
-			ubf_assert_msg (false, "Bug!");
-			return;
+			*pidx = mi;
+			return true;
 		}
+		if (r < 0)
+			lo = mi + 1;
+		else
+			hi = mi;
+	}
+	*pidx = lo;
+	return false;
+}
 
-		bool bMoved;
+static void insertIntoFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName)
+{
+	ubf_assert_non_NULL (put);
 
-		#ifdef PLATFORM_IS_WINDOWS
-			if (bIsActiveLogfile)
-				cunilogCloseCUNILOG_LOGFILEifOpen (put);
-			bMoved = MoveFileU8long (put->mbFilToRotate.buf.pch, prd->mbDstFile.buf.pcc);
-			if (bIsActiveLogfile && requiresOpenLogFile (put))
-			{
-				if (!cunilogOpenLogFile (put))
-				{
-					SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
-					cunilogSetTargetErrorAndInvokeErrorCallback	(
-						CUNILOG_ERROR_OPENING_LOGFILE,
-						put->prargs->cup, put->prargs->pev
-																);
-				}
-			}
-			if (bMoved)
-			{
-				if (hasDotNumberPostfix (put))
-				{
-					renameDotNumberPostfixInFLS (put, newLen, oldLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, false, put);
-				} else
-				if (hasLogPostfix (put))
-				{
-					renameLogPostfixInFLS (put, szNewFileName, newLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
-				}
-				logFromInsideRotatorTextU8fmt	(
-					put, "File \"%s\" moved/renamed to \"%s\".",
-					put->mbFilToRotate.buf.pcc,
-					prd->mbDstFile.buf.pcc
-												);
-			} else
-			{
-				char szErr [CUNILOG_STD_MSG_SIZE];
-				DWORD dwErr = GetTextForLastError (szErr);
+	size_t idx;
+	if (findInFLSindex (put, szName, stName, &idx))
+		return;
 
-				logFromInsideRotatorTextU8fmt	(
-					put,
-					"Error %s while attempting to move file \"%s\" to \"%s\".",
-					szErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
-												);
-				SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, dwErr);
-			}
-		#else
-			bMoved = false;
-		#endif
+	CUNILOG_FLS	fls;
+	initCUNILOG_FLSattributes (&fls);
+	fls.stFilename = stName;
+	fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, stName);
+	if (fls.chFilename)
+	{
+		memcpy (fls.chFilename, szName, stName);
+		if (0 == vec_insert (&put->fls, idx, fls))
+			return;
 	}
+	SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
 }
 
-static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
+/*
+	Adds the current/active logfile to the files list index after it has been opened,
+	unless the index doesn't exist yet or already contains it.
+*/
+static void cunilogAddLogfileToFLSindex (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-	bool b;
-	char szErr [CUNILOG_STD_MSG_SIZE];
-	
-	enfilecompressresult	cmprRes = IsFileCompressedByName (put->mbFilToRotate.buf.pch);
-	switch (cmprRes)
+	if (!cunilogTargetHasFLSindexBuilt (put))
+		return;
+
+	if (hasLogPostfix (put))
 	{
-		case fscompress_uncompressed:
-			logFromInsideRotatorTextU8fmt	(
-				put, "Initiating file system compression for file \"%s\"...",
-				put->mbFilToRotate.buf.pcc
-											);
-			b = FScompressFileByName (put->mbFilToRotate.buf.pcc);
-			if (b)
-			{
-				logFromInsideRotatorTextU8fmt	(
-					put, "File system compression for file \"%s\" initiated.",
-				put->mbFilToRotate.buf.pcc
-												);
-			} else
-			{
-				GetTextForLastError (szErr);
-				logFromInsideRotatorTextU8fmt	(
-					put,
-					"Error %s while attempting to initiate file system compression for file \"%s\".",
-					szErr, put->mbFilToRotate.buf.pcc
-										);
-			}
-			break;
-		case fscompress_compressed:
-			break;
-		case fscompress_error:
-			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt	(
-				put,
-				"Error %s while attempting to check file system compression for file \"%s\".",
-				szErr, put->mbFilToRotate.buf.pcc
-									);
-			break;
+		size_t n = put->fls.length;
+		if (0 == n || !isActiveLogPostfixFLS (put, &put->fls.data [n - 1]))
+			cunilogAddActiveLogfile (true, true, put);
+		return;
 	}
+	const char *szName = put->mbLogfileName.buf.pcc + put->lnLogPath;
+	insertIntoFLSindex (put, szName, strlen (szName) + 1);
 }
 
-#if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
+/*
+	Copies the file names of the files list index into fresh bulk memory. Renaming and
+	removing entries leaves their previous names behind in the bulk memory, which would
+	otherwise grow for as long as the target exists.
+*/
+static void compactFLSindex (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
 
-	static void MoveFileToRecycleBinWin (CUNILOG_TARGET *put)
-	{
-		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+	size_t	stTotal	= 0;
+	size_t	i;
 
-		logFromInsideRotatorTextU8fmt	(
-			put, "Moving obsolete logfile \"%s\" to recycle bin...", put->mbFilToRotate.buf.pcc
-										);
-		bool b = MoveToRecycleBinU8 (put->mbFilToRotate.buf.pcc);
-		if (b)
-		{
-			logFromInsideRotatorTextU8fmt	(
-				put, "Obsolete logfile \"%s\" moved to recycle bin.", put->mbFilToRotate.buf.pcc
-											);
-			vec_splice (&put->fls, put->prargs->idx, 1);
-		} else
-		{
-			char szErr [CUNILOG_STD_MSG_SIZE];
-			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt	(
-				put,
-				"Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.", szErr, put->mbFilToRotate.buf.pcc
-											);
+	for (i = 0; i < put->fls.length; ++ i)
+		stTotal += put->fls.data [i].stFilename;
+	char *szNames = ubf_malloc (stTotal + 1);
+	if (NULL == szNames)
+		return;
+
+	char *sz = szNames;
+	for (i = 0; i < put->fls.length; ++ i)
+	{
+		memcpy (sz, put->fls.data [i].chFilename, put->fls.data [i].stFilename);
+		sz += put->fls.data [i].stFilename;
+	}
+	EmptySBULKMEM (&put->sbm);
+	put->stFLSorphaned = 0;
+	sz = szNames;
+	for (i = 0; i < put->fls.length; ++ i)
+	{
+		CUNILOG_FLS *pfls = &put->fls.data [i];
+		pfls->chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, pfls->stFilename);
+		if (NULL == pfls->chFilename)
+		{	// The index is built again from disk.
+			cunilogResetFilesList (put);
+			break;
 		}
+		memcpy (pfls->chFilename, sz, pfls->stFilename);
+		sz += pfls->stFilename;
 	}
+	ubf_free (szNames);
+}
 
-#elif OS_IS_MACOS
+#ifdef CUNILOG_HAVE_INOTIFY
 
-	#include "./../OS/Apple/TrashCan.h"
+	// The changes to the logging folder the files list index is interested in.
+	#define CUNILOG_FLS_WATCH_MASK								\
+		(IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO	\
+		| IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
 
-	// Our wrapper.
-	static void MoveFileToRecycleBinMac (CUNILOG_TARGET *put)
+	#ifndef CUNILOG_FLS_WATCH_BUF_SIZE
+	#define CUNILOG_FLS_WATCH_BUF_SIZE		(4096)
+	#endif
+
+	/*
+		Brings the entry for the file szName of the logging folder in the files list index
+		in line with the folder. Whether the file exists is checked instead of relying on
+		the type of the notification. This makes it irrelevant if the change has already
+		been applied by cunilog itself, or if the file has been changed again since.
+	*/
+	static void updateFLSindexEntry (CUNILOG_TARGET *put, const char *szName)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert_non_NULL (szName);
 
-		logFromInsideRotatorTextU8fmt (put, "Moving obsolete logfile \"%s\" to recycle bin...\n", put->mbFilToRotate.buf.pcc);
-		if (LIBTRASHCAN_SUCCESS == trashcan_soft_delete_apple (put->mbFilToRotate.buf.pcc))
-		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" moved to recycle bin.\n", put->mbFilToRotate.buf.pcc);
-			vec_splice (&put->fls, put->prargs->idx, 1);
-		} else
-		{
-			logFromInsideRotatorTextU8fmt (put, "Error while attempting to move obsolete logfile \"%s\" to recycle bin.\n", put->mbFilToRotate.buf.pcc);
-		}
-	}
+		size_t ln = strlen (szName);
+		if (!matchWildcardPattern (szName, ln, put->mbLogFileMask.buf.pcc, put->lnLogFileMask))
+			return;
+		if (!isLogfileOrExtCompressedName (put, szName, ln))
+			return;
 
-#elif defined (OS_IS_LINUX)
+		struct stat	st;
+		size_t		idx;
+		int			fd			= cunilogLogFoldFD (put);
+		bool		bExists		= -1 != fd && 0 == fstatat (fd, szName, &st, AT_SYMLINK_NOFOLLOW);
+		if (bExists)
+			insertIntoFLSindex (put, szName, ln + 1);
+		else
+		if (findInFLSindex (put, szName, ln + 1, &idx))
+			removeFromFLS (put, idx);
+	}
 
-	static void MoveFileToRecycleBinLnx (CUNILOG_TARGET *put)
+	/*
+		Applies the pending inotify notifications to the files list index. If the kernel
+		dropped notifications or the logging folder itself has been moved or deleted, the
+		index is discarded to be built again from disk. In the latter case, the folder is
+		not watched anymore.
+	*/
+	static void applyFLSwatchEvents (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (-1 != put->fdFLSwatch);
 
-		logFromInsideRotatorTextU8fmt (put, "Moving obsolete logfile \"%s\" to recycle bin...\n", put->mbFilToRotate.buf.pcc);
-		bool b = MoveFileToTrashPOSIX (put->mbFilToRotate.buf.pcc);
-		if (b)
+		union
 		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" moved to recycle bin.\n", put->mbFilToRotate.buf.pcc);
-			vec_splice (&put->fls, put->prargs->idx, 1);
-		} else
+			struct inotify_event	ev;
+			char					buf [CUNILOG_FLS_WATCH_BUF_SIZE];
+		} u;
+		bool	bResync		= false;
+		bool	bUnwatch	= false;
+		ssize_t	r;
+
+		while (0 < (r = read (put->fdFLSwatch, u.buf, sizeof (u.buf))))
 		{
-			char szErr [CUNILOG_STD_MSG_SIZE];
-			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt (put, "Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szErr, put->mbFilToRotate.buf.pcc);
+			const char *p = u.buf;
+			while (p < u.buf + r)
+			{
+				const struct inotify_event *pev = (const struct inotify_event *) p;
+				p += sizeof (struct inotify_event) + pev->len;
+
+				if (pev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+					bUnwatch = true;
+				if (pev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_Q_OVERFLOW))
+					bResync = true;
+				else
+				if (pev->len && !bResync)
+					updateFLSindexEntry (put, pev->name);
+			}
 		}
+		if (bUnwatch)
+			DoneCUNILOG_TARGETflsWatch (put);
+		if (bResync)
+			cunilogResetFilesList (put);
 	}
-
-#else
-
-	#error To do!!!
-
 #endif
 
 /*
-	Platform-independent wrapper function.
+	Brings the files list index up to date before a rotator uses it.
 */
-static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put)
+static inline void updateFLSindex (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-	#if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
-		MoveFileToRecycleBinWin (put);
-	#elif defined (OS_IS_MACOS)
-		MoveFileToRecycleBinMac (put);
-	#elif defined (OS_IS_LINUX)
-		MoveFileToRecycleBinLnx (put);
-	#else
-		#error Not implemented yet!
+	if (!cunilogTargetHasFLSindexBuilt (put))
+		return;
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (put->pmt && cunilogAtomicXchgSize (&put->pmt->nResync, 0))
+		{	// The maintenance thread couldn't remove a logfile that isn't in the
+			//	index anymore.
+			cunilogResetFilesList (put);
+			return;
+		}
+	#endif
+	#ifdef CUNILOG_HAVE_INOTIFY
+		if (-1 != put->fdFLSwatch)
+			applyFLSwatchEvents (put);
 	#endif
+	if (cunilogTargetHasFLSindexBuilt (put) && CUNILOG_STD_BULK_ALLOC_SIZE < put->stFLSorphaned)
+		compactFLSindex (put);
 }
 
-#ifdef PLATFORM_IS_WINDOWS
-	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put)
-	{
-		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
-	
-		logFromInsideRotatorTextU8fmt (put, "Deleting obsolete logfile \"%s\"...\n", put->mbFilToRotate.buf.pch);
-		bool b = DeleteFileU8 (put->mbFilToRotate.buf.pch);
-		if (b)
-		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" deleted.\n", put->mbFilToRotate.buf.pch);
-			vec_splice (&put->fls, put->prargs->idx, 1);
-		} else
-		{
-			char szErr [CUNILOG_STD_MSG_SIZE];
-			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt (put, "Error %s while attempting to delete obsolete logfile \"%s\".\n", szErr, put->mbFilToRotate.buf.pch);
-		}
-	}
-#endif
+static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
 
-#ifdef PLATFORM_IS_POSIX
-	static void DeleteObsoleteLogfile (CUNILOG_TARGET *put)
+	if (cunilogTargetHasFLSindex (put))
+		updateFLSindex (put);
+	if (0 == put->fls.length && !cunilogTargetHasFLSindexBuilt (put))
 	{
-		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
-	
-		logFromInsideRotatorTextU8fmt (put, "Deleting obsolete logfile \"%s\"...\n", put->mbFilToRotate.buf.pch);
-		int i = unlink (put->mbFilToRotate.buf.pch);
-		if (0 == i)
-		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" deleted.\n", put->mbFilToRotate.buf.pch);
-		} else
-		{
-			logFromInsideRotatorTextU8fmt (put, "Error %d while attempting to delete obsolete logfile \"%s\".\n", errno, put->mbFilToRotate.buf.pch);
+		// The folder only shows the results of earlier jobs once they're done.
+		WaitForMaintenanceJobs (put);
+		#if defined (PLATFORM_IS_WINDOWS)
+			obtainLogfilesListToRotateWin (put);
+		#elif defined (PLATFORM_IS_POSIX)
+			obtainLogfilesListToRotatePsx (put);
+		#endif
+		if (cunilogTargetHasFLSindex (put))
+		{	// The index is kept sorted from now on, independent of the file system.
+			if (hasDotNumberPostfix (put))
+				vec_sort (&put->fls, flscmp_dotnum_index);
+			else
+				vec_sort (&put->fls, flscmp_default);
+			cunilogTargetSetFLSisSorted (put);
+			cunilogTargetSetFLSindexBuilt (put);
+		}
+		if (hasLogPostfix (put))
+		{	// Our current logfile is missing because the search mask wouldn't
+			//	pick it up. For hasDotNumberPostfix () the current logfile is
+			//	included, as well as for all other postfixes.
+			cunilogAddActiveLogfile (true, true, put);
+			//DebugOutputFilesList ("obtain", &put->fls);
 		}
+		cunilogTargetClrFLSreversed (put);
 	}
-#endif
+}
 
-#ifdef CUNILOG_BUILD_DEBUG_OUTPUT_FILES_LIST
-	static void DebugOutputFilesList (const char *szText, vec_cunilog_fls *pvec)
-	{
-		ubf_assert_non_NULL (pvec);
+bool ConfigCUNILOG_TARGETfilesListIndex (CUNILOG_TARGET *put, bool bWatchFolder)
+{
+	ubf_assert_non_NULL (put);
 
-		// Output from index 0 up to length. This is different from how the files
-		//	might be processed by a rotator.
-		size_t iFiles = 0;
-		if (szText)
-			printf ("\nDebugOutputFilesList (%s): %zu file(s)\n", szText, pvec->length);
-		else
-			printf ("\nDebugOutputFilesList: %zu file(s)\n", pvec->length);
-		while (iFiles < pvec->length)
+	// Whatever has been read from disk so far is read again for the index.
+	cunilogResetFilesList (put);
+	cunilogTargetSetFLSindex (put);
+	if (!bWatchFolder)
+		return true;
+
+	#ifdef CUNILOG_HAVE_INOTIFY
+		if (-1 == put->fdFLSwatch)
 		{
-			puts (pvec->data [iFiles].chFilename);
-			++ iFiles;
+			put->fdFLSwatch = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+			if (-1 == put->fdFLSwatch)
+				return false;
+			int wd = inotify_add_watch	(
+						put->fdFLSwatch, put->mbLogFold.buf.pcc, CUNILOG_FLS_WATCH_MASK
+										);
+			if (-1 == wd)
+			{
+				DoneCUNILOG_TARGETflsWatch (put);
+				return false;
+			}
 		}
-		puts ("");
-	}
-#else
-	#define DebugOutputFilesList(text, pvec)
-#endif
+		return true;
+	#else
+		return false;
+	#endif
+}
 
-static inline void performActualRotation (CUNILOG_ROTATOR_ARGS *prg)
+bool ConfigCUNILOG_TARGETrotateAtSize (CUNILOG_TARGET *put, uint64_t nOctets)
 {
-	ubf_assert_non_NULL (prg);
+	ubf_assert_non_NULL (put);
+	ubf_assert_msg (hasDotNumberPostfix (put), "Only supported for dot number postfixes.");
 
-	CUNILOG_PROCESSOR		*cup = prg->cup;
+	if (!hasDotNumberPostfix (put))
+		return false;
+	put->ullRotateAtSize = nOctets;
+	if (nOctets && !cunilogTargetHasFLSindex (put))
+	{
+		cunilogResetFilesList (put);
+		cunilogTargetSetFLSindex (put);
+	}
+	return true;
+}
+
+static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
 	ubf_assert_non_NULL (cup);
-	CUNILOG_ROTATION_DATA	*prd = cup->pData;
-	ubf_assert_non_NULL (prd);
-	CUNILOG_EVENT			*pev = prg->pev;
-	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL (pev);
+	
+	if (cunilogHasEventNoRotation (pev))
+		return true;
+
 	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
 	ubf_assert_non_NULL (put);
+	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+	ubf_assert_non_NULL (prd);
 
-	// Now the target knows exactly which rotator it is working on.
-	put->prargs = prg;
+	prd->nCnt = 0;
+
+	CUNILOG_ROTATOR_ARGS	args;
+	args.cup = cup;
+	args.pev = pev;
+
+	cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_ROTATOR, cup, pev);
+
+	if (cunilogrotationtask_RenameLogfiles == prd->tsk && hasDotNumberPostfix (put))
+		WaitForMaintenanceJobs (put);
+	obtainLogfilesListToRotate		(put);
+	DebugOutputFilesList ("cunilogProcessRotateLogfilesFnct", &put->fls);
 
 	switch (prd->tsk)
 	{
 		case cunilogrotationtask_None:
-			// This is a bug. We're normally not called in this case. See function
-			//	cunilogProcessRotateLogfiles ().
-			ubf_assert (false);
 			break;
-		case cunilogrotationtask_RenameLogfiles:
-			cunilogRenameLogfile (put);
+		case cunilogrotationtask_ExtCompressLogfiles:
+			// Compressed logfiles would not be renamed with the others.
+			ubf_assert_msg (!hasDotNumberPostfix (put), "Not supported with a dot number postfix.");
+			if (hasDotNumberPostfix (put))
+				break;
+			// Every logfile would fail to compress and stay.
+			ubf_assert_msg	(
+				ExtCompressorAvailable (rotatorCompressor (prd->uiFlgs)),
+				"Compressor not built in. See ExtCompressors.h."
+							);
+			if (!ExtCompressorAvailable (rotatorCompressor (prd->uiFlgs)))
+				break;
+			// The logfiles are compressed already.
+			if (put->wb.pfr)
+				break;
+			prapareLogfilesListAndRotate (&args);
 			break;
+		case cunilogrotationtask_RenameLogfiles:
+			if (!hasDotNumberPostfix (put) && !hasLogPostfix (put))
+				break;
 		case cunilogrotationtask_FScompressLogfiles:
-			cunilogFileSystemCompressLogfile (put);
-			break;
 		case cunilogrotationtask_MoveToRecycleBinLogfiles:
-			cunilogMoveFileToRecycleBin (put);
-			break;
 		case cunilogrotationtask_DeleteLogfiles:
-			cunilogDeleteObsoleteLogfile (put);
+			prapareLogfilesListAndRotate (&args);
+			break;
+		default:
+			ubf_assert_msg (false, "Internal error");
 			break;
 	}
 
-	// We're not in a rotator anymore.
-	put->prargs = NULL;
+	cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_ROTATOR, cup, pev);
+
+	return true;
 }
 
-static inline void prepareU8fullFileNameToRotate (CUNILOG_TARGET *put, size_t idx)
+/*
+	The custom processor. Its pData member is a pointer to a CUNILOG_CUSTPROCESS structure,
+	which has two members: pData for custom data and the function pointer procFnc, which
+	is the actual custom processor function. Without procFnc, the batch function procBatch
+	gets the event on its own, together with the current event line.
+*/
+static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
-	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+	
+	#ifdef DEBUG
+		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+		ubf_assert_non_NULL (put);
+	#endif
 
-	char	*strNam = put->fls.data [idx].chFilename;
-	size_t	sizName = put->fls.data [idx].stFilename;
+	CUNILOG_CUSTPROCESS	*pcu = cup->pData;
+	ubf_assert_non_NULL (pcu);
+	ubf_assert (pcu->procFnct || pcu->procBatch);
+	if (pcu->procFnct)
+		return pcu->procFnct (cup, pev);
 
-	growToSizeSMEMBUF (&put->mbFilToRotate, put->lnLogPath + sizName);
-	if (isUsableSMEMBUF (&put->mbFilToRotate))
-	{
-		memcpy (put->mbFilToRotate.buf.pch + put->lnLogPath, strNam, sizName);
-		put->stFilToRotate = put->lnLogPath + sizName;
-	}
+	CUNILOG_BATCHEVENT	be;
+	be.pev		= pev;
+	be.szLine	= pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
+	be.lnLine	= pev->pCUNILOG_TARGET->lnLogEventLine;
+	return pcu->procBatch (cup, &be, 1);
 }
 
-static inline int cmpflsnums (const char *sz1, size_t l1, const char *sz2, size_t l2)
+/*
+	The redirector processor. The event is redirected to a different CUNILOG_TARGET,
+	to which the pData member points to. When the event is redirected, the remaining
+	processors of the current target are ignored.
+
+	If pData is NULL, no redirection takes place and the remaining processors are worked
+	through as usual. Since this is most likely not what the caller intended, a debug
+	assertion expects pData not being NULL.
+*/
+static bool cunilogProcessTargetRedirectorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
-	const char *szo1 = sz1;
-	const char *szo2 = sz2;
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
 
-	while (szo1 [0] == szo2 [0])
-	{
-		++ szo1;
-		-- l1;
-		++ szo2;
-		-- l2;
+	CUNILOG_TARGET *put = cup->pData;
+	ubf_assert_non_NULL (put);
+
+	if (put)
+	{	// A batch function still needs the event, which means we redirect a copy.
+		if (cunilogIsEventDeferred (pev))
+		{
+			CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
+			if (pnev)
+				logEv (put, pnev);
+		} else
+			logEv (put, pev);
+		return false;
 	}
-	if (l1 || l2)
+	return true;
+}
+
+static bool cunilogProcessTargetForkFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+
+	CUNILOG_TARGET *put = cup->pData;
+	ubf_assert_non_NULL (put);
+
+	if (put)
 	{
-		// The shorter the greater, i.e. "file.9" is greater than "file.10".
-		if (l1 < l2)
-			return -1;
-		if (l1 > l2)
-			return 1;
-		if (isdigit (szo1 [0]) && isdigit (szo2 [0]))
+		CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
+		if (pnev)
 		{
-			uint64_t	ui1;
-			uint64_t	ui2;
-
-			//printf ("%s - %s\n", szo1, szo2);
-			ubf_uint64_from_str (&ui1, szo1);
-			ubf_uint64_from_str (&ui2, szo2);
-			if (ui1 == ui2)
-				return 0;
-			// "file.1" is greater than "file.2".
-			return ui1 > ui2 ? 1 : -1;
+			logEv (put, pnev);
 		}
 	}
-	return 0;
+	return true;
 }
 
 /*
-	Compare functions for vec_sort ().
-*/
-static int flscmp_dotnum (const void *p1, const void *p2)
+static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
-	const CUNILOG_FLS	*fls1 = p1;
-	const CUNILOG_FLS	*fls2 = p2;
-	int					r = 0;
-
-	ubf_assert_non_0 (fls1->stFilename);
-	ubf_assert_non_0 (fls2->stFilename);
+	ubf_assert_non_NULL (pev);
+	
+	CUNILOG_TARGET	*pta = pev->pCUNILOG_TARGET;
+	ubf_assert_non_NULL (pta);
 
-	r = cmpflsnums (fls1->chFilename, fls1->stFilename - 1, fls2->chFilename, fls2->stFilename - 1);
-	return r;
+	ubf_assert_msg (false, "Not supported yet!");
 }
+*/
 
-static int flscmp_default (const void *p1, const void *p2)
-{
-	const CUNILOG_FLS	*fls1 = p1;
-	const CUNILOG_FLS	*fls2 = p2;
-	int					r = 0;
+/*
+	Queue functions.
+*/
 
-	ubf_assert_non_0 (fls1->stFilename);
-	ubf_assert_non_0 (fls2->stFilename);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline size_t nToTrigger (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (cunilogHasDebugQueueLocked (put));
 
-	if (fls1->stFilename == fls2->stFilename)
+		if (cunilogTargetHasIsPaused (put))
+		{
+			++ put->nPausedEvents;
+			return 0;
+		} else
+		{	// Only the current event requires a trigger. The value of nPausedEvents
+			//	should have been zeroed out by ResumeLogCUNILOG_TARGET ().
+			ubf_assert_0 (put->nPausedEvents);
+			return 1;
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Without the locker ResumeLogCUNILOG_TARGET () might collect nPausedEvents just
+		before our increment. We therefore check the paused flag again afterwards. A
+		superfluous trigger only causes an empty round of the separate logging thread
+		while a missing one would leave the event in the queue.
+	*/
+	static inline size_t nToTriggerLockFree (CUNILOG_TARGET *put)
 	{
-		r = memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename - 1);
-		return r;
+		ubf_assert_non_NULL (put);
+
+		if (cunilogTargetHasIsPaused (put))
+		{
+			cunilogAtomicAddSize (&put->nPausedEvents, 1);
+			return cunilogTargetHasIsPaused (put) ? 0 : 1;
+		}
+		return 1;
 	}
-	if (fls1->stFilename < fls2->stFilename)
-	{	
-		r = memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename - 1);
-		return r ? r : -1;
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Internal events, command events, and the shutdown event are neither dropped nor
+		do they wait for space in the queue. Internal events are usually created by the
+		separate logging thread itself.
+	*/
+	static inline bool queueLimitAppliesToEvent (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+
+		return
+					put->nMaxQueuedEvents
+				&&	!cunilogIsEventInternal (pev)
+				&&	!cunilogIsEventShutdown (pev)
+				&&	cunilogEvtTypeCommand != pev->evType;
 	}
-	if (fls1->stFilename > fls2->stFilename)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool isEventBelowDropSeverity (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	{
-		r = memcmp (fls1->chFilename, fls2->chFilename, fls2->stFilename - 1);
-		return r ? r : 1;
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtSeverityXAmountEnumValues > pev->evSeverity);
+
+		return put->uiDropSeverities & ((uint32_t) 1 << pev->evSeverity);
 	}
-	return r;
-}
+#endif
 
-static inline bool needReverseFLS (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup)
-{
-	ubf_assert_non_NULL (put);
-	ubf_assert_non_NULL (cup);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void dropCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtSeverityXAmountEnumValues > pev->evSeverity);
 
-	CUNILOG_ROTATION_DATA	*prd = cup->pData;
-	
-	bool bRet;
-	bRet = hasDotNumberPostfix (put) && cunilogrotationtask_RenameLogfiles != prd->tsk;
-	return bRet;
-}
+		cunilogAtomicAddSize (&put->nDroppedEvents [pev->evSeverity], 1);
+		DoneCUNILOG_EVENT (NULL, pev);
+	}
+#endif
 
-/*
-	On NTFS, files are returned in descending alphabetical order.
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool isSeparateLoggingThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-	This means it is enough to just reverse the order, i.e. start with the last
-	file first and walk downwards, and this is what prapareLogfilesListAndRotate ()
-	does.
-	
-	Other file systems may also return files in descending alphabetical order,
-	but on file systems that return the files randomly we got to sort the vector
-	first. If sorting descending alphabetically is required, we expect the target option
-	flag CUNILOGTARGET_FS_NEEDS_SORTING.
+		#ifdef OS_IS_WINDOWS
+			return GetCurrentThreadId () == GetThreadId (put->th.hThread);
+		#else
+			return pthread_equal (pthread_self (), put->th.tThread);
+		#endif
+	}
+#endif
 
-	For the dot number postfix we need to sort in any case.
-*/
-static inline void sortLogfilesList (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup)
-{
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	/*
-	CUNILOG_ROTATION_DATA	*prd = cup->pData;
+		A producer can only wait for space in the queue if the separate logging thread is
+		going to empty it. It isn't while the target is paused, and it can't if the
+		producer is the separate logging thread itself. The new event is dropped instead.
+	*/
+	static inline bool canWaitForQueueSpace (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-	size_t iFiles = put->fls.length;
-	printf ("\nList sort in: %d\n", prd->tsk);
-	while (iFiles --)
+		return !cunilogTargetHasIsPaused (put) && !isSeparateLoggingThread (put);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void WaitForQueueSpace (CUNILOG_TARGET *put)
 	{
-		puts (put->fls.data [iFiles].chFilename);
+		ubf_assert_non_NULL (put);
+
+		#ifdef OS_IS_WINDOWS
+			DWORD dw = WaitForSingleObject (put->smQueueSpace.hSemaphore, INFINITE);
+			ubf_assert (WAIT_OBJECT_0 == dw);
+			UNUSED (dw);
+		#else
+			int i = sem_wait (&put->smQueueSpace.tSemaphore);
+			ubf_assert (0 == i);
+			UNUSED (i);
+		#endif
 	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called by the separate logging thread after it has emptied the queue. A producer
+		checks the amount of queued events and registers itself as waiting while it holds
+		the locker. Since we obtain the locker after the queue has been emptied, the
+		producer either sees the empty queue or we see its registration.
 	*/
+	static void WakeProducersWaitingForQueueSpace (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
 
-	if (cunilogTargetHasFSneedsSorting (put))
+		size_t n;
+
+		EnterCUNILOG_LOCKER (put);
+		n = put->nBlockedProducers;
+		put->nBlockedProducers = 0;
+		LeaveCUNILOG_LOCKER (put);
+		if (n)
+		{
+			#ifdef OS_IS_WINDOWS
+				bool b = ReleaseSemaphore (put->smQueueSpace.hSemaphore, (LONG) n, NULL);
+				ubf_assert_true (b);
+				UNUSED (b);
+			#else
+				int i;
+				while (n)
+				{
+					i = sem_post (&put->smQueueSpace.tSemaphore);
+					ubf_assert (0 == i);
+					-- n;
+				}
+				UNUSED (i);
+			#endif
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Drops the oldest queued event the queue limit applies to. If bBelowSeverityOnly
+		is true, only events below the drop severity threshold are considered. The caller
+		holds the locker. Returns false if the queue doesn't contain such an event.
+	*/
+	static bool dropOldestQueuedCUNILOG_EVENT (CUNILOG_TARGET *put, bool bBelowSeverityOnly)
 	{
-		if (!cunilogTargetHasFLSisSorted (put))
+		ubf_assert_non_NULL (put);
+		ubf_assert (cunilogHasDebugQueueLocked (put));
+
+		CUNILOG_EVENT	*prv	= NULL;
+		CUNILOG_EVENT	*pev	= put->qu.first;
+
+		while	(
+						pev
+					&&	(
+								!queueLimitAppliesToEvent (put, pev)
+							||	(bBelowSeverityOnly && !isEventBelowDropSeverity (put, pev))
+						)
+				)
 		{
-			if (hasDotNumberPostfix (put))
-				vec_sort (&put->fls, flscmp_dotnum);
-			else
-				vec_sort (&put->fls, flscmp_default);
-			cunilogTargetSetFLSisSorted (put);
+			prv = pev;
+			pev = pev->next;
 		}
+		if (NULL == pev)
+			return false;
+		if (prv)
+			prv->next		= pev->next;
+		else
+			put->qu.first	= pev->next;
+		if (put->qu.last == pev)
+			put->qu.last	= prv;
+		put->qu.num			-= 1;
+		dropCUNILOG_EVENT (put, pev);
+		return true;
 	}
+#endif
 
-	// The processor may need the files in reverse order.
-	bool bFLSreversedRequired = needReverseFLS (put, cup);
-	if (bFLSreversedRequired)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Applies the queue full policy of the target to the new event pev. The caller holds
+		the locker. Returns true if pev is to be enqueued, false if it has been dropped.
+	*/
+	static bool applyQueueFullPolicy (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	{
-		if (!cunilogTargetHasFLSreversed (put))
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogHasDebugQueueLocked (put));
+
+		while (put->qu.num >= put->nMaxQueuedEvents)
 		{
-			vec_reverse (&put->fls);
-			cunilogTargetSetFLSreversed (put);
+			switch (put->queueFullPolicy)
+			{
+				case cunilogQueueFullBlock:
+					if (!canWaitForQueueSpace (put))
+						goto DropNewest;
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+					break;
+				case cunilogQueueFullDropNewest:
+					goto DropNewest;
+				case cunilogQueueFullDropOldest:
+					if (!dropOldestQueuedCUNILOG_EVENT (put, false))
+						return true;
+					break;
+				case cunilogQueueFullDropBelowSeverity:
+					if (isEventBelowDropSeverity (put, pev))
+						goto DropNewest;
+					// An important event makes room by dropping the oldest less important
+					//	one. If there's none left, it waits like with cunilogQueueFullBlock.
+					if (dropOldestQueuedCUNILOG_EVENT (put, true))
+						break;
+					if (!canWaitForQueueSpace (put))
+						goto DropNewest;
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+					break;
+				default:
+					ubf_assert_msg (false, "Unknown queue full policy");
+					return true;
+			}
 		}
-	} else
+		return true;
+
+	DropNewest:
+		dropCUNILOG_EVENT (put, pev);
+		return false;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Lock-free version of applyQueueFullPolicy (). Since several producers can check
+		the amount of queued events at the same time, the capacity of the queue can be
+		exceeded by the amount of producers. Events can only be taken from the head of
+		a lock-free queue, which is why cunilogQueueFullDropOldest drops the new event,
+		and cunilogQueueFullDropBelowSeverity waits like cunilogQueueFullBlock for an
+		event that isn't below the drop severity threshold.
+	*/
+	static bool applyQueueFullPolicyLockFree (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	{
-		if (cunilogTargetHasFLSreversed (put))
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+
+		if (cunilogAtomicLoadSize (&put->qu.num) < put->nMaxQueuedEvents)
+			return true;
+		switch (put->queueFullPolicy)
 		{
-			vec_reverse (&put->fls);
-			cunilogTargetClrFLSreversed (put);
+			case cunilogQueueFullDropBelowSeverity:
+				if (isEventBelowDropSeverity (put, pev))
+					break;
+				// Falls through.
+				UBF_FALLTHROUGH_HINT
+			case cunilogQueueFullBlock:
+				if (!canWaitForQueueSpace (put))
+					break;
+				EnterCUNILOG_LOCKER (put);
+				while (cunilogAtomicLoadSize (&put->qu.num) >= put->nMaxQueuedEvents)
+				{
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+				}
+				LeaveCUNILOG_LOCKER (put);
+				return true;
+			case cunilogQueueFullDropNewest:
+			case cunilogQueueFullDropOldest:
+				break;
+			default:
+				ubf_assert_msg (false, "Unknown queue full policy");
+				return true;
 		}
+		dropCUNILOG_EVENT (put, pev);
+		return false;
 	}
+#endif
 
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	/*
-	printf ("\nList sort out: %d\n", prd->tsk);
-	iFiles = put->fls.length;
-	while (iFiles --)
+		Pushes the event onto the lock-free queue. Producers never block. The events are
+		linked from the most recent one to the oldest one. The member num is incremented
+		before the event is pushed so that it never falls below the actual amount of
+		queued events. See EnqueueCUNILOG_EVENT () for pbDropped.
+	*/
+	static inline size_t EnqueueLockFreeCUNILOG_EVENT (CUNILOG_EVENT *pev, bool *pbDropped)
 	{
-		puts (put->fls.data [iFiles].chFilename);
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (cunilogHasLockFreeQueue (put));
+
+		if (0 == pev->stamp)
+			pev->stamp = cunilogLocalTimestamp (put);
+		ubf_assert_non_0 (pev->stamp);
+
+		if (queueLimitAppliesToEvent (put, pev) && !applyQueueFullPolicyLockFree (put, pev))
+		{
+			if (pbDropped)
+				*pbDropped = true;
+			return 0;
+		}
+
+		cunilogAtomicAddSize (&put->qu.num, 1);
+		CUNILOG_EVENT *head = cunilogAtomicLoadEvt (&put->qu.head);
+		do
+		{
+			pev->next = head;
+		} while (!cunilogAtomicCasEvt (&put->qu.head, &head, pev));
+		return nToTriggerLockFree (put);
 	}
-	;
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns how many times the semaphore must be triggered to empty the queue. If
+		pbDropped isn't NULL, the bool it points to is set to true when the queue full
+		policy of the target has dropped the event. It is not touched otherwise.
 	*/
-}
+	static inline size_t EnqueueCUNILOG_EVENT (CUNILOG_EVENT *pev, bool *pbDropped)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
-static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
-{
-	ubf_assert_non_NULL (prg);
-	CUNILOG_EVENT			*pev = prg->pev;
-	ubf_assert_non_NULL (pev);
-	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
-	CUNILOG_PROCESSOR		*cup = prg->cup;
-	ubf_assert_non_NULL (cup);
-	CUNILOG_ROTATION_DATA	*prd = cup->pData;
-	ubf_assert_non_NULL (prd);
+		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
+		if (cunilogHasLockFreeQueue (put))
+			return EnqueueLockFreeCUNILOG_EVENT (pev, pbDropped);
 
-	//DebugOutputFilesList ("List in", cup, pev);
-	sortLogfilesList (put, cup);
+		size_t r;
 
-	uint64_t nToIgnore = prd->nIgnore + put->scuNPI.nIgnoredTotal;
-	uint64_t nMaxToRot;
+		EnterCUNILOG_LOCKER (put);
 
-	if (cunilogrotationtask_RenameLogfiles == prd->tsk && hasLogPostfix (put))
-	{	// This should all have been taken care of before we're called.
-		ubf_assert (cunilogProcessRotateLogfiles == cup->task);
-		ubf_assert (hasLogPostfix (put));
+		// In this case it's more of an enqueuing date/timestamp than a creation date/timestamp.
+		if (0 == pev->stamp)
+		{
+			pev->stamp = cunilogLocalTimestamp (put);
+			ubf_assert_msg (false, "Actually not implemented yet");
+		}
+		ubf_assert_non_0 (pev->stamp);
 
-		nMaxToRot = 1;										// Only "<appname>.log" needs rotation.
-	} else
-	{
-		nMaxToRot =	CUNILOG_MAX_ROTATE_AUTO - nToIgnore <= prd->nMaxToRotate
-					?	prd->nMaxToRotate
-					:	nToIgnore + prd->nMaxToRotate;
+		if (queueLimitAppliesToEvent (put, pev) && !applyQueueFullPolicy (put, pev))
+		{
+			LeaveCUNILOG_LOCKER (put);
+			if (pbDropped)
+				*pbDropped = true;
+			return 0;
+		}
+
+		if (put->qu.first)
+		{
+			CUNILOG_EVENT *l	= put->qu.last;
+			ubf_assert_non_NULL (l);
+			ubf_assert_NULL (l->next);
+			l->next				= pev;
+			put->qu.last		= pev;
+			put->qu.num			+= 1;
+		} else
+		{
+			put->qu.first		= pev;
+			put->qu.last		= pev;
+			put->qu.num			= 1;
+		}
+		r = nToTrigger (put);
+		LeaveCUNILOG_LOCKER (put);
+		return r;
 	}
-	DebugOutputFilesList ("List out", &put->fls);
+#endif
 
-	size_t iFiles = put->fls.length;
-	while (iFiles --)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Enqueues the list of n events from first to last, linked via their ->next
+		members, with a single lock or compare-and-swap operation. The queue limit of
+		the target is not applied. Returns how many times the semaphore must be
+		triggered.
+	*/
+	static size_t EnqueueBatchCUNILOG_EVENTs	(
+					CUNILOG_TARGET		*put,
+					CUNILOG_EVENT		*first,
+					CUNILOG_EVENT		*last,
+					size_t				n
+												)
 	{
-		ubf_assert (iFiles < put->fls.length);
-		//puts (put->fls.data [iFiles].chFilename);
-		++ prd->nCnt;
-		if (prd->nCnt > nToIgnore)
-		{
-			if (prd->nCnt <= nMaxToRot)
-			{
-				/*
-				DebugOutputFilesList ("List", &put->fls);
-				puts ("File:");
-				puts (put->fls.data [iFiles].chFilename);
-				*/
-				prepareU8fullFileNameToRotate (put, iFiles);
-				//puts (put->fls.data [iFiles].chFilename);
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (first);
+		ubf_assert_non_NULL (last);
+		ubf_assert_NULL (last->next);
+		ubf_assert_non_0 (n);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
-				prg->nam = put->fls.data [iFiles].chFilename;
-				prg->siz = put->fls.data [iFiles].stFilename;
-				prg->idx = iFiles;
-				performActualRotation (prg);
-			} else
-				break;
-		} else
-		{	// This tells the next rotation processor how many we've ignored already.
-			++ put->scuNPI.nIgnoredTotal;
+		size_t r;
+
+		if (cunilogHasLockFreeQueue (put))
+		{	// The lock-free queue is linked from the most recent event to the
+			//	oldest one.
+			CUNILOG_EVENT *prv = NULL;
+			CUNILOG_EVENT *pev = first;
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt			= pev->next;
+				pev->next	= prv;
+				prv			= pev;
+				pev			= nxt;
+			}
+			cunilogAtomicAddSize (&put->qu.num, n);
+			CUNILOG_EVENT *head = cunilogAtomicLoadEvt (&put->qu.head);
+			do
+			{
+				first->next = head;
+			} while (!cunilogAtomicCasEvt (&put->qu.head, &head, last));
+			return nToTriggerLockFree (put);
 		}
+
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
+		{
+			ubf_assert_non_NULL (put->qu.last);
+			put->qu.last->next	= first;
+		} else
+			put->qu.first		= first;
+		put->qu.last			= last;
+		put->qu.num				+= n;
+		r = nToTrigger (put);
+		LeaveCUNILOG_LOCKER (put);
+		return r;
 	}
-	DebugOutputFilesList ("List out", &put->fls);
-}
+#endif
 
 /*
-	Returns true if the logfile name ends with ".log" or ".log.<number>".
+	We expect the caller to process the returned event only. However,
+	for consistency, i.e. to hide the rest of the queue from the caller,
+	the member ->next of the returned event is set to NULL.
+	This is to ensure the caller won't try to iterate further to the next
+	event accidentally.
+
+	This function is currently not used because we always empty the entire
+	queue with DequeueAllCUNILOG_EVENTs ().
 */
-static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
-{
-	ubf_assert_non_NULL	(pfls);
-	ubf_assert_non_NULL	(pfls->chFilename);
-	ubf_assert_non_0	(pfls->stFilename);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueCUNILOG_EVENT (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert_msg (!cunilogHasLockFreeQueue (put), "Not supported for lock-free queues");
 
-	size_t o = pfls->stFilename;
-	size_t d = 0;
+		CUNILOG_EVENT	*pev	= NULL;
 
-	if (o > lenCunilogLogFileNameExtension + 1)
-	{
-		o -= 2;												// NULL and 0 index.
-		while (o && isdigit (pfls->chFilename [o]))
-		{
-			-- o;
-			++ d;
-		}
-		if (d && o && '.' == pfls->chFilename [o])
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
 		{
-			-- o;
-			++ d;
-		}
-		char *szfn = pfls->chFilename + pfls->stFilename - sizCunilogLogFileNameExtension - d;
-		if (o > lenCunilogLogFileNameExtension)
+			ubf_assert_non_0 (put->qu.num);
+
+			pev				= put->qu.first;
+			put->qu.first	= pev->next;
+			pev->next		= NULL;
+			put->qu.num		-= 1;
+		} else
 		{
-			return	0 == memcmp	(
-							szCunilogLogFileNameExtension,
-							szfn,
-							lenCunilogLogFileNameExtension
-								);
+			ubf_assert_0	(put->qu.num);
+			ubf_assert_NULL	(put->qu.last);
 		}
+		LeaveCUNILOG_LOCKER (put);
+		return pev;
 	}
-	return false;
-}
+#endif
 
-#if defined (PLATFORM_IS_WINDOWS)
-	static bool obtainLogfilesListToRotateCallbackWin (SRDIRONEENTRYSTRUCT *psdE)
+/*
+	Takes the entire lock-free queue with a single atomic exchange. Since producers
+	push onto the head of the queue, the list is reversed to restore the order in which
+	the events were enqueued. Taking the queue this way is also safe if more than one
+	thread dequeues, for instance CancelCUNILOG_TARGET (), as every caller obtains its
+	own list.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllLockFreeCUNILOG_EVENTs (CUNILOG_TARGET *put)
 	{
-		ubf_assert_non_NULL (psdE);
-		CUNILOG_TARGET			*put = psdE->pCustom;
 		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (cunilogHasLockFreeQueue (put));
 
-		CUNILOG_FLS	fls;
-		fls.stFilename = psdE->stFileNameU8;
-		fls.chFilename = psdE->szFileNameU8;
-		if (hasDotNumberPostfix (put) && !endsLogFileNameWithDotNumber (&fls))
-			return true;
+		CUNILOG_EVENT	*pev	= cunilogAtomicXchgEvt (&put->qu.head, NULL);
+		CUNILOG_EVENT	*prv	= NULL;
+		CUNILOG_EVENT	*nxt;
+		size_t			n		= 0;
 
-		fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
-		ubf_assert_non_NULL (fls.chFilename);
-		if (fls.chFilename)
+		while (pev)
 		{
-			memcpy (fls.chFilename, psdE->szFileNameU8, fls.stFilename);
-			if (0 == put->fls.capacity)
-			{
-				if (-1 == vec_reserve (&put->fls, CUNILOG_STD_VECT_EXP_SIZE))
-					return false;
-			}
-			vec_push (&put->fls, fls);
+			nxt			= pev->next;
+			pev->next	= prv;
+			prv			= pev;
+			pev			= nxt;
+			++ n;
 		}
-		return true;
+		if (n)
+			cunilogAtomicSubSize (&put->qu.num, n);
+		return prv;
 	}
-#elif defined (PLATFORM_IS_POSIX)
-	static bool obtainLogfilesListToRotateCallbackPsx (SONEDIRENT *pod)
+#endif
+
+/*
+	We expect the caller to process the returned event and all its successors
+	until the end of the list. The member ->next of the last element of the
+	singly-linked list of events is NULL.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put)
 	{
-		ubf_assert_non_NULL (pod);
-		CUNILOG_TARGET			*put = pod->pCustom;
 		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
-		CUNILOG_FLS fls;
-		fls.stFilename = strlen (pod->dirEnt->d_name) + 1;
-		if	(
-				globMatch	(
-					pod->dirEnt->d_name, fls.stFilename - 1,
-					put->mbLogFileMask.buf.pcc, put->lnLogFileMask
-							)
-			)
+		if (cunilogHasLockFreeQueue (put))
+			return DequeueAllLockFreeCUNILOG_EVENTs (put);
+
+		CUNILOG_EVENT	*pev	= NULL;
+		CUNILOG_EVENT	*last;
+
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
 		{
-			fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
-			ubf_assert_non_NULL (fls.chFilename);
-			if (fls.chFilename)
-			{
-				memcpy (fls.chFilename, pod->dirEnt->d_name, fls.stFilename);
-				if (0 == put->fls.capacity)
-				{
-					if (-1 == vec_reserve (&put->fls, CUNILOG_STD_VECT_EXP_SIZE))
-						return false;
-				}
-				vec_push (&put->fls, fls);
-			}
+			ubf_assert_non_0 (put->qu.num);
+
+			pev				= put->qu.first;
+			last			= put->qu.last;
+			ubf_assert_NULL (last->next);
+
+			// The queue is now empty. The caller is required to process
+			//	all returned events.
+			put->qu.first	= NULL;
+			put->qu.last	= NULL;
+			put->qu.num		= 0;
+		} else
+		{
+			ubf_assert_0	(put->qu.num);
+			ubf_assert_NULL	(put->qu.last);
 		}
-		return true;
+		LeaveCUNILOG_LOCKER (put);
+		return pev;
 	}
 #endif
 
-#if defined (PLATFORM_IS_WINDOWS)
-	static void obtainLogfilesListToRotateWin (CUNILOG_TARGET *put)
-	{
-		ubf_assert_non_NULL	(put);
-		ubf_assert			(strlen (put->mbLogPath.buf.pcc)		== put->lnLogPath);
-		ubf_assert			(strlen (put->mbLogFileMask.buf.pcc)	== put->lnLogFileMask);
-
-		uint64_t		n;
-		/*
-		n = ForEachDirectoryEntryU8	(
-				put->mbLogFileMask.buf.pcc,					// Search mask.
-				obtainLogfilesListToRotateCallbackWin, put, NULL
-									);
-		*/
-		n = ForEachDirectoryEntryMaskU8	(
-				put->mbLogPath.buf.pcc,			put->lnLogPath,
-				put->mbLogFileMask.buf.pcc,		put->lnLogFileMask,
-				obtainLogfilesListToRotateCallbackWin,
-				put,
-				NULL
-										);
-		UNUSED (n);
-	}
-#elif defined (PLATFORM_IS_POSIX)
-	static void obtainLogfilesListToRotatePsx (CUNILOG_TARGET *put)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void triggerCUNILOG_EVENTloggingThread (CUNILOG_TARGET *put, size_t releaseCount)
 	{
-		ubf_assert_non_NULL	(put);
-		ubf_assert			(strlen (put->mbLogPath.buf.pcc)		== put->lnLogPath);
-		ubf_assert			(strlen (put->mbLogFileMask.buf.pcc)	== put->lnLogFileMask);
-
-		uint64_t n;
-		n = ForEachPsxDirEntry	(
-				put->mbLogFold.buf.pcc,						// Directory name.
-				obtainLogfilesListToRotateCallbackPsx, put, NULL
-								);
-		UNUSED (n);
-	}
-#endif
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (0 < releaseCount);						// Caller's responsibility.
 
-static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
-{
-	ubf_assert_non_NULL (put);
+		if (cunilogHasCoalescedWakeups (put))
+		{	// The separate logging thread takes over the entire queue when it wakes
+			//	up. If it isn't parked it's going to find our event(s) anyway.
+			if (0 == cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 0))
+				return;
+			releaseCount = 1;
+		}
+		cunilogAtomicAddSize (&put->nSepLogThreadPosts, releaseCount);
 
-	if (0 == put->fls.length)
-	{
-		#if defined (PLATFORM_IS_WINDOWS)
-			obtainLogfilesListToRotateWin (put);
-		#elif defined (PLATFORM_IS_POSIX)
-			obtainLogfilesListToRotatePsx (put);
+		#ifdef OS_IS_WINDOWS
+			LONG lPrevCount;
+			LONG relCount = (long) releaseCount;
+			bool b = ReleaseSemaphore (put->sm.hSemaphore, relCount, &lPrevCount);
+			UNREFERENCED_PARAMETER (b);
+			#ifdef DEBUG
+				ubf_assert_true (b);
+				if (false == b)
+				{
+					char szMsg [CUNILOG_STD_MSG_SIZE];
+					GetTextForLastError (szMsg);
+					szMsg [0] = szMsg [0];					// To have something to step to.
+				}
+			#endif
+		#else
+			int i;
+			while (releaseCount)
+			{
+				i = sem_post (&put->sm.tSemaphore);
+				ubf_assert (0 == i);
+				-- releaseCount;
+			}
+			UNREFERENCED_PARAMETER (i);
 		#endif
-		if (hasLogPostfix (put))
-		{	// Our current logfile is missing because the search mask wouldn't
-			//	pick it up. For hasDotNumberPostfix () the current logfile is
-			//	included, as well as for all other postfixes.
-			cunilogAddActiveLogfile (true, true, put);
-			//DebugOutputFilesList ("obtain", &put->fls);
-		}
-		cunilogTargetClrFLSreversed (put);
 	}
-}
-
-static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
-{
-	ubf_assert_non_NULL (put);
-
-	vec_clear (&put->fls);
-	EmptySBULKMEM (&put->sbm);
-	cunilogTargetClrFLSisSorted (put);
-}
+#endif
 
-static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (cup);
-	ubf_assert_non_NULL (pev);
-	
-	if (cunilogHasEventNoRotation (pev))
-		return true;
+/*
+	Per-thread staging buffers.
+
+	A producer thread collects its events in its own staging buffer and hands them over
+	to the queue of the target in batches, which takes the locker of the target, or
+	the compare-and-swap operation of the lock-free queue, and the semaphore post only
+	once per batch. The staging buffer of a thread is stored in thread-local storage.
+
+	A staging buffer is practically only ever accessed by its own thread. Instead of a
+	locker it is protected by its member nBusy, which costs a single atomic exchange per
+	staged event. Other threads only access the staging buffer to publish its events:
+	the separate logging thread when they have exceeded the maximum latency, and
+	ShutdownCUNILOG_TARGET ().
+
+	Locking order: the locker of the list of staging buffers (clStagings), then nBusy of
+	a staging buffer, then the locker of the target. The separate logging thread only
+	tries to obtain the first two as a producer that waits for space in a bounded queue
+	might hold them.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#define cunilogHasStagingBuffers(put)				\
+		((put)->bStaging)
+#endif
 
-	CUNILOG_TARGET			*put = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (put);
-	CUNILOG_ROTATION_DATA	*prd = cup->pData;
-	ubf_assert_non_NULL (prd);
+/*
+	A thread that stages events reads the clock only every CUNILOG_STAGING_CLOCK_EVENTS
+	events to check the maximum latency of its staging buffer. Idle threads are taken
+	care of by the separate logging thread anyway.
+*/
+#ifndef CUNILOG_STAGING_CLOCK_EVENTS
+#define CUNILOG_STAGING_CLOCK_EVENTS					(16)
+#endif
 
-	prd->nCnt = 0;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool TryEnterCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
 
-	CUNILOG_ROTATOR_ARGS	args;
-	args.cup = cup;
-	args.pev = pev;
+		return 0 == cunilogAtomicXchgSize (&ps->nBusy, 1);
+	}
 
-	cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_ROTATOR, cup, pev);
+	static inline void EnterCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
 
-	obtainLogfilesListToRotate		(put);
-	DebugOutputFilesList ("cunilogProcessRotateLogfilesFnct", &put->fls);
+		// Only held for the time it takes to publish a batch.
+		while (!TryEnterCUNILOG_STAGING (ps))
+			Sleep_ms (0);
+	}
 
-	switch (prd->tsk)
+	static inline void LeaveCUNILOG_STAGING (CUNILOG_STAGING *ps)
 	{
-		case cunilogrotationtask_None:
-			break;
-		case cunilogrotationtask_RenameLogfiles:
-			if (!hasDotNumberPostfix (put) && !hasLogPostfix (put))
-				break;
-		case cunilogrotationtask_FScompressLogfiles:
-		case cunilogrotationtask_MoveToRecycleBinLogfiles:
-		case cunilogrotationtask_DeleteLogfiles:
-			prapareLogfilesListAndRotate (&args);
-			break;
-		default:
-			ubf_assert_msg (false, "Internal error");
-			break;
+		ubf_assert_non_NULL (ps);
+
+		cunilogAtomicStoreSize (&ps->nBusy, 0);
 	}
+#endif
 
-	cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_ROTATOR, cup, pev);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_STAGING *getThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_true (put->tlsStaging.bCreated);
 
-	return true;
-}
+		#ifdef OS_IS_WINDOWS
+			return FlsGetValue (put->tlsStaging.dwFlsIndex);
+		#else
+			return pthread_getspecific (put->tlsStaging.tKey);
+		#endif
+	}
+#endif
 
-/*
-	The custom processor. Its pData member is a pointer to a CUNILOG_CUSTPROCESS structure,
-	which has two members: pData for custom data and the function pointer procFnc, which
-	is the actual custom processor function.
-*/
-static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (cup);
-	ubf_assert_non_NULL (pev);
-	
-	#ifdef DEBUG
-		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool setThreadCUNILOG_STAGING (CUNILOG_TARGET *put, CUNILOG_STAGING *ps)
+	{
 		ubf_assert_non_NULL (put);
-	#endif
+		ubf_assert_true (put->tlsStaging.bCreated);
 
-	CUNILOG_CUSTPROCESS	*pcu = cup->pData;
-	ubf_assert_non_NULL (pcu);
-	ubf_assert_non_NULL (pcu->procFnct);
-	return pcu->procFnct (cup, pev);
-}
+		#ifdef OS_IS_WINDOWS
+			return FlsSetValue (put->tlsStaging.dwFlsIndex, ps);
+		#else
+			return 0 == pthread_setspecific (put->tlsStaging.tKey, ps);
+		#endif
+	}
+#endif
 
-/*
-	The redirector processor. The event is redirected to a different CUNILOG_TARGET,
-	to which the pData member points to. When the event is redirected, the remaining
-	processors of the current target are ignored.
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events over to the queue of the target. The caller has entered
+		the staging buffer. If the queue is bounded, the events are enqueued
+		one by one to apply the queue full policy to each of them.
 
-	If pData is NULL, no redirection takes place and the remaining processors are worked
-	through as usual. Since this is most likely not what the caller intended, a debug
-	assertion expects pData not being NULL.
-*/
-static bool cunilogProcessTargetRedirectorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (cup);
-	ubf_assert_non_NULL (pev);
+		The separate logging thread can't wait for space in the queue. The producers of
+		the events it publishes would have waited under the cunilogQueueFullBlock policy,
+		which is why the queue limit is not applied to them in this case.
+	*/
+	static void PublishCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
+
+		CUNILOG_TARGET	*put	= ps->put;
+		CUNILOG_EVENT	*pev	= ps->first;
+		CUNILOG_EVENT	*lst	= ps->last;
+		size_t			num		= ps->num;
+		size_t			n;
+
+		ps->first	= NULL;
+		ps->last	= NULL;
+		ps->num		= 0;
+		ps->octets	= 0;
+		ps->nUnclocked	= 0;
+		if (NULL == pev)
+			return;
 
-	CUNILOG_TARGET *put = cup->pData;
-	ubf_assert_non_NULL (put);
+		if	(
+					put->nMaxQueuedEvents
+				&&	!(cunilogQueueFullBlock == put->queueFullPolicy && isSeparateLoggingThread (put))
+			)
+		{
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt			= pev->next;
+				pev->next	= NULL;
+				n = EnqueueCUNILOG_EVENT (pev, NULL);
+				if (n)
+					triggerCUNILOG_EVENTloggingThread (put, n);
+				pev = nxt;
+			}
+			return;
+		}
+		n = EnqueueBatchCUNILOG_EVENTs (put, pev, lst, num);
+		if (n)
+			triggerCUNILOG_EVENTloggingThread (put, n);
+	}
+#endif
 
-	if (put)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Unlinks the staging buffer ps from its target and destroys it. If bPublish is
+		true, its events are handed over to the queue of the target first, otherwise
+		they are discarded.
+	*/
+	static void DoneCUNILOG_STAGING (CUNILOG_STAGING *ps, bool bPublish)
 	{
-		logEv (put, pev);
-		return false;
-	}
-	return true;
-}
+		ubf_assert_non_NULL (ps);
 
-static bool cunilogProcessTargetForkFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (cup);
-	ubf_assert_non_NULL (pev);
+		CUNILOG_TARGET	*put	= ps->put;
+		CUNILOG_STAGING	**pps;
 
-	CUNILOG_TARGET *put = cup->pData;
-	ubf_assert_non_NULL (put);
+		EnterLocker (&put->clStagings);
+		pps = &put->stagings;
+		while (*pps && *pps != ps)
+			pps = &(*pps)->nextStaging;
+		ubf_assert (*pps == ps);
+		if (*pps)
+			*pps = ps->nextStaging;
+		LeaveLocker (&put->clStagings);
 
-	if (put)
-	{
-		CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
-		if (pnev)
+		if (bPublish)
 		{
-			logEv (put, pev);
+			EnterCUNILOG_STAGING (ps);
+			PublishCUNILOG_STAGING (ps);
+			LeaveCUNILOG_STAGING (ps);
+		} else
+		{
+			CUNILOG_EVENT *pev = ps->first;
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt = pev->next;
+				DoneCUNILOG_EVENT (NULL, pev);
+				pev = nxt;
+			}
 		}
+		ubf_free (ps);
 	}
-	return true;
-}
-
-/*
-static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (pev);
-	
-	CUNILOG_TARGET	*pta = pev->pCUNILOG_TARGET;
-	ubf_assert_non_NULL (pta);
+#endif
 
-	ubf_assert_msg (false, "Not supported yet!");
-}
-*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when a thread that has a staging buffer exits. On Windows this might also
+		be called by FlsFree () from DoneCUNILOG_TARGETstaging (), when the separate
+		logging thread has already ended.
+	*/
+	#ifdef OS_IS_WINDOWS
+		static VOID WINAPI StagingThreadExit (PVOID pv)
+	#else
+		static void StagingThreadExit (void *pv)
+	#endif
+	{
+		CUNILOG_STAGING *ps = pv;
 
-/*
-	Queue functions.
-*/
+		if (ps)
+			DoneCUNILOG_STAGING (ps, !cunilogTargetHasShutdownCompleteFlag (ps->put));
+	}
+#endif
 
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline size_t nToTrigger (CUNILOG_TARGET *put)
+	static CUNILOG_STAGING *CreateThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert (cunilogHasDebugQueueLocked (put));
 
-		if (cunilogTargetHasIsPaused (put))
+		CUNILOG_STAGING *ps = ubf_malloc (sizeof (CUNILOG_STAGING));
+		if (NULL == ps)
 		{
-			++ put->nPausedEvents;
-			return 0;
-		} else
-		{	// Only the current event requires a trigger. The value of nPausedEvents
-			//	should have been zeroed out by ResumeLogCUNILOG_TARGET ().
-			ubf_assert_0 (put->nPausedEvents);
-			return 1;
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return NULL;
+		}
+		ps->put			= put;
+		ps->nBusy		= 0;
+		ps->first		= NULL;
+		ps->last		= NULL;
+		ps->num			= 0;
+		ps->octets		= 0;
+		ps->nUnclocked	= 0;
+		ps->ullFirst	= 0;
+		if (!setThreadCUNILOG_STAGING (put, ps))
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_THREAD_LOCAL_STORAGE);
+			ubf_free (ps);
+			return NULL;
 		}
+		EnterLocker (&put->clStagings);
+		ps->nextStaging	= put->stagings;
+		put->stagings	= ps;
+		LeaveLocker (&put->clStagings);
+		return ps;
 	}
 #endif
 
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	// Returns how many times the semaphore must be triggered to empty the queue.
-	static inline size_t EnqueueCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	static inline bool isStageableCUNILOG_EVENT (CUNILOG_EVENT *pev)
 	{
 		ubf_assert_non_NULL (pev);
-		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
-		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		return
+					!cunilogIsEventInternal (pev)
+				&&	!cunilogIsEventShutdown (pev)
+				&&	cunilogEvtTypeCommand != pev->evType;
+	}
+#endif
 
-		size_t r;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Adds the event to the staging buffer of the current thread. Returns false if the
+		event could not be staged, in which case the caller enqueues it as usual. This is
+		also the case when ShutdownCUNILOG_TARGET () has flushed the staging buffers
+		already, as nothing would hand over the event to the queue anymore.
+	*/
+	static bool StageCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
-		EnterCUNILOG_LOCKER (put);
+		CUNILOG_TARGET	*put	= pev->pCUNILOG_TARGET;
+		CUNILOG_STAGING	*ps		= getThreadCUNILOG_STAGING (put);
+		bool			bPublish;
 
-		// In this case it's more of an enqueuing date/timestamp than a creation date/timestamp.
+		if (NULL == ps)
+		{
+			ps = CreateThreadCUNILOG_STAGING (put);
+			if (NULL == ps)
+				return false;
+		}
 		if (0 == pev->stamp)
+			pev->stamp = cunilogLocalTimestamp (put);
+		ubf_assert_NULL (pev->next);
+
+		EnterCUNILOG_STAGING (ps);
+		// Set before ShutdownCUNILOG_TARGET () enters the staging buffers to flush them.
+		if (put->bStagingClosed)
 		{
-			pev->stamp = LocalTime_UBF_TIMESTAMP ();
-			ubf_assert_msg (false, "Actually not implemented yet");
+			ubf_assert_NULL (ps->first);
+			LeaveCUNILOG_STAGING (ps);
+			return false;
 		}
-		ubf_assert_non_0 (pev->stamp);
+		if (ps->last)
+			ps->last->next	= pev;
+		else
+		{
+			ps->first		= pev;
+			ps->ullFirst	= GetSystemTimeAsULONGLONGrel ();
+			ps->nUnclocked	= 0;
+		}
+		ps->last		= pev;
+		ps->num			+= 1;
+		ps->octets		+= pev->lenDataToLog;
+		bPublish = ps->num >= put->nStagingEvents || ps->octets >= put->nStagingOctets;
+		if (!bPublish && CUNILOG_STAGING_CLOCK_EVENTS <= ++ ps->nUnclocked)
+		{
+			ps->nUnclocked = 0;
+			bPublish =		GetSystemTimeAsULONGLONGrel () - ps->ullFirst
+						>=	put->ullStagingLatency;
+		}
+		if (bPublish)
+			PublishCUNILOG_STAGING (ps);
+		LeaveCUNILOG_STAGING (ps);
+		return true;
+	}
+#endif
 
-		if (put->qu.first)
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events of the current thread over to the queue of the target.
+		Called before an event that can't be staged is enqueued, so that the events of a
+		thread stay in order.
+	*/
+	static inline void FlushThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_STAGING *ps = getThreadCUNILOG_STAGING (put);
+		if (ps)
 		{
-			CUNILOG_EVENT *l	= put->qu.last;
-			ubf_assert_non_NULL (l);
-			ubf_assert_NULL (l->next);
-			l->next				= pev;
-			put->qu.last		= pev;
-			put->qu.num			+= 1;
+			EnterCUNILOG_STAGING (ps);
+			PublishCUNILOG_STAGING (ps);
+			LeaveCUNILOG_STAGING (ps);
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events of all threads over to the queue of the target. If
+		bStaleOnly is true, only staging buffers whose oldest event has exceeded the
+		maximum latency are published, and busy staging buffers are skipped. This is
+		what the separate logging thread does. Otherwise no further events are staged
+		afterwards.
+	*/
+	static void FlushCUNILOG_STAGINGs (CUNILOG_TARGET *put, bool bStaleOnly)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_STAGING	*ps;
+		uint64_t		ullNow;
+
+		if (bStaleOnly)
+		{
+			if (!TryEnterLocker (&put->clStagings))
+				return;
 		} else
 		{
-			put->qu.first		= pev;
-			put->qu.last		= pev;
-			put->qu.num			= 1;
+			EnterLocker (&put->clStagings);
+			// Producers check this after they've entered their staging buffer.
+			put->bStagingClosed = true;
+		}
+		ullNow = GetSystemTimeAsULONGLONGrel ();
+		for (ps = put->stagings; ps; ps = ps->nextStaging)
+		{
+			if (bStaleOnly)
+			{
+				if (!TryEnterCUNILOG_STAGING (ps))
+					continue;
+				if (ps->num && ullNow - ps->ullFirst >= put->ullStagingLatency)
+					PublishCUNILOG_STAGING (ps);
+			} else
+			{
+				EnterCUNILOG_STAGING (ps);
+				PublishCUNILOG_STAGING (ps);
+			}
+			LeaveCUNILOG_STAGING (ps);
+		}
+		LeaveLocker (&put->clStagings);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETstaging (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->tlsStaging.bCreated)
+		{
+			put->bStaging = false;
+			#ifdef OS_IS_WINDOWS
+				FlsFree (put->tlsStaging.dwFlsIndex);
+			#else
+				pthread_key_delete (put->tlsStaging.tKey);
+			#endif
+			put->tlsStaging.bCreated = false;
+			while (put->stagings)
+				DoneCUNILOG_STAGING (put->stagings, false);
+			DoneLocker (&put->clStagings);
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETstagingBuffers	(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		if (!HAS_CUNILOG_TARGET_A_QUEUE (put))
+			return false;
+		if (!put->tlsStaging.bCreated)
+		{
+			#ifdef OS_IS_WINDOWS
+				put->tlsStaging.dwFlsIndex = FlsAlloc (StagingThreadExit);
+				put->tlsStaging.bCreated = FLS_OUT_OF_INDEXES != put->tlsStaging.dwFlsIndex;
+			#else
+				put->tlsStaging.bCreated =
+					0 == pthread_key_create (&put->tlsStaging.tKey, StagingThreadExit);
+			#endif
+			if (!put->tlsStaging.bCreated)
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_THREAD_LOCAL_STORAGE);
+				return false;
+			}
+			InitLocker (&put->clStagings);
 		}
-		r = nToTrigger (put);
-		LeaveCUNILOG_LOCKER (put);
-		return r;
+		put->nStagingEvents		= nEvents ? nEvents : SIZE_MAX;
+		put->nStagingOctets		= nOctets ? nOctets : SIZE_MAX;
+		// FILETIME units are 100 ns.
+		put->ullStagingLatency	= msLatency ? (uint64_t) msLatency * 10000 : UINT64_MAX;
+		put->bStaging			= 1 < nEvents || nOctets || msLatency;
+		return true;
 	}
 #endif
 
-/*
-	We expect the caller to process the returned event only. However,
-	for consistency, i.e. to hide the rest of the queue from the caller,
-	the member ->next of the returned event is set to NULL.
-	This is to ensure the caller won't try to iterate further to the next
-	event accidentally.
-
-	This function is currently not used because we always empty the entire
-	queue with DequeueAllCUNILOG_EVENTs ().
-*/
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueCUNILOG_EVENT (CUNILOG_TARGET *put)
+	static inline bool SepLogThreadQueueIsEmpty (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
-		CUNILOG_EVENT	*pev	= NULL;
+		bool bEmpty;
 
+		if (cunilogHasLockFreeQueue (put))
+			return NULL == cunilogAtomicLoadEvt (&put->qu.head);
 		EnterCUNILOG_LOCKER (put);
-		if (put->qu.first)
-		{
-			ubf_assert_non_0 (put->qu.num);
-
-			pev				= put->qu.first;
-			put->qu.first	= pev->next;
-			pev->next		= NULL;
-			put->qu.num		-= 1;
-		} else
-		{
-			ubf_assert_0	(put->qu.num);
-			ubf_assert_NULL	(put->qu.last);
-		}
+		bEmpty = NULL == put->qu.first;
 		LeaveCUNILOG_LOCKER (put);
-		return pev;
+		return bEmpty;
 	}
 #endif
 
 /*
-	We expect the caller to process the returned event and all its successors
-	until the end of the list. The member ->next of the last element of the
-	singly-linked list of events is NULL.
+	With staging buffers the separate logging thread wakes up after the maximum latency
+	at the latest to publish the staging buffers of threads that stopped logging. With
+	data in the write-behind buffer it wakes up when the data has reached its maximum
+	age. The function returns the time to wait in FILETIME units, or UINT64_MAX if the
+	separate logging thread can wait for the next event forever.
 */
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put)
+	static uint64_t SepLogThreadWaitTimeout (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
-
-		CUNILOG_EVENT	*pev	= NULL;
-		CUNILOG_EVENT	*last;
-
-		EnterCUNILOG_LOCKER (put);
-		if (put->qu.first)
-		{
-			ubf_assert_non_0 (put->qu.num);
 
-			pev				= put->qu.first;
-			last			= put->qu.last;
-			ubf_assert_NULL (last->next);
+		uint64_t	ullTimeout	= UINT64_MAX;
+		uint64_t	ullAge;
 
-			// The queue is now empty. The caller is required to process
-			//	all returned events.
-			put->qu.first	= NULL;
-			put->qu.last	= NULL;
-			put->qu.num		= 0;
-		} else
+		if (cunilogHasStagingBuffers (put))
+			ullTimeout = put->ullStagingLatency;
+		if (put->wb.len && UINT64_MAX != put->wb.ullLatency)
 		{
-			ubf_assert_0	(put->qu.num);
-			ubf_assert_NULL	(put->qu.last);
+			ullAge = GetSystemTimeAsULONGLONGrel () - put->wb.ullFirst;
+			if (ullAge >= put->wb.ullLatency)
+				return 0;
+			if (put->wb.ullLatency - ullAge < ullTimeout)
+				ullTimeout = put->wb.ullLatency - ullAge;
 		}
-		LeaveCUNILOG_LOCKER (put);
-		return pev;
+		return ullTimeout;
 	}
 #endif
 
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline void triggerCUNILOG_EVENTloggingThread (CUNILOG_TARGET *put, size_t releaseCount)
+	static bool SepLogThreadTimedWaitForEvents (CUNILOG_TARGET *put, uint64_t ullTimeout)
 	{
 		ubf_assert_non_NULL (put);
 		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
-		ubf_assert (0 < releaseCount);						// Caller's responsibility.
+
+		// FILETIME units are 100 ns. Rounded up to not wake up too early.
+		uint64_t ms = (ullTimeout + 9999) / 10000;
 
 		#ifdef OS_IS_WINDOWS
-			LONG lPrevCount;
-			LONG relCount = (long) releaseCount;
-			bool b = ReleaseSemaphore (put->sm.hSemaphore, relCount, &lPrevCount);
-			UNREFERENCED_PARAMETER (b);
-			#ifdef DEBUG
-				ubf_assert_true (b);
-				if (false == b)
-				{
-					char szMsg [CUNILOG_STD_MSG_SIZE];
-					GetTextForLastError (szMsg);
-					szMsg [0] = szMsg [0];					// To have something to step to.
-				}
-			#endif
+			DWORD dw = WaitForSingleObject (put->sm.hSemaphore, (DWORD) ms);
+			ubf_assert (WAIT_OBJECT_0 == dw || WAIT_TIMEOUT == dw);
+			return WAIT_OBJECT_0 == dw || WAIT_TIMEOUT == dw;
 		#else
-			int i;
-			while (releaseCount)
+			struct timespec ts;
+			clock_gettime (CLOCK_REALTIME, &ts);
+			ts.tv_sec	+= (time_t) (ms / 1000);
+			ts.tv_nsec	+= (long) (ms % 1000) * 1000000;
+			if (ts.tv_nsec >= 1000000000)
 			{
-				i = sem_post (&put->sm.tSemaphore);
-				ubf_assert (0 == i);
-				-- releaseCount;
+				ts.tv_sec	+= 1;
+				ts.tv_nsec	-= 1000000000;
 			}
-			UNREFERENCED_PARAMETER (i);
+			int i = sem_timedwait (&put->sm.tSemaphore, &ts);
+			ubf_assert (0 == i || ETIMEDOUT == errno || EINTR == errno);
+			return 0 == i || ETIMEDOUT == errno || EINTR == errno;
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool SepLogThreadTryWaitForEvents (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		#ifdef OS_IS_WINDOWS
+			return WAIT_OBJECT_0 == WaitForSingleObject (put->sm.hSemaphore, 0);
+		#else
+			return 0 == sem_trywait (&put->sm.tSemaphore);
 		#endif
 	}
 #endif
@@ -26257,6 +32481,13 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 /*
 	The calling thread loops as long as we return true. The calling thread exits
 	when we return false.
+
+	We always announce that we're about to park, even without coalesced wake-ups, as
+	the flag CUNILOGTARGET_COALESCE_WAKEUPS might only get set after we started waiting.
+	With coalesced wake-ups we check the queue a last time afterwards. A producer
+	enqueues its event before it takes the idle flag away from us. Either we see its
+	event or it sees our flag and signals the semaphore, but we can't both miss each
+	other.
 */
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	static bool SepLogThreadWaitForEvents (CUNILOG_TARGET *put)
@@ -26264,6 +32495,27 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 		ubf_assert_non_NULL (put);
 		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
+		cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 1);
+		if (cunilogHasCoalescedWakeups (put))
+		{
+			if	(
+						!SepLogThreadQueueIsEmpty (put)
+					&&	1 == cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 0)
+				)
+				return true;
+			// Either the queue is empty or a producer has already taken the flag
+			//	and signalled (or is going to signal) the semaphore.
+		}
+		// A semaphore that is already signalled doesn't block and doesn't count as a
+		//	wake-up.
+		if (SepLogThreadTryWaitForEvents (put))
+			return true;
+		++ put->nSepLogThreadWakeups;
+
+		uint64_t ullTimeout = SepLogThreadWaitTimeout (put);
+		if (UINT64_MAX != ullTimeout)
+			return SepLogThreadTimedWaitForEvents (put, ullTimeout);
+
 		#ifdef OS_IS_WINDOWS
 			DWORD dw = WaitForSingleObject (put->sm.hSemaphore, INFINITE);
 			ubf_assert (WAIT_OBJECT_0 == dw);
@@ -26276,6 +32528,68 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 	}
 #endif
 
+/*
+	Called by the separate logging thread after it has processed all events it took off
+	the queue.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void SepLogThreadWriteBehind (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+		if	(
+					pwb->len
+				&&	(
+							cunilogWriteBehindEveryBatch == pwb->policy
+						||	(
+									UINT64_MAX != pwb->ullLatency
+								&&	GetSystemTimeAsULONGLONGrel () - pwb->ullFirst >= pwb->ullLatency
+							)
+					)
+			)
+		{
+			if (!cunilogWriteBehindToLogFile (put, NULL, 0))
+				SetCunilogSystemError (put, CUNILOG_ERROR_WRITING_LOGFILE);
+		}
+	}
+#endif
+
+/*
+	Called by the separate logging thread after it has processed all events it took off
+	the queue. The echo output of these events is written out and the processors with a
+	batch function get their events. The events they kept are destroyed afterwards.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void cunilogProcessBatch (CUNILOG_PROCESSOR *cup, CUNILOG_BATCH *pbt);
+
+	static void SepLogThreadCompleteBatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		cunilogFlushEchoBatch (put);
+		if (put->batches)
+		{
+			unsigned int n;
+			for (n = 0; n < put->nprocessors; ++ n)
+				cunilogProcessBatch (put->cprocessors [n], &put->batches [n]);
+		}
+		put->lnBatchLines	= 0;
+		put->pevBatchLine	= NULL;
+
+		CUNILOG_EVENT *pev = put->pevDeferred;
+		CUNILOG_EVENT *pnx;
+		while (pev)
+		{
+			pnx = pev->next;
+			DoneCUNILOG_EVENT (put, pev);
+			pev = pnx;
+		}
+		put->pevDeferred = NULL;
+	}
+#endif
+
 /*
 	The separate logging thread.
 */
@@ -26287,20 +32601,41 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 
 		while (SepLogThreadWaitForEvents (put))
 		{
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, true);
 			CUNILOG_EVENT *pev = DequeueAllCUNILOG_EVENTs (put);
 			CUNILOG_EVENT *pnx;
+			if (put->nMaxQueuedEvents)
+				WakeProducersWaitingForQueueSpace (put);
 			while (pev)
 			{	// Remember the next pointer because pev is going to be destroyed
 				//	by DoneSUNILOGEVENT ().
 				pnx = pev->next;
+				// Only events that reach the processors can be part of a batch.
+				if (!cunilogIsEventShutdown (pev) && cunilogEvtTypeCommand != pev->evType)
+					cunilogSetEventBatched (pev);
 				cunilogProcessEventSingleThreaded (pev);
-				DoneCUNILOG_EVENT (put, pev);
+				// Processing never destroys the event. If a batch function still needs
+				//	it, it's destroyed with the batch.
+				if (cunilogIsEventDeferred (pev) && put == pev->pCUNILOG_TARGET)
+				{
+					pev->next			= put->pevDeferred;
+					put->pevDeferred	= pev;
+				} else
+					DoneCUNILOG_EVENT (put, pev);
 				pev = pnx;
 			}
+			SepLogThreadCompleteBatch (put);
+			SepLogThreadWriteBehind (put);
 			if (cunilogTargetHasShutdownInitiatedFlag (put) && 0 == put->nPendingNoRotEvts )
 				goto ExitSeparateLoggingThread;
 		}
 	ExitSeparateLoggingThread:
+		StopMaintenanceThread (put);
+		if (!cunilogWriteBehindToLogFileAndWait (put))
+			SetCunilogSystemError (put, CUNILOG_ERROR_WRITING_LOGFILE);
+		if (put->nMaxQueuedEvents)
+			WakeProducersWaitingForQueueSpace (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return SEPARATE_LOGGING_THREAD_RETURN_SUCCESS;
 	}
@@ -26353,6 +32688,30 @@ static inline bool updateThresholdForAppliesToTimes (CUNILOG_PROCESSOR *cup)
 	return bRet;
 }
 
+/*
+	Returns true if the current event has made the active logfile of the target put points
+	to reach the size at which the rotator cup rotates. This is the threshold of a rotator
+	with the frequency cunilogProcessAppliesTo_nOctets, if it has one, or the size set with
+	ConfigCUNILOG_TARGETrotateAtSize ().
+
+	The size only triggers the rotator for the event that crosses it, or for the first
+	event written to a logfile that already exceeds it. Once a rotator has fired, a logfile
+	that stays over the size, for instance because it couldn't be renamed, doesn't trigger
+	it again with every subsequent event.
+*/
+static inline bool hasLogfileReachedRotationSize (CUNILOG_PROCESSOR *cup, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (put);
+
+	uint64_t ullMax	=		cunilogProcessAppliesTo_nOctets == cup->freq && cup->thr
+						?	cup->thr
+						:	put->ullRotateAtSize;
+	return		ullMax
+			&&	put->logfile.ullSizePrv < ullMax
+			&&	put->logfile.ullSizeEvt >= ullMax;
+}
+
 static inline bool updateCurrentValueAndIsThresholdReached	(
 								CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
 																	)
@@ -26361,7 +32720,8 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 	ubf_assert_non_NULL (pev);
 	ubf_assert (sizeof (uint64_t) == sizeof (UBF_TIMESTAMP));
 
-	bool bRet = false;
+	bool bRet		= false;
+	bool bFirst		= 0 == cup->thr;
 
 	cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
 	switch (cup->freq)
@@ -26372,6 +32732,11 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 			cup->thr = bRet ? 0 : cup->cur;
 			break;
 		case cunilogProcessAppliesTo_nOctets:
+			if (cunilogProcessRotateLogfiles == cup->task)
+			{	// The size check below decides.
+				cup->cur = pev->pCUNILOG_TARGET->logfile.ullSizeEvt;
+				break;
+			}
 			cup->cur += pev->lenDataToLog;
 			bRet = cup->cur >= cup->thr;
 			cup->thr = bRet ? 0 : cup->cur;
@@ -26419,6 +32784,15 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 	}
 	cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_THRESHOLD_UPDATE, cup, pev);
 
+	// The name of the logfile doesn't have a timestamp before this processor has run
+	//	once, even if the target doesn't run its processors on startup.
+	if (!bRet && bFirst && cunilogProcessUpdateLogFileName == cup->task)
+		bRet = true;
+
+	// Rotators also rotate when the active logfile has reached its maximum size.
+	if (!bRet && cunilogProcessRotateLogfiles == cup->task)
+		bRet = hasLogfileReachedRotationSize (cup, pev->pCUNILOG_TARGET);
+
 	// The flag OPT_CUNPROC_AT_STARTUP tells us to run the processor in any case.
 	if (optCunProcHasOPT_CUNPROC_AT_STARTUP (cup->uiOpts))
 	{
@@ -26446,42 +32820,311 @@ static bool (*pickAndRunProcessor [cunilogProcessXAmountEnumValues]) (CUNILOG_PR
 	/* cunilogProcessTargetFork			*/	,	cunilogProcessTargetForkFnct
 };
 
+static inline bool hasProcessorBatchFnct (CUNILOG_PROCESSOR *cp)
+{
+	ubf_assert_non_NULL (cp);
+
+	return	(
+					cunilogProcessCustomProcessor == cp->task
+				&&	cunilogProcessAppliesTo_nAlways == cp->freq
+				&&	cp->pData
+				&&	((CUNILOG_CUSTPROCESS *) cp->pData)->procBatch
+			);
+}
+
+/*
+	Only targets with a separate logging thread get batches. They're parallel to the
+	processor list and, like the plan, only allocated once.
+*/
+static bool allocateProcessorBatches (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (NULL == put->batches && HAS_CUNILOG_TARGET_A_QUEUE (put))
+		{
+			unsigned int n;
+			for (n = 0; n < put->nprocessors; ++ n)
+			{
+				if (hasProcessorBatchFnct (put->cprocessors [n]))
+				{
+					put->batches = ubf_calloc (put->nprocessors, sizeof (CUNILOG_BATCH));
+					return NULL != put->batches;
+				}
+			}
+		}
+	#else
+		UNUSED (put);
+	#endif
+	return true;
+}
+
+/*
+	Compiles the processor list of the target put points to into its processor plan.
+	The plan has space for all processors and is only allocated once. Disabled processors
+	are left out. Needs to be called again whenever a processor is disabled or enabled.
+*/
+static bool compileProcessorPlan (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (NULL == put->plan)
+	{
+		ubf_assert_0 (put->nplan);
+		put->plan = ubf_malloc (put->nprocessors * sizeof (CUNILOG_PLANSTEP));
+		if (NULL == put->plan)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+	}
+	if (!allocateProcessorBatches (put))
+	{
+		SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+		return false;
+	}
+
+	CUNILOG_PROCESSOR	*cp;
+	CUNILOG_PLANSTEP	*ps		= put->plan;
+	unsigned int		n;
+
+	for (n = 0; n < put->nprocessors; ++ n)
+	{
+		cp = put->cprocessors [n];
+		if (optCunProcHasOPT_CUNPROC_DISABLED (cp->uiOpts))
+			continue;
+		ubf_assert (0 <= cp->task);
+		ubf_assert (cunilogProcessXAmountEnumValues > cp->task);
+		ps->cup		= cp;
+		ps->fnct	= pickAndRunProcessor [cp->task];
+		ps->uiFlags	= 0;
+		ps->pbt		= NULL;
+		if (cunilogProcessAppliesTo_nAlways == cp->freq)
+			ps->uiFlags |= CUNILOG_PLANSTEP_ALWAYS;
+		if (OPT_CUNPROC_FORCE_NEXT & cp->uiOpts)
+			ps->uiFlags |= CUNILOG_PLANSTEP_FORCE_NEXT;
+		if (cunilogProcessEchoToConsole == cp->task)
+			ps->uiFlags |= CUNILOG_PLANSTEP_ECHO;
+		if (put->batches && hasProcessorBatchFnct (cp))
+		{
+			ps->uiFlags |= CUNILOG_PLANSTEP_BATCH;
+			ps->pbt		= &put->batches [n];
+		}
+		++ ps;
+	}
+	put->nplan = (unsigned int) (ps - put->plan);
+	return true;
+}
+
+static inline bool isEventSkippedByProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+
+	return	(
+					cup->uiSkipSeverities	& CUNILOG_SEVERITY_BIT (pev->evSeverity)
+				||	cup->uiSkipEvtTypes		& CUNILOG_EVTTYPE_BIT (pev->evType)
+			);
+}
+
+/*
+	Hands the pending events of the batch pbt points to over to the batch function of
+	the processor cup points to.
+*/
+static void cunilogProcessBatch (CUNILOG_PROCESSOR *cup, CUNILOG_BATCH *pbt)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pbt);
+
+	if (pbt->nevs)
+	{
+		CUNILOG_CUSTPROCESS	*pcu = cup->pData;
+		ubf_assert_non_NULL (pcu);
+		ubf_assert_non_NULL (pcu->procBatch);
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			// The line buffer doesn't move anymore while the batch function runs.
+			CUNILOG_TARGET	*put	= pbt->pbes [0].pev->pCUNILOG_TARGET;
+			size_t			n;
+			for (n = 0; n < pbt->nevs; ++ n)
+				pbt->pbes [n].szLine = put->szBatchLines + pbt->pofs [n];
+		#endif
+		pcu->procBatch (cup, pbt->pbes, pbt->nevs);
+		pbt->nevs = 0;
+	}
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Stores the current event line of the target, which belongs to the event pev
+		points to, in the line buffer of the batch and returns its offset at the address
+		pofs points to. Batch functions of several processors share the line. The
+		function returns false if the line buffer can't grow, in which case it's left
+		as it is.
+	*/
+	static bool cunilogStoreBatchEventLine (CUNILOG_EVENT *pev, size_t *pofs)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pofs);
+
+		CUNILOG_TARGET	*put	= pev->pCUNILOG_TARGET;
+
+		if (pev == put->pevBatchLine)
+		{
+			*pofs = put->ofsBatchLine;
+			return true;
+		}
+
+		size_t			ln		= put->lnLogEventLine + 1;
+		if (put->lnBatchLines + ln > put->szBatchLinesSize)
+		{
+			size_t	size	= put->szBatchLinesSize ? put->szBatchLinesSize * 2 : 4096;
+			while (size < put->lnBatchLines + ln)
+				size *= 2;
+			char	*sz		= ubf_realloc (put->szBatchLines, size);
+			if (NULL == sz)
+				return false;
+			put->szBatchLines		= sz;
+			put->szBatchLinesSize	= size;
+		}
+		memcpy (put->szBatchLines + put->lnBatchLines, put->mbLogEventLine.buf.pch, ln);
+		put->pevBatchLine	= pev;
+		put->ofsBatchLine	= put->lnBatchLines;
+		put->lnBatchLines	+= ln;
+		*pofs = put->ofsBatchLine;
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static bool cunilogGrowBatch (CUNILOG_BATCH *pbt)
+	{
+		ubf_assert_non_NULL (pbt);
+
+		if (pbt->nevs < pbt->size)
+			return true;
+
+		size_t				size	= pbt->size ? pbt->size * 2 : 16;
+		CUNILOG_BATCHEVENT	*pbes	= ubf_realloc (pbt->pbes, size * sizeof (CUNILOG_BATCHEVENT));
+		if (NULL == pbes)
+			return false;
+		pbt->pbes = pbes;
+		size_t				*pofs	= ubf_realloc (pbt->pofs, size * sizeof (size_t));
+		if (NULL == pofs)
+			return false;
+		pbt->pofs = pofs;
+		pbt->size = size;
+		return true;
+	}
+#endif
+
+/*
+	An event the separate logging thread took off the queue together with others is
+	added to the batch of the plan step. Any other event is processed straight away,
+	after the events that are still pending.
+*/
+static bool cunilogProcessBatchPlanStep (CUNILOG_EVENT *pev, CUNILOG_PLANSTEP *ps)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(ps);
+	ubf_assert_non_NULL	(ps->pbt);
+
+	CUNILOG_BATCH *pbt = ps->pbt;
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		size_t ofs;
+		if	(
+					cunilogIsEventBatched (pev)
+				&&	cunilogGrowBatch (pbt)
+				&&	cunilogStoreBatchEventLine (pev, &ofs)
+			)
+		{
+			pbt->pbes [pbt->nevs].pev		= pev;
+			pbt->pbes [pbt->nevs].szLine	= NULL;
+			pbt->pbes [pbt->nevs].lnLine	= pev->pCUNILOG_TARGET->lnLogEventLine;
+			pbt->pofs [pbt->nevs]			= ofs;
+			++ pbt->nevs;
+			cunilogSetEventDeferred (pev);
+			return true;
+		}
+	#endif
+	cunilogProcessBatch (ps->cup, pbt);
+	return ps->fnct (ps->cup, pev);
+}
+
 /*
+	Runs the processor of the plan step ps points to if its threshold has been reached.
 	Returns true for further processing by the caller.
 */
-static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup)
+static inline bool cunilogProcessPlanStep (CUNILOG_EVENT *pev, CUNILOG_PLANSTEP *ps)
 {
 	ubf_assert_non_NULL	(pev);
-	ubf_assert_non_NULL	(cup);
-	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
-	ubf_assert			(cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
+	ubf_assert_non_NULL	(ps);
+	ubf_assert_non_NULL	(ps->cup);
+	ubf_assert			(!optCunProcHasOPT_CUNPROC_DISABLED (ps->cup->uiOpts));
 
-	// If the processor is disabled we move on to the next one unconditionally.
-	if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
-		return true;
+	CUNILOG_PROCESSOR *cup = ps->cup;
 
-	if (cunilogHasEventEchoOnly (pev) && cunilogProcessEchoToConsole != cup->task)
+	// We move on to the next processor if this one skips the event.
+	if (isEventSkippedByProcessor (cup, pev))
 		return true;
 
 	bool bRetProcessor = true;
-	if	(updateCurrentValueAndIsThresholdReached (cup, pev))
+	if (CUNILOG_PLANSTEP_BATCH & ps->uiFlags)
+	{
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
+		bRetProcessor = cunilogProcessBatchPlanStep (pev, ps);
+	} else
+	if (CUNILOG_PLANSTEP_ALWAYS & ps->uiFlags)
+	{
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
+		bRetProcessor = ps->fnct (cup, pev);
+	} else
+	if (updateCurrentValueAndIsThresholdReached (cup, pev))
 	{
 		// True tells the caller to carry on with the next processor.
-		bRetProcessor = pickAndRunProcessor [cup->task] (cup, pev);
+		bRetProcessor = ps->fnct (cup, pev);
 	}
-	
-	if (cunilogProcessEchoToConsole == cup->task && cunilogHasEventEchoOnly (pev))
-		return false;
+
 	// An error callback function told us to stop here and ignore the remaining processors.
 	if (cunilogEventHasIgnoreRemainingProcessors (pev))
 		return false;
 	// The processor has the OPT_CUNPROC_FORCE_NEXT flag set.
-	if (OPT_CUNPROC_FORCE_NEXT & cup->uiOpts)
+	if (CUNILOG_PLANSTEP_FORCE_NEXT & ps->uiFlags)
 		return true;
 	if (cunilogTargetHasRunProcessorsOnStartup (pev->pCUNILOG_TARGET))
 		return true;
 	// Now the current processor decides if the next processor is allowed to run.
-	 return bRetProcessor;
+	return bRetProcessor;
+}
+
+/*
+	An event that is only echoed to the console goes to the first echo processor of the
+	plan that doesn't skip it.
+*/
+static inline void cunilogProcessPlanEchoOnly (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert			(cunilogHasEventEchoOnly (pev));
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	CUNILOG_PLANSTEP	*ps		= put->plan;
+	CUNILOG_PLANSTEP	*pe		= ps + put->nplan;
+
+	for (; ps < pe; ++ ps)
+	{
+		if	(
+					CUNILOG_PLANSTEP_ECHO & ps->uiFlags
+				&&	!isEventSkippedByProcessor (ps->cup, pev)
+			)
+		{
+			if	(
+						CUNILOG_PLANSTEP_ALWAYS & ps->uiFlags
+					||	updateCurrentValueAndIsThresholdReached (ps->cup, pev)
+				)
+				ps->fnct (ps->cup, pev);
+			return;
+		}
+	}
 }
 
 static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
@@ -26490,24 +33133,26 @@ static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET);
 	ubf_assert (cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
 	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET->cprocessors);
+	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET->plan);
 
 	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
 	if (!cunilogIsEventInternal (pev) && !cunilogHasEventNoRotation (pev))
 	{
 		pev->pCUNILOG_TARGET->scuNPI.nIgnoredTotal = 0;
-		cunilogResetFilesList (put);
+		if (!cunilogTargetHasFLSindex (put))
+			cunilogResetFilesList (put);
 		cunilogEventClrIgnoreRemainingProcessors (pev);
 	}
 
-	CUNILOG_PROCESSOR *cup;
-	unsigned int ui = 0;
-	while (ui < pev->pCUNILOG_TARGET->nprocessors)
+	if (cunilogHasEventEchoOnly (pev))
+		cunilogProcessPlanEchoOnly (pev);
+	else
 	{
-		cup = pev->pCUNILOG_TARGET->cprocessors [ui];
-		bool b = cunilogProcessProcessor (pev, cup);
-		if (!b)
-			break;
-		++ ui;
+		CUNILOG_PLANSTEP	*ps		= put->plan;
+		CUNILOG_PLANSTEP	*pe		= ps + put->nplan;
+
+		while (ps < pe && cunilogProcessPlanStep (pev, ps))
+			++ ps;
 	}
 
 	if (!cunilogIsEventInternal (pev))
@@ -26528,7 +33173,7 @@ static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 			ubf_assert (cunilogCmdConfigXAmountEnumValues > cmd);
 		#endif
 		culCmdChangeCmdConfigFromCommand (pev);
-		DoneCUNILOG_EVENT (NULL, pev);
+		// The event is destroyed by the caller, like any other event.
 		return true;
 	}
 #endif
@@ -26542,8 +33187,9 @@ static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev)
 	// Event command flag for shutting down the separate logging thread.
 	if (cunilogIsEventShutdown (pev))
 	{
+		// The shutdown event is only ever processed by the separate logging thread,
+		//	which destroys it afterwards like any other event.
 		cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-		DoneCUNILOG_EVENT (NULL, pev);
 		// The shutdown event has been processed. We treat this as being success.
 		return true;
 	}
@@ -26553,11 +33199,16 @@ static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev)
 			return cunilogProcessEvtCommand (pev);
 	#endif
 
+	// Messages of the maintenance thread go before the event that's going to be written.
+	if (!cunilogIsEventInternal (pev))
+		cunilogLogMaintenanceMessages (pev->pCUNILOG_TARGET);
+
 	size_t	eventLineSize = createEventLineFromSUNILOGEVENT (pev);
 	if (CUNILOG_SIZE_ERROR != eventLineSize)
 	{
 		cunilogProcessProcessors (pev);
-		if (cunilogHasEventNoRotation (pev))
+		// Only the internal events of logFromInsideRotatorTextU8fmt () are counted.
+		if (cunilogHasEventNoRotation (pev) && cunilogIsEventInternal (pev))
 			DecrementPendingNoRotationEvents (pev->pCUNILOG_TARGET);
 		return true;
 	}
@@ -26571,10 +33222,21 @@ static bool enqueueAndTriggerSeparateLoggingThread (CUNILOG_EVENT *pev)
 	ubf_assert (cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
 
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-		size_t n = EnqueueCUNILOG_EVENT (pev);
+		// Once queued, the event can be destroyed any time, either by the separate logging
+		//	thread or because it has been dropped.
+		CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
+		if (cunilogHasStagingBuffers (put))
+		{
+			if (isStageableCUNILOG_EVENT (pev) && StageCUNILOG_EVENT (pev))
+				return true;
+			FlushThreadCUNILOG_STAGING (put);
+		}
+		// An event dropped by the queue full policy is not an error.
+		bool	bDropped	= false;
+		size_t	n			= EnqueueCUNILOG_EVENT (pev, &bDropped);
 		if (n)
-			triggerCUNILOG_EVENTloggingThread (pev->pCUNILOG_TARGET, n);
-		return n > 0;
+			triggerCUNILOG_EVENTloggingThread (put, n);
+		return n > 0 || bDropped;
 	#else
 		return cunilogProcessEventSingleThreaded (pev);
 	#endif
@@ -26705,6 +33367,8 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 
 		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
 		{
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, false);
 			if (queueShutdownEvent (put))
 			{
 				WaitForEndOfSeparateLoggingThread (put);
@@ -26713,6 +33377,10 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 			}
 			return false;
 		}
+		EnterCUNILOG_LOCKER (put);
+		StopMaintenanceThread (put);
+		cunilogWriteBehindToLogFileAndWait (put);
+		LeaveCUNILOG_LOCKER (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -26721,6 +33389,7 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 	{
 		ubf_assert_non_NULL (put);
 
+		cunilogWriteBehindToLogFileAndWait (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -26734,6 +33403,8 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
 		{
 			cunilogTargetSetShutdownInitiatedFlag (put);
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, false);
 
 			// Empty the queue. While this would actually not be required here, it can
 			//	speed up things significantly (well, maybe a few cycles) with busy queues as
@@ -26788,11 +33459,16 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 
 		EnterCUNILOG_LOCKER (put);
 		cunilogTargetClrIsPaused (put);
-		n = put->nPausedEvents;
-		put->nPausedEvents = 0;
+		if (cunilogHasLockFreeQueue (put))
+			n = cunilogAtomicXchgSize (&put->nPausedEvents, 0);
+		else
+		{
+			n = put->nPausedEvents;
+			put->nPausedEvents = 0;
+		}
 		LeaveCUNILOG_LOCKER (put);
 
-		if (needsOrHasLocker (put))
+		if (n && needsOrHasLocker (put))
 			triggerCUNILOG_EVENTloggingThread (put, n);
 		return n;
 	}
@@ -26802,6 +33478,19 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 	User logging functions.
 */
 
+/*
+	Returns true if the target put points to doesn't log events with the severity sev.
+	Called by the logging functions before an event is created.
+*/
+static inline bool isSeverityFilteredOut (CUNILOG_TARGET *put, cueventseverity sev)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (0 <= sev);
+	ubf_assert (cunilogEvtSeverityXAmountEnumValues > sev);
+
+	return !(cunilogAtomicLoadU32 (&put->uiLogSeverities) & CUNILOG_SEVERITY_BIT (sev));
+}
+
 bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (put);
@@ -26811,6 +33500,8 @@ bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
 
+	// The event doesn't belong to the batch of its previous target anymore.
+	cunilogClrEventBatched (pev);
 	pev->pCUNILOG_TARGET = put;
 	return cunilogProcessOrQueueEvent (pev);
 }
@@ -26821,6 +33512,8 @@ bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccTe
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -26832,6 +33525,8 @@ bool logTextU8sevlts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -26843,6 +33538,8 @@ bool logTextU8sevlq			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	if (pev)
@@ -26859,6 +33556,8 @@ bool logTextU8sevlqts		(CUNILOG_TARGET *put, cueventseverity sev, const char *cc
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
 	if (pev)
@@ -26885,6 +33584,8 @@ bool logTextU8l				(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -26896,6 +33597,8 @@ bool logTextU8lq			(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
 	if (pev)
@@ -26922,19 +33625,11 @@ bool logTextU8vfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8l (put, ob, l);
-		ubf_free (ob);
-		return b;
-	}
-	return false;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
 bool logTextU8fmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -26943,6 +33638,8 @@ bool logTextU8fmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -26960,17 +33657,14 @@ bool logTextU8qvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8lq (put, ob, l);
-		ubf_free (ob);
-		return b;
+		cunilogSetEventNoRotation (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -26981,6 +33675,8 @@ bool logTextU8qfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -26998,24 +33694,10 @@ bool logTextU8svfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8l (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return logTextU8vfmt (put, fmt, ap);
 }
 
 bool logTextU8sfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -27024,6 +33706,8 @@ bool logTextU8sfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -27041,23 +33725,10 @@ bool logTextU8sqvfmt		(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8lq (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return logTextU8qvfmt (put, fmt, ap);
 }
 
 bool logTextU8sqfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -27066,12 +33737,14 @@ bool logTextU8sqfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
 
 	va_start (ap, fmt);
-	b = logTextU8sqfmt (put, fmt, ap);
+	b = logTextU8sqvfmt (put, fmt, ap);
 	va_end (ap);
 
 	return b;
@@ -27083,24 +33756,11 @@ bool logTextU8svfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8sevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
 bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...)
@@ -27109,6 +33769,8 @@ bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fm
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -27127,9 +33789,15 @@ bool logTextU8smbvfmtsev	(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	va_list		aq;
+
+	va_copy (aq, ap);
+	l = (size_t) vsnprintf (NULL, 0, fmt, aq);
+	va_end (aq);
 
 	growToSizeSMEMBUF (smb, l + 1);
 	if (isUsableSMEMBUF (smb))
@@ -27152,6 +33820,8 @@ bool logTextU8smbfmtsev		(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -27170,6 +33840,8 @@ bool logTextU8smbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_l
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextU8smbvfmtsev (put, smb, cunilogEvtSeverityNone, fmt, ap);
 }
@@ -27181,6 +33853,8 @@ bool logTextU8smbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -27192,12 +33866,77 @@ bool logTextU8smbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 	return b;
 }
 
+bool logTextU8dvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextDeferredvfmt (put, sev, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
+
+bool logTextU8dfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
+
+	va_list		ap;
+	bool		b;
+
+	va_start (ap, fmt);
+	b = logTextU8dvfmtsev (put, sev, fmt, ap);
+	va_end (ap);
+
+	return b;
+}
+
+bool logTextU8dvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
+
+	return logTextU8dvfmtsev (put, cunilogEvtSeverityNone, fmt, ap);
+}
+
+bool logTextU8dfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
+
+	va_list		ap;
+	bool		b;
+
+	va_start (ap, fmt);
+	b = logTextU8dvfmtsev (put, cunilogEvtSeverityNone, fmt, ap);
+	va_end (ap);
+
+	return b;
+}
+
 bool logHexDumpU8sevl		(CUNILOG_TARGET *put, cueventseverity sev, const void *pBlob, size_t size, const char *ccCaption, size_t lenCaption)
 {
 	ubf_assert_non_NULL (put);
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data (put, sev, pBlob, size, ccCaption, lenCaption);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -27209,6 +33948,8 @@ bool logHexDumpU8l			(CUNILOG_TARGET *put, const void *pBlob, size_t size, const
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob, size,
@@ -27223,6 +33964,8 @@ bool logHexDump				(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob,
@@ -27237,6 +33980,8 @@ bool logHexDumpq			(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob,
@@ -27256,6 +34001,8 @@ bool logHexOrText			(CUNILOG_TARGET *put, const void *szHexOrTxt, size_t lenHexO
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (str_has_only_printable_ASCII (szHexOrTxt, lenHexOrTxt))
 		return logTextU8l (put, szHexOrTxt, lenHexOrTxt);
@@ -27269,6 +34016,8 @@ bool logHexOrTextq			(CUNILOG_TARGET *put, const void *szHexOrTxt, size_t lenHex
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (str_has_only_printable_ASCII (szHexOrTxt, lenHexOrTxt))
 		return logTextU8lq (put, szHexOrTxt, lenHexOrTxt);
@@ -27282,6 +34031,8 @@ bool logHexOrTextU8			(CUNILOG_TARGET *put, const void *szHexOrTxtU8, size_t len
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (c_check_utf8 (szHexOrTxtU8, lenHexOrTxtU8))
 		return logTextU8l (put, szHexOrTxtU8, lenHexOrTxtU8);
@@ -27296,6 +34047,8 @@ bool logTextWU16sevl			(CUNILOG_TARGET *put, cueventseverity sev, const wchar_t
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	char s8 [CUNILOG_STD_MSG_SIZE * 4];
 	char *p8;
@@ -27341,6 +34094,8 @@ bool logTextWU16sev			(CUNILOG_TARGET *put, cueventseverity sev, const wchar_t *
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	char s8 [CUNILOG_STD_MSG_SIZE * 4];
 	char *p8;
@@ -27378,6 +34133,8 @@ bool logTextWU16l				(CUNILOG_TARGET *put, const wchar_t *cwText, size_t len)
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextWU16sevl (put, cunilogEvtSeverityNone, cwText, len);
 }
@@ -27390,6 +34147,8 @@ bool logTextWU16				(CUNILOG_TARGET *put, const wchar_t *cwText)
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextWU16sev (put, cunilogEvtSeverityNone, cwText);
 }
@@ -27401,6 +34160,8 @@ bool logTextU8csevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	if (pev)
@@ -27438,17 +34199,14 @@ bool logTextU8cvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8cl (put, ob, l);
-		ubf_free (ob);
-		return b;
+		cunilogSetEventEchoOnly (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -27459,6 +34217,8 @@ bool logTextU8cfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -27476,29 +34236,17 @@ bool logTextU8csfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
+	bool		b;
 
 	va_start (ap, fmt);
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	b = logTextU8cvfmt (put, fmt, ap);
 	va_end (ap);
 
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		va_start (ap, fmt);
-		vsnprintf (ob, l + 1, fmt, ap);
-		va_end (ap);
-
-		bool b = logTextU8cl (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return b;
 }
 
 bool logTextU8csmbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_list ap)
@@ -27508,10 +34256,15 @@ bool logTextU8csmbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	size_t		l;
+	va_list		aq;
 
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	va_copy (aq, ap);
+	l = (size_t) vsnprintf (NULL, 0, fmt, aq);
+	va_end (aq);
 
 	growToSizeSMEMBUF (smb, l + 1);
 	if (isUsableSMEMBUF (smb))
@@ -27534,6 +34287,8 @@ bool logTextU8csmbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	size_t		l;
@@ -27564,22 +34319,14 @@ bool logTextU8csvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8csevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
+		cunilogSetEventEchoOnly (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -27590,29 +34337,17 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
+	bool		b;
 
 	va_start (ap, fmt);
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	b = logTextU8csvfmtsev (put, sev, fmt, ap);
 	va_end (ap);
 
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		va_start (ap, fmt);
-		vsnprintf (ob, l + 1, fmt, ap);
-		va_end (ap);
-
-		bool b = logTextU8csevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return b;
 }
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
@@ -27639,6 +34374,27 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 	}
 #endif
 
+#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
+	/*
+		A queued command event is destroyed by the separate logging thread. Without a
+		queue it has been processed when cunilogProcessOrQueueEvent () returns and we
+		destroy it ourselves.
+	*/
+	static bool cunilogProcessOrQueueCmdEvent (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtTypeCommand == pev->evType);
+
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			if (HAS_CUNILOG_TARGET_A_QUEUE (pev->pCUNILOG_TARGET))
+				return cunilogProcessOrQueueEvent (pev);
+		#endif
+		bool b = cunilogProcessOrQueueEvent (pev);
+		DoneCUNILOG_EVENT (NULL, pev);
+		return b;
+	}
+#endif
+
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
 	bool ChangeCUNILOG_TARGETuseColourForEcho (CUNILOG_TARGET *put, bool bUseColour)
 	{
@@ -27646,7 +34402,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigUseColourForEcho (pev->szDataToLog, bUseColour);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27663,7 +34419,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigCunilognewline (pev->szDataToLog, nl);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27679,8 +34435,8 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		CUNILOG_EVENT *pev = CreateCUNILOG_EVENTforCommand (put, cunilogCmdConfigDisableTaskProcessors);
 		if (pev)
 		{
-			culCmdStoreCmdConfigEnableTaskProcessors (pev->szDataToLog, task);
-			return cunilogProcessOrQueueEvent (pev);
+			culCmdStoreCmdConfigDisableTaskProcessors (pev->szDataToLog, task);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27697,7 +34453,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigEnableTaskProcessors (pev->szDataToLog, task);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27713,7 +34469,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			memcpy (pev->szDataToLog, &cmd, sizeof (cmd));
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27727,7 +34483,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			memcpy (pev->szDataToLog, &cmd, sizeof (cmd));
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27747,7 +34503,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreConfigEventSeverityFormatType (pev->szDataToLog, sevTpy);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -27767,7 +34523,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 			if (pev)
 			{
 				culCmdStoreConfigLogThreadPriority (pev->szDataToLog, prio);
-				return cunilogProcessOrQueueEvent (pev);
+				return cunilogProcessOrQueueCmdEvent (pev);
 			}
 			return false;
 		}
@@ -27864,8 +34620,9 @@ int cunilog_printf_sev_fmtpy_vl	(
 		#ifdef PLATFORM_IS_WINDOWS
 			iRet = cunilogPrintWin (pzToPrint, lenRequired);
 		#else
+			// The text has been formatted already and must not be used as a format.
 			if (lenRequired)
-				iRet = printf (pz);
+				iRet = printf ("%s", pzToPrint);
 			else
 				iRet = printf ("");
 		#endif
@@ -28009,7 +34766,7 @@ int cunilog_puts_sev_fmtpy_l	(
 			iRet = cunilogPutsWin (pzToPrint, lenRequired);
 		#else
 			if (lenRequired)
-				iRet = puts (pz);
+				iRet = puts (pzToPrint);
 			else
 				iRet = puts ("");
 		#endif
@@ -28116,6 +34873,10 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (EventSeverityTexts5)			==	cunilogEvtSeverityXAmountEnumValues);
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (EventSeverityTexts9)			==	cunilogEvtSeverityXAmountEnumValues);
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (evtSeverityColours)			==	cunilogEvtSeverityXAmountEnumValues);
+		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (cunilogEvtSeverityRank)		==	cunilogEvtSeverityXAmountEnumValues);
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (stEventPoolPayloads)		==	CUNILOG_EVENTPOOL_CLASSES);
+		#endif
 
 		// Check that the length assignments are correct.
 		ubf_expect_bool_AND (bRet, LEN_ISO8601DATEHOURANDMINUTE	== lenDateTimeStampFromPostfix (cunilogPostfixMinute));
@@ -28143,6 +34904,7 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberWeekly));
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberMonthly));
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberYearly));
+		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberSize));
 
 		/*
 			Check consistency between unilogstruct.h and the declarations in this code file.
@@ -28519,6 +35281,46 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 
 		DoneCUNILOG_TARGET (pt);
 
+		/*
+			The cached event timestamp must always be identical to a freshly rendered one.
+			Each stamp below differs from its predecessor in a different field, the last
+			one in its date.
+		*/
+		CUNILOG_TARGET	tt;
+		CUNILOG_EVENT	te;
+		char			szC [64];
+		char			szR [64];
+		SUBF_TIMESTRUCT	tst		= {2025, 6, 15, 13, 55, 36, 123, 456, 1, 0, true};
+		UBF_TIMESTAMP	ts;
+		UBF_TIMESTAMP	tsChanges [] =
+		{
+				(UBF_TIMESTAMP) 0x007 << 8
+			,	(UBF_TIMESTAMP) 0x007 << 18
+			,	(UBF_TIMESTAMP) 0x001 << 28
+			,	(UBF_TIMESTAMP) 0x002 << 34
+			,	(UBF_TIMESTAMP) 0x004 << 40
+			,	(UBF_TIMESTAMP) 0x001 << 54
+		};
+		UBF_TIMESTAMP_from_SUBF_TIMESTRUCT (&ts, &tst);
+		te.pCUNILOG_TARGET = &tt;
+		for (unsigned int f = 0; f < cunilogEvtTS_AmountEnumValues; ++ f)
+		{
+			tt.unilogEvtTSformat = f;
+			InitCUNILOG_TSPREFIX (&tt.tsp);
+			te.stamp = ts;
+			for (unsigned int c = 0; c <= GET_ARRAY_LEN (tsChanges); ++ c)
+			{
+				size_t len = writeEvtTimestamp (szC, &te);
+				evtTSFormats [f].fnc (szR, te.stamp);
+				ubf_expect_bool_AND (bRet, evtTSFormats [f].len == len);
+				ubf_expect_bool_AND (bRet, !memcmp (szC, szR, len));
+				// Toggling these bits keeps the fields within their ranges.
+				if (c < GET_ARRAY_LEN (tsChanges))
+					te.stamp ^= tsChanges [c];
+			}
+		}
+		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (evtTSFormats) == cunilogEvtTS_AmountEnumValues);
+
 		return bRet;
 	}
 #endif
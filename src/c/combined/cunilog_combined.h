@@ -8017,11 +8017,14 @@ When		Who				What
 
 #include <stdbool.h>
 
+#include <stddef.h>
+
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
 	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
 
 	#include "./platform.h"
+	#include "./externC.h"
 
 		#if defined (OS_IS_WINDOWS)
 			//#include "./CompressNTFS_U8.h"
@@ -8032,6 +8035,7 @@ When		Who				What
 	#else
 
 		#include "./../pre/platform.h"
+		#include "./../pre/externC.h"
 
 		#if defined (OS_IS_WINDOWS)
 			//#include "./Windows/CompressNTFS_U8.h"
@@ -8043,6 +8047,166 @@ When		Who				What
 
 #endif
 
+/*
+	The compressors are only available if the application defines HAVE_ZLIB (gzip) or
+	HAVE_ZSTD (zstd) and links to the respective library, i.e. -lz and/or -lzstd.
+	Without these definitions, the compression functions below fail.
+*/
+
+EXTERN_C_BEGIN
+
+/*
+	enextcompressor
+
+	The external compressors supported.
+*/
+enum enextcompressor
+{
+		extcompressor_gzip								// Deflate in a gzip container (".gz").
+	,	extcompressor_zstd								// Zstandard (".zst").
+
+	// Do not add anything below this line.
+	,	extcompressor_XAmountEnumValues					// Used for table sizes.
+	// Do not add anything below extcompressor_XAmountEnumValues.
+};
+typedef enum enextcompressor enextcompressor;
+
+/*
+	The size of the input and the output buffer of a compression, in octets. Together
+	with the state of the compressor, this is all the memory a compression requires,
+	independent of the size of the file.
+*/
+#ifndef EXT_COMPRESSOR_BUF_SIZE
+#define EXT_COMPRESSOR_BUF_SIZE				(64 * 1024)
+#endif
+
+/*
+	The compression level that selects the default level of the compressor.
+*/
+#define EXT_COMPRESSOR_DEFAULT_LEVEL		(-1)
+
+/*
+	ExtCompressorAvailable
+
+	Returns true if the compressor cmp has been built in, false otherwise.
+*/
+bool ExtCompressorAvailable (enextcompressor cmp)
+;
+
+/*
+	ExtCompressorFileExtension
+
+	Returns the file name extension of the compressor cmp, including the dot, for
+	instance ".gz" for extcompressor_gzip. If plen is not NULL, the function writes the
+	length of the extension to the address it points to.
+*/
+const char *ExtCompressorFileExtension (enextcompressor cmp, size_t *plen)
+;
+
+/*
+	ExtCompressFileByName
+
+	Compresses the file szSrc with the compressor cmp into the file szDst. The file is
+	read and compressed in chunks of EXT_COMPRESSOR_BUF_SIZE octets.
+
+	The compressed data is written to a temporary file in the same folder, which has the
+	name szDst with ".tmp" appended. This file is flushed to disk and then renamed to
+	szDst, which replaces a file szDst that may exist already. This ensures that szDst
+	is either complete or doesn't exist. The file szSrc is not changed or deleted.
+
+	The parameter level is the compression level, or EXT_COMPRESSOR_DEFAULT_LEVEL for the
+	compressor's default level.
+
+	The function returns true on success, false otherwise. If the function fails,
+	errno on POSIX or the value of GetLastError () on Windows contains the reason, which
+	is ENOSYS or ERROR_NOT_SUPPORTED respectively if the compressor hasn't been built in.
+	The temporary file is deleted in this case.
+*/
+bool ExtCompressFileByName	(
+		const char			*szSrc,
+		const char			*szDst,
+		enextcompressor		cmp,
+		int					level
+							)
+;
+
+/*
+	EXTCMPFRAMER
+
+	A compressor that compresses data into independent frames, i.e. complete gzip members
+	or zstd frames. Each frame can be decompressed without any of the frames before it.
+	Frames written one after the other to the same file form a valid gzip or zstd file
+	that the command line tools decompress as a whole. If the file is truncated, for
+	instance because the process or the machine crashed while a frame was written, all
+	frames before the incomplete one can still be decompressed.
+
+	The structure is opaque. See CreateEXTCMPFRAMER ().
+*/
+typedef struct extcmpframer EXTCMPFRAMER;
+
+/*
+	CreateEXTCMPFRAMER
+
+	Creates a frame compressor for the compressor cmp with the compression level level,
+	or EXT_COMPRESSOR_DEFAULT_LEVEL for the compressor's default level. The state of the
+	compressor and its output buffer are reused for every frame.
+
+	The function returns a pointer to the new frame compressor, or NULL if the compressor
+	hasn't been built in or if not enough memory is available. The frame compressor must
+	be destroyed with DoneEXTCMPFRAMER () when it is not needed anymore.
+*/
+EXTCMPFRAMER *CreateEXTCMPFRAMER (enextcompressor cmp, int level)
+;
+
+/*
+	DoneEXTCMPFRAMER
+
+	Destroys the frame compressor pfr points to. The parameter pfr can be NULL.
+*/
+void DoneEXTCMPFRAMER (EXTCMPFRAMER *pfr)
+;
+
+/*
+	ExtCompressFrame
+
+	Compresses the ln1 octets p1 points to, followed by the ln2 octets p2 points to, into
+	a single frame. Either of the two can be empty.
+
+	The function returns a pointer to the frame, and writes its length to the address
+	plnFrame points to. The frame stays valid until ExtCompressFrame () or
+	DoneEXTCMPFRAMER () is called again for pfr. The function returns NULL if the data
+	could not be compressed or the output buffer could not be enlarged.
+*/
+const char *ExtCompressFrame	(
+		EXTCMPFRAMER		*pfr,
+		const char			*p1,
+		size_t				ln1,
+		const char			*p2,
+		size_t				ln2,
+		size_t				*plnFrame
+								)
+;
+
+/*
+	ExtCompressFramesRepairFile
+
+	Makes sure that the file szFile, to which the frames of pfr are going to be appended,
+	consists of complete frames of the compressor of pfr only.
+
+	Data after the last complete frame, like a frame that was still being written when the
+	process or the machine crashed, is cut off. If the file doesn't start with a frame of
+	this compressor at all, for instance because it has been written uncompressed so far,
+	its content is compressed into a single frame first (see ExtCompressFileByName ()).
+	The file is read once completely to find the end of the last complete frame.
+
+	The function returns true if the file consists of complete frames afterwards, is empty,
+	or doesn't exist. It returns false if the file could not be read or changed.
+*/
+bool ExtCompressFramesRepairFile (EXTCMPFRAMER *pfr, const char *szFile)
+;
+
+EXTERN_C_END
+
 
 #endif														// Of #ifndef U_EXTCOMPRESSORS_H.
 /****************************************************************************************
@@ -11318,6 +11482,52 @@ UBF_TIMESTAMP SystemTime_UBF_TIMESTAMP (void)
 UBF_TIMESTAMP LocalTime_UBF_TIMESTAMP (void)
 ;
 
+/*
+	UBF_TIMESTAMP_CACHE
+
+	Cache for GetLocalTimeCached_UBF_TIMESTAMP (). It holds the local time of the most
+	recently seen second, including its UTC offset, as a UBF_TIMESTAMP without
+	milliseconds. Initialise the structure with UBF_TIMESTAMP_CACHE_INITIALISER or
+	InitUBF_TIMESTAMP_CACHE () before it is used.
+*/
+typedef struct ubf_timestamp_cache
+{
+	int64_t				tSec;							// Seconds since 1970-01-01 UTC.
+	UBF_TIMESTAMP		uts;							// Local time of tSec, no ms.
+} UBF_TIMESTAMP_CACHE;
+
+#define UBF_TIMESTAMP_CACHE_INITIALISER					\
+	{ -1, 0 }
+
+#define InitUBF_TIMESTAMP_CACHE(pc)						\
+	do													\
+	{													\
+		(pc)->tSec	= -1;								\
+		(pc)->uts	= 0;								\
+	} while (0)
+
+/*
+	GetLocalTimeCached_UBF_TIMESTAMP
+	LocalTimeCached_UBF_TIMESTAMP
+
+	Return the local time like GetLocalTime_UBF_TIMESTAMP () and LocalTime_UBF_TIMESTAMP ()
+	but only read a wall clock on each call, which is CLOCK_REALTIME_COARSE on Linux,
+	CLOCK_REALTIME on other POSIX systems, and GetSystemTimeAsFileTime () on Windows. The
+	broken-down date and time and the UTC offset are taken from the cache pc points to and
+	are only recomputed when the second changes. Since DST transitions happen at second
+	boundaries, they are picked up too.
+
+	The resolution of a coarse clock is the resolution of the system's timer tick, which
+	is typically between 1 and 4 ms on Linux.
+
+	The functions are not thread-safe for the same cache. Callers that share a cache among
+	several threads must serialise the calls. Different caches can be used concurrently.
+*/
+void GetLocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP *ut, UBF_TIMESTAMP_CACHE *pc);
+
+UBF_TIMESTAMP LocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP_CACHE *pc)
+;
+
 
 EXTERN_C_END
 
@@ -18107,6 +18317,8 @@ When		Who				What
 #define CUNILOG_ERROR_APPNAME						(8)
 #define CUNILOG_ERROR_SEPARATE_LOGGING_THREAD		(9)
 #define CUNILOG_ERROR_RENAMING_LOGFILE				(10)
+#define CUNILOG_ERROR_THREAD_LOCAL_STORAGE			(11)
+#define CUNILOG_ERROR_MAINTENANCE_THREAD			(12)
 
 #define CUNILOG_ERROR_FIRST_UNUSED_ERROR			(5000)
 
@@ -18300,6 +18512,28 @@ When		Who				What
 	#endif
 #endif
 
+/*
+	io_uring for writing out the write-behind buffer on Linux.
+	See ConfigCUNILOG_TARGETioUring (). Define CUNILOG_BUILD_WITHOUT_IO_URING if the
+	kernel headers are too old to provide <linux/io_uring.h>.
+*/
+#if defined (OS_IS_LINUX) && !defined (CUNILOG_BUILD_WITHOUT_IO_URING)
+	#ifndef CUNILOG_HAVE_IO_URING
+	#define CUNILOG_HAVE_IO_URING
+	#endif
+#endif
+
+/*
+	inotify for keeping the files list index in sync with changes to the logging folder
+	made by other processes on Linux. See ConfigCUNILOG_TARGETfilesListIndex ().
+	Define CUNILOG_BUILD_WITHOUT_INOTIFY to build without it.
+*/
+#if defined (OS_IS_LINUX) && !defined (CUNILOG_BUILD_WITHOUT_INOTIFY)
+	#ifndef CUNILOG_HAVE_INOTIFY
+	#define CUNILOG_HAVE_INOTIFY
+	#endif
+#endif
+
 /*
 	Build options.
 
@@ -18481,6 +18715,10 @@ enum cunilogpostfix
 	,	cunilogPostfixDotNumberWeekly
 	,	cunilogPostfixDotNumberMonthly
 	,	cunilogPostfixDotNumberYearly
+	,	cunilogPostfixDotNumberSize							// ".<number>", rotation only when
+															//	the active logfile has reached
+															//	a certain size. See
+															//	ConfigCUNILOG_TARGETrotateAtSize ().
 	// Do not add anything below this line.
 	,	cunilogPostfixAmountEnumValues						// Used for table sizes.
 	// Do not add anything below cunilogPostfixAmountEnumValues.
@@ -18561,7 +18799,8 @@ enum cunilogprocessfrequency
 		cunilogProcessAppliesTo_nEvents						// Threshold is incremented for
 															//	each event.
 	,	cunilogProcessAppliesTo_nOctets						// Threshold counts the amount of
-															//	octets logged.
+															//	octets logged. For rotators,
+															//	the size of the active logfile.
 	,	cunilogProcessAppliesTo_nAlways						// Threshold does not apply; always
 															//	processed.
 	,	cunilogProcessAppliesTo_SecondChanged				// Processed whenever the second
@@ -18596,6 +18835,10 @@ typedef struct cunilog_processor
 	void							*pData;					// Pointer to processor-specific data.
 	uint64_t						uiOpts;					// Option flags. See OPT_CUNPROC_
 															//	definitions below.
+	uint32_t						uiSkipSeverities;		// Severities the processor skips.
+															//	See CUNILOG_SEVERITY_BIT ().
+	uint32_t						uiSkipEvtTypes;			// Event types the processor skips.
+															//	See CUNILOG_EVTTYPE_BIT ().
 } CUNILOG_PROCESSOR;
 
 /*
@@ -18617,6 +18860,13 @@ typedef struct cunilog_processor
 															//	Carries on with the next processor
 															//	unconditionally, just like
 															//	OPT_CUNPROC_FORCE_NEXT.
+															//	Once the processor belongs to a
+															//	target, only change it with
+															//	ConfigCUNILOG_TARGETdisable/
+															//	enableTaskProcessors (), which
+															//	compile the processor plan of
+															//	the target again. Never set or
+															//	clear it directly then.
 
 /*
 	Macros for some flags.
@@ -18624,6 +18874,8 @@ typedef struct cunilog_processor
 
 #define optCunProcHasOPT_CUNPROC_AT_STARTUP(v)			\
 	((v) & OPT_CUNPROC_AT_STARTUP)
+#define optCunProcSetOPT_CUNPROC_AT_STARTUP(v)			\
+	((v) |= OPT_CUNPROC_AT_STARTUP)
 #define optCunProcClrOPT_CUNPROC_AT_STARTUP(v)			\
 	((v) &= ~ OPT_CUNPROC_AT_STARTUP)
 
@@ -18644,9 +18896,114 @@ typedef struct cunilog_logfile
 		HANDLE			hLogFile;
 	#else
 		FILE			*fLogFile;
-	#endif
+		int				fdLogFile;							// Raw file descriptor or -1.
+															//	See CUNILOGTARGET_RAW_LOGFILE.
+		// See CUNILOGTARGET_MAPPED_LOGFILE.
+		char			*pMap;								// The mapped tail of the logfile or NULL.
+		size_t			lnMap;								// Length of the mapping.
+		size_t			ofsMap;								// Write position within the mapping.
+		uint64_t		ullMapBase;							// File offset of the mapping.
+		size_t			lnMapChunk;							// Octets mapped/preallocated at once.
+	#endif
+	uint64_t			ullSize;							// Size of the logfile in octets,
+															//	including octets that are still
+															//	buffered.
+	uint64_t			ullSizeEvt;							// ullSize after the current event
+															//	has been written. Compared by
+															//	rotators. See
+															//	ConfigCUNILOG_TARGETrotateAtSize ().
+	uint64_t			ullSizePrv;							// ullSizeEvt of the previous event
+															//	written to the same logfile,
+															//	or 0.
+	bool				bSizeUnseen;						// No event that triggers rotators
+															//	has been written to the logfile
+															//	since it was opened.
 } CUNILOG_LOGFILE;
 
+/*
+	When the data in the write-behind buffer of a target is written to its logfile, apart
+	from the buffer being full, the maximum latency being exceeded, or the logfile being
+	flushed or closed.
+
+	cunilogWriteBehindWhenFull		Only the conditions above. This gives the highest
+									throughput, but up to a full buffer of event lines
+									is lost if the process crashes.
+
+	cunilogWriteBehindEveryBatch	Additionally whenever the separate logging thread has
+									processed all events it took off the queue. Without
+									a separate logging thread this is identical to
+									cunilogWriteBehindWhenFull.
+*/
+enum cunilogwritebehind
+{
+		cunilogWriteBehindWhenFull
+	,	cunilogWriteBehindEveryBatch
+	// Do not add anything below this line.
+	,	cunilogWriteBehindAmountEnumValues					// Used for table sizes.
+	// Do not add anything below cunilogWriteBehindAmountEnumValues.
+};
+typedef enum cunilogwritebehind cunilogwritebehind;
+
+/*
+	CUNILOG_WRITEBEHIND
+
+	The write-behind buffer of a target. Event lines are appended to the buffer, which is
+	written to the logfile with a single write operation. See
+	ConfigCUNILOG_TARGETwriteBehind () in cunilog.h.
+*/
+/*
+	The io_uring instance of a target's write-behind buffer. The rings are shared with
+	the kernel. See ConfigCUNILOG_TARGETioUring ().
+*/
+#ifdef CUNILOG_HAVE_IO_URING
+	typedef struct cunilog_iouring
+	{
+		int							fdRing;					// The io_uring, or -1.
+		void						*pSQ;					// Mapped submission queue ring.
+		size_t						lnSQ;
+		void						*pCQ;					// Mapped completion queue ring.
+		size_t						lnCQ;					//	0 if it shares pSQ.
+		struct io_uring_sqe			*sqes;					// Mapped submission queue entries.
+		size_t						lnSQEs;
+		unsigned int				*sqHead;
+		unsigned int				*sqTail;
+		unsigned int				*sqMask;
+		unsigned int				*sqArray;
+		unsigned int				*cqHead;
+		unsigned int				*cqTail;
+		unsigned int				*cqMask;
+		struct io_uring_cqe			*cqes;
+		char						*buf;					// Buffer in flight.
+		size_t						siz;					// Size of buf in octets.
+		size_t						len;					// Octets in flight.
+		unsigned int				nInFlight;				// Pending completions.
+		bool						bSyncInFlight;			// A datasync is pending.
+	} CUNILOG_IOURING;
+#endif
+
+typedef struct cunilog_writebehind
+{
+	char							*buf;					// The buffer, or NULL if the
+															//	target has none.
+	size_t							siz;					// Size of buf in octets.
+	size_t							len;					// Octets waiting in buf.
+	uint64_t						ullFirst;				// When the oldest octet in buf
+															//	has been added.
+	uint64_t						ullLatency;				// Maximum age of octets in buf
+															//	in FILETIME units.
+	cunilogwritebehind				policy;					// When to write buf.
+	uint64_t						nSyncOctets;			// Sync the logfile after this
+															//	amount of octets, or 0.
+	uint64_t						nUnsynced;				// Octets not synced yet.
+	size_t							nWrites;				// Write operations.
+	struct extcmpframer				*pfr;					// Compresses buf into a frame
+															//	before it is written, or
+															//	NULL. See ExtCompressors.h.
+	#ifdef CUNILOG_HAVE_IO_URING
+		CUNILOG_IOURING				ur;						// Writes buf asynchronously.
+	#endif
+} CUNILOG_WRITEBEHIND;
+
 /*
 	Note that
 	cunilogrotationtask_MoveToTrashLogfiles			and
@@ -18662,6 +19019,9 @@ enum cunilogrotationtask
 	,	cunilogrotationtask_MoveToTrashLogfiles
 	,	cunilogrotationtask_MoveToRecycleBinLogfiles = cunilogrotationtask_MoveToTrashLogfiles
 	,	cunilogrotationtask_DeleteLogfiles
+	,	cunilogrotationtask_ExtCompressLogfiles				// Compress logfiles into new files
+															//	with gzip or zstd and delete
+															//	them. See ExtCompressors.h.
 
 	// Do not add anything below this line.
 	,	cunilogrotationtask_XAmountEnumValues				// Used for table sizes.
@@ -18693,6 +19053,15 @@ typedef struct cunilog_rotation_data
 															//	target is logged to, without
 															//	rotation.
 	uint64_t					uiFlgs;						// Option flags. See below.
+
+	// Retention policy. See CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN ().
+	uint64_t					ullKeepOctets;				// Total size of the logfiles to
+															//	keep. Ignored when 0.
+	uint64_t					ullKeepSeconds;				// Maximum age of a logfile to keep.
+															//	Ignored when 0.
+	uint64_t					nRetainBatch;				// Don't rotate more than this per
+															//	event that triggers the
+															//	rotator. Ignored when 0.
 } CUNILOG_ROTATION_DATA;
 
 /*
@@ -18711,6 +19080,10 @@ typedef struct cunilog_rotation_data
 //	member mbFilToRotate of the CUNILOG_TARGET structure
 #define CUNILOG_ROTATOR_FLAG_USE_MBDSTFILE		SINGLEBIT64 (2)
 
+// A rotator with the task cunilogrotationtask_ExtCompressLogfiles compresses with zstd
+//	(".zst") instead of gzip (".gz").
+#define CUNILOG_ROTATOR_FLAG_ZSTD				SINGLEBIT64 (3)
+
 /*
 	Macros for checking, setting, and clearing some of the flags above.
 */
@@ -18728,6 +19101,10 @@ typedef struct cunilog_rotation_data
 #define cunilogClrRotatorFlag_USE_MBDSTFILE(prd)		\
 	((prd)->uiFlgs &= ~ CUNILOG_ROTATOR_FLAG_USE_MBDSTFILE)
 
+// True if the rotator has a retention policy by size or age.
+#define cunilogHasRotatorRetention(prd)					\
+	((prd)->ullKeepOctets || (prd)->ullKeepSeconds)
+
 
 // Value of member nMaxToRotate of a CUNILOG_ROTATION_DATA structure to be obtained
 //	during initialisation.
@@ -18735,6 +19112,12 @@ typedef struct cunilog_rotation_data
 #define CUNILOG_MAX_ROTATE_AUTO			(UINT64_MAX)
 #endif
 
+// Default value of member nRetainBatch of a CUNILOG_ROTATION_DATA structure with a
+//	retention policy.
+#ifndef CUNILOG_DEFAULT_RETAIN_BATCH
+#define CUNILOG_DEFAULT_RETAIN_BATCH	(16)
+#endif
+
 /*
 	Initialisers for CUNILOG_ROTATION_DATA structures.
 
@@ -18751,7 +19134,8 @@ typedef struct cunilog_rotation_data
 	0, 0, CUNILOG_MAX_ROTATE_AUTO,						\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 
 /*
@@ -18763,7 +19147,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_TRASH(k)\
 {														\
@@ -18771,7 +19156,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_RECYCLE_BIN(k)\
 {														\
@@ -18779,7 +19165,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE(k)\
 {														\
@@ -18787,7 +19174,64 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
+}
+
+/*
+	Argument k is the amount of logfiles to keep/not touch. Logfiles beyond this amount
+	are deleted as usual. Logfiles within this amount are deleted too if, starting with
+	the newest logfile, the total size of the logfiles exceeds o octets, or if they're
+	older than s seconds. Either o or s can be 0 to disable the policy. The sizes and
+	times of the logfiles are obtained once and kept with the files list index, which the
+	rotator enables for its target (see ConfigCUNILOG_TARGETfilesListIndex ()). The active
+	logfile is included in the total size but never deleted. Compressed logfiles created
+	by cunilogrotationtask_ExtCompressLogfiles rotators are included with their compressed
+	size.
+
+	Not more than CUNILOG_DEFAULT_RETAIN_BATCH logfiles (member nRetainBatch) are deleted
+	per event that triggers the rotator. If more are due, the rotator runs again with the
+	next event, independent of its frequency and of the time that has passed since. This
+	only spreads the deletions over several events, which can follow each other closely.
+	It is not a limit of deletions per time period.
+*/
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN(k, o, s)\
+{														\
+	cunilogrotationtask_DeleteLogfiles,					\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	(o), (s), CUNILOG_DEFAULT_RETAIN_BATCH				\
+}
+
+/*
+	Argument k is the amount of logfiles to keep/not touch. The active logfile is never
+	compressed. Targets with a dot number postfix are not supported because compressed
+	logfiles are not renamed. The rotator is ignored in this case, and if its compressor
+	hasn't been built in (see ExtCompressors.h). Compressed logfiles stay in the list of
+	logfiles subsequent rotators work on, hence a rotator with the task
+	cunilogrotationtask_DeleteLogfiles that comes after this one deletes them too. They
+	count towards the logfiles to keep of every rotator, including this one, which skips
+	them.
+*/
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_GZIP(k)	\
+{														\
+	cunilogrotationtask_ExtCompressLogfiles,			\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
+}
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_ZSTD(k)	\
+{														\
+	cunilogrotationtask_ExtCompressLogfiles,			\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_ZSTD,							\
+	0, 0, 0												\
 }
 
 /*
@@ -18799,7 +19243,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 #define CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR	\
 {														\
@@ -18807,7 +19252,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 /*
 	Argument plf is a pointer to a CUNILOG_LOGFILE structure.
@@ -18818,7 +19264,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 #define CUNILOG_INIT_DEF_FLUSHLOGFILE_PROCESSOR			\
 {														\
@@ -18826,7 +19273,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -18840,7 +19288,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -18854,7 +19303,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -18866,7 +19316,38 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
+}
+/*
+	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
+	tsk set to cunilogrotationtask_DeleteLogfiles. Such a structure can be initialised
+	with the CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE() or the
+	CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN() macro.
+*/
+#define CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR(p)	\
+{														\
+	cunilogProcessRotateLogfiles,						\
+	cunilogProcessAppliesTo_Auto,						\
+	0, 0,												\
+	(p),												\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
+}
+/*
+	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
+	tsk set to cunilogrotationtask_ExtCompressLogfiles. Such a structure can
+	be initialised with the CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_GZIP() or the
+	CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_ZSTD() macro.
+*/
+#define CUNILOG_INIT_DEF_LOGFILESEXTCOMPRESS_PROCESSOR(p)\
+{														\
+	cunilogProcessRotateLogfiles,						\
+	cunilogProcessAppliesTo_Auto,						\
+	0, 0,												\
+	(p),												\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 
 
@@ -18876,7 +19357,7 @@ typedef struct cunilog_rotation_data
 	Function/macro to initialise a CUNILOG_PROCESSOR structure. The data (pData) member
 	is set to NULL and the member uiOpts to OPT_CUNPROC_NONE, which means no option flags
 	are set. The caller is responsible for setting those members to their desired values
-	afterwards.
+	afterwards. The processor sees events of all severities and types.
 */
 #define FillCUNILOG_PROCESSOR(cup, task,				\
 								freq, thrs)				\
@@ -18886,10 +19367,13 @@ typedef struct cunilog_rotation_data
 	(cup)->thr		= thrs;								\
 	(cup)->cur		= 0;								\
 	(cup)->pData	= NULL;								\
-	(cup)->uiOpts	= OPT_CUNPROC_NONE;
+	(cup)->uiOpts	= OPT_CUNPROC_NONE;					\
+	(cup)->uiSkipSeverities	= 0;						\
+	(cup)->uiSkipEvtTypes	= 0;
 
 #ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	typedef struct CUNILOG_EVENT CUNILOG_EVENT;
+	typedef struct cunilog_maintjob CUNILOG_MAINTJOB;
 #else
 	typedef struct cunilog_locker
 	{
@@ -18928,7 +19412,163 @@ typedef struct cunilog_rotation_data
 		CUNILOG_EVENT			*last;						// Last event.
 		size_t					num;						// Current amount of queue
 															//	elements.
+		CUNILOG_EVENT			*head;						// Most recently enqueued event
+															//	of the lock-free queue.
 	} CUNILOG_QUEUE_BASE;
+
+	typedef struct cunilog_tls_key
+	{
+		#ifdef OS_IS_WINDOWS
+			DWORD				dwFlsIndex;
+		#else
+			pthread_key_t		tKey;
+		#endif
+		bool					bCreated;
+	} CUNILOG_TLS_KEY;
+
+	/*
+		CUNILOG_STAGING
+
+		A per-thread staging buffer of a target. The events of a thread are collected
+		here and handed over to the queue of the target in batches.
+	*/
+	typedef struct cunilog_staging CUNILOG_STAGING;
+	struct cunilog_staging
+	{
+		CUNILOG_TARGET			*put;						// The target.
+		size_t					nBusy;						// 1 while a thread accesses
+															//	the staged events.
+		CUNILOG_EVENT			*first;						// Oldest staged event.
+		CUNILOG_EVENT			*last;						// Most recently staged event.
+		size_t					num;						// Amount of staged events.
+		size_t					octets;						// Their data size.
+		size_t					nUnclocked;					// Events staged since the
+															//	clock has been read.
+		uint64_t				ullFirst;					// When the oldest event has
+															//	been staged.
+		CUNILOG_STAGING			*nextStaging;				// Next staging buffer of the
+															//	target.
+	};
+
+	/*
+		CUNILOG_EVENTPOOL
+
+		An event pool. Events of up to the largest size class are carved from a bulk memory
+		block and, when they have been processed, returned to the free list of their size
+		class instead of being deallocated. Each pooled event is preceded by a
+		CUNILOG_POOLSLOT header, which is how an event finds its way back to its size class.
+
+		An event that has been handed on to another target via logEv () still returns to
+		the pool it has been taken from. The pool is therefore only deallocated when its
+		target has been destroyed and the last of its events has been returned.
+	*/
+	#ifndef CUNILOG_EVENTPOOL_CLASSES
+	#define CUNILOG_EVENTPOOL_CLASSES		(5)				// 128, 256, 512, 1 KiB, 4 KiB.
+	#endif
+
+	typedef struct cunilog_poolslot CUNILOG_POOLSLOT;
+	typedef struct cunilog_eventpool_class CUNILOG_EVENTPOOL_CLASS;
+
+	struct cunilog_poolslot
+	{
+		CUNILOG_POOLSLOT		*next;						// Next free slot.
+		CUNILOG_EVENTPOOL_CLASS	*pClass;					// The slot's size class.
+	};
+
+	typedef struct cunilog_eventpool CUNILOG_EVENTPOOL;
+
+	struct cunilog_eventpool_class
+	{
+		CUNILOG_EVENTPOOL		*pool;						// The pool of the size class.
+		CUNILOG_POOLSLOT		*free;						// Lock-free list of free slots.
+		CUNILOG_LOCKER			cl;							// Serialises taking slots from
+															//	the free list.
+		size_t					stPayload;					// Octets available for caption
+															//	and data.
+		size_t					nSlots;						// Amount of slots carved so far.
+		size_t					nInUse;						// Slots currently in use.
+		size_t					nAllocs;					// Events served by this class.
+	};
+
+	struct cunilog_eventpool
+	{
+		CUNILOG_LOCKER			cl;							// Protects sbm.
+		SBULKMEM				sbm;						// Memory for the slots.
+		CUNILOG_EVENTPOOL_CLASS	classes [CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nHeapAllocs;				// Events too big for the pool or
+															//	that didn't get a slot.
+		size_t					nRefs;						// 1 for the target plus 1 for
+															//	every slot in use.
+	};
+
+	/*
+		Result structure for getCUNILOG_EVENTPOOLstats ().
+	*/
+	typedef struct cunilog_eventpoolstats
+	{
+		size_t					stPayload	[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nSlots		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nInUse		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nAllocs		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nHeapAllocs;				// Events not served by the pool.
+		SBULKMEMSTATS			sbmStats;					// The pool's bulk memory.
+	} CUNILOG_EVENTPOOLSTATS;
+
+	/*
+		CUNILOG_MAINTENANCE
+
+		The maintenance thread of a target. Rotators hand over jobs that only work on
+		logfiles no longer written to, i.e. file system compression, compression with an
+		external compressor, moving to the recycle bin, and deleting, to this thread
+		instead of carrying them out themselves. The
+		messages of the jobs are collected in the order they are created and logged by
+		the thread that processes the events of the target.
+	*/
+	typedef struct cunilog_maintjob CUNILOG_MAINTJOB;
+	struct cunilog_maintjob
+	{
+		CUNILOG_MAINTJOB			*next;					// Next job.
+		enum cunilogrotationtask	tsk;					// The task to carry out.
+		CUNILOG_TARGET				*plogCUNILOG_TARGET;	// Target for the messages. See
+															//	CUNILOG_ROTATION_DATA.
+		uint64_t					uiFlgs;					// Option flags of the rotator.
+		char						*szFile;				// Full path of the logfile.
+		size_t						stFile;					// Its length incl. NUL terminator.
+		bool						bFailed;				// The logfile couldn't be moved
+															//	or deleted.
+	};
+
+	typedef struct cunilog_maintmsg CUNILOG_MAINTMSG;
+	struct cunilog_maintmsg
+	{
+		CUNILOG_MAINTMSG			*next;					// Next message.
+		CUNILOG_TARGET				*plogCUNILOG_TARGET;	// Target to log to, or NULL.
+		char						*szMsg;					// The message text.
+		size_t						lnMsg;					// Its length.
+	};
+
+	typedef struct cunilog_maintenance
+	{
+		CUNILOG_LOCKER				cl;						// Protects the lists.
+		CUNILOG_SEMAPHORE			sm;						// Posted for each job and to stop.
+		CUNILOG_SEMAPHORE			smIdle;					// Posted when the last job is done
+															//	and bIdleWait is set.
+		CUNILOG_THREAD				th;						// The maintenance thread.
+		CUNILOG_MAINTJOB			*firstJob;				// The job in progress or the next
+															//	one. Removed when done.
+		CUNILOG_MAINTJOB			*lastJob;				// Most recently added job.
+		CUNILOG_MAINTMSG			*firstMsg;				// Oldest message not logged yet.
+		CUNILOG_MAINTMSG			*lastMsg;				// Most recent message.
+		size_t						nMsgs;					// Amount of messages not logged yet.
+		size_t						nJobsDone;				// Amount of jobs the thread has
+															//	carried out.
+		size_t						nResync;				// Not 0 if a logfile removed from
+															//	the files list still exists.
+		int							iPrio;					// The cunilogprio of the thread.
+		bool						bIdleWait;				// Someone waits for smIdle.
+		bool						bStop;					// Leave when all jobs are done.
+		bool						bStopped;				// The thread has been joined.
+	} CUNILOG_MAINTENANCE;
 #endif
 
 /*
@@ -18959,6 +19599,25 @@ enum cunilogeventTSformat
 	// Do not add anything below cunilogEvtTS_AmountEnumValues.
 };
 
+/*
+	CUNILOG_TSPREFIX
+
+	The most recently rendered event timestamp of a target. When the next event's
+	UBF_TIMESTAMP only differs in its time of day, only the digits that changed are
+	patched instead of rendering the whole timestamp again.
+
+	The member tsf is cunilogEvtTS_AmountEnumValues while the cache is empty.
+*/
+typedef struct cunilog_tsprefix
+{
+	UBF_TIMESTAMP					stamp;					// Timestamp in szPrefix.
+	enum cunilogeventTSformat		tsf;					// Format of szPrefix.
+	char							szPrefix [LEN_ISO8601DATETIMESTAMPMS + 3 + 1];
+} CUNILOG_TSPREFIX;
+
+#define InitCUNILOG_TSPREFIX(ptp)						\
+	(ptp)->tsf = cunilogEvtTS_AmountEnumValues
+
 enum cunilogRunProcessorsOnStartup
 {
 		cunilogRunProcessorsOnStartup
@@ -18988,9 +19647,15 @@ typedef struct scunilogdump
 */
 typedef struct cunilog_fls
 {
-	char	*chFilename;
-	size_t	stFilename;
+	char		*chFilename;
+	size_t		stFilename;
+	uint64_t	ullSize;									// Size in octets.
+	uint64_t	ullModified;								// Last write as FILETIME ULONGLONG.
 } CUNILOG_FLS;
+
+// Value of the members ullSize and ullModified of a CUNILOG_FLS structure that haven't
+//	been obtained from the file system yet.
+#define CUNILOG_FLS_UNKNOWN				(UINT64_MAX)
 typedef vec_t(CUNILOG_FLS) vec_cunilog_fls;
 
 /*
@@ -19100,6 +19765,64 @@ typedef struct scunilognpi
 
 typedef struct cunilog_rotator_args CUNILOG_ROTATOR_ARGS;
 
+/*
+	Event severities.
+
+	If changed, please update the copy in the comments of cunilog.c too.
+*/
+enum cunilogeventseverity
+{
+		cunilogEvtSeverityNone									//  0
+	,	cunilogEvtSeverityNonePass								//  1
+	,	cunilogEvtSeverityNoneFail								//  2
+	,	cunilogEvtSeverityNoneWarn								//  3
+	,	cunilogEvtSeverityBlanks								//  4
+	,	cunilogEvtSeverityEmergency								//	5
+	,	cunilogEvtSeverityNotice								//	6
+	,	cunilogEvtSeverityInfo									//  7
+	,	cunilogEvtSeverityMessage								//  8
+	,	cunilogEvtSeverityWarning								//  9
+	,	cunilogEvtSeverityError									// 10
+	,	cunilogEvtSeverityPass									// 11
+	,	cunilogEvtSeverityFail									// 12
+	,	cunilogEvtSeverityCritical								// 13
+	,	cunilogEvtSeverityFatal									// 14
+	,	cunilogEvtSeverityDebug									// 15
+	,	cunilogEvtSeverityTrace									// 16
+	,	cunilogEvtSeverityDetail								// 17
+	,	cunilogEvtSeverityVerbose								// 18
+	,	cunilogEvtSeverityIllegal								// 19
+	// Do not add anything below this line.
+	,	cunilogEvtSeverityXAmountEnumValues						// Used for sanity checks.
+	// Do not add anything below cunilogEvtSeverityXAmountEnumValues.
+};
+typedef enum cunilogeventseverity cueventseverity;
+
+/*
+	Importance of the event severities, from least to most important. These are plain
+	numbers the preprocessor can compare, for instance with CUNILOG_COMPILE_MIN_SEVERITY.
+	The severities in the comments have the same rank as the one in the macro name.
+*/
+#define CUNILOG_SEVRANK_VERBOSE					(0)
+#define CUNILOG_SEVRANK_DETAIL					(1)
+#define CUNILOG_SEVRANK_TRACE					(2)
+#define CUNILOG_SEVRANK_DEBUG					(3)
+#define CUNILOG_SEVRANK_NONE					(4)				// Blanks
+#define CUNILOG_SEVRANK_INFO					(5)				// NonePass, Pass
+#define CUNILOG_SEVRANK_NOTICE					(6)				// Message
+#define CUNILOG_SEVRANK_WARNING					(7)				// NoneWarn
+#define CUNILOG_SEVRANK_ERROR					(8)				// NoneFail, Fail
+#define CUNILOG_SEVRANK_CRITICAL				(9)
+#define CUNILOG_SEVRANK_FATAL					(10)
+#define CUNILOG_SEVRANK_EMERGENCY				(11)			// Illegal
+
+/*
+	Bit masks of event severities for ConfigCUNILOG_TARGETseverityMask ().
+*/
+#define CUNILOG_SEVERITY_BIT(sev)						((uint32_t) 1 << (sev))
+#define CUNILOG_SEVERITY_MASK_ALL						\
+	(CUNILOG_SEVERITY_BIT (cunilogEvtSeverityXAmountEnumValues) - 1)
+
 /*
 	The type/format of an event severity level.
 */
@@ -19130,6 +19853,85 @@ extern cueventsevfmtpy cunilogEvtSeverityTypeDefault;
 */
 extern bool bUseCunilogDefaultOutputColour;
 
+/*
+	What happens to an event when the queue of a target with a separate logging thread
+	has reached its capacity. See ConfigCUNILOG_TARGETqueueLimit ().
+*/
+enum cunilogqueuefullpolicy
+{
+		cunilogQueueFullBlock									// The producer waits (default).
+	,	cunilogQueueFullDropNewest								// The new event is discarded.
+	,	cunilogQueueFullDropOldest								// The oldest queued event is
+																//	discarded.
+	,	cunilogQueueFullDropBelowSeverity						// The new event is discarded if
+																//	its severity is below the
+																//	threshold, otherwise the
+																//	oldest one below it.
+	// Do not add anything below this line.
+	,	cunilogQueueFullAmountEnumValues						// Used for sanity checks.
+	// Do not add anything below cunilogQueueFullAmountEnumValues.
+};
+typedef enum cunilogqueuefullpolicy cuqueuefullpolicy;
+
+/*
+	CUNILOG_BATCHEVENT
+
+	An event as the batch function of a custom processor receives it. The event line
+	has been rendered when the event went through the processors and is kept until the
+	batch function returns. It is NUL-terminated and doesn't contain a line ending. For
+	events of type cunilogEvtTypeDeferredFmt the event line is the only place the
+	formatted text can be found.
+*/
+typedef struct cunilog_batchevent
+{
+	CUNILOG_EVENT					*pev;					// The event.
+	const char						*szLine;				// Its rendered event line.
+	size_t							lnLine;					// Length of szLine.
+} CUNILOG_BATCHEVENT;
+
+/*
+	CUNILOG_BATCH
+
+	The events a processor with a batch function has been handed by the separate logging
+	thread but not processed yet. The processor gets them all at once when the thread has
+	worked through the events it took off the queue. Their event lines are stored in the
+	line buffer of the target. Since this buffer can move while the batch grows, only
+	the offsets of the lines are remembered in pofs. The member szLine of a
+	CUNILOG_BATCHEVENT structure is set just before the batch is handed over.
+*/
+typedef struct cunilog_batch
+{
+	CUNILOG_BATCHEVENT				*pbes;					// The pending events.
+	size_t							*pofs;					// Offsets of their event lines.
+	size_t							nevs;					// Amount of pending events.
+	size_t							size;					// Capacity of pbes and pofs.
+} CUNILOG_BATCH;
+
+/*
+	CUNILOG_PLANSTEP
+
+	One step of the processor plan of a target. The plan is compiled from the processor
+	list of the target when the list is set and whenever a processor is disabled or
+	enabled. It only contains the processors that are not disabled, in their original
+	order, together with everything about them that doesn't change per event.
+*/
+typedef struct cunilog_planstep
+{
+	CUNILOG_PROCESSOR				*cup;					// The processor.
+	bool							(*fnct) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *);
+															// Its processor function.
+	uint32_t						uiFlags;				// See CUNILOG_PLANSTEP_ flags below.
+	CUNILOG_BATCH					*pbt;					// Pending events of a processor
+															//	with a batch function, or NULL.
+} CUNILOG_PLANSTEP;
+
+#define CUNILOG_PLANSTEP_ALWAYS			(1u << 0)			// Frequency is
+															//	cunilogProcessAppliesTo_nAlways.
+#define CUNILOG_PLANSTEP_FORCE_NEXT		(1u << 1)			// OPT_CUNPROC_FORCE_NEXT is set.
+#define CUNILOG_PLANSTEP_ECHO			(1u << 2)			// An echo processor.
+#define CUNILOG_PLANSTEP_BATCH			(1u << 3)			// A custom processor with a
+															//	batch function.
+
 /*
 	SUNILOGTARGET
 
@@ -19153,6 +19955,8 @@ typedef struct CUNILOG_TARGET
 															//	Same as mbLogPath but NUL-terminated
 															//	and without slash at the end.
 		size_t						lnLogFold;				// Its length exl. NUL terminator.
+		int							fdLogFold;				// Directory fd of mbLogFold for
+															//	renameat (), or -1.
 	#endif
 	SMEMBUF							mbLogfileName;			// Path and name of current log file.
 	char							*szDateTimeStamp;		// Points inside mbLogfileName.buf.pch.
@@ -19178,6 +19982,13 @@ typedef struct CUNILOG_TARGET
 	SCUNILOGNPI						scuNPI;					// Information for the next processor.
 	CUNILOG_PROCESSOR				**cprocessors;
 	unsigned int					nprocessors;
+	CUNILOG_PLANSTEP				*plan;					// The processor plan, compiled
+															//	from cprocessors.
+	unsigned int					nplan;					// Steps in plan.
+	CUNILOG_BATCH					*batches;				// Pending events per processor,
+															//	parallel to cprocessors, or
+															//	NULL if no processor has a
+															//	batch function.
 
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 		CUNILOG_LOCKER				cl;						// Locker for events queue.
@@ -19190,19 +20001,87 @@ typedef struct CUNILOG_TARGET
 
 		size_t						nPausedEvents;			// Amount of events queued because
 															//	the logging thread is/was paused.
-	#endif
+
+		size_t						nDbgQueueLocked;		// 1 while the queue is locked. Only
+															//	used in debug versions. Not a
+															//	flag in uiOpts because the
+															//	logging thread changes uiOpts
+															//	without holding the lock.
+
+		size_t						nSepLogThreadIdle;		// 1 if the separate logging thread
+															//	is parked or about to park. Only
+															//	used with coalesced wake-ups.
+		size_t						nSepLogThreadPosts;		// Amount of semaphore posts.
+		size_t						nSepLogThreadWakeups;	// Amount of times the separate
+															//	logging thread blocked on the
+															//	semaphore and woke up again.
+
+		CUNILOG_SEMAPHORE			smQueueSpace;			// Semaphore for producers that
+															//	wait for space in the queue.
+		size_t						nMaxQueuedEvents;		// Capacity of the queue. 0 means
+															//	the queue is unbounded.
+		cuqueuefullpolicy			queueFullPolicy;		// What to do if the queue is full.
+		uint32_t					uiDropSeverities;		// Bit mask of the severities that
+															//	are dropped by the policy
+															//	cunilogQueueFullDropBelowSeverity.
+		size_t						nBlockedProducers;		// Producers waiting for space.
+		size_t						nDroppedEvents [cunilogEvtSeverityXAmountEnumValues];
+															// Dropped events per severity.
+
+		CUNILOG_TLS_KEY				tlsStaging;				// Thread's staging buffer.
+		CUNILOG_LOCKER				clStagings;				// Protects the list of staging
+															//	buffers.
+		CUNILOG_STAGING				*stagings;				// All staging buffers.
+		bool						bStaging;				// Staging buffers are on.
+		bool						bStagingClosed;			// Shutdown has flushed the
+															//	staging buffers. Events
+															//	are not staged anymore.
+		size_t						nStagingEvents;			// Batch size in events.
+		size_t						nStagingOctets;			// Batch size in octets.
+		uint64_t					ullStagingLatency;		// Maximum age of a staged event
+															//	in FILETIME units.
+
+		CUNILOG_EVENTPOOL			*pool;					// The event pool, or NULL.
+
+		CUNILOG_MAINTENANCE			*pmt;					// The maintenance thread, or NULL.
+
+		uint32_t					seqTimestamps;			// Sequence lock of tsc. Odd while
+															//	tsc is updated.
+
+		CUNILOG_EVENT				*pevDeferred;			// Events kept by batch functions.
+		char						*szBatchLines;			// Event lines of the batch.
+		size_t						szBatchLinesSize;		// Capacity of szBatchLines.
+		size_t						lnBatchLines;			// Octets used in szBatchLines.
+		CUNILOG_EVENT				*pevBatchLine;			// Event whose line was stored last.
+		size_t						ofsBatchLine;			// Offset of this line.
+		SMEMBUF						mbEchoBatch;			// Echo output of the current batch.
+		size_t						lnEchoBatch;			// Length of the echo output.
+	#endif
+	UBF_TIMESTAMP_CACHE				tsc;					// Cached local time.
+	CUNILOG_TSPREFIX				tsp;					// Last rendered event timestamp.
 
 	enum cunilogeventTSformat		unilogEvtTSformat;		// The format of an event timestamp.
 	newline_t						unilogNewLine;
 	CUNILOG_LOGFILE					logfile;
+	uint64_t						ullRotateAtSize;		// Rotate when the active logfile
+															//	has reached this size, or 0.
+	CUNILOG_WRITEBEHIND				wb;						// Write-behind buffer.
 	SBULKMEM						sbm;					// Bulk memory block.
 	vec_cunilog_fls					fls;					// The vector with str pointers to
 															//	the files to rotate within sbm.
+	size_t							stFLSorphaned;			// Octets in sbm no longer referenced
+															//	by fls. Files list index only.
+	#ifdef CUNILOG_HAVE_INOTIFY
+		int							fdFLSwatch;				// inotify fd watching mbLogFold
+															//	for the files list index, or -1.
+	#endif
 	// We're not using the configurable dump anymore.
 	//SCUNILOGDUMP					*psdump;				// Holds the dump parameters.
 	ddumpWidth						dumpWidth;
 
 	cueventsevfmtpy					evSeverityType;			// Format of the event severity.
+	uint32_t						uiLogSeverities;		// Bit mask of the severities that
+															//	are logged. Read without a lock.
 
 	CUNILOG_ERROR					error;
 	#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
@@ -19287,9 +20166,6 @@ typedef struct CUNILOG_TARGET
 //	in cunilogerrors.h.
 #define CUNILOGTARGET_ALWAYS_CALL_ERRORCB		SINGLEBIT64 (16)
 
-// Debug flag when the queue is locked. To be removed in the future.
-#define CUNILOGTARGET_DEBUG_QUEUE_LOCKED		SINGLEBIT64 (20)
-
 #define cunilogTargetSetShutdownInitiatedFlag(put)		\
 	((put)->uiOpts |= CUNILOGTARGET_SHUTDOWN_INITIATED)
 #define cunilogTargetHasShutdownInitiatedFlag(put)		\
@@ -19383,11 +20259,11 @@ typedef struct CUNILOG_TARGET
 
 #if defined (DEBUG) && !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY)
 	#define cunilogHasDebugQueueLocked(put)				\
-		((put)->uiOpts & CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked)
 	#define cunilogClrDebugQueueLocked(put)				\
-		((put)->uiOpts &= ~ CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked = 0)
 	#define cunilogSetDebugQueueLocked(put)				\
-		((put)->uiOpts |= CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked = 1)
 #else
 	#define cunilogHasDebugQueueLocked(put)	(true)
 	#define cunilogClrDebugQueueLocked(put)
@@ -19431,6 +20307,70 @@ typedef struct CUNILOG_TARGET
 // Colour information should be used.
 #define CUNILOGTARGET_USE_COLOUR_FOR_ECHO		SINGLEBIT64 (36)
 
+/*
+	The event queue of a target with a separate logging thread is lock-free. Producers
+	push their events with an atomic compare-and-swap operation via the member ->next
+	of the event, and the separate logging thread takes over the entire queue with a
+	single atomic exchange. Without this flag, the queue is protected by the locker
+	of the target.
+
+	This flag must be set before the first event is logged. It is ignored for targets
+	without a separate logging thread.
+*/
+#define CUNILOGTARGET_LOCKFREE_QUEUE			SINGLEBIT64 (37)
+
+/*
+	Wake-ups of the separate logging thread are coalesced. A producer only signals the
+	semaphore of the target when the separate logging thread is parked, or about to
+	park, instead of once per event. Since the separate logging thread always takes
+	over the entire queue, a burst of events then only costs a single semaphore post
+	and a single wait.
+
+	This flag must be set before the first event is logged. It is ignored for targets
+	without a separate logging thread.
+*/
+#define CUNILOGTARGET_COALESCE_WAKEUPS			SINGLEBIT64 (38)
+
+/*
+	Event timestamps are obtained from a cached local time provider instead of
+	LocalTime_UBF_TIMESTAMP (). Only a coarse wall clock is read for every event.
+	Date, time, and UTC offset are recomputed when the second changes. See
+	GetLocalTimeCached_UBF_TIMESTAMP ().
+
+	This flag is set by ConfigCUNILOG_TARGETcachedTimestamps ().
+*/
+#define CUNILOGTARGET_CACHED_TIMESTAMPS			SINGLEBIT64 (39)
+
+/*
+	POSIX only. The logfile is a raw file descriptor opened with O_APPEND and O_CLOEXEC,
+	and event lines are written with writev () instead of going through the buffer of
+	the C runtime library. This is what the Windows version always does.
+
+	This flag is set by ConfigCUNILOG_TARGETrawLogfile ().
+*/
+#define CUNILOGTARGET_RAW_LOGFILE				SINGLEBIT64 (40)
+
+/*
+	POSIX only. The tail of the logfile is preallocated and memory-mapped in chunks, and
+	event lines are copied into the mapping. The logfile is truncated to its real size
+	when it is closed. Implies CUNILOGTARGET_RAW_LOGFILE.
+
+	This flag is set by ConfigCUNILOG_TARGETmappedLogfile ().
+*/
+#define CUNILOGTARGET_MAPPED_LOGFILE			SINGLEBIT64 (41)
+
+/*
+	The files list (member fls) is a persistent index of the logfiles in the logging
+	folder. It is built once, kept sorted, and updated by the rotators instead of being
+	read from disk again for every rotation.
+
+	This flag is set by ConfigCUNILOG_TARGETfilesListIndex ().
+*/
+#define CUNILOGTARGET_FLS_INDEX					SINGLEBIT64 (42)
+
+// The files list index has been built.
+#define CUNILOGTARGET_FLS_INDEX_BUILT			SINGLEBIT64 (43)
+
 /*
 	Macros for public/user/caller flags.
 */
@@ -19470,39 +20410,47 @@ typedef struct CUNILOG_TARGET
 #define cunilogSetEnqueueTimestamps(put)				\
 	((put)->uiOpts |= CUNILOGTARGET_ENQUEUE_TIMESTAMPS)
 
+#define cunilogHasLockFreeQueue(put)					\
+	((put)->uiOpts & CUNILOGTARGET_LOCKFREE_QUEUE)
+#define cunilogClrLockFreeQueue(put)					\
+	((put)->uiOpts &= ~ CUNILOGTARGET_LOCKFREE_QUEUE)
+#define cunilogSetLockFreeQueue(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_LOCKFREE_QUEUE)
+
+#define cunilogHasCoalescedWakeups(put)					\
+	((put)->uiOpts & CUNILOGTARGET_COALESCE_WAKEUPS)
+#define cunilogClrCoalescedWakeups(put)					\
+	((put)->uiOpts &= ~ CUNILOGTARGET_COALESCE_WAKEUPS)
+#define cunilogSetCoalescedWakeups(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_COALESCE_WAKEUPS)
+
+#define cunilogHasCachedTimestamps(put)					\
+	((put)->uiOpts & CUNILOGTARGET_CACHED_TIMESTAMPS)
+#define cunilogSetCachedTimestamps(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_CACHED_TIMESTAMPS)
+
+#define cunilogHasRawLogfile(put)						\
+	((put)->uiOpts & CUNILOGTARGET_RAW_LOGFILE)
+#define cunilogSetRawLogfile(put)						\
+	((put)->uiOpts |= CUNILOGTARGET_RAW_LOGFILE)
+
+#define cunilogHasMappedLogfile(put)					\
+	((put)->uiOpts & CUNILOGTARGET_MAPPED_LOGFILE)
+#define cunilogSetMappedLogfile(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_MAPPED_LOGFILE)
+
+#define cunilogTargetHasFLSindex(put)					\
+	((put)->uiOpts & CUNILOGTARGET_FLS_INDEX)
+#define cunilogTargetSetFLSindex(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_FLS_INDEX)
+
+#define cunilogTargetHasFLSindexBuilt(put)				\
+	((put)->uiOpts & CUNILOGTARGET_FLS_INDEX_BUILT)
+#define cunilogTargetClrFLSindexBuilt(put)				\
+	((put)->uiOpts &= ~ CUNILOGTARGET_FLS_INDEX_BUILT)
+#define cunilogTargetSetFLSindexBuilt(put)				\
+	((put)->uiOpts |= CUNILOGTARGET_FLS_INDEX_BUILT)
 
-/*
-	Event severities.
-
-	If changed, please update the copy in the comments of cunilog.c too.
-*/
-enum cunilogeventseverity
-{
-		cunilogEvtSeverityNone									//  0
-	,	cunilogEvtSeverityNonePass								//  1
-	,	cunilogEvtSeverityNoneFail								//  2
-	,	cunilogEvtSeverityNoneWarn								//  3
-	,	cunilogEvtSeverityBlanks								//  4
-	,	cunilogEvtSeverityEmergency								//	5
-	,	cunilogEvtSeverityNotice								//	6
-	,	cunilogEvtSeverityInfo									//  7
-	,	cunilogEvtSeverityMessage								//  8
-	,	cunilogEvtSeverityWarning								//  9
-	,	cunilogEvtSeverityError									// 10
-	,	cunilogEvtSeverityPass									// 11
-	,	cunilogEvtSeverityFail									// 12
-	,	cunilogEvtSeverityCritical								// 13
-	,	cunilogEvtSeverityFatal									// 14
-	,	cunilogEvtSeverityDebug									// 15
-	,	cunilogEvtSeverityTrace									// 16
-	,	cunilogEvtSeverityDetail								// 17
-	,	cunilogEvtSeverityVerbose								// 18
-	,	cunilogEvtSeverityIllegal								// 19
-	// Do not add anything below this line.
-	,	cunilogEvtSeverityXAmountEnumValues						// Used for sanity checks.
-	// Do not add anything below cunilogEvtSeverityXAmountEnumValues.
-};
-typedef enum cunilogeventseverity cueventseverity;
 
 enum cunilogeventtype
 {
@@ -19519,12 +20467,40 @@ enum cunilogeventtype
 	,	cunilogEvtTypeHexDumpWithCaption16					// Caption length is 16 bit.
 	,	cunilogEvtTypeHexDumpWithCaption32					// Caption length is 32 bit.
 	,	cunilogEvtTypeHexDumpWithCaption64					// Caption length is 64 bit.
+
+		/*
+			Deferred formatting. The data starts with a copy of the NUL-terminated format
+			string, followed by a binary record of the arguments. The text is only rendered when
+			the event line is created, which is on the separate logging thread if the
+			target has one. Member lenDataToLog is the size of the format string and the
+			argument record.
+		*/
+	,	cunilogEvtTypeDeferredFmt							// Format string + arguments.
 	// Do not add anything below this line.
 	,	cunilogEvtTypeAmountEnumValues						// Used for sanity checks.
 	// Do not add anything below cunilogEvtTypeAmountEnumValues.
 };
 typedef enum cunilogeventtype cueventtype;
 
+/*
+	Bit masks of event types for ConfigCUNILOG_PROCESSORfilter ().
+*/
+#define CUNILOG_EVTTYPE_BIT(t)							((uint32_t) 1 << (t))
+#define CUNILOG_EVTTYPES_TEXT										\
+(																	\
+		CUNILOG_EVTTYPE_BIT (cunilogEvtTypeNormalText)				\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeDeferredFmt)				\
+)
+#define CUNILOG_EVTTYPES_HEXDUMP									\
+(																	\
+		CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption8)		\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption16)	\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption32)	\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption64)	\
+)
+#define CUNILOG_EVTTYPES_ALL										\
+	(CUNILOG_EVTTYPE_BIT (cunilogEvtTypeAmountEnumValues) - 1)
+
 /*
 	CUNILOG_EVENT
 
@@ -19621,6 +20597,17 @@ typedef struct CUNILOG_EVENT
 // Only process the echo processor. All others are suppressed.
 #define CUNILOGEVENT_ECHO_ONLY					SINGLEBIT64 (8)
 
+// The structure lives in a slot of the event pool of a target. This is for
+//	DoneCUNILOG_EVENT () to return it to the pool.
+#define CUNILOGEVENT_POOLED						SINGLEBIT64 (9)
+
+// The separate logging thread took the event off the queue together with others. Its
+//	processing may be finished when the thread has worked through all of them.
+#define CUNILOGEVENT_BATCHED					SINGLEBIT64 (10)
+
+// A processor with a batch function keeps the event until the batch is complete.
+#define CUNILOGEVENT_DEFERRED					SINGLEBIT64 (11)
+
 // Macros to set and check flags.
 #define cunilogSetEventAllocated(pev)					\
 	((pev)->uiOpts |= CUNILOGEVENT_ALLOCATED)
@@ -19629,6 +20616,11 @@ typedef struct CUNILOG_EVENT
 #define cunilogIsEventDataAllocated(pev)				\
 	((pev)->uiOpts & CUNILOGEVENT_DATA_ALLOCATED)
 
+#define cunilogIsEventPooled(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_POOLED)
+#define cunilogClrEventPooled(pev)						\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_POOLED)
+
 #define cunilogSetEventShutdown(pev)					\
 	((pev)->uiOpts |= CUNILOGEVENT_SHUTDOWN)
 #define cunilogIsEventShutdown(pev)						\
@@ -19674,6 +20666,20 @@ typedef struct CUNILOG_EVENT
 #define cunilogHasEventEchoOnly(pev)					\
 	((pev)->uiOpts & CUNILOGEVENT_ECHO_ONLY)
 
+#define cunilogSetEventBatched(pev)						\
+	((pev)->uiOpts |= CUNILOGEVENT_BATCHED)
+#define cunilogClrEventBatched(pev)						\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_BATCHED)
+#define cunilogIsEventBatched(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_BATCHED)
+
+#define cunilogSetEventDeferred(pev)					\
+	((pev)->uiOpts |= CUNILOGEVENT_DEFERRED)
+#define cunilogClrEventDeferred(pev)					\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_DEFERRED)
+#define cunilogIsEventDeferred(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_DEFERRED)
+
 /*
 	Return type of the separate logging thread.
 */
@@ -19705,6 +20711,12 @@ typedef struct CUNILOG_EVENT
 */
 typedef bool (*pfCustProc) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *);
 
+/*
+	A batch callback function of a custom/user defined processor. It receives an array
+	of events together with their event lines and the amount of events in this array.
+*/
+typedef bool (*pfCustProcBatch) (CUNILOG_PROCESSOR *, CUNILOG_BATCHEVENT *, size_t);
+
 /*
 	Callback function for cleaning up a custom/user defined processor.
 */
@@ -19720,10 +20732,37 @@ typedef void (*pfDoneProc) (CUNILOG_PROCESSOR *);
 					cast the pData member of the CUNILOG_PROCESSOR structure to a pointer
 					to a CUNILOG_CUSTPROCESS structure.
 	procFnct		Pointer to a custom/user function provided by the caller that handles
-					the processor. This member cannot be NULL.
+					the processor. This member can only be NULL if procBatch is not NULL.
 	procDone		Pointer to a function that is called when the processor is destroyed.
 					This member can be NULL if this custom (or user/external) processor
 					does not require cleanup code.
+	procBatch		Pointer to an optional batch function. This member can be NULL.
+					If the processor's frequency is cunilogProcessAppliesTo_nAlways and
+					its target has a separate logging thread, the events the thread takes
+					off the queue in one go are collected and handed over to procBatch
+					with a single call when all processors have run for them. The
+					remaining processors of the events have run already at that point and
+					the return value of procBatch is ignored. The members mbLogEventLine
+					and lnLogEventLine of the target don't hold the event lines of these
+					events anymore. Each CUNILOG_BATCHEVENT structure therefore carries
+					the event line of its event, which remains valid until procBatch
+					returns. In all other cases, or if memory for the batch can't be
+					obtained, procFnct is called per event. If procFnct is NULL,
+					procBatch is called with a single event and the current event line
+					instead.
+
+					Only custom processors get batches through procBatch. The echo
+					processor collects the echo output of a batch by itself. The
+					processor that writes to the logfile does not batch events. It
+					only writes a batch of event lines with a single call if the
+					target's write-behind buffer has the policy
+					cunilogWriteBehindEveryBatch. See ConfigCUNILOG_TARGETwriteBehind ().
+
+	The member procBatch has been added after procFnct and procDone. Code that initialises
+	a CUNILOG_CUSTPROCESS structure with a brace-enclosed list of three members still
+	compiles and gets a procBatch of NULL, but compilers with warnings about missing field
+	initialisers enabled (like -Wmissing-field-initializers) complain about it. Code that
+	relies on the size or the layout of the structure needs to be compiled again.
 
 	Note that there's no callback function for initialisation. If dynamic initialisation is
 	required, it is recommended to initialise pCust to NULL and initialise the custom data
@@ -19734,6 +20773,7 @@ typedef struct cunilog_customprocess
 	void			*pCust;
 	pfCustProc		procFnct;
 	pfDoneProc		procDone;
+	pfCustProcBatch	procBatch;
 } CUNILOG_CUSTPROCESS;
 
 /*
@@ -20125,9 +21165,11 @@ DoneCUNILOG_TARGETstatic ();
 	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
 		#include "./externC.h"
 		#include "./functionptrtpydef.h"
+		#include "./ExtCompressors.h"
 	#else
 		#include "./../pre/externC.h"
 		#include "./../pre/functionptrtpydef.h"
+		#include "./../extern/ExtCompressors.h"
 	#endif
 
 	#include "./cunilogversion.h"
@@ -20201,12 +21243,17 @@ DoneCUNILOG_TARGETstatic ();
 #define CUNILOG_STD_BULK_ALLOC_SIZE		(4096 - sizeof (SBULKMEMBLOCK))
 #endif
 
+// The default size of a bulk memory block of an event pool.
+#ifndef CUNILOG_STD_EVENTPOOL_SIZE
+#define CUNILOG_STD_EVENTPOOL_SIZE		(256 * 1024)
+#endif
+
 // The size we're going to expand the vector containing the names of logfiles.
 #ifndef CUNILOG_STD_VECT_EXP_SIZE
 #define CUNILOG_STD_VECT_EXP_SIZE		(128)
 #endif
 
-// The stack/heap threshold for the ...sfmt type logging functions.
+// The stack buffer size for the ...fmt type logging and output functions.
 #ifndef CUNILOG_DEFAULT_SFMT_SIZE
 #define CUNILOG_DEFAULT_SFMT_SIZE		(256)
 #endif
@@ -20305,6 +21352,58 @@ DoneCUNILOG_TARGETstatic ();
 	*/
 #else
 	#define CUNILOG_DEFAULT_OPEN_MODE	"a"
+	// The flags and permissions for a raw logfile. See ConfigCUNILOG_TARGETrawLogfile ().
+	#define CUNILOG_DEFAULT_RAW_OPEN_FLAGS	(O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC)
+	#define CUNILOG_DEFAULT_RAW_OPEN_PERMS	(0666)
+	// The flags for a memory-mapped logfile. See ConfigCUNILOG_TARGETmappedLogfile ().
+	#define CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS	(O_RDWR | O_CREAT | O_CLOEXEC)
+#endif
+
+/*
+	The amount of octets a memory-mapped logfile is extended by and mapped at once.
+	See ConfigCUNILOG_TARGETmappedLogfile ().
+*/
+#ifndef CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE
+#define CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE	(4 * 1024 * 1024)
+#endif
+
+/*
+	The priority maintenance threads compress logfiles with, and the amount of logfiles
+	that are compressed at the same time within the process. See
+	cunilogSetCompressionLimits ().
+*/
+#ifndef CUNILOG_DEFAULT_COMPRESSION_PRIORITY
+#define CUNILOG_DEFAULT_COMPRESSION_PRIORITY		(cunilogPrioBelowNormal)
+#endif
+#ifndef CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS
+#define CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS	(1)
+#endif
+
+/*
+	The amount of uncompressed octets per frame of a compressed logfile. See
+	ConfigCUNILOG_TARGETcompressedLogfile ().
+*/
+#ifndef CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE
+#define CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE		(256 * 1024)
+#endif
+
+/*
+	The size of the active logfile in octets at which it is rotated if the target
+	has been created with a postfix of cunilogPostfixDotNumberSize. See
+	ConfigCUNILOG_TARGETrotateAtSize ().
+*/
+#ifndef CUNILOG_DEFAULT_ROTATE_AT_SIZE
+#define CUNILOG_DEFAULT_ROTATE_AT_SIZE				(10 * 1024 * 1024)
+#endif
+
+/*
+	The least important severity rank (CUNILOG_SEVRANK_VERBOSE to CUNILOG_SEVRANK_EMERGENCY)
+	whose severity logging macros are compiled in. See logDebugU8l () and friends.
+	Define it as CUNILOG_SEVRANK_INFO, for instance, to compile out Debug, Trace, Detail,
+	and Verbose events.
+*/
+#ifndef CUNILOG_COMPILE_MIN_SEVERITY
+#define CUNILOG_COMPILE_MIN_SEVERITY				CUNILOG_SEVRANK_VERBOSE
 #endif
 
 EXTERN_C_BEGIN
@@ -21271,6 +22370,593 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 	#endif
 #endif
 
+/*
+	ConfigCUNILOG_TARGETseverityMask
+	ConfigCUNILOG_TARGETminSeverity
+
+	Set the severities of the events the target put points to logs. The logging functions
+	check the severity of an event before it is created, formatted, or queued, and return
+	true without doing anything else if the target doesn't log it. By default a target
+	logs events of all severities. Events created by the caller and logged with logEv ()
+	are not checked.
+
+	ConfigCUNILOG_TARGETseverityMask () sets the severities from a bit mask, in which
+	the bit CUNILOG_SEVERITY_BIT (sev) stands for the severity sev. A value of
+	CUNILOG_SEVERITY_MASK_ALL logs all severities, a value of 0 none at all.
+
+	ConfigCUNILOG_TARGETminSeverity () only logs the severities that are at least as
+	important as sevMin. See ConfigCUNILOG_TARGETqueueLimit () for the order of
+	importance. A sevMin of cunilogEvtSeverityInfo for instance stops Debug, Trace,
+	Detail, and Verbose events.
+
+	Unlike the other configuration functions, these functions can be called at any time,
+	also while other threads are logging to the target.
+*/
+void ConfigCUNILOG_TARGETseverityMask (CUNILOG_TARGET *put, uint32_t uiMask)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETseverityMask) (CUNILOG_TARGET *put, uint32_t uiMask)
+;
+void ConfigCUNILOG_TARGETminSeverity (CUNILOG_TARGET *put, cueventseverity sevMin)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETminSeverity) (CUNILOG_TARGET *put, cueventseverity sevMin)
+;
+
+/*
+	cunilogSeverityMaskFromMin
+
+	Returns a bit mask of all severities that are at least as important as sevMin, as
+	used by ConfigCUNILOG_TARGETminSeverity (). The mask can be passed on to
+	ConfigCUNILOG_TARGETseverityMask () or ConfigCUNILOG_PROCESSORfilter ().
+*/
+uint32_t cunilogSeverityMaskFromMin (cueventseverity sevMin)
+;
+TYPEDEF_FNCT_PTR (uint32_t, cunilogSeverityMaskFromMin) (cueventseverity sevMin)
+;
+
+/*
+	ConfigCUNILOG_TARGETqueueLimit
+
+	Limits the amount of events the queue of a target with a separate logging thread can
+	hold. Without a limit, which is the default, the queue grows as long as the separate
+	logging thread can't keep up, for instance when writing to the logfile stalls.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nMaxEvents			The maximum amount of queued events. If 0, the queue is
+						unbounded.
+
+	policy				What happens to a new event when the queue is full:
+						cunilogQueueFullBlock: The producer waits until the separate
+						logging thread has emptied the queue. If the target is paused, or
+						if the producer is the separate logging thread itself, the new event
+						is dropped instead. Staged events the separate logging thread hands
+						over to the queue (see ConfigCUNILOG_TARGETstagingBuffers ()) are
+						queued regardless of the limit.
+						cunilogQueueFullDropNewest: The new event is dropped.
+						cunilogQueueFullDropOldest: The oldest queued event is dropped. With
+						a lock-free queue (CUNILOGTARGET_LOCKFREE_QUEUE) the new event is
+						dropped instead.
+						cunilogQueueFullDropBelowSeverity: The new event is dropped if its
+						severity is less important than sevThreshold. Otherwise the oldest
+						queued event that is less important than sevThreshold is dropped.
+						If there's no such event, the producer waits like with
+						cunilogQueueFullBlock. With a lock-free queue the producer waits
+						without dropping a queued event. From least to most important the
+						severities are Verbose, Detail, Trace, Debug, None/Blanks,
+						Info/Pass/NonePass, Message/Notice, Warning/NoneWarn,
+						Error/Fail/NoneFail, Critical, Fatal, and Emergency/Illegal.
+
+	sevThreshold		The severity threshold for cunilogQueueFullDropBelowSeverity. The
+						parameter is ignored by the other policies.
+
+	Internal events, command events, and the shutdown event are never dropped. The member
+	nDroppedEvents of the target counts the dropped events per severity. Dropping an event
+	is not an error. The logging functions return true for an event that has been dropped
+	because the queue is full. With a lock-free queue the limit is approximate, as it can
+	be exceeded by the amount of concurrent producers.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	void ConfigCUNILOG_TARGETqueueLimit	(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	;
+	TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETqueueLimit)
+										(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	;
+#else
+	#define ConfigCUNILOG_TARGETqueueLimit(put, n, policy, sev)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETstagingBuffers
+
+	Switches on per-thread staging buffers for a target with a separate logging thread.
+	Each thread that logs collects its events in its own staging buffer first and hands
+	them over to the queue of the target in batches. This reduces the contention on the
+	queue and the amount of wake-ups of the separate logging thread for threads that log
+	a lot.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nEvents				The staged events of a thread are handed over to the queue when
+						their amount reaches nEvents. If 0, the amount is not checked.
+
+	nOctets				The staged events of a thread are handed over to the queue when
+						their data reaches nOctets octets. If 0, the data size is not
+						checked.
+
+	msLatency			The maximum time in milliseconds an event stays in a staging
+						buffer. The separate logging thread also hands over the events of
+						threads that have stopped logging after this time. If 0, events
+						only leave the staging buffer of a thread when one of the other
+						limits is reached, when the thread logs an event that can't be
+						staged, when it exits, or when the target is shut down. A thread
+						that keeps logging checks the latency only every
+						CUNILOG_STAGING_CLOCK_EVENTS events.
+
+	Staging buffers are switched on if nEvents is greater than 1, or if nOctets or
+	msLatency are not 0. They are switched off if all three limits are 0, or if nEvents is 1
+	and the other two are 0.
+
+	Internal events, command events, and the shutdown event are not staged. The staged
+	events of a thread are handed over to the queue before such an event is enqueued, so
+	the events of a thread stay in order. ShutdownCUNILOG_TARGET () hands over the staged
+	events of all threads. Events logged after this are not staged anymore but enqueued
+	directly.
+
+	The function returns true on success. It returns false if the target doesn't have a
+	separate logging thread or the thread-local storage could not be created.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETstagingBuffers	(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETstagingBuffers)
+											(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	;
+#else
+	#define ConfigCUNILOG_TARGETstagingBuffers(put, nev, noct, ms)	\
+		(false)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETeventPool
+
+	Creates an event pool for the target put points to. Events of the target are then
+	taken from size classes for 128, 256, 512, 1024, and 4096 octets of caption and data
+	instead of being allocated on the heap, and returned to the free list of their size
+	class after they have been processed. Bigger events are still allocated on the heap.
+	The slots are carved from bulk memory blocks of stBulkSize octets. If stBulkSize is 0,
+	CUNILOG_STD_EVENTPOOL_SIZE is used. The memory of the pool is only deallocated when
+	the target is destroyed with DoneCUNILOG_TARGET ().
+
+	Events created with one of the CreateCUNILOG_EVENT_ () functions must be logged to
+	the same target, or at least to a target that is destroyed after it.
+
+	The function returns true on success, false if the pool could not be allocated.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETeventPool (CUNILOG_TARGET *put, size_t stBulkSize)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETeventPool) (CUNILOG_TARGET *put, size_t stBulkSize)
+	;
+#else
+	#define ConfigCUNILOG_TARGETeventPool(put, siz)	\
+		(false)
+#endif
+
+/*
+	getCUNILOG_EVENTPOOLstats
+
+	Fills the CUNILOG_EVENTPOOLSTATS structure pStats points to with the statistics of
+	the event pool of the target put points to. Neither parameter must be NULL.
+
+	The function returns false if the target doesn't have an event pool.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool getCUNILOG_EVENTPOOLstats (CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	;
+	TYPEDEF_FNCT_PTR (bool, getCUNILOG_EVENTPOOLstats)
+		(CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	;
+#else
+	#define getCUNILOG_EVENTPOOLstats(pstats, put)	\
+		(false)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETcachedTimestamps
+
+	Lets the target put points to obtain the timestamps of its events from a cached
+	local time provider instead of calling LocalTime_UBF_TIMESTAMP () for every event.
+	The provider only reads a coarse wall clock per event. Date, time, and UTC offset
+	are recomputed once per second. See GetLocalTimeCached_UBF_TIMESTAMP () for details.
+	If the target can be used by several threads, its cache is protected by a locker.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETcachedTimestamps (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETcachedTimestamps) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETwriteBehind
+
+	Configures the write-behind buffer of the target put points to. Event lines for the
+	logfile are appended to the buffer instead of being written one by one, and the
+	buffer is written to the logfile with a single write operation. On POSIX the buffer
+	of the C runtime library is bypassed.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nOctets				The size of the buffer in octets, for instance 64 KiB to 4 MiB.
+						The buffer is written when the next event line doesn't fit
+						anymore. An event line bigger than the buffer is written together
+						with the buffer. A value of 0 switches the write-behind buffer
+						off again.
+
+	msLatency			The maximum time in milliseconds an event line stays in the
+						buffer. A target with a separate logging thread writes the buffer
+						out after this time even if no further event arrives. Other targets
+						check this when the next event line is added. If 0, the age of
+						the data in the buffer is not checked.
+
+	policy				cunilogWriteBehindWhenFull or cunilogWriteBehindEveryBatch. See
+						enum cunilogwritebehind in cunilogstructs.h. The logfile is only
+						written to in batches with cunilogWriteBehindEveryBatch. Unlike
+						custom processors with a batch function (member procBatch of a
+						CUNILOG_CUSTPROCESS structure), the processor that writes to the
+						logfile has no batch mode of its own.
+
+	nSyncOctets			The logfile is synchronised to disk with fdatasync () (fsync () on
+						macOS, FlushFileBuffers () on Windows) after this many octets
+						have been written. If 0, this is left to the operating system.
+
+	Together the parameters decide how many event lines can be lost if the process or the
+	machine crashes. The buffer is also written before the logfile is closed or changed,
+	and when the target is shut down. A cunilogProcessFlushLogFile processor does not
+	write out the buffer. It only flushes what has been written already.
+
+	The function returns true on success, false if the buffer could not be allocated.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETwriteBehind	(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETwriteBehind)
+										(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+;
+
+/*
+	ConfigCUNILOG_TARGETrawLogfile
+
+	POSIX only. Opens the logfile of the target put points to as a raw file descriptor
+	with the flags CUNILOG_DEFAULT_RAW_OPEN_FLAGS (O_APPEND and O_CLOEXEC) instead of a
+	FILE stream. Event lines are then written with writev () directly from the event
+	line buffer, without the locking of the C runtime library and without being copied
+	into its buffer first. Every event line, or the content of the write-behind buffer,
+	is appended with a single system call. A cunilogProcessFlushLogFile processor has
+	nothing to flush for a raw logfile.
+
+	If the logfile is open already, it is closed and reopened when the next event is
+	written.
+
+	The function does nothing on Windows, where the logfile is always a raw file handle
+	opened with FILE_APPEND_DATA.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETrawLogfile (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETrawLogfile) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETioUring
+
+	Linux only. Writes the write-behind buffer of the target put points to asynchronously
+	through an io_uring instead of with writev (). While the kernel writes one buffer,
+	event lines are rendered into a second one of the same size, which means a separate
+	logging thread overlaps writing a batch of event lines with formatting the next one.
+	The datasync after nSyncOctets (see ConfigCUNILOG_TARGETwriteBehind ()) is linked to the
+	write and submitted together with it. At most one write is in flight at any time,
+	which keeps the event lines in order.
+
+	ConfigCUNILOG_TARGETwriteBehind () must have been called before. If it is called again
+	with a different buffer size, the second buffer is resized too. The function does
+	nothing for a memory-mapped logfile (see ConfigCUNILOG_TARGETmappedLogfile ()).
+
+	The function returns true if the target uses io_uring. It returns false if the kernel
+	doesn't provide io_uring, doesn't support IORING_OP_WRITE (Linux 5.6 and later), or
+	doesn't allow the process to use it, if the target has
+	no write-behind buffer, or if the build has no io_uring support. The write-behind
+	buffer is then written with writev () as before. The function always returns false
+	on other platforms than Linux, or if CUNILOG_BUILD_WITHOUT_IO_URING is defined.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETioUring (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETioUring) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETmappedLogfile
+
+	POSIX only. Writes event lines of the target put points to by copying them into a
+	shared memory mapping of the logfile instead of issuing a system call per event
+	line. The logfile is opened with CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS. Its tail is
+	preallocated (posix_fallocate () on Linux, ftruncate () elsewhere) and mapped in
+	chunks of nChunk octets. A new chunk is preallocated and mapped when the current one
+	is full. When the logfile is closed, for instance because the date postfix of the
+	logfile name changes, the chunk is unmapped and the logfile is truncated to the
+	octets actually written.
+
+	nChunk is rounded up to a multiple of the page size. If nChunk is 0, the chunk size
+	is CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE.
+
+	While the logfile is open, its size as seen by other processes includes the NUL
+	octets of the preallocated but not yet written part of the current chunk. If the
+	process terminates without closing the logfile, these NUL octets remain. They are
+	removed again the next time the logfile is opened by this function.
+
+	The function implies ConfigCUNILOG_TARGETrawLogfile (). The write-behind buffer
+	(see ConfigCUNILOG_TARGETwriteBehind ()) is copied into the mapping too but is not
+	required. A cunilogProcessFlushLogFile processor has nothing to flush. The kernel
+	writes the mapped pages back to disk by itself. Write-behind sync octets (parameter
+	nSyncOctets of ConfigCUNILOG_TARGETwriteBehind ()) are honoured with msync ().
+
+	If the logfile is open already, it is closed and reopened when the next event is
+	written.
+
+	The function does nothing on Windows.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETmappedLogfile (CUNILOG_TARGET *put, size_t nChunk)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETmappedLogfile) (CUNILOG_TARGET *put, size_t nChunk)
+;
+
+/*
+	ConfigCUNILOG_TARGETcompressedLogfile
+
+	Writes the logfile of the target put points to compressed. The event lines are
+	collected in the write-behind buffer, which is compressed into an independent frame
+	every time it is written out. With extcompressor_gzip every frame is a gzip member of
+	its own, with extcompressor_zstd a zstd frame with a checksum. A logfile that consists
+	of such frames is a valid gzip or zstd file and can be read with zcat, zstdcat, or
+	similar tools.
+
+	If the process or the machine crashes, at most the frame that is being written and the
+	event lines still waiting in the write-behind buffer are lost. Every frame before it
+	can still be decompressed. When the logfile is opened again, for instance after a
+	restart, the incomplete frame is cut off before new frames are appended. A logfile that
+	doesn't start with a frame of the compressor, like one that has been written
+	uncompressed before, is compressed into a single frame first. The logfile can then be
+	read with zcat or zstdcat again. See ExtCompressFramesRepairFile () in ExtCompressors.h.
+	Opening the logfile reads it once completely for this.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	cmp					The compressor. See enum enextcompressor in ExtCompressors.h.
+
+	level				The compression level, or EXT_COMPRESSOR_DEFAULT_LEVEL for the
+						default level of the compressor.
+
+	nFrameOctets		The amount of uncompressed octets per frame. The write-behind
+						buffer is resized to this amount. If 0, the frame size is
+						CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE. Bigger frames compress
+						better, smaller ones lose less data in a crash.
+
+	The latency, policy, and sync octets of the write-behind buffer apply unchanged (see
+	ConfigCUNILOG_TARGETwriteBehind ()). Every time the buffer is written out a frame is
+	completed. A short latency or cunilogWriteBehindEveryBatch therefore creates many
+	small frames, which compress noticeably worse. An io_uring (see
+	ConfigCUNILOG_TARGETioUring ()) is not used for a compressed logfile. Switching the
+	write-behind buffer off with ConfigCUNILOG_TARGETwriteBehind () also switches
+	compression off.
+
+	The logfile keeps its name and the extension ".log", which the rotators rely on. The
+	decompression tools read the logfile regardless of its extension. Rotators with the
+	task cunilogrotationtask_ExtCompressLogfiles skip the logfiles of a target with a
+	compressed logfile.
+
+	The function returns true on success. It returns false if the compressor hasn't been
+	built in (see ExtCompressors.h) or if not enough memory is available. The logfile is
+	written uncompressed in this case, as before.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETcompressedLogfile	(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETcompressedLogfile)
+											(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+;
+
+/*
+	ConfigCUNILOG_TARGETfilesListIndex
+
+	Keeps the list of logfiles the rotation processors of the target put points to work
+	on as a persistent index. Without the index, the logging folder is read and the list
+	of its logfiles is sorted again every time a rotator is triggered, which can take
+	several milliseconds on the logging thread if the folder contains many logfiles.
+
+	The index is built and sorted when a rotator is triggered for the first time. After
+	this, it is only updated with the changes cunilog makes itself: new logfiles, renamed
+	logfiles, and logfiles that are moved to the recycle bin or deleted. Logfiles that
+	are created, renamed, or deleted by other processes are therefore not noticed.
+
+	If bWatchFolder is true, the logging folder is additionally watched with inotify on
+	Linux. Each time a rotator is triggered, pending notifications for logfiles are applied
+	to the index before it is used. If the kernel's notification queue overflowed or the
+	logging folder has been moved or deleted, the index is built again from disk.
+
+	The function returns false if bWatchFolder is true but the logging folder cannot be
+	watched, for instance because the inotify instance limit of the user has been reached.
+	The index is kept nevertheless. It returns true otherwise. bWatchFolder is ignored
+	on other platforms than Linux and if CUNILOG_BUILD_WITHOUT_INOTIFY is defined, in which
+	case the function returns false if bWatchFolder is true.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETfilesListIndex (CUNILOG_TARGET *put, bool bWatchFolder)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETfilesListIndex) (CUNILOG_TARGET *put, bool bWatchFolder)
+;
+
+/*
+	ConfigCUNILOG_TARGETrotateAtSize
+
+	Sets the size in octets at which the active logfile of the target put points to is
+	rotated. The size is the actual size of the logfile on disk, including line endings,
+	event lines still waiting in the write-behind buffer, and the compressed frames of a
+	compressed logfile (see ConfigCUNILOG_TARGETcompressedLogfile ()). It is obtained
+	from the file system when the logfile is opened and kept up to date with every
+	event written.
+
+	Size-triggered rotation is only supported for targets with one of the dot number
+	postfixes, as the rotated logfiles of the other postfixes carry the timestamp of their
+	period, which would be identical for two rotations within the same period. With a
+	postfix of cunilogPostfixDotNumberSize, logfiles are only rotated by size, and
+	the size defaults to CUNILOG_DEFAULT_ROTATE_AT_SIZE. With any other dot number postfix
+	logfiles are rotated when their period has ended or when they reached nOctets,
+	whichever comes first. A rotation processor with the frequency
+	cunilogProcessAppliesTo_nOctets uses its own threshold instead of nOctets.
+
+	The size triggers the rotators of the target only once per logfile, with the event
+	that makes the logfile reach nOctets, or with the first event written to a logfile
+	that already exceeds it. A logfile that stays over nOctets, for instance because it
+	couldn't be renamed, is not rotated again with every subsequent event.
+
+	An nOctets of 0 switches size-triggered rotation off. If nOctets is not 0, the list of
+	logfiles is kept as an index (see ConfigCUNILOG_TARGETfilesListIndex ()), so that
+	the logging folder isn't read again for every rotation.
+
+	The function returns false if the target has not been created with a dot number
+	postfix, true otherwise.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETrotateAtSize (CUNILOG_TARGET *put, uint64_t nOctets)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETrotateAtSize) (CUNILOG_TARGET *put, uint64_t nOctets)
+;
+
+/*
+	ConfigCUNILOG_TARGETmaintenanceThread
+
+	Starts a maintenance thread for the target put points to. Rotators of the target with
+	the tasks cunilogrotationtask_FScompressLogfiles, cunilogrotationtask_MoveToRecycleBinLogfiles,
+	and cunilogrotationtask_DeleteLogfiles then hand the logfiles they would otherwise process
+	themselves over to this thread as jobs and return straight away. Events continue to be
+	written to the active logfile while the jobs are carried out. Renaming logfiles is never
+	handed over because it includes the active logfile.
+
+	Rotators with the task cunilogrotationtask_ExtCompressLogfiles start the maintenance
+	thread themselves the first time they're triggered if it hasn't been started yet,
+	since compressing a logfile can take a while.
+
+	The messages of the jobs are logged in the order they have been created by the thread
+	that processes the events of the target. This happens before the next event is written,
+	or when the target is shut down with ShutdownCUNILOG_TARGET () or CancelCUNILOG_TARGET (),
+	which both wait for the maintenance thread to finish its remaining jobs first. Messages
+	not logged yet are discarded by DoneCUNILOG_TARGET ().
+
+	A rotator still waits for the jobs of earlier rotations to be done before it renames
+	dot number logfiles, and before it reads the logging folder, which it doesn't need to
+	with ConfigCUNILOG_TARGETfilesListIndex (). With the usual rotation frequencies of an
+	hour or more, the jobs are long done by then.
+
+	Logfiles that are moved to the recycle bin or deleted are removed from the list of
+	logfiles when they are handed over. If the maintenance thread cannot remove a logfile,
+	the list is read from disk again the next time a rotator is triggered.
+
+	The function returns true on success, false if the maintenance thread could not be
+	created.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETmaintenanceThread (CUNILOG_TARGET *put)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETmaintenanceThread) (CUNILOG_TARGET *put)
+	;
+#else
+	#define ConfigCUNILOG_TARGETmaintenanceThread(put)	\
+		(false)
+#endif
+
 /*
 	ConfigCUNILOG_TARGETprocessorList
 
@@ -21313,11 +22999,72 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 				prepareProcessors (put, cuProcessorList, nProcessors)
 #endif
 
+/*
+	ConfigCUNILOG_PROCESSORfilter
+
+	Sets the severities and event types the processor cup points to processes. Events
+	with other severities or types skip the processor, as if it was disabled for them
+	(see OPT_CUNPROC_DISABLED), and carry on with the next processor. Skipped events
+	don't count towards the processor's threshold either.
+
+	Parameters
+
+	cup					A pointer to the CUNILOG_PROCESSOR structure.
+
+	uiSeverities		A bit mask of the severities the processor processes. The bit
+						CUNILOG_SEVERITY_BIT (sev) stands for the severity sev. Use
+						CUNILOG_SEVERITY_MASK_ALL for all severities, or obtain a mask with
+						cunilogSeverityMaskFromMin ().
+
+	uiEvtTypes			A bit mask of the event types the processor processes. The bit
+						CUNILOG_EVTTYPE_BIT (t) stands for the event type t.
+						CUNILOG_EVTTYPES_TEXT are text events, CUNILOG_EVTTYPES_HEXDUMP
+						hex dumps, and CUNILOG_EVTTYPES_ALL are all event types. Command
+						events are carried out before any processor runs, hence they're not
+						affected.
+
+	Processors initialised with the CUNILOG_INIT_DEF_ macros or FillCUNILOG_PROCESSOR ()
+	process all severities and types. For instance, to only echo warnings and more
+	important events to the console while still writing everything to the logfile:
+
+	CUNILOG_PROCESSOR cpEcho = CUNILOG_INIT_DEF_ECHO_PROCESSOR;
+	ConfigCUNILOG_PROCESSORfilter	(
+		&cpEcho, cunilogSeverityMaskFromMin (cunilogEvtSeverityWarning),
+		CUNILOG_EVTTYPES_ALL
+									);
+
+	The function should be called before the processor is handed over to a target, or
+	while the target is paused.
+*/
+void ConfigCUNILOG_PROCESSORfilter	(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORfilter)
+									(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+;
+
 /*
 	ConfigCUNILOG_TARGETdisableTaskProcessors
 	ConfigCUNILOG_TARGETenableTaskProcessors
 
-	Disables/enables processors for task task.
+	Disables/enables processors for task task. The processor plan of the target is
+	compiled again, which leaves out disabled processors.
+
+	If the target has a separate logging thread, the change is queued as a command event
+	instead (see ChangeCUNILOG_TARGETdisableTaskProcessors ()). It takes effect for the
+	events logged after the call. If CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS is defined, the
+	functions must not be called while the separate logging thread processes events.
+
+	The flag OPT_CUNPROC_DISABLED of a processor that belongs to a target must not be set or
+	cleared directly. A direct change is ignored until the plan is compiled again, and
+	debug versions assert when they come across a disabled processor in the plan.
 */
 void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
 void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
@@ -21332,7 +23079,8 @@ TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETenableTaskProcessors)
 	ConfigCUNILOG_TARGETenableEchoProcessor
 
 	Disables/enables echo (console output) processors. Echo or console output processors
-	are processors whose task is cunilogProcessEchoToConsole.
+	are processors whose task is cunilogProcessEchoToConsole. See
+	ConfigCUNILOG_TARGETdisableTaskProcessors ().
 */
 void ConfigCUNILOG_TARGETdisableEchoProcessor	(CUNILOG_TARGET *put);
 void ConfigCUNILOG_TARGETenableEchoProcessor	(CUNILOG_TARGET *put);
@@ -21765,13 +23513,18 @@ TYPEDEF_FNCT_PTR (bool, logEv) (CUNILOG_TARGET *put, CUNILOG_EVENT *pev);
 	to a buffer provided by the caller like standard library functions vsnprintf () and family
 	would.
 
-	The fmt versions offer variadic functionality like printf () does. The function
-	logTextU8fmt () uses an additional memory allocation and deallocation internally. The sfmt
-	type functions like logTextU8sfmt () attempt to use the stack for the fmt output if less
-	than CUNILOG_DEFAULT_SFMT_SIZE bytes are required. Otherwise the heap is used.
+	The fmt versions offer variadic functionality like printf () does. They format the output
+	into a stack buffer of CUNILOG_DEFAULT_SFMT_SIZE octets first. If the output doesn't fit,
+	it is formatted a second time directly into the event's data area. No additional heap
+	buffer is required. The sfmt type functions like logTextU8sfmt () are identical to their
+	fmt counterparts and only exist for compatibility.
 	
 	Function names containing a "q" (for quick) do not invoke any rotation processors.
 
+	Function names containing a "d" (for deferred) only capture the format string and the
+	arguments. The text is rendered on the separate logging thread when the event line is
+	created. See logTextU8dfmt () below.
+
 	The functions logTextU8smbfmtsev () and logTextU8smbfmt () additionally expect an
 	initialised parameter structure of type SMEMBUF. The SMEMBUF structure can be re-used
 	for consecutive calls. Within the same thread this can save memory allocations if the
@@ -21887,6 +23640,248 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 #define logTextU8csfmtsev_static(s, ...)				\
 										logTextU8csfmtsev	(pCUNILOG_TARGETstatic, (s), __VA_ARGS__);
 
+/*
+	logVerboseU8l				logVerboseU8fmt
+	logDetailU8l				logDetailU8fmt
+	logTraceU8l					logTraceU8fmt
+	logDebugU8l					logDebugU8fmt
+	logInfoU8l					logInfoU8fmt
+	logNoticeU8l				logNoticeU8fmt
+	logMessageU8l				logMessageU8fmt
+	logWarningU8l				logWarningU8fmt
+	logErrorU8l					logErrorU8fmt
+	logCriticalU8l				logCriticalU8fmt
+	logFatalU8l					logFatalU8fmt
+	logEmergencyU8l				logEmergencyU8fmt
+
+	Macros over logTextU8sevl () and logTextU8sfmtsev () with the severity in their names.
+	The _static versions use the module's internal static CUNILOG_TARGET structure.
+
+	A macro whose severity rank (see CUNILOG_SEVRANK_VERBOSE and friends) is below
+	CUNILOG_COMPILE_MIN_SEVERITY expands to nothing but ((void) 0). Its arguments are
+	not evaluated then, which makes a compiled-out call free. This happens at compile
+	time and is independent of ConfigCUNILOG_TARGETminSeverity () and
+	ConfigCUNILOG_TARGETseverityMask (), which filter at runtime.
+
+	To behave the same in both cases, the macros have no value. Call logTextU8sevl () or
+	logTextU8sfmtsev () directly if the return value is needed.
+*/
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_VERBOSE
+	#define logVerboseU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityVerbose, (t), (l)))
+	#define logVerboseU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityVerbose, __VA_ARGS__))
+	#define logVerboseU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityVerbose, (t), (l)))
+	#define logVerboseU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityVerbose, __VA_ARGS__))
+#else
+	#define logVerboseU8l(p, t, l)				((void) 0)
+	#define logVerboseU8fmt(p, ...)				((void) 0)
+	#define logVerboseU8l_static(t, l)			((void) 0)
+	#define logVerboseU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_DETAIL
+	#define logDetailU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityDetail, (t), (l)))
+	#define logDetailU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityDetail, __VA_ARGS__))
+	#define logDetailU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityDetail, (t), (l)))
+	#define logDetailU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityDetail, __VA_ARGS__))
+#else
+	#define logDetailU8l(p, t, l)				((void) 0)
+	#define logDetailU8fmt(p, ...)				((void) 0)
+	#define logDetailU8l_static(t, l)			((void) 0)
+	#define logDetailU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_TRACE
+	#define logTraceU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityTrace, (t), (l)))
+	#define logTraceU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityTrace, __VA_ARGS__))
+	#define logTraceU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityTrace, (t), (l)))
+	#define logTraceU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityTrace, __VA_ARGS__))
+#else
+	#define logTraceU8l(p, t, l)				((void) 0)
+	#define logTraceU8fmt(p, ...)				((void) 0)
+	#define logTraceU8l_static(t, l)			((void) 0)
+	#define logTraceU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_DEBUG
+	#define logDebugU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityDebug, (t), (l)))
+	#define logDebugU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityDebug, __VA_ARGS__))
+	#define logDebugU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityDebug, (t), (l)))
+	#define logDebugU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityDebug, __VA_ARGS__))
+#else
+	#define logDebugU8l(p, t, l)				((void) 0)
+	#define logDebugU8fmt(p, ...)				((void) 0)
+	#define logDebugU8l_static(t, l)			((void) 0)
+	#define logDebugU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_INFO
+	#define logInfoU8l(p, t, l)					\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityInfo, (t), (l)))
+	#define logInfoU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityInfo, __VA_ARGS__))
+	#define logInfoU8l_static(t, l)				\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityInfo, (t), (l)))
+	#define logInfoU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityInfo, __VA_ARGS__))
+#else
+	#define logInfoU8l(p, t, l)					((void) 0)
+	#define logInfoU8fmt(p, ...)				((void) 0)
+	#define logInfoU8l_static(t, l)				((void) 0)
+	#define logInfoU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_NOTICE
+	#define logNoticeU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityNotice, (t), (l)))
+	#define logNoticeU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityNotice, __VA_ARGS__))
+	#define logNoticeU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityNotice, (t), (l)))
+	#define logNoticeU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityNotice, __VA_ARGS__))
+#else
+	#define logNoticeU8l(p, t, l)				((void) 0)
+	#define logNoticeU8fmt(p, ...)				((void) 0)
+	#define logNoticeU8l_static(t, l)			((void) 0)
+	#define logNoticeU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_NOTICE
+	#define logMessageU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityMessage, (t), (l)))
+	#define logMessageU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityMessage, __VA_ARGS__))
+	#define logMessageU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityMessage, (t), (l)))
+	#define logMessageU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityMessage, __VA_ARGS__))
+#else
+	#define logMessageU8l(p, t, l)				((void) 0)
+	#define logMessageU8fmt(p, ...)				((void) 0)
+	#define logMessageU8l_static(t, l)			((void) 0)
+	#define logMessageU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_WARNING
+	#define logWarningU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityWarning, (t), (l)))
+	#define logWarningU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityWarning, __VA_ARGS__))
+	#define logWarningU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityWarning, (t), (l)))
+	#define logWarningU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityWarning, __VA_ARGS__))
+#else
+	#define logWarningU8l(p, t, l)				((void) 0)
+	#define logWarningU8fmt(p, ...)				((void) 0)
+	#define logWarningU8l_static(t, l)			((void) 0)
+	#define logWarningU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_ERROR
+	#define logErrorU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityError, (t), (l)))
+	#define logErrorU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityError, __VA_ARGS__))
+	#define logErrorU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityError, (t), (l)))
+	#define logErrorU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityError, __VA_ARGS__))
+#else
+	#define logErrorU8l(p, t, l)				((void) 0)
+	#define logErrorU8fmt(p, ...)				((void) 0)
+	#define logErrorU8l_static(t, l)			((void) 0)
+	#define logErrorU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_CRITICAL
+	#define logCriticalU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityCritical, (t), (l)))
+	#define logCriticalU8fmt(p, ...)			\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityCritical, __VA_ARGS__))
+	#define logCriticalU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityCritical, (t), (l)))
+	#define logCriticalU8fmt_static(...)		\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityCritical, __VA_ARGS__))
+#else
+	#define logCriticalU8l(p, t, l)				((void) 0)
+	#define logCriticalU8fmt(p, ...)			((void) 0)
+	#define logCriticalU8l_static(t, l)			((void) 0)
+	#define logCriticalU8fmt_static(...)		((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_FATAL
+	#define logFatalU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityFatal, (t), (l)))
+	#define logFatalU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityFatal, __VA_ARGS__))
+	#define logFatalU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityFatal, (t), (l)))
+	#define logFatalU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityFatal, __VA_ARGS__))
+#else
+	#define logFatalU8l(p, t, l)				((void) 0)
+	#define logFatalU8fmt(p, ...)				((void) 0)
+	#define logFatalU8l_static(t, l)			((void) 0)
+	#define logFatalU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_EMERGENCY
+	#define logEmergencyU8l(p, t, l)			\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityEmergency, (t), (l)))
+	#define logEmergencyU8fmt(p, ...)			\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityEmergency, __VA_ARGS__))
+	#define logEmergencyU8l_static(t, l)		\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityEmergency, (t), (l)))
+	#define logEmergencyU8fmt_static(...)		\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityEmergency, __VA_ARGS__))
+#else
+	#define logEmergencyU8l(p, t, l)			((void) 0)
+	#define logEmergencyU8fmt(p, ...)			((void) 0)
+	#define logEmergencyU8l_static(t, l)		((void) 0)
+	#define logEmergencyU8fmt_static(...)		((void) 0)
+#endif
+
+/*
+	logTextU8dvfmtsev
+	logTextU8dfmtsev
+	logTextU8dvfmt
+	logTextU8dfmt
+
+	Deferred formatting. Instead of formatting the text in the caller's thread, these
+	functions only store a copy of the format string fmt and a compact binary record of
+	the argument values in the event. The text is rendered when the event line is
+	created, which happens on the separate logging thread. This moves the cost of
+	printf ()-style formatting off the caller.
+
+	The format string and string arguments (%s) are copied. Neither of them needs to
+	outlive the call.
+
+	Supported are the conversion specifiers d, i, u, o, x, X, c, s, p, f, F, e, E, g, G, a,
+	and A, with the flags "-+ #0", width and precision (both also as '*'), and the length
+	modifiers hh, h, l, ll, j, z, and t for integers. If fmt contains anything else, for
+	instance %n, long double (%Lf), wide characters or strings (%lc, %ls), or positional
+	arguments, or if the target doesn't have a separate logging thread, the functions fall
+	back to immediate formatting like logTextU8vfmt () and logTextU8fmt ().
+
+	The functions return true on success, false otherwise.
+*/
+bool logTextU8dvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, va_list ap);
+bool logTextU8dfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...);
+bool logTextU8dvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap);
+bool logTextU8dfmt			(CUNILOG_TARGET *put, const char *fmt, ...);
+
+#define logTextU8dvfmtsev_static(s, t, ap)				\
+										logTextU8dvfmtsev	(pCUNILOG_TARGETstatic, (s), (t), (ap))
+#define logTextU8dfmtsev_static(s, ...)	logTextU8dfmtsev	(pCUNILOG_TARGETstatic, (s), __VA_ARGS__)
+#define logTextU8dvfmt_static(t, ap)	logTextU8dvfmt		(pCUNILOG_TARGETstatic, (t), (ap))
+#define logTextU8dfmt_static(...)		logTextU8dfmt		(pCUNILOG_TARGETstatic, __VA_ARGS__)
+
 /*
 	ChangeCUNILOG_TARGETuseColourForEcho
 	ChangeCUNILOG_TARGETuseColorForEcho
@@ -22046,6 +24041,36 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 bool CunilogChangeCurrentThreadPriority (cunilogprio prio);
 TYPEDEF_FNCT_PTR (bool, CunilogChangeCurrentThreadPriority) (cunilogprio prio);
 
+/*
+	cunilogSetCompressionLimits
+
+	Limits the CPU time maintenance threads spend on compressing logfiles with rotators
+	that have the task cunilogrotationtask_ExtCompressLogfiles. The limits apply to all
+	targets of the process.
+
+	A maintenance thread changes its priority to prio before it compresses a logfile,
+	and keeps this priority afterwards. On POSIX, the priority is applied as a nice value
+	(see table icuPsxPrioTable in the code file). Without the required privileges, a
+	priority once lowered can't be raised again.
+
+	Not more than nMaxParallel logfiles are compressed at the same time. Maintenance
+	threads that would exceed this amount wait until another compression has finished.
+	A value of 0 for nMaxParallel removes the limit.
+
+	The defaults are CUNILOG_DEFAULT_COMPRESSION_PRIORITY and
+	CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS. The limits don't apply to logfiles that are
+	compressed by rotators directly, i.e. if CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined,
+	in which case this is a macro that evaluates to true.
+
+	The function returns false if prio is invalid, true otherwise.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool cunilogSetCompressionLimits (cunilogprio prio, unsigned int nMaxParallel);
+	TYPEDEF_FNCT_PTR (bool, cunilogSetCompressionLimits) (cunilogprio prio, unsigned int nMaxParallel);
+#else
+	#define cunilogSetCompressionLimits(prio, nMaxParallel) (true)
+#endif
+
 /*
 	cunilogSetDefaultPrintEventSeverityFormatType
 
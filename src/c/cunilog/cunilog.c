@@ -67,6 +67,7 @@ When		Who				What
 		#include "./strisabsolutepath.h"
 		#include "./strnewline.h"
 		#include "./CompressFile.h"
+		#include "./ExtCompressors.h"
 		#include "./ExeFileName.h"
 		#include "./UserHome.h"
 		
@@ -78,6 +79,7 @@ When		Who				What
 			#include "./PsxReadDirFncts.h"
 			#include "./PsxTrash.h"
 			#include "./PsxHome.h"
+			#include "./timespecfncts.h"
 		#endif
 		
 		#include "./unref.h"
@@ -99,6 +101,7 @@ When		Who				What
 		#include "./../string/strnewline.h"
 		#include "./../string/strwildcards.h"
 		#include "./../OS/CompressFile.h"
+		#include "./../extern/ExtCompressors.h"
 		#include "./../OS/ExeFileName.h"
 		#include "./../OS/UserHome.h"
 		
@@ -110,6 +113,7 @@ When		Who				What
 			#include "./../OS/POSIX/PsxReadDirFncts.h"
 			#include "./../OS/POSIX/PsxTrash.h"
 			#include "./../OS/POSIX/PsxHome.h"
+			#include "./../datetime/timespecfncts.h"
 		#endif
 		
 		#include "./../pre/unref.h"
@@ -121,6 +125,18 @@ When		Who				What
 #ifdef PLATFORM_IS_POSIX
 	#include <errno.h>
 	#include <unistd.h>
+	#include <time.h>
+	#include <fcntl.h>
+	#include <sys/uio.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#ifdef CUNILOG_HAVE_IO_URING
+		#include <sys/syscall.h>
+		#include <linux/io_uring.h>
+	#endif
+	#ifdef CUNILOG_HAVE_INOTIFY
+		#include <sys/inotify.h>
+	#endif
 #endif
 
 static CUNILOG_TARGET CUNILOG_TARGETstatic;
@@ -373,6 +389,7 @@ size_t arrLengthTimeStampFromPostfix [] =					// [unilogPostfixAmountEnumValues]
 	/* cunilogPostfixDotNumberWeekly		*/	,	1 + UBF_UINT64_LEN
 	/* cunilogPostfixDotNumberMonthly		*/	,	1 + UBF_UINT64_LEN
 	/* cunilogPostfixDotNumberYearly		*/	,	1 + UBF_UINT64_LEN
+	/* cunilogPostfixDotNumberSize			*/	,	1 + UBF_UINT64_LEN
 };
 
 #ifdef DEBUG
@@ -419,7 +436,8 @@ const char *arrPostfixWildcardMask []	=		// [cunilogPostfixAmountEnumValues]
 	"",											// cunilogPostfixDotNumberDaily
 	"",											// cunilogPostfixDotNumberWeekly
 	"",											// cunilogPostfixDotNumberMonthly
-	""											// cunilogPostfixDotNumberYearly
+	"",											// cunilogPostfixDotNumberYearly
+	""											// cunilogPostfixDotNumberSize
 };
 
 #ifdef DEBUG
@@ -472,6 +490,7 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 	/* cunilogPostfixDotNumberWeekly		*/	,	noPostfix
 	/* cunilogPostfixDotNumberMonthly		*/	,	noPostfix
 	/* cunilogPostfixDotNumberYearly		*/	,	noPostfix
+	/* cunilogPostfixDotNumberSize			*/	,	noPostfix
 };
 
 #ifdef DEBUG
@@ -601,8 +620,9 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 					ubf_assert_true (put->cl.bInitialised);
 				#endif
 
-				LeaveCriticalSection (&put->cl.cs);
+				// Before unlocking. Another thread may lock and set it again right away.
 				cunilogClrDebugQueueLocked (put);
+				LeaveCriticalSection (&put->cl.cs);
 			}
 		}
 	#else
@@ -616,8 +636,9 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 					ubf_assert_true (put->cl.bInitialised);
 				#endif
 
-				pthread_mutex_unlock (&put->cl.mt);
+				// Before unlocking. Another thread may lock and set it again right away.
 				cunilogClrDebugQueueLocked (put);
+				pthread_mutex_unlock (&put->cl.mt);
 			}
 		}
 	#endif
@@ -657,6 +678,333 @@ void (*obtainTimeStampAsString []) (char *, UBF_TIMESTAMP) =
 	#define DoneCUNILOG_LOCKER(x)
 #endif
 
+/*
+	Lockers that are not the locker of a target, like the ones of the staging buffers,
+	the event pool, and the maintenance thread.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void InitLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+
+		#ifdef OS_IS_WINDOWS
+			InitializeCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_init (&pcl->mt, NULL);
+		#endif
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			pcl->bInitialised = true;
+		#endif
+	}
+
+	static inline void EnterLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			ubf_assert_true (pcl->bInitialised);
+		#endif
+
+		#ifdef OS_IS_WINDOWS
+			EnterCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_lock (&pcl->mt);
+		#endif
+	}
+
+	static inline bool TryEnterLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			ubf_assert_true (pcl->bInitialised);
+		#endif
+
+		#ifdef OS_IS_WINDOWS
+			return TryEnterCriticalSection (&pcl->cs);
+		#else
+			return 0 == pthread_mutex_trylock (&pcl->mt);
+		#endif
+	}
+
+	static inline void LeaveLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+
+		#ifdef OS_IS_WINDOWS
+			LeaveCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_unlock (&pcl->mt);
+		#endif
+	}
+
+	static inline void DoneLocker (CUNILOG_LOCKER *pcl)
+	{
+		ubf_assert_non_NULL (pcl);
+
+		#ifdef OS_IS_WINDOWS
+			DeleteCriticalSection (&pcl->cs);
+		#else
+			pthread_mutex_destroy (&pcl->mt);
+		#endif
+		#ifdef CUNILOG_BUILD_DEBUG_TEST_LOCKER
+			pcl->bInitialised = false;
+		#endif
+	}
+#endif
+
+/*
+	Atomic operations for the lock-free event queue and the free lists of the event pool.
+	The compare-and-swap functions update the value pexp points to with the current value
+	if the swap fails.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline CUNILOG_EVENT *cunilogAtomicLoadEvt (CUNILOG_EVENT **pp)
+		{
+			return InterlockedCompareExchangePointer ((PVOID volatile *) pp, NULL, NULL);
+		}
+
+		static inline CUNILOG_EVENT *cunilogAtomicXchgEvt (CUNILOG_EVENT **pp, CUNILOG_EVENT *pev)
+		{
+			return InterlockedExchangePointer ((PVOID volatile *) pp, pev);
+		}
+
+		static inline bool cunilogAtomicCasEvt	(
+							CUNILOG_EVENT **pp, CUNILOG_EVENT **pexp, CUNILOG_EVENT *pev
+												)
+		{
+			CUNILOG_EVENT *prv = InterlockedCompareExchangePointer	(
+									(PVOID volatile *) pp, pev, *pexp
+																	);
+			if (prv == *pexp)
+				return true;
+			*pexp = prv;
+			return false;
+		}
+
+		static inline size_t cunilogAtomicLoadSize (size_t *p)
+		{
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, 0);
+		}
+
+		static inline size_t cunilogAtomicAddSize (size_t *p, size_t n)
+		{
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, n);
+		}
+
+		static inline size_t cunilogAtomicSubSize (size_t *p, size_t n)
+		{
+			return InterlockedExchangeAddSizeT ((size_t volatile *) p, (size_t) 0 - n);
+		}
+
+		static inline size_t cunilogAtomicXchgSize (size_t *p, size_t n)
+		{
+			#ifdef _WIN64
+				return (size_t) InterlockedExchange64 ((LONG64 volatile *) p, (LONG64) n);
+			#else
+				return (size_t) InterlockedExchange ((LONG volatile *) p, (LONG) n);
+			#endif
+		}
+
+		static inline void cunilogAtomicStoreSize (size_t *p, size_t n)
+		{
+			cunilogAtomicXchgSize (p, n);
+		}
+
+		static inline CUNILOG_POOLSLOT *cunilogAtomicLoadSlot (CUNILOG_POOLSLOT **pp)
+		{
+			return InterlockedCompareExchangePointer ((PVOID volatile *) pp, NULL, NULL);
+		}
+
+		static inline bool cunilogAtomicCasSlot	(
+							CUNILOG_POOLSLOT **pp, CUNILOG_POOLSLOT **pexp, CUNILOG_POOLSLOT *ps
+												)
+		{
+			CUNILOG_POOLSLOT *prv = InterlockedCompareExchangePointer	(
+										(PVOID volatile *) pp, ps, *pexp
+																		);
+			if (prv == *pexp)
+				return true;
+			*pexp = prv;
+			return false;
+		}
+	#else
+		static inline CUNILOG_EVENT *cunilogAtomicLoadEvt (CUNILOG_EVENT **pp)
+		{
+			return __atomic_load_n (pp, __ATOMIC_SEQ_CST);
+		}
+
+		static inline CUNILOG_EVENT *cunilogAtomicXchgEvt (CUNILOG_EVENT **pp, CUNILOG_EVENT *pev)
+		{
+			return __atomic_exchange_n (pp, pev, __ATOMIC_SEQ_CST);
+		}
+
+		static inline bool cunilogAtomicCasEvt	(
+							CUNILOG_EVENT **pp, CUNILOG_EVENT **pexp, CUNILOG_EVENT *pev
+												)
+		{
+			return __atomic_compare_exchange_n	(
+						pp, pexp, pev, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+												);
+		}
+
+		static inline size_t cunilogAtomicLoadSize (size_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicAddSize (size_t *p, size_t n)
+		{
+			return __atomic_fetch_add (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicSubSize (size_t *p, size_t n)
+		{
+			return __atomic_fetch_sub (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline size_t cunilogAtomicXchgSize (size_t *p, size_t n)
+		{
+			return __atomic_exchange_n (p, n, __ATOMIC_SEQ_CST);
+		}
+
+		static inline void cunilogAtomicStoreSize (size_t *p, size_t n)
+		{
+			__atomic_store_n (p, n, __ATOMIC_RELEASE);
+		}
+
+		static inline CUNILOG_POOLSLOT *cunilogAtomicLoadSlot (CUNILOG_POOLSLOT **pp)
+		{
+			return __atomic_load_n (pp, __ATOMIC_SEQ_CST);
+		}
+
+		static inline bool cunilogAtomicCasSlot	(
+							CUNILOG_POOLSLOT **pp, CUNILOG_POOLSLOT **pexp, CUNILOG_POOLSLOT *ps
+												)
+		{
+			return __atomic_compare_exchange_n	(
+						pp, pexp, ps, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST
+												);
+		}
+	#endif
+#endif
+
+/*
+	Loads and stores of the severity mask of a target, which can be changed while other
+	threads are logging. A relaxed load is sufficient. An event logged concurrently with
+	the change is either filtered by the old or by the new mask.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline uint32_t cunilogAtomicLoadU32 (uint32_t *p)
+		{
+			return *(uint32_t volatile *) p;
+		}
+
+		static inline void cunilogAtomicStoreU32 (uint32_t *p, uint32_t v)
+		{
+			InterlockedExchange ((LONG volatile *) p, (LONG) v);
+		}
+	#else
+		static inline uint32_t cunilogAtomicLoadU32 (uint32_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_RELAXED);
+		}
+
+		static inline void cunilogAtomicStoreU32 (uint32_t *p, uint32_t v)
+		{
+			__atomic_store_n (p, v, __ATOMIC_RELEASE);
+		}
+	#endif
+#else
+	#define cunilogAtomicLoadU32(p)						(*(p))
+	#define cunilogAtomicStoreU32(p, v)					(*(p) = (v))
+#endif
+
+/*
+	Sequence lock of the cached local time of a target (member tsc). Readers never block.
+	The sequence number is odd while a thread updates the cache. A reader copies the cache
+	and only uses the copy if the sequence number was even and did not change meanwhile.
+	Since the cache only changes once per second, a writer only takes over the cache if
+	the sequence number still is the one it read, and gives up otherwise.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#ifdef OS_IS_WINDOWS
+		static inline uint32_t cunilogTimestampSeqBeginRead (uint32_t *p)
+		{
+			uint32_t seq = *(uint32_t volatile *) p;
+			MemoryBarrier ();
+			return seq;
+		}
+
+		static inline bool cunilogTimestampSeqEndRead (uint32_t *p, uint32_t seq)
+		{
+			MemoryBarrier ();
+			return 0 == (seq & 1) && seq == *(uint32_t volatile *) p;
+		}
+
+		static inline bool cunilogTimestampSeqTryBeginWrite (uint32_t *p, uint32_t seq)
+		{
+			return	(LONG) seq == InterlockedCompareExchange	(
+									(LONG volatile *) p, (LONG) (seq + 1), (LONG) seq
+																);
+		}
+
+		static inline void cunilogTimestampSeqEndWrite (uint32_t *p, uint32_t seq)
+		{
+			InterlockedExchange ((LONG volatile *) p, (LONG) (seq + 2));
+		}
+
+		static inline void cunilogTimestampCacheLoad (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			pd->tSec	= *(int64_t volatile *) &ps->tSec;
+			pd->uts		= *(UBF_TIMESTAMP volatile *) &ps->uts;
+		}
+
+		static inline void cunilogTimestampCacheStore (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			*(int64_t volatile *) &pd->tSec			= ps->tSec;
+			*(UBF_TIMESTAMP volatile *) &pd->uts	= ps->uts;
+		}
+	#else
+		static inline uint32_t cunilogTimestampSeqBeginRead (uint32_t *p)
+		{
+			return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+		}
+
+		static inline bool cunilogTimestampSeqEndRead (uint32_t *p, uint32_t seq)
+		{
+			__atomic_thread_fence (__ATOMIC_ACQUIRE);
+			return 0 == (seq & 1) && seq == __atomic_load_n (p, __ATOMIC_RELAXED);
+		}
+
+		static inline bool cunilogTimestampSeqTryBeginWrite (uint32_t *p, uint32_t seq)
+		{
+			bool b = __atomic_compare_exchange_n	(
+						p, &seq, seq + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+													);
+			__atomic_thread_fence (__ATOMIC_RELEASE);
+			return b;
+		}
+
+		static inline void cunilogTimestampSeqEndWrite (uint32_t *p, uint32_t seq)
+		{
+			__atomic_store_n (p, seq + 2, __ATOMIC_RELEASE);
+		}
+
+		static inline void cunilogTimestampCacheLoad (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			pd->tSec	= __atomic_load_n (&ps->tSec, __ATOMIC_RELAXED);
+			pd->uts		= __atomic_load_n (&ps->uts, __ATOMIC_RELAXED);
+		}
+
+		static inline void cunilogTimestampCacheStore (UBF_TIMESTAMP_CACHE *pd, UBF_TIMESTAMP_CACHE *ps)
+		{
+			__atomic_store_n (&pd->tSec, ps->tSec, __ATOMIC_RELAXED);
+			__atomic_store_n (&pd->uts, ps->uts, __ATOMIC_RELAXED);
+		}
+	#endif
+#endif
+
 void InitSCUNILOGNPI (SCUNILOGNPI *pni)
 {
 	ubf_assert_non_NULL (pni);
@@ -999,6 +1347,7 @@ enum cunilogprocessfrequency frequencyTbl [] =
 	/* cunilogPostfixDotNumberWeekly	*/		,	cunilogProcessAppliesTo_WeekChanged
 	/* cunilogPostfixDotNumberMonthly	*/		,	cunilogProcessAppliesTo_MonthChanged
 	/* cunilogPostfixDotNumberYearly	*/		,	cunilogProcessAppliesTo_YearChanged
+	/* cunilogPostfixDotNumberSize		*/		,	cunilogProcessAppliesTo_nOctets
 };
 
 static inline enum cunilogprocessfrequency defaultFrequencyFromPostfix (CUNILOG_TARGET *put)
@@ -1027,7 +1376,7 @@ static inline bool hasDotNumberPostfix (CUNILOG_TARGET *put)
 
 	return	(
 					cunilogPostfixDotNumberMinutely	<= put->culogPostfix
-				&&	cunilogPostfixDotNumberYearly	>= put->culogPostfix
+				&&	cunilogPostfixDotNumberSize		>= put->culogPostfix
 			);
 }
 
@@ -1087,6 +1436,13 @@ static inline void defaultProcessorParameters (CUNILOG_TARGET *put)
 		{
 			case cunilogProcessRotateLogfiles:
 				prCurr = cp->pData;
+				// The retention policy relies on the sizes and times kept with the index.
+				if (cunilogHasRotatorRetention (prCurr))
+					cunilogTargetSetFLSindex (put);
+				#ifdef PLATFORM_IS_POSIX
+					// readdir () returns the files in no particular order.
+					cunilogTargetSetFSneedsSorting	(put);
+				#endif
 				if (hasDotNumberPostfix (put))
 				{	// For this rotator the trick with remembering how many files we've
 					//	had so far doesn't work. However, we need to sort the retrieved
@@ -1132,9 +1488,45 @@ static inline void zeroProcessors (CUNILOG_TARGET *put)
 
 	put->cprocessors	= NULL;
 	put->nprocessors	= 0;
+	put->plan			= NULL;
+	put->nplan			= 0;
+	put->batches		= NULL;
+}
+
+static bool compileProcessorPlan (CUNILOG_TARGET *put);
+
+static inline void DoneCUNILOG_TARGETplan (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (put->plan)
+	{
+		ubf_free (put->plan);
+		put->plan	= NULL;
+		put->nplan	= 0;
+	}
+	if (put->batches)
+	{
+		unsigned int n;
+		for (n = 0; n < put->nprocessors; ++ n)
+		{
+			ubf_assert_0 (put->batches [n].nevs);
+			if (put->batches [n].pbes)
+				ubf_free (put->batches [n].pbes);
+			if (put->batches [n].pofs)
+				ubf_free (put->batches [n].pofs);
+		}
+		ubf_free (put->batches);
+		put->batches = NULL;
+	}
 }
 
 static void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETmaintenance (CUNILOG_TARGET *put);
+#else
+	#define DoneCUNILOG_TARGETmaintenance(put)
+#endif
 
 /*
 	In the target initialisers zeroProcessors () must be called before prepareProcessors ().
@@ -1159,6 +1551,10 @@ static bool prepareProcessors (CUNILOG_TARGET *put, CUNILOG_PROCESSOR **cp, unsi
 	}
 	*/
 
+	// The plan of a previous processor list might be too small. This needs to be done
+	//	before the list is replaced as the batches are parallel to it.
+	DoneCUNILOG_TARGETplan (put);
+
 	if (NULL == cp || 0 == np)
 	{
 		ubf_assert (NULL == cp);
@@ -1178,7 +1574,7 @@ static bool prepareProcessors (CUNILOG_TARGET *put, CUNILOG_PROCESSOR **cp, unsi
 		put->nprocessors = np;
 	}
 	defaultProcessorParameters (put);
-	return true;
+	return compileProcessorPlan (put);
 }
 
 static inline void createLogfilesSearchMaskDotNumberPostfix (CUNILOG_TARGET *put)
@@ -1198,6 +1594,11 @@ static inline void createLogfilesSearchMaskDotNumberPostfix (CUNILOG_TARGET *put
 	ubf_assert (strlen (put->mbLogFileMask.buf.pcc) == put->lnLogFileMask);
 }
 
+/*
+	The search mask ends with a wildcard after the ".log" extension to also pick up the
+	logfiles that rotators with the task cunilogrotationtask_ExtCompressLogfiles have
+	compressed. See isLogfileOrExtCompressedName ().
+*/
 static inline void createLogfilesSearchMask (CUNILOG_TARGET *put)
 {
 	// Create the wildcard/search mask.
@@ -1213,11 +1614,18 @@ static inline void createLogfilesSearchMask (CUNILOG_TARGET *put)
 		+	put->lnAppName + 1
 		+	lenDateTimeStampFromPostfix (put->culogPostfix),
 		szCunilogLogFileNameExtension,
-		sizCunilogLogFileNameExtension
+		lenCunilogLogFileNameExtension
 			);
+	char *szAster =		put->mbLogFileMask.buf.pch
+					+	put->lnAppName + 1
+					+	lenDateTimeStampFromPostfix (put->culogPostfix)
+					+	lenCunilogLogFileNameExtension;
+	memcpy (szAster, "*", 2);
 	put->lnLogFileMask	=	put->lnAppName + 1
 						+	lenDateTimeStampFromPostfix (put->culogPostfix)
-						+	lenCunilogLogFileNameExtension;
+						+	lenCunilogLogFileNameExtension
+						+	1;
+	ubf_assert (strlen (put->mbLogFileMask.buf.pcc) == put->lnLogFileMask);
 }
 
 static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
@@ -1264,6 +1672,9 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 	// We also need an underscore in the search mask for LogPostfixes.
 	if (hasLogPostfix (put))
 		++ stRequiredForLogFileMask;
+	// And the wildcard for compressed logfiles. See createLogfilesSearchMask ().
+	if (!hasDotNumberPostfix (put))
+		++ stRequiredForLogFileMask;
 
 	initSMEMBUFtoSize (&put->mbLogFileMask, stRequiredForLogFileMask);
 	if (isUsableSMEMBUF (&put->mbLogFileMask))
@@ -1334,14 +1745,20 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 				// See
 				//	https://learn.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-createsemaphorew .
 				put->sm.hSemaphore = CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
-				if (NULL == put->sm.hSemaphore)
+				put->smQueueSpace.hSemaphore = CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
+				if (NULL == put->sm.hSemaphore || NULL == put->smQueueSpace.hSemaphore)
 					SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
-				return NULL != put->sm.hSemaphore;
+				return NULL != put->sm.hSemaphore && NULL != put->smQueueSpace.hSemaphore;
 				
 			#else
 			
 				int i = sem_init (&put->sm.tSemaphore, 0, 0);
 				ubf_assert (0 == i);
+				if (0 == i)
+				{
+					i = sem_init (&put->smQueueSpace.tSemaphore, 0, 0);
+					ubf_assert (0 == i);
+				}
 				if (0 != i)
 					SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
 				return 0 == i;
@@ -1365,11 +1782,16 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 			#ifdef OS_IS_WINDOWS
 				bool b = CloseHandle (put->sm.hSemaphore);
 				ubf_assert_true (b);
+				b = CloseHandle (put->smQueueSpace.hSemaphore);
+				ubf_assert_true (b);
 				UNUSED (b);
 				put->sm.hSemaphore = NULL;
+				put->smQueueSpace.hSemaphore = NULL;
 			#else
 				int i = sem_destroy (&put->sm.tSemaphore);
 				ubf_assert (0 == i);
+				i = sem_destroy (&put->smQueueSpace.tSemaphore);
+				ubf_assert (0 == i);
 				UNUSED (i);
 			#endif
 		}
@@ -1388,6 +1810,7 @@ static bool prepareCUNILOG_TARGETforLogging (CUNILOG_TARGET *put)
 			put->qu.first	= NULL;
 			put->qu.last	= NULL;
 			put->qu.num		= 0;
+			put->qu.head	= NULL;
 		}
 		// If no semaphore is required, not creating it is seen as success.
 		return true;
@@ -1550,11 +1973,30 @@ static inline void initFilesListInCUNILOG_TARGET (CUNILOG_TARGET *put)
 
 	vec_init (&put->fls);
 	InitSBULKMEM (&put->sbm, CUNILOG_STD_BULK_ALLOC_SIZE);
+	put->stFLSorphaned = 0;
+	#ifdef CUNILOG_HAVE_INOTIFY
+		put->fdFLSwatch = -1;
+	#endif
 
 	// Note that we do not allocate any bulk memory here yet. If for instance the caller
 	//	hasn't provided a rotation processor we may not even need one.
 }
 
+#ifdef CUNILOG_HAVE_INOTIFY
+	static void DoneCUNILOG_TARGETflsWatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 != put->fdFLSwatch)
+		{
+			close (put->fdFLSwatch);
+			put->fdFLSwatch = -1;
+		}
+	}
+#else
+	#define DoneCUNILOG_TARGETflsWatch(x)
+#endif
+
 static inline void initPrevTimestamp (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
@@ -1585,6 +2027,10 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	// The name of the active logfile never changes for .log and dot number postfixes.
+	//	The rotator closes and reopens it when it renames it.
+	if (hasDotNumberPostfix (put) || hasLogPostfix (put))
+		return false;
 
 	int r = memcmp	(
 				put->szDateTimeStamp, put->cPrevDateTimeStamp,
@@ -1593,6 +2039,25 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 	return r > 0;
 }
 
+/*
+	Remembers the date/timestamp postfix of the logfile just opened, so that
+	requiresNewLogFile () only returns true again when the postfix changes, instead of for
+	every event until the next time the logfile name is updated.
+
+	Logfiles with .log or dot number postfixes never require a new logfile and are
+	therefore not affected.
+*/
+static inline void setLogFileDateTimeStampInUse (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (put->szDateTimeStamp && cunilogPostfixYear >= put->culogPostfix)
+		memcpy	(
+			put->cPrevDateTimeStamp, put->szDateTimeStamp,
+			lenDateTimeStampFromPostfix (put->culogPostfix)
+				);
+}
+
 #ifdef PLATFORM_IS_POSIX
 	// The plain logging folder name is not used on Windows. It is only required
 	//	for opendir () on POSIX. This might change in the future as I can imagine
@@ -1617,24 +2082,251 @@ static inline bool requiresNewLogFile (CUNILOG_TARGET *put)
 			memcpy (put->mbLogFold.buf.pch, put->mbLogPath.buf.pch, lenLogp);
 			put->mbLogFold.buf.pch [lenLogp] = '\0';
 			put->lnLogFold = lenLogp;
+			put->fdLogFold = -1;
 			return;
 		}
 		// We should never get here.
 		ubf_assert (false);
 		put->lnLogFold = 0;
+		put->fdLogFold = -1;
 	}
-#else
-	#define InitCUNILOG_TARGETmbLogFold(x)
-#endif
 
-static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
-{
-	ubf_assert_non_NULL (put);
+	/*
+		Returns the directory file descriptor of the logging folder mbLogFold, which is
+		opened on first use and stays open until the target is destroyed, or until a
+		rename fails because the folder has been deleted and created again. Rotators use it
+		with renameat () to move logfiles without resolving the folder again each time.
+		Returns -1 if the folder cannot be opened, in which case errno is set.
+	*/
+	static int cunilogLogFoldFD (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (isUsableSMEMBUF (&put->mbLogFold));
 
-	#ifdef OS_IS_WINDOWS
+		if (-1 == put->fdLogFold)
+			put->fdLogFold = open (put->mbLogFold.buf.pcc, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		return put->fdLogFold;
+	}
+
+	static void DoneCUNILOG_TARGETfdLogFold (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (-1 != put->fdLogFold)
+		{
+			close (put->fdLogFold);
+			put->fdLogFold = -1;
+		}
+	}
+#else
+	#define InitCUNILOG_TARGETmbLogFold(x)
+	#define DoneCUNILOG_TARGETfdLogFold(x)
+#endif
+
+static inline void cunilogInitCUNILOG_LOGFILE (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef OS_IS_WINDOWS
 		put->logfile.hLogFile = NULL;
 	#else
-		put->logfile.fLogFile = NULL;
+		put->logfile.fLogFile	= NULL;
+		put->logfile.fdLogFile	= -1;
+		put->logfile.pMap		= NULL;
+		put->logfile.lnMap		= 0;
+		put->logfile.ofsMap		= 0;
+		put->logfile.ullMapBase	= 0;
+		put->logfile.lnMapChunk	= CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE;
+	#endif
+	put->logfile.ullSize		= 0;
+	put->logfile.ullSizeEvt		= 0;
+	put->logfile.ullSizePrv		= 0;
+	put->logfile.bSizeUnseen	= true;
+}
+
+#ifndef OS_IS_WINDOWS
+	/*
+		Preallocates and maps lnMapChunk octets of the logfile, starting with the page
+		that contains the file offset ullEnd. The offset ullEnd is the real end of the
+		logfile, i.e. where the next event line goes.
+	*/
+	static bool cunilogMapLogFileAt (CUNILOG_TARGET *put, uint64_t ullEnd)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->logfile.pMap);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		uint64_t		ullPage	= (uint64_t) sysconf (_SC_PAGESIZE);
+		uint64_t		ullBase	= ullEnd - ullEnd % ullPage;
+
+		// Where to continue if anything goes wrong.
+		pl->ullMapBase	= ullEnd;
+		pl->ofsMap		= 0;
+		pl->lnMap		= 0;
+
+		#ifdef OS_IS_LINUX
+			int e = posix_fallocate	(
+						pl->fdLogFile, (off_t) ullBase, (off_t) pl->lnMapChunk
+									);
+			// Not every file system supports preallocation.
+			if (e && (EOPNOTSUPP != e || ftruncate (pl->fdLogFile, (off_t) (ullBase + pl->lnMapChunk))))
+				return false;
+		#else
+			if (ftruncate (pl->fdLogFile, (off_t) (ullBase + pl->lnMapChunk)))
+				return false;
+		#endif
+		void *pv = mmap	(
+						NULL, pl->lnMapChunk, PROT_READ | PROT_WRITE, MAP_SHARED,
+						pl->fdLogFile, (off_t) ullBase
+						);
+		if (MAP_FAILED == pv)
+			return false;
+		pl->pMap		= pv;
+		pl->lnMap		= pl->lnMapChunk;
+		pl->ullMapBase	= ullBase;
+		pl->ofsMap		= (size_t) (ullEnd - ullBase);
+		return true;
+	}
+
+	/*
+		Returns the real end of a memory-mapped logfile with a size of ullSize octets,
+		which is where its trailing NUL octets start. Trailing NUL octets are left behind
+		by a process that terminated without closing the logfile. They can't be more than
+		a chunk.
+	*/
+	static uint64_t cunilogMappedLogFileEnd (CUNILOG_TARGET *put, uint64_t ullSize)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		uint64_t		ullPage	= (uint64_t) sysconf (_SC_PAGESIZE);
+		uint64_t		ullFrom	= ullSize > pl->lnMapChunk ? ullSize - pl->lnMapChunk : 0;
+		uint64_t		ullBase	= ullFrom - ullFrom % ullPage;
+		size_t			ln		= (size_t) (ullSize - ullBase);
+
+		if (0 == ullSize)
+			return 0;
+		char *pc = mmap (NULL, ln, PROT_READ, MAP_SHARED, pl->fdLogFile, (off_t) ullBase);
+		if (MAP_FAILED == pc)
+			return ullSize;
+		while (ln && ASCII_NUL == pc [ln - 1])
+			-- ln;
+		munmap (pc, (size_t) (ullSize - ullBase));
+		return ullBase + ln;
+	}
+
+	static bool cunilogOpenMappedLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		struct stat		st;
+
+		pl->fdLogFile = open	(
+					put->mbLogfileName.buf.pcc,
+					CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS, CUNILOG_DEFAULT_RAW_OPEN_PERMS
+								);
+		if (0 > pl->fdLogFile)
+			return false;
+		if (0 == fstat (pl->fdLogFile, &st))
+		{
+			uint64_t ullEnd = cunilogMappedLogFileEnd (put, (uint64_t) st.st_size);
+			if	(
+						(
+								ullEnd == (uint64_t) st.st_size
+							||	0 == ftruncate (pl->fdLogFile, (off_t) ullEnd)
+						)
+					&&	cunilogMapLogFileAt (put, ullEnd)
+				)
+				return true;
+		}
+		close (pl->fdLogFile);
+		pl->fdLogFile = -1;
+		return false;
+	}
+
+	/*
+		Unmaps the current chunk and truncates the logfile to the octets written.
+	*/
+	static void cunilogUnmapLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+
+		if (pl->pMap)
+		{
+			munmap (pl->pMap, pl->lnMap);
+			pl->pMap = NULL;
+		}
+		if (ftruncate (pl->fdLogFile, (off_t) (pl->ullMapBase + pl->ofsMap)))
+			ubf_assert (false);
+	}
+
+	/*
+		Copies the n buffers of the array piov points to into the mapping, and maps the
+		next chunk whenever the current one is full.
+	*/
+	static bool cunilogMappedWritevToLogFile (CUNILOG_TARGET *put, struct iovec *piov, int n)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (piov);
+
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+
+		for (int i = 0; i < n; ++ i)
+		{
+			const char	*pc	= piov [i].iov_base;
+			size_t		ln	= piov [i].iov_len;
+
+			while (ln)
+			{
+				if (pl->ofsMap == pl->lnMap)
+				{
+					uint64_t ullEnd = pl->ullMapBase + pl->ofsMap;
+					if (pl->pMap)
+					{
+						munmap (pl->pMap, pl->lnMap);
+						pl->pMap = NULL;
+					}
+					if (!cunilogMapLogFileAt (put, ullEnd))
+						return false;
+				}
+				size_t lnCpy = ln < pl->lnMap - pl->ofsMap ? ln : pl->lnMap - pl->ofsMap;
+				memcpy (pl->pMap + pl->ofsMap, pc, lnCpy);
+				pl->ofsMap	+= lnCpy;
+				pc			+= lnCpy;
+				ln			-= lnCpy;
+			}
+		}
+		return true;
+	}
+#endif
+
+/*
+	Obtains the size of the logfile that has just been opened. New event lines are
+	appended to it. The next event that triggers rotators is the first one that can make
+	them rotate the logfile by size. See hasLogfileReachedRotationSize ().
+*/
+static inline void cunilogObtainLogFileSize (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_LOGFILE	*pl	= &put->logfile;
+
+	pl->ullSize		= 0;
+	pl->bSizeUnseen	= true;
+	#ifdef PLATFORM_IS_WINDOWS
+		LARGE_INTEGER	li;
+		if (GetFileSizeEx (pl->hLogFile, &li))
+			pl->ullSize = (uint64_t) li.QuadPart;
+	#else
+		struct stat		st;
+		if (cunilogHasMappedLogfile (put))
+			pl->ullSize = pl->ullMapBase + pl->ofsMap;
+		else
+		if (0 == fstat (cunilogHasRawLogfile (put) ? pl->fdLogFile : fileno (pl->fLogFile), &st))
+			pl->ullSize = (uint64_t) st.st_size;
 	#endif
 }
 
@@ -1643,6 +2335,16 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 	ubf_assert_non_NULL	(put);
 	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
 
+	bool b;
+
+	/*
+		A compressed logfile that ends in a frame torn by a crash, or that has been written
+		uncompressed before, can't be read by the decompression tools. We cut the torn frame
+		off or compress the existing content first. If this fails we append anyway.
+	*/
+	if (put->wb.pfr)
+		ExtCompressFramesRepairFile (put->wb.pfr, put->mbLogfileName.buf.pcc);
+
 	#ifdef PLATFORM_IS_WINDOWS
 		put->logfile.hLogFile = CreateFileU8	(
 						put->mbLogfileName.buf.pcc,
@@ -1652,11 +2354,218 @@ static inline bool cunilogOpenLogFile (CUNILOG_TARGET *put)
 						FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
 						NULL
 									);
-		return NULL != put->logfile.hLogFile && INVALID_HANDLE_VALUE != put->logfile.hLogFile;
+		b = NULL != put->logfile.hLogFile && INVALID_HANDLE_VALUE != put->logfile.hLogFile;
 	#else
-		// We always (and automatically) append.
-		put->logfile.fLogFile = fopen (put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE);
-		return NULL != put->logfile.fLogFile;
+		if (cunilogHasMappedLogfile (put))
+			b = cunilogOpenMappedLogFile (put);
+		else
+		if (cunilogHasRawLogfile (put))
+		{	// We always (and automatically) append.
+			put->logfile.fdLogFile = open	(
+						put->mbLogfileName.buf.pcc,
+						CUNILOG_DEFAULT_RAW_OPEN_FLAGS, CUNILOG_DEFAULT_RAW_OPEN_PERMS
+											);
+			b = 0 <= put->logfile.fdLogFile;
+		} else
+		{
+			put->logfile.fLogFile = fopen (put->mbLogfileName.buf.pcc, CUNILOG_DEFAULT_OPEN_MODE);
+			b = NULL != put->logfile.fLogFile;
+		}
+	#endif
+	if (b)
+		cunilogObtainLogFileSize (put);
+	return b;
+}
+
+#ifndef OS_IS_WINDOWS
+	static inline void cunilogCloseLogFile (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (0 <= put->logfile.fdLogFile)
+		{
+			if (cunilogHasMappedLogfile (put))
+				cunilogUnmapLogFile (put);
+			close (put->logfile.fdLogFile);
+			put->logfile.fdLogFile = -1;
+		}
+		if (put->logfile.fLogFile)
+		{
+			fclose (put->logfile.fLogFile);
+			put->logfile.fLogFile = NULL;
+		}
+	}
+#endif
+
+#ifndef OS_IS_WINDOWS
+	// The file descriptor of the open logfile.
+	static inline int cunilogLogFileDescriptor (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		return cunilogHasRawLogfile (put) ? put->logfile.fdLogFile : fileno (put->logfile.fLogFile);
+	}
+#endif
+
+static bool cunilogWriteBehindToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine);
+static bool cunilogWriteBehindToLogFileAndWait (CUNILOG_TARGET *put);
+
+#ifdef CUNILOG_HAVE_IO_URING
+	static inline void InitCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+
+		pur->fdRing			= -1;
+		pur->pSQ			= NULL;
+		pur->lnSQ			= 0;
+		pur->pCQ			= NULL;
+		pur->lnCQ			= 0;
+		pur->sqes			= NULL;
+		pur->lnSQEs			= 0;
+		pur->buf			= NULL;
+		pur->siz			= 0;
+		pur->len			= 0;
+		pur->nInFlight		= 0;
+		pur->bSyncInFlight	= false;
+	}
+
+	/*
+		Unmaps the rings and closes the io_uring. Nothing must be in flight anymore.
+	*/
+	static void DoneCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+		ubf_assert_0 (pur->nInFlight);
+
+		if (pur->sqes && MAP_FAILED != (void *) pur->sqes)
+			munmap (pur->sqes, pur->lnSQEs);
+		if (pur->pCQ && MAP_FAILED != pur->pCQ && pur->pCQ != pur->pSQ)
+			munmap (pur->pCQ, pur->lnCQ);
+		if (pur->pSQ && MAP_FAILED != pur->pSQ)
+			munmap (pur->pSQ, pur->lnSQ);
+		if (0 <= pur->fdRing)
+			close (pur->fdRing);
+		if (pur->buf)
+			ubf_free (pur->buf);
+		InitCUNILOG_IOURING (pur);
+	}
+
+	/*
+		Returns true if the kernel supports the opcodes the logfile is written with. Kernels
+		too old to answer IORING_REGISTER_PROBE don't support IORING_OP_WRITE either.
+	*/
+	static bool cunilogIoUringProbeOps (int fdRing)
+	{
+		unsigned int			n	= IORING_OP_WRITE + 1;
+		struct io_uring_probe	*pp;
+		bool					b;
+
+		pp = ubf_calloc (1, sizeof (struct io_uring_probe) + n * sizeof (struct io_uring_probe_op));
+		if (NULL == pp)
+			return false;
+		b =		0 <= syscall (__NR_io_uring_register, fdRing, IORING_REGISTER_PROBE, pp, n)
+			&&	IORING_OP_WRITE <= pp->last_op
+			&&	pp->ops [IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED
+			&&	pp->ops [IORING_OP_FSYNC].flags & IO_URING_OP_SUPPORTED;
+		ubf_free (pp);
+		return b;
+	}
+
+	/*
+		Sets up an io_uring with room for a write that is linked to a datasync, and maps
+		its rings. Returns false if the kernel doesn't provide io_uring, doesn't support
+		the opcodes required, or doesn't allow this process to use it.
+	*/
+	static bool SetupCUNILOG_IOURING (CUNILOG_IOURING *pur)
+	{
+		ubf_assert_non_NULL (pur);
+		ubf_assert (0 > pur->fdRing);
+
+		struct io_uring_params	p;
+		unsigned char			*pc;
+
+		memset (&p, 0, sizeof (p));
+		pur->fdRing = (int) syscall (__NR_io_uring_setup, 2, &p);
+		if (0 > pur->fdRing)
+			return false;
+		if (!cunilogIoUringProbeOps (pur->fdRing))
+			return false;
+		pur->lnSQ = p.sq_off.array + p.sq_entries * sizeof (unsigned int);
+		pur->lnCQ = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+		if (p.features & IORING_FEAT_SINGLE_MMAP)
+		{
+			pur->lnSQ = pur->lnCQ > pur->lnSQ ? pur->lnCQ : pur->lnSQ;
+			pur->lnCQ = 0;
+		}
+		pur->pSQ = mmap	(
+						NULL, pur->lnSQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_SQ_RING
+						);
+		if (MAP_FAILED == pur->pSQ)
+			return false;
+		pur->pCQ = pur->lnCQ
+					? mmap	(
+						NULL, pur->lnCQ, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_CQ_RING
+							)
+					: pur->pSQ;
+		if (MAP_FAILED == pur->pCQ)
+			return false;
+		pur->lnSQEs = p.sq_entries * sizeof (struct io_uring_sqe);
+		pur->sqes = mmap	(
+						NULL, pur->lnSQEs, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+						pur->fdRing, IORING_OFF_SQES
+							);
+		if (MAP_FAILED == (void *) pur->sqes)
+			return false;
+		pc = pur->pSQ;
+		pur->sqHead		= (unsigned int *) (pc + p.sq_off.head);
+		pur->sqTail		= (unsigned int *) (pc + p.sq_off.tail);
+		pur->sqMask		= (unsigned int *) (pc + p.sq_off.ring_mask);
+		pur->sqArray	= (unsigned int *) (pc + p.sq_off.array);
+		pc = pur->pCQ;
+		pur->cqHead		= (unsigned int *) (pc + p.cq_off.head);
+		pur->cqTail		= (unsigned int *) (pc + p.cq_off.tail);
+		pur->cqMask		= (unsigned int *) (pc + p.cq_off.ring_mask);
+		pur->cqes		= (struct io_uring_cqe *) (pc + p.cq_off.cqes);
+		return true;
+	}
+#endif
+
+static inline void InitCUNILOG_TARGETwriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	put->wb.buf			= NULL;
+	put->wb.siz			= 0;
+	put->wb.len			= 0;
+	put->wb.ullLatency	= UINT64_MAX;
+	put->wb.policy		= cunilogWriteBehindWhenFull;
+	put->wb.nSyncOctets	= 0;
+	put->wb.nUnsynced	= 0;
+	put->wb.nWrites		= 0;
+	put->wb.pfr			= NULL;
+	#ifdef CUNILOG_HAVE_IO_URING
+		InitCUNILOG_IOURING (&put->wb.ur);
+	#endif
+}
+
+static inline void DoneCUNILOG_TARGETwriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+	// The logfile has been closed already, which wrote out the buffer.
+	ubf_assert_0 (put->wb.len);
+
+	if (put->wb.buf)
+	{
+		ubf_free (put->wb.buf);
+		put->wb.buf = NULL;
+		put->wb.siz = 0;
+	}
+	DoneEXTCMPFRAMER (put->wb.pfr);
+	put->wb.pfr = NULL;
+	#ifdef CUNILOG_HAVE_IO_URING
+		DoneCUNILOG_IOURING (&put->wb.ur);
 	#endif
 }
 
@@ -1664,6 +2573,7 @@ static inline void cunilogCloseCUNILOG_LOGFILEifOpen (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	cunilogWriteBehindToLogFileAndWait (put);
 	#ifdef OS_IS_WINDOWS
 		if (put->logfile.hLogFile)
 		{
@@ -1671,14 +2581,23 @@ static inline void cunilogCloseCUNILOG_LOGFILEifOpen (CUNILOG_TARGET *put)
 			put->logfile.hLogFile = NULL;
 		}
 	#else
-		if (put->logfile.fLogFile)
-		{
-			fclose (put->logfile.fLogFile);
-			put->logfile.fLogFile = NULL;
-		}
+		cunilogCloseLogFile (put);
 	#endif
 }
 
+static inline void initRotateAtSizeInCUNILOG_TARGET (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogPostfixDotNumberSize == put->culogPostfix)
+	{	// Size-triggered rotations can be frequent. The renames are applied to the
+		//	index instead of reading the logging folder each time.
+		put->ullRotateAtSize = CUNILOG_DEFAULT_ROTATE_AT_SIZE;
+		cunilogTargetSetFLSindex (put);
+	} else
+		put->ullRotateAtSize = 0;
+}
+
 static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
@@ -1693,9 +2612,40 @@ static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *pu
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 		put->nPendingNoRotEvts				= 0;
 		put->nPausedEvents					= 0;
+		put->nDbgQueueLocked				= 0;
+		put->nSepLogThreadIdle				= 0;
+		put->nSepLogThreadPosts				= 0;
+		put->nSepLogThreadWakeups			= 0;
+		put->nMaxQueuedEvents				= 0;
+		put->queueFullPolicy				= cunilogQueueFullBlock;
+		put->uiDropSeverities				= 0;
+		put->nBlockedProducers				= 0;
+		memset (put->nDroppedEvents, 0, sizeof (put->nDroppedEvents));
+		put->tlsStaging.bCreated			= false;
+		put->stagings						= NULL;
+		put->bStaging						= false;
+		put->bStagingClosed					= false;
+		put->nStagingEvents					= SIZE_MAX;
+		put->nStagingOctets					= SIZE_MAX;
+		put->ullStagingLatency				= UINT64_MAX;
+		put->pool							= NULL;
+		put->pmt							= NULL;
+		put->pevDeferred					= NULL;
+		put->szBatchLines					= NULL;
+		put->szBatchLinesSize				= 0;
+		put->lnBatchLines					= 0;
+		put->pevBatchLine					= NULL;
+		put->ofsBatchLine					= 0;
+		initSMEMBUF							(&put->mbEchoBatch);
+		put->lnEchoBatch					= 0;
+		put->seqTimestamps					= 0;
 	#endif
+	InitUBF_TIMESTAMP_CACHE					(&put->tsc);
+	InitCUNILOG_TSPREFIX					(&put->tsp);
+	InitCUNILOG_TARGETwriteBehind			(put);
 	put->dumpWidth							= enDataDumpWidth16;
 	put->evSeverityType						= cunilogEvtSeverityTypeDefault;
+	put->uiLogSeverities					= CUNILOG_SEVERITY_MASK_ALL;
 	initPrevTimestamp						(put);
 	InitCUNILOG_TARGETmbLogFold				(put);
 	InitCUNILOG_TARGETdumpstructs			(put);
@@ -1704,6 +2654,7 @@ static inline bool initCommonMembersAndPrepareCUNILOG_TARGET (CUNILOG_TARGET *pu
 	InitCUNILOG_TARGETqueue					(put);
 	initFilesListInCUNILOG_TARGET			(put);
 	cunilogInitCUNILOG_LOGFILE				(put);
+	initRotateAtSizeInCUNILOG_TARGET		(put);
 	bool b;
 	b = StartSeparateLoggingThread_ifNeeded	(put);
 	if (b)
@@ -2201,6 +3152,107 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 	#endif
 #endif
 
+/*
+	Importance of the event severities for ConfigCUNILOG_TARGETminSeverity () and the
+	queue full policy cunilogQueueFullDropBelowSeverity. The higher the value, the more
+	important the severity. The order of the elements is the order of the enumeration
+	cunilogeventseverity. The same ranks decide which of the severity logging macros
+	CUNILOG_COMPILE_MIN_SEVERITY compiles out.
+*/
+static const unsigned char cunilogEvtSeverityRank [] =
+{
+		CUNILOG_SEVRANK_NONE							// cunilogEvtSeverityNone
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityNonePass
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityNoneFail
+	,	CUNILOG_SEVRANK_WARNING							// cunilogEvtSeverityNoneWarn
+	,	CUNILOG_SEVRANK_NONE							// cunilogEvtSeverityBlanks
+	,	CUNILOG_SEVRANK_EMERGENCY						// cunilogEvtSeverityEmergency
+	,	CUNILOG_SEVRANK_NOTICE							// cunilogEvtSeverityNotice
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityInfo
+	,	CUNILOG_SEVRANK_NOTICE							// cunilogEvtSeverityMessage
+	,	CUNILOG_SEVRANK_WARNING							// cunilogEvtSeverityWarning
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityError
+	,	CUNILOG_SEVRANK_INFO							// cunilogEvtSeverityPass
+	,	CUNILOG_SEVRANK_ERROR							// cunilogEvtSeverityFail
+	,	CUNILOG_SEVRANK_CRITICAL						// cunilogEvtSeverityCritical
+	,	CUNILOG_SEVRANK_FATAL							// cunilogEvtSeverityFatal
+	,	CUNILOG_SEVRANK_DEBUG							// cunilogEvtSeverityDebug
+	,	CUNILOG_SEVRANK_TRACE							// cunilogEvtSeverityTrace
+	,	CUNILOG_SEVRANK_DETAIL							// cunilogEvtSeverityDetail
+	,	CUNILOG_SEVRANK_VERBOSE							// cunilogEvtSeverityVerbose
+	,	CUNILOG_SEVRANK_EMERGENCY						// cunilogEvtSeverityIllegal
+};
+
+void ConfigCUNILOG_TARGETseverityMask (CUNILOG_TARGET *put, uint32_t uiMask)
+{
+	ubf_assert_non_NULL (put);
+
+	cunilogAtomicStoreU32 (&put->uiLogSeverities, uiMask & CUNILOG_SEVERITY_MASK_ALL);
+}
+
+uint32_t cunilogSeverityMaskFromMin (cueventseverity sevMin)
+{
+	ubf_assert			(0 <= sevMin);
+	ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sevMin);
+
+	uint32_t	uiMask	= 0;
+	unsigned	sev;
+
+	for (sev = 0; sev < cunilogEvtSeverityXAmountEnumValues; ++ sev)
+	{
+		if (cunilogEvtSeverityRank [sev] >= cunilogEvtSeverityRank [sevMin])
+			uiMask |= CUNILOG_SEVERITY_BIT (sev);
+	}
+	return uiMask;
+}
+
+void ConfigCUNILOG_TARGETminSeverity (CUNILOG_TARGET *put, cueventseverity sevMin)
+{
+	ubf_assert_non_NULL	(put);
+
+	ConfigCUNILOG_TARGETseverityMask (put, cunilogSeverityMaskFromMin (sevMin));
+}
+
+void ConfigCUNILOG_PROCESSORfilter	(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+{
+	ubf_assert_non_NULL (cup);
+
+	cup->uiSkipSeverities	= ~ uiSeverities	& CUNILOG_SEVERITY_MASK_ALL;
+	cup->uiSkipEvtTypes		= ~ uiEvtTypes		& CUNILOG_EVTTYPES_ALL;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	void ConfigCUNILOG_TARGETqueueLimit	(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	{
+		ubf_assert_non_NULL	(put);
+		ubf_assert			(0 <= policy);
+		ubf_assert			(cunilogQueueFullAmountEnumValues > policy);
+		ubf_assert			(0 <= sevThreshold);
+		ubf_assert			(cunilogEvtSeverityXAmountEnumValues > sevThreshold);
+
+		uint32_t	uiDrop	= 0;
+		unsigned	sev;
+
+		for (sev = 0; sev < cunilogEvtSeverityXAmountEnumValues; ++ sev)
+		{
+			if (cunilogEvtSeverityRank [sev] < cunilogEvtSeverityRank [sevThreshold])
+				uiDrop |= (uint32_t) 1 << sev;
+		}
+		put->uiDropSeverities	= uiDrop;
+		put->queueFullPolicy	= policy;
+		put->nMaxQueuedEvents	= nMaxEvents;
+	}
+#endif
+
 #if defined (DEBUG) || defined (CUNILOG_BUILD_SHARED_LIBRARY)
 	void ConfigCUNILOG_TARGETrunProcessorsOnStartup (CUNILOG_TARGET *put, runProcessorsOnStartup rp)
 	{
@@ -2239,10 +3291,14 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 #endif
 
 /*
+	Disables the processors for task task of the target put points to if bDisable is true,
+	enables them otherwise, and compiles the processor plan of the target again. Only the
+	thread that processes the events of the target may call this function.
+
 	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
 	please don't forget to change it there too.
 */
-void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+void cunilogDisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task, bool bDisable)
 {
 	ubf_assert_non_NULL	(put);
 	ubf_assert_non_NULL (put->cprocessors);
@@ -2251,33 +3307,61 @@ void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilo
 	while (n < put->nprocessors)
 	{
 		if (task == put->cprocessors [n]->task)
-			optCunProcSetOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
+		{
+			if (bDisable)
+				optCunProcSetOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
+			else
+				optCunProcClrOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
+		}
+		++ n;
 	}
+	compileProcessorPlan (put);
 }
 
 /*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
+	The separate logging thread runs the processor plan without holding the locker of
+	the target. The change is therefore handed over to it as a command event, which it
+	processes in order with the other events.
 */
-void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+static void cunilogDisableOrQueueTaskProcessors	(
+				CUNILOG_TARGET				*put,
+				enum cunilogprocesstask		task,
+				bool						bDisable
+												)
 {
 	ubf_assert_non_NULL	(put);
-	ubf_assert_non_NULL (put->cprocessors);
 
-	unsigned int n = 0;
-	while (n < put->nprocessors)
-	{
-		if (task == put->cprocessors [n]->task)
-			optCunProcClrOPT_CUNPROC_DISABLED (put->cprocessors [n]->uiOpts);
-		-- n;
-	}
+	#if !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY) && !defined (CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS)
+		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
+		{
+			if (bDisable)
+				ChangeCUNILOG_TARGETdisableTaskProcessors (put, task);
+			else
+				ChangeCUNILOG_TARGETenableTaskProcessors (put, task);
+			return;
+		}
+	#endif
+	EnterCUNILOG_LOCKER (put);
+	cunilogDisableTaskProcessors (put, task, bDisable);
+	LeaveCUNILOG_LOCKER (put);
+}
+
+void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL (put->cprocessors);
+
+	cunilogDisableOrQueueTaskProcessors (put, task, true);
+}
+
+void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert_non_NULL (put->cprocessors);
+
+	cunilogDisableOrQueueTaskProcessors (put, task, false);
 }
 
-/*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
-*/
 void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
@@ -2286,10 +3370,6 @@ void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put)
 	ConfigCUNILOG_TARGETdisableTaskProcessors (put, cunilogProcessEchoToConsole);
 }
 
-/*
-	This function has a declaration in cunilogevtcmds.c too. If its signature changes,
-	please don't forget to change it there too.
-*/
 void ConfigCUNILOG_TARGETenableEchoProcessor (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
@@ -2364,6 +3444,7 @@ static void DoneCUNILOG_TARGETprocessors (CUNILOG_TARGET *put)
 		}
 	}
 
+	DoneCUNILOG_TARGETplan (put);
 	if (cunilogTargetHasProcessorsAllocatedFlag (put))
 	{
 		ubf_free (put->cprocessors);
@@ -2393,10 +3474,21 @@ static void DoneCUNILOG_TARGETpsdump (CUNILOG_TARGET *psu)
 	*/
 }
 
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETstaging (CUNILOG_TARGET *put);
+	static void DoneCUNILOG_TARGETeventPool (CUNILOG_TARGET *put);
+#else
+	#define DoneCUNILOG_TARGETstaging(put)
+	#define DoneCUNILOG_TARGETeventPool(put)
+#endif
+
 static void DoneCUNILOG_TARGETmembers (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	// Before anything the maintenance thread might still use goes away.
+	DoneCUNILOG_TARGETmaintenance (put);
+
 	if (cunilogTargetHasLogPathAllocatedFlag (put))
 		freeSMEMBUF (&put->mbLogPath);
 	if (cunilogTargetHasAppNameAllocatedFlag (put))
@@ -2413,10 +3505,23 @@ static void DoneCUNILOG_TARGETmembers (CUNILOG_TARGET *put)
 	#ifndef CUNILOG_BUILD_WITHOUT_CONSOLE_COLOUR
 		freeSMEMBUF (&put->mbColEventLine);
 	#endif
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		ubf_assert_0 (put->lnEchoBatch);
+		if (isUsableSMEMBUF (&put->mbEchoBatch))
+			freeSMEMBUF (&put->mbEchoBatch);
+		ubf_assert_0 (put->lnBatchLines);
+		if (put->szBatchLines)
+			ubf_free (put->szBatchLines);
+	#endif
 
 	DoneSCUNILOGNPI (&put->scuNPI);
 	DoneCUNILOG_LOCKER (put);
+	DoneCUNILOG_TARGETstaging (put);
+	DoneCUNILOG_TARGETeventPool (put);
+	DoneCUNILOG_TARGETwriteBehind (put);
 	DoneCUNILOG_TARGETqueuesemaphore (put);
+	DoneCUNILOG_TARGETfdLogFold (put);
+	DoneCUNILOG_TARGETflsWatch (put);
 	vec_deinit (&put->fls);
 	DoneSBULKMEM (&put->sbm);
 	DoneCUNILOG_TARGETpsdump (put);
@@ -2815,38 +3920,139 @@ static inline void evtTSFormats_unilogEvtTS_NCSADT (char *chNCSADT, UBF_TIMESTAM
 /*
 	Structure for the event timestamp table.
 	First member is the length that'll be written; second member is a pointer to the
-	function that is going to write this out.
+	function that is going to write this out. The remaining members are the offsets of
+	the time of day digits within the written timestamp, which patchEvtTSprefix () uses
+	to update a cached timestamp. An offset of 0 means the format has no such field.
 */
 typedef struct seventTSformats
 {
 	size_t			len;									// Required length.
 	void			(*fnc) (char *, UBF_TIMESTAMP);			// Function pointer.
+	size_t			ofsHour;								// Offset of "HH".
+	size_t			ofsMinute;								// Offset of "MI".
+	size_t			ofsSecond;								// Offset of "SS".
+	size_t			ofsMillisecond;							// Offset of "000", or 0.
 } SeventTSformats;
 
 SeventTSformats evtTSFormats [cunilogEvtTS_AmountEnumValues] =
 {
 		{	// unilogEvtTS_ISO8601
 			LEN_ISO8601DATETIMESTAMPMS + 1,
-			evtTSFormats_unilogEvtTS_ISO8601				// "YYYY-MM-DD HH:MI:SS.000+01:00 ".
+			evtTSFormats_unilogEvtTS_ISO8601,				// "YYYY-MM-DD HH:MI:SS.000+01:00 ".
+			11, 14, 17, 20
 		}
 	,	{	// unilogEvtTS_ISO8601T
 			LEN_ISO8601DATETIMESTAMPMS + 1,
-			evtTSFormats_unilogEvtTS_ISO8601T				// "YYYY-MM-DDTHH:MI:SS.000+01:00 ".
+			evtTSFormats_unilogEvtTS_ISO8601T,				// "YYYY-MM-DDTHH:MI:SS.000+01:00 ".
+			11, 14, 17, 20
 		}
 	,	{	// unilogEvtTS_ISO8601_3spc
 			LEN_ISO8601DATETIMESTAMPMS + 3,
-			evtTSFormats_unilogEvtTS_ISO8601_3spc			// "YYYY-MM-DD HH:MI:SS.000+01:00   ".
+			evtTSFormats_unilogEvtTS_ISO8601_3spc,			// "YYYY-MM-DD HH:MI:SS.000+01:00   ".
+			11, 14, 17, 20
 		}
 	,	{	// unilogEvtTS_ISO8601T_3spc
 			LEN_ISO8601DATETIMESTAMPMS + 3,
-			evtTSFormats_unilogEvtTS_ISO8601T_3spc			// "YYYY-MM-DDTHH:MI:SS.000+01:00   ".
+			evtTSFormats_unilogEvtTS_ISO8601T_3spc,			// "YYYY-MM-DDTHH:MI:SS.000+01:00   ".
+			11, 14, 17, 20
 		}
 	,	{	// cunilogEvtTS_NCSADT
 			LEN_NCSA_COMMON_LOG_DATETIME + 1,				// "[10/Oct/2000:13:55:36 -0700] ".
-			evtTSFormats_unilogEvtTS_NCSADT
+			evtTSFormats_unilogEvtTS_NCSADT,
+			13, 16, 19, 0
 		}
 };
 
+/*
+	Bits of a UBF_TIMESTAMP, as far as patchEvtTSprefix () is concerned. Microseconds are
+	not part of any event timestamp format. Any change outside the time of day (date and
+	offset) requires the timestamp to be rendered from scratch.
+*/
+#define CUNILOG_TS_MICROSECOND_MASK		(((UBF_TIMESTAMP) 0x3FF)	<< 8)
+#define CUNILOG_TS_MILLISECOND_MASK		(((UBF_TIMESTAMP) 0x3FF)	<< 18)
+#define CUNILOG_TS_SECOND_MASK			(((UBF_TIMESTAMP) 0x3F)		<< 28)
+#define CUNILOG_TS_MINUTE_MASK			(((UBF_TIMESTAMP) 0x3F)		<< 34)
+#define CUNILOG_TS_HOUR_MASK			(((UBF_TIMESTAMP) 0x1F)		<< 40)
+#define CUNILOG_TS_TIMEOFDAY_MASK						\
+(														\
+		CUNILOG_TS_MICROSECOND_MASK						\
+	|	CUNILOG_TS_MILLISECOND_MASK						\
+	|	CUNILOG_TS_SECOND_MASK							\
+	|	CUNILOG_TS_MINUTE_MASK							\
+	|	CUNILOG_TS_HOUR_MASK							\
+)
+
+/*
+	patchEvtTSprefix
+
+	Updates the time of day digits of the cached timestamp ptp points to with the ones
+	of ts. Returns false if the cache needs to be rendered from scratch instead, which
+	is the case when the date or the offset differ, or when a field is out of range.
+*/
+static bool patchEvtTSprefix (CUNILOG_TSPREFIX *ptp, SeventTSformats *pf, UBF_TIMESTAMP ts)
+{
+	ubf_assert_non_NULL (ptp);
+	ubf_assert_non_NULL (pf);
+
+	UBF_TIMESTAMP	d = ptp->stamp ^ ts;
+
+	if (d & ~CUNILOG_TS_TIMEOFDAY_MASK)
+		return false;
+	if (d & CUNILOG_TS_MILLISECOND_MASK && pf->ofsMillisecond)
+	{
+		unsigned int ms = (unsigned int) UBF_TIMESTAMP_MILLISECOND (ts);
+		if (ms > 999)
+			return false;
+		ptp->szPrefix [pf->ofsMillisecond]		= (char) ('0' + ms / 100);
+		ptp->szPrefix [pf->ofsMillisecond + 1]	= (char) ('0' + ms / 10 % 10);
+		ptp->szPrefix [pf->ofsMillisecond + 2]	= (char) ('0' + ms % 10);
+	}
+	if (d & CUNILOG_TS_SECOND_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsSecond, (uint8_t) UBF_TIMESTAMP_SECOND (ts));
+	if (d & CUNILOG_TS_MINUTE_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsMinute, (uint8_t) UBF_TIMESTAMP_MINUTE (ts));
+	if (d & CUNILOG_TS_HOUR_MASK)
+		ubf_str0_from_59max (ptp->szPrefix + pf->ofsHour, (uint8_t) UBF_TIMESTAMP_HOUR (ts));
+	ptp->stamp = ts;
+	return true;
+}
+
+/*
+	writeEvtTimestamp
+
+	Writes the event timestamp of pev in the target's format to szOut and returns the
+	amount of octets written. The target keeps the most recently rendered timestamp. Since
+	consecutive events mostly differ in their milliseconds or seconds only, the digits that
+	changed are patched and the cached timestamp is copied out.
+
+	The function must only be called while creating an event line, which is serialised
+	per target, hence the cache doesn't require a lock.
+*/
+static size_t writeEvtTimestamp (char *szOut, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (szOut);
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	CUNILOG_TSPREFIX	*ptp	= &put->tsp;
+	SeventTSformats		*pf		= &evtTSFormats [put->unilogEvtTSformat];
+
+	ubf_assert (pf->len < sizeof (ptp->szPrefix));
+
+	if	(
+				put->unilogEvtTSformat != ptp->tsf
+			||	!patchEvtTSprefix (ptp, pf, pev->stamp)
+		)
+	{
+		pf->fnc (ptp->szPrefix, pev->stamp);
+		ptp->stamp	= pev->stamp;
+		ptp->tsf	= put->unilogEvtTSformat;
+	}
+	memcpy (szOut, ptp->szPrefix, pf->len);
+	return pf->len;
+}
+
 static inline size_t requiredEvtLineTimestampAndSeverityLength (CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
@@ -2912,10 +4118,7 @@ static size_t writeEventLineFromSUNILOGEVENTU8 (char *szEventLine, CUNILOG_EVENT
 	DBG_RESET_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker);
 
 	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " (see table above).
-	evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].fnc (szEventLine, pev->stamp);
-	//ISO8601_from_UBF_TIMESTAMP (szEventLine, pue->stamp);
-
-	szEventLine += evtTSFormats [pev->pCUNILOG_TARGET->unilogEvtTSformat].len;
+	szEventLine += writeEvtTimestamp (szEventLine, pev);
 	szEventLine += writeEventSeverity (szEventLine, pev->evSeverity, pev->pCUNILOG_TARGET->evSeverityType);
 	DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szEventLine - szOrg);
 
@@ -2981,6 +4184,7 @@ static inline size_t widthOfCaptionLengthFromCunilogEventType (cueventtype type)
 		case cunilogEvtTypeHexDumpWithCaption16:	return 2;
 		case cunilogEvtTypeHexDumpWithCaption32:	return 4;
 		case cunilogEvtTypeHexDumpWithCaption64:	return 8;
+		case cunilogEvtTypeDeferredFmt:				return 0;
 		default:									return 0;
 	}
 }
@@ -3124,8 +4328,7 @@ static size_t createDumpEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
 		char *szOrg = szOut;
 
 		// Timestamp + severity.
-		evtTSFormats [put->unilogEvtTSformat].fnc (szOut, pev->stamp);
-		szOut += evtTSFormats [put->unilogEvtTSformat].len;
+		szOut += writeEvtTimestamp (szOut, pev);
 		szOut += writeEventSeverity (szOut, pev->evSeverity, put->evSeverityType);
 		DBG_TRACK_CHECK_CNTTRACKER (pev->pCUNILOG_TARGET->evtLineTracker, szOut - szOrg);
 
@@ -3194,6 +4397,542 @@ static size_t createU8EventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
 	return CUNILOG_SIZE_ERROR;
 }
 
+/*
+	Deferred formatting.
+
+	An event of type cunilogEvtTypeDeferredFmt carries a copy of the format string,
+	including its NUL terminator, followed by one record per argument. The format string
+	is copied because the caller might not pass a string literal, and its buffer might be
+	gone or overwritten by the time the event is processed. A record consists of a tag octet and 8 octets of
+	payload, which are stored unaligned. The payload of a string record is its length. The
+	string itself follows without NUL terminator. Width and precision arguments ('*') are
+	stored as integer records before the value they belong to.
+
+	The text is rendered by createDeferredFmtEventLineFromSUNILOGEVENT () when the event
+	line is created.
+*/
+#define CUNILOG_DFMT_TAG_INT			'i'
+#define CUNILOG_DFMT_TAG_UINT			'u'
+#define CUNILOG_DFMT_TAG_DOUBLE			'd'
+#define CUNILOG_DFMT_TAG_STRING			's'
+#define CUNILOG_DFMT_TAG_POINTER		'p'
+#define CUNILOG_DFMT_RECORD_SIZE		(1 + sizeof (uint64_t))
+
+// Maximum length of a rebuilt conversion specification, including its NUL terminator.
+#define CUNILOG_DFMT_SPEC_SIZE			(48)
+
+enum cunilogdfmtlength
+{
+		cunilogDfmtLen_none
+	,	cunilogDfmtLen_hh
+	,	cunilogDfmtLen_h
+	,	cunilogDfmtLen_l
+	,	cunilogDfmtLen_ll
+	,	cunilogDfmtLen_j
+	,	cunilogDfmtLen_z
+	,	cunilogDfmtLen_t
+};
+
+typedef struct cunilog_dfmtspec
+{
+	size_t						lenSpec;					// Length, including the '%'.
+	size_t						lenFlags;					// Amount of flag characters.
+	bool						bWidth;
+	bool						bWidthStar;
+	int							iWidth;
+	int							iPrec;						// -1 if no precision.
+	bool						bPrecStar;
+	enum cunilogdfmtlength		len;						// Length modifier.
+	char						cConv;						// Conversion specifier.
+} CUNILOG_DFMTSPEC;
+
+static inline bool isDeferredFmtDigit (char c)
+{
+	return '0' <= c && '9' >= c;
+}
+
+/*
+	Parses a decimal number of at most 6 digits for width and precision. Longer
+	numbers are rejected.
+*/
+static inline bool parseDeferredFmtNumber (int *pi, const char **pcc)
+{
+	const char	*cc = *pcc;
+	int			i	= 0;
+	int			n	= 0;
+
+	while (isDeferredFmtDigit (*cc))
+	{
+		if (6 == n ++)
+			return false;
+		i = i * 10 + (*cc ++ - '0');
+	}
+	*pi		= i;
+	*pcc	= cc;
+	return true;
+}
+
+/*
+	Parses the conversion specification at ccFmt, which must point to a '%'. The function
+	returns false if the conversion specification is not supported for deferred formatting.
+	Supported are the conversion specifiers d, i, u, o, x, X, c, s, p, f, F, e, E, g, G,
+	a, and A with the flags "-+ #0", width and precision (both also as '*'), and the length
+	modifiers hh, h, l, ll, j, z, and t for integers. Not supported are %n, long double
+	(L), wide characters and strings (%lc, %ls), and positional arguments.
+*/
+static bool parseDeferredFmtSpec (CUNILOG_DFMTSPEC *ps, const char *ccFmt)
+{
+	ubf_assert_non_NULL (ps);
+	ubf_assert_non_NULL (ccFmt);
+	ubf_assert ('%' == ccFmt [0]);
+
+	const char	*cc		= ccFmt + 1;
+
+	ps->bWidth			= false;
+	ps->bWidthStar		= false;
+	ps->iWidth			= 0;
+	ps->iPrec			= -1;
+	ps->bPrecStar		= false;
+	ps->len				= cunilogDfmtLen_none;
+
+	if ('%' == *cc)
+	{
+		ps->lenFlags	= 0;
+		ps->cConv		= '%';
+		ps->lenSpec		= 2;
+		return true;
+	}
+	while ('-' == *cc || '+' == *cc || ' ' == *cc || '#' == *cc || '0' == *cc)
+		++ cc;
+	ps->lenFlags = cc - ccFmt - 1;
+	if ('*' == *cc)
+	{
+		ps->bWidth		= true;
+		ps->bWidthStar	= true;
+		++ cc;
+	} else
+	if (isDeferredFmtDigit (*cc))
+	{
+		ps->bWidth		= true;
+		if (!parseDeferredFmtNumber (&ps->iWidth, &cc))
+			return false;
+	}
+	if ('.' == *cc)
+	{
+		++ cc;
+		if ('*' == *cc)
+		{
+			ps->bPrecStar	= true;
+			++ cc;
+		} else
+		if (!parseDeferredFmtNumber (&ps->iPrec, &cc))
+			return false;
+	}
+	switch (*cc)
+	{
+		case 'h':
+			++ cc;
+			if ('h' == *cc)
+			{
+				ps->len = cunilogDfmtLen_hh;
+				++ cc;
+			} else
+				ps->len = cunilogDfmtLen_h;
+			break;
+		case 'l':
+			++ cc;
+			if ('l' == *cc)
+			{
+				ps->len = cunilogDfmtLen_ll;
+				++ cc;
+			} else
+				ps->len = cunilogDfmtLen_l;
+			break;
+		case 'j':	ps->len = cunilogDfmtLen_j;	++ cc;		break;
+		case 'z':	ps->len = cunilogDfmtLen_z;	++ cc;		break;
+		case 't':	ps->len = cunilogDfmtLen_t;	++ cc;		break;
+		default:											break;
+	}
+	ps->cConv = *cc;
+	switch (ps->cConv)
+	{
+		case 'd':	case 'i':	case 'u':	case 'o':	case 'x':	case 'X':
+			break;
+		case 'c':	case 's':	case 'p':
+			if (cunilogDfmtLen_none != ps->len)
+				return false;
+			break;
+		case 'f':	case 'F':	case 'e':	case 'E':
+		case 'g':	case 'G':	case 'a':	case 'A':
+			// "%lf" is identical to "%f".
+			if (cunilogDfmtLen_none != ps->len && cunilogDfmtLen_l != ps->len)
+				return false;
+			break;
+		default:
+			// This includes %n and the NUL terminator.
+			return false;
+	}
+	ps->lenSpec = cc + 1 - ccFmt;
+	return true;
+}
+
+static inline size_t storeDeferredFmtRecord (unsigned char *pRec, char tag, uint64_t ui)
+{
+	if (pRec)
+	{
+		pRec [0] = (unsigned char) tag;
+		memcpy (pRec + 1, &ui, sizeof (uint64_t));
+	}
+	return CUNILOG_DFMT_RECORD_SIZE;
+}
+
+static inline size_t storeDeferredFmtInt (unsigned char *pRec, int64_t i)
+{
+	uint64_t	ui;
+
+	memcpy (&ui, &i, sizeof (uint64_t));
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_INT, ui);
+}
+
+static inline size_t storeDeferredFmtDouble (unsigned char *pRec, double d)
+{
+	uint64_t	ui;
+
+	ubf_assert (sizeof (double) == sizeof (uint64_t));
+	memcpy (&ui, &d, sizeof (uint64_t));
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_DOUBLE, ui);
+}
+
+/*
+	Strings are copied. If a precision is given, not more than iPrec octets are read,
+	which means the string does not need to be NUL-terminated in this case.
+*/
+static inline size_t storeDeferredFmtString (unsigned char *pRec, const char *sz, int iPrec)
+{
+	size_t		ln	= 0;
+
+	if (NULL == sz)
+		sz = "(null)";
+	if (iPrec < 0)
+		ln = strlen (sz);
+	else
+		while (ln < (size_t) iPrec && sz [ln])
+			++ ln;
+	if (pRec)
+		memcpy (pRec + CUNILOG_DFMT_RECORD_SIZE, sz, ln);
+	return storeDeferredFmtRecord (pRec, CUNILOG_DFMT_TAG_STRING, ln) + ln;
+}
+
+/*
+	Walks the format string fmt and stores a copy of fmt and the arguments of ap in the
+	binary argument record at pRec. If pRec is NULL, the function only returns the required
+	size of the record. The function returns CUNILOG_SIZE_ERROR if fmt contains a
+	conversion specification that is not supported for deferred formatting.
+*/
+static size_t storeDeferredFmtArgs (unsigned char *pRec, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (fmt);
+
+	CUNILOG_DFMTSPEC	spec;
+	const char			*cc		= fmt;
+	size_t				r		= strlen (fmt) + 1;
+	int64_t				i64;
+	uint64_t			u64;
+	int					i;
+
+	if (pRec)
+		memcpy (pRec, fmt, r);
+	while (NULL != (cc = strchr (cc, '%')))
+	{
+		if (!parseDeferredFmtSpec (&spec, cc))
+			return CUNILOG_SIZE_ERROR;
+		cc += spec.lenSpec;
+		if ('%' == spec.cConv)
+			continue;
+		if (spec.bWidthStar)
+			r += storeDeferredFmtInt (pRec ? pRec + r : NULL, va_arg (ap, int));
+		if (spec.bPrecStar)
+		{
+			i = va_arg (ap, int);
+			r += storeDeferredFmtInt (pRec ? pRec + r : NULL, i);
+			spec.iPrec = i < 0 ? -1 : i;
+		}
+		switch (spec.cConv)
+		{
+			case 'd':
+			case 'i':
+				switch (spec.len)
+				{
+					case cunilogDfmtLen_hh:	i64 = (signed char) va_arg (ap, int);	break;
+					case cunilogDfmtLen_h:	i64 = (short) va_arg (ap, int);			break;
+					case cunilogDfmtLen_l:	i64 = va_arg (ap, long);				break;
+					case cunilogDfmtLen_ll:	i64 = va_arg (ap, long long);			break;
+					case cunilogDfmtLen_j:	i64 = va_arg (ap, intmax_t);			break;
+					case cunilogDfmtLen_z:	i64 = (int64_t) va_arg (ap, size_t);	break;
+					case cunilogDfmtLen_t:	i64 = va_arg (ap, ptrdiff_t);			break;
+					default:				i64 = va_arg (ap, int);					break;
+				}
+				r += storeDeferredFmtInt (pRec ? pRec + r : NULL, i64);
+				break;
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+				switch (spec.len)
+				{
+					case cunilogDfmtLen_hh:	u64 = (unsigned char) va_arg (ap, unsigned int);	break;
+					case cunilogDfmtLen_h:	u64 = (unsigned short) va_arg (ap, unsigned int);	break;
+					case cunilogDfmtLen_l:	u64 = va_arg (ap, unsigned long);					break;
+					case cunilogDfmtLen_ll:	u64 = va_arg (ap, unsigned long long);				break;
+					case cunilogDfmtLen_j:	u64 = va_arg (ap, uintmax_t);						break;
+					case cunilogDfmtLen_z:	u64 = va_arg (ap, size_t);							break;
+					case cunilogDfmtLen_t:	u64 = (uint64_t) va_arg (ap, ptrdiff_t);			break;
+					default:				u64 = va_arg (ap, unsigned int);					break;
+				}
+				r += storeDeferredFmtRecord (pRec ? pRec + r : NULL, CUNILOG_DFMT_TAG_UINT, u64);
+				break;
+			case 'c':
+				r += storeDeferredFmtInt (pRec ? pRec + r : NULL, va_arg (ap, int));
+				break;
+			case 's':
+				r += storeDeferredFmtString	(
+						pRec ? pRec + r : NULL, va_arg (ap, const char *), spec.iPrec
+											);
+				break;
+			case 'p':
+				u64 = (uint64_t) (uintptr_t) va_arg (ap, void *);
+				r += storeDeferredFmtRecord (pRec ? pRec + r : NULL, CUNILOG_DFMT_TAG_POINTER, u64);
+				break;
+			default:
+				r += storeDeferredFmtDouble (pRec ? pRec + r : NULL, va_arg (ap, double));
+				break;
+		}
+	}
+	return r;
+}
+
+typedef struct cunilog_dfmtarg
+{
+	char						tag;
+	uint64_t					ui;
+	const char					*sz;						// Only for strings.
+} CUNILOG_DFMTARG;
+
+static inline void readDeferredFmtRecord (CUNILOG_DFMTARG *pa, const unsigned char **ppRec)
+{
+	const unsigned char *pRec = *ppRec;
+
+	pa->tag = (char) pRec [0];
+	memcpy (&pa->ui, pRec + 1, sizeof (uint64_t));
+	pRec += CUNILOG_DFMT_RECORD_SIZE;
+	if (CUNILOG_DFMT_TAG_STRING == pa->tag)
+	{
+		pa->sz	= (const char *) pRec;
+		pRec	+= pa->ui;
+	}
+	*ppRec = pRec;
+}
+
+static inline int readDeferredFmtInt (const unsigned char **ppRec)
+{
+	CUNILOG_DFMTARG		arg;
+	int64_t				i64;
+
+	readDeferredFmtRecord (&arg, ppRec);
+	ubf_assert (CUNILOG_DFMT_TAG_INT == arg.tag);
+	memcpy (&i64, &arg.ui, sizeof (int64_t));
+	return (int) i64;
+}
+
+/*
+	Rebuilds the conversion specification ps describes in szSpec, with width and
+	precision as numbers. Integers are always rendered with the length modifier "ll",
+	and strings with their stored length as precision since they're not NUL-terminated.
+*/
+static void buildDeferredFmtSpec (char *szSpec, const char *ccFmtSpec, CUNILOG_DFMTSPEC *ps)
+{
+	char	*sz		= szSpec;
+	char	*szEnd	= szSpec + CUNILOG_DFMT_SPEC_SIZE;
+
+	*sz ++ = '%';
+	memcpy (sz, ccFmtSpec + 1, ps->lenFlags);
+	sz += ps->lenFlags;
+	if (ps->bWidth)
+		sz += snprintf (sz, szEnd - sz, "%d", ps->iWidth);
+	if (ps->iPrec >= 0)
+		sz += snprintf (sz, szEnd - sz, ".%d", ps->iPrec);
+	switch (ps->cConv)
+	{
+		case 'd':	case 'i':	case 'u':	case 'o':	case 'x':	case 'X':
+			*sz ++ = 'l';
+			*sz ++ = 'l';
+			break;
+		default:
+			break;
+	}
+	*sz ++ = ps->cConv;
+	*sz = ASCII_NUL;
+	ubf_assert (sz < szEnd);
+}
+
+static inline int renderDeferredFmtArg	(
+					char						*sz,
+					size_t						siz,
+					const char					*szSpec,
+					char						cConv,
+					CUNILOG_DFMTARG				*pa
+										)
+{
+	int64_t		i64;
+	double		d;
+
+	switch (pa->tag)
+	{
+		case CUNILOG_DFMT_TAG_INT:
+			memcpy (&i64, &pa->ui, sizeof (int64_t));
+			if ('c' == cConv)
+				return snprintf (sz, siz, szSpec, (int) i64);
+			return snprintf (sz, siz, szSpec, (long long) i64);
+		case CUNILOG_DFMT_TAG_UINT:
+			return snprintf (sz, siz, szSpec, (unsigned long long) pa->ui);
+		case CUNILOG_DFMT_TAG_DOUBLE:
+			memcpy (&d, &pa->ui, sizeof (double));
+			return snprintf (sz, siz, szSpec, d);
+		case CUNILOG_DFMT_TAG_STRING:
+			return snprintf (sz, siz, szSpec, pa->sz);
+		case CUNILOG_DFMT_TAG_POINTER:
+			return snprintf (sz, siz, szSpec, (void *) (uintptr_t) pa->ui);
+	}
+	ubf_assert_msg (false, "Cunilog bug! Unknown deferred formatting tag.");
+	return -1;
+}
+
+static inline bool growDeferredFmtBuf (SMEMBUF *mb, size_t siz)
+{
+	if (mb->size < siz)
+		growToSizeRetainSMEMBUF (mb, ALIGNED_SIZE (siz, 64));
+	return isUsableSMEMBUF (mb);
+}
+
+/*
+	Renders the format string and the argument record of the event pev points to into
+	the buffer of mb, starting at offset offs. The buffer grows as required. The
+	function returns the length of the rendered text, or CUNILOG_SIZE_ERROR.
+*/
+static size_t renderDeferredFmt (SMEMBUF *mb, size_t offs, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (mb);
+	ubf_assert_non_NULL (pev);
+	ubf_assert (cunilogEvtTypeDeferredFmt == pev->evType);
+
+	const unsigned char	*pRec	= pev->szDataToLog;
+	const char			*fmt;
+	const char			*cc;
+	const char			*pc;
+	size_t				pos		= offs;
+	size_t				ln;
+	CUNILOG_DFMTSPEC	spec;
+	CUNILOG_DFMTARG		arg;
+	char				szSpec [CUNILOG_DFMT_SPEC_SIZE];
+	int					i;
+
+	if (!growDeferredFmtBuf (mb, offs + 1))
+		return CUNILOG_SIZE_ERROR;
+	fmt = (const char *) pRec;
+	pRec += strlen (fmt) + 1;
+	cc = fmt;
+	while (*cc)
+	{
+		pc = strchr (cc, '%');
+		ln = pc ? (size_t) (pc - cc) : strlen (cc);
+		if (ln)
+		{
+			if (!growDeferredFmtBuf (mb, pos + ln + 1))
+				return CUNILOG_SIZE_ERROR;
+			memcpy (mb->buf.pch + pos, cc, ln);
+			pos += ln;
+			cc += ln;
+		}
+		if (NULL == pc)
+			break;
+		if (!parseDeferredFmtSpec (&spec, cc))
+		{
+			ubf_assert_msg (false, "Cunilog bug! This has been checked by the producer.");
+			return CUNILOG_SIZE_ERROR;
+		}
+		if ('%' == spec.cConv)
+		{
+			if (!growDeferredFmtBuf (mb, pos + 2))
+				return CUNILOG_SIZE_ERROR;
+			mb->buf.pch [pos ++] = '%';
+			cc += spec.lenSpec;
+			continue;
+		}
+		if (spec.bWidthStar)
+			spec.iWidth = readDeferredFmtInt (&pRec);
+		if (spec.bPrecStar)
+		{
+			spec.iPrec = readDeferredFmtInt (&pRec);
+			spec.iPrec = spec.iPrec < 0 ? -1 : spec.iPrec;
+		}
+		readDeferredFmtRecord (&arg, &pRec);
+		if (CUNILOG_DFMT_TAG_STRING == arg.tag)
+			spec.iPrec = (int) arg.ui;
+		buildDeferredFmtSpec (szSpec, cc, &spec);
+		cc += spec.lenSpec;
+		i = renderDeferredFmtArg (mb->buf.pch + pos, mb->size - pos, szSpec, spec.cConv, &arg);
+		if (i < 0)
+			return CUNILOG_SIZE_ERROR;
+		if ((size_t) i >= mb->size - pos)
+		{
+			if (!growDeferredFmtBuf (mb, pos + i + 1))
+				return CUNILOG_SIZE_ERROR;
+			i = renderDeferredFmtArg (mb->buf.pch + pos, mb->size - pos, szSpec, spec.cConv, &arg);
+			ubf_assert ((size_t) i < mb->size - pos);
+		}
+		pos += i;
+	}
+	ubf_assert (pRec == pev->szDataToLog + pev->lenDataToLog);
+	return pos - offs;
+}
+
+static size_t createDeferredFmtEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+	ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+	ubf_assert (isInitialisedSMEMBUF (&pev->pCUNILOG_TARGET->mbLogEventLine));
+	ubf_assert (cunilogEvtTypeDeferredFmt == pev->evType);
+
+	CUNILOG_TARGET	*put		= pev->pCUNILOG_TARGET;
+	SMEMBUF			*mb			= &put->mbLogEventLine;
+
+	// "YYYY-MM-DD HH:MI:SS.000+01:00" + " " + "WRN" + " ".
+	size_t			lenPrefix	= requiredEvtLineTimestampAndSeverityLength (pev);
+
+	// The text is rendered first, directly behind the space reserved for the prefix.
+	size_t			lenText		= renderDeferredFmt (mb, lenPrefix, pev);
+	if (CUNILOG_SIZE_ERROR == lenText)
+		return CUNILOG_SIZE_ERROR;
+	lenText = strRemoveLineEndingsFromEnd (mb->buf.pch + lenPrefix, lenText);
+
+	// "." + CR + LF max. + NUL.
+	if (!growDeferredFmtBuf (mb, lenPrefix + lenText + 1 + eventLenNewline (pev) + 1))
+		return CUNILOG_SIZE_ERROR;
+
+	char *szOut = mb->buf.pch;
+	szOut += writeEvtTimestamp (szOut, pev);
+	szOut += writeEventSeverity (szOut, pev->evSeverity, put->evSeverityType);
+	ubf_assert (szOut == mb->buf.pch + lenPrefix);
+
+	szOut += lenText;
+	if (cunilogIsEventAutoFullstop (pev) && lenText && '.' != szOut [-1])
+		*szOut ++ = '.';
+	szOut [0] = ASCII_NUL;
+
+	put->lnLogEventLine = szOut - mb->buf.pch;
+	return put->lnLogEventLine;
+}
+
 static size_t createEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
@@ -3216,6 +4955,8 @@ static size_t createEventLineFromSUNILOGEVENT (CUNILOG_EVENT *pev)
 		case cunilogEvtTypeHexDumpWithCaption32:
 		case cunilogEvtTypeHexDumpWithCaption64:
 			return createDumpEventLineFromSUNILOGEVENT	(pev);
+		case cunilogEvtTypeDeferredFmt:
+			return createDeferredFmtEventLineFromSUNILOGEVENT (pev);
 		default:
 			break;
 	}
@@ -3269,33 +5010,517 @@ static inline void storeCaptionLength (unsigned char **pData, size_t ui, size_t
 }
 
 /*
-	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
-	in which case a buffer of siz octets is reserved but not initialised!
+	The event pool.
+
+	A slot consists of a CUNILOG_POOLSLOT header, the CUNILOG_EVENT structure, and the
+	payload of its size class for caption and data. Free slots are kept in a lock-free
+	singly-linked list per size class. Any thread can return a slot to the list with a
+	compare-and-swap, but only one thread at a time takes slots from it, which is what
+	the locker of the size class is for. With a single taker a slot can't be taken and
+	returned between reading the head of the list and swapping it, i.e. there's no ABA
+	problem. New slots are carved from the bulk memory of the pool.
 */
-static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
-					CUNILOG_TARGET				*put,
-					cueventseverity				sev,
-					const char					*ccCapt,
-					size_t						lenCapt,
-					cueventtype					type,
-					const char					*ccData,
-					size_t						siz
-													)
-{
-	ubf_assert_non_NULL	(put);
-	if (ccData)
-		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
-	else
-		ubf_assert (cunilogEvtTypeCommand == type && NULL == ccData);
-	ubf_assert			(USE_STRLEN != siz);
-	ubf_assert			(0 <= type);
-	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static const size_t stEventPoolPayloads [] =
+	{
+		128, 256, 512, 1024, 4096
+	};
 
-	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
-	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
-	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+	#define CUNILOG_POOLSLOT_HEADER_SIZE				\
+		ALIGNED_SIZE (sizeof (CUNILOG_POOLSLOT), CUNILOG_DEFAULT_ALIGNMENT)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns an event from the pool. The parameter ln is the total size of the event,
+		including the aligned CUNILOG_EVENT structure. The function returns NULL if the
+		event is too big for the pool or no slot could be obtained, in which case the
+		caller allocates it from the heap.
+	*/
+	static CUNILOG_EVENT *GetPooledCUNILOG_EVENT (CUNILOG_EVENTPOOL *pool, size_t ln)
+	{
+		ubf_assert_non_NULL (pool);
+
+		size_t					aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
+		CUNILOG_EVENTPOOL_CLASS	*pcl	= NULL;
+		CUNILOG_POOLSLOT		*ps;
+		unsigned int			ui;
+
+		ubf_assert (ln >= aln);
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			if (ln - aln <= pool->classes [ui].stPayload)
+			{
+				pcl = &pool->classes [ui];
+				break;
+			}
+		}
+		if (NULL == pcl)
+		{
+			cunilogAtomicAddSize (&pool->nHeapAllocs, 1);
+			return NULL;
+		}
+
+		EnterLocker (&pcl->cl);
+		ps = cunilogAtomicLoadSlot (&pcl->free);
+		while (ps && !cunilogAtomicCasSlot (&pcl->free, &ps, ps->next))
+			;
+		if (NULL == ps)
+		{
+			EnterLocker (&pool->cl);
+			ps = GetAlignedMemFromSBULKMEMgrow	(
+					&pool->sbm, CUNILOG_POOLSLOT_HEADER_SIZE + aln + pcl->stPayload
+												);
+			LeaveLocker (&pool->cl);
+			if (ps)
+			{
+				ps->pClass = pcl;
+				++ pcl->nSlots;
+			}
+		}
+		if (ps)
+			++ pcl->nAllocs;
+		LeaveLocker (&pcl->cl);
+
+		if (NULL == ps)
+		{
+			cunilogAtomicAddSize (&pool->nHeapAllocs, 1);
+			return NULL;
+		}
+		ps->next = NULL;
+		cunilogAtomicAddSize (&pcl->nInUse, 1);
+		cunilogAtomicAddSize (&pool->nRefs, 1);
+		return (CUNILOG_EVENT *) ((unsigned char *) ps + CUNILOG_POOLSLOT_HEADER_SIZE);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_EVENTPOOL (CUNILOG_EVENTPOOL *pool)
+	{
+		ubf_assert_non_NULL (pool);
+
+		unsigned int ui;
+
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			ubf_assert_0 (pool->classes [ui].nInUse);
+			DoneLocker (&pool->classes [ui].cl);
+		}
+		DoneSBULKMEM (&pool->sbm);
+		DoneLocker (&pool->cl);
+		ubf_free (pool);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Releases a reference to the pool and deallocates the pool if it was the last one.
+	*/
+	static inline void ReleaseCUNILOG_EVENTPOOL (CUNILOG_EVENTPOOL *pool)
+	{
+		ubf_assert_non_NULL (pool);
+
+		if (1 == cunilogAtomicSubSize (&pool->nRefs, 1))
+			DoneCUNILOG_EVENTPOOL (pool);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns the slot of a pooled event to the free list of its size class. This
+		is called from any thread. The target of the pool may have been destroyed
+		already if the event has been handed on to another target.
+	*/
+	static void ReturnPooledCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogIsEventPooled (pev));
+
+		CUNILOG_POOLSLOT		*ps		=
+			(CUNILOG_POOLSLOT *) ((unsigned char *) pev - CUNILOG_POOLSLOT_HEADER_SIZE);
+		CUNILOG_EVENTPOOL_CLASS	*pcl	= ps->pClass;
+		CUNILOG_POOLSLOT		*head;
+
+		ubf_assert_non_NULL (pcl);
+		cunilogAtomicSubSize (&pcl->nInUse, 1);
+		head = cunilogAtomicLoadSlot (&pcl->free);
+		do
+		{
+			ps->next = head;
+		} while (!cunilogAtomicCasSlot (&pcl->free, &head, ps));
+		ReleaseCUNILOG_EVENTPOOL (pcl->pool);
+	}
+#endif
+
+/*
+	Allocates the memory for an event of ln octets, either from the event pool of the
+	target or from the heap. The flag that tells DoneCUNILOG_EVENT () how to deallocate
+	the event is written to puiOpts.
+*/
+static inline CUNILOG_EVENT *AllocCUNILOG_EVENT	(
+					CUNILOG_TARGET				*put,
+					size_t						ln,
+					uint64_t					*puiOpts
+												)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (puiOpts);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (put->pool)
+		{
+			CUNILOG_EVENT *pev = GetPooledCUNILOG_EVENT (put->pool, ln);
+			if (pev)
+			{
+				*puiOpts = CUNILOGEVENT_POOLED;
+				return pev;
+			}
+		}
+	#endif
+	*puiOpts = CUNILOGEVENT_ALLOCATED;
+	return ubf_malloc (ln);
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETeventPool (CUNILOG_TARGET *put, size_t stBulkSize)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->pool);
+
+		if (put->pool)
+			return true;
+
+		CUNILOG_EVENTPOOL *pool = ubf_malloc (sizeof (CUNILOG_EVENTPOOL));
+		if (NULL == pool)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		InitLocker (&pool->cl);
+		InitSBULKMEM (&pool->sbm, stBulkSize ? stBulkSize : CUNILOG_STD_EVENTPOOL_SIZE);
+		unsigned int ui;
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			pool->classes [ui].pool			= pool;
+			pool->classes [ui].free			= NULL;
+			InitLocker (&pool->classes [ui].cl);
+			pool->classes [ui].stPayload	= stEventPoolPayloads [ui];
+			pool->classes [ui].nSlots		= 0;
+			pool->classes [ui].nInUse		= 0;
+			pool->classes [ui].nAllocs		= 0;
+		}
+		pool->nHeapAllocs	= 0;
+		pool->nRefs			= 1;
+		put->pool			= pool;
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool getCUNILOG_EVENTPOOLstats (CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (pStats);
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_EVENTPOOL	*pool	= put->pool;
+		unsigned int		ui;
+
+		if (NULL == pool)
+			return false;
+		for (ui = 0; ui < CUNILOG_EVENTPOOL_CLASSES; ++ ui)
+		{
+			CUNILOG_EVENTPOOL_CLASS *pcl = &pool->classes [ui];
+
+			EnterLocker (&pcl->cl);
+			pStats->stPayload [ui]	= pcl->stPayload;
+			pStats->nSlots [ui]		= pcl->nSlots;
+			pStats->nAllocs [ui]	= pcl->nAllocs;
+			LeaveLocker (&pcl->cl);
+			pStats->nInUse [ui]		= cunilogAtomicLoadSize (&pcl->nInUse);
+		}
+		pStats->nHeapAllocs = cunilogAtomicLoadSize (&pool->nHeapAllocs);
+		EnterLocker (&pool->cl);
+		getSBULKMEMstats (&pStats->sbmStats, &pool->sbm);
+		LeaveLocker (&pool->cl);
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when the target is destroyed. Events of the pool that have been handed on
+		to other targets may still be in use, in which case the last one of them returned
+		deallocates the pool.
+	*/
+	static void DoneCUNILOG_TARGETeventPool (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->pool)
+		{
+			ReleaseCUNILOG_EVENTPOOL (put->pool);
+			put->pool = NULL;
+		}
+	}
+#endif
+
+void ConfigCUNILOG_TARGETcachedTimestamps (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogHasCachedTimestamps (put))
+		return;
+	InitUBF_TIMESTAMP_CACHE (&put->tsc);
+	cunilogSetCachedTimestamps (put);
+}
+
+bool ConfigCUNILOG_TARGETwriteBehind	(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (cunilogWriteBehindAmountEnumValues > policy);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+	if (nOctets != pwb->siz)
+	{	// Data already waiting in the buffer goes out first.
+		cunilogWriteBehindToLogFileAndWait (put);
+		#ifdef CUNILOG_HAVE_IO_URING
+			// The io_uring buffer must have the same size.
+			bool bIoUring = 0 <= pwb->ur.fdRing;
+			DoneCUNILOG_IOURING (&pwb->ur);
+		#endif
+		if (pwb->buf)
+		{
+			ubf_free (pwb->buf);
+			pwb->buf = NULL;
+			pwb->siz = 0;
+		}
+		if (0 == nOctets)
+		{	// Without the buffer there's nothing to compress.
+			DoneEXTCMPFRAMER (pwb->pfr);
+			pwb->pfr = NULL;
+		}
+		if (nOctets)
+		{
+			pwb->buf = ubf_malloc (nOctets);
+			if (NULL == pwb->buf)
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+				return false;
+			}
+			pwb->siz = nOctets;
+			#ifndef OS_IS_WINDOWS
+				// From now on we write to the file descriptor directly.
+				if (!cunilogHasRawLogfile (put) && put->logfile.fLogFile)
+					fflush (put->logfile.fLogFile);
+			#endif
+			#ifdef CUNILOG_HAVE_IO_URING
+				if (bIoUring)
+					ConfigCUNILOG_TARGETioUring (put);
+			#endif
+		}
+	}
+	// FILETIME units are 100 ns.
+	pwb->ullLatency		= msLatency ? (uint64_t) msLatency * 10000 : UINT64_MAX;
+	pwb->policy			= policy;
+	pwb->nSyncOctets	= nSyncOctets;
+	return true;
+}
+
+bool ConfigCUNILOG_TARGETioUring (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef CUNILOG_HAVE_IO_URING
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+		CUNILOG_IOURING		*pur	= &pwb->ur;
+
+		if (0 <= pur->fdRing)
+			return true;
+		if (NULL == pwb->buf || cunilogHasMappedLogfile (put))
+			return false;
+		pur->buf = ubf_malloc (pwb->siz);
+		if (NULL == pur->buf)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		pur->siz = pwb->siz;
+		if (SetupCUNILOG_IOURING (pur))
+			return true;
+		// Falls back to writev ().
+		DoneCUNILOG_IOURING (pur);
+		return false;
+	#else
+		UNUSED (put);
+		return false;
+	#endif
+}
+
+void ConfigCUNILOG_TARGETrawLogfile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef OS_IS_WINDOWS
+		if (cunilogHasRawLogfile (put))
+			return;
+		// A logfile opened by the C runtime library is reopened as a raw one on demand.
+		cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		cunilogSetRawLogfile (put);
+	#else
+		UNUSED (put);
+	#endif
+}
+
+void ConfigCUNILOG_TARGETmappedLogfile (CUNILOG_TARGET *put, size_t nChunk)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef OS_IS_WINDOWS
+		size_t	page	= (size_t) sysconf (_SC_PAGESIZE);
+
+		nChunk = nChunk ? nChunk : CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE;
+		nChunk = (nChunk + page - 1) / page * page;
+		// Whatever is open now is reopened as a mapped logfile on demand.
+		cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		put->logfile.lnMapChunk = nChunk;
+		cunilogSetRawLogfile (put);
+		cunilogSetMappedLogfile (put);
+	#else
+		UNUSED (put);
+		UNUSED (nChunk);
+	#endif
+}
+
+bool ConfigCUNILOG_TARGETcompressedLogfile	(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	EXTCMPFRAMER		*pfr;
+
+	pfr = CreateEXTCMPFRAMER (cmp, level);
+	if (NULL == pfr)
+		return false;
+	nFrameOctets = nFrameOctets ? nFrameOctets : CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE;
+	// Data waiting in the buffer goes out with the previous settings.
+	cunilogWriteBehindToLogFileAndWait (put);
+	if	(
+				nFrameOctets != pwb->siz
+			&&	!ConfigCUNILOG_TARGETwriteBehind	(
+					put, nFrameOctets,
+					UINT64_MAX == pwb->ullLatency ? 0 : (unsigned int) (pwb->ullLatency / 10000),
+					pwb->policy, pwb->nSyncOctets
+												)
+		)
+	{
+		DoneEXTCMPFRAMER (pfr);
+		return false;
+	}
+	DoneEXTCMPFRAMER (pwb->pfr);
+	pwb->pfr = pfr;
+	return true;
+}
+
+/*
+	Returns the local time for the timestamp of an event of the target put points to.
+*/
+static inline UBF_TIMESTAMP cunilogLocalTimestamp (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogHasCachedTimestamps (put))
+	{
+		UBF_TIMESTAMP	ts;
+
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			UBF_TIMESTAMP_CACHE	tsc;
+			uint32_t			seq;
+			bool				bValid;
+			int64_t				tSec;
+
+			seq = cunilogTimestampSeqBeginRead (&put->seqTimestamps);
+			cunilogTimestampCacheLoad (&tsc, &put->tsc);
+			bValid = cunilogTimestampSeqEndRead (&put->seqTimestamps, seq);
+
+			// A torn copy or a copy taken during an update is discarded.
+			if (!bValid)
+				InitUBF_TIMESTAMP_CACHE (&tsc);
+			tSec = tsc.tSec;
+			GetLocalTimeCached_UBF_TIMESTAMP (&ts, &tsc);
+
+			// The first thread that sees a new second publishes it. Other threads don't wait.
+			if	(
+						bValid
+					&&	tSec != tsc.tSec
+					&&	cunilogTimestampSeqTryBeginWrite (&put->seqTimestamps, seq)
+				)
+			{
+				cunilogTimestampCacheStore (&put->tsc, &tsc);
+				cunilogTimestampSeqEndWrite (&put->seqTimestamps, seq);
+			}
+		#else
+			GetLocalTimeCached_UBF_TIMESTAMP (&ts, &put->tsc);
+		#endif
+		return ts;
+	}
+	return LocalTime_UBF_TIMESTAMP ();
+}
+
+/*
+	Note that ccData can be NULL for event type cunilogEvtTypeCommand,
+	in which case a buffer of siz octets is reserved but not initialised!
+	This is also used for event type cunilogEvtTypeNormalText by
+	CreateCUNILOG_EVENT_Textvfmt (), which formats its text directly into
+	the reserved buffer, and for event type cunilogEvtTypeDeferredFmt by
+	CreateCUNILOG_EVENT_TextDeferredvfmt (), which stores its argument record
+	there.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*ccCapt,
+					size_t						lenCapt,
+					cueventtype					type,
+					const char					*ccData,
+					size_t						siz
+													)
+{
+	ubf_assert_non_NULL	(put);
+	if (ccData)
+		ubf_assert (cunilogEvtTypeCommand != type && NULL != ccData);
+	else
+		ubf_assert	(
+							(
+									cunilogEvtTypeCommand		== type
+								||	cunilogEvtTypeNormalText	== type
+								||	cunilogEvtTypeDeferredFmt	== type
+							)
+						&&	NULL == ccData
+					);
+	ubf_assert			(USE_STRLEN != siz);
+	ubf_assert			(0 <= type);
+	ubf_assert			(cunilogEvtTypeAmountEnumValues > type);
+
+	size_t			wl		= widthOfCaptionLengthFromCunilogEventType (type);
+	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
+	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
 	size_t			ln		= aln + wl + lenCapt + siz;
-	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+	uint64_t		opts;
+	CUNILOG_EVENT	*pev	= AllocCUNILOG_EVENT (put, ln, &opts);
 
 	if (pev)
 	{
@@ -3308,7 +5533,7 @@ static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
 		{
 			FillCUNILOG_EVENT	(
 				pev, put,
-				CUNILOGEVENT_ALLOCATED,
+				opts,
 				0,
 				sev, type,
 				pData, siz, ln
@@ -3317,8 +5542,8 @@ static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
 		{
 			FillCUNILOG_EVENT	(
 				pev, put,
-				CUNILOGEVENT_ALLOCATED,
-				LocalTime_UBF_TIMESTAMP (),
+				opts,
+				cunilogLocalTimestamp (put),
 				sev, type,
 				pData, siz, ln
 								);
@@ -3331,8 +5556,6 @@ static CUNILOG_EVENT *CreateCUNILOG_EVENTandData	(
 		}
 		if (ccData)
 			memcpy (pData, ccData, siz);
-		else
-			ubf_assert (cunilogEvtTypeCommand == type);
 	}
 	return pev;
 }
@@ -3371,7 +5594,8 @@ static CUNILOG_EVENT *CreateCUNILOG_EVENTandDataTS	(
 	ubf_assert (wl || 0 == lenCapt);						// If 0 == wl we can't have a caption.
 	size_t			aln		= ALIGNED_SIZE (sizeof (CUNILOG_EVENT), CUNILOG_DEFAULT_ALIGNMENT);
 	size_t			ln		= aln + wl + lenCapt + siz;
-	CUNILOG_EVENT	*pev	= ubf_malloc (ln);
+	uint64_t		opts;
+	CUNILOG_EVENT	*pev	= AllocCUNILOG_EVENT (put, ln, &opts);
 
 	if (pev)
 	{
@@ -3379,7 +5603,7 @@ static CUNILOG_EVENT *CreateCUNILOG_EVENTandDataTS	(
 		
 		FillCUNILOG_EVENT	(
 			pev, put,
-			CUNILOGEVENT_ALLOCATED,
+			opts,
 			ts,
 			sev, type,
 			pData, siz, ln
@@ -3489,24 +5713,112 @@ CUNILOG_EVENT *CreateCUNILOG_EVENT_TextTS		(
 	return pev;
 }
 
-CUNILOG_EVENT *CreateSUNILOGEVENT_W	(
-					cueventseverity		sev,
-					size_t				lenDataW
-									)
+/*
+	Creates a text event from the format string fmt and its arguments ap. The text
+	is formatted into a stack buffer first. Only if it doesn't fit, vsnprintf () is
+	called a second time to format it straight into the data area of the event. The
+	caller's ap is not consumed.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENT_Textvfmt	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*fmt,
+					va_list						ap
+													)
 {
-	UNREFERENCED_PARAMETER (sev);
-	UNREFERENCED_PARAMETER (lenDataW);
-
-	//return CreateSUNILOGSTRUCT_U8 (evType, lenDataW * sizeof (wchar_t));
-	ubf_assert (false);
-	return NULL;
-}
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (fmt);
 
-CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
-{
-	ubf_assert_non_NULL (pev);
+	char			cb [CUNILOG_DEFAULT_SFMT_SIZE];
+	va_list			aq;
+	int				i;
+	size_t			l;
 
-	size_t size;
+	va_copy (aq, ap);
+	i = vsnprintf (cb, CUNILOG_DEFAULT_SFMT_SIZE, fmt, aq);
+	va_end (aq);
+	if (i < 0)
+		return NULL;
+	l = (size_t) i;
+	if (l < CUNILOG_DEFAULT_SFMT_SIZE)
+		return CreateCUNILOG_EVENT_Text (put, sev, cb, l);
+
+	// One more octet for the NUL terminator vsnprintf () writes.
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, NULL, 0, cunilogEvtTypeNormalText,
+							NULL, l + 1
+													);
+	if (pev)
+	{
+		va_copy (aq, ap);
+		vsnprintf ((char *) pev->szDataToLog, l + 1, fmt, aq);
+		va_end (aq);
+		pev->lenDataToLog = strRemoveLineEndingsFromEnd ((char *) pev->szDataToLog, l);
+	}
+	return pev;
+}
+
+/*
+	Creates an event of type cunilogEvtTypeDeferredFmt. Only the arguments are captured
+	here. The text is rendered when the event line is created, which is on the separate
+	logging thread if the target has one. If the target doesn't have a queue, or if fmt
+	contains a conversion specification that is not supported for deferred formatting,
+	the function falls back to CreateCUNILOG_EVENT_Textvfmt (). The caller's ap is not
+	consumed.
+*/
+static CUNILOG_EVENT *CreateCUNILOG_EVENT_TextDeferredvfmt	(
+					CUNILOG_TARGET				*put,
+					cueventseverity				sev,
+					const char					*fmt,
+					va_list						ap
+															)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (fmt);
+
+	if (!HAS_CUNILOG_TARGET_A_QUEUE (put))
+		return CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+
+	va_list			aq;
+	size_t			siz;
+
+	va_copy (aq, ap);
+	siz = storeDeferredFmtArgs (NULL, fmt, aq);
+	va_end (aq);
+	if (CUNILOG_SIZE_ERROR == siz)
+		return CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENTandData	(
+							put, sev, NULL, 0, cunilogEvtTypeDeferredFmt,
+							NULL, siz
+													);
+	if (pev)
+	{
+		va_copy (aq, ap);
+		storeDeferredFmtArgs (pev->szDataToLog, fmt, aq);
+		va_end (aq);
+	}
+	return pev;
+}
+
+CUNILOG_EVENT *CreateSUNILOGEVENT_W	(
+					cueventseverity		sev,
+					size_t				lenDataW
+									)
+{
+	UNREFERENCED_PARAMETER (sev);
+	UNREFERENCED_PARAMETER (lenDataW);
+
+	//return CreateSUNILOGSTRUCT_U8 (evType, lenDataW * sizeof (wchar_t));
+	ubf_assert (false);
+	return NULL;
+}
+
+CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (pev);
+
+	size_t size;
 
 	if (pev->sizEvent)
 		size = pev->sizEvent;
@@ -3516,6 +5828,15 @@ CUNILOG_EVENT *DuplicateCUNILOG_EVENT (CUNILOG_EVENT *pev)
 	if (pnev)
 	{
 		memcpy (pnev, pev, size);
+		// Data that follows the structure is now part of the copy.
+		if	(
+					pev->szDataToLog >= (unsigned char *) pev
+				&&	pev->szDataToLog < (unsigned char *) pev + size
+			)
+			pnev->szDataToLog = (unsigned char *) pnev + (pev->szDataToLog - (unsigned char *) pev);
+		cunilogClrEventPooled (pnev);
+		cunilogClrEventBatched (pnev);
+		cunilogClrEventDeferred (pnev);
 		cunilogSetEventAllocated (pnev);
 	}
 	return pnev;
@@ -3529,6 +5850,13 @@ CUNILOG_EVENT *DoneCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 		{
 			ubf_free (pev->szDataToLog);
 		}
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			if (cunilogIsEventPooled (pev))
+			{
+				ReturnPooledCUNILOG_EVENT (pev);
+				return NULL;
+			}
+		#endif
 		if (cunilogIsEventAllocated (pev))
 		{
 			ubf_free (pev);
@@ -3749,6 +6077,68 @@ static bool cunilogProcessNoneFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 	}
 #endif
 
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Writes out the echo output of the current batch with a single call. Each line in
+		the buffer is followed by a line ending. The last one is replaced by a NUL
+		terminator because puts () adds it again.
+	*/
+	static void cunilogFlushEchoBatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->lnEchoBatch)
+		{
+			char	*sz	= put->mbEchoBatch.buf.pch;
+			size_t	ln	= put->lnEchoBatch - 1;
+			int		ips;
+
+			sz [ln] = ASCII_NUL;
+			put->lnEchoBatch = 0;
+			#ifdef PLATFORM_IS_WINDOWS
+				ips = cunilogPutsWin (sz, ln);
+			#else
+				ips = puts (sz);
+			#endif
+			if (EOF == ips)
+			{
+				ubf_assert_msg (false, "Error writing to stdout.");
+				SetCunilogSystemError (put, EBADF);
+			}
+		}
+	}
+#else
+	#define cunilogFlushEchoBatch(put)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Appends the event line sz to the echo output of the current batch. The buffer is
+		written out before it grows, which means its content isn't lost if the
+		allocation fails. The function returns false in this case.
+	*/
+	static bool cunilogAppendToEchoBatch (CUNILOG_TARGET *put, const char *sz, size_t ln)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (sz);
+
+		size_t lnNew = put->lnEchoBatch + ln + 1;
+		if (lnNew + 1 > put->mbEchoBatch.size)
+		{
+			cunilogFlushEchoBatch (put);
+			lnNew = ln + 1;
+			growToSizeSMEMBUFreserve (&put->mbEchoBatch, lnNew + 1, put->mbEchoBatch.size);
+			if (!isUsableSMEMBUF (&put->mbEchoBatch))
+				return false;
+		}
+		char *pc = put->mbEchoBatch.buf.pch + put->lnEchoBatch;
+		memcpy (pc, sz, ln);
+		pc [ln] = '\n';
+		put->lnEchoBatch = lnNew;
+		return true;
+	}
+#endif
+
 static bool cunilogProcessEchoFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
 	UNREFERENCED_PARAMETER (cup);
@@ -3776,6 +6166,17 @@ static bool cunilogProcessEchoFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 		lnToOutput = pev->pCUNILOG_TARGET->lnLogEventLine;
 	#endif
 
+	// An event of a batch is echoed together with the others of the batch. Any other
+	//	event must not overtake them.
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if	(
+					cunilogIsEventBatched (pev)
+				&&	cunilogAppendToEchoBatch (pev->pCUNILOG_TARGET, szToOutput, lnToOutput)
+			)
+			return true;
+		cunilogFlushEchoBatch (pev->pCUNILOG_TARGET);
+	#endif
+
 	#ifdef PLATFORM_IS_WINDOWS
 		ips = cunilogPutsWin (szToOutput, lnToOutput);
 	#else
@@ -3837,6 +6238,7 @@ static bool cunilogProcessUpdateLogFileNameFnct (CUNILOG_PROCESSOR *cup, CUNILOG
 		case cunilogPostfixDotNumberWeekly:
 		case cunilogPostfixDotNumberMonthly:
 		case cunilogPostfixDotNumberYearly:
+		case cunilogPostfixDotNumberSize:
 			return true;
 
 		default:
@@ -3853,11 +6255,12 @@ static inline bool cunilogOpenNewLogFile (CUNILOG_TARGET *put)
 	ubf_assert_non_NULL	(put);
 	ubf_assert			(isInitialisedSMEMBUF (&put->mbLogfileName));
 
+	cunilogWriteBehindToLogFileAndWait (put);
 	#ifdef OS_IS_WINDOWS
 		CloseHandle (put->logfile.hLogFile);
 		return cunilogOpenLogFile (put);
 	#else
-		fclose (put->logfile.fLogFile);
+		cunilogCloseLogFile (put);
 		return cunilogOpenLogFile (put);
 	#endif
 }
@@ -3869,6 +6272,8 @@ static inline bool requiresOpenLogFile (CUNILOG_TARGET *put)
 #ifdef OS_IS_WINDOWS
 		return NULL == put->logfile.hLogFile || INVALID_HANDLE_VALUE == put->logfile.hLogFile;
 	#else
+		if (cunilogHasRawLogfile (put))
+			return 0 > put->logfile.fdLogFile;
 		return NULL == put->logfile.fLogFile;
 	#endif
 }
@@ -3915,10 +6320,420 @@ static inline size_t addNewLineToLogEventLine (char *pData, size_t lnData, enum
 	return lnData + len;
 }
 
+/*
+	Writes the n buffers of the array piov points to to the logfile with writev (),
+	carrying on after partial writes and interruptions. The array is modified.
+*/
+#ifndef OS_IS_WINDOWS
+	static bool cunilogWritevToLogFile (CUNILOG_TARGET *put, struct iovec *piov, int n)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (piov);
+
+		if (cunilogHasMappedLogfile (put))
+			return cunilogMappedWritevToLogFile (put, piov, n);
+
+		int				fd		= cunilogLogFileDescriptor (put);
+		ssize_t			w;
+
+		while (n)
+		{
+			w = writev (fd, piov, n);
+			if (w < 0)
+			{
+				if (EINTR == errno)
+					continue;
+				return false;
+			}
+			// Partial write.
+			while (n && (size_t) w >= piov->iov_len)
+			{
+				w -= (ssize_t) piov->iov_len;
+				++ piov;
+				-- n;
+			}
+			if (n)
+			{
+				piov->iov_base	= (char *) piov->iov_base + w;
+				piov->iov_len	-= (size_t) w;
+			}
+		}
+		return true;
+	}
+#endif
+
+/*
+	Writes lnBuf octets of pBuf, usually the write-behind buffer of the target put points
+	to, followed by lnLine octets of pLine, to the logfile. On POSIX both go out with a
+	single writev () call, bypassing the buffer of the C runtime library.
+*/
+static bool cunilogWriteBehindWriteToLogFile	(
+		CUNILOG_TARGET		*put,
+		const char			*pBuf,
+		size_t				lnBuf,
+		const char			*pLine,
+		size_t				lnLine
+												)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef OS_IS_WINDOWS
+		const char	*pc [2]		= {pBuf, pLine};
+		size_t		ln [2]		= {lnBuf, lnLine};
+		DWORD		dwWritten;
+
+		for (unsigned int ui = 0; ui < 2; ++ ui)
+		{
+			while (ln [ui])
+			{
+				DWORD toWrite = ln [ui] > 0x40000000 ? 0x40000000 : (DWORD) ln [ui];
+				if (!WriteFile (put->logfile.hLogFile, pc [ui], toWrite, &dwWritten, NULL))
+					return false;
+				pc [ui] += dwWritten;
+				ln [ui] -= dwWritten;
+			}
+		}
+		return true;
+	#else
+		struct iovec	iov [2];
+		int				n		= 0;
+
+		if (lnBuf)
+		{
+			iov [n].iov_base	= (void *) pBuf;
+			iov [n].iov_len		= lnBuf;
+			++ n;
+		}
+		if (lnLine)
+		{
+			iov [n].iov_base	= (void *) pLine;
+			iov [n].iov_len		= lnLine;
+			++ n;
+		}
+		return cunilogWritevToLogFile (put, iov, n);
+	#endif
+}
+
+static inline bool cunilogSyncLogFile (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifdef OS_IS_WINDOWS
+		return FlushFileBuffers (put->logfile.hLogFile);
+	#else
+		// Earlier chunks are unmapped already and taken care of by fsync ()/fdatasync ().
+		CUNILOG_LOGFILE	*pl		= &put->logfile;
+		if (pl->pMap && msync (pl->pMap, pl->ofsMap, MS_SYNC))
+			return false;
+		#ifdef OS_IS_MACOS
+			return 0 == fsync (cunilogLogFileDescriptor (put));
+		#else
+			return 0 == fdatasync (cunilogLogFileDescriptor (put));
+		#endif
+	#endif
+}
+
+#ifdef CUNILOG_HAVE_IO_URING
+	// The user_data of the submission queue entries.
+	#define CUNILOG_IOURING_WRITE		(1)
+	#define CUNILOG_IOURING_DATASYNC	(2)
+
+	static inline void cunilogIoUringQueue	(
+							CUNILOG_IOURING		*pur,
+							uint8_t				opcode,
+							uint8_t				flags,
+							int					fd,
+							const char			*pData,
+							size_t				lnData
+											)
+	{
+		ubf_assert_non_NULL (pur);
+
+		unsigned int		tail	= *pur->sqTail;
+		unsigned int		idx		= tail & *pur->sqMask;
+		struct io_uring_sqe	*sqe	= &pur->sqes [idx];
+
+		memset (sqe, 0, sizeof (*sqe));
+		sqe->opcode		= opcode;
+		sqe->flags		= flags;
+		sqe->fd			= fd;
+		if (IORING_OP_WRITE == opcode)
+		{	// Anything above the kernel's limit becomes a short write.
+			sqe->addr		= (uint64_t) (uintptr_t) pData;
+			sqe->len		= lnData > 0x7FFFF000 ? 0x7FFFF000 : (uint32_t) lnData;
+			sqe->off		= (uint64_t) -1;			// Current file position.
+			sqe->user_data	= CUNILOG_IOURING_WRITE;
+		} else
+		{
+			sqe->fsync_flags	= IORING_FSYNC_DATASYNC;
+			sqe->user_data		= CUNILOG_IOURING_DATASYNC;
+		}
+		pur->sqArray [idx] = idx;
+		__atomic_store_n (pur->sqTail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	/*
+		Waits for the completion of what has been submitted for the target put points to.
+		The rest of a short write is written synchronously, as is a failed write, and a
+		datasync that has been cancelled because of either. The function returns false if
+		the synchronous write or the datasync failed.
+	*/
+	static bool cunilogIoUringWait (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_IOURING		*pur	= &put->wb.ur;
+		bool				b		= true;
+		bool				bSync	= false;
+		unsigned int		head;
+		struct io_uring_cqe	*cqe;
+		struct iovec		iov;
+
+		while (pur->nInFlight)
+		{
+			head = *pur->cqHead;
+			if (head == __atomic_load_n (pur->cqTail, __ATOMIC_ACQUIRE))
+			{
+				if	(
+							0 > syscall	(
+									__NR_io_uring_enter, pur->fdRing, 0, 1,
+									IORING_ENTER_GETEVENTS, NULL, 0
+										)
+						&&	EINTR != errno
+					)
+				{	// We should never get here.
+					ubf_assert (false);
+					pur->nInFlight = 0;
+					b = false;
+				}
+				continue;
+			}
+			cqe = &pur->cqes [head & *pur->cqMask];
+			if (CUNILOG_IOURING_WRITE == cqe->user_data)
+			{
+				if (0 > cqe->res)
+				{	// Nothing has been written.
+					iov.iov_base	= pur->buf;
+					iov.iov_len		= pur->len;
+					b &= cunilogWritevToLogFile (put, &iov, 1);
+				} else
+				if ((size_t) cqe->res < pur->len)
+				{
+					iov.iov_base	= pur->buf + cqe->res;
+					iov.iov_len		= pur->len - (size_t) cqe->res;
+					b &= cunilogWritevToLogFile (put, &iov, 1);
+				}
+			} else
+			{	// A short write breaks the link to the datasync.
+				if (-ECANCELED == cqe->res)
+					bSync = true;
+				else
+				if (0 > cqe->res)
+					b = false;
+			}
+			__atomic_store_n (pur->cqHead, head + 1, __ATOMIC_RELEASE);
+			-- pur->nInFlight;
+		}
+		pur->len			= 0;
+		pur->bSyncInFlight	= false;
+		if (bSync)
+			b &= cunilogSyncLogFile (put);
+		return b;
+	}
+
+	/*
+		Swaps the write-behind buffer of the target put points to with the io_uring buffer
+		and submits a write of it, linked to a datasync if bSync is true. The function
+		waits for the previous submission first. This keeps the writes in order, and the
+		next batch of event lines is rendered into the other buffer while the kernel is
+		writing this one.
+
+		If the submission fails, the data is written synchronously.
+	*/
+	static bool cunilogIoUringSubmit (CUNILOG_TARGET *put, bool bSync)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+		CUNILOG_IOURING		*pur	= &pwb->ur;
+		bool				b		= cunilogIoUringWait (put);
+		int					fd		= cunilogLogFileDescriptor (put);
+		unsigned int		n		= bSync ? 2 : 1;
+		long				r;
+		char				*pc;
+		struct iovec		iov;
+
+		ubf_assert (pur->siz == pwb->siz);
+		pc					= pur->buf;
+		pur->buf			= pwb->buf;
+		pwb->buf			= pc;
+		pur->len			= pwb->len;
+		pur->bSyncInFlight	= bSync;
+		cunilogIoUringQueue (pur, IORING_OP_WRITE, bSync ? IOSQE_IO_LINK : 0, fd, pur->buf, pur->len);
+		if (bSync)
+			cunilogIoUringQueue (pur, IORING_OP_FSYNC, 0, fd, NULL, 0);
+		do
+		{
+			r = syscall (__NR_io_uring_enter, pur->fdRing, n, 0, 0, NULL, 0);
+		} while (0 > r && EINTR == errno);
+		r = 0 > r ? 0 : r;
+		pur->nInFlight = (unsigned int) r;
+		if ((unsigned int) r < n)
+		{	// Take back what hasn't been submitted and do it ourselves.
+			__atomic_store_n (pur->sqTail, *pur->sqTail - (n - (unsigned int) r), __ATOMIC_RELEASE);
+			if (0 == r)
+			{
+				iov.iov_base	= pur->buf;
+				iov.iov_len		= pur->len;
+				b &= cunilogWritevToLogFile (put, &iov, 1);
+			}
+			b &= cunilogIoUringWait (put);
+			if (bSync)
+				b &= cunilogSyncLogFile (put);
+		}
+		return b;
+	}
+#endif
+
+/*
+	Compresses the octets in the write-behind buffer of the target put points to, followed
+	by lnLine octets of pLine, into a single frame and writes it to the logfile. See
+	ConfigCUNILOG_TARGETcompressedLogfile ().
+*/
+static bool cunilogWriteBehindFrameToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (put->wb.pfr);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	size_t				lnFrame;
+	const char			*pFrame;
+
+	pFrame = ExtCompressFrame (pwb->pfr, pwb->buf, pwb->len, pLine, lnLine, &lnFrame);
+	if (NULL == pFrame)
+		return false;
+	put->logfile.ullSize += lnFrame;
+	return cunilogWriteBehindWriteToLogFile (put, pFrame, lnFrame, NULL, 0);
+}
+
+/*
+	cunilogWriteBehindToLogFile
+
+	Writes the data in the write-behind buffer of the target put points to, followed by
+	the lnLine octets pLine points to, to the logfile, and syncs the logfile if the sync
+	threshold of the target has been reached. The buffer is empty afterwards, even if
+	writing fails, in which case the function returns false.
+*/
+static bool cunilogWriteBehindToLogFile (CUNILOG_TARGET *put, const char *pLine, size_t lnLine)
+{
+	ubf_assert_non_NULL (put);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+	if (0 == pwb->len + lnLine)
+		return true;
+	if (requiresOpenLogFile (put))
+	{
+		pwb->len = 0;
+		return false;
+	}
+	bool b = true;
+	#ifdef CUNILOG_HAVE_IO_URING
+		if (0 <= pwb->ur.fdRing && !cunilogHasMappedLogfile (put) && NULL == pwb->pfr)
+		{
+			if (0 == lnLine)
+			{
+				bool bSync = pwb->nSyncOctets && pwb->nUnsynced + pwb->len >= pwb->nSyncOctets;
+				b = cunilogIoUringSubmit (put, bSync);
+				++ pwb->nWrites;
+				pwb->nUnsynced	= bSync ? 0 : pwb->nUnsynced + pwb->len;
+				pwb->len		= 0;
+				return b;
+			}
+			// Nothing must overtake what is still in flight.
+			b = cunilogIoUringWait (put);
+		}
+	#endif
+	if (pwb->pfr)
+		b &= cunilogWriteBehindFrameToLogFile (put, pLine, lnLine);
+	else
+		b &= cunilogWriteBehindWriteToLogFile (put, pwb->buf, pwb->len, pLine, lnLine);
+	++ pwb->nWrites;
+	pwb->nUnsynced	+= pwb->len + lnLine;
+	pwb->len		= 0;
+	if (b && pwb->nSyncOctets && pwb->nUnsynced >= pwb->nSyncOctets)
+	{
+		b = cunilogSyncLogFile (put);
+		pwb->nUnsynced = 0;
+	}
+	return b;
+}
+
+/*
+	Writes the data in the write-behind buffer of the target put points to to the logfile
+	and, unlike cunilogWriteBehindToLogFile (), only returns when it has been written. This
+	is required before the logfile is closed or the buffer is deallocated.
+*/
+static bool cunilogWriteBehindToLogFileAndWait (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	bool b = cunilogWriteBehindToLogFile (put, NULL, 0);
+	#ifdef CUNILOG_HAVE_IO_URING
+		b &= cunilogIoUringWait (put);
+	#endif
+	return b;
+}
+
+/*
+	Appends the event line to the write-behind buffer. The buffer is written out first if
+	the event line doesn't fit. An event line that is bigger than the entire buffer is
+	written out together with it.
+*/
+static bool cunilogWriteDataToWriteBehind (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (put->wb.buf);
+
+	CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+	char				*pData	= put->mbLogEventLine.buf.pch;
+	size_t				lnData	= put->lnLogEventLine;
+	size_t				lnLine	= addNewLineToLogEventLine (pData, lnData, put->unilogNewLine);
+	bool				b		= true;
+
+	// A compressed logfile grows by its frames.
+	if (NULL == pwb->pfr)
+		put->logfile.ullSize += lnLine;
+	if (pwb->len + lnLine > pwb->siz)
+	{
+		if (lnLine > pwb->siz)
+		{
+			b = cunilogWriteBehindToLogFile (put, pData, lnLine);
+			pData [lnData] = ASCII_NUL;
+			return b;
+		}
+		b = cunilogWriteBehindToLogFile (put, NULL, 0);
+	}
+	if (0 == pwb->len && UINT64_MAX != pwb->ullLatency)
+		pwb->ullFirst = GetSystemTimeAsULONGLONGrel ();
+	memcpy (pwb->buf + pwb->len, pData, lnLine);
+	pwb->len += lnLine;
+	pData [lnData] = ASCII_NUL;
+	if	(
+				UINT64_MAX != pwb->ullLatency
+			&&	GetSystemTimeAsULONGLONGrel () - pwb->ullFirst >= pwb->ullLatency
+		)
+		b &= cunilogWriteBehindToLogFile (put, NULL, 0);
+	return b;
+}
+
 static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
+	if (put->wb.buf)
+		return cunilogWriteDataToWriteBehind (put);
+
 	char				*pData	= put->mbLogEventLine.buf.pch;
 	size_t				lnData	= put->lnLogEventLine;
 	enum enLineEndings	nl		= put->unilogNewLine;
@@ -3926,6 +6741,7 @@ static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
 	#ifdef OS_IS_WINDOWS
 		DWORD dwWritten;
 		DWORD toWrite = addNewLineToLogEventLine (pData, lnData, nl) & 0xFFFFFFFF;
+		put->logfile.ullSize += toWrite;
 		// The file has been opened with FILE_APPEND_DATA, i.e. we don't need to
 		//	seek ourselves.
 		//	LARGE_INTEGER	z = {0, 0};
@@ -3934,7 +6750,19 @@ static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
 		pData [lnData] = ASCII_NUL;
 		return b;
 	#else
+		if (cunilogHasRawLogfile (put))
+		{	// Event line and line ending straight from where they are.
+			struct iovec	iov [2];
+			size_t			lnNL;
+			iov [0].iov_base	= pData;
+			iov [0].iov_len		= lnData;
+			iov [1].iov_base	= (void *) szLineEnding (nl, &lnNL);
+			iov [1].iov_len		= lnNL;
+			put->logfile.ullSize += lnData + lnNL;
+			return cunilogWritevToLogFile (put, iov, 2);
+		}
 		long lToWrite = (long) addNewLineToLogEventLine (pData, lnData, nl);
+		put->logfile.ullSize += (uint64_t) lToWrite;
 		// See https://www.man7.org/linux/man-pages/man3/fopen.3.html .
 		//	A call "fseek (pl->fLogFile, (long) 0, SEEK_END);" is not required
 		//	because we opened the file in append mode.
@@ -3944,6 +6772,8 @@ static bool cunilogWriteDataToLogFile (CUNILOG_TARGET *put)
 	#endif
 }
 
+static void cunilogAddLogfileToFLSindex (CUNILOG_TARGET *put);
+
 static bool cunilogProcessWriteToLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (pev);
@@ -3963,18 +6793,40 @@ static bool cunilogProcessWriteToLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 
 	if (isUsableSMEMBUF (&put->mbLogfileName))
 	{
+		// Without a logfile there's nothing to write to. The next event tries to open it
+		//	again.
 		if (requiresOpenLogFile (put))
 		{
 			if (!cunilogOpenLogFile (put))
+			{
 				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
+				return true;
+			}
+			setLogFileDateTimeStampInUse (put);
+			cunilogAddLogfileToFLSindex (put);
 		} else
 		if (REQUIRES_NEW_LOGFILE (put, cup, pev))
 		{
 			if (!cunilogOpenNewLogFile (put))
+			{
 				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_OPENING_LOGFILE, cup, pev);
+				return true;
+			}
+			setLogFileDateTimeStampInUse (put);
+			cunilogAddLogfileToFLSindex (put);
 		}
 		if (!cunilogWriteDataToLogFile (put))
 				cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_WRITING_LOGFILE, cup, pev);
+		// Rotators triggered by this event see the size that includes it, even if one of
+		//	them renames the active logfile and logs about it before the others run.
+		if (!cunilogHasEventNoRotation (pev))
+		{
+			put->logfile.ullSizePrv		=		put->logfile.bSizeUnseen
+										?	0
+										:	put->logfile.ullSizeEvt;
+			put->logfile.ullSizeEvt		= put->logfile.ullSize;
+			put->logfile.bSizeUnseen	= false;
+		}
 	}
 	return true;
 }
@@ -3989,11 +6841,13 @@ static bool cunilogProcessFlushLogFileFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVEN
 	if (cunilogHasDontWriteToLogfile (put))
 		return true;
 
+	// The write-behind buffer has its own schedule and is not written out here.
 	#ifdef OS_IS_WINDOWS
 		if (!FlushFileBuffers (put->logfile.hLogFile))
 			cunilogSetTargetErrorAndInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
 	#else
-		if (0 != fflush (put->logfile.fLogFile))
+		// A raw logfile has no buffer that could be flushed.
+		if (!cunilogHasRawLogfile (put) && 0 != fflush (put->logfile.fLogFile))
 			cunilogInvokeErrorCallback (CUNILOG_ERROR_FLUSHING_LOGFILE, cup, pev);
 	#endif
 	return true;
@@ -4021,14 +6875,14 @@ static bool enqueueAndTriggerSeparateLoggingThread (CUNILOG_EVENT *pev);
 	#define DecrementPendingNoRotationEvents(put)
 #endif
 
-static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt, ...)
+static bool logFromInsideRotatorTextU8vfmt (CUNILOG_TARGET *put, const char *fmt, va_list ap)
 {
 	ubf_assert_non_NULL (put);
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
 
-	va_list		ap;
+	va_list		cp;
 	size_t		len;
 	bool		bRet = false;
 
@@ -4053,23 +6907,18 @@ static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt,
 	*/
 	ubf_assert (put != prd->plogCUNILOG_TARGET);
 	if (prd->plogCUNILOG_TARGET && put != prd->plogCUNILOG_TARGET)
-	{
-		va_start (ap, fmt);
-		bRet = logTextU8vfmt (put, fmt, ap);
-		va_end (ap);
-		return bRet;
-	}
+		return logTextU8vfmt (put, fmt, ap);
 
-	va_start (ap, fmt);
-	len = (size_t) vsnprintf (NULL, 0, fmt, ap);
-	va_end (ap);
+	va_copy (cp, ap);
+	len = (size_t) vsnprintf (NULL, 0, fmt, cp);
+	va_end (cp);
 
 	char *szTxtToLog = ubf_malloc (len + 1);
 	if (szTxtToLog)
 	{
-		va_start (ap, fmt);
-		vsnprintf (szTxtToLog, len + 1, fmt, ap);
-		va_end (ap);
+		va_copy (cp, ap);
+		vsnprintf (szTxtToLog, len + 1, fmt, cp);
+		va_end (cp);
 
 		CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, szTxtToLog, len);
 		ubf_assert_non_NULL (pev);
@@ -4092,6 +6941,19 @@ static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt,
 	return bRet;
 }
 
+static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	va_list		ap;
+	bool		bRet;
+
+	va_start (ap, fmt);
+	bRet = logFromInsideRotatorTextU8vfmt (put, fmt, ap);
+	va_end (ap);
+	return bRet;
+}
+
 #ifdef OS_IS_WINDOWS
 	static DWORD GetTextForLastError (char *szErrMsg)
 	{
@@ -4107,9 +6969,10 @@ static bool logFromInsideRotatorTextU8fmt (CUNILOG_TARGET *put, const char *fmt,
 	{
 		ubf_assert_non_NULL (szErrMsg);
 
-		char szErr [] = "\"Not implemented\"";
-		memcpy (szErrMsg, szErr, sizeof (szErr));
-		return -1;
+		// Note that we expect a buffer of CUNILOG_STD_MSG_SIZE octets.
+		int iError = errno;
+		snprintf (szErrMsg, CUNILOG_STD_MSG_SIZE, "%d (%s)", iError, strerror (iError));
+		return iError;
 	}
 #endif
 
@@ -4190,6 +7053,7 @@ static inline void renameDotNumberPostfixInFLS (CUNILOG_TARGET *put, size_t nLen
 	{
 		char	*sz	= put->fls.data [prg->idx].chFilename;
 		size_t	ln	= put->fls.data [prg->idx].stFilename - oLen + nLen;
+		put->stFLSorphaned += put->fls.data [prg->idx].stFilename;
 		put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, ln);
 		char *szFls = put->fls.data [prg->idx].chFilename;
 		if (NULL == szFls)
@@ -4215,6 +7079,21 @@ static inline void renameDotNumberPostfixInFLS (CUNILOG_TARGET *put, size_t nLen
 	memcpy (szDst, ccSrc, nLen);
 }
 
+/*
+	Removes the entry at index idx from our files list (FLS) after its file has been
+	deleted or moved out of the logging folder.
+*/
+static inline void removeFromFLS (CUNILOG_TARGET *put, size_t idx)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
+
+	put->stFLSorphaned += put->fls.data [idx].stFilename;
+	vec_splice (&put->fls, idx, 1);
+}
+
+static void insertIntoFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName);
+
 /*
 	Renames the LogPostfix file in our files list (FLS) to keep the files list in sync
 	with the real directory on disk.
@@ -4230,6 +7109,15 @@ static inline void renameLogPostfixInFLS (CUNILOG_TARGET *put, const char *szNew
 	CUNILOG_ROTATOR_ARGS	*prg	= put->prargs;
 	size_t					siz		= lnNew + 1;
 
+	if (cunilogTargetHasFLSindexBuilt (put))
+	{	// If the active logfile is rotated twice within the same period, the rename
+		//	replaces the file rotated first. Inserting the new name instead of
+		//	overwriting the entry keeps the files list index sorted and unique.
+		removeFromFLS (put, prg->idx);
+		insertIntoFLSindex (put, szNew, siz);
+		return;
+	}
+	put->stFLSorphaned += put->fls.data [prg->idx].stFilename;
 	put->fls.data [prg->idx].chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, siz);
 	if (put->fls.data [prg->idx].chFilename)
 	{
@@ -4242,6 +7130,47 @@ static inline void renameLogPostfixInFLS (CUNILOG_TARGET *put, const char *szNew
 	put->fls.data [prg->idx].stFilename = 0;
 }
 
+/*
+	The size and last write time of a new files list entry are obtained when a retention
+	policy needs them. See isLogfileBeyondRetention ().
+*/
+static inline void initCUNILOG_FLSattributes (CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL (pfls);
+
+	pfls->ullSize		= CUNILOG_FLS_UNKNOWN;
+	pfls->ullModified	= CUNILOG_FLS_UNKNOWN;
+}
+
+/*
+	Replaces the name of the entry at index idx of our files list (FLS) with the name of
+	the file its logfile is compressed into with the compressor cmp, so that subsequent
+	rotators, like the ones that delete logfiles, work on the compressed file. Since the
+	extension is appended, the entry keeps its position in the sorted list and the index.
+*/
+static void extCompressedInFLS (CUNILOG_TARGET *put, size_t idx, enextcompressor cmp)
+{
+	ubf_assert_non_NULL	(put);
+	ubf_assert			(idx < put->fls.length);
+
+	CUNILOG_FLS	*pfls	= &put->fls.data [idx];
+	size_t		lnExt;
+	const char	*ccExt	= ExtCompressorFileExtension (cmp, &lnExt);
+	char		*szName	= GetAlignedMemFromSBULKMEMgrow (&put->sbm, pfls->stFilename + lnExt);
+
+	if (NULL == szName)
+	{	// The compressed file is picked up when the folder is read again.
+		removeFromFLS (put, idx);
+		return;
+	}
+	memcpy (szName, pfls->chFilename, pfls->stFilename - 1);
+	memcpy (szName + pfls->stFilename - 1, ccExt, lnExt + 1);
+	put->stFLSorphaned += pfls->stFilename;
+	pfls->chFilename	= szName;
+	pfls->stFilename	+= lnExt;
+	initCUNILOG_FLSattributes (pfls);
+}
+
 /*
 	The next rotator would have to read the directory listing from disk again,
 	but we may not have logfile.log again yet, if no event has been written to it,
@@ -4266,6 +7195,7 @@ static inline void cunilogAddActiveLogfile (bool bIsActiveLogfile, bool i, CUNIL
 	if (bIsActiveLogfile)
 	{
 		CUNILOG_FLS	currFls;
+		initCUNILOG_FLSattributes (&currFls);
 		currFls.stFilename = put->lnAppName + sizCunilogLogFileNameExtension;
 		currFls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, currFls.stFilename);
 		if (currFls.chFilename)
@@ -4309,7 +7239,8 @@ static inline bool prepareDotNumberPostfixFileToRename	(
 	// Either ".log.<number>" orr "g" from ".log".
 	ubf_assert ('.' == sz [0] || 'g' == sz [0]);
 	bIsActiveLogfile = 'g' == sz [0];
-	*poldLength = put->stFilToRotate - 1 - ln;
+	// The dot number part of the active logfile is appended after the "g" of ".log".
+	*poldLength = bIsActiveLogfile ? 0 : put->stFilToRotate - 1 - ln;
 	*pnewLength = incrementDotNumberName (sz);
 	return bIsActiveLogfile;
 }
@@ -4356,6 +7287,45 @@ static inline bool prepareLogPostfixFileToRename	(
 	return true;
 }
 
+/*
+	Moves/renames the file mbFilToRotate to prd->mbDstFile. Both reside in the logging
+	folder. On POSIX, the move is carried out with renameat () relative to the directory
+	file descriptor of the logging folder, which only requires the names of the files.
+*/
+static inline bool cunilogMoveFileToRotate (CUNILOG_TARGET *put, CUNILOG_ROTATION_DATA *prd)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (prd);
+
+	#ifdef PLATFORM_IS_WINDOWS
+		return MoveFileU8long (put->mbFilToRotate.buf.pch, prd->mbDstFile.buf.pcc);
+	#else
+		ubf_assert (!memcmp (put->mbFilToRotate.buf.pcc, put->mbLogPath.buf.pcc, put->lnLogPath));
+		ubf_assert (!memcmp (prd->mbDstFile.buf.pcc, put->mbLogPath.buf.pcc, put->lnLogPath));
+
+		int fd = cunilogLogFoldFD (put);
+		if (-1 == fd)
+			return false;
+		int i = renameat	(
+					fd, put->mbFilToRotate.buf.pcc + put->lnLogPath,
+					fd, prd->mbDstFile.buf.pcc + put->lnLogPath
+							);
+		if (-1 == i && ENOENT == errno)
+		{	// The logging folder might have been deleted and created again since we
+			//	opened it. Its directory fd then still refers to the deleted folder.
+			DoneCUNILOG_TARGETfdLogFold (put);
+			fd = cunilogLogFoldFD (put);
+			if (-1 == fd)
+				return false;
+			i = renameat	(
+					fd, put->mbFilToRotate.buf.pcc + put->lnLogPath,
+					fd, prd->mbDstFile.buf.pcc + put->lnLogPath
+							);
+		}
+		return 0 == i;
+	#endif
+}
+
 static void cunilogRenameLogfile (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL	(put);
@@ -4404,87 +7374,220 @@ static void cunilogRenameLogfile (CUNILOG_TARGET *put)
 			return;
 		}
 
-		bool bMoved;
+		if (bIsActiveLogfile)
+			cunilogCloseCUNILOG_LOGFILEifOpen (put);
+		bool bMoved = cunilogMoveFileToRotate (put, prd);
 
+		// Obtain the error before reopening the logfile can overwrite it.
+		char szErr [CUNILOG_STD_MSG_SIZE];
 		#ifdef PLATFORM_IS_WINDOWS
-			if (bIsActiveLogfile)
-				cunilogCloseCUNILOG_LOGFILEifOpen (put);
-			bMoved = MoveFileU8long (put->mbFilToRotate.buf.pch, prd->mbDstFile.buf.pcc);
-			if (bIsActiveLogfile && requiresOpenLogFile (put))
+			DWORD	sysErr	= bMoved ? ERROR_SUCCESS : GetTextForLastError (szErr);
+		#else
+			int		sysErr	= bMoved ? 0 : GetTextForLastError (szErr);
+		#endif
+		if (bIsActiveLogfile && requiresOpenLogFile (put))
+		{
+			if (!cunilogOpenLogFile (put))
 			{
-				if (!cunilogOpenLogFile (put))
-				{
-					SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
-					cunilogSetTargetErrorAndInvokeErrorCallback	(
-						CUNILOG_ERROR_OPENING_LOGFILE,
-						put->prargs->cup, put->prargs->pev
-																);
-				}
+				SetCunilogSystemError (put, CUNILOG_ERROR_OPENING_LOGFILE);
+				cunilogSetTargetErrorAndInvokeErrorCallback	(
+					CUNILOG_ERROR_OPENING_LOGFILE,
+					put->prargs->cup, put->prargs->pev
+															);
 			}
-			if (bMoved)
+		}
+		if (bMoved)
+		{
+			if (hasDotNumberPostfix (put))
 			{
-				if (hasDotNumberPostfix (put))
-				{
-					renameDotNumberPostfixInFLS (put, newLen, oldLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, false, put);
-				} else
-				if (hasLogPostfix (put))
-				{
-					renameLogPostfixInFLS (put, szNewFileName, newLen);
-					cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
-				}
-				logFromInsideRotatorTextU8fmt	(
-					put, "File \"%s\" moved/renamed to \"%s\".",
-					put->mbFilToRotate.buf.pcc,
-					prd->mbDstFile.buf.pcc
-												);
+				renameDotNumberPostfixInFLS (put, newLen, oldLen);
+				cunilogAddActiveLogfile (bIsActiveLogfile, false, put);
 			} else
+			if (hasLogPostfix (put))
 			{
-				char szErr [CUNILOG_STD_MSG_SIZE];
-				DWORD dwErr = GetTextForLastError (szErr);
-
-				logFromInsideRotatorTextU8fmt	(
-					put,
-					"Error %s while attempting to move file \"%s\" to \"%s\".",
-					szErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
-												);
-				SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, dwErr);
+				renameLogPostfixInFLS (put, szNewFileName, newLen);
+				cunilogAddActiveLogfile (bIsActiveLogfile, true, put);
 			}
-		#else
-			bMoved = false;
-		#endif
+			logFromInsideRotatorTextU8fmt	(
+				put, "File \"%s\" moved/renamed to \"%s\".",
+				put->mbFilToRotate.buf.pcc,
+				prd->mbDstFile.buf.pcc
+											);
+		} else
+		{
+			logFromInsideRotatorTextU8fmt	(
+				put,
+				"Error %s while attempting to move file \"%s\" to \"%s\".",
+				szErr, put->mbFilToRotate.buf.pcc, prd->mbDstFile.buf.pcc
+											);
+			SetCunilogError (put, CUNILOG_ERROR_RENAMING_LOGFILE, sysErr);
+		}
+	}
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Adds a message of job pj to the messages of the maintenance thread of the target
+		put points to. The messages are logged, and obtain their timestamps, by the thread
+		that processes the events of the target. See cunilogLogMaintenanceMessages ().
+	*/
+	static bool logFromMaintenanceThreadTextU8vfmt	(
+					CUNILOG_TARGET		*put,
+					CUNILOG_MAINTJOB	*pj,
+					const char			*fmt,
+					va_list				ap
+													)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (put->pmt);
+		ubf_assert_non_NULL (pj);
+
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		va_list				cp;
+		int					iLen;
+
+		va_copy (cp, ap);
+		iLen = vsnprintf (NULL, 0, fmt, cp);
+		va_end (cp);
+		if (iLen < 0)
+			return false;
+
+		CUNILOG_MAINTMSG *pm = ubf_malloc (sizeof (CUNILOG_MAINTMSG) + (size_t) iLen + 1);
+		if (NULL == pm)
+			return false;
+		pm->next				= NULL;
+		pm->plogCUNILOG_TARGET	= pj->plogCUNILOG_TARGET;
+		pm->szMsg				= (char *) (pm + 1);
+		pm->lnMsg				= (size_t) iLen;
+		va_copy (cp, ap);
+		vsnprintf (pm->szMsg, (size_t) iLen + 1, fmt, cp);
+		va_end (cp);
+
+		EnterLocker (&pmt->cl);
+		if (pmt->lastMsg)
+			pmt->lastMsg->next = pm;
+		else
+			pmt->firstMsg = pm;
+		pmt->lastMsg = pm;
+		cunilogAtomicAddSize (&pmt->nMsgs, 1);
+		LeaveLocker (&pmt->cl);
+		return true;
 	}
+#endif
+
+/*
+	Logs a message of a rotation task. The task is either carried out by the rotator
+	itself, in which case pj is NULL, or by the maintenance thread for job pj.
+*/
+static bool logRotationTextU8fmt (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	va_list		ap;
+	bool		bRet;
+
+	va_start (ap, fmt);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			bRet = logFromMaintenanceThreadTextU8vfmt (put, pj, fmt, ap);
+		else
+	#else
+		UNUSED (pj);
+	#endif
+			bRet = logFromInsideRotatorTextU8vfmt (put, fmt, ap);
+	va_end (ap);
+	return bRet;
+}
+
+static inline const char *fileToRotate (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			return pj->szFile;
+	#else
+		UNUSED (pj);
+	#endif
+	return put->mbFilToRotate.buf.pcc;
+}
+
+/*
+	Called when the logfile to rotate has been moved to the recycle bin or deleted. The
+	logfile of a job of the maintenance thread has been removed from the files list
+	already when the job was queued.
+*/
+static inline void removeRotatedFromFLS (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+
+	if (NULL == pj)
+		removeFromFLS (put, put->prargs->idx);
+}
+
+/*
+	Called when the logfile to rotate could not be moved to the recycle bin or deleted.
+*/
+static inline void keepRotatedInFLS (CUNILOG_MAINTJOB *pj)
+{
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			pj->bFailed = true;
+	#else
+		UNUSED (pj);
+	#endif
+}
+
+static inline uint64_t rotatorFlags (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			return pj->uiFlgs;
+	#else
+		UNUSED (pj);
+	#endif
+	ubf_assert_non_NULL (put->prargs);
+	CUNILOG_ROTATION_DATA *prd = put->prargs->cup->pData;
+	return prd->uiFlgs;
+}
+
+static inline enextcompressor rotatorCompressor (uint64_t uiFlgs)
+{
+	return uiFlgs & CUNILOG_ROTATOR_FLAG_ZSTD ? extcompressor_zstd : extcompressor_gzip;
 }
 
-static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
+static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 {
 	ubf_assert_non_NULL (put);
 
 	bool b;
 	char szErr [CUNILOG_STD_MSG_SIZE];
+	const char *szFile = fileToRotate (put, pj);
 	
-	enfilecompressresult	cmprRes = IsFileCompressedByName (put->mbFilToRotate.buf.pch);
+	enfilecompressresult	cmprRes = IsFileCompressedByName (szFile);
 	switch (cmprRes)
 	{
 		case fscompress_uncompressed:
-			logFromInsideRotatorTextU8fmt	(
-				put, "Initiating file system compression for file \"%s\"...",
-				put->mbFilToRotate.buf.pcc
-											);
-			b = FScompressFileByName (put->mbFilToRotate.buf.pcc);
+			logRotationTextU8fmt	(
+				put, pj, "Initiating file system compression for file \"%s\"...",
+				szFile
+									);
+			b = FScompressFileByName (szFile);
 			if (b)
 			{
-				logFromInsideRotatorTextU8fmt	(
-					put, "File system compression for file \"%s\" initiated.",
-				put->mbFilToRotate.buf.pcc
-												);
+				logRotationTextU8fmt	(
+					put, pj, "File system compression for file \"%s\" initiated.",
+					szFile
+										);
 			} else
 			{
 				GetTextForLastError (szErr);
-				logFromInsideRotatorTextU8fmt	(
-					put,
+				logRotationTextU8fmt	(
+					put, pj,
 					"Error %s while attempting to initiate file system compression for file \"%s\".",
-					szErr, put->mbFilToRotate.buf.pcc
+					szErr, szFile
 										);
 			}
 			break;
@@ -4492,10 +7595,10 @@ static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
 			break;
 		case fscompress_error:
 			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt	(
-				put,
+			logRotationTextU8fmt	(
+				put, pj,
 				"Error %s while attempting to check file system compression for file \"%s\".",
-				szErr, put->mbFilToRotate.buf.pcc
+				szErr, szFile
 									);
 			break;
 	}
@@ -4503,31 +7606,32 @@ static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
 
 #if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
 
-	static void MoveFileToRecycleBinWin (CUNILOG_TARGET *put)
+	static void MoveFileToRecycleBinWin (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
 
-		logFromInsideRotatorTextU8fmt	(
-			put, "Moving obsolete logfile \"%s\" to recycle bin...", put->mbFilToRotate.buf.pcc
-										);
-		bool b = MoveToRecycleBinU8 (put->mbFilToRotate.buf.pcc);
+		const char *szFile = fileToRotate (put, pj);
+
+		logRotationTextU8fmt	(
+			put, pj, "Moving obsolete logfile \"%s\" to recycle bin...", szFile
+								);
+		bool b = MoveToRecycleBinU8 (szFile);
 		if (b)
 		{
-			logFromInsideRotatorTextU8fmt	(
-				put, "Obsolete logfile \"%s\" moved to recycle bin.", put->mbFilToRotate.buf.pcc
-											);
-			vec_splice (&put->fls, put->prargs->idx, 1);
+			logRotationTextU8fmt	(
+				put, pj, "Obsolete logfile \"%s\" moved to recycle bin.", szFile
+									);
+			removeRotatedFromFLS (put, pj);
 		} else
 		{
 			char szErr [CUNILOG_STD_MSG_SIZE];
 			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt	(
-				put,
-				"Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.", szErr, put->mbFilToRotate.buf.pcc
-											);
+			logRotationTextU8fmt	(
+				put, pj,
+				"Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.", szErr, szFile
+									);
+			keepRotatedInFLS (pj);
 		}
 	}
 
@@ -4536,44 +7640,46 @@ static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
 	#include "./../OS/Apple/TrashCan.h"
 
 	// Our wrapper.
-	static void MoveFileToRecycleBinMac (CUNILOG_TARGET *put)
+	static void MoveFileToRecycleBinMac (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
 
-		logFromInsideRotatorTextU8fmt (put, "Moving obsolete logfile \"%s\" to recycle bin...\n", put->mbFilToRotate.buf.pcc);
-		if (LIBTRASHCAN_SUCCESS == trashcan_soft_delete_apple (put->mbFilToRotate.buf.pcc))
+		const char *szFile = fileToRotate (put, pj);
+
+		logRotationTextU8fmt (put, pj, "Moving obsolete logfile \"%s\" to recycle bin...\n", szFile);
+		if (LIBTRASHCAN_SUCCESS == trashcan_soft_delete_apple (szFile))
 		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" moved to recycle bin.\n", put->mbFilToRotate.buf.pcc);
-			vec_splice (&put->fls, put->prargs->idx, 1);
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" moved to recycle bin.\n", szFile);
+			removeRotatedFromFLS (put, pj);
 		} else
 		{
-			logFromInsideRotatorTextU8fmt (put, "Error while attempting to move obsolete logfile \"%s\" to recycle bin.\n", put->mbFilToRotate.buf.pcc);
+			logRotationTextU8fmt (put, pj, "Error while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szFile);
+			keepRotatedInFLS (pj);
 		}
 	}
 
 #elif defined (OS_IS_LINUX)
 
-	static void MoveFileToRecycleBinLnx (CUNILOG_TARGET *put)
+	static void MoveFileToRecycleBinLnx (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+		const char *szFile = fileToRotate (put, pj);
 
-		logFromInsideRotatorTextU8fmt (put, "Moving obsolete logfile \"%s\" to recycle bin...\n", put->mbFilToRotate.buf.pcc);
-		bool b = MoveFileToTrashPOSIX (put->mbFilToRotate.buf.pcc);
+		logRotationTextU8fmt (put, pj, "Moving obsolete logfile \"%s\" to recycle bin...\n", szFile);
+		bool b = MoveFileToTrashPOSIX (szFile);
 		if (b)
 		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" moved to recycle bin.\n", put->mbFilToRotate.buf.pcc);
-			vec_splice (&put->fls, put->prargs->idx, 1);
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" moved to recycle bin.\n", szFile);
+			removeRotatedFromFLS (put, pj);
 		} else
 		{
 			char szErr [CUNILOG_STD_MSG_SIZE];
 			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt (put, "Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szErr, put->mbFilToRotate.buf.pcc);
+			logRotationTextU8fmt (put, pj, "Error %s while attempting to move obsolete logfile \"%s\" to recycle bin.\n", szErr, szFile);
+			keepRotatedInFLS (pj);
 		}
 	}
 
@@ -4586,64 +7692,220 @@ static void cunilogFileSystemCompressLogfile (CUNILOG_TARGET *put)
 /*
 	Platform-independent wrapper function.
 */
-static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put)
+static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 {
 	ubf_assert_non_NULL (put);
 
 	#if defined (OS_IS_WINDOWS) && defined (HAVE_SHELLAPI)
-		MoveFileToRecycleBinWin (put);
+		MoveFileToRecycleBinWin (put, pj);
 	#elif defined (OS_IS_MACOS)
-		MoveFileToRecycleBinMac (put);
+		MoveFileToRecycleBinMac (put, pj);
 	#elif defined (OS_IS_LINUX)
-		MoveFileToRecycleBinLnx (put);
+		MoveFileToRecycleBinLnx (put, pj);
 	#else
 		#error Not implemented yet!
 	#endif
 }
 
 #ifdef PLATFORM_IS_WINDOWS
-	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put)
+	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+		const char *szFile = fileToRotate (put, pj);
 	
-		logFromInsideRotatorTextU8fmt (put, "Deleting obsolete logfile \"%s\"...\n", put->mbFilToRotate.buf.pch);
-		bool b = DeleteFileU8 (put->mbFilToRotate.buf.pch);
+		logRotationTextU8fmt (put, pj, "Deleting obsolete logfile \"%s\"...\n", szFile);
+		bool b = DeleteFileU8 (szFile);
 		if (b)
 		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" deleted.\n", put->mbFilToRotate.buf.pch);
-			vec_splice (&put->fls, put->prargs->idx, 1);
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" deleted.\n", szFile);
+			removeRotatedFromFLS (put, pj);
 		} else
 		{
 			char szErr [CUNILOG_STD_MSG_SIZE];
 			GetTextForLastError (szErr);
-			logFromInsideRotatorTextU8fmt (put, "Error %s while attempting to delete obsolete logfile \"%s\".\n", szErr, put->mbFilToRotate.buf.pch);
+			logRotationTextU8fmt (put, pj, "Error %s while attempting to delete obsolete logfile \"%s\".\n", szErr, szFile);
+			keepRotatedInFLS (pj);
 		}
 	}
 #endif
 
 #ifdef PLATFORM_IS_POSIX
-	static void DeleteObsoleteLogfile (CUNILOG_TARGET *put)
+	static void cunilogDeleteObsoleteLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert_non_NULL	(put->prargs);
-		ubf_assert_non_NULL	(put->prargs->cup);
-		ubf_assert_non_NULL	(put->prargs->cup->pData);
+		ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+		const char *szFile = fileToRotate (put, pj);
 	
-		logFromInsideRotatorTextU8fmt (put, "Deleting obsolete logfile \"%s\"...\n", put->mbFilToRotate.buf.pch);
-		int i = unlink (put->mbFilToRotate.buf.pch);
+		logRotationTextU8fmt (put, pj, "Deleting obsolete logfile \"%s\"...\n", szFile);
+		int i = unlink (szFile);
 		if (0 == i)
 		{
-			logFromInsideRotatorTextU8fmt (put, "Obsolete logfile \"%s\" deleted.\n", put->mbFilToRotate.buf.pch);
+			logRotationTextU8fmt (put, pj, "Obsolete logfile \"%s\" deleted.\n", szFile);
+			removeRotatedFromFLS (put, pj);
 		} else
 		{
-			logFromInsideRotatorTextU8fmt (put, "Error %d while attempting to delete obsolete logfile \"%s\".\n", errno, put->mbFilToRotate.buf.pch);
+			logRotationTextU8fmt (put, pj, "Error %d while attempting to delete obsolete logfile \"%s\".\n", errno, szFile);
+			keepRotatedInFLS (pj);
+		}
+	}
+#endif
+
+/*
+	Returns the length of the extension of an external compressor the file name szName
+	with length ln ends with, for instance 3 for ".gz", or 0 if it doesn't end with one.
+*/
+static size_t lenExtCompressorExtensionOfName (const char *szName, size_t ln)
+{
+	ubf_assert_non_NULL (szName);
+
+	int		i;
+	size_t	lnExt;
+
+	for (i = 0; i < extcompressor_XAmountEnumValues; ++ i)
+	{
+		const char *ccExt = ExtCompressorFileExtension ((enextcompressor) i, &lnExt);
+		if (lnExt < ln && !memcmp (szName + ln - lnExt, ccExt, lnExt))
+			return lnExt;
+	}
+	return 0;
+}
+
+static inline bool isActiveLogfileToRotate (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	return		isUsableSMEMBUF (&put->mbLogfileName)
+			&&	!strcmp (put->mbFilToRotate.buf.pcc, put->mbLogfileName.buf.pcc);
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static size_t	stCompressionPrio			= CUNILOG_DEFAULT_COMPRESSION_PRIORITY;
+	static size_t	stMaxParallelCompressions	= CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS;
+	static size_t	stParallelCompressions;
+
+	bool cunilogSetCompressionLimits (cunilogprio prio, unsigned int nMaxParallel)
+	{
+		ubf_assert	(0 <= prio);
+		ubf_assert	(prio < cunilogPrioAmountEnumValues);
+
+		if (0 <= prio && prio < cunilogPrioAmountEnumValues)
+		{
+			cunilogAtomicXchgSize (&stCompressionPrio, (size_t) prio);
+			cunilogAtomicXchgSize (&stMaxParallelCompressions, nMaxParallel);
+			return true;
+		}
+		return false;
+	}
+
+	/*
+		Called by the maintenance thread before it compresses a logfile. Waits until
+		less than stMaxParallelCompressions logfiles are compressed within the process.
+	*/
+	static void enterCompressionSlot (CUNILOG_MAINTENANCE *pmt)
+	{
+		ubf_assert_non_NULL (pmt);
+
+		cunilogprio prio = (cunilogprio) cunilogAtomicLoadSize (&stCompressionPrio);
+		if ((int) prio != pmt->iPrio)
+		{
+			CunilogChangeCurrentThreadPriority (prio);
+			pmt->iPrio = prio;
+		}
+
+		size_t n;
+		for (;;)
+		{
+			n = cunilogAtomicLoadSize (&stMaxParallelCompressions);
+			if (cunilogAtomicAddSize (&stParallelCompressions, 1) < n || 0 == n)
+				return;
+			cunilogAtomicSubSize (&stParallelCompressions, 1);
+			Sleep_ms (10);
 		}
 	}
+
+	static inline void leaveCompressionSlot (void)
+	{
+		cunilogAtomicSubSize (&stParallelCompressions, 1);
+	}
 #endif
 
+/*
+	Compresses the logfile to rotate into a new file with the extension of the compressor
+	appended and deletes it afterwards.
+*/
+static void cunilogExtCompressLogfile (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (pj || (put->prargs && put->prargs->cup && put->prargs->cup->pData));
+
+	const char		*szFile	= fileToRotate (put, pj);
+	enextcompressor	cmp		= rotatorCompressor (rotatorFlags (put, pj));
+	size_t			lnFile	= strlen (szFile);
+	size_t			lnExt;
+	const char		*ccExt	= ExtCompressorFileExtension (cmp, &lnExt);
+	char			szErr [CUNILOG_STD_MSG_SIZE];
+	bool			b;
+
+	char *szDst = ubf_malloc (lnFile + lnExt + 1);
+	if (NULL == szDst)
+	{
+		if (NULL == pj)
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+		keepRotatedInFLS (pj);
+		return;
+	}
+	memcpy (szDst, szFile, lnFile);
+	memcpy (szDst + lnFile, ccExt, lnExt + 1);
+
+	logRotationTextU8fmt (put, pj, "Compressing logfile \"%s\" into \"%s\"...", szFile, szDst);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			enterCompressionSlot (put->pmt);
+	#endif
+	b = ExtCompressFileByName (szFile, szDst, cmp, EXT_COMPRESSOR_DEFAULT_LEVEL);
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (pj)
+			leaveCompressionSlot ();
+	#endif
+	if (b)
+	{
+		#ifdef PLATFORM_IS_WINDOWS
+			b = DeleteFileU8 (szFile);
+		#else
+			b = 0 == unlink (szFile);
+		#endif
+		if (b)
+		{
+			logRotationTextU8fmt (put, pj, "Logfile \"%s\" compressed into \"%s\".", szFile, szDst);
+			// The entry of a job has been updated when the job was queued.
+			if (NULL == pj)
+				extCompressedInFLS (put, put->prargs->idx, cmp);
+		} else
+		{
+			GetTextForLastError (szErr);
+			logRotationTextU8fmt	(
+				put, pj,
+				"Error %s while attempting to delete logfile \"%s\" after compressing it.",
+				szErr, szFile
+									);
+			keepRotatedInFLS (pj);
+		}
+	} else
+	{
+		GetTextForLastError (szErr);
+		logRotationTextU8fmt	(
+			put, pj,
+			"Error %s while attempting to compress logfile \"%s\" into \"%s\".",
+			szErr, szFile, szDst
+								);
+		keepRotatedInFLS (pj);
+	}
+	ubf_free (szDst);
+}
+
 #ifdef CUNILOG_BUILD_DEBUG_OUTPUT_FILES_LIST
 	static void DebugOutputFilesList (const char *szText, vec_cunilog_fls *pvec)
 	{
@@ -4667,12 +7929,454 @@ static inline void cunilogMoveFileToRecycleBin (CUNILOG_TARGET *put)
 	#define DebugOutputFilesList(text, pvec)
 #endif
 
-static inline void performActualRotation (CUNILOG_ROTATOR_ARGS *prg)
-{
-	ubf_assert_non_NULL (prg);
-
-	CUNILOG_PROCESSOR		*cup = prg->cup;
-	ubf_assert_non_NULL (cup);
+/*
+	The maintenance thread.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the task of the current rotator over to the maintenance thread of the target
+		put points to. The function returns false if the target doesn't have a maintenance
+		thread or the job couldn't be created, in which case the rotator carries out the
+		task itself.
+
+		A logfile that is moved to the recycle bin or deleted is removed from the files
+		list straight away. A logfile that is compressed by a rotator with the task
+		cunilogrotationtask_ExtCompressLogfiles gets the name of its compressed file in the
+		list straight away. If the maintenance thread fails to remove or compress it later,
+		it asks for the files list to be rebuilt. See updateFLSindex ().
+	*/
+	static bool queueCUNILOG_MAINTJOB (CUNILOG_TARGET *put, CUNILOG_ROTATOR_ARGS *prg)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (prg);
+
+		CUNILOG_ROTATION_DATA	*prd	= prg->cup->pData;
+		ubf_assert_non_NULL (prd);
+
+		// Compressing a logfile takes too long for the thread that processes the events.
+		if (NULL == put->pmt && cunilogrotationtask_ExtCompressLogfiles == prd->tsk)
+			ConfigCUNILOG_TARGETmaintenanceThread (put);
+
+		CUNILOG_MAINTENANCE		*pmt	= put->pmt;
+		if (NULL == pmt || !isUsableSMEMBUF (&put->mbFilToRotate))
+			return false;
+		const char				*szFile	= put->mbFilToRotate.buf.pcc;
+		size_t					stFile	= put->stFilToRotate;
+		CUNILOG_MAINTJOB		*pj;
+		bool					bQueued	= false;
+
+		EnterLocker (&pmt->cl);
+		// A logfile that is still waiting for the same task isn't queued again. This can
+		//	happen if the folder is read again before the maintenance thread got to it.
+		for (pj = pmt->firstJob; pj; pj = pj->next)
+		{
+			if (prd->tsk == pj->tsk && stFile == pj->stFile && !memcmp (szFile, pj->szFile, stFile))
+				break;
+		}
+		if (NULL == pj)
+		{
+			pj = ubf_malloc (sizeof (CUNILOG_MAINTJOB) + stFile);
+			if (NULL == pj)
+			{
+				LeaveLocker (&pmt->cl);
+				return false;
+			}
+			pj->next				= NULL;
+			pj->tsk					= prd->tsk;
+			pj->plogCUNILOG_TARGET	= prd->plogCUNILOG_TARGET;
+			pj->uiFlgs				= prd->uiFlgs;
+			pj->szFile				= (char *) (pj + 1);
+			memcpy (pj->szFile, szFile, stFile);
+			pj->stFile				= stFile;
+			pj->bFailed				= false;
+			if (pmt->lastJob)
+				pmt->lastJob->next = pj;
+			else
+				pmt->firstJob = pj;
+			pmt->lastJob = pj;
+			bQueued = true;
+		}
+		LeaveLocker (&pmt->cl);
+
+		if (bQueued)
+		{
+			#ifdef OS_IS_WINDOWS
+				bool b = ReleaseSemaphore (pmt->sm.hSemaphore, 1, NULL);
+				ubf_assert_true (b);
+				UNUSED (b);
+			#else
+				int i = sem_post (&pmt->sm.tSemaphore);
+				ubf_assert_0 (i);
+				UNUSED (i);
+			#endif
+		}
+		if (cunilogrotationtask_ExtCompressLogfiles == prd->tsk)
+			extCompressedInFLS (put, prg->idx, rotatorCompressor (prd->uiFlgs));
+		else
+		if (cunilogrotationtask_FScompressLogfiles != prd->tsk)
+			removeFromFLS (put, prg->idx);
+		return true;
+	}
+#else
+	#define queueCUNILOG_MAINTJOB(put, prg)	\
+		(false)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void runCUNILOG_MAINTJOB (CUNILOG_TARGET *put, CUNILOG_MAINTJOB *pj)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pj);
+
+		switch (pj->tsk)
+		{
+			case cunilogrotationtask_FScompressLogfiles:
+				cunilogFileSystemCompressLogfile (put, pj);
+				break;
+			case cunilogrotationtask_MoveToRecycleBinLogfiles:
+				cunilogMoveFileToRecycleBin (put, pj);
+				break;
+			case cunilogrotationtask_DeleteLogfiles:
+				cunilogDeleteObsoleteLogfile (put, pj);
+				break;
+			case cunilogrotationtask_ExtCompressLogfiles:
+				cunilogExtCompressLogfile (put, pj);
+				break;
+			default:
+				ubf_assert_msg (false, "Internal error");
+				break;
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	SEPARATE_LOGGING_THREAD_RETURN_TYPE MaintenanceThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (put->pmt);
+
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTJOB	*pj;
+		bool				bStop;
+
+		// The semaphore is posted once for each job and once to stop. Since jobs are
+		//	only removed when they're done, all of them are done before we leave.
+		for (;;)
+		{
+			#ifdef OS_IS_WINDOWS
+				DWORD dw = WaitForSingleObject (pmt->sm.hSemaphore, INFINITE);
+				ubf_assert (WAIT_OBJECT_0 == dw);
+				UNUSED (dw);
+			#else
+				int i = sem_wait (&pmt->sm.tSemaphore);
+				if (0 != i)
+					continue;
+			#endif
+			EnterLocker (&pmt->cl);
+			pj		= pmt->firstJob;
+			bStop	= pmt->bStop;
+			LeaveLocker (&pmt->cl);
+			if (NULL == pj)
+			{
+				if (bStop)
+					break;
+				continue;
+			}
+			runCUNILOG_MAINTJOB (put, pj);
+			EnterLocker (&pmt->cl);
+			++ pmt->nJobsDone;
+			pmt->firstJob = pj->next;
+			if (NULL == pmt->firstJob)
+			{
+				pmt->lastJob = NULL;
+				if (pmt->bIdleWait)
+				{
+					pmt->bIdleWait = false;
+					#ifdef OS_IS_WINDOWS
+						ReleaseSemaphore (pmt->smIdle.hSemaphore, 1, NULL);
+					#else
+						sem_post (&pmt->smIdle.tSemaphore);
+					#endif
+				}
+			}
+			LeaveLocker (&pmt->cl);
+			if (pj->bFailed)
+				cunilogAtomicAddSize (&pmt->nResync, 1);
+			ubf_free (pj);
+		}
+		return SEPARATE_LOGGING_THREAD_RETURN_SUCCESS;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Logs the messages the maintenance thread has created so far. Called by the
+		thread that processes the events of the target put points to.
+	*/
+	static void cunilogLogMaintenanceMessages (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTMSG	*pm;
+		CUNILOG_MAINTMSG	*pnx;
+
+		if (NULL == pmt || 0 == cunilogAtomicLoadSize (&pmt->nMsgs))
+			return;
+		EnterLocker (&pmt->cl);
+		pm				= pmt->firstMsg;
+		pmt->firstMsg	= NULL;
+		pmt->lastMsg	= NULL;
+		cunilogAtomicXchgSize (&pmt->nMsgs, 0);
+		LeaveLocker (&pmt->cl);
+
+		while (pm)
+		{
+			pnx = pm->next;
+			if (pm->plogCUNILOG_TARGET)
+			{
+				logTextU8sevl	(
+					pm->plogCUNILOG_TARGET, cunilogEvtSeverityNone,
+					pm->szMsg, pm->lnMsg
+								);
+			} else
+			{	// Like logFromInsideRotatorTextU8fmt () but we're the thread that
+				//	processes the events already.
+				CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text	(
+										put, cunilogEvtSeverityNone,
+										pm->szMsg, pm->lnMsg
+															);
+				if (pev)
+				{
+					cunilogSetEventInternal		(pev);
+					cunilogSetEventNoRotation	(pev);
+					IncrementPendingNoRotationEvents (put);
+					cunilogProcessEventSingleThreaded (pev);
+					DoneCUNILOG_EVENT (put, pev);
+				}
+			}
+			ubf_free (pm);
+			pm = pnx;
+		}
+	}
+#else
+	#define cunilogLogMaintenanceMessages(put)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Waits until the maintenance thread of the target put points to has done all its
+		jobs and logs their messages. Renaming dot number logfiles changes the names of
+		all logfiles, including the ones jobs might still refer to.
+	*/
+	static void WaitForMaintenanceJobs (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		bool				bWait;
+
+		if (NULL == pmt)
+			return;
+		EnterLocker (&pmt->cl);
+		bWait = NULL != pmt->firstJob;
+		if (bWait)
+			pmt->bIdleWait = true;
+		LeaveLocker (&pmt->cl);
+		if (bWait)
+		{
+			#ifdef OS_IS_WINDOWS
+				DWORD dw = WaitForSingleObject (pmt->smIdle.hSemaphore, INFINITE);
+				ubf_assert (WAIT_OBJECT_0 == dw);
+				UNUSED (dw);
+			#else
+				while (0 != sem_wait (&pmt->smIdle.tSemaphore) && EINTR == errno)
+					;
+			#endif
+		}
+		cunilogLogMaintenanceMessages (put);
+	}
+#else
+	#define WaitForMaintenanceJobs(put)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void JoinMaintenanceThread (CUNILOG_MAINTENANCE *pmt)
+	{
+		ubf_assert_non_NULL (pmt);
+
+		if (pmt->bStopped)
+			return;
+		EnterLocker (&pmt->cl);
+		pmt->bStop = true;
+		LeaveLocker (&pmt->cl);
+		#ifdef OS_IS_WINDOWS
+			bool b = ReleaseSemaphore (pmt->sm.hSemaphore, 1, NULL);
+			ubf_assert_true (b);
+			UNUSED (b);
+			DWORD dw = WaitForSingleObject (pmt->th.hThread, INFINITE);
+			ubf_assert (WAIT_OBJECT_0 == dw);
+			UNUSED (dw);
+			CloseHandle (pmt->th.hThread);
+		#else
+			int i = sem_post (&pmt->sm.tSemaphore);
+			ubf_assert_0 (i);
+			void *threadRetValue;
+			i = pthread_join (pmt->th.tThread, &threadRetValue);
+			ubf_assert_0 (i);
+			UNUSED (threadRetValue);
+			UNUSED (i);
+		#endif
+		pmt->bStopped = true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Waits for the maintenance thread to finish its jobs and logs their remaining
+		messages. Called by the thread that processes the events of the target when the
+		target is shut down.
+	*/
+	static void StopMaintenanceThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->pmt)
+		{
+			JoinMaintenanceThread (put->pmt);
+			cunilogLogMaintenanceMessages (put);
+		}
+	}
+#else
+	#define StopMaintenanceThread(put)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DestroyCUNILOG_MAINTENANCE (CUNILOG_MAINTENANCE *pmt)
+	{
+		ubf_assert_non_NULL (pmt);
+
+		#ifdef OS_IS_WINDOWS
+			CloseHandle (pmt->sm.hSemaphore);
+			CloseHandle (pmt->smIdle.hSemaphore);
+		#else
+			sem_destroy (&pmt->sm.tSemaphore);
+			sem_destroy (&pmt->smIdle.tSemaphore);
+		#endif
+		DoneLocker (&pmt->cl);
+		ubf_free (pmt);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when the target is destroyed. Messages that haven't been logged because
+		the target hasn't been shut down are discarded.
+	*/
+	static void DoneCUNILOG_TARGETmaintenance (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_MAINTENANCE	*pmt	= put->pmt;
+		CUNILOG_MAINTMSG	*pm;
+		CUNILOG_MAINTMSG	*pnx;
+
+		if (pmt)
+		{
+			JoinMaintenanceThread (pmt);
+			pm = pmt->firstMsg;
+			while (pm)
+			{
+				pnx = pm->next;
+				ubf_free (pm);
+				pm = pnx;
+			}
+			DestroyCUNILOG_MAINTENANCE (pmt);
+			put->pmt = NULL;
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETmaintenanceThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_NULL (put->pmt);
+
+		if (put->pmt)
+			return true;
+
+		CUNILOG_MAINTENANCE *pmt = ubf_malloc (sizeof (CUNILOG_MAINTENANCE));
+		if (NULL == pmt)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+		pmt->firstJob	= NULL;
+		pmt->lastJob	= NULL;
+		pmt->firstMsg	= NULL;
+		pmt->lastMsg	= NULL;
+		pmt->nMsgs		= 0;
+		pmt->nJobsDone	= 0;
+		pmt->nResync	= 0;
+		pmt->iPrio		= cunilogPrioNormal;
+		pmt->bIdleWait	= false;
+		pmt->bStop		= false;
+		pmt->bStopped	= false;
+		#ifdef OS_IS_WINDOWS
+			pmt->sm.hSemaphore		= CreateSemaphoreW (NULL, 0, MAXLONG, NULL);
+			pmt->smIdle.hSemaphore	= CreateSemaphoreW (NULL, 0, 1, NULL);
+			if (NULL == pmt->sm.hSemaphore || NULL == pmt->smIdle.hSemaphore)
+			{
+				if (pmt->sm.hSemaphore)
+					CloseHandle (pmt->sm.hSemaphore);
+				if (pmt->smIdle.hSemaphore)
+					CloseHandle (pmt->smIdle.hSemaphore);
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+		#else
+			if (0 != sem_init (&pmt->sm.tSemaphore, 0, 0))
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+			if (0 != sem_init (&pmt->smIdle.tSemaphore, 0, 0))
+			{
+				sem_destroy (&pmt->sm.tSemaphore);
+				SetCunilogSystemError (put, CUNILOG_ERROR_SEMAPHORE);
+				ubf_free (pmt);
+				return false;
+			}
+		#endif
+		InitLocker (&pmt->cl);
+
+		// The thread expects its structure in the target.
+		put->pmt = pmt;
+		#ifdef OS_IS_WINDOWS
+			pmt->th.hThread = CreateThread (NULL, 0, MaintenanceThread, put, 0, NULL);
+			if (NULL == pmt->th.hThread)
+		#else
+			if (0 != pthread_create (&pmt->th.tThread, NULL, (void * (*)(void *)) MaintenanceThread, put))
+		#endif
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_MAINTENANCE_THREAD);
+			put->pmt = NULL;
+			DestroyCUNILOG_MAINTENANCE (pmt);
+			return false;
+		}
+		return true;
+	}
+#endif
+
+static inline void performActualRotation (CUNILOG_ROTATOR_ARGS *prg)
+{
+	ubf_assert_non_NULL (prg);
+
+	CUNILOG_PROCESSOR		*cup = prg->cup;
+	ubf_assert_non_NULL (cup);
 	CUNILOG_ROTATION_DATA	*prd = cup->pData;
 	ubf_assert_non_NULL (prd);
 	CUNILOG_EVENT			*pev = prg->pev;
@@ -4691,16 +8395,30 @@ static inline void performActualRotation (CUNILOG_ROTATOR_ARGS *prg)
 			ubf_assert (false);
 			break;
 		case cunilogrotationtask_RenameLogfiles:
+			// Renaming includes the active logfile. It's never handed over.
 			cunilogRenameLogfile (put);
 			break;
 		case cunilogrotationtask_FScompressLogfiles:
-			cunilogFileSystemCompressLogfile (put);
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogFileSystemCompressLogfile (put, NULL);
 			break;
 		case cunilogrotationtask_MoveToRecycleBinLogfiles:
-			cunilogMoveFileToRecycleBin (put);
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogMoveFileToRecycleBin (put, NULL);
 			break;
 		case cunilogrotationtask_DeleteLogfiles:
-			cunilogDeleteObsoleteLogfile (put);
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogDeleteObsoleteLogfile (put, NULL);
+			break;
+		case cunilogrotationtask_ExtCompressLogfiles:
+			// The active logfile is still written to.
+			if (isActiveLogfileToRotate (put))
+				break;
+			// Compressed by an earlier run already.
+			if (lenExtCompressorExtensionOfName (prg->nam, prg->siz - 1))
+				break;
+			if (!queueCUNILOG_MAINTJOB (put, prg))
+				cunilogExtCompressLogfile (put, NULL);
 			break;
 	}
 
@@ -4882,6 +8600,87 @@ static inline void sortLogfilesList (CUNILOG_TARGET *put, CUNILOG_PROCESSOR *cup
 	*/
 }
 
+/*
+	Obtains the size and the last write time of the logfile in the files list entry pfls
+	from the file system. On Windows, mbFilToRotate must contain the full path of the
+	logfile. The members stay CUNILOG_FLS_UNKNOWN if the logfile doesn't exist anymore.
+*/
+static inline void obtainCUNILOG_FLSattributes (CUNILOG_TARGET *put, CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pfls);
+
+	#ifdef PLATFORM_IS_WINDOWS
+		HANDLE	h	= CreateFileU8	(
+						put->mbFilToRotate.buf.pcc, FILE_READ_ATTRIBUTES,
+						FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+									);
+		if (INVALID_HANDLE_VALUE == h)
+			return;
+		LARGE_INTEGER	li;
+		FILETIME		ft;
+		if (GetFileSizeEx (h, &li) && GetFileTime (h, NULL, NULL, &ft))
+		{
+			pfls->ullSize		= (uint64_t) li.QuadPart;
+			pfls->ullModified	= ULONGLONGfromFILETIME (ft);
+		}
+		CloseHandle (h);
+	#else
+		struct stat	st;
+		int			fd	= cunilogLogFoldFD (put);
+		if (-1 == fd || fstatat (fd, pfls->chFilename, &st, 0))
+			return;
+		pfls->ullSize		= (uint64_t) st.st_size;
+		#ifdef OS_IS_MACOS
+			pfls->ullModified	= ULONGLONG_from_timespec (&st.st_mtimespec);
+		#else
+			pfls->ullModified	= ULONGLONG_from_timespec (&st.st_mtim);
+		#endif
+	#endif
+}
+
+/*
+	Returns true if the logfile at index idx of the files list is to be rotated because of
+	the retention policy of the rotator prd. The files are expected to be checked from the
+	newest to the oldest one. *pullTotal receives the total size of all files checked so
+	far, including the one at idx. The active logfile is never rotated.
+*/
+static bool isLogfileBeyondRetention	(
+				CUNILOG_TARGET				*put,
+				CUNILOG_ROTATION_DATA		*prd,
+				size_t						idx,
+				uint64_t					ullNow,
+				uint64_t					*pullTotal
+										)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (prd);
+	ubf_assert (idx < put->fls.length);
+	ubf_assert_non_NULL (pullTotal);
+
+	CUNILOG_FLS	*pfls	= &put->fls.data [idx];
+
+	prepareU8fullFileNameToRotate (put, idx);
+	if (isActiveLogfileToRotate (put))
+	{	// Its entry may be older than the last event written to it. The attributes are
+		//	obtained again once it isn't the active logfile anymore.
+		initCUNILOG_FLSattributes (pfls);
+		*pullTotal += put->logfile.ullSize;
+		return false;
+	}
+	if (CUNILOG_FLS_UNKNOWN == pfls->ullSize)
+		obtainCUNILOG_FLSattributes (put, pfls);
+	if (CUNILOG_FLS_UNKNOWN == pfls->ullSize)
+		return false;
+	*pullTotal += pfls->ullSize;
+	if (prd->ullKeepOctets && *pullTotal > prd->ullKeepOctets)
+		return true;
+	return		prd->ullKeepSeconds
+			&&	ullNow > pfls->ullModified
+			&&	ullNow - pfls->ullModified > prd->ullKeepSeconds * FT_SECOND;
+}
+
 static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 {
 	ubf_assert_non_NULL (prg);
@@ -4916,15 +8715,42 @@ static void prapareLogfilesListAndRotate (CUNILOG_ROTATOR_ARGS *prg)
 	DebugOutputFilesList ("List out", &put->fls);
 
 	size_t iFiles = put->fls.length;
+
+	// A retention policy can rotate files the rotator would otherwise ignore.
+	bool		bRetain		= cunilogHasRotatorRetention (prd);
+	uint64_t	ullNow		= prd->ullKeepSeconds ? GetSystemTimeAsULONGLONG () : 0;
+	uint64_t	ullTotal	= 0;
+	uint64_t	nRotated	= 0;
+
+	// The files to ignore come first. Skip them in one go.
+	if (!bRetain && prd->nCnt < nToIgnore)
+	{
+		uint64_t nSkip = nToIgnore - prd->nCnt;
+		nSkip = nSkip < iFiles ? nSkip : iFiles;
+		prd->nCnt						+= nSkip;
+		put->scuNPI.nIgnoredTotal		+= nSkip;
+		iFiles							-= (size_t) nSkip;
+	}
 	while (iFiles --)
 	{
 		ubf_assert (iFiles < put->fls.length);
 		//puts (put->fls.data [iFiles].chFilename);
 		++ prd->nCnt;
-		if (prd->nCnt > nToIgnore)
+		bool bRotate =		prd->nCnt > nToIgnore
+						||	(
+									bRetain
+								&&	isLogfileBeyondRetention (put, prd, iFiles, ullNow, &ullTotal)
+							);
+		if (bRotate)
 		{
-			if (prd->nCnt <= nMaxToRot)
+			if (bRetain && prd->nRetainBatch && nRotated == prd->nRetainBatch)
+			{	// The remaining files are rotated with the next event.
+				optCunProcSetOPT_CUNPROC_AT_STARTUP (prg->cup->uiOpts);
+				break;
+			}
+			if (prd->nCnt <= nMaxToRot || prd->nCnt <= nToIgnore)
 			{
+				++ nRotated;
 				/*
 				DebugOutputFilesList ("List", &put->fls);
 				puts ("File:");
@@ -4985,6 +8811,27 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 	return false;
 }
 
+/*
+	Returns true if the file name szName with length ln, which matches the search mask of
+	the target put points to, is a logfile, or a logfile that has been compressed by a
+	rotator with the task cunilogrotationtask_ExtCompressLogfiles. Other files the wildcard
+	at the end of the search mask picks up are not part of the files list. See
+	createLogfilesSearchMask ().
+*/
+static inline bool isLogfileOrExtCompressedName (CUNILOG_TARGET *put, const char *szName, size_t ln)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (szName);
+
+	if (hasDotNumberPostfix (put))
+		return true;
+	// Everything in front of the wildcard matches the same number of characters.
+	if (ln + 1 < put->lnLogFileMask)
+		return false;
+	size_t lnTail = ln + 1 - put->lnLogFileMask;
+	return 0 == lnTail || lnTail == lenExtCompressorExtensionOfName (szName, ln);
+}
+
 #if defined (PLATFORM_IS_WINDOWS)
 	static bool obtainLogfilesListToRotateCallbackWin (SRDIRONEENTRYSTRUCT *psdE)
 	{
@@ -4993,10 +8840,23 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 		ubf_assert_non_NULL (put);
 
 		CUNILOG_FLS	fls;
-		fls.stFilename = psdE->stFileNameU8;
-		fls.chFilename = psdE->szFileNameU8;
+		fls.stFilename	= psdE->stFileNameU8;
+		fls.chFilename	= psdE->szFileNameU8;
+		// Comes with the directory listing anyway.
+		fls.ullSize		=		((uint64_t) psdE->pwfd->nFileSizeHigh << 32)
+							|	psdE->pwfd->nFileSizeLow;
+		fls.ullModified	= ULONGLONGfromFILETIME (psdE->pwfd->ftLastWriteTime);
 		if (hasDotNumberPostfix (put) && !endsLogFileNameWithDotNumber (&fls))
 			return true;
+		if (!isLogfileOrExtCompressedName (put, fls.chFilename, fls.stFilename - 1))
+			return true;
+		// The active logfile is still growing. Its attributes are obtained once it has
+		//	been rotated. See isLogfileBeyondRetention ().
+		if	(
+					isUsableSMEMBUF (&put->mbLogfileName)
+				&&	!strcmp (fls.chFilename, put->mbLogfileName.buf.pcc + put->lnLogPath)
+			)
+			initCUNILOG_FLSattributes (&fls);
 
 		fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
 		ubf_assert_non_NULL (fls.chFilename);
@@ -5020,12 +8880,14 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 		ubf_assert_non_NULL (put);
 
 		CUNILOG_FLS fls;
+		initCUNILOG_FLSattributes (&fls);
 		fls.stFilename = strlen (pod->dirEnt->d_name) + 1;
 		if	(
-				globMatch	(
-					pod->dirEnt->d_name, fls.stFilename - 1,
-					put->mbLogFileMask.buf.pcc, put->lnLogFileMask
-							)
+					matchWildcardPattern	(
+						pod->dirEnt->d_name, fls.stFilename - 1,
+						put->mbLogFileMask.buf.pcc, put->lnLogFileMask
+											)
+				&&	isLogfileOrExtCompressedName (put, pod->dirEnt->d_name, fls.stFilename - 1)
 			)
 		{
 			fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, fls.stFilename);
@@ -5084,17 +8946,323 @@ static inline bool endsLogFileNameWithDotNumber (CUNILOG_FLS *pfls)
 	}
 #endif
 
-static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
+static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
 {
 	ubf_assert_non_NULL (put);
 
-	if (0 == put->fls.length)
-	{
-		#if defined (PLATFORM_IS_WINDOWS)
-			obtainLogfilesListToRotateWin (put);
+	vec_clear (&put->fls);
+	EmptySBULKMEM (&put->sbm);
+	put->stFLSorphaned = 0;
+	cunilogTargetClrFLSisSorted (put);
+	cunilogTargetClrFLSindexBuilt (put);
+}
+
+/*
+	Compare function for vec_sort () for the files list index of a target with a dot
+	number postfix. Unlike flscmp_dotnum (), names the dot number comparison considers
+	equal are ordered alphabetically, and identical names are supported, which makes the
+	order suitable for a binary search.
+*/
+static int flscmp_dotnum_index (const void *p1, const void *p2)
+{
+	const CUNILOG_FLS	*fls1 = p1;
+	const CUNILOG_FLS	*fls2 = p2;
+
+	if	(
+				fls1->stFilename == fls2->stFilename
+			&&	!memcmp (fls1->chFilename, fls2->chFilename, fls1->stFilename)
+		)
+		return 0;
+	int r = flscmp_dotnum (p1, p2);
+	return r ? r : flscmp_default (p1, p2);
+}
+
+/*
+	Compares two entries of the files list index in the order of the index, which is
+	the reverse order if the files list has been reversed.
+*/
+static inline int cmpFLSindex (CUNILOG_TARGET *put, const CUNILOG_FLS *fls1, const CUNILOG_FLS *fls2)
+{
+	ubf_assert_non_NULL (put);
+
+	int r = hasDotNumberPostfix (put) ? flscmp_dotnum_index (fls1, fls2) : flscmp_default (fls1, fls2);
+	return cunilogTargetHasFLSreversed (put) ? -r : r;
+}
+
+/*
+	Returns true if pfls is the current/active logfile "<appname>.log" of a target with a
+	.log postfix. The search mask doesn't pick it up, and it is always the last element
+	of the files list.
+*/
+static inline bool isActiveLogPostfixFLS (CUNILOG_TARGET *put, CUNILOG_FLS *pfls)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (pfls);
+
+	return		pfls->stFilename == put->lnAppName + sizCunilogLogFileNameExtension
+			&&	!memcmp (pfls->chFilename, put->mbAppName.buf.pcc, put->lnAppName)
+			&&	!memcmp	(
+					pfls->chFilename + put->lnAppName, szCunilogLogFileNameExtension,
+					sizCunilogLogFileNameExtension
+						);
+}
+
+/*
+	Binary search for the file name szName with size stName, which includes the NUL
+	terminator, in the files list index. If the function returns true, *pidx receives
+	the index of the entry. If it returns false, *pidx receives the index the entry
+	would have to be inserted at.
+*/
+static bool findInFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName, size_t *pidx)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_non_NULL (szName);
+	ubf_assert_non_0	(stName);
+	ubf_assert_non_NULL (pidx);
+
+	CUNILOG_FLS	fls;
+	fls.chFilename	= (char *) szName;
+	fls.stFilename	= stName;
+
+	size_t lo = 0;
+	size_t hi = put->fls.length;
+	if (hasLogPostfix (put) && hi && isActiveLogPostfixFLS (put, &put->fls.data [hi - 1]))
+		-- hi;
+	while (lo < hi)
+	{
+		size_t	mi	= lo + (hi - lo) / 2;
+		int		r	= cmpFLSindex (put, &put->fls.data [mi], &fls);
+		if (0 == r)
+		{
+			*pidx = mi;
+			return true;
+		}
+		if (r < 0)
+			lo = mi + 1;
+		else
+			hi = mi;
+	}
+	*pidx = lo;
+	return false;
+}
+
+static void insertIntoFLSindex (CUNILOG_TARGET *put, const char *szName, size_t stName)
+{
+	ubf_assert_non_NULL (put);
+
+	size_t idx;
+	if (findInFLSindex (put, szName, stName, &idx))
+		return;
+
+	CUNILOG_FLS	fls;
+	initCUNILOG_FLSattributes (&fls);
+	fls.stFilename = stName;
+	fls.chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, stName);
+	if (fls.chFilename)
+	{
+		memcpy (fls.chFilename, szName, stName);
+		if (0 == vec_insert (&put->fls, idx, fls))
+			return;
+	}
+	SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+}
+
+/*
+	Adds the current/active logfile to the files list index after it has been opened,
+	unless the index doesn't exist yet or already contains it.
+*/
+static void cunilogAddLogfileToFLSindex (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (!cunilogTargetHasFLSindexBuilt (put))
+		return;
+
+	if (hasLogPostfix (put))
+	{
+		size_t n = put->fls.length;
+		if (0 == n || !isActiveLogPostfixFLS (put, &put->fls.data [n - 1]))
+			cunilogAddActiveLogfile (true, true, put);
+		return;
+	}
+	const char *szName = put->mbLogfileName.buf.pcc + put->lnLogPath;
+	insertIntoFLSindex (put, szName, strlen (szName) + 1);
+}
+
+/*
+	Copies the file names of the files list index into fresh bulk memory. Renaming and
+	removing entries leaves their previous names behind in the bulk memory, which would
+	otherwise grow for as long as the target exists.
+*/
+static void compactFLSindex (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	size_t	stTotal	= 0;
+	size_t	i;
+
+	for (i = 0; i < put->fls.length; ++ i)
+		stTotal += put->fls.data [i].stFilename;
+	char *szNames = ubf_malloc (stTotal + 1);
+	if (NULL == szNames)
+		return;
+
+	char *sz = szNames;
+	for (i = 0; i < put->fls.length; ++ i)
+	{
+		memcpy (sz, put->fls.data [i].chFilename, put->fls.data [i].stFilename);
+		sz += put->fls.data [i].stFilename;
+	}
+	EmptySBULKMEM (&put->sbm);
+	put->stFLSorphaned = 0;
+	sz = szNames;
+	for (i = 0; i < put->fls.length; ++ i)
+	{
+		CUNILOG_FLS *pfls = &put->fls.data [i];
+		pfls->chFilename = GetAlignedMemFromSBULKMEMgrow (&put->sbm, pfls->stFilename);
+		if (NULL == pfls->chFilename)
+		{	// The index is built again from disk.
+			cunilogResetFilesList (put);
+			break;
+		}
+		memcpy (pfls->chFilename, sz, pfls->stFilename);
+		sz += pfls->stFilename;
+	}
+	ubf_free (szNames);
+}
+
+#ifdef CUNILOG_HAVE_INOTIFY
+
+	// The changes to the logging folder the files list index is interested in.
+	#define CUNILOG_FLS_WATCH_MASK								\
+		(IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO	\
+		| IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+	#ifndef CUNILOG_FLS_WATCH_BUF_SIZE
+	#define CUNILOG_FLS_WATCH_BUF_SIZE		(4096)
+	#endif
+
+	/*
+		Brings the entry for the file szName of the logging folder in the files list index
+		in line with the folder. Whether the file exists is checked instead of relying on
+		the type of the notification. This makes it irrelevant if the change has already
+		been applied by cunilog itself, or if the file has been changed again since.
+	*/
+	static void updateFLSindexEntry (CUNILOG_TARGET *put, const char *szName)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (szName);
+
+		size_t ln = strlen (szName);
+		if (!matchWildcardPattern (szName, ln, put->mbLogFileMask.buf.pcc, put->lnLogFileMask))
+			return;
+		if (!isLogfileOrExtCompressedName (put, szName, ln))
+			return;
+
+		struct stat	st;
+		size_t		idx;
+		int			fd			= cunilogLogFoldFD (put);
+		bool		bExists		= -1 != fd && 0 == fstatat (fd, szName, &st, AT_SYMLINK_NOFOLLOW);
+		if (bExists)
+			insertIntoFLSindex (put, szName, ln + 1);
+		else
+		if (findInFLSindex (put, szName, ln + 1, &idx))
+			removeFromFLS (put, idx);
+	}
+
+	/*
+		Applies the pending inotify notifications to the files list index. If the kernel
+		dropped notifications or the logging folder itself has been moved or deleted, the
+		index is discarded to be built again from disk. In the latter case, the folder is
+		not watched anymore.
+	*/
+	static void applyFLSwatchEvents (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (-1 != put->fdFLSwatch);
+
+		union
+		{
+			struct inotify_event	ev;
+			char					buf [CUNILOG_FLS_WATCH_BUF_SIZE];
+		} u;
+		bool	bResync		= false;
+		bool	bUnwatch	= false;
+		ssize_t	r;
+
+		while (0 < (r = read (put->fdFLSwatch, u.buf, sizeof (u.buf))))
+		{
+			const char *p = u.buf;
+			while (p < u.buf + r)
+			{
+				const struct inotify_event *pev = (const struct inotify_event *) p;
+				p += sizeof (struct inotify_event) + pev->len;
+
+				if (pev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+					bUnwatch = true;
+				if (pev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_Q_OVERFLOW))
+					bResync = true;
+				else
+				if (pev->len && !bResync)
+					updateFLSindexEntry (put, pev->name);
+			}
+		}
+		if (bUnwatch)
+			DoneCUNILOG_TARGETflsWatch (put);
+		if (bResync)
+			cunilogResetFilesList (put);
+	}
+#endif
+
+/*
+	Brings the files list index up to date before a rotator uses it.
+*/
+static inline void updateFLSindex (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (!cunilogTargetHasFLSindexBuilt (put))
+		return;
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (put->pmt && cunilogAtomicXchgSize (&put->pmt->nResync, 0))
+		{	// The maintenance thread couldn't remove a logfile that isn't in the
+			//	index anymore.
+			cunilogResetFilesList (put);
+			return;
+		}
+	#endif
+	#ifdef CUNILOG_HAVE_INOTIFY
+		if (-1 != put->fdFLSwatch)
+			applyFLSwatchEvents (put);
+	#endif
+	if (cunilogTargetHasFLSindexBuilt (put) && CUNILOG_STD_BULK_ALLOC_SIZE < put->stFLSorphaned)
+		compactFLSindex (put);
+}
+
+static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasFLSindex (put))
+		updateFLSindex (put);
+	if (0 == put->fls.length && !cunilogTargetHasFLSindexBuilt (put))
+	{
+		// The folder only shows the results of earlier jobs once they're done.
+		WaitForMaintenanceJobs (put);
+		#if defined (PLATFORM_IS_WINDOWS)
+			obtainLogfilesListToRotateWin (put);
 		#elif defined (PLATFORM_IS_POSIX)
 			obtainLogfilesListToRotatePsx (put);
 		#endif
+		if (cunilogTargetHasFLSindex (put))
+		{	// The index is kept sorted from now on, independent of the file system.
+			if (hasDotNumberPostfix (put))
+				vec_sort (&put->fls, flscmp_dotnum_index);
+			else
+				vec_sort (&put->fls, flscmp_default);
+			cunilogTargetSetFLSisSorted (put);
+			cunilogTargetSetFLSindexBuilt (put);
+		}
 		if (hasLogPostfix (put))
 		{	// Our current logfile is missing because the search mask wouldn't
 			//	pick it up. For hasDotNumberPostfix () the current logfile is
@@ -5106,13 +9274,51 @@ static inline void obtainLogfilesListToRotate (CUNILOG_TARGET *put)
 	}
 }
 
-static inline void cunilogResetFilesList (CUNILOG_TARGET *put)
+bool ConfigCUNILOG_TARGETfilesListIndex (CUNILOG_TARGET *put, bool bWatchFolder)
 {
 	ubf_assert_non_NULL (put);
 
-	vec_clear (&put->fls);
-	EmptySBULKMEM (&put->sbm);
-	cunilogTargetClrFLSisSorted (put);
+	// Whatever has been read from disk so far is read again for the index.
+	cunilogResetFilesList (put);
+	cunilogTargetSetFLSindex (put);
+	if (!bWatchFolder)
+		return true;
+
+	#ifdef CUNILOG_HAVE_INOTIFY
+		if (-1 == put->fdFLSwatch)
+		{
+			put->fdFLSwatch = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+			if (-1 == put->fdFLSwatch)
+				return false;
+			int wd = inotify_add_watch	(
+						put->fdFLSwatch, put->mbLogFold.buf.pcc, CUNILOG_FLS_WATCH_MASK
+										);
+			if (-1 == wd)
+			{
+				DoneCUNILOG_TARGETflsWatch (put);
+				return false;
+			}
+		}
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+bool ConfigCUNILOG_TARGETrotateAtSize (CUNILOG_TARGET *put, uint64_t nOctets)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert_msg (hasDotNumberPostfix (put), "Only supported for dot number postfixes.");
+
+	if (!hasDotNumberPostfix (put))
+		return false;
+	put->ullRotateAtSize = nOctets;
+	if (nOctets && !cunilogTargetHasFLSindex (put))
+	{
+		cunilogResetFilesList (put);
+		cunilogTargetSetFLSindex (put);
+	}
+	return true;
 }
 
 static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
@@ -5136,6 +9342,8 @@ static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 
 	cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_ROTATOR, cup, pev);
 
+	if (cunilogrotationtask_RenameLogfiles == prd->tsk && hasDotNumberPostfix (put))
+		WaitForMaintenanceJobs (put);
 	obtainLogfilesListToRotate		(put);
 	DebugOutputFilesList ("cunilogProcessRotateLogfilesFnct", &put->fls);
 
@@ -5143,6 +9351,23 @@ static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 	{
 		case cunilogrotationtask_None:
 			break;
+		case cunilogrotationtask_ExtCompressLogfiles:
+			// Compressed logfiles would not be renamed with the others.
+			ubf_assert_msg (!hasDotNumberPostfix (put), "Not supported with a dot number postfix.");
+			if (hasDotNumberPostfix (put))
+				break;
+			// Every logfile would fail to compress and stay.
+			ubf_assert_msg	(
+				ExtCompressorAvailable (rotatorCompressor (prd->uiFlgs)),
+				"Compressor not built in. See ExtCompressors.h."
+							);
+			if (!ExtCompressorAvailable (rotatorCompressor (prd->uiFlgs)))
+				break;
+			// The logfiles are compressed already.
+			if (put->wb.pfr)
+				break;
+			prapareLogfilesListAndRotate (&args);
+			break;
 		case cunilogrotationtask_RenameLogfiles:
 			if (!hasDotNumberPostfix (put) && !hasLogPostfix (put))
 				break;
@@ -5164,7 +9389,8 @@ static bool cunilogProcessRotateLogfilesFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EV
 /*
 	The custom processor. Its pData member is a pointer to a CUNILOG_CUSTPROCESS structure,
 	which has two members: pData for custom data and the function pointer procFnc, which
-	is the actual custom processor function.
+	is the actual custom processor function. Without procFnc, the batch function procBatch
+	gets the event on its own, together with the current event line.
 */
 static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
 {
@@ -5178,8 +9404,15 @@ static bool cunilogProcessCustomProcessorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_E
 
 	CUNILOG_CUSTPROCESS	*pcu = cup->pData;
 	ubf_assert_non_NULL (pcu);
-	ubf_assert_non_NULL (pcu->procFnct);
-	return pcu->procFnct (cup, pev);
+	ubf_assert (pcu->procFnct || pcu->procBatch);
+	if (pcu->procFnct)
+		return pcu->procFnct (cup, pev);
+
+	CUNILOG_BATCHEVENT	be;
+	be.pev		= pev;
+	be.szLine	= pev->pCUNILOG_TARGET->mbLogEventLine.buf.pch;
+	be.lnLine	= pev->pCUNILOG_TARGET->lnLogEventLine;
+	return pcu->procBatch (cup, &be, 1);
 }
 
 /*
@@ -5200,8 +9433,14 @@ static bool cunilogProcessTargetRedirectorFnct (CUNILOG_PROCESSOR *cup, CUNILOG_
 	ubf_assert_non_NULL (put);
 
 	if (put)
-	{
-		logEv (put, pev);
+	{	// A batch function still needs the event, which means we redirect a copy.
+		if (cunilogIsEventDeferred (pev))
+		{
+			CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
+			if (pnev)
+				logEv (put, pnev);
+		} else
+			logEv (put, pev);
 		return false;
 	}
 	return true;
@@ -5220,7 +9459,7 @@ static bool cunilogProcessTargetForkFnct (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT
 		CUNILOG_EVENT *pnev = DuplicateCUNILOG_EVENT (pev);
 		if (pnev)
 		{
-			logEv (put, pev);
+			logEv (put, pnev);
 		}
 	}
 	return true;
@@ -5262,152 +9501,1111 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 #endif
 
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	// Returns how many times the semaphore must be triggered to empty the queue.
-	static inline size_t EnqueueCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	/*
+		Without the locker ResumeLogCUNILOG_TARGET () might collect nPausedEvents just
+		before our increment. We therefore check the paused flag again afterwards. A
+		superfluous trigger only causes an empty round of the separate logging thread
+		while a missing one would leave the event in the queue.
+	*/
+	static inline size_t nToTriggerLockFree (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (cunilogTargetHasIsPaused (put))
+		{
+			cunilogAtomicAddSize (&put->nPausedEvents, 1);
+			return cunilogTargetHasIsPaused (put) ? 0 : 1;
+		}
+		return 1;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Internal events, command events, and the shutdown event are neither dropped nor
+		do they wait for space in the queue. Internal events are usually created by the
+		separate logging thread itself.
+	*/
+	static inline bool queueLimitAppliesToEvent (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	{
+		ubf_assert_non_NULL (put);
 		ubf_assert_non_NULL (pev);
-		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
 
-		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		return
+					put->nMaxQueuedEvents
+				&&	!cunilogIsEventInternal (pev)
+				&&	!cunilogIsEventShutdown (pev)
+				&&	cunilogEvtTypeCommand != pev->evType;
+	}
+#endif
 
-		size_t r;
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool isEventBelowDropSeverity (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtSeverityXAmountEnumValues > pev->evSeverity);
 
-		EnterCUNILOG_LOCKER (put);
+		return put->uiDropSeverities & ((uint32_t) 1 << pev->evSeverity);
+	}
+#endif
 
-		// In this case it's more of an enqueuing date/timestamp than a creation date/timestamp.
-		if (0 == pev->stamp)
-		{
-			pev->stamp = LocalTime_UBF_TIMESTAMP ();
-			ubf_assert_msg (false, "Actually not implemented yet");
-		}
-		ubf_assert_non_0 (pev->stamp);
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void dropCUNILOG_EVENT (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtSeverityXAmountEnumValues > pev->evSeverity);
 
-		if (put->qu.first)
-		{
-			CUNILOG_EVENT *l	= put->qu.last;
-			ubf_assert_non_NULL (l);
-			ubf_assert_NULL (l->next);
-			l->next				= pev;
-			put->qu.last		= pev;
-			put->qu.num			+= 1;
-		} else
+		cunilogAtomicAddSize (&put->nDroppedEvents [pev->evSeverity], 1);
+		DoneCUNILOG_EVENT (NULL, pev);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool isSeparateLoggingThread (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		#ifdef OS_IS_WINDOWS
+			return GetCurrentThreadId () == GetThreadId (put->th.hThread);
+		#else
+			return pthread_equal (pthread_self (), put->th.tThread);
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		A producer can only wait for space in the queue if the separate logging thread is
+		going to empty it. It isn't while the target is paused, and it can't if the
+		producer is the separate logging thread itself. The new event is dropped instead.
+	*/
+	static inline bool canWaitForQueueSpace (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		return !cunilogTargetHasIsPaused (put) && !isSeparateLoggingThread (put);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void WaitForQueueSpace (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		#ifdef OS_IS_WINDOWS
+			DWORD dw = WaitForSingleObject (put->smQueueSpace.hSemaphore, INFINITE);
+			ubf_assert (WAIT_OBJECT_0 == dw);
+			UNUSED (dw);
+		#else
+			int i = sem_wait (&put->smQueueSpace.tSemaphore);
+			ubf_assert (0 == i);
+			UNUSED (i);
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called by the separate logging thread after it has emptied the queue. A producer
+		checks the amount of queued events and registers itself as waiting while it holds
+		the locker. Since we obtain the locker after the queue has been emptied, the
+		producer either sees the empty queue or we see its registration.
+	*/
+	static void WakeProducersWaitingForQueueSpace (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		size_t n;
+
+		EnterCUNILOG_LOCKER (put);
+		n = put->nBlockedProducers;
+		put->nBlockedProducers = 0;
+		LeaveCUNILOG_LOCKER (put);
+		if (n)
+		{
+			#ifdef OS_IS_WINDOWS
+				bool b = ReleaseSemaphore (put->smQueueSpace.hSemaphore, (LONG) n, NULL);
+				ubf_assert_true (b);
+				UNUSED (b);
+			#else
+				int i;
+				while (n)
+				{
+					i = sem_post (&put->smQueueSpace.tSemaphore);
+					ubf_assert (0 == i);
+					-- n;
+				}
+				UNUSED (i);
+			#endif
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Drops the oldest queued event the queue limit applies to. If bBelowSeverityOnly
+		is true, only events below the drop severity threshold are considered. The caller
+		holds the locker. Returns false if the queue doesn't contain such an event.
+	*/
+	static bool dropOldestQueuedCUNILOG_EVENT (CUNILOG_TARGET *put, bool bBelowSeverityOnly)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (cunilogHasDebugQueueLocked (put));
+
+		CUNILOG_EVENT	*prv	= NULL;
+		CUNILOG_EVENT	*pev	= put->qu.first;
+
+		while	(
+						pev
+					&&	(
+								!queueLimitAppliesToEvent (put, pev)
+							||	(bBelowSeverityOnly && !isEventBelowDropSeverity (put, pev))
+						)
+				)
+		{
+			prv = pev;
+			pev = pev->next;
+		}
+		if (NULL == pev)
+			return false;
+		if (prv)
+			prv->next		= pev->next;
+		else
+			put->qu.first	= pev->next;
+		if (put->qu.last == pev)
+			put->qu.last	= prv;
+		put->qu.num			-= 1;
+		dropCUNILOG_EVENT (put, pev);
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Applies the queue full policy of the target to the new event pev. The caller holds
+		the locker. Returns true if pev is to be enqueued, false if it has been dropped.
+	*/
+	static bool applyQueueFullPolicy (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogHasDebugQueueLocked (put));
+
+		while (put->qu.num >= put->nMaxQueuedEvents)
+		{
+			switch (put->queueFullPolicy)
+			{
+				case cunilogQueueFullBlock:
+					if (!canWaitForQueueSpace (put))
+						goto DropNewest;
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+					break;
+				case cunilogQueueFullDropNewest:
+					goto DropNewest;
+				case cunilogQueueFullDropOldest:
+					if (!dropOldestQueuedCUNILOG_EVENT (put, false))
+						return true;
+					break;
+				case cunilogQueueFullDropBelowSeverity:
+					if (isEventBelowDropSeverity (put, pev))
+						goto DropNewest;
+					// An important event makes room by dropping the oldest less important
+					//	one. If there's none left, it waits like with cunilogQueueFullBlock.
+					if (dropOldestQueuedCUNILOG_EVENT (put, true))
+						break;
+					if (!canWaitForQueueSpace (put))
+						goto DropNewest;
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+					break;
+				default:
+					ubf_assert_msg (false, "Unknown queue full policy");
+					return true;
+			}
+		}
+		return true;
+
+	DropNewest:
+		dropCUNILOG_EVENT (put, pev);
+		return false;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Lock-free version of applyQueueFullPolicy (). Since several producers can check
+		the amount of queued events at the same time, the capacity of the queue can be
+		exceeded by the amount of producers. Events can only be taken from the head of
+		a lock-free queue, which is why cunilogQueueFullDropOldest drops the new event,
+		and cunilogQueueFullDropBelowSeverity waits like cunilogQueueFullBlock for an
+		event that isn't below the drop severity threshold.
+	*/
+	static bool applyQueueFullPolicyLockFree (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (pev);
+
+		if (cunilogAtomicLoadSize (&put->qu.num) < put->nMaxQueuedEvents)
+			return true;
+		switch (put->queueFullPolicy)
+		{
+			case cunilogQueueFullDropBelowSeverity:
+				if (isEventBelowDropSeverity (put, pev))
+					break;
+				// Falls through.
+				UBF_FALLTHROUGH_HINT
+			case cunilogQueueFullBlock:
+				if (!canWaitForQueueSpace (put))
+					break;
+				EnterCUNILOG_LOCKER (put);
+				while (cunilogAtomicLoadSize (&put->qu.num) >= put->nMaxQueuedEvents)
+				{
+					++ put->nBlockedProducers;
+					LeaveCUNILOG_LOCKER (put);
+					WaitForQueueSpace (put);
+					EnterCUNILOG_LOCKER (put);
+				}
+				LeaveCUNILOG_LOCKER (put);
+				return true;
+			case cunilogQueueFullDropNewest:
+			case cunilogQueueFullDropOldest:
+				break;
+			default:
+				ubf_assert_msg (false, "Unknown queue full policy");
+				return true;
+		}
+		dropCUNILOG_EVENT (put, pev);
+		return false;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Pushes the event onto the lock-free queue. Producers never block. The events are
+		linked from the most recent one to the oldest one. The member num is incremented
+		before the event is pushed so that it never falls below the actual amount of
+		queued events. See EnqueueCUNILOG_EVENT () for pbDropped.
+	*/
+	static inline size_t EnqueueLockFreeCUNILOG_EVENT (CUNILOG_EVENT *pev, bool *pbDropped)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (cunilogHasLockFreeQueue (put));
+
+		if (0 == pev->stamp)
+			pev->stamp = cunilogLocalTimestamp (put);
+		ubf_assert_non_0 (pev->stamp);
+
+		if (queueLimitAppliesToEvent (put, pev) && !applyQueueFullPolicyLockFree (put, pev))
+		{
+			if (pbDropped)
+				*pbDropped = true;
+			return 0;
+		}
+
+		cunilogAtomicAddSize (&put->qu.num, 1);
+		CUNILOG_EVENT *head = cunilogAtomicLoadEvt (&put->qu.head);
+		do
+		{
+			pev->next = head;
+		} while (!cunilogAtomicCasEvt (&put->qu.head, &head, pev));
+		return nToTriggerLockFree (put);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Returns how many times the semaphore must be triggered to empty the queue. If
+		pbDropped isn't NULL, the bool it points to is set to true when the queue full
+		policy of the target has dropped the event. It is not touched otherwise.
+	*/
+	static inline size_t EnqueueCUNILOG_EVENT (CUNILOG_EVENT *pev, bool *pbDropped)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		CUNILOG_TARGET	*put = pev->pCUNILOG_TARGET;
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		if (cunilogHasLockFreeQueue (put))
+			return EnqueueLockFreeCUNILOG_EVENT (pev, pbDropped);
+
+		size_t r;
+
+		EnterCUNILOG_LOCKER (put);
+
+		// In this case it's more of an enqueuing date/timestamp than a creation date/timestamp.
+		if (0 == pev->stamp)
+		{
+			pev->stamp = cunilogLocalTimestamp (put);
+			ubf_assert_msg (false, "Actually not implemented yet");
+		}
+		ubf_assert_non_0 (pev->stamp);
+
+		if (queueLimitAppliesToEvent (put, pev) && !applyQueueFullPolicy (put, pev))
+		{
+			LeaveCUNILOG_LOCKER (put);
+			if (pbDropped)
+				*pbDropped = true;
+			return 0;
+		}
+
+		if (put->qu.first)
+		{
+			CUNILOG_EVENT *l	= put->qu.last;
+			ubf_assert_non_NULL (l);
+			ubf_assert_NULL (l->next);
+			l->next				= pev;
+			put->qu.last		= pev;
+			put->qu.num			+= 1;
+		} else
+		{
+			put->qu.first		= pev;
+			put->qu.last		= pev;
+			put->qu.num			= 1;
+		}
+		r = nToTrigger (put);
+		LeaveCUNILOG_LOCKER (put);
+		return r;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Enqueues the list of n events from first to last, linked via their ->next
+		members, with a single lock or compare-and-swap operation. The queue limit of
+		the target is not applied. Returns how many times the semaphore must be
+		triggered.
+	*/
+	static size_t EnqueueBatchCUNILOG_EVENTs	(
+					CUNILOG_TARGET		*put,
+					CUNILOG_EVENT		*first,
+					CUNILOG_EVENT		*last,
+					size_t				n
+												)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_non_NULL (first);
+		ubf_assert_non_NULL (last);
+		ubf_assert_NULL (last->next);
+		ubf_assert_non_0 (n);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		size_t r;
+
+		if (cunilogHasLockFreeQueue (put))
+		{	// The lock-free queue is linked from the most recent event to the
+			//	oldest one.
+			CUNILOG_EVENT *prv = NULL;
+			CUNILOG_EVENT *pev = first;
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt			= pev->next;
+				pev->next	= prv;
+				prv			= pev;
+				pev			= nxt;
+			}
+			cunilogAtomicAddSize (&put->qu.num, n);
+			CUNILOG_EVENT *head = cunilogAtomicLoadEvt (&put->qu.head);
+			do
+			{
+				first->next = head;
+			} while (!cunilogAtomicCasEvt (&put->qu.head, &head, last));
+			return nToTriggerLockFree (put);
+		}
+
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
+		{
+			ubf_assert_non_NULL (put->qu.last);
+			put->qu.last->next	= first;
+		} else
+			put->qu.first		= first;
+		put->qu.last			= last;
+		put->qu.num				+= n;
+		r = nToTrigger (put);
+		LeaveCUNILOG_LOCKER (put);
+		return r;
+	}
+#endif
+
+/*
+	We expect the caller to process the returned event only. However,
+	for consistency, i.e. to hide the rest of the queue from the caller,
+	the member ->next of the returned event is set to NULL.
+	This is to ensure the caller won't try to iterate further to the next
+	event accidentally.
+
+	This function is currently not used because we always empty the entire
+	queue with DequeueAllCUNILOG_EVENTs ().
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueCUNILOG_EVENT (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert_msg (!cunilogHasLockFreeQueue (put), "Not supported for lock-free queues");
+
+		CUNILOG_EVENT	*pev	= NULL;
+
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
+		{
+			ubf_assert_non_0 (put->qu.num);
+
+			pev				= put->qu.first;
+			put->qu.first	= pev->next;
+			pev->next		= NULL;
+			put->qu.num		-= 1;
+		} else
+		{
+			ubf_assert_0	(put->qu.num);
+			ubf_assert_NULL	(put->qu.last);
+		}
+		LeaveCUNILOG_LOCKER (put);
+		return pev;
+	}
+#endif
+
+/*
+	Takes the entire lock-free queue with a single atomic exchange. Since producers
+	push onto the head of the queue, the list is reversed to restore the order in which
+	the events were enqueued. Taking the queue this way is also safe if more than one
+	thread dequeues, for instance CancelCUNILOG_TARGET (), as every caller obtains its
+	own list.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllLockFreeCUNILOG_EVENTs (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (cunilogHasLockFreeQueue (put));
+
+		CUNILOG_EVENT	*pev	= cunilogAtomicXchgEvt (&put->qu.head, NULL);
+		CUNILOG_EVENT	*prv	= NULL;
+		CUNILOG_EVENT	*nxt;
+		size_t			n		= 0;
+
+		while (pev)
+		{
+			nxt			= pev->next;
+			pev->next	= prv;
+			prv			= pev;
+			pev			= nxt;
+			++ n;
+		}
+		if (n)
+			cunilogAtomicSubSize (&put->qu.num, n);
+		return prv;
+	}
+#endif
+
+/*
+	We expect the caller to process the returned event and all its successors
+	until the end of the list. The member ->next of the last element of the
+	singly-linked list of events is NULL.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		if (cunilogHasLockFreeQueue (put))
+			return DequeueAllLockFreeCUNILOG_EVENTs (put);
+
+		CUNILOG_EVENT	*pev	= NULL;
+		CUNILOG_EVENT	*last;
+
+		EnterCUNILOG_LOCKER (put);
+		if (put->qu.first)
+		{
+			ubf_assert_non_0 (put->qu.num);
+
+			pev				= put->qu.first;
+			last			= put->qu.last;
+			ubf_assert_NULL (last->next);
+
+			// The queue is now empty. The caller is required to process
+			//	all returned events.
+			put->qu.first	= NULL;
+			put->qu.last	= NULL;
+			put->qu.num		= 0;
+		} else
+		{
+			ubf_assert_0	(put->qu.num);
+			ubf_assert_NULL	(put->qu.last);
+		}
+		LeaveCUNILOG_LOCKER (put);
+		return pev;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void triggerCUNILOG_EVENTloggingThread (CUNILOG_TARGET *put, size_t releaseCount)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+		ubf_assert (0 < releaseCount);						// Caller's responsibility.
+
+		if (cunilogHasCoalescedWakeups (put))
+		{	// The separate logging thread takes over the entire queue when it wakes
+			//	up. If it isn't parked it's going to find our event(s) anyway.
+			if (0 == cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 0))
+				return;
+			releaseCount = 1;
+		}
+		cunilogAtomicAddSize (&put->nSepLogThreadPosts, releaseCount);
+
+		#ifdef OS_IS_WINDOWS
+			LONG lPrevCount;
+			LONG relCount = (long) releaseCount;
+			bool b = ReleaseSemaphore (put->sm.hSemaphore, relCount, &lPrevCount);
+			UNREFERENCED_PARAMETER (b);
+			#ifdef DEBUG
+				ubf_assert_true (b);
+				if (false == b)
+				{
+					char szMsg [CUNILOG_STD_MSG_SIZE];
+					GetTextForLastError (szMsg);
+					szMsg [0] = szMsg [0];					// To have something to step to.
+				}
+			#endif
+		#else
+			int i;
+			while (releaseCount)
+			{
+				i = sem_post (&put->sm.tSemaphore);
+				ubf_assert (0 == i);
+				-- releaseCount;
+			}
+			UNREFERENCED_PARAMETER (i);
+		#endif
+	}
+#endif
+
+/*
+	Per-thread staging buffers.
+
+	A producer thread collects its events in its own staging buffer and hands them over
+	to the queue of the target in batches, which takes the locker of the target, or
+	the compare-and-swap operation of the lock-free queue, and the semaphore post only
+	once per batch. The staging buffer of a thread is stored in thread-local storage.
+
+	A staging buffer is practically only ever accessed by its own thread. Instead of a
+	locker it is protected by its member nBusy, which costs a single atomic exchange per
+	staged event. Other threads only access the staging buffer to publish its events:
+	the separate logging thread when they have exceeded the maximum latency, and
+	ShutdownCUNILOG_TARGET ().
+
+	Locking order: the locker of the list of staging buffers (clStagings), then nBusy of
+	a staging buffer, then the locker of the target. The separate logging thread only
+	tries to obtain the first two as a producer that waits for space in a bounded queue
+	might hold them.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#define cunilogHasStagingBuffers(put)				\
+		((put)->bStaging)
+#endif
+
+/*
+	A thread that stages events reads the clock only every CUNILOG_STAGING_CLOCK_EVENTS
+	events to check the maximum latency of its staging buffer. Idle threads are taken
+	care of by the separate logging thread anyway.
+*/
+#ifndef CUNILOG_STAGING_CLOCK_EVENTS
+#define CUNILOG_STAGING_CLOCK_EVENTS					(16)
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool TryEnterCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
+
+		return 0 == cunilogAtomicXchgSize (&ps->nBusy, 1);
+	}
+
+	static inline void EnterCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
+
+		// Only held for the time it takes to publish a batch.
+		while (!TryEnterCUNILOG_STAGING (ps))
+			Sleep_ms (0);
+	}
+
+	static inline void LeaveCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
+
+		cunilogAtomicStoreSize (&ps->nBusy, 0);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline CUNILOG_STAGING *getThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_true (put->tlsStaging.bCreated);
+
+		#ifdef OS_IS_WINDOWS
+			return FlsGetValue (put->tlsStaging.dwFlsIndex);
+		#else
+			return pthread_getspecific (put->tlsStaging.tKey);
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool setThreadCUNILOG_STAGING (CUNILOG_TARGET *put, CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert_true (put->tlsStaging.bCreated);
+
+		#ifdef OS_IS_WINDOWS
+			return FlsSetValue (put->tlsStaging.dwFlsIndex, ps);
+		#else
+			return 0 == pthread_setspecific (put->tlsStaging.tKey, ps);
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events over to the queue of the target. The caller has entered
+		the staging buffer. If the queue is bounded, the events are enqueued
+		one by one to apply the queue full policy to each of them.
+
+		The separate logging thread can't wait for space in the queue. The producers of
+		the events it publishes would have waited under the cunilogQueueFullBlock policy,
+		which is why the queue limit is not applied to them in this case.
+	*/
+	static void PublishCUNILOG_STAGING (CUNILOG_STAGING *ps)
+	{
+		ubf_assert_non_NULL (ps);
+
+		CUNILOG_TARGET	*put	= ps->put;
+		CUNILOG_EVENT	*pev	= ps->first;
+		CUNILOG_EVENT	*lst	= ps->last;
+		size_t			num		= ps->num;
+		size_t			n;
+
+		ps->first	= NULL;
+		ps->last	= NULL;
+		ps->num		= 0;
+		ps->octets	= 0;
+		ps->nUnclocked	= 0;
+		if (NULL == pev)
+			return;
+
+		if	(
+					put->nMaxQueuedEvents
+				&&	!(cunilogQueueFullBlock == put->queueFullPolicy && isSeparateLoggingThread (put))
+			)
+		{
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt			= pev->next;
+				pev->next	= NULL;
+				n = EnqueueCUNILOG_EVENT (pev, NULL);
+				if (n)
+					triggerCUNILOG_EVENTloggingThread (put, n);
+				pev = nxt;
+			}
+			return;
+		}
+		n = EnqueueBatchCUNILOG_EVENTs (put, pev, lst, num);
+		if (n)
+			triggerCUNILOG_EVENTloggingThread (put, n);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Unlinks the staging buffer ps from its target and destroys it. If bPublish is
+		true, its events are handed over to the queue of the target first, otherwise
+		they are discarded.
+	*/
+	static void DoneCUNILOG_STAGING (CUNILOG_STAGING *ps, bool bPublish)
+	{
+		ubf_assert_non_NULL (ps);
+
+		CUNILOG_TARGET	*put	= ps->put;
+		CUNILOG_STAGING	**pps;
+
+		EnterLocker (&put->clStagings);
+		pps = &put->stagings;
+		while (*pps && *pps != ps)
+			pps = &(*pps)->nextStaging;
+		ubf_assert (*pps == ps);
+		if (*pps)
+			*pps = ps->nextStaging;
+		LeaveLocker (&put->clStagings);
+
+		if (bPublish)
+		{
+			EnterCUNILOG_STAGING (ps);
+			PublishCUNILOG_STAGING (ps);
+			LeaveCUNILOG_STAGING (ps);
+		} else
+		{
+			CUNILOG_EVENT *pev = ps->first;
+			CUNILOG_EVENT *nxt;
+			while (pev)
+			{
+				nxt = pev->next;
+				DoneCUNILOG_EVENT (NULL, pev);
+				pev = nxt;
+			}
+		}
+		ubf_free (ps);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Called when a thread that has a staging buffer exits. On Windows this might also
+		be called by FlsFree () from DoneCUNILOG_TARGETstaging (), when the separate
+		logging thread has already ended.
+	*/
+	#ifdef OS_IS_WINDOWS
+		static VOID WINAPI StagingThreadExit (PVOID pv)
+	#else
+		static void StagingThreadExit (void *pv)
+	#endif
+	{
+		CUNILOG_STAGING *ps = pv;
+
+		if (ps)
+			DoneCUNILOG_STAGING (ps, !cunilogTargetHasShutdownCompleteFlag (ps->put));
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static CUNILOG_STAGING *CreateThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_STAGING *ps = ubf_malloc (sizeof (CUNILOG_STAGING));
+		if (NULL == ps)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return NULL;
+		}
+		ps->put			= put;
+		ps->nBusy		= 0;
+		ps->first		= NULL;
+		ps->last		= NULL;
+		ps->num			= 0;
+		ps->octets		= 0;
+		ps->nUnclocked	= 0;
+		ps->ullFirst	= 0;
+		if (!setThreadCUNILOG_STAGING (put, ps))
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_THREAD_LOCAL_STORAGE);
+			ubf_free (ps);
+			return NULL;
+		}
+		EnterLocker (&put->clStagings);
+		ps->nextStaging	= put->stagings;
+		put->stagings	= ps;
+		LeaveLocker (&put->clStagings);
+		return ps;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool isStageableCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+
+		return
+					!cunilogIsEventInternal (pev)
+				&&	!cunilogIsEventShutdown (pev)
+				&&	cunilogEvtTypeCommand != pev->evType;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Adds the event to the staging buffer of the current thread. Returns false if the
+		event could not be staged, in which case the caller enqueues it as usual. This is
+		also the case when ShutdownCUNILOG_TARGET () has flushed the staging buffers
+		already, as nothing would hand over the event to the queue anymore.
+	*/
+	static bool StageCUNILOG_EVENT (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pev->pCUNILOG_TARGET);
+
+		CUNILOG_TARGET	*put	= pev->pCUNILOG_TARGET;
+		CUNILOG_STAGING	*ps		= getThreadCUNILOG_STAGING (put);
+		bool			bPublish;
+
+		if (NULL == ps)
+		{
+			ps = CreateThreadCUNILOG_STAGING (put);
+			if (NULL == ps)
+				return false;
+		}
+		if (0 == pev->stamp)
+			pev->stamp = cunilogLocalTimestamp (put);
+		ubf_assert_NULL (pev->next);
+
+		EnterCUNILOG_STAGING (ps);
+		// Set before ShutdownCUNILOG_TARGET () enters the staging buffers to flush them.
+		if (put->bStagingClosed)
+		{
+			ubf_assert_NULL (ps->first);
+			LeaveCUNILOG_STAGING (ps);
+			return false;
+		}
+		if (ps->last)
+			ps->last->next	= pev;
+		else
+		{
+			ps->first		= pev;
+			ps->ullFirst	= GetSystemTimeAsULONGLONGrel ();
+			ps->nUnclocked	= 0;
+		}
+		ps->last		= pev;
+		ps->num			+= 1;
+		ps->octets		+= pev->lenDataToLog;
+		bPublish = ps->num >= put->nStagingEvents || ps->octets >= put->nStagingOctets;
+		if (!bPublish && CUNILOG_STAGING_CLOCK_EVENTS <= ++ ps->nUnclocked)
+		{
+			ps->nUnclocked = 0;
+			bPublish =		GetSystemTimeAsULONGLONGrel () - ps->ullFirst
+						>=	put->ullStagingLatency;
+		}
+		if (bPublish)
+			PublishCUNILOG_STAGING (ps);
+		LeaveCUNILOG_STAGING (ps);
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events of the current thread over to the queue of the target.
+		Called before an event that can't be staged is enqueued, so that the events of a
+		thread stay in order.
+	*/
+	static inline void FlushThreadCUNILOG_STAGING (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_STAGING *ps = getThreadCUNILOG_STAGING (put);
+		if (ps)
+		{
+			EnterCUNILOG_STAGING (ps);
+			PublishCUNILOG_STAGING (ps);
+			LeaveCUNILOG_STAGING (ps);
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Hands the staged events of all threads over to the queue of the target. If
+		bStaleOnly is true, only staging buffers whose oldest event has exceeded the
+		maximum latency are published, and busy staging buffers are skipped. This is
+		what the separate logging thread does. Otherwise no further events are staged
+		afterwards.
+	*/
+	static void FlushCUNILOG_STAGINGs (CUNILOG_TARGET *put, bool bStaleOnly)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_STAGING	*ps;
+		uint64_t		ullNow;
+
+		if (bStaleOnly)
+		{
+			if (!TryEnterLocker (&put->clStagings))
+				return;
+		} else
+		{
+			EnterLocker (&put->clStagings);
+			// Producers check this after they've entered their staging buffer.
+			put->bStagingClosed = true;
+		}
+		ullNow = GetSystemTimeAsULONGLONGrel ();
+		for (ps = put->stagings; ps; ps = ps->nextStaging)
+		{
+			if (bStaleOnly)
+			{
+				if (!TryEnterCUNILOG_STAGING (ps))
+					continue;
+				if (ps->num && ullNow - ps->ullFirst >= put->ullStagingLatency)
+					PublishCUNILOG_STAGING (ps);
+			} else
+			{
+				EnterCUNILOG_STAGING (ps);
+				PublishCUNILOG_STAGING (ps);
+			}
+			LeaveCUNILOG_STAGING (ps);
+		}
+		LeaveLocker (&put->clStagings);
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void DoneCUNILOG_TARGETstaging (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		if (put->tlsStaging.bCreated)
+		{
+			put->bStaging = false;
+			#ifdef OS_IS_WINDOWS
+				FlsFree (put->tlsStaging.dwFlsIndex);
+			#else
+				pthread_key_delete (put->tlsStaging.tKey);
+			#endif
+			put->tlsStaging.bCreated = false;
+			while (put->stagings)
+				DoneCUNILOG_STAGING (put->stagings, false);
+			DoneLocker (&put->clStagings);
+		}
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETstagingBuffers	(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		if (!HAS_CUNILOG_TARGET_A_QUEUE (put))
+			return false;
+		if (!put->tlsStaging.bCreated)
 		{
-			put->qu.first		= pev;
-			put->qu.last		= pev;
-			put->qu.num			= 1;
+			#ifdef OS_IS_WINDOWS
+				put->tlsStaging.dwFlsIndex = FlsAlloc (StagingThreadExit);
+				put->tlsStaging.bCreated = FLS_OUT_OF_INDEXES != put->tlsStaging.dwFlsIndex;
+			#else
+				put->tlsStaging.bCreated =
+					0 == pthread_key_create (&put->tlsStaging.tKey, StagingThreadExit);
+			#endif
+			if (!put->tlsStaging.bCreated)
+			{
+				SetCunilogSystemError (put, CUNILOG_ERROR_THREAD_LOCAL_STORAGE);
+				return false;
+			}
+			InitLocker (&put->clStagings);
 		}
-		r = nToTrigger (put);
-		LeaveCUNILOG_LOCKER (put);
-		return r;
+		put->nStagingEvents		= nEvents ? nEvents : SIZE_MAX;
+		put->nStagingOctets		= nOctets ? nOctets : SIZE_MAX;
+		// FILETIME units are 100 ns.
+		put->ullStagingLatency	= msLatency ? (uint64_t) msLatency * 10000 : UINT64_MAX;
+		put->bStaging			= 1 < nEvents || nOctets || msLatency;
+		return true;
 	}
 #endif
 
-/*
-	We expect the caller to process the returned event only. However,
-	for consistency, i.e. to hide the rest of the queue from the caller,
-	the member ->next of the returned event is set to NULL.
-	This is to ensure the caller won't try to iterate further to the next
-	event accidentally.
-
-	This function is currently not used because we always empty the entire
-	queue with DequeueAllCUNILOG_EVENTs ().
-*/
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueCUNILOG_EVENT (CUNILOG_TARGET *put)
+	static inline bool SepLogThreadQueueIsEmpty (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
-		CUNILOG_EVENT	*pev	= NULL;
+		bool bEmpty;
 
+		if (cunilogHasLockFreeQueue (put))
+			return NULL == cunilogAtomicLoadEvt (&put->qu.head);
 		EnterCUNILOG_LOCKER (put);
-		if (put->qu.first)
-		{
-			ubf_assert_non_0 (put->qu.num);
-
-			pev				= put->qu.first;
-			put->qu.first	= pev->next;
-			pev->next		= NULL;
-			put->qu.num		-= 1;
-		} else
-		{
-			ubf_assert_0	(put->qu.num);
-			ubf_assert_NULL	(put->qu.last);
-		}
+		bEmpty = NULL == put->qu.first;
 		LeaveCUNILOG_LOCKER (put);
-		return pev;
+		return bEmpty;
 	}
 #endif
 
 /*
-	We expect the caller to process the returned event and all its successors
-	until the end of the list. The member ->next of the last element of the
-	singly-linked list of events is NULL.
+	With staging buffers the separate logging thread wakes up after the maximum latency
+	at the latest to publish the staging buffers of threads that stopped logging. With
+	data in the write-behind buffer it wakes up when the data has reached its maximum
+	age. The function returns the time to wait in FILETIME units, or UINT64_MAX if the
+	separate logging thread can wait for the next event forever.
 */
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline CUNILOG_EVENT *DequeueAllCUNILOG_EVENTs (CUNILOG_TARGET *put)
+	static uint64_t SepLogThreadWaitTimeout (CUNILOG_TARGET *put)
 	{
 		ubf_assert_non_NULL (put);
-		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
-
-		CUNILOG_EVENT	*pev	= NULL;
-		CUNILOG_EVENT	*last;
-
-		EnterCUNILOG_LOCKER (put);
-		if (put->qu.first)
-		{
-			ubf_assert_non_0 (put->qu.num);
 
-			pev				= put->qu.first;
-			last			= put->qu.last;
-			ubf_assert_NULL (last->next);
+		uint64_t	ullTimeout	= UINT64_MAX;
+		uint64_t	ullAge;
 
-			// The queue is now empty. The caller is required to process
-			//	all returned events.
-			put->qu.first	= NULL;
-			put->qu.last	= NULL;
-			put->qu.num		= 0;
-		} else
+		if (cunilogHasStagingBuffers (put))
+			ullTimeout = put->ullStagingLatency;
+		if (put->wb.len && UINT64_MAX != put->wb.ullLatency)
 		{
-			ubf_assert_0	(put->qu.num);
-			ubf_assert_NULL	(put->qu.last);
+			ullAge = GetSystemTimeAsULONGLONGrel () - put->wb.ullFirst;
+			if (ullAge >= put->wb.ullLatency)
+				return 0;
+			if (put->wb.ullLatency - ullAge < ullTimeout)
+				ullTimeout = put->wb.ullLatency - ullAge;
 		}
-		LeaveCUNILOG_LOCKER (put);
-		return pev;
+		return ullTimeout;
 	}
 #endif
 
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-	static inline void triggerCUNILOG_EVENTloggingThread (CUNILOG_TARGET *put, size_t releaseCount)
+	static bool SepLogThreadTimedWaitForEvents (CUNILOG_TARGET *put, uint64_t ullTimeout)
 	{
 		ubf_assert_non_NULL (put);
 		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
-		ubf_assert (0 < releaseCount);						// Caller's responsibility.
+
+		// FILETIME units are 100 ns. Rounded up to not wake up too early.
+		uint64_t ms = (ullTimeout + 9999) / 10000;
 
 		#ifdef OS_IS_WINDOWS
-			LONG lPrevCount;
-			LONG relCount = (long) releaseCount;
-			bool b = ReleaseSemaphore (put->sm.hSemaphore, relCount, &lPrevCount);
-			UNREFERENCED_PARAMETER (b);
-			#ifdef DEBUG
-				ubf_assert_true (b);
-				if (false == b)
-				{
-					char szMsg [CUNILOG_STD_MSG_SIZE];
-					GetTextForLastError (szMsg);
-					szMsg [0] = szMsg [0];					// To have something to step to.
-				}
-			#endif
+			DWORD dw = WaitForSingleObject (put->sm.hSemaphore, (DWORD) ms);
+			ubf_assert (WAIT_OBJECT_0 == dw || WAIT_TIMEOUT == dw);
+			return WAIT_OBJECT_0 == dw || WAIT_TIMEOUT == dw;
 		#else
-			int i;
-			while (releaseCount)
+			struct timespec ts;
+			clock_gettime (CLOCK_REALTIME, &ts);
+			ts.tv_sec	+= (time_t) (ms / 1000);
+			ts.tv_nsec	+= (long) (ms % 1000) * 1000000;
+			if (ts.tv_nsec >= 1000000000)
 			{
-				i = sem_post (&put->sm.tSemaphore);
-				ubf_assert (0 == i);
-				-- releaseCount;
+				ts.tv_sec	+= 1;
+				ts.tv_nsec	-= 1000000000;
 			}
-			UNREFERENCED_PARAMETER (i);
+			int i = sem_timedwait (&put->sm.tSemaphore, &ts);
+			ubf_assert (0 == i || ETIMEDOUT == errno || EINTR == errno);
+			return 0 == i || ETIMEDOUT == errno || EINTR == errno;
+		#endif
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline bool SepLogThreadTryWaitForEvents (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
+
+		#ifdef OS_IS_WINDOWS
+			return WAIT_OBJECT_0 == WaitForSingleObject (put->sm.hSemaphore, 0);
+		#else
+			return 0 == sem_trywait (&put->sm.tSemaphore);
 		#endif
 	}
 #endif
@@ -5415,6 +10613,13 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 /*
 	The calling thread loops as long as we return true. The calling thread exits
 	when we return false.
+
+	We always announce that we're about to park, even without coalesced wake-ups, as
+	the flag CUNILOGTARGET_COALESCE_WAKEUPS might only get set after we started waiting.
+	With coalesced wake-ups we check the queue a last time afterwards. A producer
+	enqueues its event before it takes the idle flag away from us. Either we see its
+	event or it sees our flag and signals the semaphore, but we can't both miss each
+	other.
 */
 #ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	static bool SepLogThreadWaitForEvents (CUNILOG_TARGET *put)
@@ -5422,6 +10627,27 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 		ubf_assert_non_NULL (put);
 		ubf_assert (HAS_CUNILOG_TARGET_A_QUEUE (put));
 
+		cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 1);
+		if (cunilogHasCoalescedWakeups (put))
+		{
+			if	(
+						!SepLogThreadQueueIsEmpty (put)
+					&&	1 == cunilogAtomicXchgSize (&put->nSepLogThreadIdle, 0)
+				)
+				return true;
+			// Either the queue is empty or a producer has already taken the flag
+			//	and signalled (or is going to signal) the semaphore.
+		}
+		// A semaphore that is already signalled doesn't block and doesn't count as a
+		//	wake-up.
+		if (SepLogThreadTryWaitForEvents (put))
+			return true;
+		++ put->nSepLogThreadWakeups;
+
+		uint64_t ullTimeout = SepLogThreadWaitTimeout (put);
+		if (UINT64_MAX != ullTimeout)
+			return SepLogThreadTimedWaitForEvents (put, ullTimeout);
+
 		#ifdef OS_IS_WINDOWS
 			DWORD dw = WaitForSingleObject (put->sm.hSemaphore, INFINITE);
 			ubf_assert (WAIT_OBJECT_0 == dw);
@@ -5434,6 +10660,68 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 	}
 #endif
 
+/*
+	Called by the separate logging thread after it has processed all events it took off
+	the queue.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static inline void SepLogThreadWriteBehind (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		CUNILOG_WRITEBEHIND	*pwb	= &put->wb;
+
+		if	(
+					pwb->len
+				&&	(
+							cunilogWriteBehindEveryBatch == pwb->policy
+						||	(
+									UINT64_MAX != pwb->ullLatency
+								&&	GetSystemTimeAsULONGLONGrel () - pwb->ullFirst >= pwb->ullLatency
+							)
+					)
+			)
+		{
+			if (!cunilogWriteBehindToLogFile (put, NULL, 0))
+				SetCunilogSystemError (put, CUNILOG_ERROR_WRITING_LOGFILE);
+		}
+	}
+#endif
+
+/*
+	Called by the separate logging thread after it has processed all events it took off
+	the queue. The echo output of these events is written out and the processors with a
+	batch function get their events. The events they kept are destroyed afterwards.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static void cunilogProcessBatch (CUNILOG_PROCESSOR *cup, CUNILOG_BATCH *pbt);
+
+	static void SepLogThreadCompleteBatch (CUNILOG_TARGET *put)
+	{
+		ubf_assert_non_NULL (put);
+
+		cunilogFlushEchoBatch (put);
+		if (put->batches)
+		{
+			unsigned int n;
+			for (n = 0; n < put->nprocessors; ++ n)
+				cunilogProcessBatch (put->cprocessors [n], &put->batches [n]);
+		}
+		put->lnBatchLines	= 0;
+		put->pevBatchLine	= NULL;
+
+		CUNILOG_EVENT *pev = put->pevDeferred;
+		CUNILOG_EVENT *pnx;
+		while (pev)
+		{
+			pnx = pev->next;
+			DoneCUNILOG_EVENT (put, pev);
+			pev = pnx;
+		}
+		put->pevDeferred = NULL;
+	}
+#endif
+
 /*
 	The separate logging thread.
 */
@@ -5445,20 +10733,41 @@ static void cunilogProcessNotSupported (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *p
 
 		while (SepLogThreadWaitForEvents (put))
 		{
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, true);
 			CUNILOG_EVENT *pev = DequeueAllCUNILOG_EVENTs (put);
 			CUNILOG_EVENT *pnx;
+			if (put->nMaxQueuedEvents)
+				WakeProducersWaitingForQueueSpace (put);
 			while (pev)
 			{	// Remember the next pointer because pev is going to be destroyed
 				//	by DoneSUNILOGEVENT ().
 				pnx = pev->next;
+				// Only events that reach the processors can be part of a batch.
+				if (!cunilogIsEventShutdown (pev) && cunilogEvtTypeCommand != pev->evType)
+					cunilogSetEventBatched (pev);
 				cunilogProcessEventSingleThreaded (pev);
-				DoneCUNILOG_EVENT (put, pev);
+				// Processing never destroys the event. If a batch function still needs
+				//	it, it's destroyed with the batch.
+				if (cunilogIsEventDeferred (pev) && put == pev->pCUNILOG_TARGET)
+				{
+					pev->next			= put->pevDeferred;
+					put->pevDeferred	= pev;
+				} else
+					DoneCUNILOG_EVENT (put, pev);
 				pev = pnx;
 			}
+			SepLogThreadCompleteBatch (put);
+			SepLogThreadWriteBehind (put);
 			if (cunilogTargetHasShutdownInitiatedFlag (put) && 0 == put->nPendingNoRotEvts )
 				goto ExitSeparateLoggingThread;
 		}
 	ExitSeparateLoggingThread:
+		StopMaintenanceThread (put);
+		if (!cunilogWriteBehindToLogFileAndWait (put))
+			SetCunilogSystemError (put, CUNILOG_ERROR_WRITING_LOGFILE);
+		if (put->nMaxQueuedEvents)
+			WakeProducersWaitingForQueueSpace (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return SEPARATE_LOGGING_THREAD_RETURN_SUCCESS;
 	}
@@ -5511,6 +10820,30 @@ static inline bool updateThresholdForAppliesToTimes (CUNILOG_PROCESSOR *cup)
 	return bRet;
 }
 
+/*
+	Returns true if the current event has made the active logfile of the target put points
+	to reach the size at which the rotator cup rotates. This is the threshold of a rotator
+	with the frequency cunilogProcessAppliesTo_nOctets, if it has one, or the size set with
+	ConfigCUNILOG_TARGETrotateAtSize ().
+
+	The size only triggers the rotator for the event that crosses it, or for the first
+	event written to a logfile that already exceeds it. Once a rotator has fired, a logfile
+	that stays over the size, for instance because it couldn't be renamed, doesn't trigger
+	it again with every subsequent event.
+*/
+static inline bool hasLogfileReachedRotationSize (CUNILOG_PROCESSOR *cup, CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (put);
+
+	uint64_t ullMax	=		cunilogProcessAppliesTo_nOctets == cup->freq && cup->thr
+						?	cup->thr
+						:	put->ullRotateAtSize;
+	return		ullMax
+			&&	put->logfile.ullSizePrv < ullMax
+			&&	put->logfile.ullSizeEvt >= ullMax;
+}
+
 static inline bool updateCurrentValueAndIsThresholdReached	(
 								CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev
 																	)
@@ -5519,7 +10852,8 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 	ubf_assert_non_NULL (pev);
 	ubf_assert (sizeof (uint64_t) == sizeof (UBF_TIMESTAMP));
 
-	bool bRet = false;
+	bool bRet		= false;
+	bool bFirst		= 0 == cup->thr;
 
 	cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
 	switch (cup->freq)
@@ -5530,6 +10864,11 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 			cup->thr = bRet ? 0 : cup->cur;
 			break;
 		case cunilogProcessAppliesTo_nOctets:
+			if (cunilogProcessRotateLogfiles == cup->task)
+			{	// The size check below decides.
+				cup->cur = pev->pCUNILOG_TARGET->logfile.ullSizeEvt;
+				break;
+			}
 			cup->cur += pev->lenDataToLog;
 			bRet = cup->cur >= cup->thr;
 			cup->thr = bRet ? 0 : cup->cur;
@@ -5577,6 +10916,15 @@ static inline bool updateCurrentValueAndIsThresholdReached	(
 	}
 	cunilogTestErrorCB (CUNILOG_ERROR_TEST_AFTER_THRESHOLD_UPDATE, cup, pev);
 
+	// The name of the logfile doesn't have a timestamp before this processor has run
+	//	once, even if the target doesn't run its processors on startup.
+	if (!bRet && bFirst && cunilogProcessUpdateLogFileName == cup->task)
+		bRet = true;
+
+	// Rotators also rotate when the active logfile has reached its maximum size.
+	if (!bRet && cunilogProcessRotateLogfiles == cup->task)
+		bRet = hasLogfileReachedRotationSize (cup, pev->pCUNILOG_TARGET);
+
 	// The flag OPT_CUNPROC_AT_STARTUP tells us to run the processor in any case.
 	if (optCunProcHasOPT_CUNPROC_AT_STARTUP (cup->uiOpts))
 	{
@@ -5604,42 +10952,311 @@ static bool (*pickAndRunProcessor [cunilogProcessXAmountEnumValues]) (CUNILOG_PR
 	/* cunilogProcessTargetFork			*/	,	cunilogProcessTargetForkFnct
 };
 
+static inline bool hasProcessorBatchFnct (CUNILOG_PROCESSOR *cp)
+{
+	ubf_assert_non_NULL (cp);
+
+	return	(
+					cunilogProcessCustomProcessor == cp->task
+				&&	cunilogProcessAppliesTo_nAlways == cp->freq
+				&&	cp->pData
+				&&	((CUNILOG_CUSTPROCESS *) cp->pData)->procBatch
+			);
+}
+
+/*
+	Only targets with a separate logging thread get batches. They're parallel to the
+	processor list and, like the plan, only allocated once.
+*/
+static bool allocateProcessorBatches (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		if (NULL == put->batches && HAS_CUNILOG_TARGET_A_QUEUE (put))
+		{
+			unsigned int n;
+			for (n = 0; n < put->nprocessors; ++ n)
+			{
+				if (hasProcessorBatchFnct (put->cprocessors [n]))
+				{
+					put->batches = ubf_calloc (put->nprocessors, sizeof (CUNILOG_BATCH));
+					return NULL != put->batches;
+				}
+			}
+		}
+	#else
+		UNUSED (put);
+	#endif
+	return true;
+}
+
+/*
+	Compiles the processor list of the target put points to into its processor plan.
+	The plan has space for all processors and is only allocated once. Disabled processors
+	are left out. Needs to be called again whenever a processor is disabled or enabled.
+*/
+static bool compileProcessorPlan (CUNILOG_TARGET *put)
+{
+	ubf_assert_non_NULL (put);
+
+	if (NULL == put->plan)
+	{
+		ubf_assert_0 (put->nplan);
+		put->plan = ubf_malloc (put->nprocessors * sizeof (CUNILOG_PLANSTEP));
+		if (NULL == put->plan)
+		{
+			SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+			return false;
+		}
+	}
+	if (!allocateProcessorBatches (put))
+	{
+		SetCunilogSystemError (put, CUNILOG_ERROR_HEAP_ALLOCATION);
+		return false;
+	}
+
+	CUNILOG_PROCESSOR	*cp;
+	CUNILOG_PLANSTEP	*ps		= put->plan;
+	unsigned int		n;
+
+	for (n = 0; n < put->nprocessors; ++ n)
+	{
+		cp = put->cprocessors [n];
+		if (optCunProcHasOPT_CUNPROC_DISABLED (cp->uiOpts))
+			continue;
+		ubf_assert (0 <= cp->task);
+		ubf_assert (cunilogProcessXAmountEnumValues > cp->task);
+		ps->cup		= cp;
+		ps->fnct	= pickAndRunProcessor [cp->task];
+		ps->uiFlags	= 0;
+		ps->pbt		= NULL;
+		if (cunilogProcessAppliesTo_nAlways == cp->freq)
+			ps->uiFlags |= CUNILOG_PLANSTEP_ALWAYS;
+		if (OPT_CUNPROC_FORCE_NEXT & cp->uiOpts)
+			ps->uiFlags |= CUNILOG_PLANSTEP_FORCE_NEXT;
+		if (cunilogProcessEchoToConsole == cp->task)
+			ps->uiFlags |= CUNILOG_PLANSTEP_ECHO;
+		if (put->batches && hasProcessorBatchFnct (cp))
+		{
+			ps->uiFlags |= CUNILOG_PLANSTEP_BATCH;
+			ps->pbt		= &put->batches [n];
+		}
+		++ ps;
+	}
+	put->nplan = (unsigned int) (ps - put->plan);
+	return true;
+}
+
+static inline bool isEventSkippedByProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pev);
+
+	return	(
+					cup->uiSkipSeverities	& CUNILOG_SEVERITY_BIT (pev->evSeverity)
+				||	cup->uiSkipEvtTypes		& CUNILOG_EVTTYPE_BIT (pev->evType)
+			);
+}
+
+/*
+	Hands the pending events of the batch pbt points to over to the batch function of
+	the processor cup points to.
+*/
+static void cunilogProcessBatch (CUNILOG_PROCESSOR *cup, CUNILOG_BATCH *pbt)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pbt);
+
+	if (pbt->nevs)
+	{
+		CUNILOG_CUSTPROCESS	*pcu = cup->pData;
+		ubf_assert_non_NULL (pcu);
+		ubf_assert_non_NULL (pcu->procBatch);
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			// The line buffer doesn't move anymore while the batch function runs.
+			CUNILOG_TARGET	*put	= pbt->pbes [0].pev->pCUNILOG_TARGET;
+			size_t			n;
+			for (n = 0; n < pbt->nevs; ++ n)
+				pbt->pbes [n].szLine = put->szBatchLines + pbt->pofs [n];
+		#endif
+		pcu->procBatch (cup, pbt->pbes, pbt->nevs);
+		pbt->nevs = 0;
+	}
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	/*
+		Stores the current event line of the target, which belongs to the event pev
+		points to, in the line buffer of the batch and returns its offset at the address
+		pofs points to. Batch functions of several processors share the line. The
+		function returns false if the line buffer can't grow, in which case it's left
+		as it is.
+	*/
+	static bool cunilogStoreBatchEventLine (CUNILOG_EVENT *pev, size_t *pofs)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert_non_NULL (pofs);
+
+		CUNILOG_TARGET	*put	= pev->pCUNILOG_TARGET;
+
+		if (pev == put->pevBatchLine)
+		{
+			*pofs = put->ofsBatchLine;
+			return true;
+		}
+
+		size_t			ln		= put->lnLogEventLine + 1;
+		if (put->lnBatchLines + ln > put->szBatchLinesSize)
+		{
+			size_t	size	= put->szBatchLinesSize ? put->szBatchLinesSize * 2 : 4096;
+			while (size < put->lnBatchLines + ln)
+				size *= 2;
+			char	*sz		= ubf_realloc (put->szBatchLines, size);
+			if (NULL == sz)
+				return false;
+			put->szBatchLines		= sz;
+			put->szBatchLinesSize	= size;
+		}
+		memcpy (put->szBatchLines + put->lnBatchLines, put->mbLogEventLine.buf.pch, ln);
+		put->pevBatchLine	= pev;
+		put->ofsBatchLine	= put->lnBatchLines;
+		put->lnBatchLines	+= ln;
+		*pofs = put->ofsBatchLine;
+		return true;
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static bool cunilogGrowBatch (CUNILOG_BATCH *pbt)
+	{
+		ubf_assert_non_NULL (pbt);
+
+		if (pbt->nevs < pbt->size)
+			return true;
+
+		size_t				size	= pbt->size ? pbt->size * 2 : 16;
+		CUNILOG_BATCHEVENT	*pbes	= ubf_realloc (pbt->pbes, size * sizeof (CUNILOG_BATCHEVENT));
+		if (NULL == pbes)
+			return false;
+		pbt->pbes = pbes;
+		size_t				*pofs	= ubf_realloc (pbt->pofs, size * sizeof (size_t));
+		if (NULL == pofs)
+			return false;
+		pbt->pofs = pofs;
+		pbt->size = size;
+		return true;
+	}
+#endif
+
+/*
+	An event the separate logging thread took off the queue together with others is
+	added to the batch of the plan step. Any other event is processed straight away,
+	after the events that are still pending.
+*/
+static bool cunilogProcessBatchPlanStep (CUNILOG_EVENT *pev, CUNILOG_PLANSTEP *ps)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert_non_NULL	(ps);
+	ubf_assert_non_NULL	(ps->pbt);
+
+	CUNILOG_BATCH *pbt = ps->pbt;
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		size_t ofs;
+		if	(
+					cunilogIsEventBatched (pev)
+				&&	cunilogGrowBatch (pbt)
+				&&	cunilogStoreBatchEventLine (pev, &ofs)
+			)
+		{
+			pbt->pbes [pbt->nevs].pev		= pev;
+			pbt->pbes [pbt->nevs].szLine	= NULL;
+			pbt->pbes [pbt->nevs].lnLine	= pev->pCUNILOG_TARGET->lnLogEventLine;
+			pbt->pofs [pbt->nevs]			= ofs;
+			++ pbt->nevs;
+			cunilogSetEventDeferred (pev);
+			return true;
+		}
+	#endif
+	cunilogProcessBatch (ps->cup, pbt);
+	return ps->fnct (ps->cup, pev);
+}
+
 /*
+	Runs the processor of the plan step ps points to if its threshold has been reached.
 	Returns true for further processing by the caller.
 */
-static inline bool cunilogProcessProcessor (CUNILOG_EVENT *pev, CUNILOG_PROCESSOR *cup)
+static inline bool cunilogProcessPlanStep (CUNILOG_EVENT *pev, CUNILOG_PLANSTEP *ps)
 {
 	ubf_assert_non_NULL	(pev);
-	ubf_assert_non_NULL	(cup);
-	ubf_assert_non_NULL	(pev->pCUNILOG_TARGET);
-	ubf_assert			(cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
+	ubf_assert_non_NULL	(ps);
+	ubf_assert_non_NULL	(ps->cup);
+	ubf_assert			(!optCunProcHasOPT_CUNPROC_DISABLED (ps->cup->uiOpts));
 
-	// If the processor is disabled we move on to the next one unconditionally.
-	if (optCunProcHasOPT_CUNPROC_DISABLED (cup->uiOpts))
-		return true;
+	CUNILOG_PROCESSOR *cup = ps->cup;
 
-	if (cunilogHasEventEchoOnly (pev) && cunilogProcessEchoToConsole != cup->task)
+	// We move on to the next processor if this one skips the event.
+	if (isEventSkippedByProcessor (cup, pev))
 		return true;
 
 	bool bRetProcessor = true;
-	if	(updateCurrentValueAndIsThresholdReached (cup, pev))
+	if (CUNILOG_PLANSTEP_BATCH & ps->uiFlags)
+	{
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
+		bRetProcessor = cunilogProcessBatchPlanStep (pev, ps);
+	} else
+	if (CUNILOG_PLANSTEP_ALWAYS & ps->uiFlags)
+	{
+		cunilogTestErrorCB (CUNILOG_ERROR_TEST_BEFORE_THRESHOLD_UPDATE, cup, pev);
+		bRetProcessor = ps->fnct (cup, pev);
+	} else
+	if (updateCurrentValueAndIsThresholdReached (cup, pev))
 	{
 		// True tells the caller to carry on with the next processor.
-		bRetProcessor = pickAndRunProcessor [cup->task] (cup, pev);
+		bRetProcessor = ps->fnct (cup, pev);
 	}
-	
-	if (cunilogProcessEchoToConsole == cup->task && cunilogHasEventEchoOnly (pev))
-		return false;
+
 	// An error callback function told us to stop here and ignore the remaining processors.
 	if (cunilogEventHasIgnoreRemainingProcessors (pev))
 		return false;
 	// The processor has the OPT_CUNPROC_FORCE_NEXT flag set.
-	if (OPT_CUNPROC_FORCE_NEXT & cup->uiOpts)
+	if (CUNILOG_PLANSTEP_FORCE_NEXT & ps->uiFlags)
 		return true;
 	if (cunilogTargetHasRunProcessorsOnStartup (pev->pCUNILOG_TARGET))
 		return true;
 	// Now the current processor decides if the next processor is allowed to run.
-	 return bRetProcessor;
+	return bRetProcessor;
+}
+
+/*
+	An event that is only echoed to the console goes to the first echo processor of the
+	plan that doesn't skip it.
+*/
+static inline void cunilogProcessPlanEchoOnly (CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL	(pev);
+	ubf_assert			(cunilogHasEventEchoOnly (pev));
+
+	CUNILOG_TARGET		*put	= pev->pCUNILOG_TARGET;
+	CUNILOG_PLANSTEP	*ps		= put->plan;
+	CUNILOG_PLANSTEP	*pe		= ps + put->nplan;
+
+	for (; ps < pe; ++ ps)
+	{
+		if	(
+					CUNILOG_PLANSTEP_ECHO & ps->uiFlags
+				&&	!isEventSkippedByProcessor (ps->cup, pev)
+			)
+		{
+			if	(
+						CUNILOG_PLANSTEP_ALWAYS & ps->uiFlags
+					||	updateCurrentValueAndIsThresholdReached (ps->cup, pev)
+				)
+				ps->fnct (ps->cup, pev);
+			return;
+		}
+	}
 }
 
 static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
@@ -5648,24 +11265,26 @@ static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET);
 	ubf_assert (cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
 	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET->cprocessors);
+	ubf_assert_non_NULL						(pev->pCUNILOG_TARGET->plan);
 
 	CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
 	if (!cunilogIsEventInternal (pev) && !cunilogHasEventNoRotation (pev))
 	{
 		pev->pCUNILOG_TARGET->scuNPI.nIgnoredTotal = 0;
-		cunilogResetFilesList (put);
+		if (!cunilogTargetHasFLSindex (put))
+			cunilogResetFilesList (put);
 		cunilogEventClrIgnoreRemainingProcessors (pev);
 	}
 
-	CUNILOG_PROCESSOR *cup;
-	unsigned int ui = 0;
-	while (ui < pev->pCUNILOG_TARGET->nprocessors)
+	if (cunilogHasEventEchoOnly (pev))
+		cunilogProcessPlanEchoOnly (pev);
+	else
 	{
-		cup = pev->pCUNILOG_TARGET->cprocessors [ui];
-		bool b = cunilogProcessProcessor (pev, cup);
-		if (!b)
-			break;
-		++ ui;
+		CUNILOG_PLANSTEP	*ps		= put->plan;
+		CUNILOG_PLANSTEP	*pe		= ps + put->nplan;
+
+		while (ps < pe && cunilogProcessPlanStep (pev, ps))
+			++ ps;
 	}
 
 	if (!cunilogIsEventInternal (pev))
@@ -5686,7 +11305,7 @@ static void cunilogProcessProcessors (CUNILOG_EVENT *pev)
 			ubf_assert (cunilogCmdConfigXAmountEnumValues > cmd);
 		#endif
 		culCmdChangeCmdConfigFromCommand (pev);
-		DoneCUNILOG_EVENT (NULL, pev);
+		// The event is destroyed by the caller, like any other event.
 		return true;
 	}
 #endif
@@ -5700,8 +11319,9 @@ static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev)
 	// Event command flag for shutting down the separate logging thread.
 	if (cunilogIsEventShutdown (pev))
 	{
+		// The shutdown event is only ever processed by the separate logging thread,
+		//	which destroys it afterwards like any other event.
 		cunilogTargetSetShutdownInitiatedFlag (pev->pCUNILOG_TARGET);
-		DoneCUNILOG_EVENT (NULL, pev);
 		// The shutdown event has been processed. We treat this as being success.
 		return true;
 	}
@@ -5711,11 +11331,16 @@ static bool cunilogProcessEventSingleThreaded (CUNILOG_EVENT *pev)
 			return cunilogProcessEvtCommand (pev);
 	#endif
 
+	// Messages of the maintenance thread go before the event that's going to be written.
+	if (!cunilogIsEventInternal (pev))
+		cunilogLogMaintenanceMessages (pev->pCUNILOG_TARGET);
+
 	size_t	eventLineSize = createEventLineFromSUNILOGEVENT (pev);
 	if (CUNILOG_SIZE_ERROR != eventLineSize)
 	{
 		cunilogProcessProcessors (pev);
-		if (cunilogHasEventNoRotation (pev))
+		// Only the internal events of logFromInsideRotatorTextU8fmt () are counted.
+		if (cunilogHasEventNoRotation (pev) && cunilogIsEventInternal (pev))
 			DecrementPendingNoRotationEvents (pev->pCUNILOG_TARGET);
 		return true;
 	}
@@ -5729,10 +11354,21 @@ static bool enqueueAndTriggerSeparateLoggingThread (CUNILOG_EVENT *pev)
 	ubf_assert (cunilogIsTargetInitialised	(pev->pCUNILOG_TARGET));
 
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
-		size_t n = EnqueueCUNILOG_EVENT (pev);
+		// Once queued, the event can be destroyed any time, either by the separate logging
+		//	thread or because it has been dropped.
+		CUNILOG_TARGET *put = pev->pCUNILOG_TARGET;
+		if (cunilogHasStagingBuffers (put))
+		{
+			if (isStageableCUNILOG_EVENT (pev) && StageCUNILOG_EVENT (pev))
+				return true;
+			FlushThreadCUNILOG_STAGING (put);
+		}
+		// An event dropped by the queue full policy is not an error.
+		bool	bDropped	= false;
+		size_t	n			= EnqueueCUNILOG_EVENT (pev, &bDropped);
 		if (n)
-			triggerCUNILOG_EVENTloggingThread (pev->pCUNILOG_TARGET, n);
-		return n > 0;
+			triggerCUNILOG_EVENTloggingThread (put, n);
+		return n > 0 || bDropped;
 	#else
 		return cunilogProcessEventSingleThreaded (pev);
 	#endif
@@ -5863,6 +11499,8 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 
 		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
 		{
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, false);
 			if (queueShutdownEvent (put))
 			{
 				WaitForEndOfSeparateLoggingThread (put);
@@ -5871,6 +11509,10 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 			}
 			return false;
 		}
+		EnterCUNILOG_LOCKER (put);
+		StopMaintenanceThread (put);
+		cunilogWriteBehindToLogFileAndWait (put);
+		LeaveCUNILOG_LOCKER (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -5879,6 +11521,7 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 	{
 		ubf_assert_non_NULL (put);
 
+		cunilogWriteBehindToLogFileAndWait (put);
 		cunilogTargetSetShutdownCompleteFlag (put);
 		return true;
 	}
@@ -5892,6 +11535,8 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 		if (HAS_CUNILOG_TARGET_A_QUEUE (put))
 		{
 			cunilogTargetSetShutdownInitiatedFlag (put);
+			if (cunilogHasStagingBuffers (put))
+				FlushCUNILOG_STAGINGs (put, false);
 
 			// Empty the queue. While this would actually not be required here, it can
 			//	speed up things significantly (well, maybe a few cycles) with busy queues as
@@ -5946,11 +11591,16 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 
 		EnterCUNILOG_LOCKER (put);
 		cunilogTargetClrIsPaused (put);
-		n = put->nPausedEvents;
-		put->nPausedEvents = 0;
+		if (cunilogHasLockFreeQueue (put))
+			n = cunilogAtomicXchgSize (&put->nPausedEvents, 0);
+		else
+		{
+			n = put->nPausedEvents;
+			put->nPausedEvents = 0;
+		}
 		LeaveCUNILOG_LOCKER (put);
 
-		if (needsOrHasLocker (put))
+		if (n && needsOrHasLocker (put))
 			triggerCUNILOG_EVENTloggingThread (put, n);
 		return n;
 	}
@@ -5960,6 +11610,19 @@ static bool cunilogProcessOrQueueEvent (CUNILOG_EVENT *pev)
 	User logging functions.
 */
 
+/*
+	Returns true if the target put points to doesn't log events with the severity sev.
+	Called by the logging functions before an event is created.
+*/
+static inline bool isSeverityFilteredOut (CUNILOG_TARGET *put, cueventseverity sev)
+{
+	ubf_assert_non_NULL (put);
+	ubf_assert (0 <= sev);
+	ubf_assert (cunilogEvtSeverityXAmountEnumValues > sev);
+
+	return !(cunilogAtomicLoadU32 (&put->uiLogSeverities) & CUNILOG_SEVERITY_BIT (sev));
+}
+
 bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 {
 	ubf_assert_non_NULL (put);
@@ -5969,6 +11632,8 @@ bool logEv (CUNILOG_TARGET *put, CUNILOG_EVENT *pev)
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
 
+	// The event doesn't belong to the batch of its previous target anymore.
+	cunilogClrEventBatched (pev);
 	pev->pCUNILOG_TARGET = put;
 	return cunilogProcessOrQueueEvent (pev);
 }
@@ -5979,6 +11644,8 @@ bool logTextU8sevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccTe
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -5990,6 +11657,8 @@ bool logTextU8sevlts		(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -6001,6 +11670,8 @@ bool logTextU8sevlq			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	if (pev)
@@ -6017,6 +11688,8 @@ bool logTextU8sevlqts		(CUNILOG_TARGET *put, cueventseverity sev, const char *cc
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextTS (put, sev, ccText, len, ts);
 	if (pev)
@@ -6043,6 +11716,8 @@ bool logTextU8l				(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -6054,6 +11729,8 @@ bool logTextU8lq			(CUNILOG_TARGET *put, const char *ccText, size_t len)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, ccText, len);
 	if (pev)
@@ -6080,19 +11757,11 @@ bool logTextU8vfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8l (put, ob, l);
-		ubf_free (ob);
-		return b;
-	}
-	return false;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
 bool logTextU8fmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -6101,6 +11770,8 @@ bool logTextU8fmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6118,17 +11789,14 @@ bool logTextU8qvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8lq (put, ob, l);
-		ubf_free (ob);
-		return b;
+		cunilogSetEventNoRotation (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -6139,6 +11807,8 @@ bool logTextU8qfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6156,24 +11826,10 @@ bool logTextU8svfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8l (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return logTextU8vfmt (put, fmt, ap);
 }
 
 bool logTextU8sfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -6182,6 +11838,8 @@ bool logTextU8sfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6199,23 +11857,10 @@ bool logTextU8sqvfmt		(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8lq (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return logTextU8qvfmt (put, fmt, ap);
 }
 
 bool logTextU8sqfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
@@ -6224,12 +11869,14 @@ bool logTextU8sqfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
 
 	va_start (ap, fmt);
-	b = logTextU8sqfmt (put, fmt, ap);
+	b = logTextU8sqvfmt (put, fmt, ap);
 	va_end (ap);
 
 	return b;
@@ -6241,24 +11888,11 @@ bool logTextU8svfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8sevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
 }
 
 bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...)
@@ -6267,6 +11901,8 @@ bool logTextU8sfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fm
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6285,9 +11921,15 @@ bool logTextU8smbvfmtsev	(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	va_list		aq;
+
+	va_copy (aq, ap);
+	l = (size_t) vsnprintf (NULL, 0, fmt, aq);
+	va_end (aq);
 
 	growToSizeSMEMBUF (smb, l + 1);
 	if (isUsableSMEMBUF (smb))
@@ -6310,6 +11952,8 @@ bool logTextU8smbfmtsev		(CUNILOG_TARGET *put, SMEMBUF *smb, cueventseverity sev
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6328,6 +11972,8 @@ bool logTextU8smbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_l
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextU8smbvfmtsev (put, smb, cunilogEvtSeverityNone, fmt, ap);
 }
@@ -6339,6 +11985,8 @@ bool logTextU8smbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6350,12 +11998,77 @@ bool logTextU8smbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 	return b;
 }
 
+bool logTextU8dvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
+
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_TextDeferredvfmt (put, sev, fmt, ap);
+	return pev && cunilogProcessOrQueueEvent (pev);
+}
+
+bool logTextU8dfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
+
+	va_list		ap;
+	bool		b;
+
+	va_start (ap, fmt);
+	b = logTextU8dvfmtsev (put, sev, fmt, ap);
+	va_end (ap);
+
+	return b;
+}
+
+bool logTextU8dvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
+
+	return logTextU8dvfmtsev (put, cunilogEvtSeverityNone, fmt, ap);
+}
+
+bool logTextU8dfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
+{
+	ubf_assert_non_NULL (put);
+
+	if (cunilogTargetHasShutdownInitiatedFlag (put))
+		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
+
+	va_list		ap;
+	bool		b;
+
+	va_start (ap, fmt);
+	b = logTextU8dvfmtsev (put, cunilogEvtSeverityNone, fmt, ap);
+	va_end (ap);
+
+	return b;
+}
+
 bool logHexDumpU8sevl		(CUNILOG_TARGET *put, cueventseverity sev, const void *pBlob, size_t size, const char *ccCaption, size_t lenCaption)
 {
 	ubf_assert_non_NULL (put);
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data (put, sev, pBlob, size, ccCaption, lenCaption);
 	return pev && cunilogProcessOrQueueEvent (pev);
@@ -6367,6 +12080,8 @@ bool logHexDumpU8l			(CUNILOG_TARGET *put, const void *pBlob, size_t size, const
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob, size,
@@ -6381,6 +12096,8 @@ bool logHexDump				(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob,
@@ -6395,6 +12112,8 @@ bool logHexDumpq			(CUNILOG_TARGET *put, const void *pBlob, size_t size)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Data	(
 							put, cunilogEvtSeverityNone, pBlob,
@@ -6414,6 +12133,8 @@ bool logHexOrText			(CUNILOG_TARGET *put, const void *szHexOrTxt, size_t lenHexO
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (str_has_only_printable_ASCII (szHexOrTxt, lenHexOrTxt))
 		return logTextU8l (put, szHexOrTxt, lenHexOrTxt);
@@ -6427,6 +12148,8 @@ bool logHexOrTextq			(CUNILOG_TARGET *put, const void *szHexOrTxt, size_t lenHex
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (str_has_only_printable_ASCII (szHexOrTxt, lenHexOrTxt))
 		return logTextU8lq (put, szHexOrTxt, lenHexOrTxt);
@@ -6440,6 +12163,8 @@ bool logHexOrTextU8			(CUNILOG_TARGET *put, const void *szHexOrTxtU8, size_t len
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	if (c_check_utf8 (szHexOrTxtU8, lenHexOrTxtU8))
 		return logTextU8l (put, szHexOrTxtU8, lenHexOrTxtU8);
@@ -6454,6 +12179,8 @@ bool logTextWU16sevl			(CUNILOG_TARGET *put, cueventseverity sev, const wchar_t
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	char s8 [CUNILOG_STD_MSG_SIZE * 4];
 	char *p8;
@@ -6499,6 +12226,8 @@ bool logTextWU16sev			(CUNILOG_TARGET *put, cueventseverity sev, const wchar_t *
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	char s8 [CUNILOG_STD_MSG_SIZE * 4];
 	char *p8;
@@ -6536,6 +12265,8 @@ bool logTextWU16l				(CUNILOG_TARGET *put, const wchar_t *cwText, size_t len)
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextWU16sevl (put, cunilogEvtSeverityNone, cwText, len);
 }
@@ -6548,6 +12279,8 @@ bool logTextWU16				(CUNILOG_TARGET *put, const wchar_t *cwText)
 	
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	return logTextWU16sev (put, cunilogEvtSeverityNone, cwText);
 }
@@ -6559,6 +12292,8 @@ bool logTextU8csevl			(CUNILOG_TARGET *put, cueventseverity sev, const char *ccT
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Text (put, sev, ccText, len);
 	if (pev)
@@ -6596,17 +12331,14 @@ bool logTextU8cvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
-	size_t		l;
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	char *ob = ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, cunilogEvtSeverityNone, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-		bool b = logTextU8cl (put, ob, l);
-		ubf_free (ob);
-		return b;
+		cunilogSetEventEchoOnly (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -6617,6 +12349,8 @@ bool logTextU8cfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	bool		b;
@@ -6634,29 +12368,17 @@ bool logTextU8csfmt			(CUNILOG_TARGET *put, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
+	bool		b;
 
 	va_start (ap, fmt);
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	b = logTextU8cvfmt (put, fmt, ap);
 	va_end (ap);
 
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		va_start (ap, fmt);
-		vsnprintf (ob, l + 1, fmt, ap);
-		va_end (ap);
-
-		bool b = logTextU8cl (put, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return b;
 }
 
 bool logTextU8csmbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_list ap)
@@ -6666,10 +12388,15 @@ bool logTextU8csmbvfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, va_
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	size_t		l;
+	va_list		aq;
 
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	va_copy (aq, ap);
+	l = (size_t) vsnprintf (NULL, 0, fmt, aq);
+	va_end (aq);
 
 	growToSizeSMEMBUF (smb, l + 1);
 	if (isUsableSMEMBUF (smb))
@@ -6692,6 +12419,8 @@ bool logTextU8csmbfmt		(CUNILOG_TARGET *put, SMEMBUF *smb, const char *fmt, ...)
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, cunilogEvtSeverityNone))
+		return true;
 
 	va_list		ap;
 	size_t		l;
@@ -6722,22 +12451,14 @@ bool logTextU8csvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
-
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
-
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
+	CUNILOG_EVENT *pev = CreateCUNILOG_EVENT_Textvfmt (put, sev, fmt, ap);
+	if (pev)
 	{
-		vsnprintf (ob, l + 1, fmt, ap);
-
-		bool b = logTextU8csevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
+		cunilogSetEventEchoOnly (pev);
+		return cunilogProcessOrQueueEvent (pev);
 	}
 	return false;
 }
@@ -6748,29 +12469,17 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 
 	if (cunilogTargetHasShutdownInitiatedFlag (put))
 		return false;
+	if (isSeverityFilteredOut (put, sev))
+		return true;
 
 	va_list		ap;
-	size_t		l;
-
-	char		cb [CUNILOG_DEFAULT_SFMT_SIZE];
-	char		*ob;
+	bool		b;
 
 	va_start (ap, fmt);
-	l = (size_t) vsnprintf (NULL, 0, fmt, ap);
+	b = logTextU8csvfmtsev (put, sev, fmt, ap);
 	va_end (ap);
 
-	ob = l < CUNILOG_DEFAULT_SFMT_SIZE ? cb : ubf_malloc (l + 1);
-	if (ob)
-	{
-		va_start (ap, fmt);
-		vsnprintf (ob, l + 1, fmt, ap);
-		va_end (ap);
-
-		bool b = logTextU8csevl (put, sev, ob, l);
-		if (ob != cb) ubf_free (ob);
-		return b;
-	}
-	return false;
+	return b;
 }
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
@@ -6797,6 +12506,27 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 	}
 #endif
 
+#ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
+	/*
+		A queued command event is destroyed by the separate logging thread. Without a
+		queue it has been processed when cunilogProcessOrQueueEvent () returns and we
+		destroy it ourselves.
+	*/
+	static bool cunilogProcessOrQueueCmdEvent (CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (pev);
+		ubf_assert (cunilogEvtTypeCommand == pev->evType);
+
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			if (HAS_CUNILOG_TARGET_A_QUEUE (pev->pCUNILOG_TARGET))
+				return cunilogProcessOrQueueEvent (pev);
+		#endif
+		bool b = cunilogProcessOrQueueEvent (pev);
+		DoneCUNILOG_EVENT (NULL, pev);
+		return b;
+	}
+#endif
+
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
 	bool ChangeCUNILOG_TARGETuseColourForEcho (CUNILOG_TARGET *put, bool bUseColour)
 	{
@@ -6804,7 +12534,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigUseColourForEcho (pev->szDataToLog, bUseColour);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6821,7 +12551,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigCunilognewline (pev->szDataToLog, nl);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6837,8 +12567,8 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		CUNILOG_EVENT *pev = CreateCUNILOG_EVENTforCommand (put, cunilogCmdConfigDisableTaskProcessors);
 		if (pev)
 		{
-			culCmdStoreCmdConfigEnableTaskProcessors (pev->szDataToLog, task);
-			return cunilogProcessOrQueueEvent (pev);
+			culCmdStoreCmdConfigDisableTaskProcessors (pev->szDataToLog, task);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6855,7 +12585,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreCmdConfigEnableTaskProcessors (pev->szDataToLog, task);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6871,7 +12601,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			memcpy (pev->szDataToLog, &cmd, sizeof (cmd));
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6885,7 +12615,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			memcpy (pev->szDataToLog, &cmd, sizeof (cmd));
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6905,7 +12635,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 		if (pev)
 		{
 			culCmdStoreConfigEventSeverityFormatType (pev->szDataToLog, sevTpy);
-			return cunilogProcessOrQueueEvent (pev);
+			return cunilogProcessOrQueueCmdEvent (pev);
 		}
 		return false;
 	}
@@ -6925,7 +12655,7 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 			if (pev)
 			{
 				culCmdStoreConfigLogThreadPriority (pev->szDataToLog, prio);
-				return cunilogProcessOrQueueEvent (pev);
+				return cunilogProcessOrQueueCmdEvent (pev);
 			}
 			return false;
 		}
@@ -7022,8 +12752,9 @@ int cunilog_printf_sev_fmtpy_vl	(
 		#ifdef PLATFORM_IS_WINDOWS
 			iRet = cunilogPrintWin (pzToPrint, lenRequired);
 		#else
+			// The text has been formatted already and must not be used as a format.
 			if (lenRequired)
-				iRet = printf (pz);
+				iRet = printf ("%s", pzToPrint);
 			else
 				iRet = printf ("");
 		#endif
@@ -7167,7 +12898,7 @@ int cunilog_puts_sev_fmtpy_l	(
 			iRet = cunilogPutsWin (pzToPrint, lenRequired);
 		#else
 			if (lenRequired)
-				iRet = puts (pz);
+				iRet = puts (pzToPrint);
 			else
 				iRet = puts ("");
 		#endif
@@ -7274,6 +13005,10 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (EventSeverityTexts5)			==	cunilogEvtSeverityXAmountEnumValues);
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (EventSeverityTexts9)			==	cunilogEvtSeverityXAmountEnumValues);
 		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (evtSeverityColours)			==	cunilogEvtSeverityXAmountEnumValues);
+		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (cunilogEvtSeverityRank)		==	cunilogEvtSeverityXAmountEnumValues);
+		#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+			ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (stEventPoolPayloads)		==	CUNILOG_EVENTPOOL_CLASSES);
+		#endif
 
 		// Check that the length assignments are correct.
 		ubf_expect_bool_AND (bRet, LEN_ISO8601DATEHOURANDMINUTE	== lenDateTimeStampFromPostfix (cunilogPostfixMinute));
@@ -7301,6 +13036,7 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberWeekly));
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberMonthly));
 		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberYearly));
+		ubf_expect_bool_AND (bRet, 1 + UBF_UINT64_LEN			== lenDateTimeStampFromPostfix (cunilogPostfixDotNumberSize));
 
 		/*
 			Check consistency between unilogstruct.h and the declarations in this code file.
@@ -7677,6 +13413,46 @@ int cunilogCheckVersionIntChk (uint64_t cunilogHdrVersion)
 
 		DoneCUNILOG_TARGET (pt);
 
+		/*
+			The cached event timestamp must always be identical to a freshly rendered one.
+			Each stamp below differs from its predecessor in a different field, the last
+			one in its date.
+		*/
+		CUNILOG_TARGET	tt;
+		CUNILOG_EVENT	te;
+		char			szC [64];
+		char			szR [64];
+		SUBF_TIMESTRUCT	tst		= {2025, 6, 15, 13, 55, 36, 123, 456, 1, 0, true};
+		UBF_TIMESTAMP	ts;
+		UBF_TIMESTAMP	tsChanges [] =
+		{
+				(UBF_TIMESTAMP) 0x007 << 8
+			,	(UBF_TIMESTAMP) 0x007 << 18
+			,	(UBF_TIMESTAMP) 0x001 << 28
+			,	(UBF_TIMESTAMP) 0x002 << 34
+			,	(UBF_TIMESTAMP) 0x004 << 40
+			,	(UBF_TIMESTAMP) 0x001 << 54
+		};
+		UBF_TIMESTAMP_from_SUBF_TIMESTRUCT (&ts, &tst);
+		te.pCUNILOG_TARGET = &tt;
+		for (unsigned int f = 0; f < cunilogEvtTS_AmountEnumValues; ++ f)
+		{
+			tt.unilogEvtTSformat = f;
+			InitCUNILOG_TSPREFIX (&tt.tsp);
+			te.stamp = ts;
+			for (unsigned int c = 0; c <= GET_ARRAY_LEN (tsChanges); ++ c)
+			{
+				size_t len = writeEvtTimestamp (szC, &te);
+				evtTSFormats [f].fnc (szR, te.stamp);
+				ubf_expect_bool_AND (bRet, evtTSFormats [f].len == len);
+				ubf_expect_bool_AND (bRet, !memcmp (szC, szR, len));
+				// Toggling these bits keeps the fields within their ranges.
+				if (c < GET_ARRAY_LEN (tsChanges))
+					te.stamp ^= tsChanges [c];
+			}
+		}
+		ubf_expect_bool_AND (bRet, GET_ARRAY_LEN (evtTSFormats) == cunilogEvtTS_AmountEnumValues);
+
 		return bRet;
 	}
 #endif
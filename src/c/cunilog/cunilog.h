@@ -95,9 +95,11 @@ DoneCUNILOG_TARGETstatic ();
 	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
 		#include "./externC.h"
 		#include "./functionptrtpydef.h"
+		#include "./ExtCompressors.h"
 	#else
 		#include "./../pre/externC.h"
 		#include "./../pre/functionptrtpydef.h"
+		#include "./../extern/ExtCompressors.h"
 	#endif
 
 	#include "./cunilogversion.h"
@@ -171,12 +173,17 @@ DoneCUNILOG_TARGETstatic ();
 #define CUNILOG_STD_BULK_ALLOC_SIZE		(4096 - sizeof (SBULKMEMBLOCK))
 #endif
 
+// The default size of a bulk memory block of an event pool.
+#ifndef CUNILOG_STD_EVENTPOOL_SIZE
+#define CUNILOG_STD_EVENTPOOL_SIZE		(256 * 1024)
+#endif
+
 // The size we're going to expand the vector containing the names of logfiles.
 #ifndef CUNILOG_STD_VECT_EXP_SIZE
 #define CUNILOG_STD_VECT_EXP_SIZE		(128)
 #endif
 
-// The stack/heap threshold for the ...sfmt type logging functions.
+// The stack buffer size for the ...fmt type logging and output functions.
 #ifndef CUNILOG_DEFAULT_SFMT_SIZE
 #define CUNILOG_DEFAULT_SFMT_SIZE		(256)
 #endif
@@ -275,6 +282,58 @@ DoneCUNILOG_TARGETstatic ();
 	*/
 #else
 	#define CUNILOG_DEFAULT_OPEN_MODE	"a"
+	// The flags and permissions for a raw logfile. See ConfigCUNILOG_TARGETrawLogfile ().
+	#define CUNILOG_DEFAULT_RAW_OPEN_FLAGS	(O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC)
+	#define CUNILOG_DEFAULT_RAW_OPEN_PERMS	(0666)
+	// The flags for a memory-mapped logfile. See ConfigCUNILOG_TARGETmappedLogfile ().
+	#define CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS	(O_RDWR | O_CREAT | O_CLOEXEC)
+#endif
+
+/*
+	The amount of octets a memory-mapped logfile is extended by and mapped at once.
+	See ConfigCUNILOG_TARGETmappedLogfile ().
+*/
+#ifndef CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE
+#define CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE	(4 * 1024 * 1024)
+#endif
+
+/*
+	The priority maintenance threads compress logfiles with, and the amount of logfiles
+	that are compressed at the same time within the process. See
+	cunilogSetCompressionLimits ().
+*/
+#ifndef CUNILOG_DEFAULT_COMPRESSION_PRIORITY
+#define CUNILOG_DEFAULT_COMPRESSION_PRIORITY		(cunilogPrioBelowNormal)
+#endif
+#ifndef CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS
+#define CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS	(1)
+#endif
+
+/*
+	The amount of uncompressed octets per frame of a compressed logfile. See
+	ConfigCUNILOG_TARGETcompressedLogfile ().
+*/
+#ifndef CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE
+#define CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE		(256 * 1024)
+#endif
+
+/*
+	The size of the active logfile in octets at which it is rotated if the target
+	has been created with a postfix of cunilogPostfixDotNumberSize. See
+	ConfigCUNILOG_TARGETrotateAtSize ().
+*/
+#ifndef CUNILOG_DEFAULT_ROTATE_AT_SIZE
+#define CUNILOG_DEFAULT_ROTATE_AT_SIZE				(10 * 1024 * 1024)
+#endif
+
+/*
+	The least important severity rank (CUNILOG_SEVRANK_VERBOSE to CUNILOG_SEVRANK_EMERGENCY)
+	whose severity logging macros are compiled in. See logDebugU8l () and friends.
+	Define it as CUNILOG_SEVRANK_INFO, for instance, to compile out Debug, Trace, Detail,
+	and Verbose events.
+*/
+#ifndef CUNILOG_COMPILE_MIN_SEVERITY
+#define CUNILOG_COMPILE_MIN_SEVERITY				CUNILOG_SEVRANK_VERBOSE
 #endif
 
 EXTERN_C_BEGIN
@@ -1241,6 +1300,593 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 	#endif
 #endif
 
+/*
+	ConfigCUNILOG_TARGETseverityMask
+	ConfigCUNILOG_TARGETminSeverity
+
+	Set the severities of the events the target put points to logs. The logging functions
+	check the severity of an event before it is created, formatted, or queued, and return
+	true without doing anything else if the target doesn't log it. By default a target
+	logs events of all severities. Events created by the caller and logged with logEv ()
+	are not checked.
+
+	ConfigCUNILOG_TARGETseverityMask () sets the severities from a bit mask, in which
+	the bit CUNILOG_SEVERITY_BIT (sev) stands for the severity sev. A value of
+	CUNILOG_SEVERITY_MASK_ALL logs all severities, a value of 0 none at all.
+
+	ConfigCUNILOG_TARGETminSeverity () only logs the severities that are at least as
+	important as sevMin. See ConfigCUNILOG_TARGETqueueLimit () for the order of
+	importance. A sevMin of cunilogEvtSeverityInfo for instance stops Debug, Trace,
+	Detail, and Verbose events.
+
+	Unlike the other configuration functions, these functions can be called at any time,
+	also while other threads are logging to the target.
+*/
+void ConfigCUNILOG_TARGETseverityMask (CUNILOG_TARGET *put, uint32_t uiMask)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETseverityMask) (CUNILOG_TARGET *put, uint32_t uiMask)
+;
+void ConfigCUNILOG_TARGETminSeverity (CUNILOG_TARGET *put, cueventseverity sevMin)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETminSeverity) (CUNILOG_TARGET *put, cueventseverity sevMin)
+;
+
+/*
+	cunilogSeverityMaskFromMin
+
+	Returns a bit mask of all severities that are at least as important as sevMin, as
+	used by ConfigCUNILOG_TARGETminSeverity (). The mask can be passed on to
+	ConfigCUNILOG_TARGETseverityMask () or ConfigCUNILOG_PROCESSORfilter ().
+*/
+uint32_t cunilogSeverityMaskFromMin (cueventseverity sevMin)
+;
+TYPEDEF_FNCT_PTR (uint32_t, cunilogSeverityMaskFromMin) (cueventseverity sevMin)
+;
+
+/*
+	ConfigCUNILOG_TARGETqueueLimit
+
+	Limits the amount of events the queue of a target with a separate logging thread can
+	hold. Without a limit, which is the default, the queue grows as long as the separate
+	logging thread can't keep up, for instance when writing to the logfile stalls.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nMaxEvents			The maximum amount of queued events. If 0, the queue is
+						unbounded.
+
+	policy				What happens to a new event when the queue is full:
+						cunilogQueueFullBlock: The producer waits until the separate
+						logging thread has emptied the queue. If the target is paused, or
+						if the producer is the separate logging thread itself, the new event
+						is dropped instead. Staged events the separate logging thread hands
+						over to the queue (see ConfigCUNILOG_TARGETstagingBuffers ()) are
+						queued regardless of the limit.
+						cunilogQueueFullDropNewest: The new event is dropped.
+						cunilogQueueFullDropOldest: The oldest queued event is dropped. With
+						a lock-free queue (CUNILOGTARGET_LOCKFREE_QUEUE) the new event is
+						dropped instead.
+						cunilogQueueFullDropBelowSeverity: The new event is dropped if its
+						severity is less important than sevThreshold. Otherwise the oldest
+						queued event that is less important than sevThreshold is dropped.
+						If there's no such event, the producer waits like with
+						cunilogQueueFullBlock. With a lock-free queue the producer waits
+						without dropping a queued event. From least to most important the
+						severities are Verbose, Detail, Trace, Debug, None/Blanks,
+						Info/Pass/NonePass, Message/Notice, Warning/NoneWarn,
+						Error/Fail/NoneFail, Critical, Fatal, and Emergency/Illegal.
+
+	sevThreshold		The severity threshold for cunilogQueueFullDropBelowSeverity. The
+						parameter is ignored by the other policies.
+
+	Internal events, command events, and the shutdown event are never dropped. The member
+	nDroppedEvents of the target counts the dropped events per severity. Dropping an event
+	is not an error. The logging functions return true for an event that has been dropped
+	because the queue is full. With a lock-free queue the limit is approximate, as it can
+	be exceeded by the amount of concurrent producers.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	void ConfigCUNILOG_TARGETqueueLimit	(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	;
+	TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETqueueLimit)
+										(
+			CUNILOG_TARGET				*put,
+			size_t						nMaxEvents,
+			cuqueuefullpolicy			policy,
+			cueventseverity				sevThreshold
+										)
+	;
+#else
+	#define ConfigCUNILOG_TARGETqueueLimit(put, n, policy, sev)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETstagingBuffers
+
+	Switches on per-thread staging buffers for a target with a separate logging thread.
+	Each thread that logs collects its events in its own staging buffer first and hands
+	them over to the queue of the target in batches. This reduces the contention on the
+	queue and the amount of wake-ups of the separate logging thread for threads that log
+	a lot.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nEvents				The staged events of a thread are handed over to the queue when
+						their amount reaches nEvents. If 0, the amount is not checked.
+
+	nOctets				The staged events of a thread are handed over to the queue when
+						their data reaches nOctets octets. If 0, the data size is not
+						checked.
+
+	msLatency			The maximum time in milliseconds an event stays in a staging
+						buffer. The separate logging thread also hands over the events of
+						threads that have stopped logging after this time. If 0, events
+						only leave the staging buffer of a thread when one of the other
+						limits is reached, when the thread logs an event that can't be
+						staged, when it exits, or when the target is shut down. A thread
+						that keeps logging checks the latency only every
+						CUNILOG_STAGING_CLOCK_EVENTS events.
+
+	Staging buffers are switched on if nEvents is greater than 1, or if nOctets or
+	msLatency are not 0. They are switched off if all three limits are 0, or if nEvents is 1
+	and the other two are 0.
+
+	Internal events, command events, and the shutdown event are not staged. The staged
+	events of a thread are handed over to the queue before such an event is enqueued, so
+	the events of a thread stay in order. ShutdownCUNILOG_TARGET () hands over the staged
+	events of all threads. Events logged after this are not staged anymore but enqueued
+	directly.
+
+	The function returns true on success. It returns false if the target doesn't have a
+	separate logging thread or the thread-local storage could not be created.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETstagingBuffers	(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETstagingBuffers)
+											(
+			CUNILOG_TARGET				*put,
+			size_t						nEvents,
+			size_t						nOctets,
+			unsigned int				msLatency
+											)
+	;
+#else
+	#define ConfigCUNILOG_TARGETstagingBuffers(put, nev, noct, ms)	\
+		(false)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETeventPool
+
+	Creates an event pool for the target put points to. Events of the target are then
+	taken from size classes for 128, 256, 512, 1024, and 4096 octets of caption and data
+	instead of being allocated on the heap, and returned to the free list of their size
+	class after they have been processed. Bigger events are still allocated on the heap.
+	The slots are carved from bulk memory blocks of stBulkSize octets. If stBulkSize is 0,
+	CUNILOG_STD_EVENTPOOL_SIZE is used. The memory of the pool is only deallocated when
+	the target is destroyed with DoneCUNILOG_TARGET ().
+
+	Events created with one of the CreateCUNILOG_EVENT_ () functions must be logged to
+	the same target, or at least to a target that is destroyed after it.
+
+	The function returns true on success, false if the pool could not be allocated.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETeventPool (CUNILOG_TARGET *put, size_t stBulkSize)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETeventPool) (CUNILOG_TARGET *put, size_t stBulkSize)
+	;
+#else
+	#define ConfigCUNILOG_TARGETeventPool(put, siz)	\
+		(false)
+#endif
+
+/*
+	getCUNILOG_EVENTPOOLstats
+
+	Fills the CUNILOG_EVENTPOOLSTATS structure pStats points to with the statistics of
+	the event pool of the target put points to. Neither parameter must be NULL.
+
+	The function returns false if the target doesn't have an event pool.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool getCUNILOG_EVENTPOOLstats (CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	;
+	TYPEDEF_FNCT_PTR (bool, getCUNILOG_EVENTPOOLstats)
+		(CUNILOG_EVENTPOOLSTATS *pStats, CUNILOG_TARGET *put)
+	;
+#else
+	#define getCUNILOG_EVENTPOOLstats(pstats, put)	\
+		(false)
+#endif
+
+/*
+	ConfigCUNILOG_TARGETcachedTimestamps
+
+	Lets the target put points to obtain the timestamps of its events from a cached
+	local time provider instead of calling LocalTime_UBF_TIMESTAMP () for every event.
+	The provider only reads a coarse wall clock per event. Date, time, and UTC offset
+	are recomputed once per second. See GetLocalTimeCached_UBF_TIMESTAMP () for details.
+	If the target can be used by several threads, its cache is protected by a locker.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETcachedTimestamps (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETcachedTimestamps) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETwriteBehind
+
+	Configures the write-behind buffer of the target put points to. Event lines for the
+	logfile are appended to the buffer instead of being written one by one, and the
+	buffer is written to the logfile with a single write operation. On POSIX the buffer
+	of the C runtime library is bypassed.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	nOctets				The size of the buffer in octets, for instance 64 KiB to 4 MiB.
+						The buffer is written when the next event line doesn't fit
+						anymore. An event line bigger than the buffer is written together
+						with the buffer. A value of 0 switches the write-behind buffer
+						off again.
+
+	msLatency			The maximum time in milliseconds an event line stays in the
+						buffer. A target with a separate logging thread writes the buffer
+						out after this time even if no further event arrives. Other targets
+						check this when the next event line is added. If 0, the age of
+						the data in the buffer is not checked.
+
+	policy				cunilogWriteBehindWhenFull or cunilogWriteBehindEveryBatch. See
+						enum cunilogwritebehind in cunilogstructs.h. The logfile is only
+						written to in batches with cunilogWriteBehindEveryBatch. Unlike
+						custom processors with a batch function (member procBatch of a
+						CUNILOG_CUSTPROCESS structure), the processor that writes to the
+						logfile has no batch mode of its own.
+
+	nSyncOctets			The logfile is synchronised to disk with fdatasync () (fsync () on
+						macOS, FlushFileBuffers () on Windows) after this many octets
+						have been written. If 0, this is left to the operating system.
+
+	Together the parameters decide how many event lines can be lost if the process or the
+	machine crashes. The buffer is also written before the logfile is closed or changed,
+	and when the target is shut down. A cunilogProcessFlushLogFile processor does not
+	write out the buffer. It only flushes what has been written already.
+
+	The function returns true on success, false if the buffer could not be allocated.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETwriteBehind	(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETwriteBehind)
+										(
+		CUNILOG_TARGET				*put,
+		size_t						nOctets,
+		unsigned int				msLatency,
+		cunilogwritebehind			policy,
+		uint64_t					nSyncOctets
+										)
+;
+
+/*
+	ConfigCUNILOG_TARGETrawLogfile
+
+	POSIX only. Opens the logfile of the target put points to as a raw file descriptor
+	with the flags CUNILOG_DEFAULT_RAW_OPEN_FLAGS (O_APPEND and O_CLOEXEC) instead of a
+	FILE stream. Event lines are then written with writev () directly from the event
+	line buffer, without the locking of the C runtime library and without being copied
+	into its buffer first. Every event line, or the content of the write-behind buffer,
+	is appended with a single system call. A cunilogProcessFlushLogFile processor has
+	nothing to flush for a raw logfile.
+
+	If the logfile is open already, it is closed and reopened when the next event is
+	written.
+
+	The function does nothing on Windows, where the logfile is always a raw file handle
+	opened with FILE_APPEND_DATA.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETrawLogfile (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETrawLogfile) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETioUring
+
+	Linux only. Writes the write-behind buffer of the target put points to asynchronously
+	through an io_uring instead of with writev (). While the kernel writes one buffer,
+	event lines are rendered into a second one of the same size, which means a separate
+	logging thread overlaps writing a batch of event lines with formatting the next one.
+	The datasync after nSyncOctets (see ConfigCUNILOG_TARGETwriteBehind ()) is linked to the
+	write and submitted together with it. At most one write is in flight at any time,
+	which keeps the event lines in order.
+
+	ConfigCUNILOG_TARGETwriteBehind () must have been called before. If it is called again
+	with a different buffer size, the second buffer is resized too. The function does
+	nothing for a memory-mapped logfile (see ConfigCUNILOG_TARGETmappedLogfile ()).
+
+	The function returns true if the target uses io_uring. It returns false if the kernel
+	doesn't provide io_uring, doesn't support IORING_OP_WRITE (Linux 5.6 and later), or
+	doesn't allow the process to use it, if the target has
+	no write-behind buffer, or if the build has no io_uring support. The write-behind
+	buffer is then written with writev () as before. The function always returns false
+	on other platforms than Linux, or if CUNILOG_BUILD_WITHOUT_IO_URING is defined.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETioUring (CUNILOG_TARGET *put)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETioUring) (CUNILOG_TARGET *put)
+;
+
+/*
+	ConfigCUNILOG_TARGETmappedLogfile
+
+	POSIX only. Writes event lines of the target put points to by copying them into a
+	shared memory mapping of the logfile instead of issuing a system call per event
+	line. The logfile is opened with CUNILOG_DEFAULT_MAPPED_OPEN_FLAGS. Its tail is
+	preallocated (posix_fallocate () on Linux, ftruncate () elsewhere) and mapped in
+	chunks of nChunk octets. A new chunk is preallocated and mapped when the current one
+	is full. When the logfile is closed, for instance because the date postfix of the
+	logfile name changes, the chunk is unmapped and the logfile is truncated to the
+	octets actually written.
+
+	nChunk is rounded up to a multiple of the page size. If nChunk is 0, the chunk size
+	is CUNILOG_DEFAULT_MAPPED_CHUNK_SIZE.
+
+	While the logfile is open, its size as seen by other processes includes the NUL
+	octets of the preallocated but not yet written part of the current chunk. If the
+	process terminates without closing the logfile, these NUL octets remain. They are
+	removed again the next time the logfile is opened by this function.
+
+	The function implies ConfigCUNILOG_TARGETrawLogfile (). The write-behind buffer
+	(see ConfigCUNILOG_TARGETwriteBehind ()) is copied into the mapping too but is not
+	required. A cunilogProcessFlushLogFile processor has nothing to flush. The kernel
+	writes the mapped pages back to disk by itself. Write-behind sync octets (parameter
+	nSyncOctets of ConfigCUNILOG_TARGETwriteBehind ()) are honoured with msync ().
+
+	If the logfile is open already, it is closed and reopened when the next event is
+	written.
+
+	The function does nothing on Windows.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+void ConfigCUNILOG_TARGETmappedLogfile (CUNILOG_TARGET *put, size_t nChunk)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETmappedLogfile) (CUNILOG_TARGET *put, size_t nChunk)
+;
+
+/*
+	ConfigCUNILOG_TARGETcompressedLogfile
+
+	Writes the logfile of the target put points to compressed. The event lines are
+	collected in the write-behind buffer, which is compressed into an independent frame
+	every time it is written out. With extcompressor_gzip every frame is a gzip member of
+	its own, with extcompressor_zstd a zstd frame with a checksum. A logfile that consists
+	of such frames is a valid gzip or zstd file and can be read with zcat, zstdcat, or
+	similar tools.
+
+	If the process or the machine crashes, at most the frame that is being written and the
+	event lines still waiting in the write-behind buffer are lost. Every frame before it
+	can still be decompressed. When the logfile is opened again, for instance after a
+	restart, the incomplete frame is cut off before new frames are appended. A logfile that
+	doesn't start with a frame of the compressor, like one that has been written
+	uncompressed before, is compressed into a single frame first. The logfile can then be
+	read with zcat or zstdcat again. See ExtCompressFramesRepairFile () in ExtCompressors.h.
+	Opening the logfile reads it once completely for this.
+
+	Parameters
+
+	put					A pointer to a CUNILOG_TARGET structure.
+
+	cmp					The compressor. See enum enextcompressor in ExtCompressors.h.
+
+	level				The compression level, or EXT_COMPRESSOR_DEFAULT_LEVEL for the
+						default level of the compressor.
+
+	nFrameOctets		The amount of uncompressed octets per frame. The write-behind
+						buffer is resized to this amount. If 0, the frame size is
+						CUNILOG_DEFAULT_COMPRESSED_FRAME_SIZE. Bigger frames compress
+						better, smaller ones lose less data in a crash.
+
+	The latency, policy, and sync octets of the write-behind buffer apply unchanged (see
+	ConfigCUNILOG_TARGETwriteBehind ()). Every time the buffer is written out a frame is
+	completed. A short latency or cunilogWriteBehindEveryBatch therefore creates many
+	small frames, which compress noticeably worse. An io_uring (see
+	ConfigCUNILOG_TARGETioUring ()) is not used for a compressed logfile. Switching the
+	write-behind buffer off with ConfigCUNILOG_TARGETwriteBehind () also switches
+	compression off.
+
+	The logfile keeps its name and the extension ".log", which the rotators rely on. The
+	decompression tools read the logfile regardless of its extension. Rotators with the
+	task cunilogrotationtask_ExtCompressLogfiles skip the logfiles of a target with a
+	compressed logfile.
+
+	The function returns true on success. It returns false if the compressor hasn't been
+	built in (see ExtCompressors.h) or if not enough memory is available. The logfile is
+	written uncompressed in this case, as before.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETcompressedLogfile	(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETcompressedLogfile)
+											(
+		CUNILOG_TARGET				*put,
+		enextcompressor				cmp,
+		int							level,
+		size_t						nFrameOctets
+											)
+;
+
+/*
+	ConfigCUNILOG_TARGETfilesListIndex
+
+	Keeps the list of logfiles the rotation processors of the target put points to work
+	on as a persistent index. Without the index, the logging folder is read and the list
+	of its logfiles is sorted again every time a rotator is triggered, which can take
+	several milliseconds on the logging thread if the folder contains many logfiles.
+
+	The index is built and sorted when a rotator is triggered for the first time. After
+	this, it is only updated with the changes cunilog makes itself: new logfiles, renamed
+	logfiles, and logfiles that are moved to the recycle bin or deleted. Logfiles that
+	are created, renamed, or deleted by other processes are therefore not noticed.
+
+	If bWatchFolder is true, the logging folder is additionally watched with inotify on
+	Linux. Each time a rotator is triggered, pending notifications for logfiles are applied
+	to the index before it is used. If the kernel's notification queue overflowed or the
+	logging folder has been moved or deleted, the index is built again from disk.
+
+	The function returns false if bWatchFolder is true but the logging folder cannot be
+	watched, for instance because the inotify instance limit of the user has been reached.
+	The index is kept nevertheless. It returns true otherwise. bWatchFolder is ignored
+	on other platforms than Linux and if CUNILOG_BUILD_WITHOUT_INOTIFY is defined, in which
+	case the function returns false if bWatchFolder is true.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETfilesListIndex (CUNILOG_TARGET *put, bool bWatchFolder)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETfilesListIndex) (CUNILOG_TARGET *put, bool bWatchFolder)
+;
+
+/*
+	ConfigCUNILOG_TARGETrotateAtSize
+
+	Sets the size in octets at which the active logfile of the target put points to is
+	rotated. The size is the actual size of the logfile on disk, including line endings,
+	event lines still waiting in the write-behind buffer, and the compressed frames of a
+	compressed logfile (see ConfigCUNILOG_TARGETcompressedLogfile ()). It is obtained
+	from the file system when the logfile is opened and kept up to date with every
+	event written.
+
+	Size-triggered rotation is only supported for targets with one of the dot number
+	postfixes, as the rotated logfiles of the other postfixes carry the timestamp of their
+	period, which would be identical for two rotations within the same period. With a
+	postfix of cunilogPostfixDotNumberSize, logfiles are only rotated by size, and
+	the size defaults to CUNILOG_DEFAULT_ROTATE_AT_SIZE. With any other dot number postfix
+	logfiles are rotated when their period has ended or when they reached nOctets,
+	whichever comes first. A rotation processor with the frequency
+	cunilogProcessAppliesTo_nOctets uses its own threshold instead of nOctets.
+
+	The size triggers the rotators of the target only once per logfile, with the event
+	that makes the logfile reach nOctets, or with the first event written to a logfile
+	that already exceeds it. A logfile that stays over nOctets, for instance because it
+	couldn't be renamed, is not rotated again with every subsequent event.
+
+	An nOctets of 0 switches size-triggered rotation off. If nOctets is not 0, the list of
+	logfiles is kept as an index (see ConfigCUNILOG_TARGETfilesListIndex ()), so that
+	the logging folder isn't read again for every rotation.
+
+	The function returns false if the target has not been created with a dot number
+	postfix, true otherwise.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called.
+*/
+bool ConfigCUNILOG_TARGETrotateAtSize (CUNILOG_TARGET *put, uint64_t nOctets)
+;
+TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETrotateAtSize) (CUNILOG_TARGET *put, uint64_t nOctets)
+;
+
+/*
+	ConfigCUNILOG_TARGETmaintenanceThread
+
+	Starts a maintenance thread for the target put points to. Rotators of the target with
+	the tasks cunilogrotationtask_FScompressLogfiles, cunilogrotationtask_MoveToRecycleBinLogfiles,
+	and cunilogrotationtask_DeleteLogfiles then hand the logfiles they would otherwise process
+	themselves over to this thread as jobs and return straight away. Events continue to be
+	written to the active logfile while the jobs are carried out. Renaming logfiles is never
+	handed over because it includes the active logfile.
+
+	Rotators with the task cunilogrotationtask_ExtCompressLogfiles start the maintenance
+	thread themselves the first time they're triggered if it hasn't been started yet,
+	since compressing a logfile can take a while.
+
+	The messages of the jobs are logged in the order they have been created by the thread
+	that processes the events of the target. This happens before the next event is written,
+	or when the target is shut down with ShutdownCUNILOG_TARGET () or CancelCUNILOG_TARGET (),
+	which both wait for the maintenance thread to finish its remaining jobs first. Messages
+	not logged yet are discarded by DoneCUNILOG_TARGET ().
+
+	A rotator still waits for the jobs of earlier rotations to be done before it renames
+	dot number logfiles, and before it reads the logging folder, which it doesn't need to
+	with ConfigCUNILOG_TARGETfilesListIndex (). With the usual rotation frequencies of an
+	hour or more, the jobs are long done by then.
+
+	Logfiles that are moved to the recycle bin or deleted are removed from the list of
+	logfiles when they are handed over. If the maintenance thread cannot remove a logfile,
+	the list is read from disk again the next time a rotator is triggered.
+
+	The function returns true on success, false if the maintenance thread could not be
+	created.
+
+	This function should only be called directly after the target has been initialised and
+	before any of the logging functions has been called. It is not available if
+	CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool ConfigCUNILOG_TARGETmaintenanceThread (CUNILOG_TARGET *put)
+	;
+	TYPEDEF_FNCT_PTR (bool, ConfigCUNILOG_TARGETmaintenanceThread) (CUNILOG_TARGET *put)
+	;
+#else
+	#define ConfigCUNILOG_TARGETmaintenanceThread(put)	\
+		(false)
+#endif
+
 /*
 	ConfigCUNILOG_TARGETprocessorList
 
@@ -1283,11 +1929,72 @@ CUNILOG_PROCESSOR *GetCUNILOG_PROCESSORrotationTask	(
 				prepareProcessors (put, cuProcessorList, nProcessors)
 #endif
 
+/*
+	ConfigCUNILOG_PROCESSORfilter
+
+	Sets the severities and event types the processor cup points to processes. Events
+	with other severities or types skip the processor, as if it was disabled for them
+	(see OPT_CUNPROC_DISABLED), and carry on with the next processor. Skipped events
+	don't count towards the processor's threshold either.
+
+	Parameters
+
+	cup					A pointer to the CUNILOG_PROCESSOR structure.
+
+	uiSeverities		A bit mask of the severities the processor processes. The bit
+						CUNILOG_SEVERITY_BIT (sev) stands for the severity sev. Use
+						CUNILOG_SEVERITY_MASK_ALL for all severities, or obtain a mask with
+						cunilogSeverityMaskFromMin ().
+
+	uiEvtTypes			A bit mask of the event types the processor processes. The bit
+						CUNILOG_EVTTYPE_BIT (t) stands for the event type t.
+						CUNILOG_EVTTYPES_TEXT are text events, CUNILOG_EVTTYPES_HEXDUMP
+						hex dumps, and CUNILOG_EVTTYPES_ALL are all event types. Command
+						events are carried out before any processor runs, hence they're not
+						affected.
+
+	Processors initialised with the CUNILOG_INIT_DEF_ macros or FillCUNILOG_PROCESSOR ()
+	process all severities and types. For instance, to only echo warnings and more
+	important events to the console while still writing everything to the logfile:
+
+	CUNILOG_PROCESSOR cpEcho = CUNILOG_INIT_DEF_ECHO_PROCESSOR;
+	ConfigCUNILOG_PROCESSORfilter	(
+		&cpEcho, cunilogSeverityMaskFromMin (cunilogEvtSeverityWarning),
+		CUNILOG_EVTTYPES_ALL
+									);
+
+	The function should be called before the processor is handed over to a target, or
+	while the target is paused.
+*/
+void ConfigCUNILOG_PROCESSORfilter	(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+;
+TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_PROCESSORfilter)
+									(
+		CUNILOG_PROCESSOR			*cup,
+		uint32_t					uiSeverities,
+		uint32_t					uiEvtTypes
+									)
+;
+
 /*
 	ConfigCUNILOG_TARGETdisableTaskProcessors
 	ConfigCUNILOG_TARGETenableTaskProcessors
 
-	Disables/enables processors for task task.
+	Disables/enables processors for task task. The processor plan of the target is
+	compiled again, which leaves out disabled processors.
+
+	If the target has a separate logging thread, the change is queued as a command event
+	instead (see ChangeCUNILOG_TARGETdisableTaskProcessors ()). It takes effect for the
+	events logged after the call. If CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS is defined, the
+	functions must not be called while the separate logging thread processes events.
+
+	The flag OPT_CUNPROC_DISABLED of a processor that belongs to a target must not be set or
+	cleared directly. A direct change is ignored until the plan is compiled again, and
+	debug versions assert when they come across a disabled processor in the plan.
 */
 void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
 void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
@@ -1302,7 +2009,8 @@ TYPEDEF_FNCT_PTR (void, ConfigCUNILOG_TARGETenableTaskProcessors)
 	ConfigCUNILOG_TARGETenableEchoProcessor
 
 	Disables/enables echo (console output) processors. Echo or console output processors
-	are processors whose task is cunilogProcessEchoToConsole.
+	are processors whose task is cunilogProcessEchoToConsole. See
+	ConfigCUNILOG_TARGETdisableTaskProcessors ().
 */
 void ConfigCUNILOG_TARGETdisableEchoProcessor	(CUNILOG_TARGET *put);
 void ConfigCUNILOG_TARGETenableEchoProcessor	(CUNILOG_TARGET *put);
@@ -1735,13 +2443,18 @@ TYPEDEF_FNCT_PTR (bool, logEv) (CUNILOG_TARGET *put, CUNILOG_EVENT *pev);
 	to a buffer provided by the caller like standard library functions vsnprintf () and family
 	would.
 
-	The fmt versions offer variadic functionality like printf () does. The function
-	logTextU8fmt () uses an additional memory allocation and deallocation internally. The sfmt
-	type functions like logTextU8sfmt () attempt to use the stack for the fmt output if less
-	than CUNILOG_DEFAULT_SFMT_SIZE bytes are required. Otherwise the heap is used.
+	The fmt versions offer variadic functionality like printf () does. They format the output
+	into a stack buffer of CUNILOG_DEFAULT_SFMT_SIZE octets first. If the output doesn't fit,
+	it is formatted a second time directly into the event's data area. No additional heap
+	buffer is required. The sfmt type functions like logTextU8sfmt () are identical to their
+	fmt counterparts and only exist for compatibility.
 	
 	Function names containing a "q" (for quick) do not invoke any rotation processors.
 
+	Function names containing a "d" (for deferred) only capture the format string and the
+	arguments. The text is rendered on the separate logging thread when the event line is
+	created. See logTextU8dfmt () below.
+
 	The functions logTextU8smbfmtsev () and logTextU8smbfmt () additionally expect an
 	initialised parameter structure of type SMEMBUF. The SMEMBUF structure can be re-used
 	for consecutive calls. Within the same thread this can save memory allocations if the
@@ -1857,6 +2570,248 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 #define logTextU8csfmtsev_static(s, ...)				\
 										logTextU8csfmtsev	(pCUNILOG_TARGETstatic, (s), __VA_ARGS__);
 
+/*
+	logVerboseU8l				logVerboseU8fmt
+	logDetailU8l				logDetailU8fmt
+	logTraceU8l					logTraceU8fmt
+	logDebugU8l					logDebugU8fmt
+	logInfoU8l					logInfoU8fmt
+	logNoticeU8l				logNoticeU8fmt
+	logMessageU8l				logMessageU8fmt
+	logWarningU8l				logWarningU8fmt
+	logErrorU8l					logErrorU8fmt
+	logCriticalU8l				logCriticalU8fmt
+	logFatalU8l					logFatalU8fmt
+	logEmergencyU8l				logEmergencyU8fmt
+
+	Macros over logTextU8sevl () and logTextU8sfmtsev () with the severity in their names.
+	The _static versions use the module's internal static CUNILOG_TARGET structure.
+
+	A macro whose severity rank (see CUNILOG_SEVRANK_VERBOSE and friends) is below
+	CUNILOG_COMPILE_MIN_SEVERITY expands to nothing but ((void) 0). Its arguments are
+	not evaluated then, which makes a compiled-out call free. This happens at compile
+	time and is independent of ConfigCUNILOG_TARGETminSeverity () and
+	ConfigCUNILOG_TARGETseverityMask (), which filter at runtime.
+
+	To behave the same in both cases, the macros have no value. Call logTextU8sevl () or
+	logTextU8sfmtsev () directly if the return value is needed.
+*/
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_VERBOSE
+	#define logVerboseU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityVerbose, (t), (l)))
+	#define logVerboseU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityVerbose, __VA_ARGS__))
+	#define logVerboseU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityVerbose, (t), (l)))
+	#define logVerboseU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityVerbose, __VA_ARGS__))
+#else
+	#define logVerboseU8l(p, t, l)				((void) 0)
+	#define logVerboseU8fmt(p, ...)				((void) 0)
+	#define logVerboseU8l_static(t, l)			((void) 0)
+	#define logVerboseU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_DETAIL
+	#define logDetailU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityDetail, (t), (l)))
+	#define logDetailU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityDetail, __VA_ARGS__))
+	#define logDetailU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityDetail, (t), (l)))
+	#define logDetailU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityDetail, __VA_ARGS__))
+#else
+	#define logDetailU8l(p, t, l)				((void) 0)
+	#define logDetailU8fmt(p, ...)				((void) 0)
+	#define logDetailU8l_static(t, l)			((void) 0)
+	#define logDetailU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_TRACE
+	#define logTraceU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityTrace, (t), (l)))
+	#define logTraceU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityTrace, __VA_ARGS__))
+	#define logTraceU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityTrace, (t), (l)))
+	#define logTraceU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityTrace, __VA_ARGS__))
+#else
+	#define logTraceU8l(p, t, l)				((void) 0)
+	#define logTraceU8fmt(p, ...)				((void) 0)
+	#define logTraceU8l_static(t, l)			((void) 0)
+	#define logTraceU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_DEBUG
+	#define logDebugU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityDebug, (t), (l)))
+	#define logDebugU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityDebug, __VA_ARGS__))
+	#define logDebugU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityDebug, (t), (l)))
+	#define logDebugU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityDebug, __VA_ARGS__))
+#else
+	#define logDebugU8l(p, t, l)				((void) 0)
+	#define logDebugU8fmt(p, ...)				((void) 0)
+	#define logDebugU8l_static(t, l)			((void) 0)
+	#define logDebugU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_INFO
+	#define logInfoU8l(p, t, l)					\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityInfo, (t), (l)))
+	#define logInfoU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityInfo, __VA_ARGS__))
+	#define logInfoU8l_static(t, l)				\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityInfo, (t), (l)))
+	#define logInfoU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityInfo, __VA_ARGS__))
+#else
+	#define logInfoU8l(p, t, l)					((void) 0)
+	#define logInfoU8fmt(p, ...)				((void) 0)
+	#define logInfoU8l_static(t, l)				((void) 0)
+	#define logInfoU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_NOTICE
+	#define logNoticeU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityNotice, (t), (l)))
+	#define logNoticeU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityNotice, __VA_ARGS__))
+	#define logNoticeU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityNotice, (t), (l)))
+	#define logNoticeU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityNotice, __VA_ARGS__))
+#else
+	#define logNoticeU8l(p, t, l)				((void) 0)
+	#define logNoticeU8fmt(p, ...)				((void) 0)
+	#define logNoticeU8l_static(t, l)			((void) 0)
+	#define logNoticeU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_NOTICE
+	#define logMessageU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityMessage, (t), (l)))
+	#define logMessageU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityMessage, __VA_ARGS__))
+	#define logMessageU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityMessage, (t), (l)))
+	#define logMessageU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityMessage, __VA_ARGS__))
+#else
+	#define logMessageU8l(p, t, l)				((void) 0)
+	#define logMessageU8fmt(p, ...)				((void) 0)
+	#define logMessageU8l_static(t, l)			((void) 0)
+	#define logMessageU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_WARNING
+	#define logWarningU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityWarning, (t), (l)))
+	#define logWarningU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityWarning, __VA_ARGS__))
+	#define logWarningU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityWarning, (t), (l)))
+	#define logWarningU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityWarning, __VA_ARGS__))
+#else
+	#define logWarningU8l(p, t, l)				((void) 0)
+	#define logWarningU8fmt(p, ...)				((void) 0)
+	#define logWarningU8l_static(t, l)			((void) 0)
+	#define logWarningU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_ERROR
+	#define logErrorU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityError, (t), (l)))
+	#define logErrorU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityError, __VA_ARGS__))
+	#define logErrorU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityError, (t), (l)))
+	#define logErrorU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityError, __VA_ARGS__))
+#else
+	#define logErrorU8l(p, t, l)				((void) 0)
+	#define logErrorU8fmt(p, ...)				((void) 0)
+	#define logErrorU8l_static(t, l)			((void) 0)
+	#define logErrorU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_CRITICAL
+	#define logCriticalU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityCritical, (t), (l)))
+	#define logCriticalU8fmt(p, ...)			\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityCritical, __VA_ARGS__))
+	#define logCriticalU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityCritical, (t), (l)))
+	#define logCriticalU8fmt_static(...)		\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityCritical, __VA_ARGS__))
+#else
+	#define logCriticalU8l(p, t, l)				((void) 0)
+	#define logCriticalU8fmt(p, ...)			((void) 0)
+	#define logCriticalU8l_static(t, l)			((void) 0)
+	#define logCriticalU8fmt_static(...)		((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_FATAL
+	#define logFatalU8l(p, t, l)				\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityFatal, (t), (l)))
+	#define logFatalU8fmt(p, ...)				\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityFatal, __VA_ARGS__))
+	#define logFatalU8l_static(t, l)			\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityFatal, (t), (l)))
+	#define logFatalU8fmt_static(...)			\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityFatal, __VA_ARGS__))
+#else
+	#define logFatalU8l(p, t, l)				((void) 0)
+	#define logFatalU8fmt(p, ...)				((void) 0)
+	#define logFatalU8l_static(t, l)			((void) 0)
+	#define logFatalU8fmt_static(...)			((void) 0)
+#endif
+#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_EMERGENCY
+	#define logEmergencyU8l(p, t, l)			\
+				((void) logTextU8sevl ((p), cunilogEvtSeverityEmergency, (t), (l)))
+	#define logEmergencyU8fmt(p, ...)			\
+				((void) logTextU8sfmtsev ((p), cunilogEvtSeverityEmergency, __VA_ARGS__))
+	#define logEmergencyU8l_static(t, l)		\
+				((void) logTextU8sevl (pCUNILOG_TARGETstatic, cunilogEvtSeverityEmergency, (t), (l)))
+	#define logEmergencyU8fmt_static(...)		\
+				((void) logTextU8sfmtsev (pCUNILOG_TARGETstatic, cunilogEvtSeverityEmergency, __VA_ARGS__))
+#else
+	#define logEmergencyU8l(p, t, l)			((void) 0)
+	#define logEmergencyU8fmt(p, ...)			((void) 0)
+	#define logEmergencyU8l_static(t, l)		((void) 0)
+	#define logEmergencyU8fmt_static(...)		((void) 0)
+#endif
+
+/*
+	logTextU8dvfmtsev
+	logTextU8dfmtsev
+	logTextU8dvfmt
+	logTextU8dfmt
+
+	Deferred formatting. Instead of formatting the text in the caller's thread, these
+	functions only store a copy of the format string fmt and a compact binary record of
+	the argument values in the event. The text is rendered when the event line is
+	created, which happens on the separate logging thread. This moves the cost of
+	printf ()-style formatting off the caller.
+
+	The format string and string arguments (%s) are copied. Neither of them needs to
+	outlive the call.
+
+	Supported are the conversion specifiers d, i, u, o, x, X, c, s, p, f, F, e, E, g, G, a,
+	and A, with the flags "-+ #0", width and precision (both also as '*'), and the length
+	modifiers hh, h, l, ll, j, z, and t for integers. If fmt contains anything else, for
+	instance %n, long double (%Lf), wide characters or strings (%lc, %ls), or positional
+	arguments, or if the target doesn't have a separate logging thread, the functions fall
+	back to immediate formatting like logTextU8vfmt () and logTextU8fmt ().
+
+	The functions return true on success, false otherwise.
+*/
+bool logTextU8dvfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, va_list ap);
+bool logTextU8dfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *fmt, ...);
+bool logTextU8dvfmt			(CUNILOG_TARGET *put, const char *fmt, va_list ap);
+bool logTextU8dfmt			(CUNILOG_TARGET *put, const char *fmt, ...);
+
+#define logTextU8dvfmtsev_static(s, t, ap)				\
+										logTextU8dvfmtsev	(pCUNILOG_TARGETstatic, (s), (t), (ap))
+#define logTextU8dfmtsev_static(s, ...)	logTextU8dfmtsev	(pCUNILOG_TARGETstatic, (s), __VA_ARGS__)
+#define logTextU8dvfmt_static(t, ap)	logTextU8dvfmt		(pCUNILOG_TARGETstatic, (t), (ap))
+#define logTextU8dfmt_static(...)		logTextU8dfmt		(pCUNILOG_TARGETstatic, __VA_ARGS__)
+
 /*
 	ChangeCUNILOG_TARGETuseColourForEcho
 	ChangeCUNILOG_TARGETuseColorForEcho
@@ -2016,6 +2971,36 @@ bool logTextU8csfmtsev		(CUNILOG_TARGET *put, cueventseverity sev, const char *f
 bool CunilogChangeCurrentThreadPriority (cunilogprio prio);
 TYPEDEF_FNCT_PTR (bool, CunilogChangeCurrentThreadPriority) (cunilogprio prio);
 
+/*
+	cunilogSetCompressionLimits
+
+	Limits the CPU time maintenance threads spend on compressing logfiles with rotators
+	that have the task cunilogrotationtask_ExtCompressLogfiles. The limits apply to all
+	targets of the process.
+
+	A maintenance thread changes its priority to prio before it compresses a logfile,
+	and keeps this priority afterwards. On POSIX, the priority is applied as a nice value
+	(see table icuPsxPrioTable in the code file). Without the required privileges, a
+	priority once lowered can't be raised again.
+
+	Not more than nMaxParallel logfiles are compressed at the same time. Maintenance
+	threads that would exceed this amount wait until another compression has finished.
+	A value of 0 for nMaxParallel removes the limit.
+
+	The defaults are CUNILOG_DEFAULT_COMPRESSION_PRIORITY and
+	CUNILOG_DEFAULT_MAX_PARALLEL_COMPRESSIONS. The limits don't apply to logfiles that are
+	compressed by rotators directly, i.e. if CUNILOG_BUILD_SINGLE_THREADED_ONLY is defined,
+	in which case this is a macro that evaluates to true.
+
+	The function returns false if prio is invalid, true otherwise.
+*/
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	bool cunilogSetCompressionLimits (cunilogprio prio, unsigned int nMaxParallel);
+	TYPEDEF_FNCT_PTR (bool, cunilogSetCompressionLimits) (cunilogprio prio, unsigned int nMaxParallel);
+#else
+	#define cunilogSetCompressionLimits(prio, nMaxParallel) (true)
+#endif
+
 /*
 	cunilogSetDefaultPrintEventSeverityFormatType
 
@@ -117,6 +117,8 @@ When		Who				What
 #define CUNILOG_ERROR_APPNAME						(8)
 #define CUNILOG_ERROR_SEPARATE_LOGGING_THREAD		(9)
 #define CUNILOG_ERROR_RENAMING_LOGFILE				(10)
+#define CUNILOG_ERROR_THREAD_LOCAL_STORAGE			(11)
+#define CUNILOG_ERROR_MAINTENANCE_THREAD			(12)
 
 #define CUNILOG_ERROR_FIRST_UNUSED_ERROR			(5000)
 
@@ -65,6 +65,11 @@ When		Who				What
 #ifdef PLATFORM_IS_POSIX
 	#include <pthread.h>
 #endif
+#ifdef OS_IS_LINUX
+	#include <unistd.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+#endif
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_COMMANDS
 
@@ -147,12 +152,11 @@ void culCmdStoreCmdConfigCunilognewline (unsigned char *szOut, newline_t nl)
 }
 
 /*
-	These declarations are from cunilog.h. They are defined in cunilog.c.
+	This declaration is from cunilog.c, where the function is defined. The functions
+	ConfigCUNILOG_TARGETdisableTaskProcessors () and friends from cunilog.h would queue
+	another command event.
 */
-void ConfigCUNILOG_TARGETdisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
-void ConfigCUNILOG_TARGETenableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task);
-void ConfigCUNILOG_TARGETdisableEchoProcessor (CUNILOG_TARGET *put);
-void ConfigCUNILOG_TARGETenableEchoProcessor (CUNILOG_TARGET *put);
+void cunilogDisableTaskProcessors (CUNILOG_TARGET *put, enum cunilogprocesstask task, bool bDisable);
 
 void culCmdStoreCmdConfigDisableTaskProcessors (unsigned char *szOut, enum cunilogprocesstask task)
 {
@@ -178,7 +182,7 @@ void culCmdConfigDisableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDa
 	ubf_assert (0 <= task);
 	ubf_assert (task < cunilogProcessXAmountEnumValues);
 
-	ConfigCUNILOG_TARGETdisableTaskProcessors (put, task);
+	cunilogDisableTaskProcessors (put, task, true);
 }
 
 void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szData)
@@ -189,7 +193,7 @@ void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDat
 	ubf_assert (0 <= task);
 	ubf_assert (task < cunilogProcessXAmountEnumValues);
 
-	ConfigCUNILOG_TARGETenableTaskProcessors (put, task);
+	cunilogDisableTaskProcessors (put, task, false);
 }
 
 #ifndef CUNILOG_BUILD_WITHOUT_EVENT_SEVERITY_TYPE
@@ -233,6 +237,13 @@ void culCmdConfigEnableTaskProcessors (CUNILOG_TARGET *put, unsigned char *szDat
 		HANDLE hThread = GetCurrentThread ();
 		return SetThreadPriority (hThread, prio);
 	}
+#elif defined (OS_IS_LINUX)
+	static bool SetPsxCurrThreadPriority (int prio)
+	{	// On Linux, the nice value is a per-thread attribute. The static priority that
+		//	pthread_setschedprio () changes must be 0 with the default scheduling policy.
+		//	See https://man7.org/linux/man-pages/man2/setpriority.2.html .
+		return 0 == setpriority (PRIO_PROCESS, (id_t) syscall (SYS_gettid), prio);
+	}
 #else
 	static bool SetPsxCurrThreadPriority (int prio)
 	{	// See https://man7.org/linux/man-pages/man3/pthread_setschedprio.3.html .
@@ -316,10 +327,10 @@ void culCmdChangeCmdConfigFromCommand (CUNILOG_EVENT *pev)
 			culCmdConfigEnableTaskProcessors (put, szData);
 			break;
 		case cunilogCmdConfigDisableEchoProcessor:
-			ConfigCUNILOG_TARGETdisableEchoProcessor (put);
+			cunilogDisableTaskProcessors (put, cunilogProcessEchoToConsole, true);
 			break;
 		case cunilogCmdConfigEnableEchoProcessor:
-			ConfigCUNILOG_TARGETenableEchoProcessor (put);
+			cunilogDisableTaskProcessors (put, cunilogProcessEchoToConsole, false);
 			break;
 		case cunilogCmdConfigSetLogPriority:
 			culCmdConfigSetLogPriority (szData);
@@ -97,6 +97,28 @@ When		Who				What
 	#endif
 #endif
 
+/*
+	io_uring for writing out the write-behind buffer on Linux.
+	See ConfigCUNILOG_TARGETioUring (). Define CUNILOG_BUILD_WITHOUT_IO_URING if the
+	kernel headers are too old to provide <linux/io_uring.h>.
+*/
+#if defined (OS_IS_LINUX) && !defined (CUNILOG_BUILD_WITHOUT_IO_URING)
+	#ifndef CUNILOG_HAVE_IO_URING
+	#define CUNILOG_HAVE_IO_URING
+	#endif
+#endif
+
+/*
+	inotify for keeping the files list index in sync with changes to the logging folder
+	made by other processes on Linux. See ConfigCUNILOG_TARGETfilesListIndex ().
+	Define CUNILOG_BUILD_WITHOUT_INOTIFY to build without it.
+*/
+#if defined (OS_IS_LINUX) && !defined (CUNILOG_BUILD_WITHOUT_INOTIFY)
+	#ifndef CUNILOG_HAVE_INOTIFY
+	#define CUNILOG_HAVE_INOTIFY
+	#endif
+#endif
+
 /*
 	Build options.
 
@@ -278,6 +300,10 @@ enum cunilogpostfix
 	,	cunilogPostfixDotNumberWeekly
 	,	cunilogPostfixDotNumberMonthly
 	,	cunilogPostfixDotNumberYearly
+	,	cunilogPostfixDotNumberSize							// ".<number>", rotation only when
+															//	the active logfile has reached
+															//	a certain size. See
+															//	ConfigCUNILOG_TARGETrotateAtSize ().
 	// Do not add anything below this line.
 	,	cunilogPostfixAmountEnumValues						// Used for table sizes.
 	// Do not add anything below cunilogPostfixAmountEnumValues.
@@ -358,7 +384,8 @@ enum cunilogprocessfrequency
 		cunilogProcessAppliesTo_nEvents						// Threshold is incremented for
 															//	each event.
 	,	cunilogProcessAppliesTo_nOctets						// Threshold counts the amount of
-															//	octets logged.
+															//	octets logged. For rotators,
+															//	the size of the active logfile.
 	,	cunilogProcessAppliesTo_nAlways						// Threshold does not apply; always
 															//	processed.
 	,	cunilogProcessAppliesTo_SecondChanged				// Processed whenever the second
@@ -393,6 +420,10 @@ typedef struct cunilog_processor
 	void							*pData;					// Pointer to processor-specific data.
 	uint64_t						uiOpts;					// Option flags. See OPT_CUNPROC_
 															//	definitions below.
+	uint32_t						uiSkipSeverities;		// Severities the processor skips.
+															//	See CUNILOG_SEVERITY_BIT ().
+	uint32_t						uiSkipEvtTypes;			// Event types the processor skips.
+															//	See CUNILOG_EVTTYPE_BIT ().
 } CUNILOG_PROCESSOR;
 
 /*
@@ -414,6 +445,13 @@ typedef struct cunilog_processor
 															//	Carries on with the next processor
 															//	unconditionally, just like
 															//	OPT_CUNPROC_FORCE_NEXT.
+															//	Once the processor belongs to a
+															//	target, only change it with
+															//	ConfigCUNILOG_TARGETdisable/
+															//	enableTaskProcessors (), which
+															//	compile the processor plan of
+															//	the target again. Never set or
+															//	clear it directly then.
 
 /*
 	Macros for some flags.
@@ -421,6 +459,8 @@ typedef struct cunilog_processor
 
 #define optCunProcHasOPT_CUNPROC_AT_STARTUP(v)			\
 	((v) & OPT_CUNPROC_AT_STARTUP)
+#define optCunProcSetOPT_CUNPROC_AT_STARTUP(v)			\
+	((v) |= OPT_CUNPROC_AT_STARTUP)
 #define optCunProcClrOPT_CUNPROC_AT_STARTUP(v)			\
 	((v) &= ~ OPT_CUNPROC_AT_STARTUP)
 
@@ -441,9 +481,114 @@ typedef struct cunilog_logfile
 		HANDLE			hLogFile;
 	#else
 		FILE			*fLogFile;
+		int				fdLogFile;							// Raw file descriptor or -1.
+															//	See CUNILOGTARGET_RAW_LOGFILE.
+		// See CUNILOGTARGET_MAPPED_LOGFILE.
+		char			*pMap;								// The mapped tail of the logfile or NULL.
+		size_t			lnMap;								// Length of the mapping.
+		size_t			ofsMap;								// Write position within the mapping.
+		uint64_t		ullMapBase;							// File offset of the mapping.
+		size_t			lnMapChunk;							// Octets mapped/preallocated at once.
 	#endif
+	uint64_t			ullSize;							// Size of the logfile in octets,
+															//	including octets that are still
+															//	buffered.
+	uint64_t			ullSizeEvt;							// ullSize after the current event
+															//	has been written. Compared by
+															//	rotators. See
+															//	ConfigCUNILOG_TARGETrotateAtSize ().
+	uint64_t			ullSizePrv;							// ullSizeEvt of the previous event
+															//	written to the same logfile,
+															//	or 0.
+	bool				bSizeUnseen;						// No event that triggers rotators
+															//	has been written to the logfile
+															//	since it was opened.
 } CUNILOG_LOGFILE;
 
+/*
+	When the data in the write-behind buffer of a target is written to its logfile, apart
+	from the buffer being full, the maximum latency being exceeded, or the logfile being
+	flushed or closed.
+
+	cunilogWriteBehindWhenFull		Only the conditions above. This gives the highest
+									throughput, but up to a full buffer of event lines
+									is lost if the process crashes.
+
+	cunilogWriteBehindEveryBatch	Additionally whenever the separate logging thread has
+									processed all events it took off the queue. Without
+									a separate logging thread this is identical to
+									cunilogWriteBehindWhenFull.
+*/
+enum cunilogwritebehind
+{
+		cunilogWriteBehindWhenFull
+	,	cunilogWriteBehindEveryBatch
+	// Do not add anything below this line.
+	,	cunilogWriteBehindAmountEnumValues					// Used for table sizes.
+	// Do not add anything below cunilogWriteBehindAmountEnumValues.
+};
+typedef enum cunilogwritebehind cunilogwritebehind;
+
+/*
+	CUNILOG_WRITEBEHIND
+
+	The write-behind buffer of a target. Event lines are appended to the buffer, which is
+	written to the logfile with a single write operation. See
+	ConfigCUNILOG_TARGETwriteBehind () in cunilog.h.
+*/
+/*
+	The io_uring instance of a target's write-behind buffer. The rings are shared with
+	the kernel. See ConfigCUNILOG_TARGETioUring ().
+*/
+#ifdef CUNILOG_HAVE_IO_URING
+	typedef struct cunilog_iouring
+	{
+		int							fdRing;					// The io_uring, or -1.
+		void						*pSQ;					// Mapped submission queue ring.
+		size_t						lnSQ;
+		void						*pCQ;					// Mapped completion queue ring.
+		size_t						lnCQ;					//	0 if it shares pSQ.
+		struct io_uring_sqe			*sqes;					// Mapped submission queue entries.
+		size_t						lnSQEs;
+		unsigned int				*sqHead;
+		unsigned int				*sqTail;
+		unsigned int				*sqMask;
+		unsigned int				*sqArray;
+		unsigned int				*cqHead;
+		unsigned int				*cqTail;
+		unsigned int				*cqMask;
+		struct io_uring_cqe			*cqes;
+		char						*buf;					// Buffer in flight.
+		size_t						siz;					// Size of buf in octets.
+		size_t						len;					// Octets in flight.
+		unsigned int				nInFlight;				// Pending completions.
+		bool						bSyncInFlight;			// A datasync is pending.
+	} CUNILOG_IOURING;
+#endif
+
+typedef struct cunilog_writebehind
+{
+	char							*buf;					// The buffer, or NULL if the
+															//	target has none.
+	size_t							siz;					// Size of buf in octets.
+	size_t							len;					// Octets waiting in buf.
+	uint64_t						ullFirst;				// When the oldest octet in buf
+															//	has been added.
+	uint64_t						ullLatency;				// Maximum age of octets in buf
+															//	in FILETIME units.
+	cunilogwritebehind				policy;					// When to write buf.
+	uint64_t						nSyncOctets;			// Sync the logfile after this
+															//	amount of octets, or 0.
+	uint64_t						nUnsynced;				// Octets not synced yet.
+	size_t							nWrites;				// Write operations.
+	struct extcmpframer				*pfr;					// Compresses buf into a frame
+															//	before it is written, or
+															//	NULL. See ExtCompressors.h.
+	#ifdef CUNILOG_HAVE_IO_URING
+		CUNILOG_IOURING				ur;						// Writes buf asynchronously.
+	#endif
+} CUNILOG_WRITEBEHIND;
+
 /*
 	Note that
 	cunilogrotationtask_MoveToTrashLogfiles			and
@@ -459,6 +604,9 @@ enum cunilogrotationtask
 	,	cunilogrotationtask_MoveToTrashLogfiles
 	,	cunilogrotationtask_MoveToRecycleBinLogfiles = cunilogrotationtask_MoveToTrashLogfiles
 	,	cunilogrotationtask_DeleteLogfiles
+	,	cunilogrotationtask_ExtCompressLogfiles				// Compress logfiles into new files
+															//	with gzip or zstd and delete
+															//	them. See ExtCompressors.h.
 
 	// Do not add anything below this line.
 	,	cunilogrotationtask_XAmountEnumValues				// Used for table sizes.
@@ -490,6 +638,15 @@ typedef struct cunilog_rotation_data
 															//	target is logged to, without
 															//	rotation.
 	uint64_t					uiFlgs;						// Option flags. See below.
+
+	// Retention policy. See CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN ().
+	uint64_t					ullKeepOctets;				// Total size of the logfiles to
+															//	keep. Ignored when 0.
+	uint64_t					ullKeepSeconds;				// Maximum age of a logfile to keep.
+															//	Ignored when 0.
+	uint64_t					nRetainBatch;				// Don't rotate more than this per
+															//	event that triggers the
+															//	rotator. Ignored when 0.
 } CUNILOG_ROTATION_DATA;
 
 /*
@@ -508,6 +665,10 @@ typedef struct cunilog_rotation_data
 //	member mbFilToRotate of the CUNILOG_TARGET structure
 #define CUNILOG_ROTATOR_FLAG_USE_MBDSTFILE		SINGLEBIT64 (2)
 
+// A rotator with the task cunilogrotationtask_ExtCompressLogfiles compresses with zstd
+//	(".zst") instead of gzip (".gz").
+#define CUNILOG_ROTATOR_FLAG_ZSTD				SINGLEBIT64 (3)
+
 /*
 	Macros for checking, setting, and clearing some of the flags above.
 */
@@ -525,6 +686,10 @@ typedef struct cunilog_rotation_data
 #define cunilogClrRotatorFlag_USE_MBDSTFILE(prd)		\
 	((prd)->uiFlgs &= ~ CUNILOG_ROTATOR_FLAG_USE_MBDSTFILE)
 
+// True if the rotator has a retention policy by size or age.
+#define cunilogHasRotatorRetention(prd)					\
+	((prd)->ullKeepOctets || (prd)->ullKeepSeconds)
+
 
 // Value of member nMaxToRotate of a CUNILOG_ROTATION_DATA structure to be obtained
 //	during initialisation.
@@ -532,6 +697,12 @@ typedef struct cunilog_rotation_data
 #define CUNILOG_MAX_ROTATE_AUTO			(UINT64_MAX)
 #endif
 
+// Default value of member nRetainBatch of a CUNILOG_ROTATION_DATA structure with a
+//	retention policy.
+#ifndef CUNILOG_DEFAULT_RETAIN_BATCH
+#define CUNILOG_DEFAULT_RETAIN_BATCH	(16)
+#endif
+
 /*
 	Initialisers for CUNILOG_ROTATION_DATA structures.
 
@@ -548,7 +719,8 @@ typedef struct cunilog_rotation_data
 	0, 0, CUNILOG_MAX_ROTATE_AUTO,						\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 
 /*
@@ -560,7 +732,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_TRASH(k)\
 {														\
@@ -568,7 +741,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_MOVE_TO_RECYCLE_BIN(k)\
 {														\
@@ -576,7 +750,8 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
 }
 #define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE(k)\
 {														\
@@ -584,7 +759,64 @@ typedef struct cunilog_rotation_data
 	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
 	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
 	NULL,												\
-	CUNILOG_ROTATOR_FLAG_NONE							\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
+}
+
+/*
+	Argument k is the amount of logfiles to keep/not touch. Logfiles beyond this amount
+	are deleted as usual. Logfiles within this amount are deleted too if, starting with
+	the newest logfile, the total size of the logfiles exceeds o octets, or if they're
+	older than s seconds. Either o or s can be 0 to disable the policy. The sizes and
+	times of the logfiles are obtained once and kept with the files list index, which the
+	rotator enables for its target (see ConfigCUNILOG_TARGETfilesListIndex ()). The active
+	logfile is included in the total size but never deleted. Compressed logfiles created
+	by cunilogrotationtask_ExtCompressLogfiles rotators are included with their compressed
+	size.
+
+	Not more than CUNILOG_DEFAULT_RETAIN_BATCH logfiles (member nRetainBatch) are deleted
+	per event that triggers the rotator. If more are due, the rotator runs again with the
+	next event, independent of its frequency and of the time that has passed since. This
+	only spreads the deletions over several events, which can follow each other closely.
+	It is not a limit of deletions per time period.
+*/
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN(k, o, s)\
+{														\
+	cunilogrotationtask_DeleteLogfiles,					\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	(o), (s), CUNILOG_DEFAULT_RETAIN_BATCH				\
+}
+
+/*
+	Argument k is the amount of logfiles to keep/not touch. The active logfile is never
+	compressed. Targets with a dot number postfix are not supported because compressed
+	logfiles are not renamed. The rotator is ignored in this case, and if its compressor
+	hasn't been built in (see ExtCompressors.h). Compressed logfiles stay in the list of
+	logfiles subsequent rotators work on, hence a rotator with the task
+	cunilogrotationtask_DeleteLogfiles that comes after this one deletes them too. They
+	count towards the logfiles to keep of every rotator, including this one, which skips
+	them.
+*/
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_GZIP(k)	\
+{														\
+	cunilogrotationtask_ExtCompressLogfiles,			\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_NONE,							\
+	0, 0, 0												\
+}
+#define CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_ZSTD(k)	\
+{														\
+	cunilogrotationtask_ExtCompressLogfiles,			\
+	(k), 0, CUNILOG_MAX_ROTATE_AUTO,					\
+	SMEMBUF_INITIALISER, SMEMBUF_INITIALISER,			\
+	NULL,												\
+	CUNILOG_ROTATOR_FLAG_ZSTD,							\
+	0, 0, 0												\
 }
 
 /*
@@ -596,7 +828,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 #define CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR	\
 {														\
@@ -604,7 +837,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 /*
 	Argument plf is a pointer to a CUNILOG_LOGFILE structure.
@@ -615,7 +849,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_nAlways,					\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 #define CUNILOG_INIT_DEF_FLUSHLOGFILE_PROCESSOR			\
 {														\
@@ -623,7 +858,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	NULL,												\
-	OPT_CUNPROC_FORCE_NEXT								\
+	OPT_CUNPROC_FORCE_NEXT,								\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -637,7 +873,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -651,7 +888,8 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 /*
 	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
@@ -663,7 +901,38 @@ typedef struct cunilog_rotation_data
 	cunilogProcessAppliesTo_Auto,						\
 	0, 0,												\
 	(p),												\
-	OPT_CUNPROC_NONE									\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
+}
+/*
+	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
+	tsk set to cunilogrotationtask_DeleteLogfiles. Such a structure can be initialised
+	with the CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE() or the
+	CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN() macro.
+*/
+#define CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR(p)	\
+{														\
+	cunilogProcessRotateLogfiles,						\
+	cunilogProcessAppliesTo_Auto,						\
+	0, 0,												\
+	(p),												\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
+}
+/*
+	Argument p is a pointer to a CUNILOG_ROTATION_DATA structure with member
+	tsk set to cunilogrotationtask_ExtCompressLogfiles. Such a structure can
+	be initialised with the CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_GZIP() or the
+	CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_ZSTD() macro.
+*/
+#define CUNILOG_INIT_DEF_LOGFILESEXTCOMPRESS_PROCESSOR(p)\
+{														\
+	cunilogProcessRotateLogfiles,						\
+	cunilogProcessAppliesTo_Auto,						\
+	0, 0,												\
+	(p),												\
+	OPT_CUNPROC_NONE,									\
+	0, 0												\
 }
 
 
@@ -673,7 +942,7 @@ typedef struct cunilog_rotation_data
 	Function/macro to initialise a CUNILOG_PROCESSOR structure. The data (pData) member
 	is set to NULL and the member uiOpts to OPT_CUNPROC_NONE, which means no option flags
 	are set. The caller is responsible for setting those members to their desired values
-	afterwards.
+	afterwards. The processor sees events of all severities and types.
 */
 #define FillCUNILOG_PROCESSOR(cup, task,				\
 								freq, thrs)				\
@@ -683,10 +952,13 @@ typedef struct cunilog_rotation_data
 	(cup)->thr		= thrs;								\
 	(cup)->cur		= 0;								\
 	(cup)->pData	= NULL;								\
-	(cup)->uiOpts	= OPT_CUNPROC_NONE;
+	(cup)->uiOpts	= OPT_CUNPROC_NONE;					\
+	(cup)->uiSkipSeverities	= 0;						\
+	(cup)->uiSkipEvtTypes	= 0;
 
 #ifdef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 	typedef struct CUNILOG_EVENT CUNILOG_EVENT;
+	typedef struct cunilog_maintjob CUNILOG_MAINTJOB;
 #else
 	typedef struct cunilog_locker
 	{
@@ -725,7 +997,163 @@ typedef struct cunilog_rotation_data
 		CUNILOG_EVENT			*last;						// Last event.
 		size_t					num;						// Current amount of queue
 															//	elements.
+		CUNILOG_EVENT			*head;						// Most recently enqueued event
+															//	of the lock-free queue.
 	} CUNILOG_QUEUE_BASE;
+
+	typedef struct cunilog_tls_key
+	{
+		#ifdef OS_IS_WINDOWS
+			DWORD				dwFlsIndex;
+		#else
+			pthread_key_t		tKey;
+		#endif
+		bool					bCreated;
+	} CUNILOG_TLS_KEY;
+
+	/*
+		CUNILOG_STAGING
+
+		A per-thread staging buffer of a target. The events of a thread are collected
+		here and handed over to the queue of the target in batches.
+	*/
+	typedef struct cunilog_staging CUNILOG_STAGING;
+	struct cunilog_staging
+	{
+		CUNILOG_TARGET			*put;						// The target.
+		size_t					nBusy;						// 1 while a thread accesses
+															//	the staged events.
+		CUNILOG_EVENT			*first;						// Oldest staged event.
+		CUNILOG_EVENT			*last;						// Most recently staged event.
+		size_t					num;						// Amount of staged events.
+		size_t					octets;						// Their data size.
+		size_t					nUnclocked;					// Events staged since the
+															//	clock has been read.
+		uint64_t				ullFirst;					// When the oldest event has
+															//	been staged.
+		CUNILOG_STAGING			*nextStaging;				// Next staging buffer of the
+															//	target.
+	};
+
+	/*
+		CUNILOG_EVENTPOOL
+
+		An event pool. Events of up to the largest size class are carved from a bulk memory
+		block and, when they have been processed, returned to the free list of their size
+		class instead of being deallocated. Each pooled event is preceded by a
+		CUNILOG_POOLSLOT header, which is how an event finds its way back to its size class.
+
+		An event that has been handed on to another target via logEv () still returns to
+		the pool it has been taken from. The pool is therefore only deallocated when its
+		target has been destroyed and the last of its events has been returned.
+	*/
+	#ifndef CUNILOG_EVENTPOOL_CLASSES
+	#define CUNILOG_EVENTPOOL_CLASSES		(5)				// 128, 256, 512, 1 KiB, 4 KiB.
+	#endif
+
+	typedef struct cunilog_poolslot CUNILOG_POOLSLOT;
+	typedef struct cunilog_eventpool_class CUNILOG_EVENTPOOL_CLASS;
+
+	struct cunilog_poolslot
+	{
+		CUNILOG_POOLSLOT		*next;						// Next free slot.
+		CUNILOG_EVENTPOOL_CLASS	*pClass;					// The slot's size class.
+	};
+
+	typedef struct cunilog_eventpool CUNILOG_EVENTPOOL;
+
+	struct cunilog_eventpool_class
+	{
+		CUNILOG_EVENTPOOL		*pool;						// The pool of the size class.
+		CUNILOG_POOLSLOT		*free;						// Lock-free list of free slots.
+		CUNILOG_LOCKER			cl;							// Serialises taking slots from
+															//	the free list.
+		size_t					stPayload;					// Octets available for caption
+															//	and data.
+		size_t					nSlots;						// Amount of slots carved so far.
+		size_t					nInUse;						// Slots currently in use.
+		size_t					nAllocs;					// Events served by this class.
+	};
+
+	struct cunilog_eventpool
+	{
+		CUNILOG_LOCKER			cl;							// Protects sbm.
+		SBULKMEM				sbm;						// Memory for the slots.
+		CUNILOG_EVENTPOOL_CLASS	classes [CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nHeapAllocs;				// Events too big for the pool or
+															//	that didn't get a slot.
+		size_t					nRefs;						// 1 for the target plus 1 for
+															//	every slot in use.
+	};
+
+	/*
+		Result structure for getCUNILOG_EVENTPOOLstats ().
+	*/
+	typedef struct cunilog_eventpoolstats
+	{
+		size_t					stPayload	[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nSlots		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nInUse		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nAllocs		[CUNILOG_EVENTPOOL_CLASSES];
+		size_t					nHeapAllocs;				// Events not served by the pool.
+		SBULKMEMSTATS			sbmStats;					// The pool's bulk memory.
+	} CUNILOG_EVENTPOOLSTATS;
+
+	/*
+		CUNILOG_MAINTENANCE
+
+		The maintenance thread of a target. Rotators hand over jobs that only work on
+		logfiles no longer written to, i.e. file system compression, compression with an
+		external compressor, moving to the recycle bin, and deleting, to this thread
+		instead of carrying them out themselves. The
+		messages of the jobs are collected in the order they are created and logged by
+		the thread that processes the events of the target.
+	*/
+	typedef struct cunilog_maintjob CUNILOG_MAINTJOB;
+	struct cunilog_maintjob
+	{
+		CUNILOG_MAINTJOB			*next;					// Next job.
+		enum cunilogrotationtask	tsk;					// The task to carry out.
+		CUNILOG_TARGET				*plogCUNILOG_TARGET;	// Target for the messages. See
+															//	CUNILOG_ROTATION_DATA.
+		uint64_t					uiFlgs;					// Option flags of the rotator.
+		char						*szFile;				// Full path of the logfile.
+		size_t						stFile;					// Its length incl. NUL terminator.
+		bool						bFailed;				// The logfile couldn't be moved
+															//	or deleted.
+	};
+
+	typedef struct cunilog_maintmsg CUNILOG_MAINTMSG;
+	struct cunilog_maintmsg
+	{
+		CUNILOG_MAINTMSG			*next;					// Next message.
+		CUNILOG_TARGET				*plogCUNILOG_TARGET;	// Target to log to, or NULL.
+		char						*szMsg;					// The message text.
+		size_t						lnMsg;					// Its length.
+	};
+
+	typedef struct cunilog_maintenance
+	{
+		CUNILOG_LOCKER				cl;						// Protects the lists.
+		CUNILOG_SEMAPHORE			sm;						// Posted for each job and to stop.
+		CUNILOG_SEMAPHORE			smIdle;					// Posted when the last job is done
+															//	and bIdleWait is set.
+		CUNILOG_THREAD				th;						// The maintenance thread.
+		CUNILOG_MAINTJOB			*firstJob;				// The job in progress or the next
+															//	one. Removed when done.
+		CUNILOG_MAINTJOB			*lastJob;				// Most recently added job.
+		CUNILOG_MAINTMSG			*firstMsg;				// Oldest message not logged yet.
+		CUNILOG_MAINTMSG			*lastMsg;				// Most recent message.
+		size_t						nMsgs;					// Amount of messages not logged yet.
+		size_t						nJobsDone;				// Amount of jobs the thread has
+															//	carried out.
+		size_t						nResync;				// Not 0 if a logfile removed from
+															//	the files list still exists.
+		int							iPrio;					// The cunilogprio of the thread.
+		bool						bIdleWait;				// Someone waits for smIdle.
+		bool						bStop;					// Leave when all jobs are done.
+		bool						bStopped;				// The thread has been joined.
+	} CUNILOG_MAINTENANCE;
 #endif
 
 /*
@@ -756,6 +1184,25 @@ enum cunilogeventTSformat
 	// Do not add anything below cunilogEvtTS_AmountEnumValues.
 };
 
+/*
+	CUNILOG_TSPREFIX
+
+	The most recently rendered event timestamp of a target. When the next event's
+	UBF_TIMESTAMP only differs in its time of day, only the digits that changed are
+	patched instead of rendering the whole timestamp again.
+
+	The member tsf is cunilogEvtTS_AmountEnumValues while the cache is empty.
+*/
+typedef struct cunilog_tsprefix
+{
+	UBF_TIMESTAMP					stamp;					// Timestamp in szPrefix.
+	enum cunilogeventTSformat		tsf;					// Format of szPrefix.
+	char							szPrefix [LEN_ISO8601DATETIMESTAMPMS + 3 + 1];
+} CUNILOG_TSPREFIX;
+
+#define InitCUNILOG_TSPREFIX(ptp)						\
+	(ptp)->tsf = cunilogEvtTS_AmountEnumValues
+
 enum cunilogRunProcessorsOnStartup
 {
 		cunilogRunProcessorsOnStartup
@@ -785,9 +1232,15 @@ typedef struct scunilogdump
 */
 typedef struct cunilog_fls
 {
-	char	*chFilename;
-	size_t	stFilename;
+	char		*chFilename;
+	size_t		stFilename;
+	uint64_t	ullSize;									// Size in octets.
+	uint64_t	ullModified;								// Last write as FILETIME ULONGLONG.
 } CUNILOG_FLS;
+
+// Value of the members ullSize and ullModified of a CUNILOG_FLS structure that haven't
+//	been obtained from the file system yet.
+#define CUNILOG_FLS_UNKNOWN				(UINT64_MAX)
 typedef vec_t(CUNILOG_FLS) vec_cunilog_fls;
 
 /*
@@ -897,6 +1350,64 @@ typedef struct scunilognpi
 
 typedef struct cunilog_rotator_args CUNILOG_ROTATOR_ARGS;
 
+/*
+	Event severities.
+
+	If changed, please update the copy in the comments of cunilog.c too.
+*/
+enum cunilogeventseverity
+{
+		cunilogEvtSeverityNone									//  0
+	,	cunilogEvtSeverityNonePass								//  1
+	,	cunilogEvtSeverityNoneFail								//  2
+	,	cunilogEvtSeverityNoneWarn								//  3
+	,	cunilogEvtSeverityBlanks								//  4
+	,	cunilogEvtSeverityEmergency								//	5
+	,	cunilogEvtSeverityNotice								//	6
+	,	cunilogEvtSeverityInfo									//  7
+	,	cunilogEvtSeverityMessage								//  8
+	,	cunilogEvtSeverityWarning								//  9
+	,	cunilogEvtSeverityError									// 10
+	,	cunilogEvtSeverityPass									// 11
+	,	cunilogEvtSeverityFail									// 12
+	,	cunilogEvtSeverityCritical								// 13
+	,	cunilogEvtSeverityFatal									// 14
+	,	cunilogEvtSeverityDebug									// 15
+	,	cunilogEvtSeverityTrace									// 16
+	,	cunilogEvtSeverityDetail								// 17
+	,	cunilogEvtSeverityVerbose								// 18
+	,	cunilogEvtSeverityIllegal								// 19
+	// Do not add anything below this line.
+	,	cunilogEvtSeverityXAmountEnumValues						// Used for sanity checks.
+	// Do not add anything below cunilogEvtSeverityXAmountEnumValues.
+};
+typedef enum cunilogeventseverity cueventseverity;
+
+/*
+	Importance of the event severities, from least to most important. These are plain
+	numbers the preprocessor can compare, for instance with CUNILOG_COMPILE_MIN_SEVERITY.
+	The severities in the comments have the same rank as the one in the macro name.
+*/
+#define CUNILOG_SEVRANK_VERBOSE					(0)
+#define CUNILOG_SEVRANK_DETAIL					(1)
+#define CUNILOG_SEVRANK_TRACE					(2)
+#define CUNILOG_SEVRANK_DEBUG					(3)
+#define CUNILOG_SEVRANK_NONE					(4)				// Blanks
+#define CUNILOG_SEVRANK_INFO					(5)				// NonePass, Pass
+#define CUNILOG_SEVRANK_NOTICE					(6)				// Message
+#define CUNILOG_SEVRANK_WARNING					(7)				// NoneWarn
+#define CUNILOG_SEVRANK_ERROR					(8)				// NoneFail, Fail
+#define CUNILOG_SEVRANK_CRITICAL				(9)
+#define CUNILOG_SEVRANK_FATAL					(10)
+#define CUNILOG_SEVRANK_EMERGENCY				(11)			// Illegal
+
+/*
+	Bit masks of event severities for ConfigCUNILOG_TARGETseverityMask ().
+*/
+#define CUNILOG_SEVERITY_BIT(sev)						((uint32_t) 1 << (sev))
+#define CUNILOG_SEVERITY_MASK_ALL						\
+	(CUNILOG_SEVERITY_BIT (cunilogEvtSeverityXAmountEnumValues) - 1)
+
 /*
 	The type/format of an event severity level.
 */
@@ -927,6 +1438,85 @@ extern cueventsevfmtpy cunilogEvtSeverityTypeDefault;
 */
 extern bool bUseCunilogDefaultOutputColour;
 
+/*
+	What happens to an event when the queue of a target with a separate logging thread
+	has reached its capacity. See ConfigCUNILOG_TARGETqueueLimit ().
+*/
+enum cunilogqueuefullpolicy
+{
+		cunilogQueueFullBlock									// The producer waits (default).
+	,	cunilogQueueFullDropNewest								// The new event is discarded.
+	,	cunilogQueueFullDropOldest								// The oldest queued event is
+																//	discarded.
+	,	cunilogQueueFullDropBelowSeverity						// The new event is discarded if
+																//	its severity is below the
+																//	threshold, otherwise the
+																//	oldest one below it.
+	// Do not add anything below this line.
+	,	cunilogQueueFullAmountEnumValues						// Used for sanity checks.
+	// Do not add anything below cunilogQueueFullAmountEnumValues.
+};
+typedef enum cunilogqueuefullpolicy cuqueuefullpolicy;
+
+/*
+	CUNILOG_BATCHEVENT
+
+	An event as the batch function of a custom processor receives it. The event line
+	has been rendered when the event went through the processors and is kept until the
+	batch function returns. It is NUL-terminated and doesn't contain a line ending. For
+	events of type cunilogEvtTypeDeferredFmt the event line is the only place the
+	formatted text can be found.
+*/
+typedef struct cunilog_batchevent
+{
+	CUNILOG_EVENT					*pev;					// The event.
+	const char						*szLine;				// Its rendered event line.
+	size_t							lnLine;					// Length of szLine.
+} CUNILOG_BATCHEVENT;
+
+/*
+	CUNILOG_BATCH
+
+	The events a processor with a batch function has been handed by the separate logging
+	thread but not processed yet. The processor gets them all at once when the thread has
+	worked through the events it took off the queue. Their event lines are stored in the
+	line buffer of the target. Since this buffer can move while the batch grows, only
+	the offsets of the lines are remembered in pofs. The member szLine of a
+	CUNILOG_BATCHEVENT structure is set just before the batch is handed over.
+*/
+typedef struct cunilog_batch
+{
+	CUNILOG_BATCHEVENT				*pbes;					// The pending events.
+	size_t							*pofs;					// Offsets of their event lines.
+	size_t							nevs;					// Amount of pending events.
+	size_t							size;					// Capacity of pbes and pofs.
+} CUNILOG_BATCH;
+
+/*
+	CUNILOG_PLANSTEP
+
+	One step of the processor plan of a target. The plan is compiled from the processor
+	list of the target when the list is set and whenever a processor is disabled or
+	enabled. It only contains the processors that are not disabled, in their original
+	order, together with everything about them that doesn't change per event.
+*/
+typedef struct cunilog_planstep
+{
+	CUNILOG_PROCESSOR				*cup;					// The processor.
+	bool							(*fnct) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *);
+															// Its processor function.
+	uint32_t						uiFlags;				// See CUNILOG_PLANSTEP_ flags below.
+	CUNILOG_BATCH					*pbt;					// Pending events of a processor
+															//	with a batch function, or NULL.
+} CUNILOG_PLANSTEP;
+
+#define CUNILOG_PLANSTEP_ALWAYS			(1u << 0)			// Frequency is
+															//	cunilogProcessAppliesTo_nAlways.
+#define CUNILOG_PLANSTEP_FORCE_NEXT		(1u << 1)			// OPT_CUNPROC_FORCE_NEXT is set.
+#define CUNILOG_PLANSTEP_ECHO			(1u << 2)			// An echo processor.
+#define CUNILOG_PLANSTEP_BATCH			(1u << 3)			// A custom processor with a
+															//	batch function.
+
 /*
 	SUNILOGTARGET
 
@@ -950,6 +1540,8 @@ typedef struct CUNILOG_TARGET
 															//	Same as mbLogPath but NUL-terminated
 															//	and without slash at the end.
 		size_t						lnLogFold;				// Its length exl. NUL terminator.
+		int							fdLogFold;				// Directory fd of mbLogFold for
+															//	renameat (), or -1.
 	#endif
 	SMEMBUF							mbLogfileName;			// Path and name of current log file.
 	char							*szDateTimeStamp;		// Points inside mbLogfileName.buf.pch.
@@ -975,6 +1567,13 @@ typedef struct CUNILOG_TARGET
 	SCUNILOGNPI						scuNPI;					// Information for the next processor.
 	CUNILOG_PROCESSOR				**cprocessors;
 	unsigned int					nprocessors;
+	CUNILOG_PLANSTEP				*plan;					// The processor plan, compiled
+															//	from cprocessors.
+	unsigned int					nplan;					// Steps in plan.
+	CUNILOG_BATCH					*batches;				// Pending events per processor,
+															//	parallel to cprocessors, or
+															//	NULL if no processor has a
+															//	batch function.
 
 	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
 		CUNILOG_LOCKER				cl;						// Locker for events queue.
@@ -987,19 +1586,87 @@ typedef struct CUNILOG_TARGET
 
 		size_t						nPausedEvents;			// Amount of events queued because
 															//	the logging thread is/was paused.
+
+		size_t						nDbgQueueLocked;		// 1 while the queue is locked. Only
+															//	used in debug versions. Not a
+															//	flag in uiOpts because the
+															//	logging thread changes uiOpts
+															//	without holding the lock.
+
+		size_t						nSepLogThreadIdle;		// 1 if the separate logging thread
+															//	is parked or about to park. Only
+															//	used with coalesced wake-ups.
+		size_t						nSepLogThreadPosts;		// Amount of semaphore posts.
+		size_t						nSepLogThreadWakeups;	// Amount of times the separate
+															//	logging thread blocked on the
+															//	semaphore and woke up again.
+
+		CUNILOG_SEMAPHORE			smQueueSpace;			// Semaphore for producers that
+															//	wait for space in the queue.
+		size_t						nMaxQueuedEvents;		// Capacity of the queue. 0 means
+															//	the queue is unbounded.
+		cuqueuefullpolicy			queueFullPolicy;		// What to do if the queue is full.
+		uint32_t					uiDropSeverities;		// Bit mask of the severities that
+															//	are dropped by the policy
+															//	cunilogQueueFullDropBelowSeverity.
+		size_t						nBlockedProducers;		// Producers waiting for space.
+		size_t						nDroppedEvents [cunilogEvtSeverityXAmountEnumValues];
+															// Dropped events per severity.
+
+		CUNILOG_TLS_KEY				tlsStaging;				// Thread's staging buffer.
+		CUNILOG_LOCKER				clStagings;				// Protects the list of staging
+															//	buffers.
+		CUNILOG_STAGING				*stagings;				// All staging buffers.
+		bool						bStaging;				// Staging buffers are on.
+		bool						bStagingClosed;			// Shutdown has flushed the
+															//	staging buffers. Events
+															//	are not staged anymore.
+		size_t						nStagingEvents;			// Batch size in events.
+		size_t						nStagingOctets;			// Batch size in octets.
+		uint64_t					ullStagingLatency;		// Maximum age of a staged event
+															//	in FILETIME units.
+
+		CUNILOG_EVENTPOOL			*pool;					// The event pool, or NULL.
+
+		CUNILOG_MAINTENANCE			*pmt;					// The maintenance thread, or NULL.
+
+		uint32_t					seqTimestamps;			// Sequence lock of tsc. Odd while
+															//	tsc is updated.
+
+		CUNILOG_EVENT				*pevDeferred;			// Events kept by batch functions.
+		char						*szBatchLines;			// Event lines of the batch.
+		size_t						szBatchLinesSize;		// Capacity of szBatchLines.
+		size_t						lnBatchLines;			// Octets used in szBatchLines.
+		CUNILOG_EVENT				*pevBatchLine;			// Event whose line was stored last.
+		size_t						ofsBatchLine;			// Offset of this line.
+		SMEMBUF						mbEchoBatch;			// Echo output of the current batch.
+		size_t						lnEchoBatch;			// Length of the echo output.
 	#endif
+	UBF_TIMESTAMP_CACHE				tsc;					// Cached local time.
+	CUNILOG_TSPREFIX				tsp;					// Last rendered event timestamp.
 
 	enum cunilogeventTSformat		unilogEvtTSformat;		// The format of an event timestamp.
 	newline_t						unilogNewLine;
 	CUNILOG_LOGFILE					logfile;
+	uint64_t						ullRotateAtSize;		// Rotate when the active logfile
+															//	has reached this size, or 0.
+	CUNILOG_WRITEBEHIND				wb;						// Write-behind buffer.
 	SBULKMEM						sbm;					// Bulk memory block.
 	vec_cunilog_fls					fls;					// The vector with str pointers to
 															//	the files to rotate within sbm.
+	size_t							stFLSorphaned;			// Octets in sbm no longer referenced
+															//	by fls. Files list index only.
+	#ifdef CUNILOG_HAVE_INOTIFY
+		int							fdFLSwatch;				// inotify fd watching mbLogFold
+															//	for the files list index, or -1.
+	#endif
 	// We're not using the configurable dump anymore.
 	//SCUNILOGDUMP					*psdump;				// Holds the dump parameters.
 	ddumpWidth						dumpWidth;
 
 	cueventsevfmtpy					evSeverityType;			// Format of the event severity.
+	uint32_t						uiLogSeverities;		// Bit mask of the severities that
+															//	are logged. Read without a lock.
 
 	CUNILOG_ERROR					error;
 	#ifndef CUNILOG_BUILD_WITHOUT_ERROR_CALLBACK
@@ -1084,9 +1751,6 @@ typedef struct CUNILOG_TARGET
 //	in cunilogerrors.h.
 #define CUNILOGTARGET_ALWAYS_CALL_ERRORCB		SINGLEBIT64 (16)
 
-// Debug flag when the queue is locked. To be removed in the future.
-#define CUNILOGTARGET_DEBUG_QUEUE_LOCKED		SINGLEBIT64 (20)
-
 #define cunilogTargetSetShutdownInitiatedFlag(put)		\
 	((put)->uiOpts |= CUNILOGTARGET_SHUTDOWN_INITIATED)
 #define cunilogTargetHasShutdownInitiatedFlag(put)		\
@@ -1180,11 +1844,11 @@ typedef struct CUNILOG_TARGET
 
 #if defined (DEBUG) && !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY)
 	#define cunilogHasDebugQueueLocked(put)				\
-		((put)->uiOpts & CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked)
 	#define cunilogClrDebugQueueLocked(put)				\
-		((put)->uiOpts &= ~ CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked = 0)
 	#define cunilogSetDebugQueueLocked(put)				\
-		((put)->uiOpts |= CUNILOGTARGET_DEBUG_QUEUE_LOCKED)
+		((put)->nDbgQueueLocked = 1)
 #else
 	#define cunilogHasDebugQueueLocked(put)	(true)
 	#define cunilogClrDebugQueueLocked(put)
@@ -1228,6 +1892,70 @@ typedef struct CUNILOG_TARGET
 // Colour information should be used.
 #define CUNILOGTARGET_USE_COLOUR_FOR_ECHO		SINGLEBIT64 (36)
 
+/*
+	The event queue of a target with a separate logging thread is lock-free. Producers
+	push their events with an atomic compare-and-swap operation via the member ->next
+	of the event, and the separate logging thread takes over the entire queue with a
+	single atomic exchange. Without this flag, the queue is protected by the locker
+	of the target.
+
+	This flag must be set before the first event is logged. It is ignored for targets
+	without a separate logging thread.
+*/
+#define CUNILOGTARGET_LOCKFREE_QUEUE			SINGLEBIT64 (37)
+
+/*
+	Wake-ups of the separate logging thread are coalesced. A producer only signals the
+	semaphore of the target when the separate logging thread is parked, or about to
+	park, instead of once per event. Since the separate logging thread always takes
+	over the entire queue, a burst of events then only costs a single semaphore post
+	and a single wait.
+
+	This flag must be set before the first event is logged. It is ignored for targets
+	without a separate logging thread.
+*/
+#define CUNILOGTARGET_COALESCE_WAKEUPS			SINGLEBIT64 (38)
+
+/*
+	Event timestamps are obtained from a cached local time provider instead of
+	LocalTime_UBF_TIMESTAMP (). Only a coarse wall clock is read for every event.
+	Date, time, and UTC offset are recomputed when the second changes. See
+	GetLocalTimeCached_UBF_TIMESTAMP ().
+
+	This flag is set by ConfigCUNILOG_TARGETcachedTimestamps ().
+*/
+#define CUNILOGTARGET_CACHED_TIMESTAMPS			SINGLEBIT64 (39)
+
+/*
+	POSIX only. The logfile is a raw file descriptor opened with O_APPEND and O_CLOEXEC,
+	and event lines are written with writev () instead of going through the buffer of
+	the C runtime library. This is what the Windows version always does.
+
+	This flag is set by ConfigCUNILOG_TARGETrawLogfile ().
+*/
+#define CUNILOGTARGET_RAW_LOGFILE				SINGLEBIT64 (40)
+
+/*
+	POSIX only. The tail of the logfile is preallocated and memory-mapped in chunks, and
+	event lines are copied into the mapping. The logfile is truncated to its real size
+	when it is closed. Implies CUNILOGTARGET_RAW_LOGFILE.
+
+	This flag is set by ConfigCUNILOG_TARGETmappedLogfile ().
+*/
+#define CUNILOGTARGET_MAPPED_LOGFILE			SINGLEBIT64 (41)
+
+/*
+	The files list (member fls) is a persistent index of the logfiles in the logging
+	folder. It is built once, kept sorted, and updated by the rotators instead of being
+	read from disk again for every rotation.
+
+	This flag is set by ConfigCUNILOG_TARGETfilesListIndex ().
+*/
+#define CUNILOGTARGET_FLS_INDEX					SINGLEBIT64 (42)
+
+// The files list index has been built.
+#define CUNILOGTARGET_FLS_INDEX_BUILT			SINGLEBIT64 (43)
+
 /*
 	Macros for public/user/caller flags.
 */
@@ -1267,39 +1995,47 @@ typedef struct CUNILOG_TARGET
 #define cunilogSetEnqueueTimestamps(put)				\
 	((put)->uiOpts |= CUNILOGTARGET_ENQUEUE_TIMESTAMPS)
 
+#define cunilogHasLockFreeQueue(put)					\
+	((put)->uiOpts & CUNILOGTARGET_LOCKFREE_QUEUE)
+#define cunilogClrLockFreeQueue(put)					\
+	((put)->uiOpts &= ~ CUNILOGTARGET_LOCKFREE_QUEUE)
+#define cunilogSetLockFreeQueue(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_LOCKFREE_QUEUE)
+
+#define cunilogHasCoalescedWakeups(put)					\
+	((put)->uiOpts & CUNILOGTARGET_COALESCE_WAKEUPS)
+#define cunilogClrCoalescedWakeups(put)					\
+	((put)->uiOpts &= ~ CUNILOGTARGET_COALESCE_WAKEUPS)
+#define cunilogSetCoalescedWakeups(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_COALESCE_WAKEUPS)
+
+#define cunilogHasCachedTimestamps(put)					\
+	((put)->uiOpts & CUNILOGTARGET_CACHED_TIMESTAMPS)
+#define cunilogSetCachedTimestamps(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_CACHED_TIMESTAMPS)
+
+#define cunilogHasRawLogfile(put)						\
+	((put)->uiOpts & CUNILOGTARGET_RAW_LOGFILE)
+#define cunilogSetRawLogfile(put)						\
+	((put)->uiOpts |= CUNILOGTARGET_RAW_LOGFILE)
+
+#define cunilogHasMappedLogfile(put)					\
+	((put)->uiOpts & CUNILOGTARGET_MAPPED_LOGFILE)
+#define cunilogSetMappedLogfile(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_MAPPED_LOGFILE)
+
+#define cunilogTargetHasFLSindex(put)					\
+	((put)->uiOpts & CUNILOGTARGET_FLS_INDEX)
+#define cunilogTargetSetFLSindex(put)					\
+	((put)->uiOpts |= CUNILOGTARGET_FLS_INDEX)
+
+#define cunilogTargetHasFLSindexBuilt(put)				\
+	((put)->uiOpts & CUNILOGTARGET_FLS_INDEX_BUILT)
+#define cunilogTargetClrFLSindexBuilt(put)				\
+	((put)->uiOpts &= ~ CUNILOGTARGET_FLS_INDEX_BUILT)
+#define cunilogTargetSetFLSindexBuilt(put)				\
+	((put)->uiOpts |= CUNILOGTARGET_FLS_INDEX_BUILT)
 
-/*
-	Event severities.
-
-	If changed, please update the copy in the comments of cunilog.c too.
-*/
-enum cunilogeventseverity
-{
-		cunilogEvtSeverityNone									//  0
-	,	cunilogEvtSeverityNonePass								//  1
-	,	cunilogEvtSeverityNoneFail								//  2
-	,	cunilogEvtSeverityNoneWarn								//  3
-	,	cunilogEvtSeverityBlanks								//  4
-	,	cunilogEvtSeverityEmergency								//	5
-	,	cunilogEvtSeverityNotice								//	6
-	,	cunilogEvtSeverityInfo									//  7
-	,	cunilogEvtSeverityMessage								//  8
-	,	cunilogEvtSeverityWarning								//  9
-	,	cunilogEvtSeverityError									// 10
-	,	cunilogEvtSeverityPass									// 11
-	,	cunilogEvtSeverityFail									// 12
-	,	cunilogEvtSeverityCritical								// 13
-	,	cunilogEvtSeverityFatal									// 14
-	,	cunilogEvtSeverityDebug									// 15
-	,	cunilogEvtSeverityTrace									// 16
-	,	cunilogEvtSeverityDetail								// 17
-	,	cunilogEvtSeverityVerbose								// 18
-	,	cunilogEvtSeverityIllegal								// 19
-	// Do not add anything below this line.
-	,	cunilogEvtSeverityXAmountEnumValues						// Used for sanity checks.
-	// Do not add anything below cunilogEvtSeverityXAmountEnumValues.
-};
-typedef enum cunilogeventseverity cueventseverity;
 
 enum cunilogeventtype
 {
@@ -1316,12 +2052,40 @@ enum cunilogeventtype
 	,	cunilogEvtTypeHexDumpWithCaption16					// Caption length is 16 bit.
 	,	cunilogEvtTypeHexDumpWithCaption32					// Caption length is 32 bit.
 	,	cunilogEvtTypeHexDumpWithCaption64					// Caption length is 64 bit.
+
+		/*
+			Deferred formatting. The data starts with a copy of the NUL-terminated format
+			string, followed by a binary record of the arguments. The text is only rendered when
+			the event line is created, which is on the separate logging thread if the
+			target has one. Member lenDataToLog is the size of the format string and the
+			argument record.
+		*/
+	,	cunilogEvtTypeDeferredFmt							// Format string + arguments.
 	// Do not add anything below this line.
 	,	cunilogEvtTypeAmountEnumValues						// Used for sanity checks.
 	// Do not add anything below cunilogEvtTypeAmountEnumValues.
 };
 typedef enum cunilogeventtype cueventtype;
 
+/*
+	Bit masks of event types for ConfigCUNILOG_PROCESSORfilter ().
+*/
+#define CUNILOG_EVTTYPE_BIT(t)							((uint32_t) 1 << (t))
+#define CUNILOG_EVTTYPES_TEXT										\
+(																	\
+		CUNILOG_EVTTYPE_BIT (cunilogEvtTypeNormalText)				\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeDeferredFmt)				\
+)
+#define CUNILOG_EVTTYPES_HEXDUMP									\
+(																	\
+		CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption8)		\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption16)	\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption32)	\
+	|	CUNILOG_EVTTYPE_BIT (cunilogEvtTypeHexDumpWithCaption64)	\
+)
+#define CUNILOG_EVTTYPES_ALL										\
+	(CUNILOG_EVTTYPE_BIT (cunilogEvtTypeAmountEnumValues) - 1)
+
 /*
 	CUNILOG_EVENT
 
@@ -1418,6 +2182,17 @@ typedef struct CUNILOG_EVENT
 // Only process the echo processor. All others are suppressed.
 #define CUNILOGEVENT_ECHO_ONLY					SINGLEBIT64 (8)
 
+// The structure lives in a slot of the event pool of a target. This is for
+//	DoneCUNILOG_EVENT () to return it to the pool.
+#define CUNILOGEVENT_POOLED						SINGLEBIT64 (9)
+
+// The separate logging thread took the event off the queue together with others. Its
+//	processing may be finished when the thread has worked through all of them.
+#define CUNILOGEVENT_BATCHED					SINGLEBIT64 (10)
+
+// A processor with a batch function keeps the event until the batch is complete.
+#define CUNILOGEVENT_DEFERRED					SINGLEBIT64 (11)
+
 // Macros to set and check flags.
 #define cunilogSetEventAllocated(pev)					\
 	((pev)->uiOpts |= CUNILOGEVENT_ALLOCATED)
@@ -1426,6 +2201,11 @@ typedef struct CUNILOG_EVENT
 #define cunilogIsEventDataAllocated(pev)				\
 	((pev)->uiOpts & CUNILOGEVENT_DATA_ALLOCATED)
 
+#define cunilogIsEventPooled(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_POOLED)
+#define cunilogClrEventPooled(pev)						\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_POOLED)
+
 #define cunilogSetEventShutdown(pev)					\
 	((pev)->uiOpts |= CUNILOGEVENT_SHUTDOWN)
 #define cunilogIsEventShutdown(pev)						\
@@ -1471,6 +2251,20 @@ typedef struct CUNILOG_EVENT
 #define cunilogHasEventEchoOnly(pev)					\
 	((pev)->uiOpts & CUNILOGEVENT_ECHO_ONLY)
 
+#define cunilogSetEventBatched(pev)						\
+	((pev)->uiOpts |= CUNILOGEVENT_BATCHED)
+#define cunilogClrEventBatched(pev)						\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_BATCHED)
+#define cunilogIsEventBatched(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_BATCHED)
+
+#define cunilogSetEventDeferred(pev)					\
+	((pev)->uiOpts |= CUNILOGEVENT_DEFERRED)
+#define cunilogClrEventDeferred(pev)					\
+	((pev)->uiOpts &= ~ CUNILOGEVENT_DEFERRED)
+#define cunilogIsEventDeferred(pev)						\
+	((pev)->uiOpts & CUNILOGEVENT_DEFERRED)
+
 /*
 	Return type of the separate logging thread.
 */
@@ -1502,6 +2296,12 @@ typedef struct CUNILOG_EVENT
 */
 typedef bool (*pfCustProc) (CUNILOG_PROCESSOR *, CUNILOG_EVENT *);
 
+/*
+	A batch callback function of a custom/user defined processor. It receives an array
+	of events together with their event lines and the amount of events in this array.
+*/
+typedef bool (*pfCustProcBatch) (CUNILOG_PROCESSOR *, CUNILOG_BATCHEVENT *, size_t);
+
 /*
 	Callback function for cleaning up a custom/user defined processor.
 */
@@ -1517,10 +2317,37 @@ typedef void (*pfDoneProc) (CUNILOG_PROCESSOR *);
 					cast the pData member of the CUNILOG_PROCESSOR structure to a pointer
 					to a CUNILOG_CUSTPROCESS structure.
 	procFnct		Pointer to a custom/user function provided by the caller that handles
-					the processor. This member cannot be NULL.
+					the processor. This member can only be NULL if procBatch is not NULL.
 	procDone		Pointer to a function that is called when the processor is destroyed.
 					This member can be NULL if this custom (or user/external) processor
 					does not require cleanup code.
+	procBatch		Pointer to an optional batch function. This member can be NULL.
+					If the processor's frequency is cunilogProcessAppliesTo_nAlways and
+					its target has a separate logging thread, the events the thread takes
+					off the queue in one go are collected and handed over to procBatch
+					with a single call when all processors have run for them. The
+					remaining processors of the events have run already at that point and
+					the return value of procBatch is ignored. The members mbLogEventLine
+					and lnLogEventLine of the target don't hold the event lines of these
+					events anymore. Each CUNILOG_BATCHEVENT structure therefore carries
+					the event line of its event, which remains valid until procBatch
+					returns. In all other cases, or if memory for the batch can't be
+					obtained, procFnct is called per event. If procFnct is NULL,
+					procBatch is called with a single event and the current event line
+					instead.
+
+					Only custom processors get batches through procBatch. The echo
+					processor collects the echo output of a batch by itself. The
+					processor that writes to the logfile does not batch events. It
+					only writes a batch of event lines with a single call if the
+					target's write-behind buffer has the policy
+					cunilogWriteBehindEveryBatch. See ConfigCUNILOG_TARGETwriteBehind ().
+
+	The member procBatch has been added after procFnct and procDone. Code that initialises
+	a CUNILOG_CUSTPROCESS structure with a brace-enclosed list of three members still
+	compiles and gets a procBatch of NULL, but compilers with warnings about missing field
+	initialisers enabled (like -Wmissing-field-initializers) complain about it. Code that
+	relies on the size or the layout of the structure needs to be compiled again.
 
 	Note that there's no callback function for initialisation. If dynamic initialisation is
 	required, it is recommended to initialise pCust to NULL and initialise the custom data
@@ -1531,6 +2358,7 @@ typedef struct cunilog_customprocess
 	void			*pCust;
 	pfCustProc		procFnct;
 	pfDoneProc		procDone;
+	pfCustProcBatch	procBatch;
 } CUNILOG_CUSTPROCESS;
 
 /*
@@ -2257,6 +2257,22 @@ bool FormattedMilliseconds (char *chFormatted, const uint64_t uiTimeInMillisecon
 		ISO8601T_from_UBF_TIMESTAMPc (szTS2, tt);
 		ubf_expect_bool_AND (b, !memcmp (szTS1, szTS2, SIZ_ISO8601DATETIMESTAMPMS));
 
+		// Apart from the milliseconds the cached local time is identical to the uncached one.
+		UBF_TIMESTAMP_CACHE	tsc		= UBF_TIMESTAMP_CACHE_INITIALISER;
+		UBF_TIMESTAMP		msk		= ~ SET_UBF_TIMESTAMP_MILLISECOND_BITS (0x3FF);
+		UBF_TIMESTAMP		tc;
+		tt = LocalTime_UBF_TIMESTAMP ();
+		tc = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		if ((tt & msk) != (tc & msk))
+		{	// Hit during a second change.
+			tt = LocalTime_UBF_TIMESTAMP ();
+			tc = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		}
+		ubf_expect_bool_AND (b, (tt & msk) == (tc & msk));
+		ubf_expect_bool_AND (b, -1 != tsc.tSec);
+		tt = LocalTimeCached_UBF_TIMESTAMP (&tsc);
+		ubf_expect_bool_AND (b, (tt & msk) >= (tc & msk));
+
 		char szISO_1 [SIZ_ISO8601DATETIMESTAMP_NO_OFFS];
 		char szISO_2 [SIZ_ISO8601DATETIMESTAMP_NO_OFFS];
 		szISO_1 [LEN_ISO8601DATETIMESTAMP_NO_OFFS] = 'X';
@@ -477,6 +477,102 @@ UBF_TIMESTAMP LocalTime_UBF_TIMESTAMP (void)
 	return dts;
 }
 
+/*
+	Recomputes the cached local time for the second tSec. The UTC offset is obtained the
+	same way as in GetLocalTime_UBF_TIMESTAMP (). Unlike there, the reentrant versions of
+	localtime () are used.
+*/
+static void updateUBF_TIMESTAMP_CACHE (UBF_TIMESTAMP_CACHE *pc, int64_t tSec)
+{
+	ubf_assert_non_NULL (pc);
+
+	int				i_adjustment_hours;
+	int				i_adjustment_mins;
+	bool			bOffsetNegative = false;
+	time_t			t_time			= (time_t) tSec;
+	struct tm		stime;
+
+	#ifdef PLATFORM_IS_WINDOWS
+		struct	timeb	timebuffer;
+		_ftime (&timebuffer);
+		if (timebuffer.timezone < 0)
+		{
+			bOffsetNegative = true;
+			timebuffer.timezone *= -1;
+		}
+		i_adjustment_hours = timebuffer.timezone / 60;
+		i_adjustment_mins  = timebuffer.timezone % 60;
+		localtime_s (&stime, &t_time);
+	#else
+		struct timeval	tv;
+		struct timezone	tz;
+		gettimeofday (&tv, &tz);
+		if (tz.tz_minuteswest < 0)
+		{
+			bOffsetNegative = true;
+			tz.tz_minuteswest *= -1;
+		}
+		i_adjustment_hours	= tz.tz_minuteswest / 60;
+		i_adjustment_mins	= tz.tz_minuteswest % 60;
+		localtime_r (&t_time, &stime);
+	#endif
+
+	// Adjust daylight saving time (DST) value.
+	//  DST automatically implies +1 hour (+01:00).
+	if (stime.tm_isdst > 0) i_adjustment_hours++;
+
+	SET_UBF_TIMESTAMP_OFFSET_BITS	(
+		pc->uts, (UBF_TIMESTAMP) i_adjustment_hours, (UBF_TIMESTAMP) i_adjustment_mins, bOffsetNegative
+									);
+	pc->uts |= SET_UBF_TIMESTAMP_YEAR_BITS		((UBF_TIMESTAMP) stime.tm_year + 1900);
+	pc->uts |= SET_UBF_TIMESTAMP_MONTH_BITS		((UBF_TIMESTAMP) stime.tm_mon + 1);
+	pc->uts |= SET_UBF_TIMESTAMP_DAY_BITS		((UBF_TIMESTAMP) stime.tm_mday);
+	pc->uts |= SET_UBF_TIMESTAMP_HOUR_BITS		((UBF_TIMESTAMP) stime.tm_hour);
+	pc->uts |= SET_UBF_TIMESTAMP_MINUTE_BITS	((UBF_TIMESTAMP) stime.tm_min);
+	pc->uts |= SET_UBF_TIMESTAMP_SECOND_BITS	((UBF_TIMESTAMP) stime.tm_sec);
+	pc->tSec = tSec;
+}
+
+void GetLocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP *ut, UBF_TIMESTAMP_CACHE *pc)
+{
+	ubf_assert_non_NULL (ut);
+	ubf_assert_non_NULL (pc);
+
+	int64_t			tSec;
+	unsigned int	ms;
+
+	#ifdef PLATFORM_IS_WINDOWS
+		FILETIME		ft;
+		ULARGE_INTEGER	ul;
+		GetSystemTimeAsFileTime (&ft);
+		ul.LowPart		= ft.dwLowDateTime;
+		ul.HighPart		= ft.dwHighDateTime;
+		ul.QuadPart		-= 116444736000000000;				// 1601-01-01 to 1970-01-01.
+		tSec			= (int64_t) (ul.QuadPart / FT_SECOND);
+		ms				= (unsigned int) ((ul.QuadPart % FT_SECOND) / FT_MILLISECOND);
+	#else
+		struct timespec	ts;
+		#ifdef CLOCK_REALTIME_COARSE
+			clock_gettime (CLOCK_REALTIME_COARSE, &ts);
+		#else
+			clock_gettime (CLOCK_REALTIME, &ts);
+		#endif
+		tSec			= (int64_t) ts.tv_sec;
+		ms				= (unsigned int) (ts.tv_nsec / 1000000);
+	#endif
+
+	if (tSec != pc->tSec)
+		updateUBF_TIMESTAMP_CACHE (pc, tSec);
+	*ut = pc->uts | SET_UBF_TIMESTAMP_MILLISECOND_BITS ((UBF_TIMESTAMP) ms);
+}
+
+UBF_TIMESTAMP LocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP_CACHE *pc)
+{
+	UBF_TIMESTAMP	dts;
+	GetLocalTimeCached_UBF_TIMESTAMP (&dts, pc);
+	return dts;
+}
+
 /*
 	A note about tests.
 
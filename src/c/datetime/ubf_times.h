@@ -753,6 +753,52 @@ UBF_TIMESTAMP SystemTime_UBF_TIMESTAMP (void)
 UBF_TIMESTAMP LocalTime_UBF_TIMESTAMP (void)
 ;
 
+/*
+	UBF_TIMESTAMP_CACHE
+
+	Cache for GetLocalTimeCached_UBF_TIMESTAMP (). It holds the local time of the most
+	recently seen second, including its UTC offset, as a UBF_TIMESTAMP without
+	milliseconds. Initialise the structure with UBF_TIMESTAMP_CACHE_INITIALISER or
+	InitUBF_TIMESTAMP_CACHE () before it is used.
+*/
+typedef struct ubf_timestamp_cache
+{
+	int64_t				tSec;							// Seconds since 1970-01-01 UTC.
+	UBF_TIMESTAMP		uts;							// Local time of tSec, no ms.
+} UBF_TIMESTAMP_CACHE;
+
+#define UBF_TIMESTAMP_CACHE_INITIALISER					\
+	{ -1, 0 }
+
+#define InitUBF_TIMESTAMP_CACHE(pc)						\
+	do													\
+	{													\
+		(pc)->tSec	= -1;								\
+		(pc)->uts	= 0;								\
+	} while (0)
+
+/*
+	GetLocalTimeCached_UBF_TIMESTAMP
+	LocalTimeCached_UBF_TIMESTAMP
+
+	Return the local time like GetLocalTime_UBF_TIMESTAMP () and LocalTime_UBF_TIMESTAMP ()
+	but only read a wall clock on each call, which is CLOCK_REALTIME_COARSE on Linux,
+	CLOCK_REALTIME on other POSIX systems, and GetSystemTimeAsFileTime () on Windows. The
+	broken-down date and time and the UTC offset are taken from the cache pc points to and
+	are only recomputed when the second changes. Since DST transitions happen at second
+	boundaries, they are picked up too.
+
+	The resolution of a coarse clock is the resolution of the system's timer tick, which
+	is typically between 1 and 4 ms on Linux.
+
+	The functions are not thread-safe for the same cache. Callers that share a cache among
+	several threads must serialise the calls. Different caches can be used concurrently.
+*/
+void GetLocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP *ut, UBF_TIMESTAMP_CACHE *pc);
+
+UBF_TIMESTAMP LocalTimeCached_UBF_TIMESTAMP (UBF_TIMESTAMP_CACHE *pc)
+;
+
 
 EXTERN_C_END
 
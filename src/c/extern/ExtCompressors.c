@@ -44,5 +44,908 @@ When		Who				What
 
 #ifndef CUNILOG_USE_COMBINED_MODULE
 	#include "./ExtCompressors.h"
+
+	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
+		#include "./ubfdebug.h"
+		#include "./ubfmem.h"
+		#include "./unref.h"
+		#ifdef OS_IS_WINDOWS
+			#include "./WinAPI_U8.h"
+		#endif
+	#else
+		#include "./../dbg/ubfdebug.h"
+		#include "./../mem/ubfmem.h"
+		#include "./../pre/unref.h"
+		#ifdef OS_IS_WINDOWS
+			#include "./../OS/Windows/WinAPI_U8.h"
+		#endif
+	#endif
+#endif
+
+#include <string.h>
+#include <stdint.h>
+
+#ifdef PLATFORM_IS_POSIX
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <stdio.h>
+#endif
+
+#ifdef HAVE_ZLIB
+	#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+	#include <zstd.h>
+#endif
+
+#ifdef OS_IS_WINDOWS
+	typedef HANDLE		extcmphandle;
+	#define EXTCMP_INVALID_HANDLE	INVALID_HANDLE_VALUE
+#else
+	typedef int			extcmphandle;
+	#define EXTCMP_INVALID_HANDLE	(-1)
+#endif
+
+/*
+	The source and destination file of a compression, and the buffers. The buffers
+	are allocated together with the temporary file name in one go.
+*/
+typedef struct extcmpfiles
+{
+	extcmphandle		hSrc;
+	extcmphandle		hDst;
+	unsigned char		*pIn;								// EXT_COMPRESSOR_BUF_SIZE octets.
+	unsigned char		*pOut;								// EXT_COMPRESSOR_BUF_SIZE octets.
+	char				*szTmp;								// Name of the temporary file.
+} EXTCMPFILES;
+
+static const char		*ccExtCompressorExtensions [extcompressor_XAmountEnumValues] =
+{
+		".gz"
+	,	".zst"
+};
+
+bool ExtCompressorAvailable (enextcompressor cmp)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	switch (cmp)
+	{
+		case extcompressor_gzip:
+			#ifdef HAVE_ZLIB
+				return true;
+			#else
+				return false;
+			#endif
+		case extcompressor_zstd:
+			#ifdef HAVE_ZSTD
+				return true;
+			#else
+				return false;
+			#endif
+		default:
+			return false;
+	}
+}
+
+const char *ExtCompressorFileExtension (enextcompressor cmp, size_t *plen)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	const char *cc = ccExtCompressorExtensions [cmp];
+	if (plen)
+		*plen = strlen (cc);
+	return cc;
+}
+
+static inline void setExtCmpError (bool bNotSupported)
+{
+	#ifdef OS_IS_WINDOWS
+		SetLastError (bNotSupported ? ERROR_NOT_SUPPORTED : ERROR_INVALID_DATA);
+	#else
+		errno = bNotSupported ? ENOSYS : EIO;
+	#endif
+}
+
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+/*
+	Reads up to EXT_COMPRESSOR_BUF_SIZE octets from the source file into pIn. The number of
+	octets read is returned in *pRead. It is 0 at the end of the file.
+*/
+static bool readExtCmpSrc (EXTCMPFILES *pf, size_t *pRead)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (pRead);
+
+	#ifdef OS_IS_WINDOWS
+		DWORD dwRead;
+		if (!ReadFile (pf->hSrc, pf->pIn, EXT_COMPRESSOR_BUF_SIZE, &dwRead, NULL))
+			return false;
+		*pRead = dwRead;
+		return true;
+	#else
+		ssize_t r;
+		do
+		{
+			r = read (pf->hSrc, pf->pIn, EXT_COMPRESSOR_BUF_SIZE);
+		} while (-1 == r && EINTR == errno);
+		if (-1 == r)
+			return false;
+		*pRead = (size_t) r;
+		return true;
+	#endif
+}
+
+static bool writeExtCmpDst (EXTCMPFILES *pf, const unsigned char *pData, size_t len)
+{
+	ubf_assert_non_NULL (pf);
+
+	#ifdef OS_IS_WINDOWS
+		DWORD dwWritten;
+		while (len)
+		{
+			if (!WriteFile (pf->hDst, pData, (DWORD) len, &dwWritten, NULL))
+				return false;
+			pData	+= dwWritten;
+			len		-= dwWritten;
+		}
+		return true;
+	#else
+		ssize_t w;
+		while (len)
+		{
+			w = write (pf->hDst, pData, len);
+			if (-1 == w)
+			{
+				if (EINTR == errno)
+					continue;
+				return false;
+			}
+			pData	+= w;
+			len		-= (size_t) w;
+		}
+		return true;
+	#endif
+}
+#endif
+
+#ifdef HAVE_ZLIB
+	static bool compressExtCmpGzip (EXTCMPFILES *pf, int level)
+	{
+		ubf_assert_non_NULL (pf);
+
+		z_stream	zs;
+		size_t		stRead;
+		int			flush;
+		int			zr;
+
+		memset (&zs, 0, sizeof (zs));
+		if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+			level = Z_DEFAULT_COMPRESSION;
+		// 15 + 16 selects a window of 32 KiB and a gzip header and trailer.
+		zr = deflateInit2 (&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		if (Z_OK != zr)
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		do
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+				goto Failed;
+			zs.next_in	= pf->pIn;
+			zs.avail_in	= (uInt) stRead;
+			flush		= stRead ? Z_NO_FLUSH : Z_FINISH;
+			do
+			{
+				zs.next_out		= pf->pOut;
+				zs.avail_out	= EXT_COMPRESSOR_BUF_SIZE;
+				zr = deflate (&zs, flush);
+				if (Z_STREAM_ERROR == zr)
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (!writeExtCmpDst (pf, pf->pOut, EXT_COMPRESSOR_BUF_SIZE - zs.avail_out))
+					goto Failed;
+			} while (0 == zs.avail_out);
+		} while (Z_FINISH != flush);
+		ubf_assert (Z_STREAM_END == zr);
+		deflateEnd (&zs);
+		return true;
+
+	Failed:
+		deflateEnd (&zs);
+		return false;
+	}
+#endif
+
+#ifdef HAVE_ZSTD
+	static bool compressExtCmpZstd (EXTCMPFILES *pf, int level)
+	{
+		ubf_assert_non_NULL (pf);
+
+		ZSTD_CCtx			*cctx;
+		ZSTD_inBuffer		zin;
+		ZSTD_outBuffer		zout;
+		ZSTD_EndDirective	mode;
+		size_t				stRead;
+		size_t				zr;
+		bool				bDone;
+
+		cctx = ZSTD_createCCtx ();
+		if (NULL == cctx)
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+			level = ZSTD_CLEVEL_DEFAULT;
+		ZSTD_CCtx_setParameter (cctx, ZSTD_c_compressionLevel, level);
+		ZSTD_CCtx_setParameter (cctx, ZSTD_c_checksumFlag, 1);
+		do
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+				goto Failed;
+			zin.src		= pf->pIn;
+			zin.size	= stRead;
+			zin.pos		= 0;
+			mode		= stRead ? ZSTD_e_continue : ZSTD_e_end;
+			do
+			{
+				zout.dst	= pf->pOut;
+				zout.size	= EXT_COMPRESSOR_BUF_SIZE;
+				zout.pos	= 0;
+				zr = ZSTD_compressStream2 (cctx, &zout, &zin, mode);
+				if (ZSTD_isError (zr))
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (!writeExtCmpDst (pf, pf->pOut, zout.pos))
+					goto Failed;
+				// With ZSTD_e_end, zr is the amount of octets still to be flushed.
+				bDone = ZSTD_e_end == mode ? 0 == zr : zin.pos == zin.size;
+			} while (!bDone);
+		} while (ZSTD_e_end != mode);
+		ZSTD_freeCCtx (cctx);
+		return true;
+
+	Failed:
+		ZSTD_freeCCtx (cctx);
+		return false;
+	}
+#endif
+
+static bool openExtCmpFiles (EXTCMPFILES *pf, const char *szSrc)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (szSrc);
+
+	#ifdef OS_IS_WINDOWS
+		pf->hSrc = CreateFileU8	(
+						szSrc, GENERIC_READ,
+						FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+						NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+								);
+		if (EXTCMP_INVALID_HANDLE == pf->hSrc)
+			return false;
+		pf->hDst = CreateFileU8	(
+						pf->szTmp, GENERIC_WRITE, 0,
+						NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL
+								);
+	#else
+		pf->hSrc = open (szSrc, O_RDONLY | O_CLOEXEC);
+		if (EXTCMP_INVALID_HANDLE == pf->hSrc)
+			return false;
+		pf->hDst = open (pf->szTmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	#endif
+	return EXTCMP_INVALID_HANDLE != pf->hDst;
+}
+
+/*
+	Flushes the temporary file to disk and closes both files. If bMove is true, the
+	temporary file is then renamed to szDst. The temporary file is deleted if anything
+	failed. The error of the first failure is preserved.
+*/
+static bool closeExtCmpFiles (EXTCMPFILES *pf, const char *szDst, bool bMove)
+{
+	ubf_assert_non_NULL (pf);
+	ubf_assert_non_NULL (szDst);
+
+	#ifdef OS_IS_WINDOWS
+		DWORD	err		= ERROR_SUCCESS;
+
+		if (EXTCMP_INVALID_HANDLE != pf->hSrc)
+			CloseHandle (pf->hSrc);
+		if (EXTCMP_INVALID_HANDLE != pf->hDst)
+		{
+			if (bMove && !FlushFileBuffers (pf->hDst))
+				bMove = false;
+			CloseHandle (pf->hDst);
+			if (bMove)
+				bMove = MoveFileExU8	(
+							pf->szTmp, szDst,
+							MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+										);
+			if (!bMove)
+			{
+				err = GetLastError ();
+				DeleteFileU8 (pf->szTmp);
+				SetLastError (err);
+			}
+		}
+	#else
+		int		err;
+
+		if (EXTCMP_INVALID_HANDLE != pf->hSrc)
+			close (pf->hSrc);
+		if (EXTCMP_INVALID_HANDLE != pf->hDst)
+		{
+			if (bMove && 0 != fsync (pf->hDst))
+				bMove = false;
+			if (0 != close (pf->hDst))
+				bMove = false;
+			if (bMove)
+				bMove = 0 == rename (pf->szTmp, szDst);
+			if (!bMove)
+			{
+				err = errno;
+				unlink (pf->szTmp);
+				errno = err;
+			}
+		}
+	#endif
+	return bMove;
+}
+
+bool ExtCompressFileByName	(
+		const char			*szSrc,
+		const char			*szDst,
+		enextcompressor		cmp,
+		int					level
+							)
+{
+	ubf_assert_non_NULL	(szSrc);
+	ubf_assert_non_NULL	(szDst);
+	ubf_assert			(0 <= cmp);
+	ubf_assert			(cmp < extcompressor_XAmountEnumValues);
+
+	if (!ExtCompressorAvailable (cmp))
+	{
+		setExtCmpError (true);
+		return false;
+	}
+
+	size_t			lnDst	= strlen (szDst);
+	EXTCMPFILES		f;
+	bool			b;
+
+	f.pIn = ubf_malloc (2 * EXT_COMPRESSOR_BUF_SIZE + lnDst + sizeof (".tmp"));
+	if (NULL == f.pIn)
+		return false;
+	f.pOut	= f.pIn + EXT_COMPRESSOR_BUF_SIZE;
+	f.szTmp	= (char *) f.pOut + EXT_COMPRESSOR_BUF_SIZE;
+	memcpy (f.szTmp, szDst, lnDst);
+	memcpy (f.szTmp + lnDst, ".tmp", sizeof (".tmp"));
+	f.hSrc	= EXTCMP_INVALID_HANDLE;
+	f.hDst	= EXTCMP_INVALID_HANDLE;
+
+	b = openExtCmpFiles (&f, szSrc);
+	if (b)
+	{
+		switch (cmp)
+		{
+			#ifdef HAVE_ZLIB
+				case extcompressor_gzip:
+					b = compressExtCmpGzip (&f, level);
+					break;
+			#endif
+			#ifdef HAVE_ZSTD
+				case extcompressor_zstd:
+					b = compressExtCmpZstd (&f, level);
+					break;
+			#endif
+			default:
+				UNUSED (level);
+				setExtCmpError (true);
+				b = false;
+				break;
+		}
+	}
+	b = closeExtCmpFiles (&f, szDst, b);
+	ubf_free (f.pIn);
+	return b;
+}
+
+
+/*
+	The state of a frame compressor. The output buffer is enlarged when a frame doesn't
+	fit into it.
+*/
+struct extcmpframer
+{
+	enextcompressor		cmp;
+	int					level;
+	char				*pOut;
+	size_t				siz;								// Size of pOut in octets.
+	size_t				len;								// Octets of the frame in pOut.
+	#ifdef HAVE_ZLIB
+		z_stream		zs;
+	#endif
+	#ifdef HAVE_ZSTD
+		ZSTD_CCtx		*cctx;
+	#endif
+};
+
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+static bool growExtCmpFrameOut (EXTCMPFRAMER *pfr)
+{
+	ubf_assert_non_NULL (pfr);
+
+	char *pc = ubf_realloc (pfr->pOut, 2 * pfr->siz);
+	if (NULL == pc)
+		return false;
+	pfr->pOut	= pc;
+	pfr->siz	*= 2;
+	return true;
+}
+#endif
+
+#ifdef HAVE_ZLIB
+	/*
+		Deflates lnIn octets of pIn into the output buffer of pfr. The frame is complete
+		when the function returns true for Z_FINISH.
+	*/
+	static bool deflateExtCmpFrame (EXTCMPFRAMER *pfr, const char *pIn, size_t lnIn, int flush)
+	{
+		ubf_assert_non_NULL (pfr);
+		// zlib counts in uInt.
+		ubf_assert (lnIn == (uInt) lnIn);
+
+		z_stream	*pzs	= &pfr->zs;
+		int			zr;
+
+		if (0 == lnIn && Z_FINISH != flush)
+			return true;
+		pzs->next_in	= (Bytef *) pIn;
+		pzs->avail_in	= (uInt) lnIn;
+		for (;;)
+		{
+			if (pfr->len == pfr->siz && !growExtCmpFrameOut (pfr))
+				return false;
+			pzs->next_out	= (Bytef *) pfr->pOut + pfr->len;
+			pzs->avail_out	= (uInt) (pfr->siz - pfr->len);
+			zr = deflate (pzs, flush);
+			pfr->len = pfr->siz - pzs->avail_out;
+			if (Z_STREAM_ERROR == zr)
+				return false;
+			if (Z_FINISH == flush ? Z_STREAM_END == zr : 0 == pzs->avail_in && pzs->avail_out)
+				return true;
+		}
+	}
+#endif
+
+#ifdef HAVE_ZSTD
+	/*
+		Compresses lnIn octets of pIn into the output buffer of pfr. The frame is complete
+		when the function returns true for ZSTD_e_end.
+	*/
+	static bool zstdExtCmpFrame (EXTCMPFRAMER *pfr, const char *pIn, size_t lnIn, ZSTD_EndDirective mode)
+	{
+		ubf_assert_non_NULL (pfr);
+
+		ZSTD_inBuffer		zin;
+		ZSTD_outBuffer		zout;
+		size_t				zr;
+
+		if (0 == lnIn && ZSTD_e_end != mode)
+			return true;
+		zin.src		= pIn;
+		zin.size	= lnIn;
+		zin.pos		= 0;
+		for (;;)
+		{
+			if (pfr->len == pfr->siz && !growExtCmpFrameOut (pfr))
+				return false;
+			zout.dst	= pfr->pOut;
+			zout.size	= pfr->siz;
+			zout.pos	= pfr->len;
+			zr = ZSTD_compressStream2 (pfr->cctx, &zout, &zin, mode);
+			pfr->len = zout.pos;
+			if (ZSTD_isError (zr))
+				return false;
+			// With ZSTD_e_end, zr is the amount of octets still to be flushed.
+			if (ZSTD_e_end == mode ? 0 == zr : zin.pos == zin.size)
+				return true;
+		}
+	}
+#endif
+
+EXTCMPFRAMER *CreateEXTCMPFRAMER (enextcompressor cmp, int level)
+{
+	ubf_assert (0 <= cmp);
+	ubf_assert (cmp < extcompressor_XAmountEnumValues);
+
+	if (!ExtCompressorAvailable (cmp))
+	{
+		setExtCmpError (true);
+		return NULL;
+	}
+
+	EXTCMPFRAMER *pfr = ubf_malloc (sizeof (EXTCMPFRAMER));
+	if (NULL == pfr)
+		return NULL;
+	memset (pfr, 0, sizeof (EXTCMPFRAMER));
+	pfr->cmp	= cmp;
+	pfr->level	= level;
+	pfr->pOut	= ubf_malloc (EXT_COMPRESSOR_BUF_SIZE);
+	if (NULL == pfr->pOut)
+		goto Failed;
+	pfr->siz	= EXT_COMPRESSOR_BUF_SIZE;
+	switch (cmp)
+	{
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+					level = Z_DEFAULT_COMPRESSION;
+				// 15 + 16 selects a window of 32 KiB and a gzip header and trailer.
+				if (Z_OK != deflateInit2 (&pfr->zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY))
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				pfr->cctx = ZSTD_createCCtx ();
+				if (NULL == pfr->cctx)
+				{
+					setExtCmpError (false);
+					goto Failed;
+				}
+				if (EXT_COMPRESSOR_DEFAULT_LEVEL == level)
+					level = ZSTD_CLEVEL_DEFAULT;
+				ZSTD_CCtx_setParameter (pfr->cctx, ZSTD_c_compressionLevel, level);
+				ZSTD_CCtx_setParameter (pfr->cctx, ZSTD_c_checksumFlag, 1);
+				break;
+		#endif
+		default:
+			UNUSED (level);
+			break;
+	}
+	return pfr;
+
+Failed:
+	DoneEXTCMPFRAMER (pfr);
+	return NULL;
+}
+
+void DoneEXTCMPFRAMER (EXTCMPFRAMER *pfr)
+{
+	if (NULL == pfr)
+		return;
+	switch (pfr->cmp)
+	{
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				// Also fine if deflateInit2 () failed.
+				deflateEnd (&pfr->zs);
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				ZSTD_freeCCtx (pfr->cctx);
+				break;
+		#endif
+		default:
+			break;
+	}
+	ubf_free_accept_NULL (pfr->pOut);
+	ubf_free (pfr);
+}
+
+const char *ExtCompressFrame	(
+		EXTCMPFRAMER		*pfr,
+		const char			*p1,
+		size_t				ln1,
+		const char			*p2,
+		size_t				ln2,
+		size_t				*plnFrame
+								)
+{
+	ubf_assert_non_NULL (pfr);
+	ubf_assert_non_NULL (plnFrame);
+
+	bool b;
+
+	pfr->len = 0;
+	switch (pfr->cmp)
+	{
+		#ifdef HAVE_ZLIB
+			case extcompressor_gzip:
+				// Every frame is a gzip member of its own.
+				b =		Z_OK == deflateReset (&pfr->zs)
+					&&	deflateExtCmpFrame (pfr, p1, ln1, Z_NO_FLUSH)
+					&&	deflateExtCmpFrame (pfr, p2, ln2, Z_FINISH);
+				break;
+		#endif
+		#ifdef HAVE_ZSTD
+			case extcompressor_zstd:
+				// The parameters are kept. The frame header gets the content size.
+				b =		!ZSTD_isError (ZSTD_CCtx_reset (pfr->cctx, ZSTD_reset_session_only))
+					&&	!ZSTD_isError (ZSTD_CCtx_setPledgedSrcSize (pfr->cctx, ln1 + ln2))
+					&&	zstdExtCmpFrame (pfr, p1, ln1, ZSTD_e_continue)
+					&&	zstdExtCmpFrame (pfr, p2, ln2, ZSTD_e_end);
+				break;
+		#endif
+		default:
+			UNUSED (p1);
+			UNUSED (ln1);
+			UNUSED (p2);
+			UNUSED (ln2);
+			b = false;
+			break;
+	}
+	if (!b)
+	{
+		setExtCmpError (false);
+		return NULL;
+	}
+	*plnFrame = pfr->len;
+	return pfr->pOut;
+}
+
+#ifdef HAVE_ZLIB
+	/*
+		Inflates the gzip members of the source file of pf one after the other. The offset
+		behind the last complete member is written to *pullValid, the size of the file to
+		*pullSize.
+	*/
+	static bool scanExtCmpGzipFrames (EXTCMPFILES *pf, uint64_t *pullValid, uint64_t *pullSize)
+	{
+		ubf_assert_non_NULL (pf);
+		ubf_assert_non_NULL (pullValid);
+		ubf_assert_non_NULL (pullSize);
+
+		z_stream	zs;
+		size_t		stRead;
+		bool		bFrames	= true;
+		int			zr;
+
+		memset (&zs, 0, sizeof (zs));
+		// 15 + 16 expects a window of up to 32 KiB and a gzip header and trailer.
+		if (Z_OK != inflateInit2 (&zs, 15 + 16))
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		*pullValid	= 0;
+		*pullSize	= 0;
+		for (;;)
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+			{
+				inflateEnd (&zs);
+				return false;
+			}
+			if (0 == stRead)
+				break;
+			*pullSize	+= stRead;
+			zs.next_in	= pf->pIn;
+			zs.avail_in	= (uInt) stRead;
+			// Once the data isn't a gzip member anymore we only obtain the file size.
+			while (bFrames && (zs.avail_in || 0 == zs.avail_out))
+			{
+				zs.next_out		= pf->pOut;
+				zs.avail_out	= EXT_COMPRESSOR_BUF_SIZE;
+				zr = inflate (&zs, Z_NO_FLUSH);
+				if (Z_STREAM_END == zr)
+				{
+					*pullValid = *pullSize - zs.avail_in;
+					inflateReset (&zs);
+				} else
+				if (Z_OK != zr)
+					bFrames = false;
+			}
+		}
+		inflateEnd (&zs);
+		return true;
+	}
+#endif
+
+#ifdef HAVE_ZSTD
+	/*
+		Decompresses the zstd frames of the source file of pf one after the other. The
+		offset behind the last complete frame is written to *pullValid, the size of the file
+		to *pullSize.
+	*/
+	static bool scanExtCmpZstdFrames (EXTCMPFILES *pf, uint64_t *pullValid, uint64_t *pullSize)
+	{
+		ubf_assert_non_NULL (pf);
+		ubf_assert_non_NULL (pullValid);
+		ubf_assert_non_NULL (pullSize);
+
+		ZSTD_DCtx		*dctx;
+		ZSTD_inBuffer	zin;
+		ZSTD_outBuffer	zout;
+		size_t			stRead;
+		size_t			zr;
+		bool			bFrames	= true;
+
+		dctx = ZSTD_createDCtx ();
+		if (NULL == dctx)
+		{
+			setExtCmpError (false);
+			return false;
+		}
+		*pullValid	= 0;
+		*pullSize	= 0;
+		zout.dst	= pf->pOut;
+		zout.size	= EXT_COMPRESSOR_BUF_SIZE;
+		zout.pos	= 0;
+		for (;;)
+		{
+			if (!readExtCmpSrc (pf, &stRead))
+			{
+				ZSTD_freeDCtx (dctx);
+				return false;
+			}
+			if (0 == stRead)
+				break;
+			*pullSize	+= stRead;
+			zin.src		= pf->pIn;
+			zin.size	= stRead;
+			zin.pos		= 0;
+			// Once the data isn't a zstd frame anymore we only obtain the file size.
+			while (bFrames && (zin.pos < zin.size || zout.pos == zout.size))
+			{
+				zout.pos = 0;
+				zr = ZSTD_decompressStream (dctx, &zout, &zin);
+				if (ZSTD_isError (zr))
+					bFrames = false;
+				else
+				if (0 == zr)
+					*pullValid = *pullSize - (zin.size - zin.pos);
+			}
+		}
+		ZSTD_freeDCtx (dctx);
+		return true;
+	}
 #endif
 
+#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+	/*
+		Returns true if the source file of pf starts with the magic number of a frame of the
+		compressor cmp. The file position is reset to the start of the file.
+	*/
+	static bool hasExtCmpFrameMagic (EXTCMPFILES *pf, enextcompressor cmp)
+	{
+		ubf_assert_non_NULL (pf);
+
+		static const unsigned char	ucGzip [] = {0x1F, 0x8B};
+		static const unsigned char	ucZstd [] = {0x28, 0xB5, 0x2F, 0xFD};
+		const unsigned char			*puc	= extcompressor_gzip == cmp ? ucGzip : ucZstd;
+		size_t						ln		=
+			extcompressor_gzip == cmp ? sizeof (ucGzip) : sizeof (ucZstd);
+		size_t						stRead;
+		bool						b;
+
+		b = readExtCmpSrc (pf, &stRead) && stRead >= ln && 0 == memcmp (pf->pIn, puc, ln);
+		#ifdef OS_IS_WINDOWS
+			LARGE_INTEGER li;
+			li.QuadPart = 0;
+			SetFilePointerEx (pf->hSrc, li, NULL, FILE_BEGIN);
+		#else
+			lseek (pf->hSrc, 0, SEEK_SET);
+		#endif
+		return b;
+	}
+
+	/*
+		Cuts the file szFile off after ullValid octets.
+	*/
+	static bool truncateExtCmpFile (const char *szFile, uint64_t ullValid)
+	{
+		ubf_assert_non_NULL (szFile);
+
+		#ifdef OS_IS_WINDOWS
+			HANDLE			h;
+			LARGE_INTEGER	li;
+			bool			b;
+
+			h = CreateFileU8	(
+					szFile, GENERIC_WRITE,
+					FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+					NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+								);
+			if (INVALID_HANDLE_VALUE == h)
+				return false;
+			li.QuadPart = (LONGLONG) ullValid;
+			b = SetFilePointerEx (h, li, NULL, FILE_BEGIN) && SetEndOfFile (h);
+			CloseHandle (h);
+			return b;
+		#else
+			return 0 == truncate (szFile, (off_t) ullValid);
+		#endif
+	}
+#endif
+
+bool ExtCompressFramesRepairFile (EXTCMPFRAMER *pfr, const char *szFile)
+{
+	ubf_assert_non_NULL (pfr);
+	ubf_assert_non_NULL (szFile);
+
+	#if defined (HAVE_ZLIB) || defined (HAVE_ZSTD)
+		EXTCMPFILES		f;
+		uint64_t		ullValid	= 0;
+		uint64_t		ullSize		= 0;
+		bool			bMagic;
+		bool			b;
+
+		f.pIn = ubf_malloc (2 * EXT_COMPRESSOR_BUF_SIZE);
+		if (NULL == f.pIn)
+			return false;
+		f.pOut	= f.pIn + EXT_COMPRESSOR_BUF_SIZE;
+		f.szTmp	= NULL;
+		f.hDst	= EXTCMP_INVALID_HANDLE;
+		#ifdef OS_IS_WINDOWS
+			f.hSrc = CreateFileU8	(
+							szFile, GENERIC_READ,
+							FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+							NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+									);
+			if (EXTCMP_INVALID_HANDLE == f.hSrc)
+			{
+				ubf_free (f.pIn);
+				return ERROR_FILE_NOT_FOUND == GetLastError ();
+			}
+		#else
+			f.hSrc = open (szFile, O_RDONLY | O_CLOEXEC);
+			if (EXTCMP_INVALID_HANDLE == f.hSrc)
+			{
+				ubf_free (f.pIn);
+				return ENOENT == errno;
+			}
+		#endif
+		bMagic = hasExtCmpFrameMagic (&f, pfr->cmp);
+		switch (pfr->cmp)
+		{
+			#ifdef HAVE_ZLIB
+				case extcompressor_gzip:
+					b = scanExtCmpGzipFrames (&f, &ullValid, &ullSize);
+					break;
+			#endif
+			#ifdef HAVE_ZSTD
+				case extcompressor_zstd:
+					b = scanExtCmpZstdFrames (&f, &ullValid, &ullSize);
+					break;
+			#endif
+			default:
+				setExtCmpError (true);
+				b = false;
+				break;
+		}
+		#ifdef OS_IS_WINDOWS
+			CloseHandle (f.hSrc);
+		#else
+			close (f.hSrc);
+		#endif
+		ubf_free (f.pIn);
+		if (!b || ullValid == ullSize)
+			return b;
+		// A file that starts with a frame is ours. Only its end is torn.
+		if (ullValid || bMagic)
+			return truncateExtCmpFile (szFile, ullValid);
+		return ExtCompressFileByName (szFile, szFile, pfr->cmp, pfr->level);
+	#else
+		UNUSED (pfr);
+		UNUSED (szFile);
+		setExtCmpError (true);
+		return false;
+	#endif
+}
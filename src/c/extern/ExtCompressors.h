@@ -53,11 +53,14 @@ When		Who				What
 
 #include <stdbool.h>
 
+#include <stddef.h>
+
 #ifndef CUNILOG_USE_COMBINED_MODULE
 
 	#ifdef UBF_USE_FLAT_FOLDER_STRUCTURE
 
 	#include "./platform.h"
+	#include "./externC.h"
 
 		#if defined (OS_IS_WINDOWS)
 			//#include "./CompressNTFS_U8.h"
@@ -68,6 +71,7 @@ When		Who				What
 	#else
 
 		#include "./../pre/platform.h"
+		#include "./../pre/externC.h"
 
 		#if defined (OS_IS_WINDOWS)
 			//#include "./Windows/CompressNTFS_U8.h"
@@ -79,5 +83,165 @@ When		Who				What
 
 #endif
 
+/*
+	The compressors are only available if the application defines HAVE_ZLIB (gzip) or
+	HAVE_ZSTD (zstd) and links to the respective library, i.e. -lz and/or -lzstd.
+	Without these definitions, the compression functions below fail.
+*/
+
+EXTERN_C_BEGIN
+
+/*
+	enextcompressor
+
+	The external compressors supported.
+*/
+enum enextcompressor
+{
+		extcompressor_gzip								// Deflate in a gzip container (".gz").
+	,	extcompressor_zstd								// Zstandard (".zst").
+
+	// Do not add anything below this line.
+	,	extcompressor_XAmountEnumValues					// Used for table sizes.
+	// Do not add anything below extcompressor_XAmountEnumValues.
+};
+typedef enum enextcompressor enextcompressor;
+
+/*
+	The size of the input and the output buffer of a compression, in octets. Together
+	with the state of the compressor, this is all the memory a compression requires,
+	independent of the size of the file.
+*/
+#ifndef EXT_COMPRESSOR_BUF_SIZE
+#define EXT_COMPRESSOR_BUF_SIZE				(64 * 1024)
+#endif
+
+/*
+	The compression level that selects the default level of the compressor.
+*/
+#define EXT_COMPRESSOR_DEFAULT_LEVEL		(-1)
+
+/*
+	ExtCompressorAvailable
+
+	Returns true if the compressor cmp has been built in, false otherwise.
+*/
+bool ExtCompressorAvailable (enextcompressor cmp)
+;
+
+/*
+	ExtCompressorFileExtension
+
+	Returns the file name extension of the compressor cmp, including the dot, for
+	instance ".gz" for extcompressor_gzip. If plen is not NULL, the function writes the
+	length of the extension to the address it points to.
+*/
+const char *ExtCompressorFileExtension (enextcompressor cmp, size_t *plen)
+;
+
+/*
+	ExtCompressFileByName
+
+	Compresses the file szSrc with the compressor cmp into the file szDst. The file is
+	read and compressed in chunks of EXT_COMPRESSOR_BUF_SIZE octets.
+
+	The compressed data is written to a temporary file in the same folder, which has the
+	name szDst with ".tmp" appended. This file is flushed to disk and then renamed to
+	szDst, which replaces a file szDst that may exist already. This ensures that szDst
+	is either complete or doesn't exist. The file szSrc is not changed or deleted.
+
+	The parameter level is the compression level, or EXT_COMPRESSOR_DEFAULT_LEVEL for the
+	compressor's default level.
+
+	The function returns true on success, false otherwise. If the function fails,
+	errno on POSIX or the value of GetLastError () on Windows contains the reason, which
+	is ENOSYS or ERROR_NOT_SUPPORTED respectively if the compressor hasn't been built in.
+	The temporary file is deleted in this case.
+*/
+bool ExtCompressFileByName	(
+		const char			*szSrc,
+		const char			*szDst,
+		enextcompressor		cmp,
+		int					level
+							)
+;
+
+/*
+	EXTCMPFRAMER
+
+	A compressor that compresses data into independent frames, i.e. complete gzip members
+	or zstd frames. Each frame can be decompressed without any of the frames before it.
+	Frames written one after the other to the same file form a valid gzip or zstd file
+	that the command line tools decompress as a whole. If the file is truncated, for
+	instance because the process or the machine crashed while a frame was written, all
+	frames before the incomplete one can still be decompressed.
+
+	The structure is opaque. See CreateEXTCMPFRAMER ().
+*/
+typedef struct extcmpframer EXTCMPFRAMER;
+
+/*
+	CreateEXTCMPFRAMER
+
+	Creates a frame compressor for the compressor cmp with the compression level level,
+	or EXT_COMPRESSOR_DEFAULT_LEVEL for the compressor's default level. The state of the
+	compressor and its output buffer are reused for every frame.
+
+	The function returns a pointer to the new frame compressor, or NULL if the compressor
+	hasn't been built in or if not enough memory is available. The frame compressor must
+	be destroyed with DoneEXTCMPFRAMER () when it is not needed anymore.
+*/
+EXTCMPFRAMER *CreateEXTCMPFRAMER (enextcompressor cmp, int level)
+;
+
+/*
+	DoneEXTCMPFRAMER
+
+	Destroys the frame compressor pfr points to. The parameter pfr can be NULL.
+*/
+void DoneEXTCMPFRAMER (EXTCMPFRAMER *pfr)
+;
+
+/*
+	ExtCompressFrame
+
+	Compresses the ln1 octets p1 points to, followed by the ln2 octets p2 points to, into
+	a single frame. Either of the two can be empty.
+
+	The function returns a pointer to the frame, and writes its length to the address
+	plnFrame points to. The frame stays valid until ExtCompressFrame () or
+	DoneEXTCMPFRAMER () is called again for pfr. The function returns NULL if the data
+	could not be compressed or the output buffer could not be enlarged.
+*/
+const char *ExtCompressFrame	(
+		EXTCMPFRAMER		*pfr,
+		const char			*p1,
+		size_t				ln1,
+		const char			*p2,
+		size_t				ln2,
+		size_t				*plnFrame
+								)
+;
+
+/*
+	ExtCompressFramesRepairFile
+
+	Makes sure that the file szFile, to which the frames of pfr are going to be appended,
+	consists of complete frames of the compressor of pfr only.
+
+	Data after the last complete frame, like a frame that was still being written when the
+	process or the machine crashed, is cut off. If the file doesn't start with a frame of
+	this compressor at all, for instance because it has been written uncompressed so far,
+	its content is compressed into a single frame first (see ExtCompressFileByName ()).
+	The file is read once completely to find the end of the last complete frame.
+
+	The function returns true if the file consists of complete frames afterwards, is empty,
+	or doesn't exist. It returns false if the file could not be read or changed.
+*/
+bool ExtCompressFramesRepairFile (EXTCMPFRAMER *pfr, const char *szFile)
+;
+
+EXTERN_C_END
+
 
 #endif														// Of #ifndef U_EXTCOMPRESSORS_H.
@@ -61,6 +61,7 @@ When		Who				What
 		#include "./strhex.h"
 		#include "./check_utf8.h"
 		#include "./ProcessHelpers.h"
+		#include "./ExtCompressors.h"
 
 		// Required for the tests.
 		#include "./ubfdebug.h"
@@ -86,6 +87,7 @@ When		Who				What
 		#include "./../string/strwildcards.h"
 		#include "./../string/check_utf8.h"
 		#include "./../OS/ProcessHelpers.h"
+		#include "./../extern/ExtCompressors.h"
 
 		// Required for the tests.
 		#include "./../dbg/ubfdebug.h"
@@ -100,6 +102,18 @@ When		Who				What
 
 #endif
 
+#include <stdio.h>
+
+#ifdef PLATFORM_IS_POSIX
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+#endif
+
+#ifdef HAVE_ZLIB
+	#include <zlib.h>
+#endif
+
 void CunilogTestFnctStartTestToConsole (const char *ccTestText)
 {
 	ubf_assert_non_NULL (ccTestText);
@@ -147,6 +161,263 @@ static bool testV (CUNILOG_TARGET *put, char *sz, ...)
 	return b;
 }
 
+static bool countEventsProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+{
+	ubf_assert_non_NULL (cup);
+	UNUSED (pev);
+
+	CUNILOG_CUSTPROCESS *pcp = cup->pData;
+	size_t *pn = pcp->pCust;
+	++ *pn;
+	return true;
+}
+
+static bool countBatchesProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_BATCHEVENT *pbes, size_t n)
+{
+	ubf_assert_non_NULL (cup);
+	ubf_assert_non_NULL (pbes);
+
+	CUNILOG_CUSTPROCESS *pcp = cup->pData;
+	size_t *pn = pcp->pCust;
+	++ pn [0];														// Calls.
+	pn [1] += n;													// Events.
+	// Every event comes with its own event line.
+	size_t u;
+	for (u = 0; u < n; ++ u)
+	{
+		if	(
+					NULL == pbes [u].szLine
+				||	strlen (pbes [u].szLine) != pbes [u].lnLine
+				||	NULL == strstr (pbes [u].szLine, "atched event")
+				||	(u && pbes [u].szLine == pbes [u - 1].szLine)
+			)
+			++ pn [2];												// Bad lines.
+	}
+	return true;
+}
+
+/*
+	Returns true if the logfile of put with the postfix szPostfix appended to its name,
+	for instance ".1" for the logfile rotated last with a dot number postfix, exists.
+*/
+static bool logfileWithPostfixExists (CUNILOG_TARGET *put, const char *szPostfix)
+{
+	char	szName [1024];
+	FILE	*f;
+
+	if (sizeof (szName) <= strlen (put->mbLogfileName.buf.pcc) + strlen (szPostfix))
+		return false;
+	strcpy (szName, put->mbLogfileName.buf.pcc);
+	strcat (szName, szPostfix);
+	f = fopen (szName, "rb");
+	if (NULL == f)
+		return false;
+	fclose (f);
+	return true;
+}
+
+#ifdef HAVE_ZLIB
+	/*
+		Decompresses the gzip file szFile into a NUL-terminated buffer, which the caller
+		frees with ubf_free (). Returns NULL if szFile isn't a complete gzip file.
+	*/
+	static char *readGzipFile (const char *szFile)
+	{
+		gzFile	gz		= gzopen (szFile, "rb");
+		size_t	siz		= 4096;
+		size_t	len		= 0;
+		char	*sz;
+		char	*szNew;
+		int		n		= 0;
+		bool	b;
+
+		if (NULL == gz)
+			return NULL;
+		sz = ubf_malloc (siz);
+		szNew = sz;
+		while (szNew && 0 <= (n = gzread (gz, sz + len, (unsigned) (siz - len - 1))) && n)
+		{
+			len += (size_t) n;
+			if (siz - len < 2)
+			{
+				siz *= 2;
+				szNew = ubf_realloc (sz, siz);
+				if (szNew)
+					sz = szNew;
+			}
+		}
+		// A file that isn't compressed is read transparently.
+		b = szNew && 0 == n && !gzdirect (gz);
+		b &= Z_OK == gzclose (gz);
+		if (!b)
+		{
+			ubf_free_accept_NULL (sz);
+			return NULL;
+		}
+		sz [len] = '\0';
+		return sz;
+	}
+
+	/*
+		Returns true if the events of the NULL-terminated array ccEvents come last in sz
+		and in the order given.
+	*/
+	static bool gzipEventsInOrder (const char *sz, const char **ccEvents)
+	{
+		const char	*cc		= NULL;
+		const char	*ccNext;
+
+		// The logfile may contain the events of earlier test runs.
+		for (ccNext = strstr (sz, ccEvents [0]); ccNext; ccNext = strstr (ccNext + 1, ccEvents [0]))
+			cc = ccNext;
+		while (cc && *++ ccEvents)
+			cc = strstr (cc, *ccEvents);
+		if (NULL == cc)
+			return false;
+		cc = strchr (cc, '\n');
+		return NULL != cc && '\0' == cc [1];
+	}
+#endif
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	#define STAGING_TEST_THREADS		(4)
+
+	/*
+		The events of the staging tests. Only the separate logging thread changes the
+		members nNext, nEvents, and nBad.
+	*/
+	typedef struct stagingtest
+	{
+		CUNILOG_TARGET		*put;
+		unsigned int		nEventsPerThread;
+		unsigned int		nNext [STAGING_TEST_THREADS];
+		size_t				nEvents;
+		size_t				nBad;
+	} STAGINGTEST;
+
+	typedef struct stagingtestthread
+	{
+		STAGINGTEST			*pst;
+		unsigned int		nThread;
+		#ifdef OS_IS_WINDOWS
+			HANDLE			h;
+		#else
+			pthread_t		t;
+		#endif
+	} STAGINGTESTTHREAD;
+
+	/*
+		Checks that the events of every thread arrive complete and in order.
+	*/
+	static bool stagingTestProcessor (CUNILOG_PROCESSOR *cup, CUNILOG_EVENT *pev)
+	{
+		ubf_assert_non_NULL (cup);
+		ubf_assert_non_NULL (pev);
+
+		CUNILOG_CUSTPROCESS	*pcp	= cup->pData;
+		STAGINGTEST			*pst	= pcp->pCust;
+		char				sz [64];
+		unsigned int		nThread;
+		unsigned int		nEvent;
+		size_t				ln		= pev->lenDataToLog < sizeof (sz) - 1
+										? pev->lenDataToLog : sizeof (sz) - 1;
+
+		memcpy (sz, pev->szDataToLog, ln);
+		sz [ln] = '\0';
+		++ pst->nEvents;
+		if	(
+					2 != sscanf (sz, "Staging thread %u event %u", &nThread, &nEvent)
+				||	STAGING_TEST_THREADS <= nThread
+				||	pst->nNext [nThread] != nEvent
+			)
+			++ pst->nBad;
+		else
+			++ pst->nNext [nThread];
+		return true;
+	}
+
+	#ifdef OS_IS_WINDOWS
+		static DWORD WINAPI stagingTestThread (LPVOID pv)
+	#else
+		static void *stagingTestThread (void *pv)
+	#endif
+	{
+		STAGINGTESTTHREAD	*ptt	= pv;
+		unsigned int		n;
+
+		for (n = 0; n < ptt->pst->nEventsPerThread; ++ n)
+		{
+			logTextU8fmt (ptt->pst->put, "Staging thread %u event %u", ptt->nThread, n);
+		}
+		#ifdef OS_IS_WINDOWS
+			return 0;
+		#else
+			return NULL;
+		#endif
+	}
+
+	/*
+		Runs nThreads threads that log their events to the target of pst and waits for them
+		to exit.
+	*/
+	static bool runStagingTestThreads (STAGINGTEST *pst, unsigned int nThreads)
+	{
+		ubf_assert_non_NULL (pst);
+		ubf_assert (nThreads <= STAGING_TEST_THREADS);
+
+		STAGINGTESTTHREAD	tt [STAGING_TEST_THREADS];
+		unsigned int		n;
+		unsigned int		nStarted;
+		bool				b		= true;
+
+		for (nStarted = 0; nStarted < nThreads; ++ nStarted)
+		{
+			tt [nStarted].pst		= pst;
+			tt [nStarted].nThread	= nStarted;
+			#ifdef OS_IS_WINDOWS
+				tt [nStarted].h = CreateThread	(
+										NULL, 0, stagingTestThread, &tt [nStarted], 0, NULL
+												);
+				if (NULL == tt [nStarted].h)
+					break;
+			#else
+				if (pthread_create (&tt [nStarted].t, NULL, stagingTestThread, &tt [nStarted]))
+					break;
+			#endif
+		}
+		b &= nStarted == nThreads;
+		for (n = 0; n < nStarted; ++ n)
+		{
+			#ifdef OS_IS_WINDOWS
+				WaitForSingleObject (tt [n].h, INFINITE);
+				CloseHandle (tt [n].h);
+			#else
+				pthread_join (tt [n].t, NULL);
+			#endif
+		}
+		return b;
+	}
+
+	static CUNILOG_TARGET *createStagingTestTarget	(
+				const char			*ccLogsFolder,
+				size_t				lnLogsFolder,
+				CUNILOG_PROCESSOR	**cps
+													)
+	{
+		return CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"stagingthreads", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDay,
+					cps, 1,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+	}
+#endif
+
 static size_t	stTestState;
 
 errCBretval CunilogTestFnctTestInitialThreshold (CUNILOG_ERROR error, CUNILOG_PROCESSOR *cup)
@@ -828,6 +1099,1492 @@ bool CunilogTestFunction	(
 
 	DoneCUNILOG_TARGET (put);
 
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Creating target with lock-free queue...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetLockFreeQueue (put);
+		cunilogSetNoEcho (put);
+
+		CunilogTestFnctStartTestToConsole ("Logging through lock-free queue...");
+		unsigned int nlf = 1000;
+		while (nlf --)
+		{
+			b &= logTextU8 (put, "Lock-free queue event.");
+		}
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with lock-free queue...");
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= cunilogTargetHasShutdownCompleteFlag (put) ? true : false;
+		b &= NULL == put->qu.head;
+		b &= 0 == put->qu.num;
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Creating target with bounded queue...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+
+		// While paused the queue isn't emptied, which makes the results predictable.
+		CunilogTestFnctStartTestToConsole ("Dropping oldest events of bounded queue...");
+		ConfigCUNILOG_TARGETqueueLimit (put, 10, cunilogQueueFullDropOldest, cunilogEvtSeverityNone);
+		PauseLogCUNILOG_TARGET (put);
+		unsigned int nbq;
+		for (nbq = 0; nbq < 25; ++ nbq)
+		{
+			logTextU8sev (put, cunilogEvtSeverityInfo, "Bounded queue event.");
+		}
+		b &= 10 == put->qu.num;
+		b &= 15 == put->nDroppedEvents [cunilogEvtSeverityInfo];
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Dropping events below severity threshold...");
+		ConfigCUNILOG_TARGETqueueLimit (put, 10, cunilogQueueFullDropBelowSeverity, cunilogEvtSeverityWarning);
+		// Dropped events are not an error. Error events make room by dropping queued
+		//	info events.
+		for (nbq = 0; nbq < 5; ++ nbq)
+		{
+			b &= logTextU8sev (put, cunilogEvtSeverityDebug, "Bounded queue debug event.");
+			logTextU8sev (put, cunilogEvtSeverityError, "Bounded queue error event.");
+		}
+		b &= 10 == put->qu.num;
+		b &= 5 == put->nDroppedEvents [cunilogEvtSeverityDebug];
+		b &= 20 == put->nDroppedEvents [cunilogEvtSeverityInfo];
+		b &= 0 == put->nDroppedEvents [cunilogEvtSeverityError];
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Bounding queue of important events...");
+		for (nbq = 0; nbq < 5; ++ nbq)
+		{
+			logTextU8sev (put, cunilogEvtSeverityError, "Bounded queue error event.");
+		}
+		b &= 0 == put->nDroppedEvents [cunilogEvtSeverityError];
+		// Nothing less important left to drop, and we can't wait while paused.
+		b &= logTextU8sev (put, cunilogEvtSeverityError, "Bounded queue error event.");
+		b &= 10 == put->qu.num;
+		b &= 25 == put->nDroppedEvents [cunilogEvtSeverityInfo];
+		b &= 1 == put->nDroppedEvents [cunilogEvtSeverityError];
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Dropping newest events of paused blocking queue...");
+		ConfigCUNILOG_TARGETqueueLimit (put, 10, cunilogQueueFullBlock, cunilogEvtSeverityNone);
+		b &= logTextU8sev (put, cunilogEvtSeverityInfo, "Bounded queue event.");
+		b &= 10 == put->qu.num;
+		b &= 26 == put->nDroppedEvents [cunilogEvtSeverityInfo];
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with bounded queue...");
+		ResumeLogCUNILOG_TARGET (put);
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= cunilogTargetHasShutdownCompleteFlag (put) ? true : false;
+		b &= 0 == put->qu.num;
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Creating target with staging buffers...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= ConfigCUNILOG_TARGETstagingBuffers (put, 64, 0, 0);
+		ConfigCUNILOG_TARGETcachedTimestamps (put);
+		b &= cunilogHasCachedTimestamps (put) ? true : false;
+
+		// Without a latency the last incomplete batch stays in the staging buffer.
+		CunilogTestFnctStartTestToConsole ("Staging events in batches...");
+		unsigned int nst;
+		for (nst = 0; nst < 1000; ++ nst)
+		{
+			logTextU8 (put, "Staged event.");
+		}
+		b &= NULL != put->stagings;
+		b &= NULL != put->stagings && 1000 % 64 == put->stagings->num;
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with staging buffers...");
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= cunilogTargetHasShutdownCompleteFlag (put) ? true : false;
+		b &= NULL != put->stagings && 0 == put->stagings->num;
+		b &= 0 == put->qu.num;
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Creating target with staging buffers and blocking queue...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= ConfigCUNILOG_TARGETstagingBuffers (put, 64, 0, 1);
+		ConfigCUNILOG_TARGETqueueLimit (put, 2, cunilogQueueFullBlock, cunilogEvtSeverityNone);
+
+		// The separate logging thread hands the stale events over. It can't wait for
+		//	space in the queue but must not drop them either.
+		CunilogTestFnctStartTestToConsole ("Publishing stale staged events on logging thread...");
+		unsigned int nsb;
+		for (nsb = 0; nsb < 10; ++ nsb)
+		{
+			logTextU8 (put, "Staged event.");
+		}
+		for (nsb = 0; nsb < 1000; ++ nsb)
+		{
+			if (NULL != put->stagings && 0 == put->stagings->num)
+				break;
+			Sleep_ms (1);
+		}
+		b &= NULL != put->stagings && 0 == put->stagings->num;
+		for (nsb = 0; nsb < cunilogEvtSeverityXAmountEnumValues; ++ nsb)
+		{
+			b &= 0 == put->nDroppedEvents [nsb];
+		}
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with staging buffers and blocking queue...");
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= cunilogTargetHasShutdownCompleteFlag (put) ? true : false;
+		b &= 0 == put->qu.num;
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Staging events of several threads...");
+		STAGINGTEST				stt;
+		CUNILOG_CUSTPROCESS		cuStt		= {&stt, stagingTestProcessor, NULL, NULL};
+		CUNILOG_PROCESSOR		cpStt		=
+			{
+				cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+				&cuStt, OPT_CUNPROC_NONE, 0, 0
+			};
+		CUNILOG_PROCESSOR		*cpsStt []	= {&cpStt};
+		memset (&stt, 0, sizeof (stt));
+		put = createStagingTestTarget (ccLogsFolder, lnLogsFolder, cpsStt);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		stt.put					= put;
+		stt.nEventsPerThread	= 1000;
+		// A size limit alone switches staging buffers on.
+		b &= ConfigCUNILOG_TARGETstagingBuffers (put, 0, 1024, 0);
+		b &= put->bStaging;
+		b &= runStagingTestThreads (&stt, STAGING_TEST_THREADS);
+		// The threads have exited. Their staging buffers are gone.
+		b &= NULL == put->stagings;
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= STAGING_TEST_THREADS * stt.nEventsPerThread == stt.nEvents;
+		b &= 0 == stt.nBad;
+		// Staging has been closed by the shutdown.
+		b &= put->bStagingClosed;
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Handing over staged events at thread exit...");
+		memset (&stt, 0, sizeof (stt));
+		put = createStagingTestTarget (ccLogsFolder, lnLogsFolder, cpsStt);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		stt.put					= put;
+		stt.nEventsPerThread	= 10;
+		// No latency. Only the exit of the thread can hand over the incomplete batch.
+		b &= ConfigCUNILOG_TARGETstagingBuffers (put, 64, 0, 0);
+		b &= runStagingTestThreads (&stt, 1);
+		b &= NULL == put->stagings;
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= 10 == stt.nEvents;
+		b &= 0 == stt.nBad;
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	#ifdef PLATFORM_IS_POSIX
+		// Without a write-behind buffer every event line and its line ending are appended
+		//	with their own writev () call.
+		CunilogTestFnctStartTestToConsole ("Writing raw logfile...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"rawlog", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		ConfigCUNILOG_TARGETrawLogfile (put);
+		b &= cunilogHasRawLogfile (put) ? true : false;
+		remove (put->mbLogfileName.buf.pcc);
+		b &= logTextU8 (put, "Raw event 1.");
+		b &= logTextU8 (put, "Raw event 2.");
+		b &= 0 <= put->logfile.fdLogFile;
+		b &= NULL == put->logfile.fLogFile;
+		b &= NULL == put->wb.buf;
+		uint64_t	ullRawSize	= put->logfile.ullSize;
+		char		cRaw [1024];
+		size_t		lnRaw		= 0;
+		FILE		*fRaw;
+		b &= ShutdownCUNILOG_TARGET (put);
+		fRaw = fopen (put->mbLogfileName.buf.pcc, "rb");
+		b &= NULL != fRaw;
+		if (fRaw)
+		{
+			lnRaw = fread (cRaw, 1, sizeof (cRaw) - 1, fRaw);
+			fclose (fRaw);
+		}
+		cRaw [lnRaw] = '\0';
+		b &= ullRawSize == lnRaw;
+		char *ccRaw1 = strstr (cRaw, "Raw event 1.\n");
+		char *ccRaw2 = strstr (cRaw, "Raw event 2.\n");
+		b &= ccRaw1 && ccRaw2 && ccRaw1 < ccRaw2;
+		b &= lnRaw && '\n' == cRaw [lnRaw - 1];
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	CunilogTestFnctStartTestToConsole ("Creating target with write-behind buffer...");
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				NULL, 0,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDay,
+				NULL, 0,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+										);
+	CunilogTestFnctResultToConsole (NULL != put);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	b &= ConfigCUNILOG_TARGETwriteBehind (put, 4096, 0, cunilogWriteBehindWhenFull, 0);
+	ConfigCUNILOG_TARGETrawLogfile (put);
+	#ifdef PLATFORM_IS_POSIX
+		b &= cunilogHasRawLogfile (put) ? true : false;
+	#endif
+	// Falls back to writev () if io_uring is not available.
+	ConfigCUNILOG_TARGETioUring (put);
+
+	// The buffer is only written when the next event line doesn't fit anymore.
+	CunilogTestFnctStartTestToConsole ("Collecting event lines in write-behind buffer...");
+	unsigned int nwb;
+	for (nwb = 0; nwb < 1000; ++ nwb)
+	{
+		logTextU8 (put, "Write-behind event.");
+	}
+	b &= 0 < put->wb.nWrites && 100 > put->wb.nWrites;
+	b &= 0 < put->wb.len && put->wb.siz >= put->wb.len;
+	#ifdef PLATFORM_IS_POSIX
+		b &= 0 <= put->logfile.fdLogFile;
+	#endif
+	CunilogTestFnctResultToConsole (b);
+
+	CunilogTestFnctStartTestToConsole ("Shutting down target with write-behind buffer...");
+	b &= ShutdownCUNILOG_TARGET (put);
+	b &= 0 == put->wb.len;
+	CunilogTestFnctResultToConsole (b);
+	DoneCUNILOG_TARGET (put);
+
+	#ifdef PLATFORM_IS_POSIX
+		CunilogTestFnctStartTestToConsole ("Creating target with memory-mapped logfile...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"mapped", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDay,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		ConfigCUNILOG_TARGETmappedLogfile (put, 1);
+		b &= cunilogHasRawLogfile (put) && cunilogHasMappedLogfile (put);
+
+		// A chunk of a single page is full after a few event lines.
+		CunilogTestFnctStartTestToConsole ("Copying event lines into mapped logfile...");
+		for (nwb = 0; nwb < 1000; ++ nwb)
+		{
+			logTextU8 (put, "Memory-mapped event.");
+		}
+		b &= NULL != put->logfile.pMap;
+		b &= 0 < put->logfile.ullMapBase;
+		b &= put->logfile.lnMap > put->logfile.ofsMap;
+		CunilogTestFnctResultToConsole (b);
+
+		// Closing truncates the logfile, and the next event line is appended to it.
+		CunilogTestFnctStartTestToConsole ("Reopening memory-mapped logfile...");
+		uint64_t ullMapEnd = put->logfile.ullMapBase + put->logfile.ofsMap;
+		ConfigCUNILOG_TARGETmappedLogfile (put, 1);
+		b &= NULL == put->logfile.pMap;
+		b &= 0 > put->logfile.fdLogFile;
+		logTextU8 (put, "Memory-mapped event.");
+		b &= NULL != put->logfile.pMap;
+		b &= ullMapEnd < put->logfile.ullMapBase + put->logfile.ofsMap;
+		b &= ullMapEnd + 100 > put->logfile.ullMapBase + put->logfile.ofsMap;
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with memory-mapped logfile...");
+		b &= ShutdownCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+
+		// The second target renames the active logfile of the first one to "renamed.log.1"
+		//	when it runs its processors on startup.
+		CunilogTestFnctStartTestToConsole ("Renaming dot number logfiles...");
+		unsigned int nrn;
+		for (nrn = 0; nrn < 2; ++ nrn)
+		{
+			put = CreateNewCUNILOG_TARGET		(
+						ccLogsFolder, lnLogsFolder,
+						"renamed", USE_STRLEN,
+						cunilogPath_relativeToExecutable,
+						cunilogSingleThreaded,
+						cunilogPostfixDotNumberYearly,
+						NULL, 0,
+						cunilogEvtTS_Default,
+						cunilogNewLineDefault,
+						cunilogRunProcessorsOnStartup
+												);
+			if (NULL == put)
+				return false;
+			cunilogSetNoEcho (put);
+			logTextU8 (put, "Dot number event.");
+			if (nrn)
+			{
+				b &= logfileWithPostfixExists (put, ".1");
+				b &= -1 != put->fdLogFold;
+				b &= CUNILOG_ERROR_RENAMING_LOGFILE != CunilogCunilogError (put->error);
+			}
+			b &= ShutdownCUNILOG_TARGET (put);
+			DoneCUNILOG_TARGET (put);
+		}
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	// The second target renames "indexed.log" to "indexed.log.1" through the index. With
+	//	a dot number postfix, the active logfile is the first entry, or the last one if
+	//	the last rotator reversed the list.
+	CunilogTestFnctStartTestToConsole ("Rotating with files list index...");
+	unsigned int nix;
+	for (nix = 0; nix < 2; ++ nix)
+	{
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"indexed", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		ConfigCUNILOG_TARGETfilesListIndex (put, true);
+		b &= cunilogTargetHasFLSindex (put) ? true : false;
+		logTextU8 (put, "Files list index event.");
+		if (nix)
+		{
+			b &= cunilogTargetHasFLSindexBuilt (put) ? true : false;
+			b &= 2 <= put->fls.length;
+			if (b)
+			{
+				size_t ixa = cunilogTargetHasFLSreversed (put) ? put->fls.length - 1 : 0;
+				size_t ix1 = cunilogTargetHasFLSreversed (put) ? put->fls.length - 2 : 1;
+				b &= !strcmp (put->fls.data [ixa].chFilename, "indexed.log");
+				b &= !strcmp (put->fls.data [ix1].chFilename, "indexed.log.1");
+			}
+		}
+		b &= ShutdownCUNILOG_TARGET (put);
+		DoneCUNILOG_TARGET (put);
+	}
+	CunilogTestFnctResultToConsole (b);
+
+	#ifdef PLATFORM_IS_POSIX
+		// A folder with the name of the logfile keeps it from being opened. The event is
+		//	not written, and the next one opens the logfile once the folder is gone.
+		CunilogTestFnctStartTestToConsole ("Failing to open logfile...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"openfail", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		remove (put->mbLogfileName.buf.pcc);
+		b &= 0 == mkdir (put->mbLogfileName.buf.pcc, 0700);
+		logTextU8 (put, "Event for a logfile that can't be opened.");
+		b &= CUNILOG_ERROR_OPENING_LOGFILE == CunilogCunilogError (put->error);
+		b &= NULL == put->logfile.fLogFile;
+		b &= 0 == rmdir (put->mbLogfileName.buf.pcc);
+		logTextU8 (put, "Event for a logfile that can be opened.");
+		b &= NULL != put->logfile.fLogFile;
+		b &= ShutdownCUNILOG_TARGET (put);
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		/*
+			The delete rotator hands the two oldest of the three logfiles from an earlier
+			run over to the maintenance thread. It keeps the active logfile and one more.
+			The maintenance thread is done with its jobs and its messages have been logged
+			when the target has been shut down.
+		*/
+		CunilogTestFnctStartTestToConsole ("Rotating with maintenance thread...");
+		char					szMntOld [1024];
+		size_t					lnMntOld;
+		FILE					*fMnt;
+		unsigned				uMnt;
+		for (nix = 0; nix < 2; ++ nix)
+		{
+			CUNILOG_ROTATION_DATA	rdMntDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE (2);
+			CUNILOG_PROCESSOR		cpMntUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+			CUNILOG_PROCESSOR		cpMntWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+			CUNILOG_PROCESSOR		cpMntDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdMntDel);
+			CUNILOG_PROCESSOR		*cpsMnt []	= {&cpMntUpd, &cpMntWrt, &cpMntDel};
+			put = CreateNewCUNILOG_TARGET		(
+						ccLogsFolder, lnLogsFolder,
+						"maintained", USE_STRLEN,
+						cunilogPath_relativeToExecutable,
+						nix ? cunilogMultiThreadedSeparateLoggingThread : cunilogSingleThreaded,
+						cunilogPostfixDay,
+						cpsMnt, 3,
+						cunilogEvtTS_Default,
+						cunilogNewLineDefault,
+						cunilogRunProcessorsOnStartup
+												);
+			if (NULL == put)
+				return false;
+			cunilogSetNoEcho (put);
+			lnMntOld = put->lnLogPath + strlen ("maintained_2000-01-01.log");
+			b &= lnMntOld < sizeof (szMntOld);
+			if (lnMntOld >= sizeof (szMntOld))
+				return false;
+			memcpy (szMntOld, put->mbLogPath.buf.pcc, put->lnLogPath);
+			for (uMnt = 1; uMnt <= 3; ++ uMnt)
+			{
+				snprintf	(
+					szMntOld + put->lnLogPath, sizeof (szMntOld) - put->lnLogPath,
+					"maintained_2000-01-0%u.log", uMnt
+							);
+				fMnt = fopen (szMntOld, "wb");
+				b &= NULL != fMnt;
+				if (fMnt)
+					fclose (fMnt);
+			}
+			b &= ConfigCUNILOG_TARGETmaintenanceThread (put);
+			b &= NULL != put->pmt;
+			logTextU8 (put, "Maintenance thread event.");
+			logTextU8 (put, "Maintenance thread event.");
+			b &= ShutdownCUNILOG_TARGET (put);
+			if (put->pmt)
+			{
+				b &= put->pmt->bStopped;
+				b &= NULL == put->pmt->firstJob;
+				b &= NULL == put->pmt->firstMsg;
+				// The logfiles have been deleted by the maintenance thread, not the rotator.
+				b &= 2 == put->pmt->nJobsDone;
+			}
+			for (uMnt = 1; uMnt <= 3; ++ uMnt)
+			{
+				szMntOld [lnMntOld - 5] = (char) ('0' + uMnt);
+				fMnt = fopen (szMntOld, "rb");
+				b &= 3 == uMnt ? NULL != fMnt : NULL == fMnt;
+				if (fMnt)
+					fclose (fMnt);
+			}
+			remove (szMntOld);
+			DoneCUNILOG_TARGET (put);
+		}
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	// Compresses the logfile of a target. This only succeeds if the compressor has been
+	//	built in. The compressed file replaces one from an earlier run.
+	CunilogTestFnctStartTestToConsole ("Compressing logfile with external compressor...");
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"compressed", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDay,
+				NULL, 0,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	logTextU8 (put, "Event to compress.");
+	b &= ShutdownCUNILOG_TARGET (put);
+	size_t		lnExt;
+	const char	*ccExt		= ExtCompressorFileExtension (extcompressor_gzip, &lnExt);
+	size_t		lnCmpSrc	= strlen (put->mbLogfileName.buf.pcc);
+	char		szCmpDst [1024];
+	b &= 3 == lnExt;
+	if (lnCmpSrc + lnExt < sizeof (szCmpDst))
+	{
+		memcpy (szCmpDst, put->mbLogfileName.buf.pcc, lnCmpSrc);
+		memcpy (szCmpDst + lnCmpSrc, ccExt, lnExt + 1);
+		b &=		ExtCompressorAvailable (extcompressor_gzip)
+				==	ExtCompressFileByName	(
+						put->mbLogfileName.buf.pcc, szCmpDst,
+						extcompressor_gzip, EXT_COMPRESSOR_DEFAULT_LEVEL
+											);
+		// The logfile is not deleted, hence the compressed file can be replaced.
+		b &=		ExtCompressorAvailable (extcompressor_gzip)
+				==	ExtCompressFileByName	(
+						put->mbLogfileName.buf.pcc, szCmpDst,
+						extcompressor_gzip, EXT_COMPRESSOR_DEFAULT_LEVEL
+											);
+	}
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	#if defined (HAVE_ZLIB) && !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY)
+		/*
+			The rotator starts the maintenance thread of the target and hands the two old
+			logfiles over to it. With the default of one compression at a time, the second
+			compression has to wait for the slot of the first one. The compressed files
+			stay in the files list, and the delete rotator that comes after the compression
+			rotator deletes the older one. It keeps one logfile in addition to the active
+			one the compression rotator has ignored.
+		*/
+		CunilogTestFnctStartTestToConsole ("Compressing logfiles with rotator...");
+		CUNILOG_ROTATION_DATA	rdExtCmp	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_GZIP (1);
+		CUNILOG_ROTATION_DATA	rdExtDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE (1);
+		CUNILOG_PROCESSOR		cpExtUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+		CUNILOG_PROCESSOR		cpExtWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+		CUNILOG_PROCESSOR		cpExtCmp	= CUNILOG_INIT_DEF_LOGFILESEXTCOMPRESS_PROCESSOR (&rdExtCmp);
+		CUNILOG_PROCESSOR		cpExtDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdExtDel);
+		CUNILOG_PROCESSOR		*cpsExt []	= {&cpExtUpd, &cpExtWrt, &cpExtCmp, &cpExtDel};
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"extcompressed", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDay,
+					cpsExt, 4,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogRunProcessorsOnStartup
+										);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		char		szExtOld [1024];
+		size_t		lnExtOld	= put->lnLogPath + strlen ("extcompressed_2000-01-01.log");
+		const char	*ccExtOld []	= {"Old logfile 1.\n", "Old logfile 2.\n"};
+		FILE		*fExt;
+		char		*szExtGz;
+		unsigned	uExt;
+		b &= lnExtOld + 4 < sizeof (szExtOld);
+		if (lnExtOld + 4 >= sizeof (szExtOld))
+			return false;
+		memcpy (szExtOld, put->mbLogPath.buf.pcc, put->lnLogPath);
+		for (uExt = 0; uExt < 2; ++ uExt)
+		{
+			snprintf	(
+				szExtOld + put->lnLogPath, sizeof (szExtOld) - put->lnLogPath,
+				"extcompressed_2000-01-0%u.log.gz", uExt + 1
+						);
+			remove (szExtOld);
+			szExtOld [lnExtOld] = '\0';
+			fExt = fopen (szExtOld, "wb");
+			b &= fExt && strlen (ccExtOld [uExt]) == fwrite (ccExtOld [uExt], 1, strlen (ccExtOld [uExt]), fExt);
+			if (fExt)
+				fclose (fExt);
+		}
+		b &= NULL == put->pmt;
+		logTextU8 (put, "Compression rotator event.");
+		b &= NULL != put->pmt;
+		b &= ShutdownCUNILOG_TARGET (put);
+		// Both logfiles are gone. The older compressed file has been deleted.
+		for (uExt = 0; uExt < 2; ++ uExt)
+		{
+			szExtOld [lnExtOld - 5] = (char) ('1' + uExt);
+			szExtOld [lnExtOld] = '\0';
+			fExt = fopen (szExtOld, "rb");
+			b &= NULL == fExt;
+			if (fExt)
+				fclose (fExt);
+			memcpy (szExtOld + lnExtOld, ".gz", 4);
+			szExtGz = readGzipFile (szExtOld);
+			if (uExt)
+				b &= szExtGz && !strcmp (szExtGz, ccExtOld [uExt]);
+			else
+				b &= NULL == szExtGz;
+			ubf_free_accept_NULL (szExtGz);
+		}
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	CunilogTestFnctStartTestToConsole ("Writing compressed logfile...");
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"compressedlog", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDay,
+				NULL, 0,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	// Fails if gzip hasn't been built in. The logfile is written uncompressed then.
+	bool bCompressed = ConfigCUNILOG_TARGETcompressedLogfile	(
+							put, extcompressor_gzip, EXT_COMPRESSOR_DEFAULT_LEVEL, 128
+																);
+	b &= ExtCompressorAvailable (extcompressor_gzip) == bCompressed;
+	b &= bCompressed == (NULL != put->wb.pfr);
+	logTextU8 (put, "Compressed event 1, which goes into the first frame.");
+	logTextU8 (put, "Compressed event 2, which doesn't fit and completes the first frame.");
+	logTextU8 (put, "Compressed event 3, which completes the second frame.");
+	b &= ShutdownCUNILOG_TARGET (put);
+	// The shutdown has written the third frame.
+	b &= 0 == put->wb.len;
+	if (bCompressed)
+		b &= 3 == put->wb.nWrites;
+	#ifdef HAVE_ZLIB
+		const char *ccCmpEvents [] =
+		{
+				"Compressed event 1, which goes into the first frame."
+			,	"Compressed event 2, which doesn't fit and completes the first frame."
+			,	"Compressed event 3, which completes the second frame."
+			,	"Compressed event 4, which is written after the torn frame."
+			,	NULL
+		};
+		size_t	lnCmpLog	= strlen (put->mbLogfileName.buf.pcc);
+		char	*szCmpLog	= ubf_malloc (lnCmpLog + sizeof (".plain"));
+		char	*szGzip;
+		FILE	*fCmp;
+		char	cTorn [20];
+		size_t	lnTorn		= 0;
+
+		b &= NULL != szCmpLog;
+		if (NULL == szCmpLog)
+			return false;
+		memcpy (szCmpLog, put->mbLogfileName.buf.pcc, lnCmpLog + 1);
+		szGzip = readGzipFile (szCmpLog);
+		b &= NULL != szGzip;
+		if (szGzip)
+		{
+			ccCmpEvents [3] = NULL;
+			b &= gzipEventsInOrder (szGzip, ccCmpEvents);
+			ccCmpEvents [3] = "Compressed event 4, which is written after the torn frame.";
+			ubf_free (szGzip);
+		}
+		// A torn gzip member, like one a crash leaves behind.
+		fCmp = fopen (szCmpLog, "rb");
+		if (fCmp)
+		{
+			lnTorn = fread (cTorn, 1, sizeof (cTorn), fCmp);
+			fclose (fCmp);
+		}
+		b &= sizeof (cTorn) == lnTorn;
+		fCmp = fopen (szCmpLog, "ab");
+		b &= fCmp && lnTorn == fwrite (cTorn, 1, lnTorn, fCmp);
+		if (fCmp)
+			fclose (fCmp);
+		b &= NULL == readGzipFile (szCmpLog);
+	#endif
+	DoneCUNILOG_TARGET (put);
+	#ifdef HAVE_ZLIB
+		// Opening the logfile again cuts the torn member off.
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"compressedlog", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDay,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogRunProcessorsOnStartup
+										);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= ConfigCUNILOG_TARGETcompressedLogfile	(
+					put, extcompressor_gzip, EXT_COMPRESSOR_DEFAULT_LEVEL, 128
+													);
+		logTextU8 (put, ccCmpEvents [3]);
+		b &= ShutdownCUNILOG_TARGET (put);
+		DoneCUNILOG_TARGET (put);
+		szGzip = readGzipFile (szCmpLog);
+		b &= NULL != szGzip;
+		if (szGzip)
+		{
+			b &= gzipEventsInOrder (szGzip, ccCmpEvents);
+			ubf_free (szGzip);
+		}
+		// A file written uncompressed so far is compressed before frames are appended.
+		EXTCMPFRAMER	*pfr			= CreateEXTCMPFRAMER	(
+												extcompressor_gzip,
+												EXT_COMPRESSOR_DEFAULT_LEVEL
+																);
+		const char		ccPlain []		= "Plain line 1.\nPlain line 2.\n";
+		memcpy (szCmpLog + lnCmpLog, ".plain", sizeof (".plain"));
+		fCmp = fopen (szCmpLog, "wb");
+		b &= fCmp && sizeof (ccPlain) - 1 == fwrite (ccPlain, 1, sizeof (ccPlain) - 1, fCmp);
+		if (fCmp)
+			fclose (fCmp);
+		b &= NULL != pfr;
+		if (pfr)
+		{
+			b &= ExtCompressFramesRepairFile (pfr, szCmpLog);
+			szGzip = readGzipFile (szCmpLog);
+			b &= szGzip && 0 == strcmp (szGzip, ccPlain);
+			ubf_free_accept_NULL (szGzip);
+			// A file that consists of complete frames is left alone.
+			b &= ExtCompressFramesRepairFile (pfr, szCmpLog);
+			szGzip = readGzipFile (szCmpLog);
+			b &= szGzip && 0 == strcmp (szGzip, ccPlain);
+			ubf_free_accept_NULL (szGzip);
+			DoneEXTCMPFRAMER (pfr);
+		}
+		remove (szCmpLog);
+		ubf_free (szCmpLog);
+	#endif
+	CunilogTestFnctResultToConsole (b);
+
+	CunilogTestFnctStartTestToConsole ("Rotating logfile at size...");
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"sizerotated", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDotNumberSize,
+				NULL, 0,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	b &= CUNILOG_DEFAULT_ROTATE_AT_SIZE == put->ullRotateAtSize;
+	b &= cunilogTargetHasFLSindex (put) ? true : false;
+	// Off for now. Lines of the same length grow the logfile by the same amount.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, 0);
+	logTextU8 (put, "Size event 1.");
+	uint64_t ullSz1 = put->logfile.ullSize;
+	logTextU8 (put, "Size event 2.");
+	uint64_t ullSz2 = put->logfile.ullSize;
+	logTextU8 (put, "Size event 3.");
+	uint64_t ullSz3 = put->logfile.ullSize;
+	b &= ullSz2 - ullSz1 > strlen ("Size event 2.");
+	b &= ullSz2 - ullSz1 == ullSz3 - ullSz2;
+	// The next event exceeds the size and rotates the logfile.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, ullSz3 + 1);
+	logTextU8 (put, "Size event 4.");
+	b &= ullSz3 + ullSz3 - ullSz2 == put->logfile.ullSizeEvt;
+	b &= 2 <= put->fls.length;
+	b &= logfileWithPostfixExists (put, ".1");
+	b &= !logfileWithPostfixExists (put, ".2");
+	// The size triggers a rotation once per logfile. The first event of the new logfile
+	//	exceeds the size too.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, 1);
+	logTextU8 (put, "Size event 5.");
+	b &= logfileWithPostfixExists (put, ".2");
+	b &= !logfileWithPostfixExists (put, ".3");
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	CunilogTestFnctStartTestToConsole ("Deleting logfiles beyond retention size...");
+	CUNILOG_ROTATION_DATA	rdRetRen	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_RENAME_LOGFILES;
+	// Nothing but the active logfile fits into a single octet.
+	CUNILOG_ROTATION_DATA	rdRetDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN (10, 1, 0);
+	CUNILOG_PROCESSOR		cpRetUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+	CUNILOG_PROCESSOR		cpRetWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+	CUNILOG_PROCESSOR		cpRetRen	= CUNILOG_INIT_DEF_RENAMELOGFILES_PROCESSOR (&rdRetRen);
+	CUNILOG_PROCESSOR		cpRetDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdRetDel);
+	CUNILOG_PROCESSOR		*cpsRet []	= {&cpRetUpd, &cpRetWrt, &cpRetRen, &cpRetDel};
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"retained", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDotNumberSize,
+				cpsRet, 4,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	b &= cunilogTargetHasFLSindex (put) ? true : false;
+	// Every event rotates the active logfile, which is deleted straight away.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, 1);
+	logTextU8 (put, "Retained event 1.");
+	logTextU8 (put, "Retained event 2.");
+	logTextU8 (put, "Retained event 3.");
+	b &= 1 == put->fls.length;
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	// Renaming a logfile doesn't change its last write time.
+	CunilogTestFnctStartTestToConsole ("Deleting logfiles beyond retention age...");
+	CUNILOG_ROTATION_DATA	rdAgeRen	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_RENAME_LOGFILES;
+	CUNILOG_ROTATION_DATA	rdAgeDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN (10, 0, 1);
+	CUNILOG_PROCESSOR		cpAgeUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+	CUNILOG_PROCESSOR		cpAgeWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+	CUNILOG_PROCESSOR		cpAgeRen	= CUNILOG_INIT_DEF_RENAMELOGFILES_PROCESSOR (&rdAgeRen);
+	CUNILOG_PROCESSOR		cpAgeDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdAgeDel);
+	CUNILOG_PROCESSOR		*cpsAge []	= {&cpAgeUpd, &cpAgeWrt, &cpAgeRen, &cpAgeDel};
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"retainedage", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDotNumberSize,
+				cpsAge, 4,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	// Every event rotates the active logfile.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, 1);
+	logTextU8 (put, "Aged event 1.");
+	b &= logfileWithPostfixExists (put, ".1");
+	Sleep_ms (2100);
+	// The logfile of the first event is now too old and deleted after it has been renamed
+	//	to ".2". The one of the second event is kept.
+	logTextU8 (put, "Aged event 2.");
+	b &= logfileWithPostfixExists (put, ".1");
+	b &= !logfileWithPostfixExists (put, ".2");
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	// Five rotated logfiles of which not more than two are deleted per event.
+	CunilogTestFnctStartTestToConsole ("Deleting logfiles beyond retention in batches...");
+	CUNILOG_ROTATION_DATA	rdRbaDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE_RETAIN (10, 1, 0);
+	CUNILOG_PROCESSOR		cpRbaUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+	CUNILOG_PROCESSOR		cpRbaWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+	CUNILOG_PROCESSOR		cpRbaDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdRbaDel);
+	CUNILOG_PROCESSOR		*cpsRba []	= {&cpRbaUpd, &cpRbaWrt, &cpRbaDel};
+	rdRbaDel.nRetainBatch = 2;
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"retainedbatch", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDotNumberSize,
+				cpsRba, 3,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	// Not rotated by size. The rotator only runs at startup and when a batch is left over.
+	b &= ConfigCUNILOG_TARGETrotateAtSize (put, 0);
+	char		szBatPostfix [4];
+	unsigned	uBat;
+	for (uBat = 1; uBat <= 5; ++ uBat)
+	{
+		char	szBatName [1024];
+		FILE	*fBat;
+		snprintf (szBatName, sizeof (szBatName), "%s.%u", put->mbLogfileName.buf.pcc, uBat);
+		fBat = fopen (szBatName, "wb");
+		b &= fBat && 1 == fwrite ("B", 1, 1, fBat);
+		if (fBat)
+			fclose (fBat);
+	}
+	logTextU8 (put, "Batch event 1.");
+	b &= 4 == put->fls.length;
+	logTextU8 (put, "Batch event 2.");
+	b &= 2 == put->fls.length;
+	logTextU8 (put, "Batch event 3.");
+	b &= 1 == put->fls.length;
+	for (uBat = 1; uBat <= 5; ++ uBat)
+	{
+		snprintf (szBatPostfix, sizeof (szBatPostfix), ".%u", uBat);
+		b &= !logfileWithPostfixExists (put, szBatPostfix);
+	}
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	CunilogTestFnctStartTestToConsole ("Filtering events by severity...");
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"filtered", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDay,
+				NULL, 0,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	b &= CUNILOG_SEVERITY_MASK_ALL == put->uiLogSeverities;
+	ConfigCUNILOG_TARGETminSeverity (put, cunilogEvtSeverityInfo);
+	b &= logTextU8sev (put, cunilogEvtSeverityInfo, "Filtered event 1.");
+	uint64_t ullSzFlt = put->logfile.ullSize;
+	// Events that are filtered out are not an error.
+	b &= logTextU8sev (put, cunilogEvtSeverityDebug, "Filtered event 2.");
+	b &= logTextU8sfmtsev (put, cunilogEvtSeverityVerbose, "Filtered event %d.", 3);
+	b &= logHexDumpU8sevl (put, cunilogEvtSeverityTrace, "4", 1, NULL, 0);
+	b &= ullSzFlt == put->logfile.ullSize;
+	ConfigCUNILOG_TARGETseverityMask (put, CUNILOG_SEVERITY_BIT (cunilogEvtSeverityDebug));
+	b &= logTextU8 (put, "Filtered event 5.");
+	b &= ullSzFlt == put->logfile.ullSize;
+	b &= logTextU8sev (put, cunilogEvtSeverityDebug, "Filtered event 6.");
+	b &= ullSzFlt < put->logfile.ullSize;
+	ullSzFlt = put->logfile.ullSize;
+	// Compiled in unless CUNILOG_COMPILE_MIN_SEVERITY is above CUNILOG_SEVRANK_DEBUG.
+	logDebugU8fmt (put, "Filtered event %d.", 7);
+	#if CUNILOG_COMPILE_MIN_SEVERITY <= CUNILOG_SEVRANK_DEBUG
+		b &= ullSzFlt < put->logfile.ullSize;
+	#else
+		b &= ullSzFlt == put->logfile.ullSize;
+	#endif
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	CunilogTestFnctStartTestToConsole ("Filtering events by processor...");
+	size_t					nFltCnt		= 0;
+	CUNILOG_CUSTPROCESS		cuFltCnt	= {&nFltCnt, countEventsProcessor, NULL, NULL};
+	CUNILOG_PROCESSOR		cpFltCnt	=
+		{
+			cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+			&cuFltCnt, OPT_CUNPROC_FORCE_NEXT, 0, 0
+		};
+	// Only text events that are at least warnings.
+	ConfigCUNILOG_PROCESSORfilter	(
+		&cpFltCnt, cunilogSeverityMaskFromMin (cunilogEvtSeverityWarning),
+		CUNILOG_EVTTYPES_TEXT
+									);
+	CUNILOG_PROCESSOR		cpFltUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+	CUNILOG_PROCESSOR		cpFltWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+	CUNILOG_PROCESSOR		*cpsFlt []	= {&cpFltCnt, &cpFltUpd, &cpFltWrt};
+	put = CreateNewCUNILOG_TARGET		(
+				ccLogsFolder, lnLogsFolder,
+				"procfiltered", USE_STRLEN,
+				cunilogPath_relativeToExecutable,
+				cunilogSingleThreaded,
+				cunilogPostfixDay,
+				cpsFlt, 3,
+				cunilogEvtTS_Default,
+				cunilogNewLineDefault,
+				cunilogDontRunProcessorsOnStartup
+									);
+	if (NULL == put)
+		return false;
+	cunilogSetNoEcho (put);
+	ullSzFlt = put->logfile.ullSize;
+	b &= logTextU8sev (put, cunilogEvtSeverityInfo, "Processor filtered event 1.");
+	b &= logTextU8sev (put, cunilogEvtSeverityWarning, "Processor filtered event 2.");
+	b &= logTextU8sev (put, cunilogEvtSeverityFatal, "Processor filtered event 3.");
+	b &= logHexDumpU8sevl (put, cunilogEvtSeverityError, "4", 1, NULL, 0);
+	b &= 2 == nFltCnt;
+	// The logfile processor isn't filtered.
+	uint64_t ullSzFlt4 = put->logfile.ullSize;
+	b &= logTextU8sev (put, cunilogEvtSeverityInfo, "Processor filtered event 5.");
+	b &= ullSzFlt < ullSzFlt4 && ullSzFlt4 < put->logfile.ullSize;
+	b &= 2 == nFltCnt;
+	// Disabled processors are not part of the processor plan.
+	b &= 3 == put->nplan;
+	ConfigCUNILOG_TARGETdisableTaskProcessors (put, cunilogProcessCustomProcessor);
+	b &= 2 == put->nplan;
+	b &= logTextU8sev (put, cunilogEvtSeverityFatal, "Processor filtered event 6.");
+	b &= 2 == nFltCnt;
+	ConfigCUNILOG_TARGETenableTaskProcessors (put, cunilogProcessCustomProcessor);
+	b &= 3 == put->nplan;
+	b &= logTextU8sev (put, cunilogEvtSeverityFatal, "Processor filtered event 7.");
+	b &= 3 == nFltCnt;
+	b &= ShutdownCUNILOG_TARGET (put);
+	DoneCUNILOG_TARGET (put);
+	CunilogTestFnctResultToConsole (b);
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		// The separate logging thread changes its processor plan itself, in order with
+		//	the events.
+		CunilogTestFnctStartTestToConsole ("Disabling processors of a separate logging thread...");
+		size_t					nSepCnt		= 0;
+		CUNILOG_CUSTPROCESS		cuSepCnt	= {&nSepCnt, countEventsProcessor, NULL, NULL};
+		CUNILOG_PROCESSOR		cpSepCnt	=
+			{
+				cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+				&cuSepCnt, OPT_CUNPROC_FORCE_NEXT, 0, 0
+			};
+		CUNILOG_PROCESSOR		*cpsSep []	= {&cpSepCnt};
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"procdisabled", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDay,
+					cpsSep, 1,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= logTextU8 (put, "Counted event 1.");
+		ConfigCUNILOG_TARGETdisableTaskProcessors (put, cunilogProcessCustomProcessor);
+		b &= logTextU8 (put, "Uncounted event 2.");
+		b &= logTextU8 (put, "Uncounted event 3.");
+		ConfigCUNILOG_TARGETenableTaskProcessors (put, cunilogProcessCustomProcessor);
+		b &= logTextU8 (put, "Counted event 4.");
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= 2 == nSepCnt;
+		b &= 1 == put->nplan;
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Handing batches of events to a processor...");
+		size_t					nBatCnt [3]	= {0, 0, 0};
+		CUNILOG_CUSTPROCESS		cuBatCnt	= {nBatCnt, NULL, NULL, countBatchesProcessor};
+		CUNILOG_PROCESSOR		cpBatCnt	=
+			{
+				cunilogProcessCustomProcessor, cunilogProcessAppliesTo_nAlways, 0, 0,
+				&cuBatCnt, OPT_CUNPROC_FORCE_NEXT, 0, 0
+			};
+		CUNILOG_PROCESSOR		cpBatUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+		CUNILOG_PROCESSOR		cpBatWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+		CUNILOG_PROCESSOR		*cpsBat []	= {&cpBatCnt, &cpBatUpd, &cpBatWrt};
+		unsigned int			nbe;
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"batched", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreadedSeparateLoggingThread,
+					cunilogPostfixDay,
+					cpsBat, 3,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= NULL != put->batches;
+		b &= put->plan [0].uiFlags & CUNILOG_PLANSTEP_BATCH ? true : false;
+		// The events queued while the target is paused are taken off the queue in one go.
+		PauseLogCUNILOG_TARGET (put);
+		for (nbe = 0; nbe < 10; ++ nbe)
+		{
+			logTextU8 (put, "Batched event.");
+		}
+		// Only the batch function can see the text of a deferred formatting event.
+		logTextU8dfmt (put, "Batched event %d.", 11);
+		ResumeLogCUNILOG_TARGET (put);
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= 1 == nBatCnt [0];
+		b &= 11 == nBatCnt [1];
+		b &= 0 == nBatCnt [2];
+		DoneCUNILOG_TARGET (put);
+
+		// Without a separate logging thread the batch function gets one event per call.
+		//	The processors have already run for the first target, which is why they're
+		//	told to run on startup again.
+		nBatCnt [0] = 0;
+		nBatCnt [1] = 0;
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"batched", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreaded,
+					cunilogPostfixDay,
+					cpsBat, 3,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= NULL == put->batches;
+		b &= logTextU8 (put, "Unbatched event 1.");
+		b &= logTextU8 (put, "Unbatched event 2.");
+		b &= 2 == nBatCnt [0];
+		b &= 2 == nBatCnt [1];
+		b &= 0 == nBatCnt [2];
+		b &= ShutdownCUNILOG_TARGET (put);
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	#if !defined (CUNILOG_BUILD_SINGLE_THREADED_ONLY) && defined (PLATFORM_IS_POSIX)
+		/*
+			The events taken off the queue in one go are echoed together. Every event
+			rotates the logfile, and the delete rotator hands the rotated logfile over to
+			the maintenance thread. The rename rotator of the next event waits for this job
+			and logs its messages, which are not part of the batch. They must not overtake
+			the batched events before them. The echo output of the last events is written
+			out when the target is shut down.
+		*/
+		CunilogTestFnctStartTestToConsole ("Echoing batches of events...");
+		CUNILOG_ROTATION_DATA	rdEchRen	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_RENAME_LOGFILES;
+		CUNILOG_ROTATION_DATA	rdEchDel	= CUNILOG_INIT_DEF_CUNILOG_ROTATION_DATA_DELETE (1);
+		CUNILOG_PROCESSOR		cpEchEch	= CUNILOG_INIT_DEF_ECHO_PROCESSOR;
+		CUNILOG_PROCESSOR		cpEchUpd	= CUNILOG_INIT_DEF_UPDATELOGFILENAME_PROCESSOR;
+		CUNILOG_PROCESSOR		cpEchWrt	= CUNILOG_INIT_DEF_WRITETTOLOGFILE_PROCESSOR;
+		CUNILOG_PROCESSOR		cpEchRen	= CUNILOG_INIT_DEF_RENAMELOGFILES_PROCESSOR (&rdEchRen);
+		CUNILOG_PROCESSOR		cpEchDel	= CUNILOG_INIT_DEF_LOGFILESDELETE_PROCESSOR (&rdEchDel);
+		CUNILOG_PROCESSOR		*cpsEch []	=
+			{&cpEchEch, &cpEchUpd, &cpEchWrt, &cpEchRen, &cpEchDel};
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					"echobatched", USE_STRLEN,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberSize,
+					cpsEch, 5,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		b &= ConfigCUNILOG_TARGETrotateAtSize (put, 1);
+		b &= ConfigCUNILOG_TARGETmaintenanceThread (put);
+		char	szEchOut [1024];
+		char	cEchOut [16384];
+		size_t	lnEchOut		= 0;
+		int		fdEchOut;
+		int		fdStdout;
+		FILE	*fEchOut;
+		// Not picked up by the rotators.
+		snprintf (szEchOut, sizeof (szEchOut), "%sechobatched_stdout.txt", put->mbLogPath.buf.pcc);
+		fflush (stdout);
+		fdStdout	= dup (STDOUT_FILENO);
+		fdEchOut	= open (szEchOut, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		b &= -1 != fdStdout && -1 != fdEchOut;
+		if (-1 != fdStdout && -1 != fdEchOut)
+		{
+			dup2 (fdEchOut, STDOUT_FILENO);
+			PauseLogCUNILOG_TARGET (put);
+			logTextU8 (put, "Echo batch event 1.");
+			logTextU8 (put, "Echo batch event 2.");
+			logTextU8 (put, "Echo batch event 3.");
+			logTextU8 (put, "Echo batch event 4.");
+			ResumeLogCUNILOG_TARGET (put);
+			b &= ShutdownCUNILOG_TARGET (put);
+			b &= 0 == put->lnEchoBatch;
+			fflush (stdout);
+			dup2 (fdStdout, STDOUT_FILENO);
+		}
+		if (-1 != fdStdout)
+			close (fdStdout);
+		if (-1 != fdEchOut)
+			close (fdEchOut);
+		DoneCUNILOG_TARGET (put);
+		fEchOut = fopen (szEchOut, "rb");
+		if (fEchOut)
+		{
+			lnEchOut = fread (cEchOut, 1, sizeof (cEchOut) - 1, fEchOut);
+			fclose (fEchOut);
+		}
+		cEchOut [lnEchOut] = '\0';
+		remove (szEchOut);
+		const char *ccEch1 = strstr (cEchOut, "Echo batch event 1.");
+		const char *ccEch2 = strstr (cEchOut, "Echo batch event 2.");
+		const char *ccEch3 = strstr (cEchOut, "Echo batch event 3.");
+		const char *ccEch4 = strstr (cEchOut, "Echo batch event 4.");
+		const char *ccEchM = strstr (cEchOut, "obsolete logfile");
+		b &= ccEch1 && ccEch2 && ccEch3 && ccEch4 && ccEchM;
+		b &= ccEch1 < ccEch2 && ccEch2 < ccEch3 && ccEch3 < ccEch4;
+		// The job of the first event is logged while the second one is processed, before
+		//	or after its echo output, depending on when the job is done.
+		b &= ccEch1 < ccEchM && ccEchM < ccEch3;
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		CunilogTestFnctStartTestToConsole ("Creating target with event pool...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		CunilogTestFnctResultToConsole (NULL != put);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= ConfigCUNILOG_TARGETeventPool (put, 0);
+
+		// While paused the events stay in their slots.
+		CunilogTestFnctStartTestToConsole ("Taking events from size classes of event pool...");
+		CUNILOG_EVENTPOOLSTATS	eps;
+		char					szPoolEvt [5000];
+		unsigned int			npe;
+		memset (szPoolEvt, 'x', sizeof (szPoolEvt));
+		PauseLogCUNILOG_TARGET (put);
+		for (npe = 0; npe < 10; ++ npe)
+		{
+			logTextU8 (put, "Pooled event.");
+		}
+		for (npe = 0; npe < 5; ++ npe)
+		{
+			logTextU8l (put, szPoolEvt, 300);
+		}
+		logTextU8l (put, szPoolEvt, sizeof (szPoolEvt));
+		b &= getCUNILOG_EVENTPOOLstats (&eps, put);
+		b &= 128 == eps.stPayload [0];
+		b &= 10 <= eps.nInUse [0];
+		b &= 5 <= eps.nInUse [2];
+		b &= 1 <= eps.nHeapAllocs;
+		CunilogTestFnctResultToConsole (b);
+
+		// Too long for the stack buffer, which means it's formatted into the event.
+		CunilogTestFnctStartTestToConsole ("Formatting long text into event...");
+		logTextU8fmt (put, "%.*s%u\n", 300, szPoolEvt, 7u);
+		b &= NULL != put->qu.last;
+		if (put->qu.last)
+		{
+			b &= 301 == put->qu.last->lenDataToLog;
+			b &= 'x' == put->qu.last->szDataToLog [0];
+			b &= '7' == put->qu.last->szDataToLog [300];
+		}
+		CunilogTestFnctResultToConsole (b);
+
+		// Long double is not supported for deferred formatting. The text is formatted
+		//	straight away.
+		CunilogTestFnctStartTestToConsole ("Falling back to immediate formatting...");
+		logTextU8dfmt (put, "%.1Lf|%d", (long double) 2.5, 3);
+		b &= NULL != put->qu.last;
+		if (put->qu.last)
+		{
+			b &= cunilogEvtTypeNormalText == put->qu.last->evType;
+			b &= 5 == put->qu.last->lenDataToLog;
+			b &= !memcmp (put->qu.last->szDataToLog, "2.5|3", 5);
+		}
+		CunilogTestFnctResultToConsole (b);
+
+		// Only the arguments are captured. The format string and string arguments are
+		//	copied. Neither of them needs to outlive the call.
+		CunilogTestFnctStartTestToConsole ("Deferred formatting...");
+		char					szDeferred [4];
+		char					szDeferredFmt [64];
+		const char				ccDeferredFmt []	= "%s|%5d|%-6.2f|%llx|%c|%.*s|%%|%*d|%zu";
+		memcpy (szDeferred, "abc", 4);
+		memcpy (szDeferredFmt, ccDeferredFmt, sizeof (ccDeferredFmt));
+		logTextU8dfmt	(
+			put, szDeferredFmt, szDeferred, -42, 3.14159,
+			0xABCull, 'Z', 2, "xyz", -4, 7, (size_t) 12345
+						);
+		memcpy (szDeferred, "ZZZ", 4);
+		memset (szDeferredFmt, '%', sizeof (szDeferredFmt) - 1);
+		szDeferredFmt [sizeof (szDeferredFmt) - 1] = '\0';
+		b &= NULL != put->qu.last;
+		if (put->qu.last)
+			b &= cunilogEvtTypeDeferredFmt == put->qu.last->evType;
+		CunilogTestFnctResultToConsole (b);
+
+		CunilogTestFnctStartTestToConsole ("Shutting down target with event pool...");
+		ResumeLogCUNILOG_TARGET (put);
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= getCUNILOG_EVENTPOOLstats (&eps, put);
+		for (npe = 0; npe < CUNILOG_EVENTPOOL_CLASSES; ++ npe)
+		{
+			b &= 0 == eps.nInUse [npe];
+			b &= eps.nSlots [npe] <= eps.nAllocs [npe];
+		}
+		b &= 1 <= eps.sbmStats.nSBULKMEMBLOCKs;
+		CunilogTestFnctResultToConsole (b);
+
+		// The deferred event was the last one to be rendered.
+		CunilogTestFnctStartTestToConsole ("Rendering deferred event on logging thread...");
+		b &= NULL != strstr	(
+						put->mbLogEventLine.buf.pch,
+						" abc|  -42|3.14  |abc|Z|xy|%|7   |12345"
+							);
+		CunilogTestFnctResultToConsole (b);
+		DoneCUNILOG_TARGET (put);
+
+		// A command event goes back to the pool only once. Otherwise the same slot
+		//	would be handed out for more than one event afterwards.
+		CunilogTestFnctStartTestToConsole ("Processing command event with event pool...");
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		b &= ConfigCUNILOG_TARGETeventPool (put, 0);
+		b &= ChangeCUNILOG_TARGETcunilognewline (put, cunilogNewLineDefault);
+		for (npe = 0; npe < 1000; ++ npe)
+		{
+			b &= getCUNILOG_EVENTPOOLstats (&eps, put);
+			if (1 != eps.nInUse [0])
+				break;
+			Sleep_ms (1);
+		}
+		b &= 0 == eps.nInUse [0];
+		PauseLogCUNILOG_TARGET (put);
+		logTextU8 (put, "Pooled event 1.");
+		logTextU8 (put, "Pooled event 2.");
+		logTextU8 (put, "Pooled event 3.");
+		CUNILOG_EVENT *pevPooled = put->qu.first;
+		b &= NULL != pevPooled && NULL != pevPooled->next && NULL != pevPooled->next->next;
+		if (b)
+		{
+			b &= pevPooled != pevPooled->next;
+			b &= pevPooled->next != pevPooled->next->next;
+			b &= pevPooled != pevPooled->next->next;
+			b &= '1' == pevPooled->szDataToLog [13];
+			b &= '2' == pevPooled->next->szDataToLog [13];
+			b &= '3' == pevPooled->next->next->szDataToLog [13];
+		}
+		ResumeLogCUNILOG_TARGET (put);
+		b &= ShutdownCUNILOG_TARGET (put);
+		b &= getCUNILOG_EVENTPOOLstats (&eps, put);
+		b &= 0 == eps.nInUse [0];
+		DoneCUNILOG_TARGET (put);
+		CunilogTestFnctResultToConsole (b);
+
+		// The event outlives the target whose pool it has been taken from.
+		CunilogTestFnctStartTestToConsole ("Handing pooled event on to another target...");
+		CUNILOG_TARGET *putOther = CreateNewCUNILOG_TARGET	(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+															);
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put || NULL == putOther)
+			return false;
+		cunilogSetNoEcho (put);
+		cunilogSetNoEcho (putOther);
+		b &= ConfigCUNILOG_TARGETeventPool (put, 0);
+		pevPooled = CreateCUNILOG_EVENT_Text (put, cunilogEvtSeverityNone, "Handed on.", USE_STRLEN);
+		b &= NULL != pevPooled && cunilogIsEventPooled (pevPooled);
+		PauseLogCUNILOG_TARGET (putOther);
+		logEv (putOther, pevPooled);
+		b &= ShutdownCUNILOG_TARGET (put);
+		DoneCUNILOG_TARGET (put);
+		ResumeLogCUNILOG_TARGET (putOther);
+		b &= ShutdownCUNILOG_TARGET (putOther);
+		b &= NULL != strstr (putOther->mbLogEventLine.buf.pch, "Handed on.");
+		DoneCUNILOG_TARGET (putOther);
+		CunilogTestFnctResultToConsole (b);
+	#endif
+
 	CunilogTestFnctStartTestToConsole ("Testing directory reader...");
 	#ifdef PLATFORM_IS_WINDOWS
 		b &= ForEachDirectoryEntryMaskU8TestFnct ();
@@ -956,5 +2713,246 @@ bool CunilogTestFunction	(
 	DoneCUNILOG_TARGETstatic ();
 
 
+	return b;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	static bool CunilogTestFnctWakeupsBenchmarkRun	(
+			const char		*ccLogsFolder,
+			size_t			lnLogsFolder,
+			bool			bCoalesce,
+			unsigned int	nEvents
+													)
+	{
+		bool			b		= true;
+		CUNILOG_TARGET	*put;
+		ULONGLONG		ullStart;
+		ULONGLONG		ullEnd;
+		unsigned int	n		= nEvents;
+		char			szOut [CUNILOG_STD_MSG_SIZE];
+
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogMultiThreadedSeparateLoggingThread,
+					cunilogPostfixDotNumberYearly,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		if (bCoalesce)
+			cunilogSetCoalescedWakeups (put);
+
+		ullStart = GetSystemTimeAsULONGLONG ();
+		while (n --)
+		{
+			b &= logTextU8 (put, "Wake-up benchmark event.");
+		}
+		b &= ShutdownCUNILOG_TARGET (put);
+		ullEnd = GetSystemTimeAsULONGLONG ();
+
+		// The shutdown event is an event too.
+		b &= put->nSepLogThreadPosts <= (size_t) nEvents + 1;
+
+		// FILETIME units are 100 ns.
+		snprintf	(
+			szOut, CUNILOG_STD_MSG_SIZE,
+			"\t%s: %u events, %.0f ms, %.4f semaphore posts/event, %.4f wake-ups/event",
+			bCoalesce ? "Coalesced  " : "Per event  ",
+			nEvents,
+			(double) (ullEnd - ullStart) / 10000.0,
+			(double) put->nSepLogThreadPosts / nEvents,
+			(double) put->nSepLogThreadWakeups / nEvents
+					);
+		cunilog_puts (szOut);
+		DoneCUNILOG_TARGET (put);
+		return b;
+	}
+#endif
+
+bool CunilogTestFnctBenchmarkWakeups	(
+		const char *ccLogsFolder,
+		size_t		lnLogsFolder
+										)
+{
+	bool b = true;
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		unsigned int nEvents = 100000;
+
+		cunilog_puts ("Benchmarking wake-ups of the separate logging thread...");
+		b &= CunilogTestFnctWakeupsBenchmarkRun (ccLogsFolder, lnLogsFolder, false, nEvents);
+		b &= CunilogTestFnctWakeupsBenchmarkRun (ccLogsFolder, lnLogsFolder, true, nEvents);
+		CunilogTestFnctStartTestToConsole ("Wake-up benchmark...");
+		CunilogTestFnctResultToConsole (b);
+	#else
+		UNUSED (ccLogsFolder);
+		UNUSED (lnLogsFolder);
+	#endif
+
+	return b;
+}
+
+#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+	enum logfilewriter
+	{
+			writerFwrite
+		,	writerWriteBehind
+		,	writerIoUring
+	};
+
+	static bool CunilogTestFnctLogfileWritersBenchmarkRun	(
+			const char				*ccLogsFolder,
+			size_t					lnLogsFolder,
+			enum logfilewriter		writer,
+			unsigned int			nEvents
+															)
+	{
+		bool			b		= true;
+		CUNILOG_TARGET	*put;
+		ULONGLONG		ullStart;
+		ULONGLONG		ullEnd;
+		unsigned int	n		= nEvents;
+		char			szOut [CUNILOG_STD_MSG_SIZE];
+		const char		*ccWriter [] =
+		{
+			"fwrite ()/WriteFile ()", "Write-behind, writev ()", "Write-behind, io_uring"
+		};
+
+		put = CreateNewCUNILOG_TARGET		(
+					ccLogsFolder, lnLogsFolder,
+					NULL, 0,
+					cunilogPath_relativeToExecutable,
+					cunilogSingleThreadedSeparateLoggingThread,
+					cunilogPostfixDay,
+					NULL, 0,
+					cunilogEvtTS_Default,
+					cunilogNewLineDefault,
+					cunilogDontRunProcessorsOnStartup
+											);
+		if (NULL == put)
+			return false;
+		cunilogSetNoEcho (put);
+		if (writerFwrite != writer)
+		{
+			b &= ConfigCUNILOG_TARGETwriteBehind	(
+						put, 64 * 1024, 0, cunilogWriteBehindEveryBatch, 1024 * 1024
+													);
+			ConfigCUNILOG_TARGETrawLogfile (put);
+		}
+		if (writerIoUring == writer && !ConfigCUNILOG_TARGETioUring (put))
+		{
+			snprintf (szOut, CUNILOG_STD_MSG_SIZE, "\t%s: not available", ccWriter [writer]);
+			cunilog_puts (szOut);
+			DoneCUNILOG_TARGET (put);
+			return b;
+		}
+
+		ullStart = GetSystemTimeAsULONGLONG ();
+		while (n --)
+		{
+			b &= logTextU8 (put, "Logfile writer benchmark event.");
+		}
+		b &= ShutdownCUNILOG_TARGET (put);
+		ullEnd = GetSystemTimeAsULONGLONG ();
+		b &= 0 == put->wb.len;
+
+		// FILETIME units are 100 ns.
+		snprintf	(
+			szOut, CUNILOG_STD_MSG_SIZE,
+			"\t%s: %u events, %.0f ms, %.0f events/s, %zu writes",
+			ccWriter [writer],
+			nEvents,
+			(double) (ullEnd - ullStart) / 10000.0,
+			(double) nEvents * 10000000.0 / (double) (ullEnd - ullStart + 1),
+			put->wb.nWrites
+					);
+		cunilog_puts (szOut);
+		DoneCUNILOG_TARGET (put);
+		return b;
+	}
+#endif
+
+bool CunilogTestFnctBenchmarkLogfileWriters	(
+		const char *ccLogsFolder,
+		size_t		lnLogsFolder
+											)
+{
+	bool b = true;
+
+	#ifndef CUNILOG_BUILD_SINGLE_THREADED_ONLY
+		unsigned int nEvents = 500000;
+
+		cunilog_puts ("Benchmarking logfile writers of the separate logging thread...");
+		b &= CunilogTestFnctLogfileWritersBenchmarkRun	(
+				ccLogsFolder, lnLogsFolder, writerFwrite, nEvents
+														);
+		b &= CunilogTestFnctLogfileWritersBenchmarkRun	(
+				ccLogsFolder, lnLogsFolder, writerWriteBehind, nEvents
+														);
+		b &= CunilogTestFnctLogfileWritersBenchmarkRun	(
+				ccLogsFolder, lnLogsFolder, writerIoUring, nEvents
+														);
+		CunilogTestFnctStartTestToConsole ("Logfile writer benchmark...");
+		CunilogTestFnctResultToConsole (b);
+	#else
+		UNUSED (ccLogsFolder);
+		UNUSED (lnLogsFolder);
+	#endif
+
+	return b;
+}
+
+bool CunilogTestFnctBenchmarkTimestamps (void)
+{
+	bool				b		= true;
+	unsigned int		nCalls	= 1000000;
+	unsigned int		n;
+	UBF_TIMESTAMP		ts		= 0;
+	UBF_TIMESTAMP		tc		= 0;
+	UBF_TIMESTAMP_CACHE	tsc		= UBF_TIMESTAMP_CACHE_INITIALISER;
+	ULONGLONG			ullStart;
+	ULONGLONG			ullLocal;
+	ULONGLONG			ullCached;
+	char				szOut [CUNILOG_STD_MSG_SIZE];
+
+	cunilog_puts ("Benchmarking local time providers...");
+
+	ullStart = GetSystemTimeAsULONGLONG ();
+	for (n = 0; n < nCalls; ++ n)
+	{
+		ts |= LocalTime_UBF_TIMESTAMP ();
+	}
+	ullLocal = GetSystemTimeAsULONGLONG () - ullStart;
+
+	ullStart = GetSystemTimeAsULONGLONG ();
+	for (n = 0; n < nCalls; ++ n)
+	{
+		tc |= LocalTimeCached_UBF_TIMESTAMP (&tsc);
+	}
+	ullCached = GetSystemTimeAsULONGLONG () - ullStart;
+	b &= 0 != ts && 0 != tc;
+
+	// FILETIME units are 100 ns.
+	snprintf	(
+		szOut, CUNILOG_STD_MSG_SIZE,
+		"\tLocalTime_UBF_TIMESTAMP ()      : %u calls, %.1f ns/call",
+		nCalls, (double) ullLocal * 100.0 / nCalls
+				);
+	cunilog_puts (szOut);
+	snprintf	(
+		szOut, CUNILOG_STD_MSG_SIZE,
+		"\tLocalTimeCached_UBF_TIMESTAMP (): %u calls, %.1f ns/call",
+		nCalls, (double) ullCached * 100.0 / nCalls
+				);
+	cunilog_puts (szOut);
+	CunilogTestFnctStartTestToConsole ("Local time provider benchmark...");
+	CunilogTestFnctResultToConsole (b);
+
 	return b;
 }
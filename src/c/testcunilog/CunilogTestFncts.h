@@ -93,6 +93,44 @@ bool CunilogTestFunction	(
 							)
 ;
 
+/*
+	CunilogTestFnctBenchmarkWakeups
+
+	Logs a burst of events through a target with a separate logging thread, once with
+	a semaphore post per event and once with coalesced wake-ups, and outputs the amount
+	of semaphore posts and of actual wake-ups of the separate logging thread per event
+	to the console. Only waits that block count as wake-ups.
+*/
+bool CunilogTestFnctBenchmarkWakeups	(
+		const char				*ccLogsFolder,
+		size_t					lnLogsFolder
+										)
+;
+
+/*
+	CunilogTestFnctBenchmarkLogfileWriters
+
+	Logs a burst of events through a target with a separate logging thread, once with
+	the default logfile writer, once with a write-behind buffer written with writev (),
+	and once with a write-behind buffer written through io_uring, and outputs the
+	throughput of each of them to the console.
+*/
+bool CunilogTestFnctBenchmarkLogfileWriters	(
+		const char				*ccLogsFolder,
+		size_t					lnLogsFolder
+											)
+;
+
+/*
+	CunilogTestFnctBenchmarkTimestamps
+
+	Obtains a burst of timestamps from LocalTime_UBF_TIMESTAMP () and from the cached
+	provider LocalTimeCached_UBF_TIMESTAMP (), and outputs the time per call of each
+	of them to the console.
+*/
+bool CunilogTestFnctBenchmarkTimestamps (void)
+;
+
 EXTERN_C_END
 
 #endif														// Of #ifndef U_CUNILOGTESTFNCTS_H.
@@ -103,6 +103,11 @@ int main (int argc, char *argv [])
 	b = CunilogTestFunction	(
 			ccLogsFolder, lnLogsFolder, STR_HELLO_FROM_EXE
 							);
+	#ifdef CUNILOG_BUILD_BENCHMARKS
+		b &= CunilogTestFnctBenchmarkWakeups (ccLogsFolder, lnLogsFolder);
+		b &= CunilogTestFnctBenchmarkLogfileWriters (ccLogsFolder, lnLogsFolder);
+		b &= CunilogTestFnctBenchmarkTimestamps ();
+	#endif
 
 	return b ? EXIT_SUCCESS : EXIT_FAILURE;	
 }
@@ -36,6 +36,12 @@ When		Who				What
 	folder.
 */
 
+/*
+	The benchmarks take a while and their results depend on the machine. They are only
+	built and run when CUNILOG_BUILD_BENCHMARKS is defined.
+*/
+//#define CUNILOG_BUILD_BENCHMARKS
+
 #if defined (_WIN32) && defined (_WIN64)
 	// 64 bit MSVC version.
 	#ifndef STR_LOGS_FOLDER